@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2017-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2017-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0 OR MIT
  */
@@ -32,6 +32,7 @@ const static char *TAG = "esp_apptrace";
 typedef struct {
     esp_apptrace_hw_t *hw;
     void               *hw_data;
+    esp_apptrace_overflow_stats_t overflow[CONFIG_FREERTOS_NUMBER_OF_CORES];   // data dropped by each core
 } esp_apptrace_channel_t;
 
 static esp_apptrace_channel_t   s_trace_channels[ESP_APPTRACE_DEST_MAX];
@@ -107,6 +108,15 @@ void esp_apptrace_down_buffer_config(uint8_t *buf, uint32_t size)
     }
 }
 
+// counters are only updated by their own core, atomics keep them right when ISRs interrupt tasks updating them
+static void esp_apptrace_overflow_account(esp_apptrace_channel_t *ch, uint32_t size)
+{
+    esp_apptrace_overflow_stats_t *stats = &ch->overflow[esp_cpu_get_core_id()];
+
+    __atomic_fetch_add(&stats->dropped_chunks, 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&stats->dropped_bytes, size, __ATOMIC_RELAXED);
+}
+
 uint8_t *esp_apptrace_down_buffer_get(esp_apptrace_dest_t dest, uint32_t *size, uint32_t user_tmo)
 {
     esp_apptrace_tmo_t tmo;
@@ -230,7 +240,11 @@ uint8_t *esp_apptrace_buffer_get(esp_apptrace_dest_t dest, uint32_t size, uint32
     }
 
     esp_apptrace_tmo_init(&tmo, user_tmo);
-    return ch->hw->get_up_buffer(ch->hw_data, size, &tmo);
+    uint8_t *ptr = ch->hw->get_up_buffer(ch->hw_data, size, &tmo);
+    if (ptr == NULL) {
+        esp_apptrace_overflow_account(ch, size);
+    }
+    return ptr;
 }
 
 esp_err_t esp_apptrace_buffer_put(esp_apptrace_dest_t dest, uint8_t *ptr, uint32_t user_tmo)
@@ -289,6 +303,7 @@ esp_err_t esp_apptrace_write(esp_apptrace_dest_t dest, const void *data, uint32_
     esp_apptrace_tmo_init(&tmo, user_tmo);
     ptr = ch->hw->get_up_buffer(ch->hw_data, size, &tmo);
     if (ptr == NULL) {
+        esp_apptrace_overflow_account(ch, size);
         return ESP_ERR_NO_MEM;
     }
 
@@ -341,6 +356,7 @@ int esp_apptrace_vprintf_to(esp_apptrace_dest_t dest, uint32_t user_tmo, const c
 
     pout = ch->hw->get_up_buffer(ch->hw_data, 1 + sizeof(char *) + nargs * sizeof(uint32_t), &tmo);
     if (pout == NULL) {
+        esp_apptrace_overflow_account(ch, 1 + sizeof(char *) + nargs * sizeof(uint32_t));
         ESP_APPTRACE_LOGE("Failed to get buffer!");
         return -1;
     }
@@ -370,6 +386,24 @@ int esp_apptrace_vprintf(const char *fmt, va_list ap)
     return esp_apptrace_vprintf_to(ESP_APPTRACE_DEST_JTAG, 0, fmt, ap);
 }
 
+esp_err_t esp_apptrace_get_overflow_stats(esp_apptrace_dest_t dest, int core_id, esp_apptrace_overflow_stats_t *stats)
+{
+    if (dest >= ESP_APPTRACE_DEST_MAX || core_id < 0 || core_id >= CONFIG_FREERTOS_NUMBER_OF_CORES || stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_apptrace_channel_t *ch = &s_trace_channels[dest];
+    if (ch->hw == NULL) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    stats->dropped_chunks = __atomic_load_n(&ch->overflow[core_id].dropped_chunks, __ATOMIC_RELAXED);
+    stats->dropped_bytes = __atomic_load_n(&ch->overflow[core_id].dropped_bytes, __ATOMIC_RELAXED);
+    return ESP_OK;
+}
+
 esp_err_t esp_apptrace_flush_nolock(esp_apptrace_dest_t dest, uint32_t min_sz, uint32_t usr_tmo)
 {
     esp_apptrace_tmo_t tmo;
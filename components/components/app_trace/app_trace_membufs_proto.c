@@ -7,6 +7,7 @@
 #include <sys/param.h>
 #include <string.h>
 #include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
 #include "esp_log.h"
 #include "esp_cpu.h"
 #include "esp_app_trace_membufs_proto.h"
@@ -44,8 +45,22 @@ typedef struct {
 #endif
 #define ESP_APPTRACE_USR_BLOCK_RAW_SZ(_s_)     ((_s_) + sizeof(esp_tracedata_hdr_t))
 
-#define ESP_APPTRACE_INBLOCK_MARKER(_hw_data_)          ((_hw_data_)->state.markers[(_hw_data_)->state.in_block % 2])
-#define ESP_APPTRACE_INBLOCK_MARKER_UPD(_hw_data_, _v_)   do {(_hw_data_)->state.markers[(_hw_data_)->state.in_block % 2] += (_v_);}while(0)
+/** Block markers hold the filling level in the lower bits, then the number of lock-free writers which have reserved a chunk
+ * and not written its header yet. The closed bit is set for blocks which can not be reserved from: the block exposed to the host,
+ * the input block while it is being switched, or while older data wait in the pending buffer. Writers then take the locked path. */
+#define ESP_APPTRACE_BLOCK_CLOSED                       (1UL << 31)
+#define ESP_APPTRACE_BLOCK_WRITER                       (1UL << 24)
+#define ESP_APPTRACE_BLOCK_WRITERS_MSK                  (ESP_APPTRACE_BLOCK_CLOSED - ESP_APPTRACE_BLOCK_WRITER)
+#define ESP_APPTRACE_BLOCK_LEN_MSK                      (ESP_APPTRACE_BLOCK_WRITER - 1)
+/** Lock-free writers fill in a header with interrupts disabled, so they are waited for a few cycles at most.
+ * The limit only matters on panic, when the other core can be halted in between. */
+#define ESP_APPTRACE_BLOCK_WRITERS_WAIT_MAX             1000
+
+/** Markers are read with acquire ordering: once the writers count of a block is seen to drop, the chunk headers they wrote are visible */
+#define ESP_APPTRACE_MARKER_LOAD(_hw_data_, _num_)      __atomic_load_n(&(_hw_data_)->state.markers[_num_], __ATOMIC_ACQUIRE)
+#define ESP_APPTRACE_MARKER_STORE(_hw_data_, _num_, _v_) __atomic_store_n(&(_hw_data_)->state.markers[_num_], (_v_), __ATOMIC_RELEASE)
+
+#define ESP_APPTRACE_INBLOCK_MARKER(_hw_data_)          (ESP_APPTRACE_BLOCK_LEN_MSK & ESP_APPTRACE_MARKER_LOAD(_hw_data_, (_hw_data_)->state.in_block % 2))
 #define ESP_APPTRACE_INBLOCK(_hw_data_)             (&(_hw_data_)->blocks[(_hw_data_)->state.in_block % 2])
 
 const static char *TAG = "esp_apptrace";
@@ -61,8 +76,9 @@ esp_err_t esp_apptrace_membufs_init(esp_apptrace_membufs_proto_data_t *proto, co
     for (unsigned i = 0; i < 2; i++) {
         proto->blocks[i].start = blocks_cfg[i].start;
         proto->blocks[i].sz = blocks_cfg[i].sz;
-        proto->state.markers[i] = 0;
     }
+    proto->state.markers[0] = 0;
+    proto->state.markers[1] = ESP_APPTRACE_BLOCK_CLOSED;
     proto->state.in_block = 0;
 #if CONFIG_APPTRACE_PENDING_DATA_SIZE_MAX > 0
     esp_apptrace_rb_init(&proto->rb_pend, proto->pending_data,
@@ -76,7 +92,46 @@ void esp_apptrace_membufs_down_buffer_config(esp_apptrace_membufs_proto_data_t *
     esp_apptrace_rb_init(&data->rb_down, buf, size);
 }
 
-// assumed to be protected by caller from multi-core/thread access
+/* Reserves size bytes in the input block. Writers on all cores and ISRs advance the block marker with compare-and-set,
+ * so a block is never handed out twice. A writer which read the marker of a block which has been switched meanwhile
+ * can not succeed because that block is closed: it retries with the new input block or takes the locked path.
+ * Lock-free writers pass ESP_APPTRACE_BLOCK_WRITER in writer and call esp_apptrace_membufs_reserve_done() once
+ * the chunk header is written, writers holding the lock pass 0 since blocks are only switched under the lock. */
+static uint8_t *esp_apptrace_membufs_reserve(esp_apptrace_membufs_proto_data_t *proto, uint32_t size, uint32_t writer, int *block_num)
+{
+    while (1) {
+        int num = proto->state.in_block % 2;
+        uint32_t marker = ESP_APPTRACE_MARKER_LOAD(proto, num);
+        if ((marker & ESP_APPTRACE_BLOCK_CLOSED) || (marker & ESP_APPTRACE_BLOCK_LEN_MSK) + size > proto->blocks[num].sz) {
+            return NULL;
+        }
+        if (esp_cpu_compare_and_set(&proto->state.markers[num], marker, marker + size + writer)) {
+            *block_num = num;
+            return proto->blocks[num].start + (marker & ESP_APPTRACE_BLOCK_LEN_MSK);
+        }
+    }
+}
+
+// the release ordering publishes the chunk header to the core closing the block, which waits for the writers count to drop
+static void esp_apptrace_membufs_reserve_done(esp_apptrace_membufs_proto_data_t *proto, int block_num)
+{
+    __atomic_fetch_sub(&proto->state.markers[block_num], ESP_APPTRACE_BLOCK_WRITER, __ATOMIC_RELEASE);
+}
+
+// closes the block to lock-free writers, returns the length of the data in it once their chunk headers are written
+static uint32_t esp_apptrace_membufs_close(esp_apptrace_membufs_proto_data_t *proto, int block_num)
+{
+    uint32_t marker;
+
+    do {
+        marker = ESP_APPTRACE_MARKER_LOAD(proto, block_num);
+    } while (!esp_cpu_compare_and_set(&proto->state.markers[block_num], marker, marker | ESP_APPTRACE_BLOCK_CLOSED));
+    for (int i = 0; i < ESP_APPTRACE_BLOCK_WRITERS_WAIT_MAX && (ESP_APPTRACE_MARKER_LOAD(proto, block_num) & ESP_APPTRACE_BLOCK_WRITERS_MSK); i++) {
+    }
+    return marker & ESP_APPTRACE_BLOCK_LEN_MSK;
+}
+
+// assumed to be protected by caller from multi-core/thread access, writers reserving without lock are closed out
 static esp_err_t esp_apptrace_membufs_swap(esp_apptrace_membufs_proto_data_t *proto)
 {
     int prev_block_num = proto->state.in_block % 2;
@@ -88,11 +143,15 @@ static esp_err_t esp_apptrace_membufs_swap(esp_apptrace_membufs_proto_data_t *pr
         return res;
     }
 
-    proto->state.markers[new_block_num] = 0;
+    // no more data can be reserved in the block passed to the host, so its length is final
+    uint32_t prev_block_len = esp_apptrace_membufs_close(proto, prev_block_num);
+    // the new block stays closed until the pending data are copied to it, so that they keep their order
+    uint32_t new_block_len = 0;
+    ESP_APPTRACE_MARKER_STORE(proto, new_block_num, ESP_APPTRACE_BLOCK_CLOSED);
     // switch to new block
     proto->state.in_block++;
 
-    proto->hw->swap(new_block_num, proto->state.markers[prev_block_num]);
+    proto->hw->swap(new_block_num, prev_block_len);
 
     // handle data from host
     esp_hostdata_hdr_t *hdr = (esp_hostdata_hdr_t *)proto->blocks[new_block_num].start;
@@ -115,13 +174,13 @@ static esp_err_t esp_apptrace_membufs_swap(esp_apptrace_membufs_proto_data_t *pr
     }
 #if CONFIG_APPTRACE_PENDING_DATA_SIZE_MAX > 0
     // copy pending data to  block if any
-    while (proto->state.markers[new_block_num] < proto->blocks[new_block_num].sz) {
+    while (new_block_len < proto->blocks[new_block_num].sz) {
         uint32_t read_sz = esp_apptrace_rb_read_size_get(&proto->rb_pend);
         if (read_sz == 0) {
             break; // no more data in pending buffer
         }
-        if (read_sz > proto->blocks[new_block_num].sz - proto->state.markers[new_block_num]) {
-            read_sz = proto->blocks[new_block_num].sz - proto->state.markers[new_block_num];
+        if (read_sz > proto->blocks[new_block_num].sz - new_block_len) {
+            read_sz = proto->blocks[new_block_num].sz - new_block_len;
         }
         uint8_t *ptr = esp_apptrace_rb_consume(&proto->rb_pend, read_sz);
         if (!ptr) {
@@ -131,11 +190,13 @@ static esp_err_t esp_apptrace_membufs_swap(esp_apptrace_membufs_proto_data_t *pr
         ESP_APPTRACE_LOGD("Pump %d pend bytes [%x %x %x %x : %x %x %x %x : %x %x %x %x : %x %x...%x %x]",
             read_sz, *(ptr+0), *(ptr+1), *(ptr+2), *(ptr+3), *(ptr+4),
             *(ptr+5), *(ptr+6), *(ptr+7), *(ptr+8), *(ptr+9), *(ptr+10), *(ptr+11), *(ptr+12), *(ptr+13), *(ptr+read_sz-2), *(ptr+read_sz-1));
-        memcpy(proto->blocks[new_block_num].start + proto->state.markers[new_block_num], ptr, read_sz);
-        proto->state.markers[new_block_num] += read_sz;
+        memcpy(proto->blocks[new_block_num].start + new_block_len, ptr, read_sz);
+        new_block_len += read_sz;
     }
 #endif
-    proto->hw->swap_end(proto->state.in_block, proto->state.markers[prev_block_num]);
+    // open the new block to writers, if pending data are left it is full and they still take the locked path
+    ESP_APPTRACE_MARKER_STORE(proto, new_block_num, new_block_len);
+    proto->hw->swap_end(proto->state.in_block, prev_block_len);
     return res;
 }
 
@@ -231,6 +292,18 @@ static uint32_t esp_apptrace_membufs_down_buffer_write_nolock(esp_apptrace_membu
     return total_sz;
 }
 
+#if CONFIG_APPTRACE_PENDING_DATA_SIZE_MAX > 0
+static uint8_t *esp_apptrace_membufs_pend(esp_apptrace_membufs_proto_data_t *proto, uint32_t size)
+{
+    uint8_t *ptr = esp_apptrace_rb_produce(&proto->rb_pend, size);
+    if (ptr) {
+        // data written after these ones must not get into the input block before them
+        esp_apptrace_membufs_close(proto, proto->state.in_block % 2);
+    }
+    return ptr;
+}
+#endif
+
 static inline uint8_t *esp_apptrace_membufs_wait4buf(esp_apptrace_membufs_proto_data_t *proto, uint16_t size, esp_apptrace_tmo_t *tmo, int *pended)
 {
     uint8_t *ptr = NULL;
@@ -245,26 +318,25 @@ static inline uint8_t *esp_apptrace_membufs_wait4buf(esp_apptrace_membufs_proto_
         // if after block switch we still have pending data (not all pending data have been pumped to block)
         // alloc new pending buffer
         *pended = 1;
-        ptr = esp_apptrace_rb_produce(&proto->rb_pend, size);
+        ptr = esp_apptrace_membufs_pend(proto, size);
         if (!ptr) {
             ESP_APPTRACE_LOGE("Failed to alloc pend buf 1: w-r-s %d-%d-%d!", proto->rb_pend.wr, proto->rb_pend.rd, proto->rb_pend.cur_size);
         }
     } else
 #endif
     {
-        // update block pointers
-        if (ESP_APPTRACE_INBLOCK_MARKER(proto) + size > ESP_APPTRACE_INBLOCK(proto)->sz) {
+        int block_num;
+        *pended = 0;
+        ptr = esp_apptrace_membufs_reserve(proto, size, 0, &block_num);
 #if CONFIG_APPTRACE_PENDING_DATA_SIZE_MAX > 0
+        if (ptr == NULL) {
             *pended = 1;
-            ptr = esp_apptrace_rb_produce(&proto->rb_pend, size);
+            ptr = esp_apptrace_membufs_pend(proto, size);
             if (ptr == NULL) {
                 ESP_APPTRACE_LOGE("Failed to alloc pend buf 2: w-r-s %d-%d-%d!", proto->rb_pend.wr, proto->rb_pend.rd, proto->rb_pend.cur_size);
             }
-#endif
-        } else {
-            *pended = 0;
-            ptr = ESP_APPTRACE_INBLOCK(proto)->start + ESP_APPTRACE_INBLOCK_MARKER(proto);
         }
+#endif
     }
 
     return ptr;
@@ -281,8 +353,8 @@ static inline uint8_t *esp_apptrace_membufs_pkt_start(uint8_t *ptr, uint16_t siz
 static inline void esp_apptrace_membufs_pkt_end(uint8_t *ptr)
 {
     esp_tracedata_hdr_t *hdr = (esp_tracedata_hdr_t *)(ptr - sizeof(esp_tracedata_hdr_t));
-    // update written size
-    hdr->wr_sz = hdr->block_sz;
+    // update written size, after the data for the host reading the block from another core
+    __atomic_store_n(&hdr->wr_sz, hdr->block_sz, __ATOMIC_RELEASE);
 }
 
 uint8_t *esp_apptrace_membufs_up_buffer_get(esp_apptrace_membufs_proto_data_t *proto, uint32_t size, esp_apptrace_tmo_t *tmo)
@@ -304,41 +376,28 @@ uint8_t *esp_apptrace_membufs_up_buffer_get(esp_apptrace_membufs_proto_data_t *p
     if (esp_apptrace_rb_read_size_get(&proto->rb_pend) > 0) {
         // if we have buffered data alloc new pending buffer
         ESP_APPTRACE_LOGD("Get %d bytes from PEND buffer", size);
-        buf_ptr = esp_apptrace_rb_produce(&proto->rb_pend, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
+        buf_ptr = esp_apptrace_membufs_pend(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
         if (buf_ptr == NULL) {
             int pended_buf;
             buf_ptr = esp_apptrace_membufs_wait4buf(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size), tmo, &pended_buf);
-            if (buf_ptr && !pended_buf) {
-                ESP_APPTRACE_LOGD("Get %d bytes from block", size);
-                // update cur block marker
-                ESP_APPTRACE_INBLOCK_MARKER_UPD(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
-            }
         }
     } else {
 #else
     if (1) {
 #endif
-        if (ESP_APPTRACE_INBLOCK_MARKER(proto) + ESP_APPTRACE_USR_BLOCK_RAW_SZ(size) > ESP_APPTRACE_INBLOCK(proto)->sz) {
+        int block_num;
+        // fit to curr block
+        buf_ptr = esp_apptrace_membufs_reserve(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size), 0, &block_num);
+        if (buf_ptr == NULL) {
             #if CONFIG_APPTRACE_PENDING_DATA_SIZE_MAX > 0
             ESP_APPTRACE_LOGD("Block full. Get %" PRIu32 " bytes from PEND buffer", size);
-            buf_ptr = esp_apptrace_rb_produce(&proto->rb_pend, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
+            buf_ptr = esp_apptrace_membufs_pend(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
             #endif
             if (buf_ptr == NULL) {
                 int pended_buf;
                 ESP_APPTRACE_LOGD(" full. Get %" PRIu32 " bytes from pend buffer", size);
                 buf_ptr = esp_apptrace_membufs_wait4buf(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size), tmo, &pended_buf);
-                if (buf_ptr && !pended_buf) {
-                    ESP_APPTRACE_LOGD("Got %" PRIu32 " bytes from block", size);
-                    // update cur block marker
-                    ESP_APPTRACE_INBLOCK_MARKER_UPD(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
-                }
             }
-        } else {
-            ESP_APPTRACE_LOGD("Get %" PRIu32 " bytes from  buffer", size);
-            // fit to curr  nlock
-            buf_ptr = ESP_APPTRACE_INBLOCK(proto)->start + ESP_APPTRACE_INBLOCK_MARKER(proto);
-            // update cur block marker
-            ESP_APPTRACE_INBLOCK_MARKER_UPD(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size));
         }
     }
     if (buf_ptr) {
@@ -348,6 +407,23 @@ uint8_t *esp_apptrace_membufs_up_buffer_get(esp_apptrace_membufs_proto_data_t *p
     return buf_ptr;
 }
 
+uint8_t *esp_apptrace_membufs_up_buffer_reserve(esp_apptrace_membufs_proto_data_t *proto, uint32_t size)
+{
+    if (size > ESP_APPTRACE_USR_DATA_LEN_MAX(proto)) {
+        return NULL;
+    }
+    int block_num;
+    // the block is not passed to the host until the chunk header is written, keep it short
+    unsigned int_state = portSET_INTERRUPT_MASK_FROM_ISR();
+    uint8_t *buf_ptr = esp_apptrace_membufs_reserve(proto, ESP_APPTRACE_USR_BLOCK_RAW_SZ(size), ESP_APPTRACE_BLOCK_WRITER, &block_num);
+    if (buf_ptr) {
+        buf_ptr = esp_apptrace_membufs_pkt_start(buf_ptr, size);
+        esp_apptrace_membufs_reserve_done(proto, block_num);
+    }
+    portCLEAR_INTERRUPT_MASK_FROM_ISR(int_state);
+    return buf_ptr;
+}
+
 esp_err_t esp_apptrace_membufs_up_buffer_put(esp_apptrace_membufs_proto_data_t *proto, uint8_t *ptr, esp_apptrace_tmo_t *tmo)
 {
     esp_apptrace_membufs_pkt_end(ptr);
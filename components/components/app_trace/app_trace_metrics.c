@@ -0,0 +1,385 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <inttypes.h>
+#include "sdkconfig.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_system.h"
+#include "esp_heap_caps.h"
+#include "esp_app_trace.h"
+#include "esp_app_trace_util.h"
+#include "esp_app_trace_metrics.h"
+
+#if CONFIG_APPTRACE_METRICS_DEST_UART
+#define ESP_APPTRACE_METRICS_DEST       ESP_APPTRACE_DEST_UART
+#else
+#define ESP_APPTRACE_METRICS_DEST       ESP_APPTRACE_DEST_JTAG
+#endif
+
+#define ESP_APPTRACE_METRICS_MAGIC0     'E'
+#define ESP_APPTRACE_METRICS_MAGIC1     'M'
+/* Room left at the start of the buffer for the packet header: magic, version and packet length */
+#define ESP_APPTRACE_METRICS_HDR_MAX    (2 + 1 + 5)
+/* Largest record: metric, time delta and 64 bit value, all varints */
+#define ESP_APPTRACE_METRICS_REC_MAX    (3 + 10 + 10)
+#define ESP_APPTRACE_METRICS_SCHEMA_MAX (3 + 1 + 1 + ESP_APPTRACE_METRIC_NAME_MAX + 1 + ESP_APPTRACE_METRIC_UNIT_MAX)
+
+_Static_assert(CONFIG_APPTRACE_METRICS_BUF_SIZE >= ESP_APPTRACE_METRICS_HDR_MAX + 5 + 10 + ESP_APPTRACE_METRICS_SCHEMA_MAX,
+               "Metrics packet must hold the schema of a metric");
+
+static const char *TAG = "esp_apptrace_metrics";
+
+typedef struct {
+    const char *name;
+    const char *unit;
+    esp_apptrace_metric_type_t type;
+    uint32_t last_seq;          // packet holding the last value, counters are delta encoded within a packet
+    int64_t last_value;
+} esp_apptrace_metric_desc_t;
+
+typedef struct {
+    portMUX_TYPE lock;
+    bool inited;
+    uint32_t count;             // number of registered metrics
+    uint32_t schema_next;       // metrics from this one on have their schema still to be sent
+    uint32_t schema_seq;        // packet in which the last round of schemas started
+    uint32_t seq;               // sequence number of the packet being filled
+    int64_t last_ts;            // timestamp of the previous record in the packet
+    uint32_t len;               // length of the packet, 0 if no packet is started
+    bool packet_schema;         // the packet being filled holds schemas
+    bool schema_lost;           // a packet holding schemas was dropped, they are all sent again
+    esp_apptrace_metric_desc_t metrics[CONFIG_APPTRACE_METRICS_MAX];
+    uint8_t buf[CONFIG_APPTRACE_METRICS_BUF_SIZE];
+} esp_apptrace_metrics_t;
+
+static esp_apptrace_metrics_t s_metrics = {
+    .lock = portMUX_INITIALIZER_UNLOCKED,
+};
+
+#if CONFIG_APPTRACE_METRICS_SYS_PERIOD_MS > 0
+static esp_apptrace_metric_t s_sys_heap_free, s_sys_heap_min_free, s_sys_tasks;
+static esp_timer_handle_t s_sys_timer;
+#endif
+#if CONFIG_APPTRACE_METRICS_TASK_SWITCHES
+static esp_apptrace_metric_t s_sys_task_switches;
+// incremented by traceTASK_SWITCHED_IN(), each core only writes its own counter
+uint32_t esp_apptrace_metrics_task_switches[CONFIG_FREERTOS_NUMBER_OF_CORES];
+#endif
+
+static uint8_t *esp_apptrace_metrics_put_varint(uint8_t *p, uint64_t v)
+{
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static inline uint64_t esp_apptrace_metrics_zigzag(int64_t v)
+{
+    return ((uint64_t)v << 1) ^ (uint64_t)(v >> 63);
+}
+
+// must be called with the lock held, the packet is dropped if it can not be written without waiting
+static esp_err_t esp_apptrace_metrics_packet_write(void)
+{
+    esp_err_t res = ESP_OK;
+
+    if (s_metrics.len == 0) {
+        return ESP_OK;
+    }
+    // the header is put right before the packet body, its length is only known now
+    uint32_t body_len = s_metrics.len - ESP_APPTRACE_METRICS_HDR_MAX;
+    uint8_t hdr[ESP_APPTRACE_METRICS_HDR_MAX];
+    uint8_t *p = hdr;
+    *p++ = ESP_APPTRACE_METRICS_MAGIC0;
+    *p++ = ESP_APPTRACE_METRICS_MAGIC1;
+    *p++ = ESP_APPTRACE_METRICS_VERSION;
+    p = esp_apptrace_metrics_put_varint(p, body_len);
+    uint32_t hdr_len = p - hdr;
+    uint8_t *start = s_metrics.buf + ESP_APPTRACE_METRICS_HDR_MAX - hdr_len;
+    memcpy(start, hdr, hdr_len);
+
+    res = esp_apptrace_write(ESP_APPTRACE_METRICS_DEST, start, hdr_len + body_len, 0);
+    if (res != ESP_OK) {
+        ESP_APPTRACE_LOGD("Dropped metrics packet %" PRIu32 " (%d)", s_metrics.seq, res);
+        // the host can not decode the records of the metrics whose schema was lost until it gets them again
+        if (s_metrics.packet_schema) {
+            s_metrics.schema_lost = true;
+        }
+        res = ESP_ERR_NO_MEM;
+    }
+    s_metrics.seq++;
+    s_metrics.len = 0;
+    return res;
+}
+
+// must be called with the lock held, starts a round of schemas if one is due
+static void esp_apptrace_metrics_schema_check(void)
+{
+    bool schema_due = s_metrics.schema_lost;
+#if CONFIG_APPTRACE_METRICS_SCHEMA_INTERVAL > 0
+    schema_due |= s_metrics.seq - s_metrics.schema_seq >= CONFIG_APPTRACE_METRICS_SCHEMA_INTERVAL;
+#endif
+    // a round of schemas spanning several packets is completed before the next one starts
+    if (schema_due && s_metrics.schema_next == s_metrics.count) {
+        s_metrics.schema_next = 0;
+        s_metrics.schema_seq = s_metrics.seq;
+        s_metrics.schema_lost = false;
+    }
+}
+
+// must be called with the lock held, makes sure that size bytes can be appended to a started packet
+static esp_err_t esp_apptrace_metrics_packet_reserve(uint32_t size, int64_t ts)
+{
+    esp_err_t res = ESP_OK;
+
+    if (s_metrics.len + size > sizeof(s_metrics.buf)) {
+        res = esp_apptrace_metrics_packet_write();
+    }
+    if (s_metrics.len == 0) {
+        uint8_t *p = s_metrics.buf + ESP_APPTRACE_METRICS_HDR_MAX;
+        p = esp_apptrace_metrics_put_varint(p, s_metrics.seq);
+        p = esp_apptrace_metrics_put_varint(p, ts);
+        s_metrics.len = p - s_metrics.buf;
+        s_metrics.last_ts = ts;
+        s_metrics.packet_schema = false;
+        // rounds of schemas start packets, so that a host which missed the previous schemas decodes all the packets
+        // from this one on
+        esp_apptrace_metrics_schema_check();
+    }
+    return res;
+}
+
+// must be called with the lock held, appends the schemas not sent yet
+static esp_err_t esp_apptrace_metrics_schema_put(int64_t ts)
+{
+    esp_err_t res = ESP_OK;
+
+    while (s_metrics.schema_next < s_metrics.count) {
+        esp_err_t err = esp_apptrace_metrics_packet_reserve(ESP_APPTRACE_METRICS_SCHEMA_MAX, ts);
+        if (err != ESP_OK) {
+            res = err;
+        }
+        uint32_t id = s_metrics.schema_next;
+        esp_apptrace_metric_desc_t *desc = &s_metrics.metrics[id];
+        size_t name_len = strlen(desc->name);
+        size_t unit_len = desc->unit ? strlen(desc->unit) : 0;
+        uint8_t *p = s_metrics.buf + s_metrics.len;
+        p = esp_apptrace_metrics_put_varint(p, (id << 1) | 1);
+        *p++ = desc->type;
+        *p++ = name_len;
+        memcpy(p, desc->name, name_len);
+        p += name_len;
+        *p++ = unit_len;
+        if (unit_len) {
+            memcpy(p, desc->unit, unit_len);
+            p += unit_len;
+        }
+        s_metrics.len = p - s_metrics.buf;
+        s_metrics.packet_schema = true;
+        s_metrics.schema_next = id + 1;
+    }
+    return res;
+}
+
+static bool esp_apptrace_metrics_type_match(esp_apptrace_metric_type_t type, esp_apptrace_metric_type_t api_type)
+{
+    if (api_type == ESP_APPTRACE_METRIC_INT) {
+        // esp_apptrace_metrics_record() serves all the integer types
+        return type == ESP_APPTRACE_METRIC_UINT || type == ESP_APPTRACE_METRIC_INT || type == ESP_APPTRACE_METRIC_COUNTER;
+    }
+    return type == api_type;
+}
+
+static esp_err_t esp_apptrace_metrics_put(esp_apptrace_metric_t metric, esp_apptrace_metric_type_t api_type, int64_t value, float fvalue)
+{
+    esp_err_t res = ESP_OK;
+
+    if (!s_metrics.inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int64_t ts = esp_timer_get_time();
+
+    portENTER_CRITICAL_SAFE(&s_metrics.lock);
+    if (metric >= s_metrics.count || !esp_apptrace_metrics_type_match(s_metrics.metrics[metric].type, api_type)) {
+        portEXIT_CRITICAL_SAFE(&s_metrics.lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_apptrace_metric_desc_t *desc = &s_metrics.metrics[metric];
+    esp_err_t err = esp_apptrace_metrics_schema_put(ts);
+    if (err != ESP_OK) {
+        res = err;
+    }
+    err = esp_apptrace_metrics_packet_reserve(ESP_APPTRACE_METRICS_REC_MAX, ts);
+    if (err != ESP_OK) {
+        res = err;
+    }
+    // schemas dropped with a packet written to make room for the record or for its schema are sent again before it
+    esp_apptrace_metrics_schema_check();
+    if (s_metrics.schema_next < s_metrics.count) {
+        // if this packet is dropped too, its schemas are sent with the next record
+        err = esp_apptrace_metrics_schema_put(ts);
+        if (err != ESP_OK) {
+            res = err;
+        }
+        err = esp_apptrace_metrics_packet_reserve(ESP_APPTRACE_METRICS_REC_MAX, ts);
+        if (err != ESP_OK) {
+            res = err;
+        }
+    }
+
+    // timestamps of records taken concurrently can be slightly out of order, keep deltas positive
+    int64_t delta = ts > s_metrics.last_ts ? ts - s_metrics.last_ts : 0;
+    s_metrics.last_ts += delta;
+    uint8_t *p = s_metrics.buf + s_metrics.len;
+    p = esp_apptrace_metrics_put_varint(p, (uint32_t)metric << 1);
+    p = esp_apptrace_metrics_put_varint(p, delta);
+    switch (desc->type) {
+    case ESP_APPTRACE_METRIC_UINT:
+        p = esp_apptrace_metrics_put_varint(p, (uint64_t)value);
+        break;
+    case ESP_APPTRACE_METRIC_INT:
+        p = esp_apptrace_metrics_put_varint(p, esp_apptrace_metrics_zigzag(value));
+        break;
+    case ESP_APPTRACE_METRIC_COUNTER: {
+        int64_t prev = desc->last_seq == s_metrics.seq ? desc->last_value : 0;
+        p = esp_apptrace_metrics_put_varint(p, esp_apptrace_metrics_zigzag(value - prev));
+        desc->last_seq = s_metrics.seq;
+        desc->last_value = value;
+        break;
+    }
+    case ESP_APPTRACE_METRIC_FLOAT:
+        memcpy(p, &fvalue, sizeof(fvalue));
+        p += sizeof(fvalue);
+        break;
+    default:
+        break;
+    }
+    s_metrics.len = p - s_metrics.buf;
+    portEXIT_CRITICAL_SAFE(&s_metrics.lock);
+    return res;
+}
+
+esp_err_t esp_apptrace_metrics_register(const char *name, const char *unit, esp_apptrace_metric_type_t type, esp_apptrace_metric_t *out_metric)
+{
+    if (name == NULL || name[0] == 0 || strlen(name) > ESP_APPTRACE_METRIC_NAME_MAX || out_metric == NULL ||
+        (unit != NULL && strlen(unit) > ESP_APPTRACE_METRIC_UNIT_MAX) || type >= ESP_APPTRACE_METRIC_TYPE_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!s_metrics.inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    portENTER_CRITICAL(&s_metrics.lock);
+    if (s_metrics.count == CONFIG_APPTRACE_METRICS_MAX) {
+        portEXIT_CRITICAL(&s_metrics.lock);
+        return ESP_ERR_NO_MEM;
+    }
+    esp_apptrace_metric_desc_t *desc = &s_metrics.metrics[s_metrics.count];
+    desc->name = name;
+    desc->unit = unit;
+    desc->type = type;
+    desc->last_seq = UINT32_MAX;
+    // the schema is sent with the next record
+    *out_metric = s_metrics.count++;
+    portEXIT_CRITICAL(&s_metrics.lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_apptrace_metrics_record(esp_apptrace_metric_t metric, int64_t value)
+{
+    // integer types are checked against the metric type when it is known
+    return esp_apptrace_metrics_put(metric, ESP_APPTRACE_METRIC_INT, value, 0);
+}
+
+esp_err_t esp_apptrace_metrics_record_float(esp_apptrace_metric_t metric, float value)
+{
+    return esp_apptrace_metrics_put(metric, ESP_APPTRACE_METRIC_FLOAT, 0, value);
+}
+
+esp_err_t esp_apptrace_metrics_event(esp_apptrace_metric_t metric)
+{
+    return esp_apptrace_metrics_put(metric, ESP_APPTRACE_METRIC_EVENT, 0, 0);
+}
+
+esp_err_t esp_apptrace_metrics_flush(uint32_t tmo)
+{
+    if (!s_metrics.inited) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    portENTER_CRITICAL(&s_metrics.lock);
+    esp_err_t res = esp_apptrace_metrics_packet_write();
+    portEXIT_CRITICAL(&s_metrics.lock);
+    if (res != ESP_OK) {
+        return res;
+    }
+    return esp_apptrace_flush(ESP_APPTRACE_METRICS_DEST, tmo);
+}
+
+#if CONFIG_APPTRACE_METRICS_SYS_PERIOD_MS > 0
+static void esp_apptrace_metrics_sys_sample(void *arg)
+{
+    esp_apptrace_metrics_record(s_sys_heap_free, esp_get_free_heap_size());
+    esp_apptrace_metrics_record(s_sys_heap_min_free, esp_get_minimum_free_heap_size());
+    esp_apptrace_metrics_record(s_sys_tasks, uxTaskGetNumberOfTasks());
+#if CONFIG_APPTRACE_METRICS_TASK_SWITCHES
+    uint32_t task_switches = 0;
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        task_switches += esp_apptrace_metrics_task_switches[i];
+    }
+    esp_apptrace_metrics_record(s_sys_task_switches, task_switches);
+#endif
+    // the records reach the trace buffer at least once per period, it is sent to the host when full
+    portENTER_CRITICAL(&s_metrics.lock);
+    esp_apptrace_metrics_packet_write();
+    portEXIT_CRITICAL(&s_metrics.lock);
+}
+#endif
+
+esp_err_t esp_apptrace_metrics_init(void)
+{
+    if (s_metrics.inited) {
+        return ESP_OK;
+    }
+    s_metrics.inited = true;
+
+#if CONFIG_APPTRACE_METRICS_SYS_PERIOD_MS > 0
+    esp_err_t res = esp_apptrace_metrics_register("sys.heap_free", "B", ESP_APPTRACE_METRIC_UINT, &s_sys_heap_free);
+    if (res == ESP_OK) {
+        res = esp_apptrace_metrics_register("sys.heap_min_free", "B", ESP_APPTRACE_METRIC_UINT, &s_sys_heap_min_free);
+    }
+    if (res == ESP_OK) {
+        res = esp_apptrace_metrics_register("sys.tasks", NULL, ESP_APPTRACE_METRIC_UINT, &s_sys_tasks);
+    }
+#if CONFIG_APPTRACE_METRICS_TASK_SWITCHES
+    if (res == ESP_OK) {
+        res = esp_apptrace_metrics_register("sys.task_switches", NULL, ESP_APPTRACE_METRIC_COUNTER, &s_sys_task_switches);
+    }
+#endif
+    if (res == ESP_OK) {
+        const esp_timer_create_args_t timer_args = {
+            .callback = esp_apptrace_metrics_sys_sample,
+            .name = "apptrace_metrics",
+        };
+        res = esp_timer_create(&timer_args, &s_sys_timer);
+    }
+    if (res == ESP_OK) {
+        res = esp_timer_start_periodic(s_sys_timer, CONFIG_APPTRACE_METRICS_SYS_PERIOD_MS * 1000ULL);
+    }
+    if (res != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start sampling system metrics (0x%x)", res);
+        return res;
+    }
+#endif
+    ESP_LOGD(TAG, "Metrics stream to %s", ESP_APPTRACE_METRICS_DEST == ESP_APPTRACE_DEST_UART ? "UART" : "JTAG");
+    return ESP_OK;
+}
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2017-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2017-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -25,6 +25,14 @@ typedef enum {
     ESP_APPTRACE_DEST_NUM
 } esp_apptrace_dest_t;
 
+/**
+ * Trace data a core could not write because the trace buffer was full, see esp_apptrace_get_overflow_stats.
+ */
+typedef struct {
+    uint32_t dropped_chunks;    ///< Number of failed esp_apptrace_buffer_get, esp_apptrace_write and esp_apptrace_vprintf_to calls
+    uint32_t dropped_bytes;     ///< Total size of the data requested by these calls
+} esp_apptrace_overflow_stats_t;
+
 /**
  * @brief  Initializes application tracing module.
  *
@@ -160,6 +168,19 @@ uint8_t *esp_apptrace_down_buffer_get(esp_apptrace_dest_t dest, uint32_t *size,
  */
 esp_err_t esp_apptrace_down_buffer_put(esp_apptrace_dest_t dest, uint8_t *ptr, uint32_t tmo);
 
+/**
+ * @brief Gets the amount of trace data dropped by a core.
+ *        Data are dropped when no trace buffer can be allocated within the timeout, usually because the host
+ *        does not read them fast enough. The counters are cumulative since esp_apptrace_init.
+ *
+ * @param dest    Indicates HW interface to get the statistics of.
+ * @param core_id Core which tried to write the data.
+ * @param stats   Address to store the statistics.
+ *
+ * @return ESP_OK on success, otherwise see esp_err_t
+ */
+esp_err_t esp_apptrace_get_overflow_stats(esp_apptrace_dest_t dest, int core_id, esp_apptrace_overflow_stats_t *stats);
+
 /**
  * @brief Checks whether host is connected.
  *
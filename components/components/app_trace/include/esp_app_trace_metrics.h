@@ -0,0 +1,137 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ESP_APP_TRACE_METRICS_H_
+#define ESP_APP_TRACE_METRICS_H_
+
+#include <stdint.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Binary metrics stream
+ *
+ * Counters, gauges and events recorded by the application are sent to the host through esp_apptrace_write()
+ * in a compact, self-describing binary format. The stream is captured like any other application trace
+ * (e.g. with OpenOCD `esp apptrace start file://metrics.bin`) and decoded offline with `metricstrace_proc.py`.
+ *
+ * Stream format, multi-byte integers being LEB128 varints unless stated otherwise:
+ *  - The stream is a sequence of packets, each one written to the trace buffer by a single esp_apptrace_write().
+ *    Packet: magic "EM" (2 bytes), version (1 byte), length of the rest of the packet, packet sequence number,
+ *    timestamp of the packet in us, then records until the end of the packet.
+ *    A packet can be decoded without the previous ones, gaps in the sequence numbers show lost packets.
+ *  - Record: `metric << 1 | schema` followed by
+ *    - schema = 1: type (1 byte), name length (1 byte), name, unit length (1 byte), unit.
+ *    - schema = 0: time since the previous record of the packet (or the packet timestamp) in us, then the value:
+ *      varint for ESP_APPTRACE_METRIC_UINT, zigzag varint for ESP_APPTRACE_METRIC_INT, zigzag varint of the difference
+ *      to the previous value of the metric in the packet (0 for the first one) for ESP_APPTRACE_METRIC_COUNTER,
+ *      little endian IEEE 754 single (4 bytes) for ESP_APPTRACE_METRIC_FLOAT, nothing for ESP_APPTRACE_METRIC_EVENT.
+ *  - The schema of a metric is sent before its first value, and the schemas of all metrics are sent again every
+ *    CONFIG_APPTRACE_METRICS_SCHEMA_INTERVAL packets and after a packet holding schemas was dropped.
+ */
+
+#define ESP_APPTRACE_METRICS_VERSION    1   ///< Version of the stream format
+
+#define ESP_APPTRACE_METRIC_NAME_MAX    32  ///< Maximum length of a metric name
+#define ESP_APPTRACE_METRIC_UNIT_MAX    16  ///< Maximum length of a metric unit
+
+/**
+ * Metric types, which select how values are encoded.
+ */
+typedef enum {
+    ESP_APPTRACE_METRIC_UINT = 0,   ///< Unsigned value, e.g. a queue depth
+    ESP_APPTRACE_METRIC_INT,        ///< Signed value
+    ESP_APPTRACE_METRIC_COUNTER,    ///< Value which changes by small steps, e.g. a number of received packets
+    ESP_APPTRACE_METRIC_FLOAT,      ///< Floating point value
+    ESP_APPTRACE_METRIC_EVENT,      ///< Event without value, only its timestamp is sent
+    ESP_APPTRACE_METRIC_TYPE_MAX,
+} esp_apptrace_metric_type_t;
+
+/**
+ * Metric identifier returned by esp_apptrace_metrics_register.
+ */
+typedef uint16_t esp_apptrace_metric_t;
+
+/**
+ * @brief Initializes the metrics stream.
+ *        Starts sampling the system metrics if CONFIG_APPTRACE_METRICS_SYS_PERIOD_MS is not 0: free heap size,
+ *        minimum free heap size, number of tasks and, with CONFIG_APPTRACE_METRICS_TASK_SWITCHES, task switches.
+ *
+ * @return ESP_OK on success, otherwise see esp_err_t
+ */
+esp_err_t esp_apptrace_metrics_init(void);
+
+/**
+ * @brief Registers a metric.
+ *
+ * @param name       Name of the metric, at most ESP_APPTRACE_METRIC_NAME_MAX characters.
+ *                   The string must stay valid while the metrics stream is used.
+ * @param unit       Unit of the values, at most ESP_APPTRACE_METRIC_UNIT_MAX characters, or NULL.
+ *                   The string must stay valid while the metrics stream is used.
+ * @param type       Type of the metric.
+ * @param out_metric Address to store the metric identifier.
+ *
+ * @return
+ *    - ESP_OK on success
+ *    - ESP_ERR_INVALID_ARG if an argument is invalid
+ *    - ESP_ERR_NO_MEM if CONFIG_APPTRACE_METRICS_MAX metrics are already registered
+ *    - ESP_ERR_INVALID_STATE if the metrics stream is not initialized
+ */
+esp_err_t esp_apptrace_metrics_register(const char *name, const char *unit, esp_apptrace_metric_type_t type, esp_apptrace_metric_t *out_metric);
+
+/**
+ * @brief Records a value of an integer metric.
+ *        Can be called from tasks and ISRs. It does not wait: if the packet can not be written to the trace buffer,
+ *        the records in it are dropped.
+ *
+ * @param metric Identifier of a ESP_APPTRACE_METRIC_UINT, ESP_APPTRACE_METRIC_INT or ESP_APPTRACE_METRIC_COUNTER metric.
+ * @param value  Value of the metric.
+ *
+ * @return
+ *    - ESP_OK on success
+ *    - ESP_ERR_INVALID_ARG if the metric is unknown or of another type
+ *    - ESP_ERR_NO_MEM if a packet could not be written and its records were dropped
+ *    - ESP_ERR_INVALID_STATE if the metrics stream is not initialized
+ */
+esp_err_t esp_apptrace_metrics_record(esp_apptrace_metric_t metric, int64_t value);
+
+/**
+ * @brief Records a value of a floating point metric.
+ *        Same as esp_apptrace_metrics_record for ESP_APPTRACE_METRIC_FLOAT metrics.
+ *
+ * @param metric Identifier of a ESP_APPTRACE_METRIC_FLOAT metric.
+ * @param value  Value of the metric.
+ *
+ * @return See esp_apptrace_metrics_record
+ */
+esp_err_t esp_apptrace_metrics_record_float(esp_apptrace_metric_t metric, float value);
+
+/**
+ * @brief Records an event.
+ *        Same as esp_apptrace_metrics_record for ESP_APPTRACE_METRIC_EVENT metrics.
+ *
+ * @param metric Identifier of a ESP_APPTRACE_METRIC_EVENT metric.
+ *
+ * @return See esp_apptrace_metrics_record
+ */
+esp_err_t esp_apptrace_metrics_event(esp_apptrace_metric_t metric);
+
+/**
+ * @brief Writes the records gathered so far to the trace buffer and flushes it to the host.
+ *
+ * @param tmo Timeout for flushing the trace buffer (in us). Use ESP_APPTRACE_TMO_INFINITE to wait indefinitely.
+ *
+ * @return ESP_OK on success, otherwise see esp_err_t
+ */
+esp_err_t esp_apptrace_metrics_flush(uint32_t tmo);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
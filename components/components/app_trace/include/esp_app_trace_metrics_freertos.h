@@ -0,0 +1,32 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#ifndef ESP_APP_TRACE_METRICS_FREERTOS_H_
+#define ESP_APP_TRACE_METRICS_FREERTOS_H_
+
+/*
+ * FreeRTOS trace macros of the metrics stream, included by FreeRTOSConfig.h if CONFIG_APPTRACE_METRICS_TASK_SWITCHES
+ * is enabled. The task switches of each core are counted here and sampled as the "sys.task_switches" metric.
+ */
+
+#include <stdint.h>
+#include "sdkconfig.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * Number of tasks switched in on each core.
+ */
+extern uint32_t esp_apptrace_metrics_task_switches[CONFIG_FREERTOS_NUMBER_OF_CORES];
+
+#define traceTASK_SWITCHED_IN()     (esp_apptrace_metrics_task_switches[xPortGetCoreID()]++)
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
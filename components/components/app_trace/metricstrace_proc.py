@@ -0,0 +1,218 @@
+#!/usr/bin/env python
+#
+# metricstrace_proc decodes a metrics stream captured from esp_apptrace_metrics, see
+# esp_app_trace_metrics.h for the format
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+from __future__ import division, print_function
+
+import argparse
+import struct
+import sys
+
+__version__ = '1.0'
+
+MAGIC = b'EM'
+VERSION = 1
+
+TYPE_UINT = 0
+TYPE_INT = 1
+TYPE_COUNTER = 2
+TYPE_FLOAT = 3
+TYPE_EVENT = 4
+TYPE_NAMES = ['uint', 'int', 'counter', 'float', 'event']
+
+quiet = False
+
+
+def status(msg):
+    if not quiet:
+        print(msg, file=sys.stderr)
+
+
+class MalformedPacket(ValueError):
+    pass
+
+
+class Reader(object):
+    def __init__(self, data, pos, end):
+        self.data = data
+        self.pos = pos
+        self.end = end
+
+    def byte(self):
+        if self.pos >= self.end:
+            raise MalformedPacket('Truncated record')
+        byte = self.data[self.pos]
+        self.pos += 1
+        return byte
+
+    def bytes(self, length):
+        if self.pos + length > self.end:
+            raise MalformedPacket('Truncated record')
+        out = self.data[self.pos:self.pos + length]
+        self.pos += length
+        return out
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            byte = self.byte()
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+            if shift >= 70:
+                raise MalformedPacket('Varint too long')
+
+
+def unzigzag(value):
+    return (value >> 1) ^ -(value & 1)
+
+
+class Decoder(object):
+    """ Decodes packets, keeping the schemas and the statistics of the stream """
+
+    def __init__(self):
+        self.schemas = {}
+        self.packets = 0
+        self.lost_packets = 0
+        self.skipped_bytes = 0
+        self.unknown_records = 0
+        self.next_seq = None
+
+    def packets_of(self, data):
+        """ Yields (seq, ts, records reader), resynchronizing on the magic after corrupted data """
+        pos = 0
+        while pos < len(data):
+            start = data.find(MAGIC, pos)
+            if start < 0:
+                self.skipped_bytes += len(data) - pos
+                return
+            self.skipped_bytes += start - pos
+            try:
+                if start + 3 > len(data):
+                    raise MalformedPacket('Truncated header')
+                if data[start + 2] != VERSION:
+                    raise MalformedPacket('Version {} is not supported'.format(data[start + 2]))
+                header = Reader(data, start + 3, len(data))
+                length = header.varint()
+                end = header.pos + length
+                if end > len(data):
+                    raise MalformedPacket('Truncated packet')
+                reader = Reader(data, header.pos, end)
+                seq = reader.varint()
+                ts = reader.varint()
+            except MalformedPacket:
+                self.skipped_bytes += 1
+                pos = start + 1
+                continue
+            yield seq, ts, reader
+            pos = end
+
+    def decode(self, data):
+        """ Yields (ts, name, unit, type, value) for all the samples of the stream """
+        for seq, ts, reader in self.packets_of(data):
+            self.packets += 1
+            if self.next_seq is not None and seq != self.next_seq:
+                self.lost_packets += (seq - self.next_seq) & 0xffffffff
+            self.next_seq = (seq + 1) & 0xffffffff
+            counters = {}
+            samples = []
+            try:
+                while reader.pos < reader.end:
+                    key = reader.varint()
+                    metric = key >> 1
+                    if key & 1:
+                        mtype = reader.byte()
+                        name = reader.bytes(reader.byte()).decode('utf-8', 'replace')
+                        unit = reader.bytes(reader.byte()).decode('utf-8', 'replace')
+                        self.schemas[metric] = (name, unit, mtype)
+                        continue
+                    ts += reader.varint()
+                    schema = self.schemas.get(metric)
+                    if schema is None:
+                        # The value can not be skipped without the type, the rest of the packet is lost
+                        self.unknown_records += 1
+                        break
+                    name, unit, mtype = schema
+                    if mtype == TYPE_UINT:
+                        value = reader.varint()
+                    elif mtype == TYPE_INT:
+                        value = unzigzag(reader.varint())
+                    elif mtype == TYPE_COUNTER:
+                        value = counters.get(metric, 0) + unzigzag(reader.varint())
+                        counters[metric] = value
+                    elif mtype == TYPE_FLOAT:
+                        value = struct.unpack('<f', reader.bytes(4))[0]
+                    elif mtype == TYPE_EVENT:
+                        value = None
+                    else:
+                        raise MalformedPacket('Unknown type {} of metric {}'.format(mtype, name))
+                    samples.append((ts, name, unit, mtype, value))
+            except MalformedPacket as e:
+                status('Packet {}: {}'.format(seq, e))
+            for sample in samples:
+                yield sample
+
+
+def format_value(mtype, value):
+    if value is None:
+        return ''
+    if mtype == TYPE_FLOAT:
+        return '{:g}'.format(value)
+    return str(value)
+
+
+def main():
+    global quiet
+    parser = argparse.ArgumentParser(description='Decodes a metrics stream captured from esp_apptrace_metrics')
+    parser.add_argument('--quiet', '-q', help='Don\'t print non-critical status messages to stderr', action='store_true')
+    parser.add_argument('--csv', help='Print the samples as CSV: timestamp (us), metric, unit, value', action='store_true')
+    parser.add_argument('--summary', '-s', help='Only print the statistics of each metric', action='store_true')
+    parser.add_argument('input', help='Captured trace, e.g. from OpenOCD "esp apptrace start file://metrics.bin"')
+    args = parser.parse_args()
+    quiet = args.quiet
+
+    with open(args.input, 'rb') as f:
+        data = bytearray(f.read())
+
+    decoder = Decoder()
+    stats = {}
+    if args.csv and not args.summary:
+        print('timestamp_us,metric,unit,value')
+    for ts, name, unit, mtype, value in decoder.decode(data):
+        stat = stats.setdefault(name, [unit, mtype, 0, None, None, None])
+        stat[2] += 1
+        if value is not None:
+            stat[3] = value if stat[3] is None else min(stat[3], value)
+            stat[4] = value if stat[4] is None else max(stat[4], value)
+            stat[5] = value
+        if args.summary:
+            continue
+        if args.csv:
+            print('{},{},{},{}'.format(ts, name, unit, format_value(mtype, value)))
+        else:
+            print('{:>14.6f} {:<32} {} {}'.format(ts / 1e6, name, format_value(mtype, value), unit).rstrip())
+
+    if args.summary:
+        for name in sorted(stats):
+            unit, mtype, count, vmin, vmax, last = stats[name]
+            if mtype == TYPE_EVENT:
+                print('{:<32} {:<8} {} events'.format(name, TYPE_NAMES[mtype], count))
+            else:
+                print('{:<32} {:<8} {} samples, min {}, max {}, last {} {}'.format(
+                    name, TYPE_NAMES[mtype], count, format_value(mtype, vmin), format_value(mtype, vmax),
+                    format_value(mtype, last), unit).rstrip())
+    status('{} packets, {} lost, {} bytes skipped, {} records of unknown metrics'.format(
+        decoder.packets, decoder.lost_packets, decoder.skipped_bytes, decoder.unknown_records))
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main())
+    except (IOError, OSError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(2)
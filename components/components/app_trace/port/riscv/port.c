@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0 OR MIT
  */
@@ -183,6 +183,11 @@ static uint8_t *esp_apptrace_riscv_up_buffer_get(esp_apptrace_riscv_data_t *hw_d
     if (!ESP_APPTRACE_RISCV_INITED(hw_data)) {
         return NULL;
     }
+    // data fitting in the current block are reserved without lock, it is only needed to switch blocks
+    ptr = esp_apptrace_membufs_up_buffer_reserve(&hw_data->membufs, size);
+    if (ptr != NULL) {
+        return ptr;
+    }
     esp_err_t res = esp_apptrace_riscv_lock(hw_data, tmo);
     if (res != ESP_OK) {
         return NULL;
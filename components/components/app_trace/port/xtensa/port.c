@@ -131,7 +131,11 @@
 // 5. Module Access Synchronization
 // ================================
 
-// Access to internal module's data is synchronized with custom mutex. Mutex is a wrapper for portMUX_TYPE and uses almost the same sync mechanism as in
+// Chunks which fit in the current input block are allocated without the mutex: the block filling level is advanced with compare-and-set
+// (S32C1I), so tasks and ISRs on both cores get separate chunks without waiting for each other. Before a block is exposed to the host its
+// filling level is marked closed, so allocations in it fail and the calls which need to switch blocks or to use the pending data buffer
+// fall back to the mutex. Data which can not be written are counted per core, see esp_apptrace_get_overflow_stats().
+// Access to the rest of internal module's data is synchronized with custom mutex. Mutex is a wrapper for portMUX_TYPE and uses almost the same sync mechanism as in
 // vPortCPUAcquireMutex/vPortCPUReleaseMutex. The mechanism uses S32C1I Xtensa instruction to implement exclusive access to module's data from tasks and
 // ISRs running on both cores. Also custom mutex allows specifying timeout for locking operation. Locking routine checks underlying mutex in cycle until
 // it gets its ownership or timeout expires. The differences of application tracing module's mutex implementation from vPortCPUAcquireMutex/vPortCPUReleaseMutex are:
@@ -360,6 +364,11 @@ static uint8_t *esp_apptrace_trax_up_buffer_get(esp_apptrace_trax_data_t *hw_dat
     if (!ESP_APPTRACE_TRAX_INITED(hw_data)) {
         return NULL;
     }
+    // data fitting in the current block are reserved without lock, it is only needed to switch blocks
+    ptr = esp_apptrace_membufs_up_buffer_reserve(&hw_data->membufs, size);
+    if (ptr != NULL) {
+        return ptr;
+    }
     esp_err_t res = esp_apptrace_trax_lock(hw_data, tmo);
     if (res != ESP_OK) {
         return NULL;
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2020-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2020-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -16,8 +16,8 @@ extern "C" {
 /** TRAX HW transport state */
 typedef struct {
     uint32_t                   in_block;     // input block ID
-    // TODO: change to uint16_t
-    uint32_t                   markers[2];   // block filling level markers
+    // block filling level markers, reserved with compare-and-set, bit 31 is set while the block is closed to lock-free writers
+    uint32_t                   markers[2];
 } esp_apptrace_membufs_state_t;
 
 /** memory block parameters,
@@ -53,6 +53,9 @@ void esp_apptrace_membufs_down_buffer_config(esp_apptrace_membufs_proto_data_t *
 uint8_t *esp_apptrace_membufs_down_buffer_get(esp_apptrace_membufs_proto_data_t *proto, uint32_t *size, esp_apptrace_tmo_t *tmo);
 esp_err_t esp_apptrace_membufs_down_buffer_put(esp_apptrace_membufs_proto_data_t *proto, uint8_t *ptr, esp_apptrace_tmo_t *tmo);
 uint8_t *esp_apptrace_membufs_up_buffer_get(esp_apptrace_membufs_proto_data_t *proto, uint32_t size, esp_apptrace_tmo_t *tmo);
+/* Lock-free version of esp_apptrace_membufs_up_buffer_get(), which only succeeds if the data fit in the current input block.
+ * If it returns NULL, the caller takes its lock and calls esp_apptrace_membufs_up_buffer_get() to switch blocks. */
+uint8_t *esp_apptrace_membufs_up_buffer_reserve(esp_apptrace_membufs_proto_data_t *proto, uint32_t size);
 esp_err_t esp_apptrace_membufs_up_buffer_put(esp_apptrace_membufs_proto_data_t *proto, uint8_t *ptr, esp_apptrace_tmo_t *tmo);
 esp_err_t esp_apptrace_membufs_flush_nolock(esp_apptrace_membufs_proto_data_t *proto, uint32_t min_sz, esp_apptrace_tmo_t *tmo);
 
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -19,6 +19,9 @@
 
 #include "esp_app_trace.h"
 #include "esp_app_trace_util.h"
+#if CONFIG_APPTRACE_METRICS_ENABLE
+#include "esp_app_trace_metrics.h"
+#endif
 
 #define ESP_APPTRACE_TEST_USE_PRINT_LOCK        0
 #define ESP_APPTRACE_TEST_PRN_WRERR_MAX         5
@@ -695,6 +698,120 @@ TEST_CASE("Log trace test (2 tasks)", "[trace][ignore]")
     vSemaphoreDelete(arg2.done);
 }
 
+#define ESP_APPTRACE_TEST_OVF_CHUNKS    20000
+
+typedef struct {
+    SemaphoreHandle_t done;
+    uint32_t wr_err;
+} esp_apptrace_test_ovf_task_arg_t;
+
+static void esp_apptrace_test_ovf_task(void *p)
+{
+    esp_apptrace_test_ovf_task_arg_t *arg = (esp_apptrace_test_ovf_task_arg_t *)p;
+    uint32_t buf[4];
+
+    for (uint32_t i = 0; i < ESP_APPTRACE_TEST_OVF_CHUNKS; i++) {
+        buf[0] = i;
+        if (ESP_APPTRACE_TEST_WRITE_NOWAIT(buf, sizeof(buf)) != ESP_OK) {
+            arg->wr_err++;
+        }
+    }
+    xSemaphoreGive(arg->done);
+    vTaskDelete(NULL);
+}
+
+static void esp_apptrace_test_ovf_stats_get(esp_apptrace_overflow_stats_t *total)
+{
+    memset(total, 0, sizeof(*total));
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        esp_apptrace_overflow_stats_t stats;
+        TEST_ESP_OK(esp_apptrace_get_overflow_stats(ESP_APPTRACE_DEST_TRAX, i, &stats));
+        total->dropped_chunks += stats.dropped_chunks;
+        total->dropped_bytes += stats.dropped_bytes;
+    }
+}
+
+TEST_CASE("App trace overflow stats count the writes which fail", "[trace]")
+{
+    esp_apptrace_test_ovf_task_arg_t args[CONFIG_FREERTOS_NUMBER_OF_CORES] = {};
+    esp_apptrace_overflow_stats_t before, after;
+    uint32_t wr_err = 0;
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_get_overflow_stats(ESP_APPTRACE_DEST_TRAX, CONFIG_FREERTOS_NUMBER_OF_CORES, &before));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_get_overflow_stats(ESP_APPTRACE_DEST_TRAX, 0, NULL));
+    esp_apptrace_test_ovf_stats_get(&before);
+
+    // writers on all cores at once, they reserve the trace buffers without lock
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        args[i].done = xSemaphoreCreateBinary();
+        TEST_ASSERT_NOT_NULL(args[i].done);
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(esp_apptrace_test_ovf_task, "ovf", 2048, &args[i], 3, NULL, i));
+    }
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        xSemaphoreTake(args[i].done, portMAX_DELAY);
+        vSemaphoreDelete(args[i].done);
+        wr_err += args[i].wr_err;
+    }
+    // larger than a trace block, so it can not be written whether the host reads the data or not
+    uint8_t data = 0;
+    TEST_ESP_ERR(ESP_ERR_NO_MEM, ESP_APPTRACE_TEST_WRITE_NOWAIT(&data, 0x10000));
+
+    esp_apptrace_test_ovf_stats_get(&after);
+    TEST_ASSERT_EQUAL_UINT32(wr_err + 1, after.dropped_chunks - before.dropped_chunks);
+    TEST_ASSERT_EQUAL_UINT32(wr_err * 4 * sizeof(uint32_t) + 0x10000, after.dropped_bytes - before.dropped_bytes);
+}
+
+#if CONFIG_APPTRACE_METRICS_ENABLE
+TEST_CASE("App trace metrics check the metric types", "[trace]")
+{
+    esp_apptrace_metric_t depth, load, reconnect;
+
+    TEST_ESP_OK(esp_apptrace_metrics_init());
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_register("", NULL, ESP_APPTRACE_METRIC_UINT, &depth));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_register("test.depth", NULL, ESP_APPTRACE_METRIC_TYPE_MAX, &depth));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_register("test.depth", "0123456789abcdefg", ESP_APPTRACE_METRIC_UINT, &depth));
+    TEST_ESP_OK(esp_apptrace_metrics_register("test.depth", "items", ESP_APPTRACE_METRIC_UINT, &depth));
+    TEST_ESP_OK(esp_apptrace_metrics_register("test.load", "%", ESP_APPTRACE_METRIC_FLOAT, &load));
+    TEST_ESP_OK(esp_apptrace_metrics_register("test.reconnect", NULL, ESP_APPTRACE_METRIC_EVENT, &reconnect));
+
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_record(load, 1));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_record_float(depth, 1.0f));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_event(depth));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_apptrace_metrics_record(CONFIG_APPTRACE_METRICS_MAX, 1));
+    // records do not wait for the host, packets which can not be written are dropped
+    for (int i = 0; i < 1000; i++) {
+        esp_err_t res = esp_apptrace_metrics_record(depth, i);
+        TEST_ASSERT(res == ESP_OK || res == ESP_ERR_NO_MEM);
+        res = esp_apptrace_metrics_record_float(load, i / 10.0f);
+        TEST_ASSERT(res == ESP_OK || res == ESP_ERR_NO_MEM);
+        res = esp_apptrace_metrics_event(reconnect);
+        TEST_ASSERT(res == ESP_OK || res == ESP_ERR_NO_MEM);
+    }
+}
+
+#if CONFIG_APPTRACE_METRICS_TASK_SWITCHES
+static uint32_t esp_apptrace_test_task_switches(void)
+{
+    uint32_t task_switches = 0;
+    for (int i = 0; i < CONFIG_FREERTOS_NUMBER_OF_CORES; i++) {
+        task_switches += esp_apptrace_metrics_task_switches[i];
+    }
+    return task_switches;
+}
+
+TEST_CASE("App trace metrics count the task switches", "[trace]")
+{
+    TEST_ESP_OK(esp_apptrace_metrics_init());
+    uint32_t before = esp_apptrace_test_task_switches();
+    // each delay switches to another task and back
+    for (int i = 0; i < 10; i++) {
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_GREATER_OR_EQUAL_UINT32(before + 20, esp_apptrace_test_task_switches());
+}
+#endif
+#endif
+
 #else // #if CONFIG_APPTRACE_SV_ENABLE == 0
 
 typedef struct {
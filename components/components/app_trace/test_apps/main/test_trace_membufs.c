@@ -0,0 +1,323 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdio.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "sdkconfig.h"
+#include "unity.h"
+#include "esp_timer.h"
+#include "driver/gptimer.h"
+#include "esp_rom_sys.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+#if CONFIG_APPTRACE_MEMBUFS_APPTRACE_PROTO_ENABLE
+#include "esp_app_trace_util.h"
+#include "esp_app_trace_membufs_proto.h"
+
+/* The membufs protocol is run on RAM blocks, its swap callbacks stand in for the host: they check each block
+ * exposed to the host, as OpenOCD would read it. There is a writer task on each core and a timer ISR writer.
+ * A block is reused as soon as the host has read the other one, so a task preempted while copying its data
+ * could find its chunk overwritten: there is one task per core, and blocks are larger than what the ISR writes. */
+
+#define ESP_APPTRACE_TEST_MEMBUFS_BLOCK_SIZE        4096
+#define ESP_APPTRACE_TEST_MEMBUFS_WRITERS           (CONFIG_FREERTOS_NUMBER_OF_CORES + 1)
+#define ESP_APPTRACE_TEST_MEMBUFS_ISR_PERIOD_US     50
+#define ESP_APPTRACE_TEST_MEMBUFS_CHUNKS            20000
+#define ESP_APPTRACE_TEST_MEMBUFS_BENCH_CHUNKS      100000
+
+/* chunk header, as in app_trace_membufs_proto.c */
+typedef struct {
+#if CONFIG_APPTRACE_SV_ENABLE
+    uint8_t   block_sz;
+    uint8_t   wr_sz;
+#else
+    uint16_t   block_sz;
+    uint16_t   wr_sz;
+#endif
+} esp_apptrace_test_chunk_hdr_t;
+
+#if CONFIG_APPTRACE_SV_ENABLE
+#define ESP_APPTRACE_TEST_CHUNK_LEN(_v_)            (_v_)
+#else
+#define ESP_APPTRACE_TEST_CHUNK_LEN(_v_)            ((_v_) & ~(1 << 15))
+#endif
+
+/* payload of the chunks, followed by bytes derived from the sequence number */
+typedef struct {
+    uint32_t seq;
+    uint8_t writer;
+} __attribute__((packed)) esp_apptrace_test_chunk_t;
+
+typedef struct {
+    esp_apptrace_membufs_proto_data_t proto;
+    esp_apptrace_lock_t lock;
+    uint8_t blocks[2][ESP_APPTRACE_TEST_MEMBUFS_BLOCK_SIZE];
+    // host side, only accessed with the lock held
+    uint32_t next_seq[ESP_APPTRACE_TEST_MEMBUFS_WRITERS];
+    uint32_t chunks;            // chunks read by the host
+    uint32_t incomplete;        // chunks whose data were not all written when the block was exposed
+    uint32_t errors;            // malformed, corrupt or out of order chunks
+} esp_apptrace_test_membufs_t;
+
+typedef struct {
+    int id;
+    uint32_t chunks;
+    bool lock_free;
+    SemaphoreHandle_t done;
+    uint32_t seq;
+    uint32_t written;
+    int64_t elapsed_us;
+} esp_apptrace_test_membufs_writer_t;
+
+static esp_apptrace_test_membufs_t *s_membufs;
+
+static esp_err_t esp_apptrace_test_membufs_swap_start(uint32_t curr_block_id)
+{
+    return ESP_OK;
+}
+
+static void esp_apptrace_test_membufs_error(const char *msg, uint32_t offset)
+{
+    if (s_membufs->errors++ < 5) {
+        esp_rom_printf("Host: %s at offset %" PRIu32 "\n", msg, offset);
+    }
+}
+
+/* Reads the block exposed to the host, the writers may still be copying their data to it */
+static esp_err_t esp_apptrace_test_membufs_swap(uint32_t new_block_id, uint32_t prev_block_len)
+{
+    const uint8_t *block = s_membufs->blocks[(new_block_id + 1) % 2];
+    uint32_t offset = 0;
+
+    while (offset < prev_block_len) {
+        const esp_apptrace_test_chunk_hdr_t *hdr = (const esp_apptrace_test_chunk_hdr_t *)(block + offset);
+        uint32_t len = ESP_APPTRACE_TEST_CHUNK_LEN(hdr->block_sz);
+        uint32_t wr_len = ESP_APPTRACE_TEST_CHUNK_LEN(__atomic_load_n(&hdr->wr_sz, __ATOMIC_ACQUIRE));
+        if (len < sizeof(esp_apptrace_test_chunk_t) || offset + sizeof(*hdr) + len > prev_block_len) {
+            esp_apptrace_test_membufs_error("malformed chunk header", offset);
+            return ESP_OK;
+        }
+        s_membufs->chunks++;
+        if (wr_len == 0) {
+            s_membufs->incomplete++;
+        } else if (wr_len != len) {
+            esp_apptrace_test_membufs_error("chunk length mismatch", offset);
+        } else {
+            const uint8_t *data = (const uint8_t *)(hdr + 1);
+            esp_apptrace_test_chunk_t chunk;
+            memcpy(&chunk, data, sizeof(chunk));
+            if (chunk.writer >= ESP_APPTRACE_TEST_MEMBUFS_WRITERS || chunk.seq < s_membufs->next_seq[chunk.writer]) {
+                esp_apptrace_test_membufs_error("chunk out of order", offset);
+            } else {
+                s_membufs->next_seq[chunk.writer] = chunk.seq + 1;
+                for (uint32_t i = sizeof(chunk); i < len; i++) {
+                    if (data[i] != (uint8_t)(chunk.seq + i)) {
+                        esp_apptrace_test_membufs_error("corrupt chunk data", offset);
+                        break;
+                    }
+                }
+            }
+        }
+        offset += sizeof(*hdr) + len;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t esp_apptrace_test_membufs_swap_end(uint32_t new_block_id, uint32_t prev_block_len)
+{
+    return ESP_OK;
+}
+
+static bool esp_apptrace_test_membufs_host_data_pending(void)
+{
+    return false;
+}
+
+static esp_apptrace_membufs_proto_hw_t s_membufs_hw = {
+    .swap_start = esp_apptrace_test_membufs_swap_start,
+    .swap = esp_apptrace_test_membufs_swap,
+    .swap_end = esp_apptrace_test_membufs_swap_end,
+    .host_data_pending = esp_apptrace_test_membufs_host_data_pending,
+};
+
+static void esp_apptrace_test_membufs_init(void)
+{
+    s_membufs = calloc(1, sizeof(*s_membufs));
+    TEST_ASSERT_NOT_NULL(s_membufs);
+    const esp_apptrace_mem_block_t blocks[2] = {
+        { .start = s_membufs->blocks[0], .sz = ESP_APPTRACE_TEST_MEMBUFS_BLOCK_SIZE },
+        { .start = s_membufs->blocks[1], .sz = ESP_APPTRACE_TEST_MEMBUFS_BLOCK_SIZE },
+    };
+    s_membufs->proto.hw = &s_membufs_hw;
+    TEST_ESP_OK(esp_apptrace_membufs_init(&s_membufs->proto, blocks));
+    esp_apptrace_lock_init(&s_membufs->lock);
+}
+
+/* Passes the remaining data to the host and checks that it got all the chunks written */
+static void esp_apptrace_test_membufs_deinit(uint32_t written)
+{
+    esp_apptrace_tmo_t tmo;
+    esp_apptrace_tmo_init(&tmo, ESP_APPTRACE_TMO_INFINITE);
+    TEST_ESP_OK(esp_apptrace_lock_take(&s_membufs->lock, &tmo));
+    TEST_ESP_OK(esp_apptrace_membufs_flush_nolock(&s_membufs->proto, 0, &tmo));
+    TEST_ESP_OK(esp_apptrace_lock_give(&s_membufs->lock));
+    TEST_ASSERT_EQUAL_UINT32(0, s_membufs->errors);
+    TEST_ASSERT_EQUAL_UINT32(written, s_membufs->chunks);
+    free(s_membufs);
+    s_membufs = NULL;
+}
+
+/* Writes a chunk as the JTAG port does: without lock if it fits in the current block, with the lock otherwise */
+static bool esp_apptrace_test_membufs_write(bool lock_free, const uint8_t *data, uint32_t size)
+{
+    esp_apptrace_tmo_t tmo;
+    uint8_t *ptr = lock_free ? esp_apptrace_membufs_up_buffer_reserve(&s_membufs->proto, size) : NULL;
+
+    esp_apptrace_tmo_init(&tmo, ESP_APPTRACE_TMO_INFINITE);
+    if (ptr == NULL) {
+        if (esp_apptrace_lock_take(&s_membufs->lock, &tmo) != ESP_OK) {
+            return false;
+        }
+        ptr = esp_apptrace_membufs_up_buffer_get(&s_membufs->proto, size, &tmo);
+        esp_apptrace_lock_give(&s_membufs->lock);
+        if (ptr == NULL) {
+            return false;
+        }
+    }
+    memcpy(ptr, data, size);
+    return esp_apptrace_membufs_up_buffer_put(&s_membufs->proto, ptr, &tmo) == ESP_OK;
+}
+
+/* Writes the next chunk of the writer, of 8 to 60 bytes so that the chunks of the writers are interleaved at any offset.
+ * Lengths are multiples of 4, like the data of the other tests, so that chunk headers are aligned. */
+static void esp_apptrace_test_membufs_write_next(esp_apptrace_test_membufs_writer_t *arg)
+{
+    uint8_t data[64];
+    esp_apptrace_test_chunk_t chunk = { .seq = arg->seq, .writer = arg->id };
+    uint32_t size = 8 + 4 * ((arg->seq * 7 + arg->id * 13) % 14);
+
+    memcpy(data, &chunk, sizeof(chunk));
+    for (uint32_t i = sizeof(chunk); i < size; i++) {
+        data[i] = arg->seq + i;
+    }
+    if (esp_apptrace_test_membufs_write(arg->lock_free, data, size)) {
+        arg->written++;
+    }
+    arg->seq++;
+}
+
+static bool esp_apptrace_test_membufs_timer_isr(gptimer_handle_t timer, const gptimer_alarm_event_data_t *edata, void *user_ctx)
+{
+    esp_apptrace_test_membufs_write_next((esp_apptrace_test_membufs_writer_t *)user_ctx);
+    return false;
+}
+
+static void esp_apptrace_test_membufs_writer_task(void *p)
+{
+    esp_apptrace_test_membufs_writer_t *arg = (esp_apptrace_test_membufs_writer_t *)p;
+
+    int64_t start = esp_timer_get_time();
+    while (arg->seq < arg->chunks) {
+        esp_apptrace_test_membufs_write_next(arg);
+    }
+    arg->elapsed_us = esp_timer_get_time() - start;
+    xSemaphoreGive(arg->done);
+    vTaskDelete(NULL);
+}
+
+/* Runs a writer task on each of the first num cores, returns the number of chunks they wrote */
+static uint32_t esp_apptrace_test_membufs_run(esp_apptrace_test_membufs_writer_t *writers, int num, uint32_t chunks, bool lock_free)
+{
+    uint32_t written = 0;
+
+    for (int i = 0; i < num; i++) {
+        writers[i] = (esp_apptrace_test_membufs_writer_t) {
+            .id = i,
+            .chunks = chunks,
+            .lock_free = lock_free,
+            .done = xSemaphoreCreateBinary(),
+        };
+        TEST_ASSERT_NOT_NULL(writers[i].done);
+    }
+    for (int i = 0; i < num; i++) {
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreatePinnedToCore(esp_apptrace_test_membufs_writer_task, "membufs", 2048, &writers[i], 3, NULL, i));
+    }
+    for (int i = 0; i < num; i++) {
+        xSemaphoreTake(writers[i].done, portMAX_DELAY);
+        vSemaphoreDelete(writers[i].done);
+        written += writers[i].written;
+    }
+    return written;
+}
+
+TEST_CASE("App trace membufs keep the chunks of concurrent writers whole and in order", "[trace]")
+{
+    esp_apptrace_test_membufs_writer_t writers[ESP_APPTRACE_TEST_MEMBUFS_WRITERS];
+    esp_apptrace_test_membufs_writer_t *isr_writer = &writers[CONFIG_FREERTOS_NUMBER_OF_CORES];
+    gptimer_handle_t gptimer;
+
+    esp_apptrace_test_membufs_init();
+    *isr_writer = (esp_apptrace_test_membufs_writer_t) {
+        .id = CONFIG_FREERTOS_NUMBER_OF_CORES,
+        .lock_free = true,
+    };
+    gptimer_config_t timer_config = {
+        .clk_src = GPTIMER_CLK_SRC_DEFAULT,
+        .direction = GPTIMER_COUNT_UP,
+        .resolution_hz = 1000000,
+    };
+    gptimer_alarm_config_t alarm_config = {
+        .alarm_count = ESP_APPTRACE_TEST_MEMBUFS_ISR_PERIOD_US,
+        .flags.auto_reload_on_alarm = true,
+    };
+    gptimer_event_callbacks_t cbs = {
+        .on_alarm = esp_apptrace_test_membufs_timer_isr,
+    };
+    TEST_ESP_OK(gptimer_new_timer(&timer_config, &gptimer));
+    TEST_ESP_OK(gptimer_register_event_callbacks(gptimer, &cbs, isr_writer));
+    TEST_ESP_OK(gptimer_enable(gptimer));
+    TEST_ESP_OK(gptimer_set_alarm_action(gptimer, &alarm_config));
+    TEST_ESP_OK(gptimer_start(gptimer));
+
+    uint32_t written = esp_apptrace_test_membufs_run(writers, CONFIG_FREERTOS_NUMBER_OF_CORES, ESP_APPTRACE_TEST_MEMBUFS_CHUNKS, true);
+
+    TEST_ESP_OK(gptimer_stop(gptimer));
+    TEST_ESP_OK(gptimer_disable(gptimer));
+    TEST_ESP_OK(gptimer_del_timer(gptimer));
+    // blocks are always swapped, so no write fails
+    TEST_ASSERT_EQUAL_UINT32(CONFIG_FREERTOS_NUMBER_OF_CORES * ESP_APPTRACE_TEST_MEMBUFS_CHUNKS, written);
+    TEST_ASSERT_GREATER_THAN_UINT32(0, isr_writer->written);
+    TEST_ASSERT_EQUAL_UINT32(isr_writer->seq, isr_writer->written);
+    written += isr_writer->written;
+    printf("%" PRIu32 " chunks, %" PRIu32 " from the ISR, %" PRIu32 " still being written when their block was exposed\n",
+           written, isr_writer->written, s_membufs->incomplete);
+    esp_apptrace_test_membufs_deinit(written);
+}
+TEST_CASE("App trace membufs writer time with and without lock", "[trace]")
+{
+    esp_apptrace_test_membufs_writer_t writers[CONFIG_FREERTOS_NUMBER_OF_CORES];
+
+    printf("%-10s %-10s %12s\n", "Writers", "Path", "ns/chunk");
+    for (int num = 1; num <= CONFIG_FREERTOS_NUMBER_OF_CORES; num++) {
+        for (int lock_free = 0; lock_free <= 1; lock_free++) {
+            esp_apptrace_test_membufs_init();
+            uint32_t written = esp_apptrace_test_membufs_run(writers, num, ESP_APPTRACE_TEST_MEMBUFS_BENCH_CHUNKS, lock_free);
+            int64_t elapsed_us = 0;
+            for (int i = 0; i < num; i++) {
+                elapsed_us = MAX(elapsed_us, writers[i].elapsed_us);
+            }
+            printf("%-10d %-10s %12" PRIu32 "\n", num, lock_free ? "lock-free" : "locked",
+                   (uint32_t)(elapsed_us * 1000 / ESP_APPTRACE_TEST_MEMBUFS_BENCH_CHUNKS));
+            esp_apptrace_test_membufs_deinit(written);
+        }
+    }
+}
+#endif // CONFIG_APPTRACE_MEMBUFS_APPTRACE_PROTO_ENABLE
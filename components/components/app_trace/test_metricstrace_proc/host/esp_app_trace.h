@@ -0,0 +1,17 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stdint.h>
+#include "esp_err.h"
+
+typedef enum {
+    ESP_APPTRACE_DEST_JTAG,
+    ESP_APPTRACE_DEST_UART,
+} esp_apptrace_dest_t;
+
+esp_err_t esp_apptrace_write(esp_apptrace_dest_t dest, const void *data, uint32_t size, uint32_t tmo);
+esp_err_t esp_apptrace_flush(esp_apptrace_dest_t dest, uint32_t tmo);
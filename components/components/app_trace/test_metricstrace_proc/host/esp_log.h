@@ -0,0 +1,9 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#define ESP_LOGE(tag, format, ...)  ((void)(tag))
+#define ESP_LOGD(tag, format, ...)  ((void)(tag))
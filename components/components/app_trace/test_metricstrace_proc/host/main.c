@@ -0,0 +1,163 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/*
+ * Host driver of test_metricstrace_proc.py: records a fixed pseudo-random sequence through app_trace_metrics.c,
+ * writes the packets it sends to the file given as first argument and prints what was sent:
+ *   P <seq> <offset> <written>           for every packet, offset being the position of written packets in the file
+ *   R <seq> <ts> <name> <value>          for every record, seq being the packet holding it, '-' as value of events
+ * The packets whose sequence numbers are listed in the second argument (comma separated) are dropped.
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include "app_trace_metrics.c"
+
+#define TEST_RECORDS        2000
+#define TEST_LATE_REGISTER  1500
+
+static FILE *s_out;
+static long s_offset;
+static int64_t s_now;
+static const char *s_drop;
+static uint64_t s_rand = 1;
+
+int64_t esp_timer_get_time(void)
+{
+    return s_now;
+}
+
+static bool test_dropped(uint32_t seq)
+{
+    for (const char *p = s_drop; *p; p++) {
+        char *end;
+        if (strtoul(p, &end, 10) == seq) {
+            return true;
+        }
+        p = end;
+        if (*p == 0) {
+            break;
+        }
+    }
+    return false;
+}
+
+esp_err_t esp_apptrace_write(esp_apptrace_dest_t dest, const void *data, uint32_t size, uint32_t tmo)
+{
+    bool written = !test_dropped(s_metrics.seq);
+    printf("P %" PRIu32 " %ld %d\n", s_metrics.seq, s_offset, written);
+    if (!written) {
+        return ESP_ERR_NO_MEM;
+    }
+    fwrite(data, 1, size, s_out);
+    s_offset += size;
+    return ESP_OK;
+}
+
+esp_err_t esp_apptrace_flush(esp_apptrace_dest_t dest, uint32_t tmo)
+{
+    return ESP_OK;
+}
+
+static uint64_t test_rand(void)
+{
+    s_rand = s_rand * 6364136223846793005ULL + 1442695040888963407ULL;
+    return s_rand >> 11 | s_rand << 53;
+}
+
+static void test_record(esp_apptrace_metric_t metric, int64_t value, float fvalue)
+{
+    const esp_apptrace_metric_desc_t *desc = &s_metrics.metrics[metric];
+    esp_err_t res;
+    char text[32];
+
+    switch (desc->type) {
+    case ESP_APPTRACE_METRIC_UINT:
+        res = esp_apptrace_metrics_record(metric, value);
+        snprintf(text, sizeof(text), "%" PRIu64, (uint64_t)value);
+        break;
+    case ESP_APPTRACE_METRIC_FLOAT:
+        res = esp_apptrace_metrics_record_float(metric, fvalue);
+        snprintf(text, sizeof(text), "%.9g", fvalue);
+        break;
+    case ESP_APPTRACE_METRIC_EVENT:
+        res = esp_apptrace_metrics_event(metric);
+        snprintf(text, sizeof(text), "-");
+        break;
+    default:
+        res = esp_apptrace_metrics_record(metric, value);
+        snprintf(text, sizeof(text), "%" PRId64, value);
+        break;
+    }
+    if (res != ESP_OK && res != ESP_ERR_NO_MEM) {
+        fprintf(stderr, "Record of %s failed (0x%x)\n", desc->name, res);
+        exit(1);
+    }
+    printf("R %" PRIu32 " %" PRId64 " %s %s\n", s_metrics.seq, s_now, desc->name, text);
+}
+
+int main(int argc, char **argv)
+{
+    esp_apptrace_metric_t metrics[6];
+    int64_t counter = 0;
+
+    if (argc != 3) {
+        fprintf(stderr, "Usage: %s <capture> <dropped packets>\n", argv[0]);
+        return 2;
+    }
+    s_out = fopen(argv[1], "wb");
+    if (s_out == NULL) {
+        perror(argv[1]);
+        return 2;
+    }
+    s_drop = argv[2];
+    s_now = 1000000;
+
+    if (esp_apptrace_metrics_init() != ESP_OK ||
+        esp_apptrace_metrics_register("q.depth", "items", ESP_APPTRACE_METRIC_UINT, &metrics[0]) != ESP_OK ||
+        esp_apptrace_metrics_register("temp.delta", "mC", ESP_APPTRACE_METRIC_INT, &metrics[1]) != ESP_OK ||
+        esp_apptrace_metrics_register("rx.packets", "pkts", ESP_APPTRACE_METRIC_COUNTER, &metrics[2]) != ESP_OK ||
+        esp_apptrace_metrics_register("cpu.load", "%", ESP_APPTRACE_METRIC_FLOAT, &metrics[3]) != ESP_OK ||
+        esp_apptrace_metrics_register("wifi.reconnect", NULL, ESP_APPTRACE_METRIC_EVENT, &metrics[4]) != ESP_OK) {
+        fprintf(stderr, "Failed to register the metrics\n");
+        return 1;
+    }
+    int count = 5;
+    for (int i = 0; i < TEST_RECORDS; i++) {
+        if (i == TEST_LATE_REGISTER) {
+            if (esp_apptrace_metrics_register("late.gauge", NULL, ESP_APPTRACE_METRIC_INT, &metrics[count++]) != ESP_OK) {
+                fprintf(stderr, "Failed to register the late metric\n");
+                return 1;
+            }
+        }
+        // mostly small steps, from time to time a long gap or records taken in the same microsecond
+        uint64_t r = test_rand();
+        s_now += r % 16 == 0 ? (int64_t)(test_rand() % 1000000000) : r % 16 == 1 ? 0 : (int64_t)(test_rand() % 1000);
+        esp_apptrace_metric_t metric = metrics[test_rand() % count];
+        int64_t value = 0;
+        float fvalue = 0;
+        switch (s_metrics.metrics[metric].type) {
+        case ESP_APPTRACE_METRIC_UINT:
+            value = (int64_t)(test_rand() >> (test_rand() % 64));
+            break;
+        case ESP_APPTRACE_METRIC_INT:
+            value = (int64_t)test_rand() >> (test_rand() % 64);
+            break;
+        case ESP_APPTRACE_METRIC_COUNTER:
+            counter += test_rand() % 32 == 0 ? (int64_t)(test_rand() >> 20) : (int64_t)(test_rand() % 20) - 3;
+            value = counter;
+            break;
+        case ESP_APPTRACE_METRIC_FLOAT:
+            fvalue = (float)((int64_t)test_rand() >> 40) / 1000.0f;
+            break;
+        default:
+            break;
+        }
+        test_record(metric, value, fvalue);
+    }
+    esp_err_t res = esp_apptrace_metrics_flush(0);
+    fclose(s_out);
+    return res == ESP_OK || res == ESP_ERR_NO_MEM ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+/* Configuration of app_trace_metrics.c built on the host by test_metricstrace_proc.py:
+ * small packets and a short schema interval, so that a short run spans many packets and schema rounds */
+#pragma once
+
+#define CONFIG_APPTRACE_METRICS_ENABLE              1
+#define CONFIG_APPTRACE_METRICS_DEST_JTAG           1
+#define CONFIG_APPTRACE_METRICS_MAX                 8
+#define CONFIG_APPTRACE_METRICS_BUF_SIZE            128
+#define CONFIG_APPTRACE_METRICS_SCHEMA_INTERVAL     8
+#define CONFIG_APPTRACE_METRICS_SYS_PERIOD_MS       0
@@ -0,0 +1,122 @@
+#!/usr/bin/env python
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import os
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+try:
+    import metricstrace_proc
+except ImportError:
+    raise
+
+TEST_DIR = os.path.dirname(os.path.abspath(__file__))
+COMPONENT_DIR = os.path.dirname(TEST_DIR)
+
+
+class MetricsRoundTripTest(unittest.TestCase):
+    """ Encodes records with app_trace_metrics.c built for the host (see host/main.c) and decodes them back """
+
+    @classmethod
+    def setUpClass(cls):  # type: () -> None
+        cc = os.environ.get('CC', 'cc')
+        if shutil.which(cc) is None:
+            raise unittest.SkipTest('No C compiler to build the metrics encoder')
+        cls.tmpdir = tempfile.mkdtemp()
+        cls.driver = os.path.join(cls.tmpdir, 'metrics_host')
+        subprocess.check_call([cc, '-std=gnu11', '-Wall', '-Werror',
+                               '-I', os.path.join(TEST_DIR, 'host'), '-I', COMPONENT_DIR,
+                               '-I', os.path.join(COMPONENT_DIR, 'include'),
+                               os.path.join(TEST_DIR, 'host', 'main.c'), '-o', cls.driver])
+
+    @classmethod
+    def tearDownClass(cls):  # type: () -> None
+        shutil.rmtree(cls.tmpdir)
+
+    def encode(self, dropped=()):  # type: (tuple) -> tuple
+        """ Returns the capture, the packets {seq: (offset, written)} and the records [(seq, ts, name, value)] """
+        capture = os.path.join(self.tmpdir, 'metrics.bin')
+        out = subprocess.check_output([self.driver, capture, ','.join(str(seq) for seq in dropped)])
+        packets = {}
+        records = []
+        for line in out.decode().splitlines():
+            fields = line.split()
+            if fields[0] == 'P':
+                packets[int(fields[1])] = (int(fields[2]), fields[3] == '1')
+            else:
+                records.append((int(fields[1]), int(fields[2]), fields[3], fields[4]))
+        with open(capture, 'rb') as f:
+            return bytearray(f.read()), packets, records
+
+    def check_samples(self, samples, records):  # type: (list, list) -> None
+        self.assertEqual(len(records), len(samples))
+        for (ts, name, _, mtype, value), (_, rec_ts, rec_name, rec_value) in zip(samples, records):
+            self.assertEqual((rec_ts, rec_name), (ts, name))
+            if mtype == metricstrace_proc.TYPE_EVENT:
+                self.assertEqual('-', rec_value)
+                self.assertIsNone(value)
+            elif mtype == metricstrace_proc.TYPE_FLOAT:
+                # the encoder prints the single precision value with all its digits
+                self.assertEqual(struct.pack('<f', float(rec_value)), struct.pack('<f', value))
+            else:
+                self.assertEqual(int(rec_value), value, name)
+
+    def test_round_trip(self):  # type: () -> None
+        data, packets, records = self.encode()
+        decoder = metricstrace_proc.Decoder()
+        self.check_samples(list(decoder.decode(data)), records)
+        self.assertEqual(len(packets), decoder.packets)
+        self.assertEqual(0, decoder.lost_packets)
+        self.assertEqual(0, decoder.skipped_bytes)
+        self.assertEqual(0, decoder.unknown_records)
+        self.assertEqual({'', 'items', 'mC', 'pkts', '%'}, set(unit for _, unit, _ in decoder.schemas.values()))
+
+    def test_dropped_packets(self):  # type: () -> None
+        # packet 0 holds the first schemas, they are sent again before the next record
+        dropped = (0, 5, 6, 40)
+        data, packets, records = self.encode(dropped)
+        for seq in dropped:
+            self.assertFalse(packets[seq][1])
+        decoder = metricstrace_proc.Decoder()
+        self.check_samples(list(decoder.decode(data)), [r for r in records if packets[r[0]][1]])
+        # the decoder can not know that the first packet was lost
+        self.assertEqual(len(dropped) - 1, decoder.lost_packets)
+        self.assertEqual(0, decoder.unknown_records)
+
+    def test_capture_started_late(self):  # type: () -> None
+        data, packets, records = self.encode()
+        # the capture starts with a packet whose metrics are unknown, and is decoded from the next round of schemas
+        start = 3
+        first = None
+        for seq in sorted(packets):
+            if seq <= start:
+                continue
+            reader = metricstrace_proc.Reader(data, packets[seq][0] + 3, len(data))
+            reader.varint()
+            reader.varint()
+            reader.varint()
+            if reader.varint() & 1:
+                first = seq
+                break
+        self.assertIsNotNone(first)
+        decoder = metricstrace_proc.Decoder()
+        self.check_samples(list(decoder.decode(data[packets[start][0]:])), [r for r in records if r[0] >= first])
+        self.assertEqual(first - start, decoder.unknown_records)
+
+    def test_command_line(self):  # type: () -> None
+        data, _, records = self.encode()
+        capture = os.path.join(self.tmpdir, 'metrics.bin')
+        out = subprocess.check_output([sys.executable, os.path.join(COMPONENT_DIR, 'metricstrace_proc.py'), '--csv',
+                                       '--quiet', capture]).decode().splitlines()
+        self.assertEqual('timestamp_us,metric,unit,value', out[0])
+        self.assertEqual(len(records), len(out) - 1)
+        self.assertEqual(str(records[0][1]), out[1].split(',')[0])
+
+
+if __name__ == '__main__':
+    unittest.main()
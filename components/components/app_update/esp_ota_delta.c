@@ -0,0 +1,290 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <inttypes.h>
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+#include "esp_ota_delta.h"
+#include "sys/param.h"
+
+/* The new image is gathered in this buffer before being written, so that it is written in large pieces
+ * however short the operations of the delta are. It also holds the header until it is complete. */
+#define DELTA_BUF_SIZE      1024
+
+/* A varint of the delta holds at most 35 bits: a 32 bit length and the copy flag, or a zigzag 33 bit distance */
+#define DELTA_VARINT_MAX_SHIFT  35
+
+static const char *TAG = "esp_ota_delta";
+
+typedef enum {
+    DELTA_HEADER,           /*!< Receiving the header */
+    DELTA_OP,               /*!< Receiving the length of the next operation */
+    DELTA_DISTANCE,         /*!< Receiving the distance of a copy */
+    DELTA_INSERT,           /*!< Receiving the literal bytes of an insert */
+    DELTA_DONE,             /*!< The new image is complete */
+} delta_state_t;
+
+struct esp_ota_delta {
+    esp_ota_handle_t ota_handle;
+    esp_ota_delta_write_cb_t write_cb;  /*!< Writes the new image instead of esp_ota_write() if set */
+    void *user_ctx;
+    const esp_partition_t *base;
+    delta_state_t state;
+    esp_err_t err;              /*!< First error, returned by all the following calls */
+    uint32_t base_size;
+    uint32_t image_size;
+    uint32_t image_offset;      /*!< Bytes of the new image produced, including the ones still in buf */
+    uint32_t base_offset;       /*!< End of the previous copy in the base image */
+    uint32_t op_len;            /*!< Bytes left in the current operation */
+    uint64_t varint;
+    unsigned varint_shift;
+    size_t buf_len;
+    uint8_t buf[DELTA_BUF_SIZE];
+};
+
+_Static_assert(DELTA_BUF_SIZE >= ESP_OTA_DELTA_HEADER_SIZE, "Delta buffer must hold the header");
+
+esp_err_t esp_ota_delta_begin(esp_ota_handle_t ota_handle, const esp_partition_t *base, esp_ota_delta_handle_t *out_handle)
+{
+    if (out_handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (base == NULL) {
+        base = esp_ota_get_running_partition();
+        if (base == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+    }
+    struct esp_ota_delta *delta = calloc(1, sizeof(struct esp_ota_delta));
+    if (delta == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    delta->ota_handle = ota_handle;
+    delta->base = base;
+    delta->state = DELTA_HEADER;
+    *out_handle = delta;
+    return ESP_OK;
+}
+
+esp_err_t esp_ota_delta_set_write_cb(esp_ota_delta_handle_t handle, esp_ota_delta_write_cb_t write_cb, void *user_ctx)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->state != DELTA_HEADER || handle->buf_len != 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    handle->write_cb = write_cb;
+    handle->user_ctx = user_ctx;
+    return ESP_OK;
+}
+
+static uint32_t get_u32(const uint8_t *p)
+{
+    return p[0] | (p[1] << 8) | (p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static esp_err_t delta_parse_header(struct esp_ota_delta *delta)
+{
+    const uint8_t *header = delta->buf;
+    if (get_u32(header) != ESP_OTA_DELTA_MAGIC) {
+        ESP_LOGE(TAG, "Not a delta, magic 0x%08" PRIx32, get_u32(header));
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (header[4] != ESP_OTA_DELTA_VERSION) {
+        ESP_LOGE(TAG, "Delta version %d is not supported", header[4]);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    delta->base_size = get_u32(header + 8);
+    delta->image_size = get_u32(header + 12);
+    if (delta->base_size > delta->base->size) {
+        ESP_LOGE(TAG, "Base image of the delta (%" PRIu32 " bytes) is larger than partition %s", delta->base_size, delta->base->label);
+        return ESP_ERR_OTA_DELTA_BASE_MISMATCH;
+    }
+    uint8_t sha_256[32];
+    esp_err_t err = esp_partition_get_sha256(delta->base, sha_256);
+    if (err != ESP_OK || memcmp(sha_256, header + 16, sizeof(sha_256)) != 0) {
+        ESP_LOGE(TAG, "Partition %s does not hold the base image of the delta", delta->base->label);
+        return ESP_ERR_OTA_DELTA_BASE_MISMATCH;
+    }
+    ESP_LOGD(TAG, "Delta from a %" PRIu32 " byte image to a %" PRIu32 " byte image", delta->base_size, delta->image_size);
+    return ESP_OK;
+}
+
+static esp_err_t delta_flush(struct esp_ota_delta *delta)
+{
+    esp_err_t err = ESP_OK;
+    if (delta->buf_len) {
+        if (delta->write_cb) {
+            err = delta->write_cb(delta->buf, delta->buf_len, delta->user_ctx);
+        } else {
+            err = esp_ota_write(delta->ota_handle, delta->buf, delta->buf_len);
+        }
+        delta->buf_len = 0;
+    }
+    return err;
+}
+
+/* Appends len bytes of the new image, taken from data or, if data is NULL, from the base image at base_offset */
+static esp_err_t delta_output(struct esp_ota_delta *delta, const uint8_t *data, uint32_t base_offset, size_t len)
+{
+    while (len > 0) {
+        size_t n = MIN(len, DELTA_BUF_SIZE - delta->buf_len);
+        esp_err_t err;
+        if (data) {
+            memcpy(delta->buf + delta->buf_len, data, n);
+            data += n;
+        } else {
+            err = esp_partition_read(delta->base, base_offset, delta->buf + delta->buf_len, n);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Reading the base image failed (0x%x)", err);
+                return err;
+            }
+            base_offset += n;
+        }
+        delta->buf_len += n;
+        len -= n;
+        if (delta->buf_len == DELTA_BUF_SIZE) {
+            err = delta_flush(delta);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return ESP_OK;
+}
+
+/* Feeds a byte to the varint being received, returns true once it is complete */
+static bool delta_varint(struct esp_ota_delta *delta, uint8_t byte, esp_err_t *err)
+{
+    if (delta->varint_shift == 0) {
+        delta->varint = 0;
+    }
+    delta->varint |= (uint64_t)(byte & 0x7f) << delta->varint_shift;
+    delta->varint_shift += 7;
+    if (byte & 0x80) {
+        if (delta->varint_shift >= DELTA_VARINT_MAX_SHIFT) {
+            ESP_LOGE(TAG, "Malformed delta, varint too long");
+            *err = ESP_ERR_INVALID_ARG;
+        }
+        return false;
+    }
+    delta->varint_shift = 0;
+    return true;
+}
+
+static void delta_next_op(struct esp_ota_delta *delta)
+{
+    delta->state = (delta->image_offset == delta->image_size) ? DELTA_DONE : DELTA_OP;
+}
+
+static esp_err_t delta_apply(struct esp_ota_delta *delta, const uint8_t *data, size_t size)
+{
+    esp_err_t err = ESP_OK;
+
+    while (size > 0 && err == ESP_OK) {
+        switch (delta->state) {
+        case DELTA_HEADER: {
+            size_t n = MIN(size, ESP_OTA_DELTA_HEADER_SIZE - delta->buf_len);
+            memcpy(delta->buf + delta->buf_len, data, n);
+            delta->buf_len += n;
+            data += n;
+            size -= n;
+            if (delta->buf_len == ESP_OTA_DELTA_HEADER_SIZE) {
+                delta->buf_len = 0;
+                err = delta_parse_header(delta);
+                delta_next_op(delta);
+            }
+            break;
+        }
+        case DELTA_OP:
+            if (delta_varint(delta, *data++, &err)) {
+                uint64_t len = delta->varint >> 1;
+                if (len == 0 || len > delta->image_size - delta->image_offset) {
+                    ESP_LOGE(TAG, "Malformed delta, operation of %" PRIu64 " bytes at image offset %" PRIu32, len, delta->image_offset);
+                    err = ESP_ERR_INVALID_ARG;
+                    break;
+                }
+                delta->op_len = len;
+                delta->state = (delta->varint & 1) ? DELTA_DISTANCE : DELTA_INSERT;
+            }
+            size--;
+            break;
+        case DELTA_DISTANCE:
+            if (delta_varint(delta, *data++, &err)) {
+                int64_t distance = (int64_t)(delta->varint >> 1) ^ -(int64_t)(delta->varint & 1);
+                int64_t offset = (int64_t)delta->base_offset + distance;
+                if (offset < 0 || offset + delta->op_len > delta->base_size) {
+                    ESP_LOGE(TAG, "Malformed delta, copy of %" PRIu32 " bytes from base offset %" PRId64, delta->op_len, offset);
+                    err = ESP_ERR_INVALID_ARG;
+                    break;
+                }
+                err = delta_output(delta, NULL, offset, delta->op_len);
+                delta->base_offset = offset + delta->op_len;
+                delta->image_offset += delta->op_len;
+                delta_next_op(delta);
+            }
+            size--;
+            break;
+        case DELTA_INSERT: {
+            size_t n = MIN(size, delta->op_len);
+            err = delta_output(delta, data, 0, n);
+            data += n;
+            size -= n;
+            delta->op_len -= n;
+            delta->image_offset += n;
+            if (delta->op_len == 0) {
+                delta_next_op(delta);
+            }
+            break;
+        }
+        case DELTA_DONE:
+            ESP_LOGE(TAG, "Malformed delta, %u bytes after the end of the image", (unsigned)size);
+            err = ESP_ERR_INVALID_ARG;
+            break;
+        }
+    }
+    if (err == ESP_OK && delta->state == DELTA_DONE) {
+        err = delta_flush(delta);
+    }
+    return err;
+}
+
+esp_err_t esp_ota_delta_write(esp_ota_delta_handle_t handle, const void *data, size_t size)
+{
+    if (handle == NULL || (data == NULL && size > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (handle->err == ESP_OK) {
+        handle->err = delta_apply(handle, data, size);
+    }
+    return handle->err;
+}
+
+esp_err_t esp_ota_delta_end(esp_ota_delta_handle_t handle)
+{
+    if (handle == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = handle->err;
+    if (err == ESP_OK && handle->state != DELTA_DONE) {
+        ESP_LOGE(TAG, "Delta incomplete, %" PRIu32 " of %" PRIu32 " bytes of the image", handle->image_offset, handle->image_size);
+        err = ESP_ERR_INVALID_SIZE;
+    }
+    free(handle);
+    return err;
+}
+
+void esp_ota_delta_abort(esp_ota_delta_handle_t handle)
+{
+    free(handle);
+}
@@ -32,6 +32,7 @@
 #include "esp_bootloader_desc.h"
 #include "esp_flash.h"
 #include "esp_flash_internal.h"
+#include "esp_private/esp_ota_private.h"
 
 #define SUB_TYPE_ID(i) (i & 0x0F)
 #define ALIGN_UP(num, align) (((num) + ((align) - 1)) & ~((align) - 1))
@@ -48,6 +49,7 @@ typedef struct ota_ops_entry_ {
     uint32_t wrote_size;
     uint8_t partial_bytes;
     bool ota_resumption;
+    esp_image_stream_t *image_stream;        /*!< Image hashed as it is written, NULL unless written sequentially from the start */
     WORD_ALIGNED_ATTR uint8_t partial_data[16];
     LIST_ENTRY(ota_ops_entry_) entries;
 } ota_ops_entry_t;
@@ -57,10 +59,20 @@ static LIST_HEAD(ota_ops_entries_head, ota_ops_entry_) s_ota_ops_entries_head =
 
 static uint32_t s_ota_ops_last_handle = 0;
 
+/* App partition verified by esp_ota_end() with the hashes calculated while it was written,
+ * esp_ota_set_boot_partition() does not verify it again */
+static const esp_partition_t *s_stream_verified_partition = NULL;
+
 const static char *TAG = "esp_ota_ops";
 
 static ota_ops_entry_t *get_ota_ops_entry(esp_ota_handle_t handle);
 
+static void ota_drop_image_stream(ota_ops_entry_t *it)
+{
+    esp_image_stream_abort(it->image_stream);
+    it->image_stream = NULL;
+}
+
 /* Return true if this is an OTA app partition */
 static bool is_ota_partition(const esp_partition_t *p)
 {
@@ -129,6 +141,9 @@ static ota_ops_entry_t* esp_ota_init_entry(const esp_partition_t *partition)
 
     LIST_INSERT_HEAD(&s_ota_ops_entries_head, new_entry, entries);
 
+    if (partition == s_stream_verified_partition) {
+        s_stream_verified_partition = NULL;
+    }
     new_entry->partition.staging = partition;
     new_entry->partition.final = partition;
     new_entry->partition.finalize_with_copy = false;
@@ -280,6 +295,9 @@ esp_err_t esp_ota_set_final_partition(esp_ota_handle_t handle, const esp_partiti
             return ESP_ERR_NOT_FOUND;
         }
         ESP_LOGI(TAG,"Staging partition - <%s>. Final partition - <%s>.", it->partition.staging->label, final_partition->label);
+        if (final_partition == s_stream_verified_partition) {
+            s_stream_verified_partition = NULL;
+        }
         it->partition.final = final_partition;
         it->partition.finalize_with_copy = finalize_with_copy;
         if (final_partition->type == ESP_PARTITION_TYPE_BOOTLOADER) {
@@ -333,6 +351,10 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
                         ESP_LOGE(TAG, "OTA image has invalid magic byte (expected 0xE9, saw 0x%02x)", data_bytes[0]);
                         return ESP_ERR_OTA_VALIDATE_FAILED;
                     }
+                    if (!it->ota_resumption) {
+                        ota_drop_image_stream(it);
+                        it->image_stream = esp_image_stream_start();
+                    }
 
                 } else if (it->partition.final->type == ESP_PARTITION_TYPE_PARTITION_TABLE) {
                     if (*(uint16_t*)data_bytes != (uint16_t)ESP_PARTITION_MAGIC) {
@@ -342,6 +364,9 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
                 }
             }
 
+            /* Hash the data before the flash encryption caching, the stream is dropped if a write fails */
+            esp_image_stream_data(it->image_stream, data_bytes, size);
+
             if (esp_flash_encryption_enabled()) {
                 /* Can only write 16 byte blocks to flash, so need to cache anything else */
                 size_t copy_len;
@@ -357,6 +382,7 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
                     /* write 16 byte to partition */
                     ret = esp_partition_write(it->partition.staging, it->wrote_size, it->partial_data, 16);
                     if (ret != ESP_OK) {
+                        ota_drop_image_stream(it);
                         return ret;
                     }
                     it->partial_bytes = 0;
@@ -377,6 +403,8 @@ esp_err_t esp_ota_write(esp_ota_handle_t handle, const void *data, size_t size)
             ret = esp_partition_write(it->partition.staging, it->wrote_size, data_bytes, size);
             if(ret == ESP_OK){
                 it->wrote_size += size;
+            } else {
+                ota_drop_image_stream(it);
             }
             return ret;
         }
@@ -411,6 +439,8 @@ esp_err_t esp_ota_write_with_offset(esp_ota_handle_t handle, const void *data, s
                 ESP_LOGE(TAG, "Size should be 16byte aligned for flash encryption case");
                 return ESP_ERR_INVALID_ARG;
             }
+            // The image is no longer written sequentially, esp_ota_end() verifies it from flash
+            ota_drop_image_stream(it);
             ret = esp_partition_write(it->partition.staging, offset, data_bytes, size);
             if (ret == ESP_OK) {
                 it->wrote_size += size;
@@ -442,6 +472,7 @@ esp_err_t esp_ota_abort(esp_ota_handle_t handle)
     if (it == NULL) {
         return ESP_ERR_NOT_FOUND;
     }
+    ota_drop_image_stream(it);
     LIST_REMOVE(it, entries);
     free(it);
     return ESP_OK;
@@ -456,9 +487,16 @@ static esp_err_t ota_verify_partition(ota_ops_entry_t *ota_ops)
             .offset = ota_ops->partition.staging->address,
             .size = ota_ops->partition.staging->size,
         };
-        if (esp_image_verify(ESP_IMAGE_VERIFY, &part_pos, &data) != ESP_OK) {
+        // Only re-reads the segment data if the image was not hashed while it was written
+        bool streamed;
+        esp_err_t err = esp_image_stream_verify(ota_ops->image_stream, ESP_IMAGE_VERIFY, &part_pos, &data, &streamed);
+        ota_ops->image_stream = NULL;
+        if (err != ESP_OK) {
             return ESP_ERR_OTA_VALIDATE_FAILED;
         }
+        if (streamed && ota_ops->partition.final->type == ESP_PARTITION_TYPE_APP && !ota_ops->partition.finalize_with_copy) {
+            s_stream_verified_partition = ota_ops->partition.final;
+        }
     } else if (ota_ops->partition.final->type == ESP_PARTITION_TYPE_PARTITION_TABLE) {
         const esp_partition_info_t *partition_table = NULL;
         esp_partition_mmap_handle_t partition_table_map;
@@ -518,6 +556,7 @@ esp_err_t esp_ota_end(esp_ota_handle_t handle)
         // In esp_ota_begin, bootloader offset was updated, here we return it to default.
         esp_image_bootloader_offset_set(ESP_PRIMARY_BOOTLOADER_OFFSET);
     }
+    ota_drop_image_stream(it);
     LIST_REMOVE(it, entries);
     free(it);
     return ret;
@@ -596,13 +635,22 @@ static esp_err_t esp_rewrite_ota_data(esp_partition_subtype_t subtype)
     }
 }
 
+bool esp_ota_partition_is_stream_verified(const esp_partition_t *partition)
+{
+    return partition != NULL && partition == s_stream_verified_partition;
+}
+
 esp_err_t esp_ota_set_boot_partition(const esp_partition_t *partition)
 {
     if (partition == NULL) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (image_validate(partition, ESP_IMAGE_VERIFY) != ESP_OK) {
+    // An image just verified by esp_ota_end() is not read back from flash again
+    if (partition == s_stream_verified_partition) {
+        ESP_LOGD(TAG, "Image of <%s> was verified while it was written", partition->label);
+        s_stream_verified_partition = NULL;
+    } else if (image_validate(partition, ESP_IMAGE_VERIFY) != ESP_OK) {
         return ESP_ERR_OTA_VALIDATE_FAILED;
     }
 
@@ -1071,6 +1119,9 @@ static esp_err_t erase_last_boot_app_partition(bool skip_app_part_erase)
     }
 
     if (!skip_app_part_erase) {
+        if (last_boot_app_partition_from_otadata == s_stream_verified_partition) {
+            s_stream_verified_partition = NULL;
+        }
         esp_err_t err = esp_partition_erase_range(last_boot_app_partition_from_otadata, 0, last_boot_app_partition_from_otadata->size);
         if (err != ESP_OK) {
             return err;
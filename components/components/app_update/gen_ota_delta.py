@@ -0,0 +1,208 @@
+#!/usr/bin/env python
+#
+# gen_ota_delta generates the delta from an app image to a newer one, which
+# esp_ota_delta_write() applies to the running app to rebuild the newer image
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+from __future__ import division, print_function
+
+import argparse
+import hashlib
+import struct
+import sys
+
+__version__ = '1.0'
+
+DELTA_MAGIC = 0x444f5345
+DELTA_VERSION = 1
+DELTA_HEADER = struct.Struct('<IB3xII32s')
+
+ESP_IMAGE_MAGIC = 0xe9
+ESP_IMAGE_HEADER_LEN = 24
+ESP_IMAGE_SEGMENT_HEADER_LEN = 8
+HASH_LEN = 32
+
+# Bytes hashed to find copies, and step between the base image offsets indexed
+BLOCK_LEN = 16
+INDEX_STEP = 4
+# Shortest copy worth emitting, a copy costs a few bytes while the bytes inserted instead cost their length
+MIN_COPY_LEN = 8
+
+quiet = False
+
+
+def status(msg):
+    if not quiet:
+        print(msg)
+
+
+def app_image_sha256(image):
+    """ Returns the SHA-256 that esp_partition_get_sha256() gives for a partition holding this app image """
+    if len(image) < ESP_IMAGE_HEADER_LEN or image[0] != ESP_IMAGE_MAGIC:
+        raise ValueError('The base is not an app image')
+    segments = image[1]
+    hash_appended = image[23] == 1
+    offset = ESP_IMAGE_HEADER_LEN
+    for _ in range(segments):
+        if offset + ESP_IMAGE_SEGMENT_HEADER_LEN > len(image):
+            raise ValueError('The base app image is truncated')
+        _, data_len = struct.unpack_from('<II', image, offset)
+        offset += ESP_IMAGE_SEGMENT_HEADER_LEN + data_len
+    # The checksum byte ends the image on a 16 byte boundary
+    image_len = (offset + 16) & ~15
+    if hash_appended:
+        if image_len + HASH_LEN > len(image):
+            raise ValueError('The base app image is truncated')
+        return image[image_len:image_len + HASH_LEN]
+    return hashlib.sha256(image[:image_len]).digest()
+
+
+def varint(value):
+    out = bytearray()
+    while True:
+        byte = value & 0x7f
+        value >>= 7
+        if value:
+            out.append(byte | 0x80)
+        else:
+            out.append(byte)
+            return bytes(out)
+
+
+def zigzag(value):
+    return value * 2 if value >= 0 else -value * 2 - 1
+
+
+def match_len(a, a_pos, b, b_pos, limit):
+    """ Length of the common prefix of a[a_pos:] and b[b_pos:], at most limit """
+    n = 0
+    step = 4096
+    while n < limit:
+        chunk = min(step, limit - n)
+        if a[a_pos + n:a_pos + n + chunk] == b[b_pos + n:b_pos + n + chunk]:
+            n += chunk
+        elif chunk > 16:
+            step = chunk // 16
+        else:
+            while n < limit and a[a_pos + n] == b[b_pos + n]:
+                n += 1
+            break
+    return n
+
+
+def generate_delta(base, new):
+    """ Returns the delta rebuilding new from base, see esp_ota_delta.h for the format """
+    index = {}
+    for offset in range(len(base) - BLOCK_LEN, -1, -INDEX_STEP):
+        index[base[offset:offset + BLOCK_LEN]] = offset
+
+    ops = bytearray()
+    insert_start = 0
+    base_offset = 0
+    pos = 0
+    expected = None     # base offset continuing the previous copy at pos, tried first
+    while pos + BLOCK_LEN <= len(new):
+        block = new[pos:pos + BLOCK_LEN]
+        candidates = []
+        if expected is not None and 0 <= expected <= len(base) - BLOCK_LEN:
+            candidates.append(expected)
+        candidate = index.get(block)
+        if candidate is not None:
+            candidates.append(candidate)
+        best_len = 0
+        for candidate in candidates:
+            length = match_len(base, candidate, new, pos, min(len(base) - candidate, len(new) - pos))
+            if length > best_len:
+                best_len, best = length, candidate
+        if best_len < MIN_COPY_LEN:
+            pos += 1
+            if expected is not None:
+                expected += 1
+            continue
+        # Extend the copy backwards over the bytes which would have been inserted
+        back = 0
+        while pos - back > insert_start and best - back > 0 and new[pos - back - 1] == base[best - back - 1]:
+            back += 1
+        pos, best, best_len = pos - back, best - back, best_len + back
+        if pos > insert_start:
+            ops += varint((pos - insert_start) << 1) + new[insert_start:pos]
+        ops += varint(best_len << 1 | 1) + varint(zigzag(best - base_offset))
+        base_offset = best + best_len
+        pos += best_len
+        insert_start = pos
+        expected = base_offset
+    if len(new) > insert_start:
+        ops += varint((len(new) - insert_start) << 1) + new[insert_start:]
+
+    header = DELTA_HEADER.pack(DELTA_MAGIC, DELTA_VERSION, len(base), len(new), app_image_sha256(base))
+    return header + bytes(ops)
+
+
+def apply_delta(base, delta):
+    """ Rebuilds the new image, as esp_ota_delta_write() does """
+    magic, version, base_size, image_size, _ = DELTA_HEADER.unpack_from(delta, 0)
+    if magic != DELTA_MAGIC or version != DELTA_VERSION or base_size != len(base):
+        raise ValueError('Invalid delta header')
+    pos = DELTA_HEADER.size
+    base_offset = 0
+    out = bytearray()
+
+    def read_varint():
+        nonlocal pos
+        value = shift = 0
+        while True:
+            byte = delta[pos]
+            pos += 1
+            value |= (byte & 0x7f) << shift
+            shift += 7
+            if not byte & 0x80:
+                return value
+
+    while len(out) < image_size:
+        op = read_varint()
+        length = op >> 1
+        if op & 1:
+            distance = read_varint()
+            base_offset += (distance >> 1) ^ -(distance & 1)
+            out += base[base_offset:base_offset + length]
+            base_offset += length
+        else:
+            out += delta[pos:pos + length]
+            pos += length
+    if pos != len(delta) or len(out) != image_size:
+        raise ValueError('Invalid delta length')
+    return bytes(out)
+
+
+def main():
+    global quiet
+    parser = argparse.ArgumentParser(description='Generates the delta from an app image to a newer one, for delta OTA updates')
+    parser.add_argument('--quiet', '-q', help='Don\'t print non-critical status messages to stderr', action='store_true')
+    parser.add_argument('--base', help='App image which the delta is applied to, usually the one running on the device', required=True)
+    parser.add_argument('--new', help='App image to update to', required=True)
+    parser.add_argument('--output', '-o', help='Path of the delta', required=True)
+    args = parser.parse_args()
+    quiet = args.quiet
+
+    with open(args.base, 'rb') as f:
+        base = f.read()
+    with open(args.new, 'rb') as f:
+        new = f.read()
+
+    delta = generate_delta(base, new)
+    if apply_delta(base, delta) != new:
+        raise RuntimeError('The delta does not rebuild the new image')
+
+    with open(args.output, 'wb') as f:
+        f.write(delta)
+    status('Delta of {} bytes for a {} byte image ({:.1f}%)'.format(len(delta), len(new), 100.0 * len(delta) / max(len(new), 1)))
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main())
+    except (ValueError, RuntimeError) as e:
+        print(e, file=sys.stderr)
+        sys.exit(2)
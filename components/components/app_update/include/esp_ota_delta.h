@@ -0,0 +1,138 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+#include "esp_ota_ops.h"
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+/**
+ * Delta updates
+ *
+ * A delta (patch) describes the new image as a sequence of byte ranges copied from a base image, usually the
+ * running app, and of literal bytes inserted in between. It is made on the host with `gen_ota_delta.py`:
+ *
+ *     python gen_ota_delta.py --base old_app.bin --new new_app.bin --output app.delta
+ *
+ * The delta is applied while it is received, with a fixed amount of RAM whatever the size of the image: the new
+ * image is rebuilt in the update partition through esp_ota_write(), so esp_ota_end() validates it as any other image.
+ *
+ *     esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &ota_handle);
+ *     esp_ota_delta_begin(ota_handle, NULL, &delta_handle);
+ *     esp_ota_delta_write(delta_handle, data, size);  // for each chunk of the delta
+ *     esp_ota_delta_end(delta_handle);
+ *     esp_ota_end(ota_handle);
+ *
+ * Delta format, little endian:
+ *  - header: magic ESP_OTA_DELTA_MAGIC (uint32), version (uint8), 3 reserved bytes, size of the base image (uint32),
+ *    size of the new image (uint32), SHA-256 of the base image as returned by esp_partition_get_sha256() (32 bytes).
+ *  - then, until the new image is complete, operations starting with the varint (LEB128) `length << 1 | copy`:
+ *    - copy = 0: `length` literal bytes follow.
+ *    - copy = 1: followed by the zigzag varint distance from the end of the previous copy (from 0 for the first one)
+ *      to the start of the `length` bytes to copy from the base image.
+ */
+
+#define ESP_OTA_DELTA_MAGIC         0x444f5345  /*!< "ESOD", first bytes of a delta */
+#define ESP_OTA_DELTA_VERSION       1           /*!< Version of the delta format */
+#define ESP_OTA_DELTA_HEADER_SIZE   48          /*!< Size of the delta header */
+
+/**
+ * @brief Opaque handle for applying a delta, returned by esp_ota_delta_begin()
+ */
+typedef struct esp_ota_delta *esp_ota_delta_handle_t;
+
+/**
+ * @brief Function writing the next part of the new image, see esp_ota_delta_set_write_cb()
+ */
+typedef esp_err_t (*esp_ota_delta_write_cb_t)(const void *data, size_t size, void *user_ctx);
+
+/**
+ * @brief   Start applying a delta to an OTA update
+ *
+ * @param ota_handle    Handle obtained from esp_ota_begin(), which the new image is written to.
+ * @param base          Partition holding the base image of the delta, NULL for the running app partition.
+ *                      It must not be the partition being updated.
+ * @param out_handle    On success, returns a handle to pass to esp_ota_delta_write() and esp_ota_delta_end().
+ *
+ * @return
+ *    - ESP_OK: Success.
+ *    - ESP_ERR_INVALID_ARG: out_handle is NULL or there is no running partition.
+ *    - ESP_ERR_NO_MEM: Cannot allocate memory for the handle.
+ */
+esp_err_t esp_ota_delta_begin(esp_ota_handle_t ota_handle, const esp_partition_t *base, esp_ota_delta_handle_t *out_handle);
+
+/**
+ * @brief   Write the new image with a callback instead of esp_ota_write()
+ *
+ * The callback gets the new image in order, in parts of up to 1 KB, and passes them on to esp_ota_write() of the
+ * OTA handle. This lets the caller look at the new image while it is rebuilt, for example to check its header
+ * before the rest of the delta is downloaded.
+ *
+ * @param handle    Handle obtained from esp_ota_delta_begin(), before the first call to esp_ota_delta_write()
+ * @param write_cb  Function writing the new image, NULL to write it with esp_ota_write()
+ * @param user_ctx  Passed to write_cb
+ *
+ * @return
+ *    - ESP_OK: Success.
+ *    - ESP_ERR_INVALID_ARG: handle is NULL.
+ *    - ESP_ERR_INVALID_STATE: Part of the delta has already been applied.
+ */
+esp_err_t esp_ota_delta_set_write_cb(esp_ota_delta_handle_t handle, esp_ota_delta_write_cb_t write_cb, void *user_ctx);
+
+/**
+ * @brief   Apply the next part of a delta
+ *
+ * The delta can be split in parts of any size. Once the header has been received, the base partition is checked
+ * to hold the image the delta was made against.
+ *
+ * @param handle  Handle obtained from esp_ota_delta_begin()
+ * @param data    Next part of the delta
+ * @param size    Size of data in bytes
+ *
+ * @return
+ *    - ESP_OK: The part was applied.
+ *    - ESP_ERR_INVALID_ARG: handle is NULL, or the delta is malformed.
+ *    - ESP_ERR_INVALID_VERSION: The delta has a format version this code does not support.
+ *    - ESP_ERR_OTA_DELTA_BASE_MISMATCH: The base partition does not hold the base image of the delta.
+ *    - or an error code of esp_ota_write() (or of the write callback) or esp_partition_read().
+ *    Once an error is returned, all the following calls return it.
+ */
+esp_err_t esp_ota_delta_write(esp_ota_delta_handle_t handle, const void *data, size_t size);
+
+/**
+ * @brief   Finish applying a delta and free the handle
+ *
+ * The new image is then finished with esp_ota_end() of the OTA handle.
+ *
+ * @param handle  Handle obtained from esp_ota_delta_begin(), invalid after this call.
+ *
+ * @return
+ *    - ESP_OK: The whole delta was applied.
+ *    - ESP_ERR_INVALID_SIZE: The delta was not received in full.
+ *    - or the error returned by esp_ota_delta_write().
+ */
+esp_err_t esp_ota_delta_end(esp_ota_delta_handle_t handle);
+
+/**
+ * @brief   Stop applying a delta and free the handle
+ *
+ * The OTA update itself is aborted with esp_ota_abort().
+ *
+ * @param handle  Handle obtained from esp_ota_delta_begin(), invalid after this call.
+ */
+void esp_ota_delta_abort(esp_ota_delta_handle_t handle);
+
+#ifdef __cplusplus
+}
+#endif
@@ -32,6 +32,7 @@ extern "C"
 #define ESP_ERR_OTA_SMALL_SEC_VER                (ESP_ERR_OTA_BASE + 0x04)  /*!< Error if the firmware has a secure version less than the running firmware. */
 #define ESP_ERR_OTA_ROLLBACK_FAILED              (ESP_ERR_OTA_BASE + 0x05)  /*!< Error if flash does not have valid firmware in passive partition and hence rollback is not possible */
 #define ESP_ERR_OTA_ROLLBACK_INVALID_STATE       (ESP_ERR_OTA_BASE + 0x06)  /*!< Error if current active firmware is still marked in pending validation state (ESP_OTA_IMG_PENDING_VERIFY), essentially first boot of firmware image post upgrade and hence firmware upgrade is not possible */
+#define ESP_ERR_OTA_DELTA_BASE_MISMATCH          (ESP_ERR_OTA_BASE + 0x07)  /*!< Error if the base partition does not hold the image a delta was made against */
 
 
 /**
@@ -213,6 +214,10 @@ esp_err_t esp_ota_write_with_offset(esp_ota_handle_t handle, const void *data, s
  * If the finalize_with_copy option is set, the staging partition will be copied to the final partition at the end of this function.
  * Otherwise, copying will need to be handled by custom code using esp_partition_copy().
  *
+ * An app or bootloader image written from its start with esp_ota_write() is checksummed and hashed as it is written,
+ * so only its headers, digest and signature are read back from flash here (see esp_image_stream_verify()).
+ * Images written with esp_ota_write_with_offset() or after esp_ota_resume() are verified by reading them back in full.
+ *
  * @return
  *    - ESP_OK: Newly written OTA app image is valid.
  *    - ESP_ERR_NOT_FOUND: OTA handle was not found.
@@ -239,6 +244,9 @@ esp_err_t esp_ota_abort(esp_ota_handle_t handle);
  *
  * @note If this function returns ESP_OK, calling esp_restart() will boot the newly configured app partition.
  *
+ * The image is verified before the OTA data is updated, unless it was just written with esp_ota_write() and verified by
+ * esp_ota_end() with the hashes calculated while it was written. The partition must not be modified by other means in between.
+ *
  * @param partition Pointer to info for partition containing app image to boot.
  *
  * @return
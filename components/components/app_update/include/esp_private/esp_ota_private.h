@@ -0,0 +1,37 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdbool.h>
+#include "esp_partition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file esp_ota_private.h
+ *
+ * @brief Private functions of app_update, used by its tests
+ */
+
+/**
+ * @brief Check if the image of an app partition was verified while it was written
+ *
+ * True from the esp_ota_end() call which verified the image written with esp_ota_write() from its start,
+ * using the checksum and hashes calculated by esp_ota_write(), until esp_ota_set_boot_partition() is
+ * called for the partition (which then does not verify the image again), or the partition is written again.
+ *
+ * @param partition  App partition
+ *
+ * @return true if esp_ota_set_boot_partition() will not read the image back from flash
+ */
+bool esp_ota_partition_is_stream_verified(const esp_partition_t *partition);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -14,6 +14,10 @@
 #include <unity.h>
 #include <test_utils.h>
 #include <esp_ota_ops.h>
+#include <esp_ota_delta.h>
+#include <esp_image_format.h>
+#include "esp_private/esp_ota_private.h"
+#include <sys/param.h>
 
 /* These OTA tests currently don't assume an OTA partition exists
    on the device, so they're a bit limited
@@ -122,3 +126,181 @@ TEST_CASE("esp_ota_get_running_partition points to correct address", "[spi_flash
     ESP_LOGI("running bin", "0x%p", (void*)part->address);
     TEST_ASSERT_EQUAL_HEX32(factory->address, part->address);
 }
+
+static esp_err_t write_running_app(const esp_partition_t *update_partition, size_t corrupt_offset)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_pos_t running_pos = {
+            .offset = running->address,
+            .size = running->size
+    };
+    esp_image_metadata_t data;
+    TEST_ESP_OK(esp_image_get_metadata(&running_pos, &data));
+
+    const uint8_t *image;
+    esp_partition_mmap_handle_t image_map;
+    TEST_ESP_OK(esp_partition_mmap(running, 0, data.image_len, ESP_PARTITION_MMAP_DATA, (const void **)&image, &image_map));
+
+    esp_ota_handle_t handle;
+    uint8_t chunk[1000];
+    TEST_ESP_OK(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    for (size_t offset = 0; offset < data.image_len; offset += sizeof(chunk)) {
+        size_t len = MIN(sizeof(chunk), data.image_len - offset);
+        memcpy(chunk, image + offset, len);
+        if (corrupt_offset >= offset && corrupt_offset < offset + len) {
+            chunk[corrupt_offset - offset] ^= 0x01;
+        }
+        TEST_ESP_OK(esp_ota_write(handle, chunk, len));
+    }
+    esp_partition_munmap(image_map);
+    return esp_ota_end(handle);
+}
+
+TEST_CASE("esp_ota_end() verifies the image hashed by esp_ota_write()", "[ota]")
+{
+    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
+    TEST_ASSERT_NOT_NULL(update_partition);
+
+    TEST_ESP_OK(write_running_app(update_partition, SIZE_MAX));
+    TEST_ASSERT_TRUE(esp_ota_partition_is_stream_verified(update_partition));
+    /* the checksum and hash of the segment data are the ones calculated by esp_ota_write() */
+    TEST_ESP_ERR(ESP_ERR_OTA_VALIDATE_FAILED, write_running_app(update_partition, 0x1001));
+    TEST_ASSERT_FALSE(esp_ota_partition_is_stream_verified(update_partition));
+}
+
+TEST_CASE("esp_ota_set_boot_partition() does not verify an image verified by esp_ota_end() again", "[ota]")
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
+    TEST_ASSERT_NOT_NULL(update_partition);
+
+    TEST_ESP_OK(write_running_app(update_partition, SIZE_MAX));
+    TEST_ASSERT_TRUE(esp_ota_partition_is_stream_verified(update_partition));
+    TEST_ESP_OK(esp_ota_set_boot_partition(update_partition));
+    TEST_ASSERT_FALSE(esp_ota_partition_is_stream_verified(update_partition));
+    TEST_ASSERT_EQUAL_PTR(update_partition, esp_ota_get_boot_partition());
+
+    /* verified from flash */
+    TEST_ESP_OK(esp_ota_set_boot_partition(running));
+    TEST_ASSERT_EQUAL_PTR(running, esp_ota_get_boot_partition());
+
+    /* a new update of the partition drops the earlier verification */
+    TEST_ESP_OK(write_running_app(update_partition, SIZE_MAX));
+    esp_ota_handle_t handle;
+    TEST_ESP_OK(esp_ota_begin(update_partition, OTA_SIZE_UNKNOWN, &handle));
+    TEST_ASSERT_FALSE(esp_ota_partition_is_stream_verified(update_partition));
+    TEST_ESP_OK(esp_ota_abort(handle));
+}
+
+static size_t put_varint(uint8_t *p, uint32_t value)
+{
+    size_t n = 0;
+    while (value >= 0x80) {
+        p[n++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    p[n++] = value;
+    return n;
+}
+
+static void put_u32(uint8_t *p, uint32_t value)
+{
+    memcpy(p, &value, sizeof(value));
+}
+
+/* Makes a delta which rebuilds the running app: its first bytes are inserted, the rest is copied in two pieces */
+static uint8_t *make_running_app_delta(size_t *delta_len)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_pos_t running_pos = {
+            .offset = running->address,
+            .size = running->size
+    };
+    esp_image_metadata_t data;
+    TEST_ESP_OK(esp_image_get_metadata(&running_pos, &data));
+    const uint32_t image_len = data.image_len;
+    const uint32_t insert_len = 64;
+    const uint32_t half = image_len / 2;
+
+    uint8_t *delta = calloc(1, ESP_OTA_DELTA_HEADER_SIZE + 5 + insert_len + 2 * 10);
+    TEST_ASSERT_NOT_NULL(delta);
+    put_u32(delta, ESP_OTA_DELTA_MAGIC);
+    delta[4] = ESP_OTA_DELTA_VERSION;
+    put_u32(delta + 8, image_len);
+    put_u32(delta + 12, image_len);
+    TEST_ESP_OK(esp_partition_get_sha256(running, delta + 16));
+    size_t len = ESP_OTA_DELTA_HEADER_SIZE;
+
+    len += put_varint(delta + len, insert_len << 1);
+    TEST_ESP_OK(esp_partition_read(running, 0, delta + len, insert_len));
+    len += insert_len;
+    /* copy from offset insert_len, then on from where it ended */
+    len += put_varint(delta + len, (half - insert_len) << 1 | 1);
+    len += put_varint(delta + len, insert_len << 1);
+    len += put_varint(delta + len, (image_len - half) << 1 | 1);
+    len += put_varint(delta + len, 0);
+    *delta_len = len;
+    return delta;
+}
+
+TEST_CASE("esp_ota_delta_write() rebuilds the image in the update partition", "[ota]")
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
+    TEST_ASSERT_NOT_NULL(update_partition);
+    size_t delta_len;
+    uint8_t *delta = make_running_app_delta(&delta_len);
+
+    esp_ota_handle_t handle;
+    esp_ota_delta_handle_t delta_handle;
+    TEST_ESP_OK(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ESP_OK(esp_ota_delta_begin(handle, NULL, &delta_handle));
+    /* small parts split the header, the varints and the inserted bytes */
+    for (size_t offset = 0; offset < delta_len; offset += 7) {
+        TEST_ESP_OK(esp_ota_delta_write(delta_handle, delta + offset, MIN(7, delta_len - offset)));
+    }
+    TEST_ESP_OK(esp_ota_delta_end(delta_handle));
+    TEST_ESP_OK(esp_ota_end(handle));
+
+    uint8_t running_sha[32], update_sha[32];
+    TEST_ESP_OK(esp_partition_get_sha256(running, running_sha));
+    TEST_ESP_OK(esp_partition_get_sha256(update_partition, update_sha));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(running_sha, update_sha, sizeof(running_sha));
+    free(delta);
+}
+
+TEST_CASE("esp_ota_delta_write() rejects a delta for another base or an incomplete one", "[ota]")
+{
+    const esp_partition_t *update_partition = esp_ota_get_next_update_partition(NULL);
+    TEST_ASSERT_NOT_NULL(update_partition);
+    size_t delta_len;
+    uint8_t *delta = make_running_app_delta(&delta_len);
+    esp_ota_handle_t handle;
+    esp_ota_delta_handle_t delta_handle;
+
+    /* the SHA-256 of the base is checked before anything is written */
+    delta[16] ^= 0x01;
+    TEST_ESP_OK(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ESP_OK(esp_ota_delta_begin(handle, NULL, &delta_handle));
+    TEST_ESP_ERR(ESP_ERR_OTA_DELTA_BASE_MISMATCH, esp_ota_delta_write(delta_handle, delta, delta_len));
+    TEST_ESP_ERR(ESP_ERR_OTA_DELTA_BASE_MISMATCH, esp_ota_delta_write(delta_handle, delta, 0));
+    TEST_ESP_ERR(ESP_ERR_OTA_DELTA_BASE_MISMATCH, esp_ota_delta_end(delta_handle));
+    TEST_ESP_OK(esp_ota_abort(handle));
+    delta[16] ^= 0x01;
+
+    /* the last copy is missing */
+    TEST_ESP_OK(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ESP_OK(esp_ota_delta_begin(handle, NULL, &delta_handle));
+    TEST_ESP_OK(esp_ota_delta_write(delta_handle, delta, delta_len - 1));
+    TEST_ESP_ERR(ESP_ERR_INVALID_SIZE, esp_ota_delta_end(delta_handle));
+    TEST_ESP_OK(esp_ota_abort(handle));
+
+    /* bytes after the end of the image */
+    TEST_ESP_OK(esp_ota_begin(update_partition, OTA_WITH_SEQUENTIAL_WRITES, &handle));
+    TEST_ESP_OK(esp_ota_delta_begin(handle, NULL, &delta_handle));
+    TEST_ESP_OK(esp_ota_delta_write(delta_handle, delta, delta_len));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_ota_delta_write(delta_handle, delta, 1));
+    esp_ota_delta_abort(delta_handle);
+    TEST_ESP_OK(esp_ota_abort(handle));
+    free(delta);
+}
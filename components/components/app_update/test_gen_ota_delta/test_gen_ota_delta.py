@@ -0,0 +1,128 @@
+#!/usr/bin/env python
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import hashlib
+import os
+import random
+import shutil
+import struct
+import subprocess
+import sys
+import tempfile
+import unittest
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+try:
+    import gen_ota_delta
+except ImportError:
+    raise
+
+
+def make_image(segments, hash_appended=True):
+    """ Returns an app image holding the segments, with the checksum and, if hash_appended, the SHA-256 """
+    image = bytearray(struct.pack('<BBBBI', 0xe9, len(segments), 2, 0x20, 0x40080000)) + bytes(15)
+    image.append(1 if hash_appended else 0)
+    checksum = 0xef
+    for i, data in enumerate(segments):
+        data = data + bytes(-len(data) % 4)
+        image += struct.pack('<II', 0x3f400020 + 0x100000 * i, len(data)) + data
+        for byte in data:
+            checksum ^= byte
+    image += bytes(((len(image) + 16) & ~15) - len(image) - 1) + bytes([checksum])
+    if hash_appended:
+        image += hashlib.sha256(image).digest()
+    return bytes(image)
+
+
+class GenOtaDeltaTest(unittest.TestCase):
+    def setUp(self):  # type: () -> None
+        rand = random.Random(0)
+        self.code = bytes(rand.getrandbits(8) for _ in range(32 * 1024))
+        self.rodata = bytes(rand.getrandbits(8) for _ in range(8 * 1024))
+        self.base = make_image([self.code, self.rodata])
+
+    def check_round_trip(self, new):  # type: (bytes) -> bytes
+        delta = gen_ota_delta.generate_delta(self.base, new)
+        self.assertEqual(gen_ota_delta.apply_delta(self.base, delta), new)
+        return delta
+
+    def test_header(self):  # type: () -> None
+        delta = self.check_round_trip(self.base)
+        self.assertEqual(gen_ota_delta.DELTA_HEADER.size, 48)
+        self.assertEqual(delta[:4], b'ESOD')
+        magic, version, base_size, image_size, sha256 = gen_ota_delta.DELTA_HEADER.unpack_from(delta, 0)
+        self.assertEqual(version, 1)
+        self.assertEqual(base_size, len(self.base))
+        self.assertEqual(image_size, len(self.base))
+        self.assertEqual(sha256, self.base[-32:])
+
+    def test_identical_images(self):  # type: () -> None
+        delta = self.check_round_trip(self.base)
+        # A single copy of the whole image
+        self.assertLess(len(delta), gen_ota_delta.DELTA_HEADER.size + 8)
+
+    def test_edited_image(self):  # type: () -> None
+        code = bytearray(self.code)
+        code[100:104] = b'\x12\x34\x56\x78'                     # patched instruction
+        code[20000:20000] = bytes(range(200))                   # inserted function
+        del code[30000:30500]                                   # removed function
+        rodata = b'new string\0' + self.rodata[:4000] + self.rodata[4100:]
+        new = make_image([bytes(code), rodata])
+        delta = self.check_round_trip(new)
+        self.assertLess(len(delta), len(new) // 10)
+
+    def test_unrelated_images(self):  # type: () -> None
+        rand = random.Random(1)
+        new = make_image([bytes(rand.getrandbits(8) for _ in range(16 * 1024))])
+        delta = self.check_round_trip(new)
+        # Inserted whole, with little overhead
+        self.assertLess(len(delta), len(new) + 64)
+
+    def test_short_images(self):  # type: () -> None
+        self.check_round_trip(b'')
+        self.check_round_trip(self.base[:5])
+
+    def test_image_sha256(self):  # type: () -> None
+        self.assertEqual(gen_ota_delta.app_image_sha256(self.base), self.base[-32:])
+        image = make_image([self.code], hash_appended=False)
+        self.assertEqual(gen_ota_delta.app_image_sha256(image + bytes(100)), hashlib.sha256(image).digest())
+        with self.assertRaises(ValueError):
+            gen_ota_delta.app_image_sha256(b'\xff' * 64)
+        with self.assertRaises(ValueError):
+            gen_ota_delta.app_image_sha256(self.base[:1000])
+
+    def test_invalid_delta(self):  # type: () -> None
+        new = make_image([self.code[:1000] + self.rodata])
+        delta = gen_ota_delta.generate_delta(self.base, new)
+        with self.assertRaises(ValueError):
+            gen_ota_delta.apply_delta(self.base[:-16], delta)
+        with self.assertRaises(ValueError):
+            gen_ota_delta.apply_delta(self.base, b'XXXX' + delta[4:])
+        with self.assertRaises(ValueError):
+            gen_ota_delta.apply_delta(self.base, delta + b'\0')
+        with self.assertRaises((ValueError, IndexError)):
+            gen_ota_delta.apply_delta(self.base, delta[:-1])
+
+    def test_command_line(self):  # type: () -> None
+        new = make_image([self.code[:-64], self.rodata])
+        tmp = tempfile.mkdtemp()
+        self.addCleanup(shutil.rmtree, tmp)
+        paths = [os.path.join(tmp, name) for name in ('base.bin', 'new.bin', 'delta.bin')]
+        for path, data in zip(paths, (self.base, new)):
+            with open(path, 'wb') as f:
+                f.write(data)
+        script = os.path.join(os.path.dirname(__file__), '..', 'gen_ota_delta.py')
+        args = [sys.executable, script, '--quiet', '--base', paths[0], '--new', paths[1], '-o', paths[2]]
+        self.assertEqual(subprocess.call(args), 0)
+        with open(paths[2], 'rb') as f:
+            self.assertEqual(gen_ota_delta.apply_delta(self.base, f.read()), new)
+
+        # The base must be an app image, for the SHA-256 checked on the device
+        with open(paths[0], 'wb') as f:
+            f.write(b'\xff' * 1024)
+        with open(os.devnull, 'w') as devnull:
+            self.assertEqual(subprocess.call(args, stderr=devnull), 2)
+
+
+if __name__ == '__main__':
+    unittest.main()
@@ -1,11 +1,12 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 #pragma once
 
 #include <stdbool.h>
+#include <stddef.h>
 #include <esp_err.h>
 #include "esp_flash_partitions.h"
 #include "esp_app_format.h"
@@ -127,6 +128,70 @@ esp_err_t esp_image_verify(esp_image_load_mode_t mode, const esp_partition_pos_t
  */
 esp_err_t esp_image_get_metadata(const esp_partition_pos_t *part, esp_image_metadata_t *metadata);
 
+#if !NON_OS_BUILD
+/* App/bootloader image hashed while it is being written, e.g. by esp_ota_write() */
+typedef struct esp_image_stream esp_image_stream_t;
+
+/**
+ * @brief Start hashing an app/bootloader image which is written sequentially
+ *
+ * Pass each chunk of the image to esp_image_stream_data() in order, starting from the image header,
+ * then verify the image with esp_image_stream_verify() once it has been written to flash.
+ *
+ * @return The stream, or NULL if there is not enough memory or if the configured signature scheme
+ *         (SHA-384) cannot be verified this way. Use esp_image_verify() instead in that case.
+ */
+esp_image_stream_t *esp_image_stream_start(void);
+
+/**
+ * @brief Parse, checksum and hash the next chunk of the image
+ *
+ * Headers are parsed as they arrive, the segment data is checksummed and the image hashed
+ * up to the appended SHA-256 digest (or up to the signature block if signatures are verified).
+ * Data past that point is ignored.
+ *
+ * @param stream Stream started by esp_image_stream_start(), may be NULL.
+ * @param data Plaintext chunk of the image.
+ * @param len Length of the chunk.
+ */
+void esp_image_stream_data(esp_image_stream_t *stream, const void *data, size_t len);
+
+/**
+ * @brief Verify an app/bootloader image which was hashed while it was written
+ *
+ * Performs the same checks as esp_image_verify(), but only the image and segment headers, the checksum,
+ * the appended digest and the signature block are read back from flash. The checksum and hashes are
+ * the ones calculated by esp_image_stream_data(), so segment data is not re-read.
+ *
+ * Falls back to esp_image_verify() if the whole image was not streamed, or if the headers on flash
+ * differ from the streamed ones.
+ *
+ * @note Corruption of the segment data when it was written to flash is not detected, unless
+ *       CONFIG_SPI_FLASH_VERIFY_WRITE is enabled. The bootloader still verifies the image before booting it.
+ *
+ * @param stream Stream of the image, freed by this function. May be NULL to verify from flash.
+ * @param mode Mode of operation (verify or silent verify).
+ * @param part Partition the image was written to.
+ * @param[out] data Pointer to the image metadata structure which is filled in by this function.
+ * @param[out] streamed Set to true if the image was verified with the checksum and hashes of the stream,
+ *                      false if it was read back from flash. May be NULL.
+ *
+ * @return
+ * - ESP_OK if the image is valid
+ * - ESP_ERR_IMAGE_FLASH_FAIL if a SPI flash error occurs
+ * - ESP_ERR_IMAGE_INVALID if the image appears invalid.
+ * - ESP_ERR_INVALID_ARG if the partition or data pointers are invalid.
+ */
+esp_err_t esp_image_stream_verify(esp_image_stream_t *stream, esp_image_load_mode_t mode, const esp_partition_pos_t *part, esp_image_metadata_t *data, bool *streamed);
+
+/**
+ * @brief Free a stream without verifying the image
+ *
+ * @param stream Stream started by esp_image_stream_start(), may be NULL.
+ */
+void esp_image_stream_abort(esp_image_stream_t *stream);
+#endif // !NON_OS_BUILD
+
 /**
  * @brief Verify and load an app image (available only in space of bootloader).
  *
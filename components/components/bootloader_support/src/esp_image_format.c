@@ -3,6 +3,7 @@
  *
  * SPDX-License-Identifier: Apache-2.0
  */
+#include <stdlib.h>
 #include <string.h>
 #include <sys/param.h>
 #include <esp_cpu.h>
@@ -107,6 +108,7 @@ static esp_err_t process_appended_hash_and_sig(esp_image_metadata_t *data, uint3
 static esp_err_t process_checksum(bootloader_sha256_handle_t sha_handle, uint32_t checksum_word, esp_image_metadata_t *data, bool silent, bool skip_check_checksum);
 static esp_err_t __attribute__((unused)) verify_secure_boot_signature(bootloader_sha256_handle_t sha_handle, esp_image_metadata_t *data, uint8_t *image_digest, uint8_t *verified_digest);
 static esp_err_t __attribute__((unused)) verify_simple_hash(bootloader_sha256_handle_t sha_handle, esp_image_metadata_t *data);
+static esp_err_t __attribute__((unused)) verify_simple_hash_digest(const uint8_t *image_hash, esp_image_metadata_t *data);
 
 static uint32_t s_bootloader_partition_offset = ESP_PRIMARY_BOOTLOADER_OFFSET;
 
@@ -1138,7 +1140,11 @@ static esp_err_t verify_simple_hash(bootloader_sha256_handle_t sha_handle, esp_i
 {
     uint8_t image_hash[HASH_LEN] = { 0 };
     bootloader_sha256_finish(sha_handle, image_hash);
+    return verify_simple_hash_digest(image_hash, data);
+}
 
+static esp_err_t verify_simple_hash_digest(const uint8_t *image_hash, esp_image_metadata_t *data)
+{
     // Log the hash for debugging
     bootloader_debug_buffer(image_hash, HASH_LEN, "Calculated hash");
 
@@ -1179,3 +1185,296 @@ int esp_image_get_flash_size(esp_image_flash_size_t app_flash_size)
         return 0;
     }
 }
+
+/* The stream holds a SHA-256 context for the whole update, non-OS builds only have the single ROM one */
+#if !NON_OS_BUILD
+
+typedef enum {
+    STREAM_IMAGE_HEADER,
+    STREAM_SEGMENT_HEADER,
+    STREAM_SEGMENT_DATA,
+    STREAM_CHECKSUM_PADDING,
+    STREAM_APPENDED_HASH,
+    STREAM_SIGNATURE_PADDING,
+    STREAM_DONE,
+    STREAM_INVALID,
+} esp_image_stream_state_t;
+
+struct esp_image_stream {
+    esp_image_stream_state_t state;
+    uint32_t offset;                    /* Number of image bytes streamed so far */
+    uint32_t part_start;                /* Offset of the header or segment being streamed */
+    uint32_t part_end;                  /* Offset at which the header or segment ends */
+    WORD_ALIGNED_ATTR esp_image_header_t image;
+    esp_image_segment_header_t segment;
+    int segment_index;
+    uint32_t image_len;                 /* Length of the image up to the checksum padding */
+    uint32_t checksum_word;
+    bootloader_sha256_handle_t sha_handle;
+    uint8_t digest[HASH_LEN];           /* SHA-256 of the image, or of the signed part of it, set once done */
+};
+
+esp_image_stream_t *esp_image_stream_start(void)
+{
+#if CONFIG_SECURE_BOOT_ECDSA_KEY_LEN_384_BITS && (SECURE_BOOT_CHECK_SIGNATURE == 1)
+    // The SHA-384 signature digest is only calculated when verifying from flash
+    return NULL;
+#else
+    esp_image_stream_t *stream = calloc(1, sizeof(esp_image_stream_t));
+    if (stream == NULL) {
+        return NULL;
+    }
+    stream->sha_handle = bootloader_sha256_start();
+    if (stream->sha_handle == NULL) {
+        free(stream);
+        return NULL;
+    }
+    stream->state = STREAM_IMAGE_HEADER;
+    stream->part_end = sizeof(esp_image_header_t);
+    stream->checksum_word = ESP_ROM_CHECKSUM_INITIAL;
+    return stream;
+#endif
+}
+
+static void stream_set_state(esp_image_stream_t *stream, esp_image_stream_state_t state, uint32_t len)
+{
+    stream->state = state;
+    stream->part_start = stream->offset;
+    stream->part_end = stream->offset + len;
+}
+
+static void stream_finish(esp_image_stream_t *stream)
+{
+    bootloader_sha256_finish(stream->sha_handle, stream->digest);
+    stream->sha_handle = NULL;
+    stream->state = STREAM_DONE;
+}
+
+static void stream_next_segment(esp_image_stream_t *stream)
+{
+    if (stream->segment_index < stream->image.segment_count) {
+        stream_set_state(stream, STREAM_SEGMENT_HEADER, sizeof(esp_image_segment_header_t));
+    } else {
+        // Same padding as process_checksum(), the checksum is the last byte of it
+        stream->image_len = stream->offset;
+        stream_set_state(stream, STREAM_CHECKSUM_PADDING, ((stream->offset + 1 + 15) & ~15) - stream->offset);
+    }
+}
+
+static void stream_after_appended_hash(esp_image_stream_t *stream)
+{
+#if CONFIG_SECURE_SIGNED_APPS_RSA_SCHEME || CONFIG_SECURE_SIGNED_APPS_ECDSA_V2_SCHEME
+    // Partitions start on a sector boundary, so this is the padding hashed by verify_secure_boot_signature()
+    uint32_t padded_end = ALIGN_UP(stream->offset, FLASH_SECTOR_SIZE);
+    if (padded_end > stream->offset) {
+        stream_set_state(stream, STREAM_SIGNATURE_PADDING, padded_end - stream->offset);
+        return;
+    }
+#endif
+    stream_finish(stream);
+}
+
+/* Move on once the header, segment or padding being streamed is complete */
+static void stream_part_done(esp_image_stream_t *stream)
+{
+    switch (stream->state) {
+    case STREAM_IMAGE_HEADER:
+        if (stream->image.magic != ESP_IMAGE_HEADER_MAGIC || stream->image.segment_count > ESP_IMAGE_MAX_SEGMENTS) {
+            stream->state = STREAM_INVALID;
+            return;
+        }
+        stream_next_segment(stream);
+        break;
+    case STREAM_SEGMENT_HEADER:
+        if ((stream->segment.data_len & 3) != 0 || stream->segment.data_len >= ESP_IMAGE_MAX_FLASH_ADDR_SIZE) {
+            stream->state = STREAM_INVALID;
+            return;
+        }
+        if (stream->segment.data_len > 0) {
+            stream_set_state(stream, STREAM_SEGMENT_DATA, stream->segment.data_len);
+            break;
+        }
+        stream->segment_index++;
+        stream_next_segment(stream);
+        break;
+    case STREAM_SEGMENT_DATA:
+        stream->segment_index++;
+        stream_next_segment(stream);
+        break;
+    case STREAM_CHECKSUM_PADDING:
+#if (SECURE_BOOT_CHECK_SIGNATURE == 1)
+        // For secure boot, the signature hash covers the whole file including any "simple" hash
+        if (stream->image.hash_appended) {
+            stream_set_state(stream, STREAM_APPENDED_HASH, HASH_LEN);
+        } else {
+            stream_after_appended_hash(stream);
+        }
+#else
+        stream_finish(stream);
+#endif
+        break;
+    case STREAM_APPENDED_HASH:
+        stream_after_appended_hash(stream);
+        break;
+    case STREAM_SIGNATURE_PADDING:
+        stream_finish(stream);
+        break;
+    default:
+        break;
+    }
+}
+
+/* Segment data always starts word aligned, words may be split across calls though */
+static void stream_checksum(esp_image_stream_t *stream, const uint8_t *src, size_t len)
+{
+    uint32_t offset = stream->offset;
+    for (; len > 0 && (offset & 3) != 0; src++, len--, offset++) {
+        stream->checksum_word ^= (uint32_t)*src << (8 * (offset & 3));
+    }
+    for (; len >= 4; src += 4, len -= 4) {
+        uint32_t w;
+        memcpy(&w, src, sizeof(w));
+        stream->checksum_word ^= w;
+    }
+    for (; len > 0; src++, len--, offset++) {
+        stream->checksum_word ^= (uint32_t)*src << (8 * (offset & 3));
+    }
+}
+
+void esp_image_stream_data(esp_image_stream_t *stream, const void *data, size_t len)
+{
+    const uint8_t *src = (const uint8_t *)data;
+    if (stream == NULL) {
+        return;
+    }
+    while (len > 0 && stream->state < STREAM_DONE) {
+        size_t part_len = MIN(len, stream->part_end - stream->offset);
+        if (stream->state == STREAM_IMAGE_HEADER) {
+            memcpy((uint8_t *)&stream->image + (stream->offset - stream->part_start), src, part_len);
+        } else if (stream->state == STREAM_SEGMENT_HEADER) {
+            memcpy((uint8_t *)&stream->segment + (stream->offset - stream->part_start), src, part_len);
+        } else if (stream->state == STREAM_SEGMENT_DATA) {
+            stream_checksum(stream, src, part_len);
+        }
+        bootloader_sha256_data(stream->sha_handle, src, part_len);
+        stream->offset += part_len;
+        src += part_len;
+        len -= part_len;
+        if (stream->offset == stream->part_end) {
+            stream_part_done(stream);
+        }
+    }
+}
+
+void esp_image_stream_abort(esp_image_stream_t *stream)
+{
+    if (stream != NULL) {
+        if (stream->sha_handle != NULL) {
+            bootloader_sha256_finish(stream->sha_handle, NULL);
+        }
+        free(stream);
+    }
+}
+
+/* The checks of process_segment_data() on the app description, which is not read back from flash in full */
+static esp_err_t stream_verify_app_desc(esp_image_metadata_t *data)
+{
+    if (data->image.segment_count == 0 || is_bootloader(data->start_addr)) {
+        return ESP_OK;
+    }
+#if !CONFIG_IDF_TARGET_ESP32 || CONFIG_BOOTLOADER_APP_ANTI_ROLLBACK
+    esp_app_desc_t app_desc;
+    esp_err_t err = bootloader_flash_read(data->segment_data[0], &app_desc, sizeof(app_desc), true);
+    if (err != ESP_OK) {
+        return err;
+    }
+#if !CONFIG_IDF_TARGET_ESP32
+    err = bootloader_common_check_efuse_blk_validity(app_desc.min_efuse_blk_rev_full, app_desc.max_efuse_blk_rev_full);
+    if (err != ESP_OK) {
+        return err;
+    }
+#endif
+#if CONFIG_BOOTLOADER_APP_ANTI_ROLLBACK
+    data->secure_version = app_desc.secure_version;
+#endif
+#endif // !CONFIG_IDF_TARGET_ESP32 || CONFIG_BOOTLOADER_APP_ANTI_ROLLBACK
+    return ESP_OK;
+}
+
+esp_err_t esp_image_stream_verify(esp_image_stream_t *stream, esp_image_load_mode_t mode, const esp_partition_pos_t *part, esp_image_metadata_t *data, bool *streamed)
+{
+    bool silent = (mode == ESP_IMAGE_VERIFY_SILENT);
+    esp_err_t err = ESP_OK;
+    bool verify_sha;
+#if (SECURE_BOOT_CHECK_SIGNATURE == 1)
+    uint8_t image_digest[ESP_SECURE_BOOT_DIGEST_LEN] = { [ 0 ... ESP_SECURE_BOOT_DIGEST_LEN - 1 ] = 0xEE };
+    uint8_t verified_digest[ESP_SECURE_BOOT_DIGEST_LEN] = { [ 0 ... ESP_SECURE_BOOT_DIGEST_LEN - 1 ] = 0x01 };
+#endif
+
+    if (streamed) {
+        *streamed = false;
+    }
+    if (data == NULL || part == NULL) {
+        esp_image_stream_abort(stream);
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (stream == NULL || stream->state != STREAM_DONE) {
+        ESP_LOGD(TAG, "image was not streamed in full, verifying it from flash");
+        esp_image_stream_abort(stream);
+        return image_load(mode, part, data);
+    }
+
+#if CONFIG_SECURE_BOOT_V2_ENABLED
+    verify_sha = true;
+#else
+    verify_sha = !is_bootloader(part->offset);
+#endif
+
+    if (part->size > ESP_IMAGE_MAX_FLASH_ADDR_SIZE) {
+        err = ESP_ERR_INVALID_ARG;
+        FAIL_LOAD("partition size 0x%"PRIx32" invalid, larger than 16MB", part->size);
+    }
+
+    // Only the headers are read back from flash, the segment data was checksummed and hashed as it was streamed
+    CHECK_ERR(process_image_header(data, part->offset, NULL, true, silent));
+    CHECK_ERR(process_segments(data, silent, false, NULL, NULL));
+    if (memcmp(&data->image, &stream->image, sizeof(esp_image_header_t)) != 0 || data->image_len != stream->image_len) {
+        ESP_LOGW(TAG, "image on flash differs from the streamed image, verifying it from flash");
+        esp_image_stream_abort(stream);
+        return image_load(mode, part, data);
+    }
+    CHECK_ERR(stream_verify_app_desc(data));
+    bool skip_check_checksum = esp_cpu_dbgr_is_attached();
+    CHECK_ERR(process_checksum(NULL, stream->checksum_word, data, silent, skip_check_checksum));
+    CHECK_ERR(process_appended_hash_and_sig(data, part->offset, part->size, true, silent));
+    if (verify_sha) {
+#if (SECURE_BOOT_CHECK_SIGNATURE == 1)
+        ESP_LOGI(TAG, "Verifying image signature...");
+        memcpy(image_digest, stream->digest, ESP_SECURE_BOOT_DIGEST_LEN);
+        bootloader_debug_buffer(image_digest, ESP_SECURE_BOOT_DIGEST_LEN, "Calculated secure boot hash");
+        err = verify_signature_and_adjust_image_len(data, data->start_addr + stream->offset, image_digest, verified_digest);
+#else
+        if (data->image.hash_appended && !esp_cpu_dbgr_is_attached()) {
+            err = verify_simple_hash_digest(stream->digest, data);
+        }
+#endif
+    }
+    if (err != ESP_OK) {
+        goto err;
+    }
+    esp_image_stream_abort(stream);
+    if (streamed) {
+        *streamed = true;
+    }
+    return ESP_OK;
+
+err:
+    if (err == ESP_OK) {
+        err = ESP_ERR_IMAGE_INVALID;
+    }
+    esp_image_stream_abort(stream);
+    bzero(data, sizeof(esp_image_metadata_t));
+    return err;
+}
+
+#endif // !NON_OS_BUILD
@@ -17,6 +17,7 @@
 #include "sys/queue.h"
 
 #define ANSI_COLOR_DEFAULT      39      /** Default foreground color */
+#define CMD_HASH_BUCKETS        32      /** Number of buckets of the command table, a power of 2 */
 
 typedef struct cmd_item_ {
     /**
@@ -37,6 +38,8 @@ typedef struct cmd_item_ {
     void *argtable;                                     //!< optional pointer to arg table
     void *context;                                      //!< optional pointer to user context
     SLIST_ENTRY(cmd_item_) next;                        //!< next command in the list
+    SLIST_ENTRY(cmd_item_) hash_next;                   //!< next command in the same bucket of the command table
+    uint32_t hash;                                      //!< hash of the command name
 } cmd_item_t;
 
 typedef void (*const fn_print_arg_t)(cmd_item_t*);
@@ -44,13 +47,16 @@ typedef void (*const fn_print_arg_t)(cmd_item_t*);
 /** linked list of command structures */
 static SLIST_HEAD(cmd_list_, cmd_item_) s_cmd_list;
 
+/** command table, the commands are looked up by the hash of their name */
+static SLIST_HEAD(cmd_bucket_, cmd_item_) s_cmd_table[CMD_HASH_BUCKETS];
+
 /** run-time configuration options */
 static esp_console_config_t s_config = {
     .heap_alloc_caps = MALLOC_CAP_DEFAULT
 };
 
-/** temporary buffer used for command line parsing */
-static char *s_tmp_line_buf;
+/** set by esp_console_init */
+static bool s_console_inited;
 
 static const cmd_item_t *find_command_by_name(const char *name);
 
@@ -61,7 +67,7 @@ esp_err_t esp_console_init(const esp_console_config_t *config)
     if (!config) {
         return ESP_ERR_INVALID_ARG;
     }
-    if (s_tmp_line_buf) {
+    if (s_console_inited) {
         return ESP_ERR_INVALID_STATE;
     }
     memcpy(&s_config, config, sizeof(s_config));
@@ -71,20 +77,17 @@ esp_err_t esp_console_init(const esp_console_config_t *config)
     if (s_config.heap_alloc_caps == 0) {
         s_config.heap_alloc_caps = MALLOC_CAP_DEFAULT;
     }
-    s_tmp_line_buf = heap_caps_calloc(1, config->max_cmdline_length, s_config.heap_alloc_caps);
-    if (s_tmp_line_buf == NULL) {
-        return ESP_ERR_NO_MEM;
-    }
+    s_console_inited = true;
     return ESP_OK;
 }
 
 esp_err_t esp_console_deinit(void)
 {
-    if (!s_tmp_line_buf) {
+    if (!s_console_inited) {
         return ESP_ERR_INVALID_STATE;
     }
-    free(s_tmp_line_buf);
-    s_tmp_line_buf = NULL;
+    s_console_inited = false;
+    memset(s_cmd_table, 0, sizeof(s_cmd_table));
     cmd_item_t *it, *tmp;
     SLIST_FOREACH_SAFE(it, &s_cmd_list, next, tmp) {
         SLIST_REMOVE(&s_cmd_list, it, cmd_item_, next);
@@ -94,9 +97,20 @@ esp_err_t esp_console_deinit(void)
     return ESP_OK;
 }
 
+/* FNV-1a, command names are short and this spreads them well over the buckets */
+static uint32_t cmd_hash(const char *name)
+{
+    uint32_t hash = 2166136261u;
+    while (*name) {
+        hash = (hash ^ (uint8_t)*name++) * 16777619u;
+    }
+    return hash;
+}
+
 void esp_console_rm_item_free_hint(cmd_item_t *item)
 {
     SLIST_REMOVE(&s_cmd_list, item, cmd_item_, next);
+    SLIST_REMOVE(&s_cmd_table[item->hash & (CMD_HASH_BUCKETS - 1)], item, cmd_item_, hash_next);
     free(item->hint);
 }
 
@@ -136,6 +150,7 @@ esp_err_t esp_console_cmd_register(const esp_console_cmd_t *cmd)
         esp_console_rm_item_free_hint(item);
     }
     item->command = cmd->command;
+    item->hash = cmd_hash(cmd->command);
     item->help = cmd->help;
     if (cmd->hint) {
         /* Prepend a space before the hint. It separates command name and
@@ -183,6 +198,7 @@ esp_err_t esp_console_cmd_register(const esp_console_cmd_t *cmd)
 #endif
         SLIST_INSERT_AFTER(last, item, next);
     }
+    SLIST_INSERT_HEAD(&s_cmd_table[item->hash & (CMD_HASH_BUCKETS - 1)], item, hash_next);
     return ESP_OK;
 }
 
@@ -203,46 +219,43 @@ void esp_console_get_completion(const char *buf, linenoiseCompletions *lc)
 
 const char *esp_console_get_hint(const char *buf, int *color, int *bold)
 {
-    size_t len = strlen(buf);
-    cmd_item_t *it;
-    SLIST_FOREACH(it, &s_cmd_list, next) {
-        if (strlen(it->command) == len &&
-                strncmp(buf, it->command, len) == 0) {
-            *color = s_config.hint_color;
-            *bold = s_config.hint_bold;
-            return it->hint;
-        }
+    const cmd_item_t *it = find_command_by_name(buf);
+    if (it == NULL) {
+        return NULL;
     }
-    return NULL;
+    *color = s_config.hint_color;
+    *bold = s_config.hint_bold;
+    return it->hint;
 }
 
 static const cmd_item_t *find_command_by_name(const char *name)
 {
-    const cmd_item_t *cmd = NULL;
+    uint32_t hash = cmd_hash(name);
     cmd_item_t *it;
-    size_t len = strlen(name);
-    SLIST_FOREACH(it, &s_cmd_list, next) {
-        if (strlen(it->command) == len &&
-                strcmp(name, it->command) == 0) {
-            cmd = it;
-            break;
+    SLIST_FOREACH(it, &s_cmd_table[hash & (CMD_HASH_BUCKETS - 1)], hash_next) {
+        if (it->hash == hash && strcmp(name, it->command) == 0) {
+            return it;
         }
     }
-    return cmd;
+    return NULL;
 }
 
 esp_err_t esp_console_run(const char *cmdline, int *cmd_ret)
 {
-    if (s_tmp_line_buf == NULL) {
+    if (!s_console_inited) {
         return ESP_ERR_INVALID_STATE;
     }
-    char **argv = (char **) heap_caps_calloc(s_config.max_cmdline_args, sizeof(char *), s_config.heap_alloc_caps);
+    /* argv and the copy of the line being split are allocated per call,
+     * so that commands can be run by several tasks at once */
+    char **argv = (char **) heap_caps_calloc(1, s_config.max_cmdline_args * sizeof(char *) + s_config.max_cmdline_length,
+                                             s_config.heap_alloc_caps);
     if (argv == NULL) {
         return ESP_ERR_NO_MEM;
     }
-    strlcpy(s_tmp_line_buf, cmdline, s_config.max_cmdline_length);
+    char *line_buf = (char *) &argv[s_config.max_cmdline_args];
+    strlcpy(line_buf, cmdline, s_config.max_cmdline_length);
 
-    size_t argc = esp_console_split_argv(s_tmp_line_buf, argv,
+    size_t argc = esp_console_split_argv(line_buf, argv,
                                          s_config.max_cmdline_args);
     if (argc == 0) {
         free(argv);
@@ -339,16 +352,11 @@ static int help_command(int argc, char **argv)
     } else {
         /* Print summary of given command, verbose option will be ignored */
         bool found_command = false;
-        SLIST_FOREACH(it, &s_cmd_list, next) {
-            if (it->help == NULL) {
-                continue;
-            }
-            if (strcmp(help_args.help_cmd->sval[0], it->command) == 0) {
-                print_arg_help(it);
-                found_command = true;
-                ret_value = 0;
-                break;
-            }
+        it = (cmd_item_t *)find_command_by_name(help_args.help_cmd->sval[0]);
+        if (it != NULL && it->help != NULL) {
+            print_arg_help(it);
+            found_command = true;
+            ret_value = 0;
         }
 
         /* If given command has not been found, print error message*/
@@ -248,6 +248,7 @@ esp_err_t esp_console_cmd_deregister(const char *cmd_name);
 
 /**
  * @brief Run command line
+ * @note  Can be called by several tasks at once, e.g. by the workers of a console server
  * @param cmdline command line (command name followed by a number of arguments)
  * @param[out] cmd_ret return code from the command (set if command was run)
  * @return
@@ -468,6 +469,115 @@ esp_err_t esp_console_start_repl(esp_console_repl_t *repl);
  */
 esp_err_t esp_console_stop_repl(esp_console_repl_t *repl);
 
+#if CONFIG_VFS_SUPPORT_SELECT || __DOXYGEN__
+/******************************************************************************
+ *              Console server
+ ******************************************************************************/
+
+/**
+ * @brief Type defined for console server, which serves several sessions at once
+ *
+ */
+typedef struct esp_console_server_s *esp_console_server_handle_t;
+
+/**
+ * @brief Parameters for console server
+ *
+ */
+typedef struct {
+    size_t max_sessions;           //!< maximum number of sessions served at once
+    size_t worker_num;             //!< number of tasks running the commands, i.e. commands which can run at once
+    uint32_t task_stack_size;      //!< stack size of the I/O task and of each worker
+    uint32_t task_priority;        //!< priority of the I/O task and of the workers
+    BaseType_t task_core_id;       //!< affinity of the I/O task and of the workers
+    const char *prompt;            //!< prompt (NULL represents default: "esp> ")
+    size_t max_cmdline_length;     //!< maximum length of a command line. If 0, default value will be used
+} esp_console_server_config_t;
+
+/**
+ * @brief Default console server configuration value
+ *
+ */
+#define ESP_CONSOLE_SERVER_CONFIG_DEFAULT() \
+{                                           \
+        .max_sessions = 4,                  \
+        .worker_num = 2,                    \
+        .task_stack_size = 4096,            \
+        .task_priority = 2,                 \
+        .task_core_id = tskNO_AFFINITY,     \
+        .prompt = NULL,                     \
+        .max_cmdline_length = 0,            \
+}
+
+/**
+ * @brief Create a console server
+ *
+ * A single I/O task reads the command lines of all the sessions and hands them to a pool of worker tasks,
+ * so a long-running command only holds its own session: the other sessions keep being served.
+ * The commands of a session run one at a time, in the order they were received.
+ *
+ * Sessions read plain lines, without line editing or history. Telnet option negotiation is ignored.
+ *
+ * @note The commands are looked up in the command table shared with the REPL, so esp_console_init must be called
+ *       before lines are received.
+ *       Each worker prints the output of a command to the session it runs it for. On chips, its stdout is redirected.
+ *       On Linux, stdout is shared by all the threads, so the first server replaces it by an unbuffered stream which
+ *       writes to the session of the calling worker, or to the previous stdout for the other tasks.
+ *
+ * @param[in] config server configuration
+ * @param[out] ret_server return server handle after creation succeed, return NULL otherwise
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if an argument is invalid
+ *      - ESP_ERR_NO_MEM if out of memory
+ *      - ESP_FAIL if the tasks can not be created
+ */
+esp_err_t esp_console_server_new(const esp_console_server_config_t *config, esp_console_server_handle_t *ret_server);
+
+/**
+ * @brief Add a session to a console server
+ *
+ * @param[in] server server handle returned from esp_console_server_new
+ * @param[in] in_fd file descriptor the command lines are read from, e.g. a UART opened through VFS or a socket
+ * @param[in] out_fd file descriptor the output is written to, can be the same as in_fd
+ * @note The server owns the file descriptors, it closes them when the session ends on end of file or error,
+ *       or when the server is deleted.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if an argument is invalid
+ *      - ESP_ERR_NO_MEM if max_sessions sessions are already served, or out of memory
+ */
+esp_err_t esp_console_server_add_session(esp_console_server_handle_t server, int in_fd, int out_fd);
+
+#if CONFIG_IDF_TARGET_LINUX || __DOXYGEN__
+/**
+ * @brief Accept TCP (e.g. telnet) connections as sessions of a console server
+ *
+ * @param[in] server server handle returned from esp_console_server_new
+ * @param[in] port TCP port to listen on, on all the interfaces
+ * @note Only available on Linux target. On chips, accept the connections and add them with esp_console_server_add_session.
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if server is NULL
+ *      - ESP_ERR_INVALID_STATE if the server already listens
+ *      - ESP_FAIL if the socket can not be created or bound
+ */
+esp_err_t esp_console_server_listen_tcp(esp_console_server_handle_t server, uint16_t port);
+#endif // CONFIG_IDF_TARGET_LINUX || __DOXYGEN__
+
+/**
+ * @brief Delete a console server
+ *
+ * Waits for the commands being run to return, then closes all the sessions.
+ *
+ * @param[in] server server handle returned from esp_console_server_new
+ * @return
+ *      - ESP_OK on success
+ *      - ESP_ERR_INVALID_ARG if server is NULL
+ */
+esp_err_t esp_console_server_delete(esp_console_server_handle_t server);
+#endif // CONFIG_VFS_SUPPORT_SELECT || __DOXYGEN__
+
 #ifdef __cplusplus
 }
 #endif
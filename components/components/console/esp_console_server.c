@@ -0,0 +1,640 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include "sdkconfig.h"
+#if CONFIG_IDF_TARGET_LINUX && !defined(_GNU_SOURCE)
+#define _GNU_SOURCE                 // fopencookie
+#endif
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/select.h>
+#include <sys/param.h>
+#if CONFIG_IDF_TARGET_LINUX
+#include <sys/socket.h>
+#include <netinet/in.h>
+#endif
+#include "esp_console.h"
+#include "console_private.h"
+#include "esp_log.h"
+#include "freertos/queue.h"
+
+#if CONFIG_VFS_SUPPORT_SELECT
+
+/* The I/O task waits for the sessions at most this long, so that it sees the sessions which were added
+ * and the request to stop the server */
+#define CONSOLE_SERVER_POLL_MS      (50)
+/* Same, while the input buffer of a session is full, so that the session is read again soon after a worker
+ * takes lines from it */
+#define CONSOLE_SERVER_THROTTLED_POLL_MS (1)
+/* Bytes read from a session at once */
+#define CONSOLE_SERVER_READ_LEN     (128)
+
+#define TELNET_IAC                  (255)
+#define TELNET_SB                   (250)
+#define TELNET_SE                   (240)
+#define TELNET_WILL                 (251)
+
+static const char *TAG = "console.server";
+
+typedef enum {
+    SESSION_TELNET_DATA,
+    SESSION_TELNET_IAC,             // received IAC
+    SESSION_TELNET_OPTION,          // received IAC and WILL, WONT, DO or DONT
+    SESSION_TELNET_SUB,             // in a subnegotiation
+    SESSION_TELNET_SUB_IAC,         // received IAC in a subnegotiation
+} session_telnet_state_t;
+
+typedef struct {
+    struct esp_console_server_s *server;
+    int in_fd;
+    int out_fd;
+#if !CONFIG_IDF_TARGET_LINUX
+    FILE *out_file;                 // stdout of the worker running a command of the session
+#endif
+    bool busy;                      // a line of the session is queued or run, the next one waits for it
+    bool eof;                       // nothing more can be read, the session ends after its last line
+    bool discard;                   // the line being received is too long, it is dropped until its end
+    bool too_long;                  // the line run by a worker was dropped as too long
+    session_telnet_state_t telnet;
+    size_t in_len;
+    char *in_buf;                   // bytes received and not run yet, max_cmdline_length bytes
+    char *line;                     // line run by a worker
+} server_session_t;
+
+struct esp_console_server_s {
+    size_t max_sessions;
+    size_t worker_num;
+    size_t max_cmdline_length;
+    char prompt[CONSOLE_PROMPT_MAX_LEN];
+    SemaphoreHandle_t lock;         // protects the sessions and their input buffers
+    server_session_t **sessions;
+    server_session_t **ready;       // sessions which can be read, used by the I/O task
+    QueueHandle_t jobs;             // sessions with a line to run, NULL stops a worker
+    SemaphoreHandle_t task_done;    // given by each task when it returns
+    int listen_fd;
+    volatile bool stopping;
+};
+
+static void fd_write(int fd, const char *buf, size_t len)
+{
+    while (len > 0) {
+        ssize_t n = write(fd, buf, len);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            // the session is closed by the I/O task once it reads the end of file
+            return;
+        }
+        buf += n;
+        len -= n;
+    }
+}
+
+static void session_write(server_session_t *s, const char *str)
+{
+    fd_write(s->out_fd, str, strlen(str));
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+/* stdout is shared by all the threads on Linux. Once a server is created, it is replaced by an unbuffered stream
+ * which writes to the session of the worker thread running a command, and to the previous stdout otherwise. */
+static __thread int s_command_out_fd = -1;
+static FILE *s_process_stdout;
+
+static void session_stdout_forward(const char *buf, size_t len)
+{
+    if (s_command_out_fd >= 0) {
+        fd_write(s_command_out_fd, buf, len);
+    } else {
+        fwrite(buf, 1, len, s_process_stdout);
+        fflush(s_process_stdout);
+    }
+}
+
+#ifdef __APPLE__
+static int session_stdout_write(void *cookie, const char *buf, int len)
+{
+    session_stdout_forward(buf, len);
+    return len;
+}
+#else
+static ssize_t session_stdout_write(void *cookie, const char *buf, size_t len)
+{
+    session_stdout_forward(buf, len);
+    return len;
+}
+#endif
+
+static esp_err_t session_stdout_install(void)
+{
+    static portMUX_TYPE install_lock = portMUX_INITIALIZER_UNLOCKED;
+    esp_err_t ret = ESP_OK;
+    // servers may be created by several tasks at once
+    portENTER_CRITICAL(&install_lock);
+    if (s_process_stdout == NULL) {
+#ifdef __APPLE__
+        FILE *f = funopen(NULL, NULL, session_stdout_write, NULL, NULL);
+#else
+        FILE *f = fopencookie(NULL, "w", (cookie_io_functions_t) {
+            .write = session_stdout_write,
+        });
+#endif
+        if (f == NULL || setvbuf(f, NULL, _IONBF, 0) != 0) {
+            if (f) {
+                fclose(f);
+            }
+            ret = ESP_ERR_NO_MEM;
+        } else {
+            fflush(stdout);
+            s_process_stdout = stdout;
+            stdout = f;
+        }
+    }
+    portEXIT_CRITICAL(&install_lock);
+    return ret;
+}
+#endif // CONFIG_IDF_TARGET_LINUX
+
+static void session_free(server_session_t *s)
+{
+#if !CONFIG_IDF_TARGET_LINUX
+    if (s->out_file) {
+        // closes out_fd as well, which may be in_fd
+        fclose(s->out_file);
+        if (s->in_fd == s->out_fd) {
+            s->in_fd = -1;
+        }
+        s->out_fd = -1;
+    }
+#endif
+    if (s->out_fd >= 0 && s->out_fd != s->in_fd) {
+        close(s->out_fd);
+    }
+    if (s->in_fd >= 0) {
+        close(s->in_fd);
+    }
+    free(s);
+}
+
+/* Must be called with the lock held. Moves the next complete line of the session to s->line. */
+static bool session_next_line(server_session_t *s)
+{
+    char *end = memchr(s->in_buf, '\n', s->in_len);
+    size_t len;
+    if (end) {
+        len = end - s->in_buf;
+    } else if (s->eof && s->in_len > 0) {
+        // the last line does not need a line end
+        len = s->in_len;
+    } else if (s->in_len == s->server->max_cmdline_length) {
+        // the line can not be run, it is dropped until its end and the worker reports it
+        s->in_len = 0;
+        s->discard = true;
+        s->too_long = true;
+        return true;
+    } else {
+        return false;
+    }
+    memcpy(s->line, s->in_buf, len);
+    if (len > 0 && s->line[len - 1] == '\r') {
+        len--;
+    }
+    s->line[len] = '\0';
+    size_t consumed = end ? (size_t)(end - s->in_buf) + 1 : s->in_len;
+    memmove(s->in_buf, s->in_buf + consumed, s->in_len - consumed);
+    s->in_len -= consumed;
+    return true;
+}
+
+/* Must be called with the lock held. Queues the next line of an idle session, returns true if the session
+ * is over and has been removed from the server. */
+static bool session_dispatch(server_session_t *s)
+{
+    struct esp_console_server_s *server = s->server;
+    if (s->busy) {
+        return false;
+    }
+    if (session_next_line(s)) {
+        s->busy = true;
+        // the queue has room for all the sessions, so this does not wait
+        xQueueSend(server->jobs, &s, 0);
+        return false;
+    }
+    if (!s->eof) {
+        return false;
+    }
+    for (size_t i = 0; i < server->max_sessions; i++) {
+        if (server->sessions[i] == s) {
+            server->sessions[i] = NULL;
+        }
+    }
+    return true;
+}
+
+static void session_run_line(server_session_t *s)
+{
+    if (s->too_long) {
+        s->too_long = false;
+        session_write(s, "Command line too long\r\n");
+        session_write(s, s->server->prompt);
+        return;
+    }
+    int ret;
+    // the output of the command goes to the session
+#if CONFIG_IDF_TARGET_LINUX
+    s_command_out_fd = s->out_fd;
+    esp_err_t err = esp_console_run(s->line, &ret);
+    s_command_out_fd = -1;
+#else
+    // stdout is per task on chips
+    FILE *task_stdout = stdout;
+    stdout = s->out_file;
+    esp_err_t err = esp_console_run(s->line, &ret);
+    fflush(stdout);
+    stdout = task_stdout;
+#endif
+    char msg[80];
+    msg[0] = '\0';
+    if (err == ESP_ERR_NOT_FOUND) {
+        snprintf(msg, sizeof(msg), "Unrecognized command\r\n");
+    } else if (err == ESP_ERR_INVALID_ARG) {
+        // command was empty
+    } else if (err == ESP_OK && ret != ESP_OK) {
+        snprintf(msg, sizeof(msg), "Command returned non-zero error code: 0x%x (%s)\r\n", ret, esp_err_to_name(ret));
+    } else if (err != ESP_OK) {
+        snprintf(msg, sizeof(msg), "Internal error: %s\r\n", esp_err_to_name(err));
+    }
+    session_write(s, msg);
+    session_write(s, s->server->prompt);
+}
+
+static void esp_console_server_worker(void *args)
+{
+    struct esp_console_server_s *server = (struct esp_console_server_s *)args;
+    server_session_t *s;
+
+    while (xQueueReceive(server->jobs, &s, portMAX_DELAY) == pdTRUE && s != NULL) {
+        session_run_line(s);
+
+        xSemaphoreTake(server->lock, portMAX_DELAY);
+        s->busy = false;
+        // the next line of the session goes to the back of the queue, so that all sessions are served in turn
+        bool ended = session_dispatch(s);
+        xSemaphoreGive(server->lock);
+        if (ended) {
+            session_free(s);
+        }
+    }
+    xSemaphoreGive(server->task_done);
+    vTaskDelete(NULL);
+}
+
+/* Drops the telnet commands, which are sent by telnet clients to negotiate options */
+static size_t session_filter_telnet(server_session_t *s, char *buf, size_t len)
+{
+    size_t out = 0;
+    for (size_t i = 0; i < len; i++) {
+        uint8_t c = buf[i];
+        switch (s->telnet) {
+        case SESSION_TELNET_DATA:
+            if (c == TELNET_IAC) {
+                s->telnet = SESSION_TELNET_IAC;
+            } else if (c != '\0') {
+                buf[out++] = c;
+            }
+            break;
+        case SESSION_TELNET_IAC:
+            if (c == TELNET_IAC) {
+                // escaped 255 data byte, which can not be part of a command
+                s->telnet = SESSION_TELNET_DATA;
+            } else if (c == TELNET_SB) {
+                s->telnet = SESSION_TELNET_SUB;
+            } else if (c >= TELNET_WILL) {
+                s->telnet = SESSION_TELNET_OPTION;
+            } else {
+                s->telnet = SESSION_TELNET_DATA;
+            }
+            break;
+        case SESSION_TELNET_OPTION:
+            s->telnet = SESSION_TELNET_DATA;
+            break;
+        case SESSION_TELNET_SUB:
+            if (c == TELNET_IAC) {
+                s->telnet = SESSION_TELNET_SUB_IAC;
+            }
+            break;
+        case SESSION_TELNET_SUB_IAC:
+            s->telnet = (c == TELNET_SE) ? SESSION_TELNET_DATA : SESSION_TELNET_SUB;
+            break;
+        }
+    }
+    return out;
+}
+
+static void esp_console_server_read(server_session_t *s)
+{
+    struct esp_console_server_s *server = s->server;
+    char buf[CONSOLE_SERVER_READ_LEN];
+
+    // only the I/O task appends to the input buffer, so the room left can only grow until the lock is taken
+    xSemaphoreTake(server->lock, portMAX_DELAY);
+    size_t room = server->max_cmdline_length - s->in_len;
+    xSemaphoreGive(server->lock);
+
+    ssize_t n = read(s->in_fd, buf, MIN(room, sizeof(buf)));
+    if (n < 0 && (errno == EINTR || errno == EAGAIN)) {
+        return;
+    }
+    // the bytes read may all be telnet commands, which leave no data but do not end the session
+    size_t len = (n > 0) ? session_filter_telnet(s, buf, n) : 0;
+
+    xSemaphoreTake(server->lock, portMAX_DELAY);
+    if (n <= 0) {
+        s->eof = true;
+    }
+    for (size_t i = 0; i < len; i++) {
+        if (s->discard) {
+            s->discard = (buf[i] != '\n');
+            continue;
+        }
+        s->in_buf[s->in_len++] = buf[i];
+    }
+    bool ended = session_dispatch(s);
+    xSemaphoreGive(server->lock);
+
+    if (ended) {
+        session_free(s);
+    }
+}
+
+static server_session_t *session_new(struct esp_console_server_s *server, int in_fd, int out_fd)
+{
+    server_session_t *s = calloc(1, sizeof(server_session_t) + 2 * server->max_cmdline_length + 1);
+    if (s == NULL) {
+        return NULL;
+    }
+    s->server = server;
+    s->in_fd = in_fd;
+    s->out_fd = out_fd;
+    s->in_buf = (char *)(s + 1);
+    s->line = s->in_buf + server->max_cmdline_length;
+    return s;
+}
+
+esp_err_t esp_console_server_add_session(esp_console_server_handle_t server, int in_fd, int out_fd)
+{
+    if (server == NULL || in_fd < 0 || out_fd < 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    server_session_t *s = session_new(server, in_fd, out_fd);
+    if (s == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    esp_err_t ret = ESP_ERR_NO_MEM;
+    xSemaphoreTake(server->lock, portMAX_DELAY);
+    for (size_t i = 0; i < server->max_sessions; i++) {
+        if (server->sessions[i] == NULL) {
+#if !CONFIG_IDF_TARGET_LINUX
+            s->out_file = fdopen(out_fd, "w");
+            if (s->out_file == NULL) {
+                break;
+            }
+#endif
+            session_write(s, server->prompt);
+            server->sessions[i] = s;
+            ret = ESP_OK;
+            break;
+        }
+    }
+    xSemaphoreGive(server->lock);
+    if (ret != ESP_OK) {
+        // the caller keeps the file descriptors
+        free(s);
+    }
+    return ret;
+}
+
+static void esp_console_server_io_task(void *args)
+{
+    struct esp_console_server_s *server = (struct esp_console_server_s *)args;
+    server_session_t **ready = server->ready;
+
+    while (!server->stopping) {
+        fd_set read_fds;
+        FD_ZERO(&read_fds);
+        int max_fd = -1;
+        bool throttled = false;
+        if (server->listen_fd >= 0) {
+            FD_SET(server->listen_fd, &read_fds);
+            max_fd = server->listen_fd;
+        }
+        xSemaphoreTake(server->lock, portMAX_DELAY);
+        for (size_t i = 0; i < server->max_sessions; i++) {
+            server_session_t *s = server->sessions[i];
+            // a full input buffer is not read until the worker running the session has taken lines from it
+            if (s && !s->eof && s->in_len < server->max_cmdline_length) {
+                FD_SET(s->in_fd, &read_fds);
+                max_fd = MAX(max_fd, s->in_fd);
+            } else if (s && !s->eof) {
+                throttled = true;
+            }
+        }
+        xSemaphoreGive(server->lock);
+
+        struct timeval tv = {
+            .tv_sec = 0,
+            .tv_usec = (throttled ? CONSOLE_SERVER_THROTTLED_POLL_MS : CONSOLE_SERVER_POLL_MS) * 1000,
+        };
+        int nready = select(max_fd + 1, &read_fds, NULL, NULL, &tv);
+        if (nready < 0) {
+            if (errno != EINTR) {
+                ESP_LOGE(TAG, "select failed (%d)", errno);
+                vTaskDelay(pdMS_TO_TICKS(CONSOLE_SERVER_POLL_MS));
+            }
+            continue;
+        }
+        if (nready == 0) {
+            continue;
+        }
+
+        // sessions are only freed by this task or by a worker after their end of file was read by this task,
+        // so the ones which are ready stay valid
+        size_t ready_num = 0;
+        xSemaphoreTake(server->lock, portMAX_DELAY);
+        for (size_t i = 0; i < server->max_sessions; i++) {
+            server_session_t *s = server->sessions[i];
+            if (s && FD_ISSET(s->in_fd, &read_fds)) {
+                ready[ready_num++] = s;
+            }
+        }
+        xSemaphoreGive(server->lock);
+        for (size_t i = 0; i < ready_num; i++) {
+            esp_console_server_read(ready[i]);
+        }
+
+#if CONFIG_IDF_TARGET_LINUX
+        if (server->listen_fd >= 0 && FD_ISSET(server->listen_fd, &read_fds)) {
+            int fd = accept(server->listen_fd, NULL, NULL);
+            if (fd >= 0 && esp_console_server_add_session(server, fd, fd) != ESP_OK) {
+                const char *msg = "Too many sessions\r\n";
+                int unused __attribute__((unused));
+                unused = write(fd, msg, strlen(msg));
+                close(fd);
+            }
+        }
+#endif
+    }
+    xSemaphoreGive(server->task_done);
+    vTaskDelete(NULL);
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+esp_err_t esp_console_server_listen_tcp(esp_console_server_handle_t server, uint16_t port)
+{
+    if (server == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (server->listen_fd >= 0) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int fd = socket(AF_INET, SOCK_STREAM, 0);
+    if (fd < 0) {
+        ESP_LOGE(TAG, "socket failed (%d)", errno);
+        return ESP_FAIL;
+    }
+    int reuse = 1;
+    setsockopt(fd, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(port),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(fd, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(fd, server->max_sessions) != 0) {
+        ESP_LOGE(TAG, "listening on port %u failed (%d)", port, errno);
+        close(fd);
+        return ESP_FAIL;
+    }
+    server->listen_fd = fd;
+    return ESP_OK;
+}
+#endif // CONFIG_IDF_TARGET_LINUX
+
+static void esp_console_server_free(struct esp_console_server_s *server)
+{
+    if (server->sessions) {
+        for (size_t i = 0; i < server->max_sessions; i++) {
+            if (server->sessions[i]) {
+                session_free(server->sessions[i]);
+            }
+        }
+        free(server->sessions);
+    }
+    free(server->ready);
+    if (server->listen_fd >= 0) {
+        close(server->listen_fd);
+    }
+    if (server->jobs) {
+        vQueueDelete(server->jobs);
+    }
+    if (server->task_done) {
+        vSemaphoreDelete(server->task_done);
+    }
+    if (server->lock) {
+        vSemaphoreDelete(server->lock);
+    }
+    free(server);
+}
+
+/* Stops the tasks which were created, the I/O task being the first one */
+static void esp_console_server_stop(struct esp_console_server_s *server, size_t task_num)
+{
+    if (task_num == 0) {
+        return;
+    }
+    server->stopping = true;
+    xSemaphoreTake(server->task_done, portMAX_DELAY);
+    // the workers run the lines queued before they get the request to stop
+    server_session_t *stop = NULL;
+    for (size_t i = 1; i < task_num; i++) {
+        xQueueSend(server->jobs, &stop, portMAX_DELAY);
+    }
+    for (size_t i = 1; i < task_num; i++) {
+        xSemaphoreTake(server->task_done, portMAX_DELAY);
+    }
+}
+
+esp_err_t esp_console_server_new(const esp_console_server_config_t *config, esp_console_server_handle_t *ret_server)
+{
+    if (config == NULL || ret_server == NULL || config->max_sessions == 0 || config->worker_num == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    *ret_server = NULL;
+#if CONFIG_IDF_TARGET_LINUX
+    if (session_stdout_install() != ESP_OK) {
+        return ESP_ERR_NO_MEM;
+    }
+#endif
+
+    struct esp_console_server_s *server = calloc(1, sizeof(struct esp_console_server_s));
+    if (server == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    server->max_sessions = config->max_sessions;
+    server->worker_num = config->worker_num;
+    server->max_cmdline_length = config->max_cmdline_length ? config->max_cmdline_length : console_config.max_cmdline_length;
+    server->listen_fd = -1;
+    // sessions may be remote terminals, which do not support escape sequences
+    snprintf(server->prompt, sizeof(server->prompt), "%s ", config->prompt ? config->prompt : "esp>");
+
+    server->sessions = calloc(config->max_sessions, sizeof(server_session_t *));
+    server->ready = calloc(config->max_sessions, sizeof(server_session_t *));
+    server->lock = xSemaphoreCreateMutex();
+    server->task_done = xSemaphoreCreateCounting(config->worker_num + 1, 0);
+    // each session is queued at most once, and each worker gets one request to stop
+    server->jobs = xQueueCreate(config->max_sessions + config->worker_num, sizeof(server_session_t *));
+    if (server->sessions == NULL || server->ready == NULL || server->lock == NULL || server->task_done == NULL || server->jobs == NULL) {
+        esp_console_server_free(server);
+        return ESP_ERR_NO_MEM;
+    }
+
+    size_t task_num = 0;
+    if (xTaskCreatePinnedToCore(esp_console_server_io_task, "console_io", config->task_stack_size,
+                                server, config->task_priority, NULL, config->task_core_id) == pdPASS) {
+        task_num++;
+        while (task_num <= config->worker_num &&
+                xTaskCreatePinnedToCore(esp_console_server_worker, "console_worker", config->task_stack_size,
+                                        server, config->task_priority, NULL, config->task_core_id) == pdPASS) {
+            task_num++;
+        }
+    }
+    if (task_num != config->worker_num + 1) {
+        ESP_LOGE(TAG, "creating the tasks failed");
+        esp_console_server_stop(server, task_num);
+        esp_console_server_free(server);
+        return ESP_FAIL;
+    }
+
+    *ret_server = server;
+    return ESP_OK;
+}
+
+esp_err_t esp_console_server_delete(esp_console_server_handle_t server)
+{
+    if (server == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_console_server_stop(server, server->worker_num + 1);
+    esp_console_server_free(server);
+    return ESP_OK;
+}
+
+#endif // CONFIG_VFS_SUPPORT_SELECT
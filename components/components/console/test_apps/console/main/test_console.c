@@ -5,6 +5,8 @@
  */
 #include <stdio.h>
 #include <string.h>
+#include <stdlib.h>
+#include <inttypes.h>
 #include "sdkconfig.h"
 #include "unity.h"
 #include "esp_console.h"
@@ -13,6 +15,12 @@
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
 #include "freertos/semphr.h"
+#if CONFIG_IDF_TARGET_LINUX
+#include <errno.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <sys/socket.h>
+#endif
 
 /*
  * NOTE: Most of these unit tests DO NOT work standalone. They require pytest to control
@@ -330,6 +338,243 @@ TEST_CASE("esp console test with context", "[console]")
     TEST_ESP_OK(esp_console_deinit());
 }
 
+TEST_CASE("esp console finds commands among many registered ones", "[console]")
+{
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_console_init(&console_config));
+
+    static char names[100][8];
+    for (int i = 0; i < 100; i++) {
+        snprintf(names[i], sizeof(names[i]), "cmd%d", i);
+        const esp_console_cmd_t cmd = {
+            .command = names[i],
+            .func = do_hello_cmd,
+        };
+        TEST_ESP_OK(esp_console_cmd_register(&cmd));
+    }
+    for (int i = 0; i < 100; i += 2) {
+        TEST_ESP_OK(esp_console_cmd_deregister(names[i]));
+    }
+
+    int ret;
+    for (int i = 0; i < 100; i++) {
+        TEST_ESP_ERR((i % 2) ? ESP_OK : ESP_ERR_NOT_FOUND, esp_console_run(names[i], &ret));
+    }
+    TEST_ESP_ERR(ESP_ERR_NOT_FOUND, esp_console_run("cmd", &ret));
+    TEST_ESP_OK(esp_console_deinit());
+}
+
+#if CONFIG_IDF_TARGET_LINUX
+#define TEST_SERVER_SESSIONS    4
+#define TEST_SERVER_LINES       1000
+
+static int s_seq_last[TEST_SERVER_SESSIONS];
+
+// "seq <session> <n>" checks that the lines of a session run in order
+static int do_seq_cmd(int argc, char **argv)
+{
+    int session = atoi(argv[1]);
+    int n = atoi(argv[2]);
+    if (n != s_seq_last[session] + 1) {
+        return 1;
+    }
+    s_seq_last[session] = n;
+    printf("seq %d done\n", session);
+    return 0;
+}
+
+static int do_sleep_cmd(int argc, char **argv)
+{
+    vTaskDelay(pdMS_TO_TICKS(500));
+    return 0;
+}
+
+typedef struct {
+    size_t prompt;                  // bytes of the prompt matched
+    size_t output;                  // bytes of the output of seq matched, for any session
+    size_t own_output;              // bytes of the output of seq matched, for this session
+    int outputs;                    // outputs of seq received, for any session
+    int own_outputs;                // outputs of seq received, for this session
+} test_server_match_t;
+
+static test_server_match_t s_match[TEST_SERVER_SESSIONS];
+
+// Returns true when c ends an occurrence of str, matched holds the bytes of str matched so far
+static bool test_server_match(const char *str, size_t *matched, char c)
+{
+    *matched = (c == str[*matched]) ? *matched + 1 : (c == str[0]);
+    if (str[*matched] == '\0') {
+        *matched = 0;
+        return true;
+    }
+    return false;
+}
+
+// Counts the prompts which can be read from the non-blocking socket of a session, and the outputs of seq
+static int test_server_read_prompts(int session, int fd)
+{
+    test_server_match_t *match = &s_match[session];
+    char own_output[32];
+    snprintf(own_output, sizeof(own_output), "seq %d done\n", session);
+    int found = 0;
+    char buf[256];
+    ssize_t n;
+    while ((n = read(fd, buf, sizeof(buf))) > 0) {
+        for (ssize_t i = 0; i < n; i++) {
+            found += test_server_match("esp> ", &match->prompt, buf[i]);
+            match->outputs += test_server_match(" done\n", &match->output, buf[i]);
+            match->own_outputs += test_server_match(own_output, &match->own_output, buf[i]);
+        }
+    }
+    return found;
+}
+
+// Counts the prompts received on a non-blocking socket, until count of them or the timeout
+static int test_server_wait_prompts(int session, int fd, int count, int timeout_ms)
+{
+    int found = 0;
+    TickType_t start = xTaskGetTickCount();
+    while (found < count && xTaskGetTickCount() - start < pdMS_TO_TICKS(timeout_ms)) {
+        int n = test_server_read_prompts(session, fd);
+        if (n == 0) {
+            vTaskDelay(1);
+        }
+        found += n;
+    }
+    return found;
+}
+
+TEST_CASE("esp console server runs the scripts of several sessions", "[console]")
+{
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_console_init(&console_config));
+    const esp_console_cmd_t seq_cmd = {
+        .command = "seq",
+        .func = do_seq_cmd,
+    };
+    const esp_console_cmd_t sleep_cmd = {
+        .command = "sleep",
+        .func = do_sleep_cmd,
+    };
+    TEST_ESP_OK(esp_console_cmd_register(&seq_cmd));
+    TEST_ESP_OK(esp_console_cmd_register(&sleep_cmd));
+
+    esp_console_server_config_t server_config = ESP_CONSOLE_SERVER_CONFIG_DEFAULT();
+    server_config.max_sessions = TEST_SERVER_SESSIONS;
+    esp_console_server_handle_t server;
+    TEST_ESP_OK(esp_console_server_new(&server_config, &server));
+
+    int fds[TEST_SERVER_SESSIONS][2];
+    memset(s_match, 0, sizeof(s_match));
+    for (int i = 0; i < TEST_SERVER_SESSIONS; i++) {
+        TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds[i]));
+        TEST_ASSERT_EQUAL(0, fcntl(fds[i][0], F_SETFL, O_NONBLOCK));
+        TEST_ESP_OK(esp_console_server_add_session(server, fds[i][1], fds[i][1]));
+        TEST_ASSERT_EQUAL(1, test_server_wait_prompts(i, fds[i][0], 1, 1000));
+        s_seq_last[i] = 0;
+    }
+    int extra[2];
+    TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, extra));
+    TEST_ESP_ERR(ESP_ERR_NO_MEM, esp_console_server_add_session(server, extra[1], extra[1]));
+    close(extra[0]);
+    close(extra[1]);
+
+    // a long-running command only holds its own session
+    TEST_ASSERT_EQUAL(6, write(fds[0][0], "sleep\n", 6));
+    TEST_ASSERT_EQUAL(10, write(fds[1][0], "seq 1 1\r\n", 10));
+    TEST_ASSERT_EQUAL(1, test_server_wait_prompts(1, fds[1][0], 1, 250));
+    TEST_ASSERT_EQUAL(1, test_server_wait_prompts(0, fds[0][0], 1, 1000));
+
+    // scripted throughput, all sessions at once
+    int sent[TEST_SERVER_SESSIONS];
+    int done[TEST_SERVER_SESSIONS];
+    int done_total = 0;
+    for (int i = 0; i < TEST_SERVER_SESSIONS; i++) {
+        sent[i] = done[i] = s_seq_last[i];
+    }
+    TickType_t start = xTaskGetTickCount();
+    while (done_total < TEST_SERVER_SESSIONS * TEST_SERVER_LINES - 1) {
+        TEST_ASSERT_LESS_THAN(pdMS_TO_TICKS(10000), xTaskGetTickCount() - start);
+        bool idle = true;
+        for (int i = 0; i < TEST_SERVER_SESSIONS; i++) {
+            char line[32];
+            int len = snprintf(line, sizeof(line), "seq %d %d\n", i, sent[i] + 1);
+            if (sent[i] < TEST_SERVER_LINES && write(fds[i][0], line, len) == len) {
+                sent[i]++;
+                idle = false;
+            }
+            int n = test_server_read_prompts(i, fds[i][0]);
+            done[i] += n;
+            done_total += n;
+            idle = idle && n == 0;
+        }
+        if (idle) {
+            vTaskDelay(1);
+        }
+    }
+    uint32_t ms = pdTICKS_TO_MS(xTaskGetTickCount() - start);
+    for (int i = 0; i < TEST_SERVER_SESSIONS; i++) {
+        TEST_ASSERT_EQUAL(TEST_SERVER_LINES, done[i]);
+        TEST_ASSERT_EQUAL(TEST_SERVER_LINES, s_seq_last[i]);
+        // the output of each command went to its own session only
+        TEST_ASSERT_EQUAL(TEST_SERVER_LINES, s_match[i].outputs);
+        TEST_ASSERT_EQUAL(TEST_SERVER_LINES, s_match[i].own_outputs);
+    }
+    printf("%d commands of %d sessions in %" PRIu32 " ms\n", TEST_SERVER_SESSIONS * TEST_SERVER_LINES, TEST_SERVER_SESSIONS, ms);
+
+    // the session ends on end of file, after its last line
+    TEST_ASSERT_EQUAL(10, write(fds[2][0], "seq 2 1001", 10));
+    shutdown(fds[2][0], SHUT_WR);
+    TEST_ASSERT_EQUAL(1, test_server_wait_prompts(2, fds[2][0], 1, 1000));
+    TEST_ASSERT_EQUAL(1001, s_seq_last[2]);
+
+    TEST_ESP_OK(esp_console_server_delete(server));
+    for (int i = 0; i < TEST_SERVER_SESSIONS; i++) {
+        // the server closed the file descriptor used both for input and output
+        TEST_ASSERT_EQUAL(-1, fcntl(fds[i][1], F_GETFD));
+        TEST_ASSERT_EQUAL(EBADF, errno);
+        close(fds[i][0]);
+    }
+    TEST_ESP_OK(esp_console_deinit());
+}
+
+TEST_CASE("esp console server keeps a session which only negotiates telnet options", "[console]")
+{
+    esp_console_config_t console_config = ESP_CONSOLE_CONFIG_DEFAULT();
+    TEST_ESP_OK(esp_console_init(&console_config));
+    const esp_console_cmd_t seq_cmd = {
+        .command = "seq",
+        .func = do_seq_cmd,
+    };
+    TEST_ESP_OK(esp_console_cmd_register(&seq_cmd));
+    esp_console_server_config_t server_config = ESP_CONSOLE_SERVER_CONFIG_DEFAULT();
+    esp_console_server_handle_t server;
+    TEST_ESP_OK(esp_console_server_new(&server_config, &server));
+
+    int fds[2];
+    TEST_ASSERT_EQUAL(0, socketpair(AF_UNIX, SOCK_STREAM, 0, fds));
+    TEST_ASSERT_EQUAL(0, fcntl(fds[0], F_SETFL, O_NONBLOCK));
+    memset(s_match, 0, sizeof(s_match));
+    s_seq_last[0] = 0;
+    TEST_ESP_OK(esp_console_server_add_session(server, fds[1], fds[1]));
+    TEST_ASSERT_EQUAL(1, test_server_wait_prompts(0, fds[0], 1, 1000));
+
+    // IAC WILL NAWS, read on its own, leaves no data
+    const uint8_t will_naws[] = { 255, 251, 31 };
+    TEST_ASSERT_EQUAL(sizeof(will_naws), write(fds[0], will_naws, sizeof(will_naws)));
+    vTaskDelay(pdMS_TO_TICKS(200));
+    // the session is still open
+    TEST_ASSERT_EQUAL(8, send(fds[0], "seq 0 1\n", 8, MSG_NOSIGNAL));
+    TEST_ASSERT_EQUAL(1, test_server_wait_prompts(0, fds[0], 1, 1000));
+    TEST_ASSERT_EQUAL(1, s_seq_last[0]);
+    TEST_ASSERT_EQUAL(1, s_match[0].own_outputs);
+
+    TEST_ESP_OK(esp_console_server_delete(server));
+    close(fds[0]);
+    TEST_ESP_OK(esp_console_deinit());
+}
+#endif // CONFIG_IDF_TARGET_LINUX
+
 TEST_CASE("esp console help command - set verbose level = 0", "[console][ignore]")
 {
     esp_console_repl_config_t repl_config = ESP_CONSOLE_REPL_CONFIG_DEFAULT();
@@ -4,6 +4,8 @@
  * SPDX-License-Identifier: Apache-2.0
  */
 
+#include <stdint.h>
+#include <string.h>
 #include "esp_tls_crypto.h"
 #include "esp_log.h"
 #include "esp_err.h"
@@ -100,3 +102,58 @@ int esp_crypto_base64_encode(unsigned char *dst, size_t dlen, size_t *olen,
 {
     return _esp_crypto_base64_encode(dst, dlen, olen, src, slen);
 }
+
+/* Unit of the WebSocket masking loop. Generic vector code is used where it maps onto
+ * vector registers, otherwise the widest integer register. */
+#if defined(__SSE2__) || defined(__ARM_NEON)
+typedef uint32_t ws_mask_word_t __attribute__((vector_size(16), __may_alias__));
+#elif UINTPTR_MAX > UINT32_MAX
+typedef uint64_t __attribute__((__may_alias__)) ws_mask_word_t;
+#else
+typedef uint32_t __attribute__((__may_alias__)) ws_mask_word_t;
+#endif
+
+#define WS_MASK_WORD_SIZE   sizeof(ws_mask_word_t)
+#define WS_MASK_IS_ALIGNED(ptr) (((uintptr_t)(ptr) & (WS_MASK_WORD_SIZE - 1)) == 0)
+
+void esp_crypto_ws_mask(unsigned char *dst, const unsigned char *src, size_t len,
+                        const unsigned char mask_key[4], size_t offset)
+{
+    size_t i = 0;
+
+    /* Head: bytes up to the first aligned word of dst */
+    while (i < len && !WS_MASK_IS_ALIGNED(dst + i)) {
+        dst[i] = src[i] ^ mask_key[(offset + i) & 3];
+        i++;
+    }
+
+    if (len - i >= WS_MASK_WORD_SIZE) {
+        /* The word size is a multiple of 4, so the same rotation of the key applies to every word */
+        unsigned char pattern[WS_MASK_WORD_SIZE];
+        for (size_t j = 0; j < WS_MASK_WORD_SIZE; j++) {
+            pattern[j] = mask_key[(offset + i + j) & 3];
+        }
+        ws_mask_word_t mask;
+        memcpy(&mask, pattern, WS_MASK_WORD_SIZE);
+
+        ws_mask_word_t *d = (ws_mask_word_t *)(dst + i);
+        if (WS_MASK_IS_ALIGNED(src + i)) {
+            const ws_mask_word_t *s = (const ws_mask_word_t *)(src + i);
+            for (; len - i >= WS_MASK_WORD_SIZE; i += WS_MASK_WORD_SIZE) {
+                *d++ = *s++ ^ mask;
+            }
+        } else {
+            /* src is misaligned relative to dst, let the compiler pick the best unaligned load */
+            for (; len - i >= WS_MASK_WORD_SIZE; i += WS_MASK_WORD_SIZE) {
+                ws_mask_word_t word;
+                memcpy(&word, src + i, WS_MASK_WORD_SIZE);
+                *d++ = word ^ mask;
+            }
+        }
+    }
+
+    /* Tail */
+    for (; i < len; i++) {
+        dst[i] = src[i] ^ mask_key[(offset + i) & 3];
+    }
+}
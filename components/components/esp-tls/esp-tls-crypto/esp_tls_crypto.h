@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2020-2021 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2020-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -54,6 +54,25 @@ int esp_crypto_base64_encode(unsigned char *dst, size_t dlen,
                              size_t *olen, const unsigned char *src,
                              size_t slen);
 
+/**
+ * @brief Apply a WebSocket masking key to a payload (RFC 6455, section 5.3)
+ *
+ * XORs the payload with the 4-byte masking key, a machine word (or vector register,
+ * where the compiler supports it) at a time. Masking and unmasking are the same operation.
+ * The payload may be processed in several parts: offset gives the position of the
+ * first byte of src within the whole payload, so that each part continues with the
+ * right byte of the key.
+ *
+ * @param[out]  dst       destination buffer, either equal to src (in place) or not
+ *                        overlapping it. No alignment is required.
+ * @param[in]   src       payload to be masked
+ * @param[in]   len       number of bytes to process
+ * @param[in]   mask_key  masking key of the frame
+ * @param[in]   offset    position of src[0] within the frame payload
+ */
+void esp_crypto_ws_mask(unsigned char *dst, const unsigned char *src, size_t len,
+                        const unsigned char mask_key[4], size_t offset);
+
 #ifdef __cplusplus
 }
 #endif
@@ -78,6 +78,9 @@ static const char *TAG = "esp-tls";
 #define _esp_tls_server_session_delete      esp_mbedtls_server_session_delete
 #define _esp_tls_server_session_ticket_ctx_init    esp_mbedtls_server_session_ticket_ctx_init
 #define _esp_tls_server_session_ticket_ctx_free    esp_mbedtls_server_session_ticket_ctx_free
+#define _esp_tls_server_session_ticket_rotate      esp_mbedtls_server_session_ticket_rotate
+#define _esp_tls_server_session_cache_ctx_init     esp_mbedtls_server_session_cache_ctx_init
+#define _esp_tls_server_session_cache_ctx_free     esp_mbedtls_server_session_cache_ctx_free
 #define _esp_tls_get_bytes_avail            esp_mbedtls_get_bytes_avail
 #define _esp_tls_init_global_ca_store       esp_mbedtls_init_global_ca_store
 #define _esp_tls_set_global_ca_store        esp_mbedtls_set_global_ca_store                 /*!< Callback function for setting global CA store data for TLS/SSL */
@@ -468,6 +471,9 @@ static int esp_tls_low_level_conn(const char *hostname, int hostlen, int port, c
     switch (tls->conn_state) {
     case ESP_TLS_INIT:
         tls->sockfd = -1;
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+        tls->port = port;
+#endif
         if (cfg != NULL && cfg->is_plain_tcp == false) {
             _esp_tls_net_init(tls);
             tls->is_tls = true;
@@ -710,6 +716,7 @@ esp_err_t esp_tls_cfg_server_session_tickets_init(esp_tls_cfg_server_t *cfg)
     esp_err_t ret =  _esp_tls_server_session_ticket_ctx_init(cfg->ticket_ctx);
     if (ret != ESP_OK) {
         free(cfg->ticket_ctx);
+        cfg->ticket_ctx = NULL;
     }
     return ret;
 #else
@@ -726,6 +733,82 @@ void esp_tls_cfg_server_session_tickets_free(esp_tls_cfg_server_t *cfg)
 #endif
 }
 
+void esp_tls_cfg_server_session_tickets_deinit(esp_tls_cfg_server_t *cfg)
+{
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_TICKETS)
+    if (cfg && cfg->ticket_ctx) {
+        _esp_tls_server_session_ticket_ctx_free(cfg->ticket_ctx);
+        free(cfg->ticket_ctx);
+        cfg->ticket_ctx = NULL;
+    }
+#endif
+}
+
+esp_err_t esp_tls_cfg_server_session_tickets_rotate(esp_tls_cfg_server_t *cfg)
+{
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_TICKETS)
+    if (!cfg || !cfg->ticket_ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    return _esp_tls_server_session_ticket_rotate(cfg->ticket_ctx);
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+esp_err_t esp_tls_cfg_server_session_cache_init(esp_tls_cfg_server_t *cfg)
+{
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_CACHE)
+    if (!cfg || cfg->session_cache) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    cfg->session_cache = calloc(1, sizeof(esp_tls_server_session_cache_ctx_t));
+    if (!cfg->session_cache) {
+        return ESP_ERR_NO_MEM;
+    }
+    esp_err_t ret = _esp_tls_server_session_cache_ctx_init(cfg->session_cache);
+    if (ret != ESP_OK) {
+        free(cfg->session_cache);
+        cfg->session_cache = NULL;
+    }
+    return ret;
+#else
+    return ESP_ERR_NOT_SUPPORTED;
+#endif
+}
+
+void esp_tls_cfg_server_session_cache_free(esp_tls_cfg_server_t *cfg)
+{
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_CACHE)
+    if (cfg && cfg->session_cache) {
+        _esp_tls_server_session_cache_ctx_free(cfg->session_cache);
+        free(cfg->session_cache);
+        cfg->session_cache = NULL;
+    }
+#endif
+}
+
+esp_err_t esp_tls_cfg_server_get_session_stats(const esp_tls_cfg_server_t *cfg, esp_tls_server_session_stats_t *stats)
+{
+    if (!cfg || !stats) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    memset(stats, 0, sizeof(*stats));
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_CACHE)
+    if (cfg->session_cache) {
+        stats->cache_stored = __atomic_load_n(&cfg->session_cache->stored, __ATOMIC_RELAXED);
+        stats->cache_resumed = __atomic_load_n(&cfg->session_cache->resumed, __ATOMIC_RELAXED);
+    }
+#endif
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_TICKETS)
+    if (cfg->ticket_ctx) {
+        stats->tickets_issued = __atomic_load_n(&cfg->ticket_ctx->issued, __ATOMIC_RELAXED);
+        stats->tickets_resumed = __atomic_load_n(&cfg->ticket_ctx->resumed, __ATOMIC_RELAXED);
+    }
+#endif
+    return ESP_OK;
+}
+
 /**
  * @brief      Create a server side TLS/SSL connection
  */
@@ -18,6 +18,9 @@
 #include "mbedtls/entropy.h"
 #include "mbedtls/ctr_drbg.h"
 #endif
+#ifdef CONFIG_ESP_TLS_SERVER_SESSION_CACHE
+#include "mbedtls/ssl_cache.h"
+#endif
 #elif CONFIG_ESP_TLS_USING_WOLFSSL
 #include "wolfssl/wolfcrypt/settings.h"
 #include "wolfssl/ssl.h"
@@ -251,9 +254,26 @@ typedef struct esp_tls_server_session_ticket_ctx {
                                                                                      CTR_DRBG is deterministic random
                                                                                      bit generation based on AES-256 */
     mbedtls_ssl_ticket_context ticket_ctx;                                     /*!< Session ticket generation context */
+
+    uint32_t issued;                                                            /*!< Number of session tickets issued */
+
+    uint32_t resumed;                                                           /*!< Number of sessions resumed from a session ticket */
 } esp_tls_server_session_ticket_ctx_t;
 #endif
 
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_CACHE)
+/**
+ * @brief Data structures necessary to support TLS session resumption from a session ID according to RFC5246
+ */
+typedef struct esp_tls_server_session_cache_ctx {
+    mbedtls_ssl_cache_context cache;                                            /*!< Session cache, keyed by session ID */
+
+    uint32_t stored;                                                            /*!< Number of sessions stored in the cache */
+
+    uint32_t resumed;                                                           /*!< Number of sessions resumed from the cache */
+} esp_tls_server_session_cache_ctx_t;
+#endif
+
 #if defined(CONFIG_ESP_TLS_SERVER_CERT_SELECT_HOOK)
 /**
  * @brief tls handshake callback
@@ -349,6 +369,14 @@ typedef struct esp_tls_cfg_server {
                                                     to free the data associated with this context. */
 #endif
 
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_CACHE)
+    esp_tls_server_session_cache_ctx_t * session_cache; /*!< Session cache context.
+                                                    You have to call esp_tls_cfg_server_session_cache_init
+                                                    to use it.
+                                                    Call esp_tls_cfg_server_session_cache_free
+                                                    to free the data associated with this context. */
+#endif
+
     void *userdata;                             /*!< User data to be added to the ssl context.
                                                   Can be retrieved by callbacks */
 #if defined(CONFIG_ESP_TLS_SERVER_CERT_SELECT_HOOK)
@@ -386,10 +414,87 @@ esp_err_t esp_tls_cfg_server_session_tickets_init(esp_tls_cfg_server_t *cfg);
 /**
  * @brief Free the server side TLS session ticket context
  *
+ * @note The memory of cfg->ticket_ctx itself is not freed and cfg->ticket_ctx is left as it is.
+ *       Use esp_tls_cfg_server_session_tickets_deinit() to release everything.
+ *
  * @param cfg server configuration as esp_tls_cfg_server_t
  */
 void esp_tls_cfg_server_session_tickets_free(esp_tls_cfg_server_t *cfg);
 
+/**
+ * @brief Free the server side TLS session ticket context and the memory allocated for it
+ *
+ * Unlike esp_tls_cfg_server_session_tickets_free(), this function also frees cfg->ticket_ctx,
+ * which was allocated by esp_tls_cfg_server_session_tickets_init(), and sets it to NULL.
+ * The session tickets may then be initialized again.
+ *
+ * @param cfg server configuration as esp_tls_cfg_server_t
+ */
+void esp_tls_cfg_server_session_tickets_deinit(esp_tls_cfg_server_t *cfg);
+
+/**
+ * @brief Rotate the server side TLS session ticket key
+ *
+ * This function replaces the key which encrypts new session tickets with a new random key.
+ * The tickets encrypted with the previous key are still accepted, until the next rotation.
+ * The key is also rotated automatically, every CONFIG_ESP_TLS_SERVER_SESSION_TICKET_TIMEOUT seconds.
+ *
+ * @param[in]  cfg server configuration as esp_tls_cfg_server_t, with an initialized session ticket context
+ * @return
+ *             ESP_OK if the key has been rotated
+ *             ESP_ERR_INVALID_ARG if the session ticket context is not initialized
+ *             ESP_ERR_NOT_SUPPORTED if session tickets are not available due to build configuration
+ *             ESP_FAIL if the new key could not be generated or installed
+ */
+esp_err_t esp_tls_cfg_server_session_tickets_rotate(esp_tls_cfg_server_t *cfg);
+
+/**
+ * @brief Initialize the server side TLS session cache context
+ *
+ * This function initializes the server side session cache, which lets clients
+ * without session ticket support resume their session from its session ID.
+ * Use esp_tls_cfg_server_session_cache_free to free the data.
+ *
+ * @param[in]  cfg server configuration as esp_tls_cfg_server_t
+ * @return
+ *             ESP_OK if setup succeeded
+ *             ESP_ERR_INVALID_ARG if context is already initialized
+ *             ESP_ERR_NO_MEM if memory allocation failed
+ *             ESP_ERR_NOT_SUPPORTED if the session cache is not available due to build configuration
+ */
+esp_err_t esp_tls_cfg_server_session_cache_init(esp_tls_cfg_server_t *cfg);
+
+/**
+ * @brief Free the server side TLS session cache context
+ *
+ * @param cfg server configuration as esp_tls_cfg_server_t
+ */
+void esp_tls_cfg_server_session_cache_free(esp_tls_cfg_server_t *cfg);
+
+/**
+ * @brief Server side session resumption statistics
+ */
+typedef struct esp_tls_server_session_stats {
+    uint32_t cache_stored;                      /*!< Sessions stored in the session cache, one per full handshake */
+    uint32_t cache_resumed;                     /*!< Sessions resumed from the session cache */
+    uint32_t tickets_issued;                    /*!< Session tickets issued */
+    uint32_t tickets_resumed;                   /*!< Sessions resumed from a session ticket */
+} esp_tls_server_session_stats_t;
+
+/**
+ * @brief Get the session resumption statistics of the server configuration
+ *
+ * The counters of the session cache and of the session tickets are zero when
+ * the corresponding context is not initialized.
+ *
+ * @param[in]  cfg    server configuration as esp_tls_cfg_server_t
+ * @param[out] stats  statistics
+ * @return
+ *             ESP_OK on success
+ *             ESP_ERR_INVALID_ARG if an argument is NULL
+ */
+esp_err_t esp_tls_cfg_server_get_session_stats(const esp_tls_cfg_server_t *cfg, esp_tls_server_session_stats_t *stats);
+
 typedef struct esp_tls esp_tls_t;
 
 /**
@@ -831,6 +936,36 @@ esp_tls_client_session_t *esp_tls_get_client_session(esp_tls_t *tls);
  */
 void esp_tls_free_client_session(esp_tls_client_session_t *client_session);
 #endif /* CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
+
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+/**
+ * @brief Client session cache statistics
+ */
+typedef struct esp_tls_client_session_cache_stats {
+    uint32_t hits;                              /*!< Connections which have offered a cached session */
+    uint32_t misses;                            /*!< Connections which found no cached session */
+    uint32_t stored;                            /*!< Sessions stored in the cache */
+    uint32_t evicted;                           /*!< Sessions evicted to make room for another server */
+    uint32_t entries;                           /*!< Sessions currently in the cache */
+} esp_tls_client_session_cache_stats_t;
+
+/**
+ * @brief Get the client session cache statistics
+ *
+ * @param[out] stats  statistics
+ * @return
+ *             ESP_OK on success
+ *             ESP_ERR_INVALID_ARG if stats is NULL
+ */
+esp_err_t esp_tls_client_session_cache_get_stats(esp_tls_client_session_cache_stats_t *stats);
+
+/**
+ * @brief Remove all the sessions from the client session cache and reset its statistics
+ *
+ * The next connection to each server does a full handshake.
+ */
+void esp_tls_client_session_cache_clear(void);
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_CACHE */
 #ifdef __cplusplus
 }
 #endif
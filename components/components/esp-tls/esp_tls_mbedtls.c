@@ -31,6 +31,10 @@
 #include "esp_crt_bundle.h"
 #endif
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+#include "esp_tls_session_cache.h"
+#endif
+
 #ifdef CONFIG_ESP_TLS_USE_SECURE_ELEMENT
 /* cryptoauthlib includes */
 #include "mbedtls/atca_mbedtls_wrap.h"
@@ -111,6 +115,28 @@ typedef struct esp_tls_pki_t {
 
 static esp_err_t set_server_config(esp_tls_cfg_server_t *cfg, esp_tls_t *tls);
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+/* Offers the cached session of the server, the handshake falls back to a full one if the server does not resume it */
+static void set_cached_session(const char *hostname, size_t hostlen, const esp_tls_cfg_t *cfg, esp_tls_t *tls)
+{
+    if (esp_tls_session_cache_key_init(&tls->session_cache_key, hostname, hostlen, tls->port, cfg) != ESP_OK) {
+        ESP_LOGD(TAG, "Not enough memory for the session cache key, the session is not cached");
+        return;
+    }
+    mbedtls_ssl_session session;
+    mbedtls_ssl_session_init(&session);
+    if (esp_tls_session_cache_load(&tls->session_cache_key, &session) == ESP_OK) {
+        int ret = mbedtls_ssl_set_session(&tls->ssl, &session);
+        if (ret != 0) {
+            ESP_LOGD(TAG, "mbedtls_ssl_set_session of the cached session returned -0x%04X", -ret);
+        } else {
+            ESP_LOGD(TAG, "Reusing the cached client session");
+        }
+    }
+    mbedtls_ssl_session_free(&session);
+}
+#endif
+
 esp_err_t esp_create_mbedtls_handle(const char *hostname, size_t hostlen, const void *cfg, esp_tls_t *tls, void *server_params)
 {
     assert(cfg != NULL);
@@ -197,6 +223,12 @@ esp_err_t esp_create_mbedtls_handle(const char *hostname, size_t hostlen, const
     }
     mbedtls_ssl_set_bio(&tls->ssl, &tls->server_fd, mbedtls_net_send, mbedtls_net_recv, NULL);
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+    if (tls->role == ESP_TLS_CLIENT && ((esp_tls_cfg_t *)cfg)->client_session == NULL) {
+        set_cached_session(hostname, hostlen, cfg, tls);
+    }
+#endif
+
     return ESP_OK;
 
 exit:
@@ -299,6 +331,13 @@ int esp_mbedtls_handshake(esp_tls_t *tls, const esp_tls_cfg_t *cfg)
 #endif
         tls->conn_state = ESP_TLS_DONE;
 
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+        /* TLS 1.3 sessions are cached when the tickets sent by the server after the handshake are read */
+        if (tls->session_cache_key.hash != 0 && mbedtls_ssl_get_version_number(&tls->ssl) != MBEDTLS_SSL_VERSION_TLS1_3) {
+            esp_tls_session_cache_store(&tls->session_cache_key, tls->ssl.MBEDTLS_PRIVATE(session));
+        }
+#endif
+
 #ifdef CONFIG_ESP_TLS_USE_DS_PERIPHERAL
         esp_ds_release_ds_lock();
 #endif
@@ -394,6 +433,11 @@ ssize_t esp_mbedtls_read(esp_tls_t *tls, char *data, size_t datalen)
 
                 ESP_LOGD(TAG, "Session ticket saved in the client session context");
                 tls->client_session_len = session_ticket_len;
+#if CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+                if (tls->session_cache_key.hash != 0) {
+                    esp_tls_session_cache_store(&tls->session_cache_key, &tls13_saved_client_session->saved_session);
+                }
+#endif // CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
                 mbedtls_ssl_session_free(&tls13_saved_client_session->saved_session);
                 free(tls13_saved_client_session);
                 tls13_saved_client_session = NULL;
@@ -531,6 +575,9 @@ void esp_mbedtls_cleanup(esp_tls_t *tls)
     mbedtls_ssl_config_free(&tls->conf);
     mbedtls_ctr_drbg_free(&tls->ctr_drbg);
     mbedtls_ssl_free(&tls->ssl);
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+    esp_tls_session_cache_key_free(&tls->session_cache_key);
+#endif
 #ifdef CONFIG_ESP_TLS_USE_SECURE_ELEMENT
     atcab_release();
 #endif
@@ -656,7 +703,11 @@ static esp_err_t set_global_ca_store(esp_tls_t *tls)
 #ifdef CONFIG_ESP_TLS_SERVER_SESSION_TICKETS
 int esp_mbedtls_server_session_ticket_write(void *p_ticket, const mbedtls_ssl_session *session, unsigned char *start, const unsigned char *end, size_t *tlen, uint32_t *lifetime)
 {
-    int ret = mbedtls_ssl_ticket_write(p_ticket, session, start, end, tlen, lifetime);
+    esp_tls_server_session_ticket_ctx_t *ctx = p_ticket;
+    int ret = mbedtls_ssl_ticket_write(&ctx->ticket_ctx, session, start, end, tlen, lifetime);
+    if (ret == 0) {
+        __atomic_fetch_add(&ctx->issued, 1, __ATOMIC_RELAXED);
+    }
 #ifndef NDEBUG
     if (ret != 0) {
         ESP_LOGE(TAG, "Writing session ticket resulted in error code -0x%04X", -ret);
@@ -668,7 +719,11 @@ int esp_mbedtls_server_session_ticket_write(void *p_ticket, const mbedtls_ssl_se
 
 int esp_mbedtls_server_session_ticket_parse(void *p_ticket, mbedtls_ssl_session *session, unsigned char *buf, size_t len)
 {
-    int ret = mbedtls_ssl_ticket_parse(p_ticket, session, buf, len);
+    esp_tls_server_session_ticket_ctx_t *ctx = p_ticket;
+    int ret = mbedtls_ssl_ticket_parse(&ctx->ticket_ctx, session, buf, len);
+    if (ret == 0) {
+        __atomic_fetch_add(&ctx->resumed, 1, __ATOMIC_RELAXED);
+    }
 #ifndef NDEBUG
     if (ret != 0) {
         ESP_LOGD(TAG, "Parsing session ticket resulted in error code -0x%04X", -ret);
@@ -719,6 +774,72 @@ void esp_mbedtls_server_session_ticket_ctx_free(esp_tls_server_session_ticket_ct
         mbedtls_entropy_free(&ctx->entropy);
     }
 }
+
+esp_err_t esp_mbedtls_server_session_ticket_rotate(esp_tls_server_session_ticket_ctx_t *ctx)
+{
+    /* Sizes for the MBEDTLS_CIPHER_AES_256_GCM cipher set up in esp_mbedtls_server_session_ticket_ctx_init */
+    unsigned char name[4];
+    unsigned char key[32];
+    int ret;
+    if ((ret = mbedtls_ctr_drbg_random(&ctx->ctr_drbg, name, sizeof(name))) != 0 ||
+            (ret = mbedtls_ctr_drbg_random(&ctx->ctr_drbg, key, sizeof(key))) != 0) {
+        ESP_LOGE(TAG, "mbedtls_ctr_drbg_random returned -0x%04X", -ret);
+        mbedtls_print_error_msg(ret);
+        mbedtls_platform_zeroize(key, sizeof(key));
+        return ESP_FAIL;
+    }
+    ret = mbedtls_ssl_ticket_rotate(&ctx->ticket_ctx, name, sizeof(name), key, sizeof(key),
+                                    CONFIG_ESP_TLS_SERVER_SESSION_TICKET_TIMEOUT);
+    mbedtls_platform_zeroize(key, sizeof(key));
+    if (ret != 0) {
+        ESP_LOGE(TAG, "mbedtls_ssl_ticket_rotate returned -0x%04X", -ret);
+        mbedtls_print_error_msg(ret);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+#endif
+
+#ifdef CONFIG_ESP_TLS_SERVER_SESSION_CACHE
+static int server_session_cache_get(void *data, unsigned char const *session_id, size_t session_id_len, mbedtls_ssl_session *session)
+{
+    esp_tls_server_session_cache_ctx_t *ctx = data;
+    int ret = mbedtls_ssl_cache_get(&ctx->cache, session_id, session_id_len, session);
+    if (ret == 0) {
+        __atomic_fetch_add(&ctx->resumed, 1, __ATOMIC_RELAXED);
+    }
+    return ret;
+}
+
+static int server_session_cache_set(void *data, unsigned char const *session_id, size_t session_id_len, const mbedtls_ssl_session *session)
+{
+    esp_tls_server_session_cache_ctx_t *ctx = data;
+    int ret = mbedtls_ssl_cache_set(&ctx->cache, session_id, session_id_len, session);
+    if (ret == 0) {
+        __atomic_fetch_add(&ctx->stored, 1, __ATOMIC_RELAXED);
+    } else {
+        ESP_LOGD(TAG, "mbedtls_ssl_cache_set returned -0x%04X", -ret);
+    }
+    return ret;
+}
+
+esp_err_t esp_mbedtls_server_session_cache_ctx_init(esp_tls_server_session_cache_ctx_t *ctx)
+{
+    if (!ctx) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    mbedtls_ssl_cache_init(&ctx->cache);
+    mbedtls_ssl_cache_set_max_entries(&ctx->cache, CONFIG_ESP_TLS_SERVER_SESSION_CACHE_SIZE);
+    mbedtls_ssl_cache_set_timeout(&ctx->cache, CONFIG_ESP_TLS_SERVER_SESSION_CACHE_TIMEOUT);
+    return ESP_OK;
+}
+
+void esp_mbedtls_server_session_cache_ctx_free(esp_tls_server_session_cache_ctx_t *ctx)
+{
+    if (ctx) {
+        mbedtls_ssl_cache_free(&ctx->cache);
+    }
+}
 #endif
 
 static esp_err_t set_server_config(esp_tls_cfg_server_t *cfg, esp_tls_t *tls)
@@ -864,7 +985,15 @@ static esp_err_t set_server_config(esp_tls_cfg_server_t *cfg, esp_tls_t *tls)
         mbedtls_ssl_conf_session_tickets_cb( &tls->conf,
                 esp_mbedtls_server_session_ticket_write,
                 esp_mbedtls_server_session_ticket_parse,
-                &cfg->ticket_ctx->ticket_ctx );
+                cfg->ticket_ctx );
+    }
+#endif
+
+#ifdef CONFIG_ESP_TLS_SERVER_SESSION_CACHE
+    if (cfg->session_cache) {
+        ESP_LOGD(TAG, "Enabling server-side tls session cache");
+        mbedtls_ssl_conf_session_cache(&tls->conf, cfg->session_cache,
+                                       server_session_cache_get, server_session_cache_set);
     }
 #endif
 
@@ -0,0 +1,269 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <sys/lock.h>
+#include "esp_log.h"
+#include "esp_tls.h"
+#include "mbedtls/platform_util.h"
+#include "mbedtls/sha256.h"
+#include "esp_tls_session_cache.h"
+
+static const char *TAG = "esp-tls-session-cache";
+
+#define FNV_OFFSET_BASIS    (0xcbf29ce484222325ULL)
+#define FNV_PRIME           (0x100000001b3ULL)
+
+typedef struct {
+    esp_tls_session_cache_key_t key;    /*!< Cache key of the session, key.hash is 0 if the entry is free */
+    unsigned char *session;     /*!< Serialized session */
+    size_t session_len;
+    uint32_t last_used;         /*!< Value of s_clock when the entry was last stored or loaded */
+} session_cache_entry_t;
+
+static _lock_t s_lock;
+static session_cache_entry_t s_entries[CONFIG_ESP_TLS_CLIENT_SESSION_CACHE_SIZE];
+static uint32_t s_clock;
+static esp_tls_client_session_cache_stats_t s_stats;
+
+static uint64_t fnv1a(uint64_t hash, const void *data, size_t len)
+{
+    const unsigned char *p = data;
+    for (size_t i = 0; i < len; i++) {
+        hash = (hash ^ p[i]) * FNV_PRIME;
+    }
+    return hash;
+}
+
+/* Serializes the fields of the key. With data NULL, only the length is counted. */
+typedef struct {
+    unsigned char *data;
+    size_t len;
+} key_writer_t;
+
+static void key_put(key_writer_t *w, const void *data, size_t len)
+{
+    if (w->data && len) {
+        memcpy(w->data + w->len, data, len);
+    }
+    w->len += len;
+}
+
+/* Puts the length too, so that consecutive fields cannot be confused */
+static void key_put_buf(key_writer_t *w, const void *data, size_t len)
+{
+    len = data ? len : 0;
+    key_put(w, &len, sizeof(len));
+    key_put(w, data, len);
+}
+
+static void key_put_str(key_writer_t *w, const char *str)
+{
+    key_put_buf(w, str, str ? strlen(str) : 0);
+}
+
+/* Certificates are too long to be copied to every key, and keys must not be copied at all:
+ * they are represented by their SHA-256 digest */
+static void key_put_digest(key_writer_t *w, const void *data, size_t len)
+{
+    unsigned char digest[32] = { 0 };
+    if (w->data && data && len) {
+        mbedtls_sha256(data, len, digest, 0);
+    }
+    key_put(w, digest, sizeof(digest));
+}
+
+static void key_serialize(key_writer_t *w, const char *hostname, size_t hostlen, int port, const esp_tls_cfg_t *cfg)
+{
+    key_put_buf(w, hostname, hostlen);
+    key_put(w, &port, sizeof(port));
+    key_put_str(w, cfg->common_name);
+    key_put(w, &cfg->skip_common_name, sizeof(cfg->skip_common_name));
+    key_put(w, &cfg->tls_version, sizeof(cfg->tls_version));
+    /* Server authentication */
+    key_put_digest(w, cfg->cacert_buf, cfg->cacert_buf ? cfg->cacert_bytes : 0);
+    key_put(w, &cfg->crt_bundle_attach, sizeof(cfg->crt_bundle_attach));
+    key_put(w, &cfg->use_global_ca_store, sizeof(cfg->use_global_ca_store));
+#if defined(CONFIG_ESP_TLS_PSK_VERIFICATION)
+    if (cfg->psk_hint_key) {
+        key_put_str(w, cfg->psk_hint_key->hint);
+        key_put_digest(w, cfg->psk_hint_key->key, cfg->psk_hint_key->key_size);
+    }
+#endif
+    /* Client authentication */
+    key_put_digest(w, cfg->clientcert_buf, cfg->clientcert_buf ? cfg->clientcert_bytes : 0);
+    key_put(w, &cfg->use_secure_element, sizeof(cfg->use_secure_element));
+    key_put(w, &cfg->use_ecdsa_peripheral, sizeof(cfg->use_ecdsa_peripheral));
+    key_put(w, &cfg->ds_data, sizeof(cfg->ds_data));
+}
+
+esp_err_t esp_tls_session_cache_key_init(esp_tls_session_cache_key_t *key, const char *hostname, size_t hostlen,
+                                         int port, const esp_tls_cfg_t *cfg)
+{
+    memset(key, 0, sizeof(*key));
+    key_writer_t w = { 0 };
+    key_serialize(&w, hostname, hostlen, port, cfg);
+    w.data = malloc(w.len);
+    if (w.data == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    w.len = 0;
+    key_serialize(&w, hostname, hostlen, port, cfg);
+
+    uint64_t hash = fnv1a(FNV_OFFSET_BASIS, w.data, w.len);
+    key->hash = hash ? hash : 1;
+    key->data = w.data;
+    key->len = w.len;
+    return ESP_OK;
+}
+
+void esp_tls_session_cache_key_free(esp_tls_session_cache_key_t *key)
+{
+    free(key->data);
+    memset(key, 0, sizeof(*key));
+}
+
+/* The hash only selects the candidates, the key has to be equal */
+static bool key_equal(const esp_tls_session_cache_key_t *a, const esp_tls_session_cache_key_t *b)
+{
+    return a->hash == b->hash && a->len == b->len && memcmp(a->data, b->data, a->len) == 0;
+}
+
+/* Sessions hold the master secret of the connection */
+static void free_session(unsigned char *session, size_t session_len)
+{
+    if (session) {
+        mbedtls_platform_zeroize(session, session_len);
+        free(session);
+    }
+}
+
+static session_cache_entry_t *find_entry(const esp_tls_session_cache_key_t *key)
+{
+    for (int i = 0; i < CONFIG_ESP_TLS_CLIENT_SESSION_CACHE_SIZE; i++) {
+        if (s_entries[i].key.hash != 0 && key_equal(&s_entries[i].key, key)) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static void free_entry(session_cache_entry_t *entry)
+{
+    free_session(entry->session, entry->session_len);
+    free(entry->key.data);
+}
+
+esp_err_t esp_tls_session_cache_load(const esp_tls_session_cache_key_t *key, mbedtls_ssl_session *session)
+{
+    esp_err_t err = ESP_ERR_NOT_FOUND;
+    session_cache_entry_t stale = { 0 };
+
+    _lock_acquire(&s_lock);
+    session_cache_entry_t *entry = find_entry(key);
+    if (entry) {
+        int ret = mbedtls_ssl_session_load(session, entry->session, entry->session_len);
+        if (ret == 0) {
+            entry->last_used = ++s_clock;
+            err = ESP_OK;
+        } else {
+            ESP_LOGW(TAG, "Dropping a cached session which cannot be loaded, returned -0x%04X", -ret);
+            mbedtls_ssl_session_free(session);
+            mbedtls_ssl_session_init(session);
+            stale = *entry;
+            memset(entry, 0, sizeof(*entry));
+            s_stats.entries--;
+        }
+    }
+    if (err == ESP_OK) {
+        s_stats.hits++;
+    } else {
+        s_stats.misses++;
+    }
+    _lock_release(&s_lock);
+    free_entry(&stale);
+    return err;
+}
+
+void esp_tls_session_cache_store(const esp_tls_session_cache_key_t *key, const mbedtls_ssl_session *session)
+{
+    size_t len = 0;
+    int ret = mbedtls_ssl_session_save(session, NULL, 0, &len);
+    if (ret != MBEDTLS_ERR_SSL_BUFFER_TOO_SMALL) {
+        ESP_LOGD(TAG, "The session cannot be saved, returned -0x%04X", -ret);
+        return;
+    }
+    unsigned char *saved = malloc(len);
+    if (saved == NULL) {
+        ESP_LOGD(TAG, "Not enough memory to cache the session");
+        return;
+    }
+    if ((ret = mbedtls_ssl_session_save(session, saved, len, &len)) != 0) {
+        ESP_LOGD(TAG, "Saving the session returned -0x%04X", -ret);
+        free_session(saved, len);
+        return;
+    }
+    /* The entry keeps its own copy of the key, the connection frees its key when it is closed */
+    esp_tls_session_cache_key_t key_copy = *key;
+    key_copy.data = malloc(key->len);
+    if (key_copy.data == NULL) {
+        ESP_LOGD(TAG, "Not enough memory to cache the session");
+        free_session(saved, len);
+        return;
+    }
+    memcpy(key_copy.data, key->data, key->len);
+
+    _lock_acquire(&s_lock);
+    session_cache_entry_t *entry = find_entry(key);
+    if (entry == NULL) {
+        /* A free entry, or else the least recently used one */
+        entry = &s_entries[0];
+        for (int i = 0; i < CONFIG_ESP_TLS_CLIENT_SESSION_CACHE_SIZE && entry->key.hash != 0; i++) {
+            if (s_entries[i].key.hash == 0 || s_entries[i].last_used < entry->last_used) {
+                entry = &s_entries[i];
+            }
+        }
+        if (entry->key.hash != 0) {
+            s_stats.evicted++;
+        } else {
+            s_stats.entries++;
+        }
+    }
+    session_cache_entry_t replaced = *entry;
+    entry->key = key_copy;
+    entry->session = saved;
+    entry->session_len = len;
+    entry->last_used = ++s_clock;
+    s_stats.stored++;
+    _lock_release(&s_lock);
+    free_entry(&replaced);
+}
+
+esp_err_t esp_tls_client_session_cache_get_stats(esp_tls_client_session_cache_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    _lock_acquire(&s_lock);
+    *stats = s_stats;
+    _lock_release(&s_lock);
+    return ESP_OK;
+}
+
+void esp_tls_client_session_cache_clear(void)
+{
+    session_cache_entry_t entries[CONFIG_ESP_TLS_CLIENT_SESSION_CACHE_SIZE];
+
+    _lock_acquire(&s_lock);
+    memcpy(entries, s_entries, sizeof(entries));
+    memset(s_entries, 0, sizeof(s_entries));
+    memset(&s_stats, 0, sizeof(s_stats));
+    _lock_release(&s_lock);
+    for (int i = 0; i < CONFIG_ESP_TLS_CLIENT_SESSION_CACHE_SIZE; i++) {
+        free_entry(&entries[i]);
+    }
+}
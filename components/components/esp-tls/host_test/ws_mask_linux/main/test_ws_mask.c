@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "unity.h"
+#include "esp_tls_crypto.h"
+
+#define TEST_MAX_LEN        200
+#define TEST_MAX_MISALIGN   16
+#define BENCH_LEN           (64 * 1024)
+#define BENCH_ROUNDS        200
+
+static const unsigned char s_mask_key[4] = { 0x37, 0xfa, 0x21, 0x3d };
+
+static void ws_mask_bytewise(unsigned char *dst, const unsigned char *src, size_t len,
+                             const unsigned char mask_key[4], size_t offset)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src[i] ^ mask_key[(offset + i) % 4];
+    }
+}
+
+static void fill_random(unsigned char *buf, size_t len, unsigned seed)
+{
+    srand(seed);
+    for (size_t i = 0; i < len; i++) {
+        buf[i] = rand();
+    }
+}
+
+static int64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+TEST_CASE("esp_crypto_ws_mask matches byte-wise masking", "[ws_mask]")
+{
+    unsigned char src[TEST_MAX_LEN + TEST_MAX_MISALIGN];
+    unsigned char dst[TEST_MAX_LEN + TEST_MAX_MISALIGN + 1];
+    unsigned char expected[TEST_MAX_LEN];
+    fill_random(src, sizeof(src), 1);
+
+    for (size_t src_off = 0; src_off < TEST_MAX_MISALIGN; src_off++) {
+        for (size_t dst_off = 0; dst_off < TEST_MAX_MISALIGN; dst_off++) {
+            for (size_t key_off = 0; key_off < 4; key_off++) {
+                for (size_t len = 0; len <= TEST_MAX_LEN; len++) {
+                    ws_mask_bytewise(expected, src + src_off, len, s_mask_key, key_off);
+                    memset(dst, 0xa5, sizeof(dst));
+                    esp_crypto_ws_mask(dst + dst_off, src + src_off, len, s_mask_key, key_off);
+                    if (len) {
+                        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, dst + dst_off, len);
+                    }
+                    // nothing written outside of the destination
+                    TEST_ASSERT_EACH_EQUAL_HEX8(0xa5, dst + dst_off + len, sizeof(dst) - dst_off - len);
+                    if (dst_off) {
+                        TEST_ASSERT_EACH_EQUAL_HEX8(0xa5, dst, dst_off);
+                    }
+                }
+            }
+        }
+    }
+}
+
+TEST_CASE("esp_crypto_ws_mask in place and in parts", "[ws_mask]")
+{
+    unsigned char payload[TEST_MAX_LEN];
+    unsigned char masked[TEST_MAX_LEN];
+    unsigned char expected[TEST_MAX_LEN];
+    fill_random(payload, sizeof(payload), 2);
+    ws_mask_bytewise(expected, payload, sizeof(payload), s_mask_key, 0);
+
+    // in place, in parts of every length from 1 to 17 bytes
+    for (size_t part = 1; part <= 17; part++) {
+        memcpy(masked, payload, sizeof(masked));
+        for (size_t pos = 0; pos < sizeof(masked); pos += part) {
+            size_t len = (sizeof(masked) - pos < part) ? sizeof(masked) - pos : part;
+            esp_crypto_ws_mask(masked + pos, masked + pos, len, s_mask_key, pos);
+        }
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, masked, sizeof(masked));
+    }
+
+    // unmasking is the same operation
+    esp_crypto_ws_mask(masked, masked, sizeof(masked), s_mask_key, 0);
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(payload, masked, sizeof(masked));
+}
+
+TEST_CASE("esp_crypto_ws_mask unmasks received frames in place", "[ws_mask]")
+{
+    // esp_http_server unmasks each received frame in place, from the start of the payload,
+    // wherever the payload lies in its receive buffer
+    unsigned char buf[TEST_MAX_LEN + TEST_MAX_MISALIGN + 1];
+    unsigned char payload[TEST_MAX_LEN];
+    unsigned char expected[TEST_MAX_LEN];
+    fill_random(payload, sizeof(payload), 4);
+
+    for (size_t off = 0; off < TEST_MAX_MISALIGN; off++) {
+        for (size_t len = 1; len <= TEST_MAX_LEN; len++) {
+            ws_mask_bytewise(expected, payload, len, s_mask_key, 0);
+            memset(buf, 0xa5, sizeof(buf));
+            memcpy(buf + off, payload, len);
+            esp_crypto_ws_mask(buf + off, buf + off, len, s_mask_key, 0);
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, buf + off, len);
+            TEST_ASSERT_EACH_EQUAL_HEX8(0xa5, buf + off + len, sizeof(buf) - off - len);
+            if (off) {
+                TEST_ASSERT_EACH_EQUAL_HEX8(0xa5, buf, off);
+            }
+        }
+    }
+}
+
+static double bench_mb_per_s(void (*mask)(unsigned char *, const unsigned char *, size_t, const unsigned char *, size_t),
+                             unsigned char *dst, const unsigned char *src)
+{
+    int64_t start = time_us();
+    for (int i = 0; i < BENCH_ROUNDS; i++) {
+        mask(dst, src, BENCH_LEN, s_mask_key, i);
+    }
+    int64_t elapsed_us = time_us() - start;
+    return (double)BENCH_LEN * BENCH_ROUNDS / (elapsed_us ? elapsed_us : 1);
+}
+
+TEST_CASE("esp_crypto_ws_mask throughput", "[ws_mask]")
+{
+    unsigned char *src = malloc(BENCH_LEN + 1);
+    unsigned char *dst = malloc(BENCH_LEN + 1);
+    TEST_ASSERT_NOT_NULL(src);
+    TEST_ASSERT_NOT_NULL(dst);
+    fill_random(src, BENCH_LEN + 1, 3);
+
+    printf("%-20s %12s %12s\n", "Case", "Byte MB/s", "Word MB/s");
+    printf("%-20s %12.1f %12.1f\n", "in place",
+           bench_mb_per_s(ws_mask_bytewise, src, src), bench_mb_per_s(esp_crypto_ws_mask, src, src));
+    printf("%-20s %12.1f %12.1f\n", "copy, aligned",
+           bench_mb_per_s(ws_mask_bytewise, dst, src), bench_mb_per_s(esp_crypto_ws_mask, dst, src));
+    printf("%-20s %12.1f %12.1f\n", "copy, misaligned",
+           bench_mb_per_s(ws_mask_bytewise, dst, src + 1), bench_mb_per_s(esp_crypto_ws_mask, dst, src + 1));
+
+    free(src);
+    free(dst);
+}
+
+void app_main(void)
+{
+    printf("Running WebSocket masking linux host test app\n");
+    unity_run_menu();
+}
@@ -102,6 +102,29 @@ esp_err_t esp_mbedtls_server_session_ticket_ctx_init(esp_tls_server_session_tick
  * /note :- The function can only be used with mbedtls ssl library
  */
 void esp_mbedtls_server_session_ticket_ctx_free(esp_tls_server_session_ticket_ctx_t *cfg);
+
+/**
+ * Internal function to rotate the key of the server side session ticket context
+ *
+ * /note :- The function can only be used with mbedtls ssl library
+ */
+esp_err_t esp_mbedtls_server_session_ticket_rotate(esp_tls_server_session_ticket_ctx_t *cfg);
+#endif
+
+#ifdef CONFIG_ESP_TLS_SERVER_SESSION_CACHE
+/**
+ * Internal function to setup server side session cache context
+ *
+ * /note :- The function can only be used with mbedtls ssl library
+ */
+esp_err_t esp_mbedtls_server_session_cache_ctx_init(esp_tls_server_session_cache_ctx_t *cfg);
+
+/**
+ * Internal function to free server side session cache context
+ *
+ * /note :- The function can only be used with mbedtls ssl library
+ */
+void esp_mbedtls_server_session_cache_ctx_free(esp_tls_server_session_cache_ctx_t *cfg);
 #endif
 
 /**
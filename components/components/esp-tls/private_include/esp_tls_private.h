@@ -29,6 +29,9 @@
 #ifdef CONFIG_MBEDTLS_SSL_PROTO_TLS1_3
 #include "psa/crypto.h"
 #endif
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+#include "esp_tls_session_cache.h"
+#endif
 #elif CONFIG_ESP_TLS_USING_WOLFSSL
 #include "wolfssl/wolfcrypt/settings.h"
 #include "wolfssl/ssl.h"
@@ -73,6 +76,11 @@ struct esp_tls {
     unsigned char *client_session;                                              /*!< Pointer for the serialized client session ticket context. */
     size_t client_session_len;                                                  /*!< Length of the serialized client session ticket context. */
 #endif /* CONFIG_MBEDTLS_SSL_PROTO_TLS1_3 && CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS */
+#ifdef CONFIG_ESP_TLS_CLIENT_SESSION_CACHE
+    int port;                                                                   /*!< Port of the server, part of the client session cache key */
+    esp_tls_session_cache_key_t session_cache_key;                              /*!< Client session cache key of the connection,
+                                                                                     its hash is 0 if the session is not cached */
+#endif /* CONFIG_ESP_TLS_CLIENT_SESSION_CACHE */
 #elif CONFIG_ESP_TLS_USING_WOLFSSL
     void *priv_ctx;
     void *priv_ssl;
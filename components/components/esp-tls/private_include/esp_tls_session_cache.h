@@ -0,0 +1,81 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+// This file contains the client session cache shared by all the esp-tls client connections.
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+#include "esp_tls.h"
+#include "mbedtls/ssl.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Cache key of a client connection
+ *
+ * The fields of the configuration are serialized to data, certificates and pre-shared keys
+ * as their SHA-256 digest. Keys are equal if their data are equal, the hash is only used
+ * to skip most of the comparisons.
+ */
+typedef struct {
+    uint64_t hash;              /*!< Hash of data, never 0 for an initialized key */
+    unsigned char *data;        /*!< Serialized key */
+    size_t len;                 /*!< Length of data */
+} esp_tls_session_cache_key_t;
+
+/**
+ * @brief      Compute the cache key of a client connection
+ *
+ *             The key covers the server (host and port) and every option of the configuration
+ *             which decides how the server is authenticated, or how the client authenticates itself,
+ *             so that a session is only resumed by connections which would have established it.
+ *
+ * @param[out] key      The key, to be freed with esp_tls_session_cache_key_free()
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_NO_MEM if the key cannot be allocated
+ */
+esp_err_t esp_tls_session_cache_key_init(esp_tls_session_cache_key_t *key, const char *hostname, size_t hostlen,
+                                         int port, const esp_tls_cfg_t *cfg);
+
+/**
+ * @brief      Free the data of a key initialized by esp_tls_session_cache_key_init()
+ *
+ *             The key is reset, so it may be freed again.
+ */
+void esp_tls_session_cache_key_free(esp_tls_session_cache_key_t *key);
+
+/**
+ * @brief      Load the cached session of the key
+ *
+ * @param[in]  key      The cache key
+ * @param[out] session  Initialized session, to be freed by the caller on success
+ *
+ * @return
+ *     - ESP_OK if a session has been loaded
+ *     - ESP_ERR_NOT_FOUND if there is no usable session for the key
+ */
+esp_err_t esp_tls_session_cache_load(const esp_tls_session_cache_key_t *key, mbedtls_ssl_session *session);
+
+/**
+ * @brief      Store the session under the key, replacing the previous session of the key
+ *
+ *             The least recently used session is evicted when the cache is full.
+ *
+ * @param[in]  key      The cache key
+ * @param[in]  session  The session, e.g. of a connection which has just completed its handshake
+ */
+void esp_tls_session_cache_store(const esp_tls_session_cache_key_t *key, const mbedtls_ssl_session *session);
+
+#ifdef __cplusplus
+}
+#endif
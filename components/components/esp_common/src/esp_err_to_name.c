@@ -292,6 +292,10 @@ static const esp_err_msg_t esp_err_msg_table[] = {
                                                                                 essentially first boot of firmware image
                                                                                 post upgrade and hence firmware upgrade
                                                                                 is not possible */
+#   endif
+#   ifdef      ESP_ERR_OTA_DELTA_BASE_MISMATCH
+    ERR_TBL_IT(ESP_ERR_OTA_DELTA_BASE_MISMATCH),                /*  5383 0x1507 Error if the base partition does not
+                                                                                hold the image a delta was made against */
 #   endif
     // components/efuse/include/esp_efuse.h
 #   ifdef      ESP_ERR_EFUSE
@@ -18,6 +18,7 @@
 #include "esp_transport_ssl.h"
 #include "http_utils.h"
 #include "http_auth.h"
+#include "http_pool.h"
 #include "sdkconfig.h"
 #include "esp_http_client.h"
 #include "errno.h"
@@ -53,6 +54,10 @@ typedef struct {
     char *orig_raw_data;/*!< The Original pointer to HTTP data after decoding */
     int raw_len;        /*!< The HTTP data len after decoding */
     char *output_ptr;   /*!< The destination address of the data to be copied to after decoding */
+    const char *body;   /*!< Decoded body in `data` which has not been read yet */
+    int body_len;       /*!< The length of the decoded body in `data` */
+    char *unparsed;     /*!< HTTP data in `data` left after the parser was paused */
+    int unparsed_len;   /*!< The length of the HTTP data left in `data` */
 } esp_http_buffer_t;
 
 /**
@@ -142,7 +147,10 @@ struct esp_http_client {
     bool                        is_async;
     esp_transport_keep_alive_t  keep_alive_cfg;
     struct ifreq                *if_name;
+    esp_http_client_pool_handle_t pool;
     unsigned                    cache_data_in_fetch_hdr: 1;
+    unsigned                    zero_copy_read: 1;
+    unsigned                    body_in_place: 1;   /*!< Pause the parser at each part of the body, leaving it in the receive buffer */
 #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
     session_ticket_state_t      session_ticket_state;
 #endif
@@ -151,6 +159,7 @@ struct esp_http_client {
 typedef struct esp_http_client esp_http_client_t;
 
 static esp_err_t _clear_connection_info(esp_http_client_handle_t client);
+static esp_err_t http_client_close(esp_http_client_handle_t client, bool to_pool);
 /**
  * Default settings
  */
@@ -299,6 +308,10 @@ static int http_on_headers_complete(http_parser *parser)
            headers that indicate the presence of a body.*/
         return 1;
     }
+    if (client->zero_copy_read && client->cache_data_in_fetch_hdr) {
+        /* Leave the body received along with the headers in the receive buffer, instead of caching it */
+        http_parser_pause(parser, 1);
+    }
     return 0;
 }
 
@@ -307,7 +320,12 @@ static int http_on_body(http_parser *parser, const char *at, size_t length)
     esp_http_client_t *client = parser->data;
     ESP_LOGD(TAG, "http_on_body %zu", length);
 
-    if (client->response->buffer->output_ptr) {
+    if (client->body_in_place) {
+        /* Stop at this part of the body until it has been read from the receive buffer */
+        client->response->buffer->body = at;
+        client->response->buffer->body_len = length;
+        http_parser_pause(parser, 1);
+    } else if (client->response->buffer->output_ptr) {
         memcpy(client->response->buffer->output_ptr, (char *)at, length);
         client->response->buffer->output_ptr += length;
     } else {
@@ -327,7 +345,9 @@ static int http_on_body(http_parser *parser, const char *at, size_t length)
     }
 
     client->response->data_process += length;
-    client->response->buffer->raw_len += length;
+    if (!client->body_in_place) {
+        client->response->buffer->raw_len += length;
+    }
     http_dispatch_event(client, HTTP_EVENT_ON_DATA, (void *)at, length);
     esp_http_client_on_data_t evt_data = {};
     evt_data.data_process = client->response->data_process;
@@ -574,6 +594,14 @@ static esp_err_t _set_config(esp_http_client_handle_t client, const esp_http_cli
     if (config->is_async) {
         client->is_async = true;
     }
+    client->pool = config->connection_pool;
+    client->zero_copy_read = config->zero_copy_read;
+#if CONFIG_ESP_HTTP_CLIENT_ENABLE_CUSTOM_TRANSPORT
+    if (config->transport && client->pool) {
+        ESP_LOGW(TAG, "Connection pool is not used with a custom transport");
+        client->pool = NULL;
+    }
+#endif
 
     return ret;
 
@@ -1158,7 +1186,7 @@ esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *u
         }
         /* Free cached data if any, as we are closing this connection */
         esp_http_client_cached_buf_cleanup(client->response->buffer);
-        esp_http_client_close(client);
+        http_client_close(client, false);
     }
 
     if (old_host) {
@@ -1183,7 +1211,7 @@ esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *u
     if (old_port != client->connection_info.port) {
         /* Free cached data if any, as we are closing this connection */
         esp_http_client_cached_buf_cleanup(client->response->buffer);
-        esp_http_client_close(client);
+        http_client_close(client, false);
     }
 
     if (purl.field_data[UF_USERINFO].len) {
@@ -1259,6 +1287,32 @@ esp_err_t esp_http_client_set_timeout_ms(esp_http_client_handle_t client, int ti
     return ESP_OK;
 }
 
+/* Resumes parsing the HTTP data left in the receive buffer, returns the number of bytes parsed */
+static int http_client_parse_unparsed(esp_http_client_handle_t client)
+{
+    esp_http_buffer_t *res_buffer = client->response->buffer;
+    size_t parsed = http_parser_execute(client->parser, client->parser_settings, res_buffer->unparsed, res_buffer->unparsed_len);
+    if (HTTP_PARSER_ERRNO(client->parser) == HPE_PAUSED) {
+        http_parser_pause(client->parser, 0);
+    } else if (HTTP_PARSER_ERRNO(client->parser) != HPE_OK) {
+        ESP_LOGE(TAG, "Failed to parse the response: %s", http_errno_description(HTTP_PARSER_ERRNO(client->parser)));
+        res_buffer->unparsed_len = 0;
+        return ESP_FAIL;
+    }
+    res_buffer->unparsed += parsed;
+    res_buffer->unparsed_len -= parsed;
+    return parsed;
+}
+
+/* Parses the HTTP data left in the receive buffer up to the next part of the body */
+static int http_client_parse_body_in_place(esp_http_client_handle_t client)
+{
+    client->body_in_place = 1;
+    int ret = http_client_parse_unparsed(client);
+    client->body_in_place = 0;
+    return ret;
+}
+
 static int esp_http_client_get_data(esp_http_client_handle_t client)
 {
     if (client->state < HTTP_STATE_RES_ON_DATA_START) {
@@ -1271,6 +1325,20 @@ static int esp_http_client_get_data(esp_http_client_handle_t client)
 
     esp_http_buffer_t *res_buffer = client->response->buffer;
 
+    if (res_buffer->body_len || res_buffer->unparsed_len) {
+        /* Drop the body left unread in the receive buffer, and parse the rest of the data */
+        int len = res_buffer->body_len;
+        res_buffer->body_len = 0;
+        if (res_buffer->unparsed_len) {
+            int parsed = http_client_parse_unparsed(client);
+            if (parsed < 0) {
+                return ESP_FAIL;
+            }
+            len += parsed;
+        }
+        return len;
+    }
+
     ESP_LOGD(TAG, "data_process=%"PRId64", content_length=%"PRId64, client->response->data_process, client->response->content_length);
     errno = 0;
     int rlen = esp_transport_read(client->transport, res_buffer->data, client->buffer_size_rx, client->timeout_ms);
@@ -1301,6 +1369,55 @@ bool esp_http_client_is_complete_data_received(esp_http_client_handle_t client)
     return true;
 }
 
+static bool http_client_is_data_remain(esp_http_client_handle_t client)
+{
+    bool is_data_remain;
+    if (client->response->is_chunked) {
+        is_data_remain = !client->is_chunk_complete;
+    } else {
+        is_data_remain = client->response->data_process < client->response->content_length;
+    }
+    ESP_LOGD(TAG, "is_data_remain=%d, is_chunked=%d, content_length=%"PRId64, is_data_remain, client->response->is_chunked, client->response->content_length);
+    return is_data_remain;
+}
+
+/* Handles a transport read which returned no data, ridx being the length of the data already read */
+static int http_client_handle_read_error(esp_http_client_handle_t client, int rlen, int ridx)
+{
+    esp_log_level_t sev = ESP_LOG_WARN;
+    /* Check for cleanly closed connection */
+    if (rlen == ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN && client->response->is_chunked) {
+        /* Explicit call to parser for invoking `message_complete` callback */
+        http_parser_execute(client->parser, client->parser_settings, client->response->buffer->data, 0);
+        /* ...and lowering the message severity, as closed connection from server side is expected in chunked transport */
+        sev = ESP_LOG_DEBUG;
+    }
+    if (errno != 0) {
+        ESP_LOG_LEVEL(sev, TAG, "esp_transport_read returned:%d and errno:%d ", rlen, errno);
+    }
+
+    if (rlen == ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT) {
+        ESP_LOGD(TAG, "Connection timed out before data was ready!");
+        /* Returning the number of bytes read upto the point where connection timed out */
+        if (ridx) {
+            return ridx;
+        }
+        return -ESP_ERR_HTTP_EAGAIN;
+    }
+
+    if (rlen != ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN) {
+        esp_err_t err = esp_transport_translate_error(rlen);
+        ESP_LOGE(TAG, "transport_read: error - %d | %s", err, esp_err_to_name(err));
+    }
+
+    if (rlen < 0 && ridx == 0 && !esp_http_client_is_complete_data_received(client)) {
+        http_dispatch_event(client, HTTP_EVENT_ERROR, esp_transport_get_error_handle(client->transport), 0);
+        http_dispatch_event_to_event_loop(HTTP_EVENT_ERROR, &client, sizeof(esp_http_client_handle_t));
+        return ESP_FAIL;
+    }
+    return ridx;
+}
+
 int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
 {
     esp_http_buffer_t *res_buffer = client->response->buffer;
@@ -1320,17 +1437,25 @@ int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
         }
     }
     int need_read = len - ridx;
-    bool is_data_remain = true;
-    while (need_read > 0 && is_data_remain) {
-        if (client->response->is_chunked) {
-            is_data_remain = !client->is_chunk_complete;
-        } else {
-            is_data_remain = client->response->data_process < client->response->content_length;
+    /* Copy out the body left in the receive buffer first */
+    while (need_read > 0 && (res_buffer->body_len || res_buffer->unparsed_len)) {
+        if (res_buffer->body_len == 0) {
+            if (http_client_parse_body_in_place(client) < 0) {
+                return ridx ? ridx : ESP_FAIL;
+            }
+            continue;
         }
-        ESP_LOGD(TAG, "is_data_remain=%d, is_chunked=%d, content_length=%"PRId64, is_data_remain, client->response->is_chunked, client->response->content_length);
-        if (!is_data_remain) {
-            break;
+        int copy_len = res_buffer->body_len;
+        if (copy_len > need_read) {
+            copy_len = need_read;
         }
+        memcpy(buffer + ridx, res_buffer->body, copy_len);
+        res_buffer->body += copy_len;
+        res_buffer->body_len -= copy_len;
+        ridx += copy_len;
+        need_read -= copy_len;
+    }
+    while (need_read > 0 && http_client_is_data_remain(client)) {
         int byte_to_read = need_read;
         if (byte_to_read > client->buffer_size_rx) {
             byte_to_read = client->buffer_size_rx;
@@ -1340,38 +1465,7 @@ int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
         ESP_LOGD(TAG, "need_read=%d, byte_to_read=%d, rlen=%d, ridx=%d", need_read, byte_to_read, rlen, ridx);
 
         if (rlen <= 0) {
-            esp_log_level_t sev = ESP_LOG_WARN;
-            /* Check for cleanly closed connection */
-            if (rlen == ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN && client->response->is_chunked) {
-                /* Explicit call to parser for invoking `message_complete` callback */
-                http_parser_execute(client->parser, client->parser_settings, res_buffer->data, 0);
-                /* ...and lowering the message severity, as closed connection from server side is expected in chunked transport */
-                sev = ESP_LOG_DEBUG;
-            }
-            if (errno != 0) {
-                ESP_LOG_LEVEL(sev, TAG, "esp_transport_read returned:%d and errno:%d ", rlen, errno);
-            }
-
-            if (rlen == ERR_TCP_TRANSPORT_CONNECTION_TIMEOUT) {
-                ESP_LOGD(TAG, "Connection timed out before data was ready!");
-                /* Returning the number of bytes read upto the point where connection timed out */
-                if (ridx) {
-                    return ridx;
-                }
-                return -ESP_ERR_HTTP_EAGAIN;
-            }
-
-            if (rlen != ERR_TCP_TRANSPORT_CONNECTION_CLOSED_BY_FIN) {
-                esp_err_t err = esp_transport_translate_error(rlen);
-                ESP_LOGE(TAG, "transport_read: error - %d | %s", err, esp_err_to_name(err));
-            }
-
-            if (rlen < 0 && ridx == 0 && !esp_http_client_is_complete_data_received(client)) {
-                http_dispatch_event(client, HTTP_EVENT_ERROR, esp_transport_get_error_handle(client->transport), 0);
-                http_dispatch_event_to_event_loop(HTTP_EVENT_ERROR, &client, sizeof(esp_http_client_handle_t));
-                return ESP_FAIL;
-            }
-            return ridx;
+            return http_client_handle_read_error(client, rlen, ridx);
         }
         res_buffer->output_ptr = buffer + ridx;
         http_parser_execute(client->parser, client->parser_settings, res_buffer->data, rlen);
@@ -1385,6 +1479,47 @@ int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len)
     return ridx;
 }
 
+int esp_http_client_read_zero_copy(esp_http_client_handle_t client, const char **data)
+{
+    esp_http_buffer_t *res_buffer = client->response->buffer;
+
+    *data = NULL;
+    if (res_buffer->raw_len) {
+        /* Hand out the body cached while fetching the headers at once, it is freed on the next read */
+        int len = res_buffer->raw_len;
+        *data = res_buffer->raw_data;
+        res_buffer->raw_len = 0;
+        return len;
+    }
+    esp_http_client_cached_buf_cleanup(res_buffer);
+
+    while (true) {
+        if (res_buffer->body_len) {
+            int len = res_buffer->body_len;
+            *data = res_buffer->body;
+            res_buffer->body_len = 0;
+            return len;
+        }
+        if (res_buffer->unparsed_len) {
+            if (http_client_parse_body_in_place(client) < 0) {
+                return ESP_FAIL;
+            }
+            continue;
+        }
+        if (!http_client_is_data_remain(client)) {
+            return 0;
+        }
+        errno = 0;
+        int rlen = esp_transport_read(client->transport, res_buffer->data, client->buffer_size_rx, client->timeout_ms);
+        ESP_LOGD(TAG, "rlen=%d", rlen);
+        if (rlen <= 0) {
+            return http_client_handle_read_error(client, rlen, 0);
+        }
+        res_buffer->unparsed = res_buffer->data;
+        res_buffer->unparsed_len = rlen;
+    }
+}
+
 esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
 {
     esp_err_t err = ESP_FAIL;
@@ -1516,6 +1651,9 @@ esp_err_t esp_http_client_perform(esp_http_client_handle_t client)
                 if (!http_should_keep_alive(client->parser)) {
                     ESP_LOGD(TAG, "Close connection");
                     esp_http_client_close(client);
+                } else if (client->pool) {
+                    /* Hand the connection over to the pool, the next request leases one again */
+                    esp_http_client_close(client);
                 } else {
                     if (client->state > HTTP_STATE_CONNECTED) {
                         client->state = HTTP_STATE_CONNECTED;
@@ -1540,6 +1678,8 @@ int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client)
     client->state = HTTP_STATE_REQ_COMPLETE_DATA;
     esp_http_buffer_t *buffer = client->response->buffer;
     client->response->status_code = -1;
+    buffer->body_len = 0;
+    buffer->unparsed_len = 0;
 
     while (client->state < HTTP_STATE_RES_COMPLETE_HEADER) {
         errno = 0;
@@ -1551,7 +1691,13 @@ int64_t esp_http_client_fetch_headers(esp_http_client_handle_t client)
             }
             return ESP_FAIL;
         }
-        http_parser_execute(client->parser, client->parser_settings, buffer->data, buffer->len);
+        size_t parsed = http_parser_execute(client->parser, client->parser_settings, buffer->data, buffer->len);
+        if (HTTP_PARSER_ERRNO(client->parser) == HPE_PAUSED) {
+            /* Paused at the end of the headers in zero copy mode, the rest is body */
+            http_parser_pause(client->parser, 0);
+            buffer->unparsed = buffer->data + parsed;
+            buffer->unparsed_len = buffer->len - parsed;
+        }
     }
     client->state = HTTP_STATE_RES_ON_DATA_START;
     ESP_LOGD(TAG, "content_length = %"PRId64, client->response->content_length);
@@ -1602,7 +1748,10 @@ static esp_err_t esp_http_client_connect(esp_http_client_handle_t client)
 #endif
             return ESP_ERR_HTTP_INVALID_TRANSPORT;
         }
-        if (!client->is_async) {
+        if (client->pool && http_pool_lease(client->pool, client->connection_info.scheme, client->connection_info.host,
+                                            client->connection_info.port, client->transport) == ESP_OK) {
+            ESP_LOGD(TAG, "Reusing pooled connection to %s://%s:%d", client->connection_info.scheme, client->connection_info.host, client->connection_info.port);
+        } else if (!client->is_async) {
             if (esp_transport_connect(client->transport, client->connection_info.host, client->connection_info.port, client->timeout_ms) < 0) {
                 ESP_LOGE(TAG, "Connection failed, sock < 0");
                 return ESP_ERR_HTTP_CONNECT;
@@ -1817,17 +1966,37 @@ int esp_http_client_write(esp_http_client_handle_t client, const char *buffer, i
     return widx;
 }
 
-esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+/* Whether the connection can take another request: none is in flight, or the response has been received completely */
+static bool http_client_conn_reusable(esp_http_client_handle_t client)
+{
+    if (client->state == HTTP_STATE_CONNECTED) {
+        return !client->first_line_prepared;
+    }
+    return client->state >= HTTP_STATE_RES_ON_DATA_START && client->state < HTTP_STATE_CLOSE &&
+           http_should_keep_alive(client->parser) && esp_http_client_is_complete_data_received(client);
+}
+
+static esp_err_t http_client_close(esp_http_client_handle_t client, bool to_pool)
 {
     if (client->state > HTTP_STATE_INIT) {
+        bool reusable = to_pool && client->pool && http_client_conn_reusable(client);
         http_dispatch_event(client, HTTP_EVENT_DISCONNECTED, esp_transport_get_error_handle(client->transport), 0);
         http_dispatch_event_to_event_loop(HTTP_EVENT_DISCONNECTED, &client, sizeof(esp_http_client_handle_t));
         client->state = HTTP_STATE_INIT;
+        if (reusable && http_pool_release(client->pool, client->connection_info.scheme, client->connection_info.host,
+                                          client->connection_info.port, client->transport) == ESP_OK) {
+            return ESP_OK;
+        }
         return esp_transport_close(client->transport);
     }
     return ESP_OK;
 }
 
+esp_err_t esp_http_client_close(esp_http_client_handle_t client)
+{
+    return http_client_close(client, true);
+}
+
 esp_err_t esp_http_client_set_post_field(esp_http_client_handle_t client, const char *data, int len)
 {
     esp_err_t err = ESP_OK;
@@ -1984,6 +2153,8 @@ esp_err_t esp_http_client_flush_response(esp_http_client_handle_t client, int *l
     int read_len = 0;
     while (!esp_http_client_is_complete_data_received(client)) {
         int data_read = esp_http_client_get_data(client);
+        /* The flushed data is not cached */
+        client->response->buffer->raw_len = 0;
         if (data_read < 0) {
             return ESP_FAIL;
         }
@@ -0,0 +1,339 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <unistd.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_http_client.h"
+#include "esp_http_server.h"
+
+#define TEST_PORT           30081
+#define TEST_URL            "http://127.0.0.1:30081/hello"
+#define TEST_BIG_URL        "http://127.0.0.1:30081/big"
+#define TEST_BODY           "Hello from the pool test"
+/* Larger than the receive buffer of the client */
+#define TEST_BIG_LEN        4096
+#define WAIT_TIMEOUT_MS     5000
+
+#define BENCH_TASKS         4
+#define BENCH_REQUESTS      250
+
+static httpd_handle_t s_server;
+static atomic_int s_accepted;       /* Connections accepted by the server */
+static atomic_int s_closed;         /* Connections closed by the server */
+static atomic_int s_last_fd;        /* Socket of the last request on the server side */
+
+static esp_err_t hello_handler(httpd_req_t *req)
+{
+    atomic_store(&s_last_fd, httpd_req_to_sockfd(req));
+    return httpd_resp_send(req, TEST_BODY, HTTPD_RESP_USE_STRLEN);
+}
+
+static esp_err_t big_handler(httpd_req_t *req)
+{
+    static char body[TEST_BIG_LEN];
+    memset(body, 'x', sizeof(body));
+    return httpd_resp_send(req, body, sizeof(body));
+}
+
+static esp_err_t open_fn(httpd_handle_t hd, int sockfd)
+{
+    atomic_fetch_add(&s_accepted, 1);
+    /* Responses are sent in several writes: without this, a response on a reused
+     * connection waits for the delayed acknowledgement of its headers */
+    int nodelay = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return ESP_OK;
+}
+
+static void close_fn(httpd_handle_t hd, int sockfd)
+{
+    atomic_fetch_add(&s_closed, 1);
+    close(sockfd);
+}
+
+static void start_server(void)
+{
+    s_accepted = 0;
+    s_closed = 0;
+    s_last_fd = -1;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    /* Without lwIP the server supports up to 12 open sockets */
+    config.max_open_sockets = 12;
+    config.lru_purge_enable = true;
+    config.open_fn = open_fn;
+    config.close_fn = close_fn;
+    TEST_ESP_OK(httpd_start(&s_server, &config));
+    httpd_uri_t hello = {
+        .uri = "/hello",
+        .method = HTTP_GET,
+        .handler = hello_handler,
+    };
+    TEST_ESP_OK(httpd_register_uri_handler(s_server, &hello));
+    httpd_uri_t big = {
+        .uri = "/big",
+        .method = HTTP_GET,
+        .handler = big_handler,
+    };
+    TEST_ESP_OK(httpd_register_uri_handler(s_server, &big));
+}
+
+static void stop_server(void)
+{
+    TEST_ESP_OK(httpd_stop(s_server));
+    s_server = NULL;
+}
+
+static esp_http_client_handle_t create_client(esp_http_client_pool_handle_t pool, const char *url)
+{
+    esp_http_client_config_t config = {
+        .url = url,
+        .connection_pool = pool,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    TEST_ASSERT_NOT_NULL(client);
+    return client;
+}
+
+/* Makes one request with a new client, as a task would do for each of its requests */
+static esp_err_t get_once(esp_http_client_pool_handle_t pool)
+{
+    esp_http_client_handle_t client = create_client(pool, TEST_URL);
+    esp_err_t err = esp_http_client_perform(client);
+    if (err == ESP_OK && esp_http_client_get_status_code(client) != 200) {
+        err = ESP_FAIL;
+    }
+    esp_http_client_cleanup(client);
+    return err;
+}
+
+static esp_http_client_pool_stats_t get_stats(esp_http_client_pool_handle_t pool)
+{
+    esp_http_client_pool_stats_t stats;
+    TEST_ESP_OK(esp_http_client_pool_get_stats(pool, &stats));
+    return stats;
+}
+
+static bool wait_for_value(atomic_int *value, int expected)
+{
+    for (int i = 0; i < WAIT_TIMEOUT_MS && atomic_load(value) != expected; i++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return atomic_load(value) == expected;
+}
+
+TEST_CASE("pooled clients reuse the connection", "[http_client_pool]")
+{
+    start_server();
+    esp_http_client_pool_config_t config = { 0 };
+    esp_http_client_pool_handle_t pool;
+    TEST_ESP_OK(esp_http_client_pool_create(&config, &pool));
+
+    for (int i = 0; i < 3; i++) {
+        TEST_ESP_OK(get_once(pool));
+    }
+    esp_http_client_pool_stats_t stats = get_stats(pool);
+    TEST_ASSERT_EQUAL(1, stats.missed);
+    TEST_ASSERT_EQUAL(2, stats.reused);
+    TEST_ASSERT_EQUAL(3, stats.released);
+    TEST_ASSERT_EQUAL(1, stats.idle);
+    TEST_ASSERT_EQUAL(1, s_accepted);
+
+    /* A client keeps its handle for several requests */
+    esp_http_client_handle_t client = create_client(pool, TEST_URL);
+    for (int i = 0; i < 3; i++) {
+        TEST_ESP_OK(esp_http_client_perform(client));
+        TEST_ASSERT_EQUAL(200, esp_http_client_get_status_code(client));
+    }
+    TEST_ESP_OK(esp_http_client_cleanup(client));
+    TEST_ASSERT_EQUAL(1, s_accepted);
+    TEST_ASSERT_EQUAL(5, get_stats(pool).reused);
+
+    TEST_ESP_OK(esp_http_client_pool_destroy(pool));
+    TEST_ASSERT_TRUE(wait_for_value(&s_closed, 1));
+    stop_server();
+}
+
+TEST_CASE("pooled connections are kept within the per host limit", "[http_client_pool]")
+{
+    start_server();
+    esp_http_client_pool_config_t config = {
+        .max_idle_per_host = 2,
+    };
+    esp_http_client_pool_handle_t pool;
+    TEST_ESP_OK(esp_http_client_pool_create(&config, &pool));
+
+    /* Three requests in flight at the same time need three connections */
+    esp_http_client_handle_t clients[3];
+    char buf[64];
+    for (int i = 0; i < 3; i++) {
+        clients[i] = create_client(pool, TEST_URL);
+        TEST_ESP_OK(esp_http_client_open(clients[i], 0));
+        TEST_ASSERT_EQUAL(strlen(TEST_BODY), esp_http_client_fetch_headers(clients[i]));
+    }
+    TEST_ASSERT_EQUAL(3, s_accepted);
+    for (int i = 0; i < 3; i++) {
+        TEST_ASSERT_EQUAL(strlen(TEST_BODY), esp_http_client_read_response(clients[i], buf, sizeof(buf)));
+        TEST_ESP_OK(esp_http_client_cleanup(clients[i]));
+    }
+    esp_http_client_pool_stats_t stats = get_stats(pool);
+    TEST_ASSERT_EQUAL(3, stats.released);
+    TEST_ASSERT_EQUAL(1, stats.closed_limit);
+    TEST_ASSERT_EQUAL(2, stats.idle);
+
+    /* A response which is not read completely leaves the connection unusable */
+    esp_http_client_handle_t client = create_client(pool, TEST_BIG_URL);
+    TEST_ESP_OK(esp_http_client_open(client, 0));
+    TEST_ASSERT_EQUAL(TEST_BIG_LEN, esp_http_client_fetch_headers(client));
+    TEST_ASSERT_EQUAL(sizeof(buf), esp_http_client_read_response(client, buf, sizeof(buf)));
+    TEST_ESP_OK(esp_http_client_cleanup(client));
+    stats = get_stats(pool);
+    TEST_ASSERT_EQUAL(3, stats.released);
+    TEST_ASSERT_EQUAL(1, stats.idle);
+    TEST_ASSERT_EQUAL(1, stats.reused);
+
+    TEST_ESP_OK(esp_http_client_pool_destroy(pool));
+    stop_server();
+}
+
+TEST_CASE("idle pooled connections are closed after the timeout", "[http_client_pool]")
+{
+    start_server();
+    esp_http_client_pool_config_t config = {
+        .idle_timeout_ms = 50,
+    };
+    esp_http_client_pool_handle_t pool;
+    TEST_ESP_OK(esp_http_client_pool_create(&config, &pool));
+
+    TEST_ESP_OK(get_once(pool));
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ESP_OK(get_once(pool));
+    esp_http_client_pool_stats_t stats = get_stats(pool);
+    TEST_ASSERT_EQUAL(1, stats.closed_timeout);
+    TEST_ASSERT_EQUAL(2, stats.missed);
+    TEST_ASSERT_EQUAL(0, stats.reused);
+    TEST_ASSERT_EQUAL(2, s_accepted);
+
+    TEST_ESP_OK(esp_http_client_pool_destroy(pool));
+    stop_server();
+}
+
+TEST_CASE("pooled connections closed by the server are not reused", "[http_client_pool]")
+{
+    start_server();
+    esp_http_client_pool_config_t config = { 0 };
+    esp_http_client_pool_handle_t pool;
+    TEST_ESP_OK(esp_http_client_pool_create(&config, &pool));
+
+    TEST_ESP_OK(get_once(pool));
+    TEST_ESP_OK(httpd_sess_trigger_close(s_server, s_last_fd));
+    TEST_ASSERT_TRUE(wait_for_value(&s_closed, 1));
+
+    TEST_ESP_OK(get_once(pool));
+    esp_http_client_pool_stats_t stats = get_stats(pool);
+    TEST_ASSERT_EQUAL(1, stats.closed_stale);
+    TEST_ASSERT_EQUAL(2, stats.missed);
+    TEST_ASSERT_EQUAL(1, stats.idle);
+
+    TEST_ESP_OK(esp_http_client_pool_flush(pool));
+    TEST_ASSERT_EQUAL(0, get_stats(pool).idle);
+    TEST_ESP_OK(esp_http_client_pool_destroy(pool));
+    stop_server();
+}
+
+typedef struct {
+    esp_http_client_pool_handle_t pool;
+    SemaphoreHandle_t done;
+    atomic_int failed;
+} bench_ctx_t;
+
+static void bench_task(void *arg)
+{
+    bench_ctx_t *ctx = arg;
+    for (int i = 0; i < BENCH_REQUESTS; i++) {
+        if (get_once(ctx->pool) != ESP_OK) {
+            atomic_fetch_add(&ctx->failed, 1);
+        }
+    }
+    xSemaphoreGive(ctx->done);
+    vTaskDelete(NULL);
+}
+
+static int64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+/* Runs the requests of all the tasks, returns the time taken */
+static int64_t bench_run(esp_http_client_pool_handle_t pool)
+{
+    bench_ctx_t ctx = {
+        .pool = pool,
+        .done = xSemaphoreCreateCounting(BENCH_TASKS, 0),
+    };
+    TEST_ASSERT_NOT_NULL(ctx.done);
+
+    int64_t start = time_us();
+    for (int i = 0; i < BENCH_TASKS; i++) {
+        TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(bench_task, "bench", 8192, &ctx, 5, NULL));
+    }
+    for (int i = 0; i < BENCH_TASKS; i++) {
+        xSemaphoreTake(ctx.done, portMAX_DELAY);
+    }
+    int64_t elapsed = time_us() - start;
+    vSemaphoreDelete(ctx.done);
+    TEST_ASSERT_EQUAL(0, ctx.failed);
+    return elapsed;
+}
+
+TEST_CASE("connection pool benchmark", "[http_client_pool]")
+{
+    start_server();
+    const int requests = BENCH_TASKS * BENCH_REQUESTS;
+
+    int64_t unpooled_us = bench_run(NULL);
+    int unpooled_conns = s_accepted;
+
+    esp_http_client_pool_config_t config = {
+        .max_idle_per_host = BENCH_TASKS,
+    };
+    esp_http_client_pool_handle_t pool;
+    TEST_ESP_OK(esp_http_client_pool_create(&config, &pool));
+    s_accepted = 0;
+    int64_t pooled_us = bench_run(pool);
+    int pooled_conns = s_accepted;
+    esp_http_client_pool_stats_t stats = get_stats(pool);
+    TEST_ESP_OK(esp_http_client_pool_destroy(pool));
+    stop_server();
+
+    TEST_ASSERT_EQUAL(requests, stats.reused + stats.missed);
+    TEST_ASSERT_LESS_OR_EQUAL(BENCH_TASKS, pooled_conns);
+    printf("%d tasks making %d requests each, with a new client per request\n", BENCH_TASKS, BENCH_REQUESTS);
+    printf("%-10s %10s %12s %12s\n", "Pool", "Time (ms)", "Requests/s", "Connections");
+    printf("%-10s %10lld %12.0f %12d\n", "none", (long long)unpooled_us / 1000,
+           (double)requests * 1000000 / unpooled_us, unpooled_conns);
+    printf("%-10s %10lld %12.0f %12d\n", "shared", (long long)pooled_us / 1000,
+           (double)requests * 1000000 / pooled_us, pooled_conns);
+}
+
+void app_main(void)
+{
+    printf("Running HTTP client connection pool linux host test app\n");
+    unity_run_menu();
+}
@@ -0,0 +1,382 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/socket.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "esp_http_client.h"
+#include "esp_http_server.h"
+
+#define TEST_PORT           30082
+#define TEST_DATA_URL       "http://127.0.0.1:30082/data"
+#define TEST_CHUNKED_URL    "http://127.0.0.1:30082/chunked"
+#define TEST_HEADERS_URL    "http://127.0.0.1:30082/headers"
+#define TEST_DATA_LEN       (64 * 1024)
+#define TEST_CHUNKED_LEN    (40 * 1024)
+#define TEST_RX_BUF_SIZE    1024
+#define TEST_HEADER_COUNT   24
+
+#define BENCH_DATA_LEN      (256 * 1024)
+#define BENCH_REQUESTS      40
+#define BENCH_LOOKUPS       100000
+
+/* Counts the heap allocations, through the glibc allocator */
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t n, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+
+static atomic_int s_allocs;
+
+void *malloc(size_t size)
+{
+    atomic_fetch_add(&s_allocs, 1);
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t n, size_t size)
+{
+    atomic_fetch_add(&s_allocs, 1);
+    return __libc_calloc(n, size);
+}
+
+void *realloc(void *ptr, size_t size)
+{
+    atomic_fetch_add(&s_allocs, 1);
+    return __libc_realloc(ptr, size);
+}
+
+static httpd_handle_t s_server;
+static char s_data[BENCH_DATA_LEN];
+static size_t s_data_len = TEST_DATA_LEN;
+
+static char pattern(size_t i)
+{
+    return (char)(i ^ (i >> 8) ^ (i >> 16));
+}
+
+static esp_err_t data_handler(httpd_req_t *req)
+{
+    return httpd_resp_send(req, s_data, s_data_len);
+}
+
+static esp_err_t chunked_handler(httpd_req_t *req)
+{
+    /* Chunks of varying sizes, some larger than the receive buffer of the client */
+    size_t sent = 0;
+    for (size_t i = 1; sent < TEST_CHUNKED_LEN; i++) {
+        size_t len = (i * 397) % 3000 + 1;
+        if (len > TEST_CHUNKED_LEN - sent) {
+            len = TEST_CHUNKED_LEN - sent;
+        }
+        esp_err_t err = httpd_resp_send_chunk(req, s_data + sent, len);
+        if (err != ESP_OK) {
+            return err;
+        }
+        sent += len;
+    }
+    return httpd_resp_send_chunk(req, NULL, 0);
+}
+
+/* Responds with the values of the X-Test-<n> headers, separated by commas */
+static esp_err_t headers_handler(httpd_req_t *req)
+{
+    char resp[TEST_HEADER_COUNT * 16] = "";
+    char key[16], value[16];
+    for (int i = 0; i < TEST_HEADER_COUNT; i++) {
+        snprintf(key, sizeof(key), "X-Test-%d", i);
+        if (httpd_req_get_hdr_value_str(req, key, value, sizeof(value)) == ESP_OK) {
+            strcat(resp, value);
+            strcat(resp, ",");
+        }
+    }
+    return httpd_resp_sendstr(req, resp);
+}
+
+static esp_err_t open_fn(httpd_handle_t hd, int sockfd)
+{
+    /* Responses are sent in several writes, see the connection pool test app */
+    int nodelay = 1;
+    setsockopt(sockfd, IPPROTO_TCP, TCP_NODELAY, &nodelay, sizeof(nodelay));
+    return ESP_OK;
+}
+
+static void start_server(void)
+{
+    for (size_t i = 0; i < sizeof(s_data); i++) {
+        s_data[i] = pattern(i);
+    }
+    s_data_len = TEST_DATA_LEN;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    config.max_open_sockets = 12;
+    config.open_fn = open_fn;
+    TEST_ESP_OK(httpd_start(&s_server, &config));
+    const httpd_uri_t uris[] = {
+        { .uri = "/data", .method = HTTP_GET, .handler = data_handler },
+        { .uri = "/chunked", .method = HTTP_GET, .handler = chunked_handler },
+        { .uri = "/headers", .method = HTTP_GET, .handler = headers_handler },
+    };
+    for (int i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        TEST_ESP_OK(httpd_register_uri_handler(s_server, &uris[i]));
+    }
+}
+
+static void stop_server(void)
+{
+    TEST_ESP_OK(httpd_stop(s_server));
+    s_server = NULL;
+}
+
+static esp_http_client_handle_t create_client(const char *url, bool zero_copy_read)
+{
+    esp_http_client_config_t config = {
+        .url = url,
+        .buffer_size = TEST_RX_BUF_SIZE,
+        .zero_copy_read = zero_copy_read,
+    };
+    esp_http_client_handle_t client = esp_http_client_init(&config);
+    TEST_ASSERT_NOT_NULL(client);
+    return client;
+}
+
+/* Reads the whole body without copying it, checks it and returns its length */
+static size_t read_body_zero_copy(esp_http_client_handle_t client)
+{
+    size_t total = 0;
+    const char *data;
+    int len;
+    while ((len = esp_http_client_read_zero_copy(client, &data)) > 0) {
+        TEST_ASSERT_EQUAL_MEMORY(s_data + total, data, len);
+        total += len;
+    }
+    TEST_ASSERT_EQUAL(0, len);
+    return total;
+}
+
+TEST_CASE("zero copy read hands out the body from the receive buffer", "[http_client_read]")
+{
+    start_server();
+    for (int zero_copy_read = 0; zero_copy_read <= 1; zero_copy_read++) {
+        esp_http_client_handle_t client = create_client(TEST_DATA_URL, zero_copy_read);
+        /* Several responses on the same connection */
+        for (int i = 0; i < 3; i++) {
+            TEST_ESP_OK(esp_http_client_open(client, 0));
+            TEST_ASSERT_EQUAL(TEST_DATA_LEN, esp_http_client_fetch_headers(client));
+            TEST_ASSERT_EQUAL(TEST_DATA_LEN, read_body_zero_copy(client));
+            TEST_ASSERT_TRUE(esp_http_client_is_complete_data_received(client));
+        }
+        TEST_ESP_OK(esp_http_client_cleanup(client));
+    }
+    stop_server();
+}
+
+TEST_CASE("zero copy read decodes chunked bodies", "[http_client_read]")
+{
+    start_server();
+    for (int zero_copy_read = 0; zero_copy_read <= 1; zero_copy_read++) {
+        esp_http_client_handle_t client = create_client(TEST_CHUNKED_URL, zero_copy_read);
+        for (int i = 0; i < 2; i++) {
+            TEST_ESP_OK(esp_http_client_open(client, 0));
+            TEST_ASSERT_EQUAL(0, esp_http_client_fetch_headers(client));
+            TEST_ASSERT_TRUE(esp_http_client_is_chunked_response(client));
+            TEST_ASSERT_EQUAL(TEST_CHUNKED_LEN, read_body_zero_copy(client));
+            TEST_ASSERT_TRUE(esp_http_client_is_complete_data_received(client));
+        }
+        TEST_ESP_OK(esp_http_client_cleanup(client));
+    }
+    stop_server();
+}
+
+TEST_CASE("zero copy and copying reads can be interleaved", "[http_client_read]")
+{
+    start_server();
+    const char *urls[] = { TEST_DATA_URL, TEST_CHUNKED_URL };
+    const size_t lens[] = { TEST_DATA_LEN, TEST_CHUNKED_LEN };
+    char buf[300];
+    for (int u = 0; u < 2; u++) {
+        for (int zero_copy_read = 0; zero_copy_read <= 1; zero_copy_read++) {
+            esp_http_client_handle_t client = create_client(urls[u], zero_copy_read);
+            TEST_ESP_OK(esp_http_client_open(client, 0));
+            TEST_ASSERT_GREATER_OR_EQUAL(0, esp_http_client_fetch_headers(client));
+            size_t total = 0;
+            for (int i = 0; total < lens[u]; i++) {
+                int len;
+                if (i % 2) {
+                    const char *data;
+                    len = esp_http_client_read_zero_copy(client, &data);
+                    TEST_ASSERT_GREATER_THAN(0, len);
+                    TEST_ASSERT_EQUAL_MEMORY(s_data + total, data, len);
+                } else {
+                    len = esp_http_client_read(client, buf, sizeof(buf));
+                    TEST_ASSERT_GREATER_THAN(0, len);
+                    TEST_ASSERT_EQUAL_MEMORY(s_data + total, buf, len);
+                }
+                total += len;
+            }
+            TEST_ASSERT_EQUAL(lens[u], total);
+            TEST_ASSERT_EQUAL(0, esp_http_client_read(client, buf, sizeof(buf)));
+            TEST_ESP_OK(esp_http_client_cleanup(client));
+        }
+    }
+    stop_server();
+}
+
+TEST_CASE("request headers are set, replaced and deleted", "[http_client_read]")
+{
+    start_server();
+    esp_http_client_handle_t client = create_client(TEST_HEADERS_URL, false);
+    char key[16], value[16], expected[TEST_HEADER_COUNT * 16] = "";
+    char *got;
+    for (int i = 0; i < TEST_HEADER_COUNT; i++) {
+        snprintf(key, sizeof(key), "X-Test-%d", i);
+        snprintf(value, sizeof(value), "%d", i);
+        TEST_ESP_OK(esp_http_client_set_header(client, key, value));
+    }
+    for (int i = 0; i < TEST_HEADER_COUNT; i++) {
+        /* Keys are case insensitive */
+        snprintf(key, sizeof(key), "x-TEST-%d", i);
+        snprintf(value, sizeof(value), "%d", i);
+        TEST_ESP_OK(esp_http_client_get_header(client, key, &got));
+        TEST_ASSERT_EQUAL_STRING(value, got);
+        if (i % 3 == 0) {
+            TEST_ESP_OK(esp_http_client_delete_header(client, key));
+            TEST_ESP_OK(esp_http_client_get_header(client, key, &got));
+            TEST_ASSERT_NULL(got);
+            continue;
+        }
+        /* Values both shorter and longer than the previous ones */
+        snprintf(value, sizeof(value), i % 3 == 1 ? "v" : "value-%d", i);
+        TEST_ESP_OK(esp_http_client_set_header(client, key, value));
+        strcat(expected, value);
+        strcat(expected, ",");
+    }
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_http_client_delete_header(client, "X-Test-0"));
+
+    char resp[sizeof(expected)] = "";
+    TEST_ESP_OK(esp_http_client_open(client, 0));
+    TEST_ASSERT_EQUAL(strlen(expected), esp_http_client_fetch_headers(client));
+    TEST_ASSERT_EQUAL(strlen(expected), esp_http_client_read_response(client, resp, sizeof(resp) - 1));
+    TEST_ASSERT_EQUAL_STRING(expected, resp);
+
+    TEST_ESP_OK(esp_http_client_delete_all_headers(client));
+    TEST_ESP_OK(esp_http_client_get_header(client, "X-Test-1", &got));
+    TEST_ASSERT_NULL(got);
+    TEST_ESP_OK(esp_http_client_cleanup(client));
+    stop_server();
+}
+
+static int64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+typedef struct {
+    int64_t time_us;
+    int allocs;
+} bench_result_t;
+
+/* Downloads the body BENCH_REQUESTS times on one connection */
+static bench_result_t bench_read(bool zero_copy)
+{
+    static char buf[TEST_RX_BUF_SIZE];
+    esp_http_client_handle_t client = create_client(TEST_DATA_URL, zero_copy);
+    /* Connect first, not to count the allocations of the first request */
+    TEST_ESP_OK(esp_http_client_open(client, 0));
+    TEST_ASSERT_EQUAL(BENCH_DATA_LEN, esp_http_client_fetch_headers(client));
+    TEST_ESP_OK(esp_http_client_flush_response(client, NULL));
+
+    int allocs = atomic_load(&s_allocs);
+    int64_t start = time_us();
+    for (int i = 0; i < BENCH_REQUESTS; i++) {
+        TEST_ESP_OK(esp_http_client_open(client, 0));
+        TEST_ASSERT_EQUAL(BENCH_DATA_LEN, esp_http_client_fetch_headers(client));
+        size_t total = 0;
+        const char *data;
+        int len;
+        do {
+            if (zero_copy) {
+                len = esp_http_client_read_zero_copy(client, &data);
+            } else {
+                len = esp_http_client_read(client, buf, sizeof(buf));
+            }
+            TEST_ASSERT_GREATER_OR_EQUAL(0, len);
+            total += len;
+        } while (len > 0);
+        TEST_ASSERT_EQUAL(BENCH_DATA_LEN, total);
+    }
+    bench_result_t result = {
+        .time_us = time_us() - start,
+        .allocs = atomic_load(&s_allocs) - allocs,
+    };
+    TEST_ESP_OK(esp_http_client_cleanup(client));
+    return result;
+}
+
+TEST_CASE("response read benchmark", "[http_client_read]")
+{
+    start_server();
+    s_data_len = BENCH_DATA_LEN;
+    /* Warm up the server and the sockets */
+    bench_read(false);
+    bench_result_t results[2] = { bench_read(false), bench_read(true) };
+    stop_server();
+
+    const char *names[] = { "read", "zero copy" };
+    double mbytes = (double)BENCH_REQUESTS * BENCH_DATA_LEN / (1024 * 1024);
+    printf("%d responses of %d bytes on one connection, including the allocations of the server\n", BENCH_REQUESTS, BENCH_DATA_LEN);
+    printf("%-10s %10s %10s %16s\n", "Read", "Time (ms)", "MB/s", "Allocs/request");
+    for (int i = 0; i < 2; i++) {
+        printf("%-10s %10lld %10.1f %16.1f\n", names[i], (long long)results[i].time_us / 1000,
+               mbytes * 1000000 / results[i].time_us, (double)results[i].allocs / BENCH_REQUESTS);
+    }
+}
+
+TEST_CASE("request header lookup benchmark", "[http_client_read]")
+{
+    esp_http_client_handle_t client = create_client(TEST_HEADERS_URL, false);
+    char keys[TEST_HEADER_COUNT][16], key[16];
+    for (int i = 0; i < TEST_HEADER_COUNT; i++) {
+        snprintf(keys[i], sizeof(keys[i]), "X-Test-%d", i);
+        TEST_ESP_OK(esp_http_client_set_header(client, keys[i], "value"));
+        snprintf(keys[i], sizeof(keys[i]), "x-test-%d", i);
+    }
+    char *value;
+    int64_t start = time_us();
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        esp_http_client_get_header(client, keys[i % TEST_HEADER_COUNT], &value);
+        TEST_ASSERT_NOT_NULL(value);
+    }
+    int64_t lookup_us = time_us() - start;
+
+    int allocs = atomic_load(&s_allocs);
+    for (int i = 0; i < BENCH_LOOKUPS; i++) {
+        snprintf(key, sizeof(key), "%d", i % 1000);
+        TEST_ESP_OK(esp_http_client_set_header(client, "Content-Length", key));
+    }
+    int set_allocs = atomic_load(&s_allocs) - allocs;
+    TEST_ESP_OK(esp_http_client_cleanup(client));
+
+    printf("%d lookups among %d headers: %.1f ns per lookup\n", BENCH_LOOKUPS, TEST_HEADER_COUNT,
+           (double)lookup_us * 1000 / BENCH_LOOKUPS);
+    printf("%d updates of a header: %d allocations\n", BENCH_LOOKUPS, set_allocs);
+}
+
+void app_main(void)
+{
+    printf("Running HTTP client read linux host test app\n");
+    unity_run_menu();
+}
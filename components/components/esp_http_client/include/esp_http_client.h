@@ -154,6 +154,31 @@ typedef enum {
     HTTP_TLS_DYN_BUF_STRATEGY_MAX,      /*!< to indicate max */
 } esp_http_client_tls_dyn_buf_strategy_t;
 
+typedef struct esp_http_client_pool *esp_http_client_pool_handle_t;
+
+/**
+ * @brief Connection pool configuration
+ */
+typedef struct {
+    int max_idle_per_host;      /*!< Max idle connections kept for the same scheme, host and port, default is 2 if zero */
+    int max_idle;               /*!< Max idle connections kept in total, default is 8 if zero */
+    int idle_timeout_ms;        /*!< Idle connections are closed after this time, default is 4000 if zero.
+                                     Should be shorter than the keep-alive timeout of the servers */
+} esp_http_client_pool_config_t;
+
+/**
+ * @brief Connection pool statistics
+ */
+typedef struct {
+    uint32_t reused;            /*!< Connections leased from the pool */
+    uint32_t missed;            /*!< Connects which found no idle connection to lease */
+    uint32_t released;          /*!< Connections handed back to the pool */
+    uint32_t closed_stale;      /*!< Idle connections found closed by the server */
+    uint32_t closed_timeout;    /*!< Idle connections closed after `idle_timeout_ms` */
+    uint32_t closed_limit;      /*!< Idle connections closed to stay within `max_idle_per_host` and `max_idle` */
+    uint32_t idle;              /*!< Idle connections in the pool */
+} esp_http_client_pool_stats_t;
+
 /**
  * @brief HTTP configuration
  */
@@ -232,6 +257,10 @@ typedef struct {
     struct esp_transport_item_t *transport;
 #endif
     esp_http_client_addr_type_t addr_type;  /*!< Address type used in http client configurations */
+    esp_http_client_pool_handle_t connection_pool;  /*!< Connection pool shared with other clients, see `esp_http_client_pool_create`.
+                                                     Not used with a custom transport */
+    bool zero_copy_read;                    /*!< Leave the response body received along with the headers in the receive buffer
+                                                 instead of copying it, to be handed out by `esp_http_client_read_zero_copy` */
 
 #if CONFIG_MBEDTLS_DYNAMIC_BUFFER
     esp_http_client_tls_dyn_buf_strategy_t tls_dyn_buf_strategy; /*!< TLS dynamic buffer strategy */
@@ -663,6 +692,26 @@ bool esp_http_client_is_chunked_response(esp_http_client_handle_t client);
  */
 int esp_http_client_read(esp_http_client_handle_t client, char *buffer, int len);
 
+/**
+ * @brief      Read the next part of the response body without copying it
+ *
+ *             The body is handed out from the receive buffer of the client, after decoding the chunked
+ *             transfer encoding, and the size of each part is bounded by `buffer_size`. Set `zero_copy_read`
+ *             in the configuration to also avoid copying the part of the body received along with the headers.
+ *             This function can be used in place of, or interleaved with, `esp_http_client_read`.
+ *
+ * @param[in]  client  The esp_http_client handle
+ * @param[out] data    Set to the body data, which is valid until the next read from the client
+ *
+ * @return
+ *     - (-1) if any errors
+ *     - (0) if the whole body has been read
+ *     - Length of the data
+ *
+ * @note  (-ESP_ERR_HTTP_EAGAIN = -0x7007) is returned when call is timed-out before any data was ready
+ */
+int esp_http_client_read_zero_copy(esp_http_client_handle_t client, const char **data);
+
 
 /**
  * @brief      Get http response status code, the valid value if this function invoke after `esp_http_client_perform`
@@ -857,6 +906,67 @@ esp_err_t esp_http_client_get_chunk_length(esp_http_client_handle_t client, int
  */
 bool esp_http_client_is_persistent_connection(esp_http_client_handle_t client);
 
+/**
+ * @brief      Create a pool of keep-alive connections, to be shared by several clients
+ *
+ *             A client configured with the pool hands its connection over to the pool once a response
+ *             is complete and the server keeps the connection alive, i.e. at the end of `esp_http_client_perform`,
+ *             and in `esp_http_client_close`. On its next request, a client leases an idle connection
+ *             to the same scheme, host and port from the pool, including its TLS session, and only connects
+ *             if there is none. `HTTP_EVENT_ON_CONNECTED` and `HTTP_EVENT_DISCONNECTED` are dispatched
+ *             when a connection is leased and handed back.
+ *
+ * @note       Connections are matched by scheme, host and port only. All the clients sharing a pool must therefore
+ *             use the same TLS configuration (server verification, client certificate) for a given host.
+ *
+ * @param[in]  config  The pool configuration
+ * @param[out] pool    Handle of the created pool
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_ARG if an argument is invalid
+ *     - ESP_ERR_NO_MEM if there is not enough memory
+ */
+esp_err_t esp_http_client_pool_create(const esp_http_client_pool_config_t *config, esp_http_client_pool_handle_t *pool);
+
+/**
+ * @brief      Close the idle connections and destroy the pool
+ *
+ * @note       The clients configured with the pool must be cleaned up before
+ *
+ * @param[in]  pool  The pool
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_ARG if the pool is NULL
+ */
+esp_err_t esp_http_client_pool_destroy(esp_http_client_pool_handle_t pool);
+
+/**
+ * @brief      Close all the idle connections of the pool
+ *
+ *             Idle connections are otherwise closed after `idle_timeout_ms`, when the pool is used.
+ *
+ * @param[in]  pool  The pool
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_ARG if the pool is NULL
+ */
+esp_err_t esp_http_client_pool_flush(esp_http_client_pool_handle_t pool);
+
+/**
+ * @brief      Get the statistics of the pool
+ *
+ * @param[in]  pool   The pool
+ * @param[out] stats  The statistics
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_ARG if an argument is NULL
+ */
+esp_err_t esp_http_client_pool_get_stats(esp_http_client_pool_handle_t pool, esp_http_client_pool_stats_t *stats);
+
 #ifdef __cplusplus
 }
 #endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <stdarg.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_log.h"
 #include "esp_check.h"
 #include "http_header.h"
@@ -18,24 +19,56 @@
 
 static const char *TAG = "HTTP_HEADER";
 #define HEADER_BUFFER (1024)
+#define HEADER_HASH_BUCKETS (16)
 
 /**
  * dictionary item struct, with key-value pair
  */
 typedef struct http_header_item {
-    char *key;                          /*!< key */
+    char *key;                          /*!< key, allocated along with the item */
     char *value;                        /*!< value */
+    uint32_t hash;                      /*!< hash of the key, case insensitive */
+    struct http_header_item *bucket_next;  /*!< Point to next entry in the same bucket */
     STAILQ_ENTRY(http_header_item) next;   /*!< Point to next entry */
 } http_header_item_t;
 
-STAILQ_HEAD(http_header, http_header_item);
+STAILQ_HEAD(http_header_list, http_header_item);
 
+/**
+ * The items are kept in insertion order to generate the request, and chained in buckets by hash for lookups
+ */
+struct http_header {
+    struct http_header_list items;
+    http_header_item_handle_t buckets[HEADER_HASH_BUCKETS];
+};
+
+/* FNV-1a of the lowercase key */
+static uint32_t http_header_hash(const char *key)
+{
+    uint32_t hash = 2166136261u;
+    while (*key) {
+        hash ^= (uint8_t)tolower((unsigned char)*key++);
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static http_header_item_handle_t *http_header_bucket(http_header_handle_t header, uint32_t hash)
+{
+    return &header->buckets[hash % HEADER_HASH_BUCKETS];
+}
+
+static void http_header_free_item(http_header_item_handle_t item)
+{
+    free(item->value);
+    free(item);
+}
 
 http_header_handle_t http_header_init(void)
 {
     http_header_handle_t header = calloc(1, sizeof(struct http_header));
     ESP_RETURN_ON_FALSE(header, NULL, TAG, "Memory exhausted");
-    STAILQ_INIT(header);
+    STAILQ_INIT(&header->items);
     return header;
 }
 
@@ -48,12 +81,12 @@ esp_err_t http_header_destroy(http_header_handle_t header)
 
 http_header_item_handle_t http_header_get_item(http_header_handle_t header, const char *key)
 {
-    http_header_item_handle_t item;
     if (header == NULL || key == NULL) {
         return NULL;
     }
-    STAILQ_FOREACH(item, header, next) {
-        if (strcasecmp(item->key, key) == 0) {
+    uint32_t hash = http_header_hash(key);
+    for (http_header_item_handle_t item = *http_header_bucket(header, hash); item; item = item->bucket_next) {
+        if (item->hash == hash && strcasecmp(item->key, key) == 0) {
             return item;
         }
     }
@@ -78,18 +111,22 @@ static esp_err_t http_header_new_item(http_header_handle_t header, const char *k
 {
     esp_err_t ret = ESP_OK;
     http_header_item_handle_t item;
+    size_t key_len = strlen(key);
 
-    item = calloc(1, sizeof(http_header_item_t));
+    item = calloc(1, sizeof(http_header_item_t) + key_len + 1);
     ESP_RETURN_ON_FALSE(item, ESP_ERR_NO_MEM, TAG, "Memory exhausted");
-    HTTP_GOTO_ON_FALSE_DBG(http_utils_assign_string(&item->key, key, -1), ESP_ERR_NO_MEM, _header_new_item_exit, TAG, "Failed to assign string");
+    item->key = (char *)(item + 1);
+    memcpy(item->key, key, key_len + 1);
     http_utils_trim_whitespace(&item->key);
     HTTP_GOTO_ON_FALSE_DBG(http_utils_assign_string(&item->value, value, -1), ESP_ERR_NO_MEM, _header_new_item_exit, TAG, "Failed to assign string");
     http_utils_trim_whitespace(&item->value);
-    STAILQ_INSERT_TAIL(header, item, next);
+    item->hash = http_header_hash(item->key);
+    http_header_item_handle_t *bucket = http_header_bucket(header, item->hash);
+    item->bucket_next = *bucket;
+    *bucket = item;
+    STAILQ_INSERT_TAIL(&header->items, item, next);
     return ret;
 _header_new_item_exit:
-    free(item->key);
-    free(item->value);
     free(item);
     return ret;
 }
@@ -105,8 +142,16 @@ esp_err_t http_header_set(http_header_handle_t header, const char *key, const ch
     item = http_header_get_item(header, key);
 
     if (item) {
-        free(item->value);
-        item->value = strdup(value);
+        size_t value_len = strlen(value);
+        if (value_len <= strlen(item->value)) {
+            /* Reuse the allocation, as for the Content-Length set for each request */
+            memcpy(item->value, value, value_len + 1);
+        } else {
+            char *new_value = strdup(value);
+            ESP_RETURN_ON_FALSE(new_value, ESP_ERR_NO_MEM, TAG, "Memory exhausted");
+            free(item->value);
+            item->value = new_value;
+        }
         http_utils_trim_whitespace(&item->value);
         return ESP_OK;
     }
@@ -137,10 +182,13 @@ esp_err_t http_header_delete(http_header_handle_t header, const char *key)
 {
     http_header_item_handle_t item = http_header_get_item(header, key);
     if (item) {
-        STAILQ_REMOVE(header, item, http_header_item, next);
-        free(item->key);
-        free(item->value);
-        free(item);
+        http_header_item_handle_t *link = http_header_bucket(header, item->hash);
+        while (*link != item) {
+            link = &(*link)->bucket_next;
+        }
+        *link = item->bucket_next;
+        STAILQ_REMOVE(&header->items, item, http_header_item, next);
+        http_header_free_item(item);
     } else {
         return ESP_ERR_NOT_FOUND;
     }
@@ -171,7 +219,7 @@ int http_header_generate_string(http_header_handle_t header, int index, char *bu
     bool is_end = false;
 
     // iterate over the header entries to calculate buffer size and determine last item
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         if (item->value && idx >= index) {
             size += strlen(item->key);
             size += strlen(item->value);
@@ -199,7 +247,7 @@ int http_header_generate_string(http_header_handle_t header, int index, char *bu
     // iterate again over the header entries to write only the fitting indices
     int str_len = 0;
     idx = 0;
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         if (item->value && idx >= index && idx < ret_idx) {
             str_len += snprintf(buffer + str_len, *buffer_len - str_len, "%s: %s\r\n", item->key, item->value);
         }
@@ -215,15 +263,14 @@ int http_header_generate_string(http_header_handle_t header, int index, char *bu
 
 esp_err_t http_header_clean(http_header_handle_t header)
 {
-    http_header_item_handle_t item = STAILQ_FIRST(header), tmp;
+    http_header_item_handle_t item = STAILQ_FIRST(&header->items), tmp;
     while (item != NULL) {
         tmp = STAILQ_NEXT(item, next);
-        free(item->key);
-        free(item->value);
-        free(item);
+        http_header_free_item(item);
         item = tmp;
     }
-    STAILQ_INIT(header);
+    STAILQ_INIT(&header->items);
+    memset(header->buckets, 0, sizeof(header->buckets));
     return ESP_OK;
 }
 
@@ -231,7 +278,7 @@ int http_header_count(http_header_handle_t header)
 {
     http_header_item_handle_t item;
     int count = 0;
-    STAILQ_FOREACH(item, header, next) {
+    STAILQ_FOREACH(item, &header->items, next) {
         count ++;
     }
     return count;
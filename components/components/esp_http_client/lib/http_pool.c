@@ -0,0 +1,250 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/queue.h>
+#include <sys/select.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+#include "esp_log.h"
+#include "esp_check.h"
+#include "esp_transport_ssl.h"
+#include "http_pool.h"
+
+static const char *TAG = "HTTP_POOL";
+
+#define DEFAULT_MAX_IDLE_PER_HOST   (2)
+#define DEFAULT_MAX_IDLE            (8)
+#define DEFAULT_IDLE_TIMEOUT_MS     (4000)
+
+/**
+ * Idle connection, with the scheme, host and port it was opened to
+ */
+typedef struct http_pool_conn {
+    char                        *scheme;
+    char                        *host;
+    int                         port;
+    esp_transport_conn_handle_t conn;
+    TickType_t                  idle_since;     /*!< Tick count when the connection was handed back */
+    TAILQ_ENTRY(http_pool_conn) next;
+} http_pool_conn_t;
+
+TAILQ_HEAD(http_pool_conn_list, http_pool_conn);
+
+struct esp_http_client_pool {
+    SemaphoreHandle_t               lock;
+    int                             max_idle_per_host;
+    int                             max_idle;
+    TickType_t                      idle_timeout;
+    esp_http_client_pool_stats_t    stats;
+    struct http_pool_conn_list      idle;       /*!< Most recently handed back first */
+};
+
+static void http_pool_conn_free(http_pool_conn_t *entry)
+{
+    esp_transport_ssl_conn_destroy(entry->conn);
+    free(entry->scheme);
+    free(entry->host);
+    free(entry);
+}
+
+/* Closes the connections outside of the lock, as closing a TLS connection sends an alert */
+static void http_pool_close_list(struct http_pool_conn_list *list)
+{
+    http_pool_conn_t *entry;
+    while ((entry = TAILQ_FIRST(list)) != NULL) {
+        TAILQ_REMOVE(list, entry, next);
+        http_pool_conn_free(entry);
+    }
+}
+
+static bool http_pool_conn_match(const http_pool_conn_t *entry, const char *scheme, const char *host, int port)
+{
+    return entry->port == port && strcasecmp(entry->scheme, scheme) == 0 && strcasecmp(entry->host, host) == 0;
+}
+
+/* An idle connection has nothing to read: data or end of file means that the server has closed it */
+static bool http_pool_conn_alive(const http_pool_conn_t *entry)
+{
+    int sock = esp_transport_ssl_conn_get_socket(entry->conn);
+    if (sock < 0) {
+        return false;
+    }
+    fd_set readset;
+    FD_ZERO(&readset);
+    FD_SET(sock, &readset);
+    struct timeval timeout = { 0 };
+    return select(sock + 1, &readset, NULL, NULL, &timeout) == 0;
+}
+
+static void http_pool_evict(esp_http_client_pool_handle_t pool, http_pool_conn_t *entry, struct http_pool_conn_list *to_close)
+{
+    TAILQ_REMOVE(&pool->idle, entry, next);
+    TAILQ_INSERT_TAIL(to_close, entry, next);
+    pool->stats.idle--;
+}
+
+/* Moves the timed out connections to to_close, must be called with the lock taken */
+static void http_pool_prune(esp_http_client_pool_handle_t pool, struct http_pool_conn_list *to_close)
+{
+    TickType_t now = xTaskGetTickCount();
+    http_pool_conn_t *entry;
+    while ((entry = TAILQ_LAST(&pool->idle, http_pool_conn_list)) != NULL &&
+            now - entry->idle_since >= pool->idle_timeout) {
+        ESP_LOGD(TAG, "Closing idle connection to %s://%s:%d", entry->scheme, entry->host, entry->port);
+        http_pool_evict(pool, entry, to_close);
+        pool->stats.closed_timeout++;
+    }
+}
+
+esp_err_t esp_http_client_pool_create(const esp_http_client_pool_config_t *config, esp_http_client_pool_handle_t *pool)
+{
+    ESP_RETURN_ON_FALSE(config && pool, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+    ESP_RETURN_ON_FALSE(config->max_idle_per_host >= 0 && config->max_idle >= 0 && config->idle_timeout_ms >= 0,
+                        ESP_ERR_INVALID_ARG, TAG, "Invalid configuration");
+
+    esp_http_client_pool_handle_t p = calloc(1, sizeof(struct esp_http_client_pool));
+    ESP_RETURN_ON_FALSE(p, ESP_ERR_NO_MEM, TAG, "Memory exhausted");
+    p->lock = xSemaphoreCreateMutex();
+    if (p->lock == NULL) {
+        free(p);
+        ESP_LOGE(TAG, "Failed to create the pool lock");
+        return ESP_ERR_NO_MEM;
+    }
+    p->max_idle_per_host = config->max_idle_per_host ? config->max_idle_per_host : DEFAULT_MAX_IDLE_PER_HOST;
+    p->max_idle = config->max_idle ? config->max_idle : DEFAULT_MAX_IDLE;
+    p->idle_timeout = pdMS_TO_TICKS(config->idle_timeout_ms ? config->idle_timeout_ms : DEFAULT_IDLE_TIMEOUT_MS);
+    TAILQ_INIT(&p->idle);
+    *pool = p;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_pool_flush(esp_http_client_pool_handle_t pool)
+{
+    ESP_RETURN_ON_FALSE(pool, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    struct http_pool_conn_list to_close = TAILQ_HEAD_INITIALIZER(to_close);
+    xSemaphoreTake(pool->lock, portMAX_DELAY);
+    TAILQ_CONCAT(&to_close, &pool->idle, next);
+    pool->stats.idle = 0;
+    xSemaphoreGive(pool->lock);
+    http_pool_close_list(&to_close);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_pool_destroy(esp_http_client_pool_handle_t pool)
+{
+    ESP_RETURN_ON_FALSE(pool, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    esp_http_client_pool_flush(pool);
+    vSemaphoreDelete(pool->lock);
+    free(pool);
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_pool_get_stats(esp_http_client_pool_handle_t pool, esp_http_client_pool_stats_t *stats)
+{
+    ESP_RETURN_ON_FALSE(pool && stats, ESP_ERR_INVALID_ARG, TAG, "Invalid arguments");
+
+    xSemaphoreTake(pool->lock, portMAX_DELAY);
+    *stats = pool->stats;
+    xSemaphoreGive(pool->lock);
+    return ESP_OK;
+}
+
+esp_err_t http_pool_lease(esp_http_client_pool_handle_t pool, const char *scheme, const char *host, int port, esp_transport_handle_t transport)
+{
+    struct http_pool_conn_list to_close = TAILQ_HEAD_INITIALIZER(to_close);
+    http_pool_conn_t *entry, *found = NULL;
+
+    xSemaphoreTake(pool->lock, portMAX_DELAY);
+    http_pool_prune(pool, &to_close);
+    entry = TAILQ_FIRST(&pool->idle);
+    while (entry != NULL && found == NULL) {
+        http_pool_conn_t *following = TAILQ_NEXT(entry, next);
+        if (http_pool_conn_match(entry, scheme, host, port)) {
+            TAILQ_REMOVE(&pool->idle, entry, next);
+            pool->stats.idle--;
+            if (http_pool_conn_alive(entry)) {
+                found = entry;
+            } else {
+                ESP_LOGD(TAG, "Idle connection to %s://%s:%d was closed by the server", scheme, host, port);
+                TAILQ_INSERT_TAIL(&to_close, entry, next);
+                pool->stats.closed_stale++;
+            }
+        }
+        entry = following;
+    }
+    if (found) {
+        pool->stats.reused++;
+    } else {
+        pool->stats.missed++;
+    }
+    xSemaphoreGive(pool->lock);
+    http_pool_close_list(&to_close);
+
+    if (found == NULL) {
+        return ESP_ERR_NOT_FOUND;
+    }
+    esp_err_t err = esp_transport_ssl_attach_conn(transport, found->conn);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to attach the connection to the transport: %s", esp_err_to_name(err));
+        http_pool_conn_free(found);
+        return ESP_ERR_NOT_FOUND;
+    }
+    found->conn = NULL;
+    http_pool_conn_free(found);
+    return ESP_OK;
+}
+
+esp_err_t http_pool_release(esp_http_client_pool_handle_t pool, const char *scheme, const char *host, int port, esp_transport_handle_t transport)
+{
+    http_pool_conn_t *released = calloc(1, sizeof(http_pool_conn_t));
+    if (released == NULL || (released->scheme = strdup(scheme)) == NULL || (released->host = strdup(host)) == NULL) {
+        if (released) {
+            free(released->scheme);
+            free(released);
+        }
+        return ESP_ERR_NO_MEM;
+    }
+    released->port = port;
+    released->conn = esp_transport_ssl_detach_conn(transport);
+    if (released->conn == NULL) {
+        http_pool_conn_free(released);
+        return ESP_FAIL;
+    }
+
+    struct http_pool_conn_list to_close = TAILQ_HEAD_INITIALIZER(to_close);
+    http_pool_conn_t *entry, *oldest = NULL;
+    int host_count = 0;
+
+    xSemaphoreTake(pool->lock, portMAX_DELAY);
+    http_pool_prune(pool, &to_close);
+    TAILQ_FOREACH(entry, &pool->idle, next) {
+        if (http_pool_conn_match(entry, scheme, host, port)) {
+            host_count++;
+            oldest = entry;
+        }
+    }
+    if (host_count >= pool->max_idle_per_host) {
+        http_pool_evict(pool, oldest, &to_close);
+        pool->stats.closed_limit++;
+    }
+    if (pool->stats.idle >= (uint32_t)pool->max_idle) {
+        http_pool_evict(pool, TAILQ_LAST(&pool->idle, http_pool_conn_list), &to_close);
+        pool->stats.closed_limit++;
+    }
+    released->idle_since = xTaskGetTickCount();
+    TAILQ_INSERT_HEAD(&pool->idle, released, next);
+    pool->stats.idle++;
+    pool->stats.released++;
+    xSemaphoreGive(pool->lock);
+    http_pool_close_list(&to_close);
+    return ESP_OK;
+}
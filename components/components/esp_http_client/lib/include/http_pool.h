@@ -0,0 +1,55 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#ifndef _HTTP_POOL_H_
+#define _HTTP_POOL_H_
+
+#include "esp_err.h"
+#include "esp_transport.h"
+#include "esp_http_client.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief      Attach an idle connection to the scheme, host and port from the pool to the transport
+ *
+ *             Idle connections which have timed out, or have been closed by the server, are closed on the way.
+ *
+ * @param[in]  pool       The pool
+ * @param[in]  scheme     The scheme
+ * @param[in]  host       The host
+ * @param[in]  port       The port
+ * @param[in]  transport  The transport, closed
+ *
+ * @return
+ *     - ESP_OK if a connection has been attached to the transport
+ *     - ESP_ERR_NOT_FOUND if there is no idle connection
+ */
+esp_err_t http_pool_lease(esp_http_client_pool_handle_t pool, const char *scheme, const char *host, int port, esp_transport_handle_t transport);
+
+/**
+ * @brief      Detach the connection from the transport and keep it in the pool as idle
+ *
+ * @param[in]  pool       The pool
+ * @param[in]  scheme     The scheme
+ * @param[in]  host       The host
+ * @param[in]  port       The port
+ * @param[in]  transport  The transport, connected
+ *
+ * @return
+ *     - ESP_OK if the connection has been handed over to the pool, the transport is then closed
+ *     - ESP_FAIL if the connection could not be detached, the transport remains connected
+ *     - ESP_ERR_NO_MEM if there is not enough memory
+ */
+esp_err_t http_pool_release(esp_http_client_pool_handle_t pool, const char *scheme, const char *host, int port, esp_transport_handle_t transport);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _HTTP_POOL_H_ */
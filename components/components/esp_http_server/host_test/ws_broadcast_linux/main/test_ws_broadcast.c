@@ -0,0 +1,485 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <stdatomic.h>
+#include <time.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/param.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "unity.h"
+#include "esp_http_server.h"
+
+#define TEST_PORT           30080
+/* Without lwIP the server supports up to 12 open sockets */
+#define MAX_CLIENTS         12
+/* Number of work items queued to the server at a time, well below what the control socket can hold */
+#define WORK_WINDOW         16
+#define PAYLOAD_RING        64
+#define MAX_PAYLOAD_LEN     4096
+#define WAIT_TIMEOUT_MS     10000
+
+/* Client side of a connection, served by client_thread() */
+typedef struct {
+    int sock;
+    int server_fd;              /* Socket of this client on the server side */
+    bool small_rcvbuf;          /* Shrink the receive buffer, to become slow sooner */
+    atomic_bool paused;         /* Stop reading from the socket */
+    atomic_uint frames;         /* Number of frames received */
+    atomic_bool error;          /* Unexpected frame received */
+    uint32_t next_seq;
+    size_t buf_len;
+    uint8_t buf[2 * (MAX_PAYLOAD_LEN + 4)];
+} test_client_t;
+
+static test_client_t s_clients[MAX_CLIENTS];
+static size_t s_client_count;
+static atomic_int s_handshakes;
+static atomic_bool s_connected;
+static atomic_bool s_connect_failed;
+static atomic_bool s_stop;
+static atomic_bool s_done;
+static pthread_t s_thread;
+
+static httpd_handle_t s_server;
+static SemaphoreHandle_t s_window;
+static atomic_uint s_sent;
+static atomic_uint s_skipped;
+static atomic_uint s_dropped;
+static atomic_uint s_failed;
+
+static uint8_t s_payloads[PAYLOAD_RING][MAX_PAYLOAD_LEN];
+
+static int64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static esp_err_t ws_handler(httpd_req_t *req)
+{
+    if (req->method == HTTP_GET) {
+        int n = atomic_load(&s_handshakes);
+        s_clients[n].server_fd = httpd_req_to_sockfd(req);
+        atomic_store(&s_handshakes, n + 1);
+        return ESP_OK;
+    }
+    /* The clients don't send data frames, nothing to process */
+    httpd_ws_frame_t frame = { 0 };
+    return httpd_ws_recv_frame(req, &frame, 0);
+}
+
+static bool client_connect(test_client_t *c, int index)
+{
+    static const char request[] = "GET /ws HTTP/1.1\r\n"
+                                  "Host: localhost\r\n"
+                                  "Upgrade: websocket\r\n"
+                                  "Connection: Upgrade\r\n"
+                                  "Sec-WebSocket-Key: dGhlIHNhbXBsZSBub25jZQ==\r\n"
+                                  "Sec-WebSocket-Version: 13\r\n\r\n";
+
+    c->sock = socket(AF_INET, SOCK_STREAM, 0);
+    if (c->sock < 0) {
+        return false;
+    }
+    if (c->small_rcvbuf) {
+        int size = 4096;
+        setsockopt(c->sock, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    }
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    if (connect(c->sock, (struct sockaddr *)&addr, sizeof(addr)) != 0 ||
+            send(c->sock, request, sizeof(request) - 1, 0) != sizeof(request) - 1) {
+        return false;
+    }
+
+    /* The server sends nothing after the handshake response until the test starts */
+    char response[256];
+    size_t len = 0;
+    while (len < sizeof(response) - 1) {
+        int ret = recv(c->sock, response + len, sizeof(response) - 1 - len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        len += ret;
+        response[len] = '\0';
+        if (strstr(response, "\r\n\r\n")) {
+            break;
+        }
+    }
+    if (strncmp(response, "HTTP/1.1 101", 12) != 0) {
+        return false;
+    }
+
+    /* Wait for the handler to record the socket on the server side */
+    while (atomic_load(&s_handshakes) <= index) {
+        usleep(100);
+    }
+    return true;
+}
+
+/* Consumes the complete frames in the buffer of the client */
+static void client_parse(test_client_t *c)
+{
+    size_t pos = 0;
+    while (c->buf_len - pos >= 2) {
+        const uint8_t *f = c->buf + pos;
+        size_t avail = c->buf_len - pos;
+        size_t hdr = 2;
+        size_t len = f[1] & 0x7f;
+        if (len == 126) {
+            if (avail < 4) {
+                break;
+            }
+            len = (f[2] << 8) | f[3];
+            hdr = 4;
+        }
+        if (avail < hdr + len) {
+            break;
+        }
+        uint32_t seq = UINT32_MAX;
+        if (len >= sizeof(seq)) {
+            memcpy(&seq, f + hdr, sizeof(seq));
+        }
+        if (f[0] != (0x80 | HTTPD_WS_TYPE_BINARY) || seq != c->next_seq) {
+            atomic_store(&c->error, true);
+        }
+        c->next_seq++;
+        atomic_fetch_add(&c->frames, 1);
+        pos += hdr + len;
+    }
+    memmove(c->buf, c->buf + pos, c->buf_len - pos);
+    c->buf_len -= pos;
+}
+
+/* Runs the clients. This is a plain thread rather than a task, so that it can block in socket calls. */
+static void *client_thread(void *arg)
+{
+    for (size_t i = 0; i < s_client_count; i++) {
+        if (!client_connect(&s_clients[i], i)) {
+            atomic_store(&s_connect_failed, true);
+            break;
+        }
+    }
+    atomic_store(&s_connected, true);
+
+    struct pollfd pfds[MAX_CLIENTS];
+    while (!atomic_load(&s_stop)) {
+        size_t n = 0;
+        for (size_t i = 0; i < s_client_count; i++) {
+            pfds[n].fd = atomic_load(&s_clients[i].paused) ? -1 : s_clients[i].sock;
+            pfds[n].events = POLLIN;
+            n++;
+        }
+        if (poll(pfds, n, 10) <= 0) {
+            continue;
+        }
+        for (size_t i = 0; i < n; i++) {
+            if (!(pfds[i].revents & POLLIN)) {
+                continue;
+            }
+            test_client_t *c = &s_clients[i];
+            int ret = recv(c->sock, c->buf + c->buf_len, sizeof(c->buf) - c->buf_len, 0);
+            if (ret > 0) {
+                c->buf_len += ret;
+                client_parse(c);
+            }
+        }
+    }
+
+    for (size_t i = 0; i < s_client_count; i++) {
+        if (s_clients[i].sock >= 0) {
+            close(s_clients[i].sock);
+        }
+    }
+    atomic_store(&s_done, true);
+    return NULL;
+}
+
+static bool wait_for(atomic_bool *flag)
+{
+    for (int i = 0; i < WAIT_TIMEOUT_MS && !atomic_load(flag); i++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    return atomic_load(flag);
+}
+
+static void start_test(size_t client_count, bool first_slow)
+{
+    memset(s_clients, 0, sizeof(s_clients));
+    for (size_t i = 0; i < MAX_CLIENTS; i++) {
+        s_clients[i].sock = -1;
+    }
+    s_clients[0].small_rcvbuf = first_slow;
+    s_clients[0].paused = first_slow;
+    s_client_count = client_count;
+    s_handshakes = 0;
+    s_connected = false;
+    s_connect_failed = false;
+    s_stop = false;
+    s_done = false;
+    s_sent = s_skipped = s_dropped = s_failed = 0;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = TEST_PORT;
+    config.max_open_sockets = MAX_CLIENTS;
+    TEST_ESP_OK(httpd_start(&s_server, &config));
+    httpd_uri_t ws = {
+        .uri = "/ws",
+        .method = HTTP_GET,
+        .handler = ws_handler,
+        .is_websocket = true,
+    };
+    TEST_ESP_OK(httpd_register_uri_handler(s_server, &ws));
+
+    s_window = xSemaphoreCreateCounting(WORK_WINDOW, WORK_WINDOW);
+    TEST_ASSERT_NOT_NULL(s_window);
+
+    /* Keep the signals used by the FreeRTOS port away from the client thread */
+    sigset_t all, old;
+    sigfillset(&all);
+    pthread_sigmask(SIG_BLOCK, &all, &old);
+    int ret = pthread_create(&s_thread, NULL, client_thread, NULL);
+    pthread_sigmask(SIG_SETMASK, &old, NULL);
+    TEST_ASSERT_EQUAL(0, ret);
+
+    TEST_ASSERT_TRUE(wait_for(&s_connected));
+    TEST_ASSERT_FALSE(s_connect_failed);
+}
+
+static void stop_test(void)
+{
+    /* Let the work in flight finish */
+    for (int i = 0; i < WORK_WINDOW; i++) {
+        xSemaphoreTake(s_window, portMAX_DELAY);
+    }
+    atomic_store(&s_stop, true);
+    TEST_ASSERT_TRUE(wait_for(&s_done));
+    pthread_join(s_thread, NULL);
+    TEST_ESP_OK(httpd_stop(s_server));
+    vSemaphoreDelete(s_window);
+}
+
+/* Waits until the clients [first, last) have received the given number of frames */
+static void wait_frames(size_t first, size_t last, unsigned frames)
+{
+    for (size_t i = first; i < last; i++) {
+        for (int t = 0; t < WAIT_TIMEOUT_MS && atomic_load(&s_clients[i].frames) < frames; t++) {
+            vTaskDelay(pdMS_TO_TICKS(1));
+        }
+        TEST_ASSERT_EQUAL(frames, atomic_load(&s_clients[i].frames));
+        TEST_ASSERT_FALSE(atomic_load(&s_clients[i].error));
+    }
+}
+
+static void broadcast_done(const httpd_ws_broadcast_result_t *result, void *arg)
+{
+    atomic_fetch_add(&s_sent, result->sent);
+    atomic_fetch_add(&s_skipped, result->skipped);
+    atomic_fetch_add(&s_dropped, result->dropped);
+    atomic_fetch_add(&s_failed, result->failed);
+    xSemaphoreGive(s_window);
+}
+
+static void send_done(esp_err_t err, int socket, void *arg)
+{
+    atomic_fetch_add(err == ESP_OK ? &s_sent : &s_failed, 1);
+    xSemaphoreGive(s_window);
+}
+
+static httpd_ws_frame_t make_frame(uint32_t seq, size_t len)
+{
+    uint8_t *payload = s_payloads[seq % PAYLOAD_RING];
+    memset(payload, seq, len);
+    memcpy(payload, &seq, sizeof(seq));
+    httpd_ws_frame_t frame = {
+        .type = HTTPD_WS_TYPE_BINARY,
+        .payload = payload,
+        .len = len,
+    };
+    return frame;
+}
+
+static void broadcast(uint32_t seq, size_t len, const int *fds, size_t fd_count, httpd_ws_broadcast_policy_t policy)
+{
+    httpd_ws_frame_t frame = make_frame(seq, len);
+    httpd_ws_shared_frame_t *shared;
+    TEST_ESP_OK(httpd_ws_shared_frame_create(&frame, &shared));
+    xSemaphoreTake(s_window, portMAX_DELAY);
+    TEST_ESP_OK(httpd_ws_broadcast_async(s_server, shared, fds, fd_count, policy, broadcast_done, NULL));
+    httpd_ws_shared_frame_release(shared);
+}
+
+TEST_CASE("broadcast sends the frame to every client in order", "[ws_broadcast]")
+{
+    const size_t clients = 8;
+    const unsigned frames = 100;
+    start_test(clients, false);
+
+    for (uint32_t seq = 0; seq < frames; seq++) {
+        broadcast(seq, 200 + seq, NULL, 0, HTTPD_WS_BROADCAST_WAIT);
+    }
+    wait_frames(0, clients, frames);
+    stop_test();
+
+    TEST_ASSERT_EQUAL(clients * frames, s_sent);
+    TEST_ASSERT_EQUAL(0, s_skipped + s_dropped + s_failed);
+}
+
+TEST_CASE("broadcast to a list of clients", "[ws_broadcast]")
+{
+    const size_t clients = 6;
+    const unsigned frames = 10;
+    start_test(clients, false);
+
+    int fds[clients / 2 + 1];
+    for (size_t i = 0; i < clients / 2; i++) {
+        fds[i] = s_clients[2 * i].server_fd;
+    }
+    fds[clients / 2] = 10000;  /* not a client */
+
+    for (uint32_t seq = 0; seq < frames; seq++) {
+        broadcast(seq, 16, fds, clients / 2 + 1, HTTPD_WS_BROADCAST_WAIT);
+    }
+    for (size_t i = 0; i < clients; i += 2) {
+        wait_frames(i, i + 1, frames);
+    }
+    stop_test();
+
+    for (size_t i = 1; i < clients; i += 2) {
+        TEST_ASSERT_EQUAL(0, s_clients[i].frames);
+    }
+    TEST_ASSERT_EQUAL(clients / 2 * frames, s_sent);
+    TEST_ASSERT_EQUAL(frames, s_failed);
+}
+
+TEST_CASE("broadcast skips or drops slow clients", "[ws_broadcast]")
+{
+    const size_t clients = 4;
+    start_test(clients, true);
+
+    /* The first client doesn't read, until its socket is full */
+    uint32_t seq = 0;
+    while (atomic_load(&s_skipped) == 0 && seq < 20000) {
+        broadcast(seq++, MAX_PAYLOAD_LEN, NULL, 0, HTTPD_WS_BROADCAST_SKIP_SLOW);
+        if (seq % WORK_WINDOW == 0) {
+            wait_frames(1, clients, seq);
+        }
+    }
+    wait_frames(1, clients, seq);
+    TEST_ASSERT_GREATER_THAN(0, s_skipped);
+    TEST_ASSERT_EQUAL(0, s_dropped);
+
+    broadcast(seq++, MAX_PAYLOAD_LEN, NULL, 0, HTTPD_WS_BROADCAST_DROP_SLOW);
+    wait_frames(1, clients, seq);
+    TEST_ASSERT_EQUAL(1, s_dropped);
+
+    int slow_fd = s_clients[0].server_fd;
+    for (int t = 0; t < WAIT_TIMEOUT_MS && httpd_ws_get_fd_info(s_server, slow_fd) == HTTPD_WS_CLIENT_WEBSOCKET; t++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    TEST_ASSERT_NOT_EQUAL(HTTPD_WS_CLIENT_WEBSOCKET, httpd_ws_get_fd_info(s_server, slow_fd));
+    stop_test();
+}
+
+/* Sends a few bytes of the frame, then fails as if the connection was lost */
+static int fail_mid_frame_send(httpd_handle_t hd, int sockfd, const char *buf, size_t buf_len, int flags)
+{
+    static bool s_started;
+    if (s_started) {
+        s_started = false;
+        return HTTPD_SOCK_ERR_FAIL;
+    }
+    s_started = true;
+    return send(sockfd, buf, MIN(buf_len, 8), flags);
+}
+
+static void set_failing_send(void *arg)
+{
+    httpd_sess_set_send_override(s_server, *(int *)arg, fail_mid_frame_send);
+    xSemaphoreGive(s_window);
+}
+
+TEST_CASE("broadcast closes clients whose frame was cut", "[ws_broadcast]")
+{
+    const size_t clients = 4;
+    start_test(clients, false);
+
+    int broken_fd = s_clients[0].server_fd;
+    xSemaphoreTake(s_window, portMAX_DELAY);
+    TEST_ESP_OK(httpd_queue_work(s_server, set_failing_send, &broken_fd));
+
+    broadcast(0, 200, NULL, 0, HTTPD_WS_BROADCAST_WAIT);
+    wait_frames(1, clients, 1);
+    for (int t = 0; t < WAIT_TIMEOUT_MS && httpd_ws_get_fd_info(s_server, broken_fd) == HTTPD_WS_CLIENT_WEBSOCKET; t++) {
+        vTaskDelay(pdMS_TO_TICKS(1));
+    }
+    TEST_ASSERT_NOT_EQUAL(HTTPD_WS_CLIENT_WEBSOCKET, httpd_ws_get_fd_info(s_server, broken_fd));
+
+    /* The following frames go to the other clients only */
+    broadcast(1, 200, NULL, 0, HTTPD_WS_BROADCAST_WAIT);
+    wait_frames(1, clients, 2);
+    stop_test();
+
+    TEST_ASSERT_EQUAL(0, s_clients[0].frames);
+    TEST_ASSERT_EQUAL(2 * (clients - 1), s_sent);
+    TEST_ASSERT_EQUAL(1, s_failed);
+}
+
+TEST_CASE("broadcast fan-out benchmark", "[ws_broadcast]")
+{
+    const size_t clients = MAX_CLIENTS;
+    const unsigned frames = 1000;
+    const size_t len = 256;
+    start_test(clients, false);
+
+    /* Baseline: the frame is queued to every client separately */
+    int64_t start = time_us();
+    for (uint32_t seq = 0; seq < frames; seq++) {
+        httpd_ws_frame_t frame = make_frame(seq, len);
+        for (size_t i = 0; i < clients; i++) {
+            xSemaphoreTake(s_window, portMAX_DELAY);
+            TEST_ESP_OK(httpd_ws_send_data_async(s_server, s_clients[i].server_fd, &frame, send_done, NULL));
+        }
+    }
+    wait_frames(0, clients, frames);
+    int64_t per_client_us = time_us() - start;
+
+    start = time_us();
+    for (uint32_t seq = frames; seq < 2 * frames; seq++) {
+        broadcast(seq, len, NULL, 0, HTTPD_WS_BROADCAST_WAIT);
+    }
+    wait_frames(0, clients, 2 * frames);
+    int64_t broadcast_us = time_us() - start;
+    stop_test();
+
+    TEST_ASSERT_EQUAL(2 * clients * frames, s_sent);
+    printf("%u frames of %u bytes to %u clients\n", frames, (unsigned)len, (unsigned)clients);
+    printf("%-24s %10s %14s\n", "Method", "Time (ms)", "Frames/s");
+    printf("%-24s %10lld %14.0f\n", "httpd_ws_send_data_async", (long long)per_client_us / 1000,
+           (double)clients * frames * 1000000 / per_client_us);
+    printf("%-24s %10lld %14.0f\n", "httpd_ws_broadcast_async", (long long)broadcast_us / 1000,
+           (double)clients * frames * 1000000 / broadcast_us);
+}
+
+void app_main(void)
+{
+    printf("Running WebSocket broadcast linux host test app\n");
+    unity_run_menu();
+}
@@ -1763,12 +1763,14 @@ esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *pkt);
  *
  * This API should rarely be called directly, with an exception of asynchronous send using httpd_queue_work.
  *
+ * @note If sending fails, a part of the frame may have been sent already, so the session is closed.
+ *
  * @param[in] hd      Server instance data
  * @param[in] fd      Socket descriptor for sending data
  * @param[in] frame     WebSocket frame
  * @return
  *  - ESP_OK                    : On successful
- *  - ESP_FAIL                  : When socket errors occurs
+ *  - ESP_FAIL                  : When socket errors occurs, the session is then closed
  *  - ESP_ERR_INVALID_STATE     : Handshake was already done beforehand
  *  - ESP_ERR_INVALID_ARG       : Argument is invalid (null or non-WebSocket)
  */
@@ -1816,6 +1818,87 @@ esp_err_t httpd_ws_send_data(httpd_handle_t handle, int socket, httpd_ws_frame_t
 esp_err_t httpd_ws_send_data_async(httpd_handle_t handle, int socket, httpd_ws_frame_t *frame,
                                    transfer_complete_cb callback, void *arg);
 
+/**
+ * @brief What a broadcast does with clients which can't take more data
+ */
+typedef enum {
+    HTTPD_WS_BROADCAST_WAIT = 0,    /*!< Send to every client, waiting for slow ones up to the send timeout of the server */
+    HTTPD_WS_BROADCAST_SKIP_SLOW,   /*!< Don't send the frame to clients whose socket is not writable */
+    HTTPD_WS_BROADCAST_DROP_SLOW,   /*!< Close the session of clients whose socket is not writable */
+} httpd_ws_broadcast_policy_t;
+
+/**
+ * @brief Outcome of a broadcast, passed to its completion callback
+ */
+typedef struct {
+    size_t sent;                /*!< Number of clients the frame was sent to */
+    size_t skipped;             /*!< Number of slow clients skipped, with HTTPD_WS_BROADCAST_SKIP_SLOW */
+    size_t dropped;             /*!< Number of slow clients closed, with HTTPD_WS_BROADCAST_DROP_SLOW */
+    size_t failed;              /*!< Number of clients for which sending failed, whose sessions are closed,
+                                     or which were not WebSocket clients */
+} httpd_ws_broadcast_result_t;
+
+/**
+ * @brief Broadcast complete callback
+ */
+typedef void (*httpd_ws_broadcast_cb_t)(const httpd_ws_broadcast_result_t *result, void *arg);
+
+/**
+ * @brief WebSocket frame encoded once to be sent to many clients
+ *
+ * It holds the header and a copy of the payload in one buffer and is reference counted,
+ * so the same frame can be passed to several broadcasts.
+ */
+typedef struct httpd_ws_shared_frame httpd_ws_shared_frame_t;
+
+/**
+ * @brief Encode a WebSocket frame for broadcasting
+ *
+ * The payload is copied, so the frame can be released or reused as soon as this returns.
+ * The shared frame is created with a reference count of one, which belongs to the caller.
+ *
+ * @param[in]  frame   WebSocket frame
+ * @param[out] shared  Encoded frame
+ * @return
+ *  - ESP_OK                    : On successful
+ *  - ESP_ERR_INVALID_ARG       : Null arguments
+ *  - ESP_ERR_NO_MEM            : Unable to allocate memory
+ */
+esp_err_t httpd_ws_shared_frame_create(const httpd_ws_frame_t *frame, httpd_ws_shared_frame_t **shared);
+
+/**
+ * @brief Release a reference to an encoded frame, freeing it when it was the last one
+ *
+ * @param[in] shared  Encoded frame
+ */
+void httpd_ws_shared_frame_release(httpd_ws_shared_frame_t *shared);
+
+/**
+ * @brief Sends an encoded frame to several websockets asynchronously
+ *
+ * All the clients are served by a single work item in the context of the server, which takes
+ * its own reference to the frame: the caller may release it as soon as this returns.
+ * With HTTPD_WS_BROADCAST_SKIP_SLOW and HTTPD_WS_BROADCAST_DROP_SLOW a client is slow when its
+ * socket is not writable at the moment its turn comes. A frame which has been started is always
+ * sent completely, so a client which is short of buffer space may still delay the others.
+ *
+ * @param[in] handle    Server instance data
+ * @param[in] shared    Encoded frame, from httpd_ws_shared_frame_create()
+ * @param[in] fds       Socket descriptors to send to, or NULL for all the active WebSocket clients
+ * @param[in] fd_count  Number of socket descriptors in fds
+ * @param[in] policy    What to do with slow clients
+ * @param[in] callback  Callback invoked after sending to all clients, may be NULL
+ * @param[in] arg       User data passed to provided callback
+ * @return
+ *  - ESP_OK                    : On successful
+ *  - ESP_ERR_INVALID_ARG       : Null arguments
+ *  - ESP_FAIL                  : Failure in ctrl socket
+ *  - ESP_ERR_NO_MEM            : Unable to allocate memory
+ */
+esp_err_t httpd_ws_broadcast_async(httpd_handle_t handle, httpd_ws_shared_frame_t *shared,
+                                   const int *fds, size_t fd_count, httpd_ws_broadcast_policy_t policy,
+                                   httpd_ws_broadcast_cb_t callback, void *arg);
+
 #endif /* CONFIG_HTTPD_WS_SUPPORT || __DOXYGEN__ */
 /** End of WebSocket related stuff
  * @}
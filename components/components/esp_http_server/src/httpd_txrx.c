@@ -135,6 +135,10 @@ int httpd_recv_with_opt(httpd_req_t *r, char *buf, size_t buf_len, httpd_recv_op
             }
             return ret;
         }
+        if (ret == 0) {
+            /* Connection closed by the peer, no more data will follow */
+            break;
+        }
 
         recv_len += ret;
         buf      += ret;
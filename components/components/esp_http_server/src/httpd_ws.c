@@ -8,12 +8,15 @@
 
 #include <stdlib.h>
 #include <string.h>
+#include <stdatomic.h>
 #include <sys/random.h>
+#include <sys/select.h>
 #include <esp_log.h>
 #include <esp_err.h>
 #include <mbedtls/sha1.h>
 #include <mbedtls/base64.h>
 #include <mbedtls/error.h>
+#include <esp_tls_crypto.h>
 
 #include <esp_http_server.h>
 #include "esp_httpd_priv.h"
@@ -22,6 +25,10 @@
 
 #ifdef CONFIG_HTTPD_WS_SUPPORT
 
+/* Maximum length of the header of a frame sent by the server: 2 bytes header, 8 bytes length.
+ * The server does not mask its frames, so there is no mask key. */
+#define HTTPD_WS_MAX_HEADER_LEN 10
+
 #define WS_SEND_OK      (1 << 0)
 #define WS_SEND_FAILED  (1 << 1)
 
@@ -264,9 +271,8 @@ static esp_err_t httpd_ws_unmask_payload(uint8_t *payload, size_t len, const uin
         return ESP_ERR_INVALID_ARG;
     }
 
-    for (size_t idx = 0; idx < len; idx++) {
-        payload[idx] = (payload[idx] ^ mask_key[idx % 4]);
-    }
+    /* Same word-wide kernel as the WebSocket client, in place from the start of the payload */
+    esp_crypto_ws_mask(payload, payload, len, mask_key, 0);
 
     return ESP_OK;
 }
@@ -401,16 +407,11 @@ esp_err_t httpd_ws_send_frame(httpd_req_t *req, httpd_ws_frame_t *frame)
     return httpd_ws_send_frame_async(req->handle, httpd_req_to_sockfd(req), frame);
 }
 
-esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+/* Encodes the header of a frame sent by the server into header_buf, returns its length */
+static uint8_t httpd_ws_encode_header(const httpd_ws_frame_t *frame, uint8_t header_buf[HTTPD_WS_MAX_HEADER_LEN])
 {
-    if (!frame) {
-        ESP_LOGW(TAG, LOG_FMT("Argument is invalid"));
-        return ESP_ERR_INVALID_ARG;
-    }
-
-    /* Prepare Tx buffer - maximum length is 14, which includes 2 bytes header, 8 bytes length, 4 bytes mask key */
     uint8_t tx_len = 0;
-    uint8_t header_buf[10] = {0 };
+    memset(header_buf, 0, HTTPD_WS_MAX_HEADER_LEN);
     /* Set the `FIN` bit by default if message is not fragmented. Else, set it as per the `final` field */
     header_buf[0] |= (!frame->fragmented) ? HTTPD_WS_FIN_BIT : (frame->final? HTTPD_WS_FIN_BIT: HTTPD_WS_CONTINUE);
     header_buf[0] |= frame->type; /* Type (opcode): 4 bits */
@@ -439,14 +440,29 @@ esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t
     /* WebSocket server does not required to mask response payload, so leave the MASK bit as 0. */
     header_buf[1] &= (~HTTPD_WS_MASK_BIT);
 
+    return tx_len;
+}
+
+esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t *frame)
+{
+    if (!frame) {
+        ESP_LOGW(TAG, LOG_FMT("Argument is invalid"));
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t header_buf[HTTPD_WS_MAX_HEADER_LEN];
+    uint8_t tx_len = httpd_ws_encode_header(frame, header_buf);
+
     struct sock_db *sess = httpd_sess_get(hd, fd);
     if (!sess) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    /* Send off header */
+    /* Send off header. If it fails, a part of it may have been sent,
+     * so the client can't find the start of the next frame: close the session. */
     if (sess->send_fn(hd, fd, (const char *)header_buf, tx_len, 0) < 0) {
         ESP_LOGW(TAG, LOG_FMT("Failed to send WS header"));
+        httpd_sess_trigger_close_(hd, sess);
         return ESP_FAIL;
     }
 
@@ -454,6 +470,7 @@ esp_err_t httpd_ws_send_frame_async(httpd_handle_t hd, int fd, httpd_ws_frame_t
     if(frame->len > 0 && frame->payload != NULL) {
         if (sess->send_fn(hd, fd, (const char *)frame->payload, frame->len, 0) < 0) {
             ESP_LOGW(TAG, LOG_FMT("Failed to send WS payload"));
+            httpd_sess_trigger_close_(hd, sess);
             return ESP_FAIL;
         }
     }
@@ -629,4 +646,171 @@ esp_err_t httpd_ws_send_data_async(httpd_handle_t handle, int socket, httpd_ws_f
     return ESP_OK;
 }
 
+struct httpd_ws_shared_frame {
+    atomic_int refcount;
+    size_t len;                 /* Length of data, header and payload */
+    uint8_t data[];
+};
+
+typedef struct {
+    httpd_ws_shared_frame_t *shared;
+    httpd_handle_t handle;
+    httpd_ws_broadcast_policy_t policy;
+    httpd_ws_broadcast_cb_t callback;
+    void *arg;
+    httpd_ws_broadcast_result_t result;
+    bool all_clients;           /* Send to all the active WebSocket clients rather than to fds */
+    size_t fd_count;
+    int fds[];
+} broadcast_transfer_t;
+
+esp_err_t httpd_ws_shared_frame_create(const httpd_ws_frame_t *frame, httpd_ws_shared_frame_t **shared)
+{
+    if (!frame || !shared || (frame->len > 0 && !frame->payload)) {
+        ESP_LOGW(TAG, LOG_FMT("Argument is invalid"));
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t header_buf[HTTPD_WS_MAX_HEADER_LEN];
+    uint8_t header_len = httpd_ws_encode_header(frame, header_buf);
+
+    httpd_ws_shared_frame_t *sf = malloc(sizeof(httpd_ws_shared_frame_t) + header_len + frame->len);
+    if (sf == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    atomic_init(&sf->refcount, 1);
+    sf->len = header_len + frame->len;
+    memcpy(sf->data, header_buf, header_len);
+    if (frame->len > 0) {
+        memcpy(sf->data + header_len, frame->payload, frame->len);
+    }
+    *shared = sf;
+    return ESP_OK;
+}
+
+void httpd_ws_shared_frame_release(httpd_ws_shared_frame_t *shared)
+{
+    if (shared && atomic_fetch_sub(&shared->refcount, 1) == 1) {
+        free(shared);
+    }
+}
+
+/* Checks, without waiting, whether the socket can take more data */
+static bool httpd_ws_sock_writable(int fd)
+{
+    fd_set write_set;
+    FD_ZERO(&write_set);
+    FD_SET(fd, &write_set);
+    struct timeval tv = { 0 };
+    return select(fd + 1, NULL, &write_set, NULL, &tv) > 0;
+}
+
+static void httpd_ws_broadcast_close(struct httpd_data *hd, struct sock_db *sess)
+{
+    /* Skipped by later broadcasts, until the queued close is processed */
+    sess->ws_close = true;
+    httpd_sess_trigger_close_(hd, sess);
+}
+
+static void httpd_ws_broadcast_to(broadcast_transfer_t *trans, struct sock_db *sess)
+{
+    struct httpd_data *hd = (struct httpd_data *) trans->handle;
+
+    if (trans->policy != HTTPD_WS_BROADCAST_WAIT && !httpd_ws_sock_writable(sess->fd)) {
+        if (trans->policy == HTTPD_WS_BROADCAST_DROP_SLOW) {
+            ESP_LOGD(TAG, LOG_FMT("Closing slow client %d"), sess->fd);
+            httpd_ws_broadcast_close(hd, sess);
+            trans->result.dropped++;
+        } else {
+            trans->result.skipped++;
+        }
+        return;
+    }
+
+    const char *buf = (const char *)trans->shared->data;
+    size_t buf_len = trans->shared->len;
+    while (buf_len > 0) {
+        int ret = sess->send_fn(hd, sess->fd, buf, buf_len, 0);
+        if (ret < 0) {
+            /* A part of the frame may have been sent already, the client would take
+             * the rest of it and the following frames for garbage */
+            ESP_LOGW(TAG, LOG_FMT("Failed to send WS frame to %d, closing it"), sess->fd);
+            httpd_ws_broadcast_close(hd, sess);
+            trans->result.failed++;
+            return;
+        }
+        buf += ret;
+        buf_len -= ret;
+    }
+    trans->result.sent++;
+}
+
+static int httpd_ws_broadcast_enum(struct sock_db *session, void *context)
+{
+    if (session->fd >= 0 && session->ws_handshake_done && !session->ws_close) {
+        httpd_ws_broadcast_to(context, session);
+    }
+    return 1;
+}
+
+static void httpd_ws_broadcast_cb(void *arg)
+{
+    broadcast_transfer_t *trans = arg;
+    struct httpd_data *hd = (struct httpd_data *) trans->handle;
+
+    if (trans->all_clients) {
+        httpd_sess_enum(hd, httpd_ws_broadcast_enum, trans);
+    } else {
+        for (size_t i = 0; i < trans->fd_count; i++) {
+            struct sock_db *sess = httpd_sess_get(hd, trans->fds[i]);
+            if (!sess || !sess->ws_handshake_done || sess->ws_close) {
+                trans->result.failed++;
+                continue;
+            }
+            httpd_ws_broadcast_to(trans, sess);
+        }
+    }
+
+    if (trans->callback) {
+        trans->callback(&trans->result, trans->arg);
+    }
+    httpd_ws_shared_frame_release(trans->shared);
+    free(trans);
+}
+
+esp_err_t httpd_ws_broadcast_async(httpd_handle_t handle, httpd_ws_shared_frame_t *shared,
+                                   const int *fds, size_t fd_count, httpd_ws_broadcast_policy_t policy,
+                                   httpd_ws_broadcast_cb_t callback, void *arg)
+{
+    if (!handle || !shared || (!fds && fd_count > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    broadcast_transfer_t *transfer = calloc(1, sizeof(broadcast_transfer_t) + fd_count * sizeof(int));
+    if (transfer == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+
+    transfer->shared = shared;
+    transfer->handle = handle;
+    transfer->policy = policy;
+    transfer->callback = callback;
+    transfer->arg = arg;
+    transfer->all_clients = (fds == NULL);
+    transfer->fd_count = fd_count;
+    if (fd_count > 0) {
+        memcpy(transfer->fds, fds, fd_count * sizeof(int));
+    }
+
+    atomic_fetch_add(&shared->refcount, 1);
+    esp_err_t err = httpd_queue_work(handle, httpd_ws_broadcast_cb, transfer);
+    if (err != ESP_OK) {
+        atomic_fetch_sub(&shared->refcount, 1);
+        free(transfer);
+        return err;
+    }
+
+    return ESP_OK;
+}
+
 #endif /* CONFIG_HTTPD_WS_SUPPORT */
@@ -0,0 +1,63 @@
+#!/usr/bin/env python
+#
+# compress_ota_image compresses an app image, or a delta made by gen_ota_delta.py, for
+# esp_https_ota with esp_https_ota_config_t::compressed_image set
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+from __future__ import division, print_function
+
+import argparse
+import sys
+import zlib
+
+__version__ = '1.0'
+
+# The device allocates a window of 2^window_bits bytes to decompress the image
+DEFAULT_WINDOW_BITS = 12
+
+quiet = False
+
+
+def status(msg):
+    if not quiet:
+        print(msg)
+
+
+def compress_image(image, window_bits):
+    """ Returns the image as a zlib stream, the window size being recorded in its header """
+    compressor = zlib.compressobj(9, zlib.DEFLATED, window_bits, 9)
+    return compressor.compress(image) + compressor.flush()
+
+
+def main():
+    global quiet
+    parser = argparse.ArgumentParser(description='Compresses an app image or a delta for esp_https_ota compressed updates')
+    parser.add_argument('--quiet', '-q', help='Don\'t print non-critical status messages to stderr', action='store_true')
+    parser.add_argument('--window-bits', '-w', help='Base-2 logarithm of the window size, the device needs this much RAM to decompress '
+                        '(default: %(default)s, i.e. 4 KB)', type=int, choices=range(9, 16), default=DEFAULT_WINDOW_BITS)
+    parser.add_argument('input', help='App image or delta to compress')
+    parser.add_argument('--output', '-o', help='Path of the compressed image', required=True)
+    args = parser.parse_args()
+    quiet = args.quiet
+
+    with open(args.input, 'rb') as f:
+        image = f.read()
+
+    compressed = compress_image(image, args.window_bits)
+    if zlib.decompress(compressed) != image:
+        raise RuntimeError('The compressed image does not decompress to the input')
+
+    with open(args.output, 'wb') as f:
+        f.write(compressed)
+    status('Compressed {} bytes to {} bytes ({:.1f}%), with a {} byte window'.format(
+        len(image), len(compressed), 100.0 * len(compressed) / max(len(image), 1), 1 << args.window_bits))
+    return 0
+
+
+if __name__ == '__main__':
+    try:
+        sys.exit(main())
+    except RuntimeError as e:
+        print(e, file=sys.stderr)
+        sys.exit(2)
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2017-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2017-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -67,6 +67,13 @@ typedef struct {
     uint32_t buffer_caps;                          /*!< The memory capability to use when allocating the buffer for OTA update. Default capability is MALLOC_CAP_DEFAULT */
     bool ota_resumption;                           /*!< Enable resumption in downloading of OTA image between reboots */
     size_t ota_image_bytes_written;                /*!< Number of OTA image bytes written to flash so far, updated by the application when OTA data is written successfully in the target OTA partition. */
+    int pipeline_depth;                            /*!< Number of download buffers shared with a task which writes them to flash, so that the next chunk is downloaded while the previous ones are written.
+                                                        0 or 1: each chunk is written to flash by esp_https_ota_perform() itself. Not used with ota_resumption. */
+    bool delta_update;                             /*!< The URL serves a delta made by gen_ota_delta.py against the running app, see esp_ota_delta.h. The new image is rebuilt while the delta is downloaded.
+                                                        Image sizes and lengths read are then those of the delta. Not supported with ota_resumption. */
+    bool compressed_image;                         /*!< The URL serves the image, or the delta with delta_update, compressed as a zlib stream (see compress_ota_image.py). It is inflated with the ROM
+                                                        decompressor between the download and the flash writes, using about 11 KB plus the window of the stream (4 KB by default).
+                                                        Image sizes and lengths read are then those of the compressed data. Not supported with ota_resumption. */
 #if CONFIG_ESP_HTTPS_OTA_DECRYPT_CB || __DOXYGEN__
     decrypt_cb_t decrypt_cb;                       /*!< Callback for external decryption layer */
     void *decrypt_user_ctx;                        /*!< User context for external decryption layer */
@@ -147,6 +154,14 @@ esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_http
  * This function must be called in a loop since it returns after every HTTP read operation thus
  * giving you the flexibility to stop OTA operation midway.
  *
+ * With `pipeline_depth` of 2 or more, the data read is queued to the flash write task and this function
+ * only blocks when all the buffers are waiting to be written. A failed flash write is returned by a later
+ * call, and this function returns ESP_OK only once all the data has been written.
+ *
+ * With `delta_update` or `compressed_image`, the header of the image is checked as soon as it is rebuilt, as the
+ * first chunk of a downloaded image is: chip ID and revision, description magic and, with
+ * CONFIG_BOOTLOADER_APP_ANTI_ROLLBACK, the secure version of an app.
+ *
  * @param[in]  https_ota_handle  pointer to esp_https_ota_handle_t structure
  *
  * @return
@@ -156,6 +171,7 @@ esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_http
  *    - ESP_ERR_INVALID_ARG: Invalid argument
  *    - ESP_ERR_INVALID_VERSION: Invalid chip revision in image header
  *    - ESP_ERR_OTA_VALIDATE_FAILED: Invalid app image
+ *    - ESP_ERR_OTA_SMALL_SEC_VER: Secure version of an app rebuilt from a delta or decompressed is lower than the one in efuse
  *    - ESP_ERR_NO_MEM: Cannot allocate memory for OTA operation.
  *    - ESP_ERR_FLASH_OP_TIMEOUT or ESP_ERR_FLASH_OP_FAIL: Flash write failed.
  *    - For other return codes, refer OTA documentation in esp-idf's app_update component.
@@ -193,6 +209,7 @@ bool esp_https_ota_is_complete_data_received(esp_https_ota_handle_t https_ota_ha
  *    - ESP_ERR_INVALID_STATE
  *    - ESP_ERR_INVALID_ARG: Invalid argument
  *    - ESP_ERR_OTA_VALIDATE_FAILED: Invalid app image
+ *    - ESP_ERR_OTA_SMALL_SEC_VER: Secure version of an app rebuilt from a delta or decompressed is lower than the one in efuse
  */
 esp_err_t esp_https_ota_finish(esp_https_ota_handle_t https_ota_handle);
 
@@ -229,6 +246,7 @@ esp_err_t esp_https_ota_abort(esp_https_ota_handle_t https_ota_handle);
  * @return
  *    - ESP_ERR_INVALID_ARG: Invalid arguments
  *    - ESP_ERR_INVALID_STATE: Invalid state to call this API. esp_https_ota_begin() not called yet.
+ *    - ESP_ERR_NOT_SUPPORTED: The update is a delta or is compressed, the description is only known once the image is rebuilt
  *    - ESP_FAIL: Failed to read image descriptor
  *    - ESP_OK: Successfully read image descriptor
  */
@@ -258,6 +276,10 @@ esp_err_t esp_https_ota_get_bootloader_img_desc(esp_https_ota_handle_t https_ota
 * @note   This API should be called only if `esp_https_ota_perform()` has been called at least once or
 *         if `esp_https_ota_get_img_desc` has been called before.
 *
+* @note   With `pipeline_depth` of 2 or more, this includes the data still waiting to be written to flash.
+*
+* @note   With `delta_update` or `compressed_image`, this is the number of bytes of the delta or of the compressed data read so far.
+*
 * @param[in]   https_ota_handle   pointer to esp_https_ota_handle_t structure
 *
 * @return
@@ -10,12 +10,21 @@
 #include <esp_https_ota.h>
 #include <esp_log.h>
 #include <esp_ota_ops.h>
+#include "esp_ota_delta.h"
+#include "miniz.h"
 #include <errno.h>
 #include <sys/param.h>
 #include <inttypes.h>
 #include "esp_check.h"
 #include "esp_flash_encrypt.h"
 #include "hal/efuse_hal.h"
+#ifdef CONFIG_BOOTLOADER_APP_ANTI_ROLLBACK
+#include "esp_efuse.h"
+#endif
+#include "freertos/FreeRTOS.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
 
 ESP_EVENT_DEFINE_BASE(ESP_HTTPS_OTA_EVENT);
 
@@ -29,6 +38,11 @@ _Static_assert(DEFAULT_OTA_BUF_SIZE > (sizeof(esp_image_header_t) + sizeof(esp_i
 
 #define DEFAULT_REQUEST_SIZE (64 * 1024)
 
+/* Start of an image rebuilt from a delta or decompressed, which holds what the first chunk of a downloaded image is checked for */
+#define REBUILT_HEADER_SIZE (sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t) + sizeof(esp_app_desc_t))
+
+_Static_assert(sizeof(esp_bootloader_desc_t) <= sizeof(esp_app_desc_t), "Rebuilt header too small for the bootloader description");
+
 static const int DEFAULT_MAX_AUTH_RETRIES = 10;
 
 static const char *TAG = "esp_https_ota";
@@ -41,6 +55,23 @@ typedef enum {
     ESP_HTTPS_OTA_RESUME,
 } esp_https_ota_state;
 
+/* Chunk handed over to the flash write task of pipelined OTA */
+typedef struct {
+    char *buf;                  /*!< Download buffer to give back once written, NULL to only signal the caller */
+    const void *data;           /*!< Data to write, the decrypted data if there is a decrypt callback */
+    size_t len;
+    bool stop;                  /*!< The task exits after signalling the caller */
+} ota_pipeline_chunk_t;
+
+/* Inflates a compressed image (or delta) before it is written */
+typedef struct {
+    tinfl_decompressor inflator;
+    uint8_t *window;            /*!< Output of the inflator, which is also its dictionary. Sized by the zlib header */
+    uint32_t window_size;
+    uint32_t window_len;        /*!< Bytes inflated into window, written once it is full or the stream ends */
+    bool done;
+} ota_decompress_t;
+
 struct esp_https_ota_handle {
     esp_ota_handle_t update_handle;
     struct {                                  /*!< Details of staging and final partitions for OTA update */
@@ -57,7 +88,24 @@ struct esp_https_ota_handle {
     esp_https_ota_state state;
     bool bulk_flash_erase;
     bool partial_http_download;
+    bool delta_update;
+    esp_ota_delta_handle_t delta;             /*!< Rebuilds the new image from the downloaded delta, created with the update handle */
+    ota_decompress_t *decompress;             /*!< Set if the downloaded data is compressed */
+    struct {                                  /*!< Start of the image rebuilt from a delta or decompressed, checked once complete */
+        uint8_t data[REBUILT_HEADER_SIZE];
+        size_t len;
+    } rebuilt_header;
     int max_authorization_retries;
+    struct {                                  /*!< Flash write task of pipelined OTA, started by the first read of image data */
+        int depth;                            /*!< Number of download buffers, 1 if the data is written by esp_https_ota_perform */
+        char *bufs;                           /*!< The download buffers after ota_upgrade_buf, each of ota_upgrade_buf_size */
+        QueueHandle_t free_bufs;              /*!< Download buffers ready to be read into */
+        QueueHandle_t filled;                 /*!< Chunks waiting to be written */
+        SemaphoreHandle_t done;
+        TaskHandle_t task;
+        volatile esp_err_t err;               /*!< First error of esp_ota_write, no more data is written after it */
+        int written;
+    } pipeline;
 #if CONFIG_ESP_HTTPS_OTA_DECRYPT_CB
     decrypt_cb_t decrypt_cb;
     void *decrypt_user_ctx;
@@ -264,12 +312,156 @@ static void esp_https_ota_decrypt_cb_free_buf(void *buffer)
 }
 #endif // CONFIG_ESP_HTTPS_OTA_DECRYPT_CB
 
+/* The data downloaded is not the image itself, but a delta of it or a compressed form */
+static bool ota_data_is_image(const esp_https_ota_t *handle)
+{
+    return !handle->delta_update && handle->decompress == NULL;
+}
+
+static esp_err_t esp_ota_verify_chip_id(const void *arg);
+static esp_err_t esp_ota_verify_chip_revision(const void *arg);
+
+/* Checks the start of an image rebuilt from a delta or decompressed, as the first chunk of a downloaded image is checked */
+static esp_err_t ota_check_rebuilt_header(esp_https_ota_t *handle)
+{
+    const esp_image_header_t *header = (const esp_image_header_t *)handle->rebuilt_header.data;
+    const void *img_info = handle->rebuilt_header.data + sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t);
+
+    if (header->magic != ESP_IMAGE_HEADER_MAGIC) {
+        ESP_LOGE(TAG, "Rebuilt image has an invalid magic byte 0x%02x", header->magic);
+        return ESP_ERR_OTA_VALIDATE_FAILED;
+    }
+    esp_err_t err = esp_ota_verify_chip_id(header);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = esp_ota_verify_chip_revision(header);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (handle->partition.final->type == ESP_PARTITION_TYPE_APP) {
+        const esp_app_desc_t *app_info = (const esp_app_desc_t *)img_info;
+        if (app_info->magic_word != ESP_APP_DESC_MAGIC_WORD) {
+            ESP_LOGE(TAG, "Incorrect app descriptor magic");
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+        }
+#ifdef CONFIG_BOOTLOADER_APP_ANTI_ROLLBACK
+        // esp_https_ota_get_img_desc() is not supported for these images, so the secure version is checked here
+        if (!esp_efuse_check_secure_version(app_info->secure_version)) {
+            ESP_LOGE(TAG, "Secure version %" PRIu32 " of the rebuilt image is lower than the one in efuse", app_info->secure_version);
+            return ESP_ERR_OTA_SMALL_SEC_VER;
+        }
+#endif
+    } else {
+        const esp_bootloader_desc_t *bootloader_info = (const esp_bootloader_desc_t *)img_info;
+        if (bootloader_info->magic_byte != ESP_BOOTLOADER_DESC_MAGIC_BYTE) {
+            ESP_LOGE(TAG, "Incorrect bootloader descriptor magic");
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+        }
+    }
+    return ESP_OK;
+}
+
+/* Writes the image to the update partition. The start of an image rebuilt from a delta or decompressed is
+ * checked once it is complete, before the data which completes it is written. */
+static esp_err_t ota_flash_write(esp_https_ota_t *handle, const void *data, size_t len)
+{
+    const bool checked_type = handle->partition.final->type == ESP_PARTITION_TYPE_APP || handle->partition.final->type == ESP_PARTITION_TYPE_BOOTLOADER;
+    if (!ota_data_is_image(handle) && checked_type && handle->rebuilt_header.len < REBUILT_HEADER_SIZE) {
+        size_t n = MIN(len, REBUILT_HEADER_SIZE - handle->rebuilt_header.len);
+        memcpy(handle->rebuilt_header.data + handle->rebuilt_header.len, data, n);
+        handle->rebuilt_header.len += n;
+        if (handle->rebuilt_header.len == REBUILT_HEADER_SIZE) {
+            esp_err_t err = ota_check_rebuilt_header(handle);
+            if (err != ESP_OK) {
+                return err;
+            }
+        }
+    }
+    return esp_ota_write(handle->update_handle, data, len);
+}
+
+static esp_err_t ota_delta_image_write_cb(const void *data, size_t size, void *user_ctx)
+{
+    return ota_flash_write((esp_https_ota_t *)user_ctx, data, size);
+}
+
+static esp_err_t ota_delta_write(esp_https_ota_t *handle, const void *data, size_t len)
+{
+    if (handle->delta) {
+        return esp_ota_delta_write(handle->delta, data, len);
+    }
+    return ota_flash_write(handle, data, len);
+}
+
+static esp_err_t ota_decompress_write(esp_https_ota_t *handle, const uint8_t *data, size_t len)
+{
+    ota_decompress_t *decompress = handle->decompress;
+    if (decompress->window == NULL && len > 0) {
+        /* CINFO, the high nibble of the first byte of the zlib header, is log2 of the window size minus 8.
+         * tinfl fails on a window larger than its output buffer, this makes it just as large. */
+        decompress->window_size = 1 << (8 + MIN(data[0] >> 4, 7));
+        decompress->window = malloc(decompress->window_size);
+        if (decompress->window == NULL) {
+            ESP_LOGE(TAG, "Couldn't allocate memory for a %" PRIu32 " byte decompression window", decompress->window_size);
+            return ESP_ERR_NO_MEM;
+        }
+        ESP_LOGD(TAG, "Compressed image with a %" PRIu32 " byte window", decompress->window_size);
+    }
+
+    tinfl_status status = TINFL_STATUS_NEEDS_MORE_INPUT;
+    while (len > 0 || status == TINFL_STATUS_HAS_MORE_OUTPUT) {
+        if (decompress->done) {
+            ESP_LOGE(TAG, "Data received after the end of the compressed image");
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+        }
+        size_t in_size = len;
+        size_t out_size = decompress->window_size - decompress->window_len;
+        status = tinfl_decompress(&decompress->inflator, data, &in_size, decompress->window, decompress->window + decompress->window_len,
+                                  &out_size, TINFL_FLAG_PARSE_ZLIB_HEADER | TINFL_FLAG_HAS_MORE_INPUT);
+        data += in_size;
+        len -= in_size;
+        decompress->window_len += out_size;
+        if (status < TINFL_STATUS_DONE) {
+            ESP_LOGE(TAG, "Decompression of the image failed (%d)", status);
+            return ESP_ERR_OTA_VALIDATE_FAILED;
+        }
+        decompress->done = (status == TINFL_STATUS_DONE);
+        if (decompress->window_len == decompress->window_size || decompress->done) {
+            esp_err_t err = ota_delta_write(handle, decompress->window, decompress->window_len);
+            if (err != ESP_OK) {
+                return err;
+            }
+            decompress->window_len = 0;
+        }
+    }
+    return ESP_OK;
+}
+
+static void ota_decompress_free(esp_https_ota_t *handle)
+{
+    if (handle->decompress) {
+        free(handle->decompress->window);
+        free(handle->decompress);
+        handle->decompress = NULL;
+    }
+}
+
+/* Writes downloaded data to the update partition, decompressing it and applying it as a delta as configured */
+static esp_err_t ota_image_write(esp_https_ota_t *handle, const void *data, size_t len)
+{
+    if (handle->decompress) {
+        return ota_decompress_write(handle, data, len);
+    }
+    return ota_delta_write(handle, data, len);
+}
+
 static esp_err_t _ota_write(esp_https_ota_t *https_ota_handle, const void *buffer, size_t buf_len)
 {
     if (buffer == NULL || https_ota_handle == NULL) {
         return ESP_FAIL;
     }
-    esp_err_t err = esp_ota_write(https_ota_handle->update_handle, buffer, buf_len);
+    esp_err_t err = ota_image_write(https_ota_handle, buffer, buf_len);
     if (err != ESP_OK) {
         ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%x", err);
     } else {
@@ -285,6 +477,135 @@ static esp_err_t _ota_write(esp_https_ota_t *https_ota_handle, const void *buffe
     return err;
 }
 
+static void ota_pipeline_task(void *arg)
+{
+    esp_https_ota_t *handle = (esp_https_ota_t *)arg;
+    ota_pipeline_chunk_t chunk;
+
+    while (xQueueReceive(handle->pipeline.filled, &chunk, portMAX_DELAY) == pdTRUE) {
+        if (chunk.buf == NULL) {
+            bool stop = chunk.stop;
+            xSemaphoreGive(handle->pipeline.done);
+            if (stop) {
+                break;
+            }
+            continue;
+        }
+        if (handle->pipeline.err == ESP_OK) {
+            esp_err_t err = ota_image_write(handle, chunk.data, chunk.len);
+            if (err != ESP_OK) {
+                ESP_LOGE(TAG, "Error: esp_ota_write failed! err=0x%x", err);
+                handle->pipeline.err = err;
+            } else {
+                handle->pipeline.written += chunk.len;
+                ESP_LOGD(TAG, "Written image length %d", handle->pipeline.written);
+            }
+            esp_https_ota_dispatch_event(ESP_HTTPS_OTA_WRITE_FLASH, (void *)(&handle->pipeline.written), sizeof(int));
+        }
+#if CONFIG_ESP_HTTPS_OTA_DECRYPT_CB
+        esp_https_ota_decrypt_cb_free_buf((void *) chunk.data);
+#endif
+        xQueueSend(handle->pipeline.free_bufs, &chunk.buf, portMAX_DELAY);
+    }
+    vTaskDelete(NULL);
+}
+
+static void ota_pipeline_delete(esp_https_ota_t *handle)
+{
+    if (handle->pipeline.free_bufs) {
+        vQueueDelete(handle->pipeline.free_bufs);
+        handle->pipeline.free_bufs = NULL;
+    }
+    if (handle->pipeline.filled) {
+        vQueueDelete(handle->pipeline.filled);
+        handle->pipeline.filled = NULL;
+    }
+    if (handle->pipeline.done) {
+        vSemaphoreDelete(handle->pipeline.done);
+        handle->pipeline.done = NULL;
+    }
+}
+
+static esp_err_t ota_pipeline_start(esp_https_ota_t *handle)
+{
+    /* One more chunk than buffers, so that signalling the task never blocks */
+    handle->pipeline.free_bufs = xQueueCreate(handle->pipeline.depth, sizeof(char *));
+    handle->pipeline.filled = xQueueCreate(handle->pipeline.depth + 1, sizeof(ota_pipeline_chunk_t));
+    handle->pipeline.done = xSemaphoreCreateBinary();
+    if (!handle->pipeline.free_bufs || !handle->pipeline.filled || !handle->pipeline.done) {
+        ESP_LOGE(TAG, "Couldn't allocate memory for the flash write task");
+        ota_pipeline_delete(handle);
+        return ESP_ERR_NO_MEM;
+    }
+    handle->pipeline.written = handle->binary_file_len;
+    xQueueSend(handle->pipeline.free_bufs, &handle->ota_upgrade_buf, 0);
+    for (int i = 0; i < handle->pipeline.depth - 1; i++) {
+        char *buf = handle->pipeline.bufs + i * handle->ota_upgrade_buf_size;
+        xQueueSend(handle->pipeline.free_bufs, &buf, 0);
+    }
+    if (xTaskCreate(ota_pipeline_task, "https_ota_write", CONFIG_ESP_HTTPS_OTA_PIPELINE_TASK_STACK_SIZE,
+                    handle, CONFIG_ESP_HTTPS_OTA_PIPELINE_TASK_PRIORITY, &handle->pipeline.task) != pdPASS) {
+        ESP_LOGE(TAG, "Couldn't create the flash write task");
+        handle->pipeline.task = NULL;
+        ota_pipeline_delete(handle);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+/* Waits for the flash write task to write all the chunks handed over to it */
+static esp_err_t ota_pipeline_sync(esp_https_ota_t *handle, bool stop)
+{
+    if (handle->pipeline.task == NULL) {
+        return ESP_OK;
+    }
+    ota_pipeline_chunk_t chunk = { .stop = stop };
+    xQueueSend(handle->pipeline.filled, &chunk, portMAX_DELAY);
+    xSemaphoreTake(handle->pipeline.done, portMAX_DELAY);
+    if (stop) {
+        handle->pipeline.task = NULL;
+        ota_pipeline_delete(handle);
+    }
+    return handle->pipeline.err;
+}
+
+/* Takes a free download buffer, blocking while all of them wait to be written */
+static esp_err_t ota_pipeline_get_buf(esp_https_ota_t *handle, char **buf)
+{
+    if (handle->pipeline.task == NULL) {
+        esp_err_t err = ota_pipeline_start(handle);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    if (handle->pipeline.err != ESP_OK) {
+        return handle->pipeline.err;
+    }
+    xQueueReceive(handle->pipeline.free_bufs, buf, portMAX_DELAY);
+    return ESP_OK;
+}
+
+static void ota_pipeline_put_buf(esp_https_ota_t *handle, char *buf)
+{
+    if (handle->pipeline.task) {
+        xQueueSend(handle->pipeline.free_bufs, &buf, 0);
+    }
+}
+
+/* Hands the data read into buf over to the flash write task */
+static esp_err_t ota_pipeline_write(esp_https_ota_t *handle, char *buf, const void *data, size_t len)
+{
+    ota_pipeline_chunk_t chunk = {
+        .buf = buf,
+        .data = data,
+        .len = len,
+    };
+    xQueueSend(handle->pipeline.filled, &chunk, portMAX_DELAY);
+    /* Counts the data downloaded, which is what the next HTTP range starts from */
+    handle->binary_file_len += len;
+    return handle->pipeline.err != ESP_OK ? handle->pipeline.err : ESP_ERR_HTTPS_OTA_IN_PROGRESS;
+}
+
 static bool is_server_verification_enabled(const esp_https_ota_config_t *ota_config) {
     return  (ota_config->http_config->cert_pem
             || ota_config->http_config->use_global_ca_store
@@ -325,6 +646,13 @@ esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_http
     }
 #endif
 
+    if ((ota_config->delta_update || ota_config->compressed_image) && ota_config->ota_resumption) {
+        // The state of the delta being applied or of the decompressor is not kept between reboots
+        ESP_LOGE(TAG, "OTA resumption is not supported for delta or compressed updates");
+        *handle = NULL;
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
     esp_https_ota_t *https_ota_handle = calloc(1, sizeof(esp_https_ota_t));
     if (!https_ota_handle) {
         ESP_LOGE(TAG, "Couldn't allocate memory to upgrade data buffer");
@@ -333,6 +661,7 @@ esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_http
     }
 
     https_ota_handle->partial_http_download = ota_config->partial_http_download;
+    https_ota_handle->delta_update = ota_config->delta_update;
     https_ota_handle->max_http_request_size = (ota_config->max_http_request_size == 0) ? DEFAULT_REQUEST_SIZE : ota_config->max_http_request_size;
     https_ota_handle->max_authorization_retries = ota_config->http_config->max_authorization_retries;
 
@@ -342,6 +671,13 @@ esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_http
         https_ota_handle->max_authorization_retries = 0;
     }
 
+    https_ota_handle->pipeline.depth = MAX(ota_config->pipeline_depth, 1);
+    if (ota_config->ota_resumption && https_ota_handle->pipeline.depth > 1) {
+        // The bytes written to flash must be known whenever esp_https_ota_perform returns
+        ESP_LOGW(TAG, "pipeline_depth is not supported with ota_resumption, writing without pipeline");
+        https_ota_handle->pipeline.depth = 1;
+    }
+
     if (ota_config->ota_resumption) {
         // We allow resumption only if we have minimum buffer size already written to flash
         if (ota_config->ota_image_bytes_written >= DEFAULT_OTA_BUF_SIZE) {
@@ -517,6 +853,31 @@ esp_err_t esp_https_ota_begin(const esp_https_ota_config_t *ota_config, esp_http
         err = ESP_ERR_NO_MEM;
         goto http_cleanup;
     }
+    if (https_ota_handle->pipeline.depth > 1) {
+        const size_t bufs_size = (https_ota_handle->pipeline.depth - 1) * alloc_size;
+        if (ota_config->buffer_caps != 0) {
+            https_ota_handle->pipeline.bufs = (char *)heap_caps_malloc(bufs_size, ota_config->buffer_caps);
+        } else {
+            https_ota_handle->pipeline.bufs = (char *)malloc(bufs_size);
+        }
+        if (!https_ota_handle->pipeline.bufs) {
+            ESP_LOGE(TAG, "Couldn't allocate memory for %d download buffers", https_ota_handle->pipeline.depth);
+            free(https_ota_handle->ota_upgrade_buf);
+            err = ESP_ERR_NO_MEM;
+            goto http_cleanup;
+        }
+    }
+    if (ota_config->compressed_image) {
+        // The window is allocated once its size is read from the start of the image
+        https_ota_handle->decompress = calloc(1, sizeof(ota_decompress_t));
+        if (!https_ota_handle->decompress) {
+            ESP_LOGE(TAG, "Couldn't allocate memory for the decompressor");
+            free(https_ota_handle->pipeline.bufs);
+            free(https_ota_handle->ota_upgrade_buf);
+            err = ESP_ERR_NO_MEM;
+            goto http_cleanup;
+        }
+    }
 #if CONFIG_ESP_HTTPS_OTA_DECRYPT_CB
     https_ota_handle->decrypt_cb = ota_config->decrypt_cb;
     https_ota_handle->decrypt_user_ctx = ota_config->decrypt_user_ctx;
@@ -590,6 +951,10 @@ static esp_err_t get_description_from_image(esp_https_ota_handle_t https_ota_han
         ESP_LOGE(TAG, "esp_https_ota_get_img_desc: Invalid state");
         return ESP_ERR_INVALID_STATE;
     }
+    if (!ota_data_is_image(handle)) {
+        // The image header is only known once the data is decompressed or applied as a delta
+        return ESP_ERR_NOT_SUPPORTED;
+    }
 
     unsigned img_info_len = 0;
     if (handle->partition.final->type == ESP_PARTITION_TYPE_APP) {
@@ -604,6 +969,10 @@ static esp_err_t get_description_from_image(esp_https_ota_handle_t https_ota_han
     const int offset = sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t);
     void *img_info = NULL;
 
+    // All the download buffers are back once the data read so far is in flash
+    esp_err_t err = ota_pipeline_sync(handle, false);
+    ESP_RETURN_ON_ERROR(err, TAG, "flash write failed %d", err);
+
     if (handle->binary_file_len >= offset + img_info_len) {
         esp_err_t ret = esp_partition_read(handle->partition.staging, offset, handle->ota_upgrade_buf, img_info_len);
         ESP_RETURN_ON_ERROR(ret, TAG, "partition read failed %d", ret);
@@ -680,7 +1049,9 @@ esp_err_t esp_https_ota_perform(esp_https_ota_handle_t https_ota_handle)
 
     esp_err_t err;
     int data_read;
-    const size_t erase_size = handle->bulk_flash_erase ? (handle->image_length > 0 ? handle->image_length : OTA_SIZE_UNKNOWN) : OTA_WITH_SEQUENTIAL_WRITES;
+    char *buf = handle->ota_upgrade_buf;
+    // The length of a delta or of a compressed image is not the one of the image
+    const size_t erase_size = handle->bulk_flash_erase ? (handle->image_length > 0 && ota_data_is_image(handle) ? handle->image_length : OTA_SIZE_UNKNOWN) : OTA_WITH_SEQUENTIAL_WRITES;
     switch (handle->state) {
         case ESP_HTTPS_OTA_BEGIN:
             err = esp_ota_begin(handle->partition.staging, erase_size, &handle->update_handle);
@@ -689,6 +1060,20 @@ esp_err_t esp_https_ota_perform(esp_https_ota_handle_t https_ota_handle)
                 return err;
             }
             esp_ota_set_final_partition(handle->update_handle, handle->partition.final, handle->partition.finalize_with_copy);
+            if (handle->delta_update) {
+                err = esp_ota_delta_begin(handle->update_handle, NULL, &handle->delta);
+                if (err != ESP_OK) {
+                    ESP_LOGE(TAG, "esp_ota_delta_begin failed (%s)", esp_err_to_name(err));
+                    esp_ota_abort(handle->update_handle);
+                    return err;
+                }
+                esp_ota_delta_set_write_cb(handle->delta, ota_delta_image_write_cb, handle);
+            }
+            if (!ota_data_is_image(handle)) {
+                /* The header of the image is checked once it is rebuilt, all the data is read as image data */
+                handle->state = ESP_HTTPS_OTA_IN_PROGRESS;
+                return ESP_ERR_HTTPS_OTA_IN_PROGRESS;
+            }
             handle->state = ESP_HTTPS_OTA_IN_PROGRESS;
             /* In case `esp_https_ota_get_img_desc` was invoked first,
                then the image data read there should be written to OTA partition
@@ -745,9 +1130,18 @@ esp_err_t esp_https_ota_perform(esp_https_ota_handle_t https_ota_handle)
             handle->state = ESP_HTTPS_OTA_IN_PROGRESS;
             /* falls through */
         case ESP_HTTPS_OTA_IN_PROGRESS:
+            if (handle->pipeline.depth > 1) {
+                err = ota_pipeline_get_buf(handle, &buf);
+                if (err != ESP_OK) {
+                    return err;
+                }
+            }
             data_read = esp_http_client_read(handle->http_client,
-                                             handle->ota_upgrade_buf,
+                                             buf,
                                              handle->ota_upgrade_buf_size);
+            if (data_read <= 0) {
+                ota_pipeline_put_buf(handle, buf);
+            }
             if (data_read == 0) {
                 /*
                  *  esp_http_client_is_complete_data_received is added to check whether
@@ -759,20 +1153,24 @@ esp_err_t esp_https_ota_perform(esp_https_ota_handle_t https_ota_handle)
                 }
                 ESP_LOGD(TAG, "Connection closed");
             } else if (data_read > 0) {
-                const void *data_buf = (const void *) handle->ota_upgrade_buf;
+                const void *data_buf = (const void *) buf;
                 int data_len = data_read;
 #if CONFIG_ESP_HTTPS_OTA_DECRYPT_CB
                 decrypt_cb_arg_t args = {};
-                args.data_in = handle->ota_upgrade_buf;
+                args.data_in = buf;
                 args.data_in_len = data_read;
                 err = esp_https_ota_decrypt_cb(handle, &args);
                 if (err == ESP_OK) {
                     data_buf = args.data_out;
                     data_len = args.data_out_len;
                 } else {
+                    ota_pipeline_put_buf(handle, buf);
                     return err;
                 }
 #endif // CONFIG_ESP_HTTPS_OTA_DECRYPT_CB
+                if (handle->pipeline.depth > 1) {
+                    return ota_pipeline_write(handle, buf, data_buf, data_len);
+                }
                 return _ota_write(handle, data_buf, data_len);
             } else {
                 if (data_read == -ESP_ERR_HTTP_EAGAIN) {
@@ -822,7 +1220,7 @@ esp_err_t esp_https_ota_perform(esp_https_ota_handle_t https_ota_handle)
             return ESP_ERR_HTTPS_OTA_IN_PROGRESS;
         }
     }
-    return ESP_OK;
+    return ota_pipeline_sync(handle, false);
 }
 
 bool esp_https_ota_is_complete_data_received(esp_https_ota_handle_t https_ota_handle)
@@ -851,13 +1249,28 @@ esp_err_t esp_https_ota_finish(esp_https_ota_handle_t https_ota_handle)
     switch (handle->state) {
         case ESP_HTTPS_OTA_SUCCESS:
         case ESP_HTTPS_OTA_IN_PROGRESS:
-            err = esp_ota_end(handle->update_handle);
+            err = ota_pipeline_sync(handle, true);
+            if (err == ESP_OK && handle->decompress && !handle->decompress->done) {
+                ESP_LOGE(TAG, "Compressed image is incomplete");
+                err = ESP_ERR_INVALID_SIZE;
+            }
+            if (handle->delta) {
+                esp_err_t delta_err = esp_ota_delta_end(handle->delta);
+                err = (err == ESP_OK) ? delta_err : err;
+            }
+            if (err == ESP_OK) {
+                err = esp_ota_end(handle->update_handle);
+            } else {
+                esp_ota_abort(handle->update_handle);
+            }
             /* falls through */
         case ESP_HTTPS_OTA_BEGIN:
         case ESP_HTTPS_OTA_RESUME:
             if (handle->ota_upgrade_buf) {
                 free(handle->ota_upgrade_buf);
             }
+            free(handle->pipeline.bufs);
+            ota_decompress_free(handle);
             if (handle->http_client) {
                 _http_cleanup(handle->http_client);
             }
@@ -902,6 +1315,10 @@ esp_err_t esp_https_ota_abort(esp_https_ota_handle_t https_ota_handle)
     switch (handle->state) {
         case ESP_HTTPS_OTA_SUCCESS:
         case ESP_HTTPS_OTA_IN_PROGRESS:
+            ota_pipeline_sync(handle, true);
+            if (handle->delta) {
+                esp_ota_delta_abort(handle->delta);
+            }
             err = esp_ota_abort(handle->update_handle);
             /* falls through */
         case ESP_HTTPS_OTA_BEGIN:
@@ -909,6 +1326,8 @@ esp_err_t esp_https_ota_abort(esp_https_ota_handle_t https_ota_handle)
             if (handle->ota_upgrade_buf) {
                 free(handle->ota_upgrade_buf);
             }
+            free(handle->pipeline.bufs);
+            ota_decompress_free(handle);
             if (handle->http_client) {
                 _http_cleanup(handle->http_client);
             }
@@ -0,0 +1,34 @@
+#!/usr/bin/env python
+#
+# Compresses the image of the test app with compress_ota_image.py for the compressed update cases.
+# Each stream, with a window of 4 KB and of 512 bytes, is written after its length (uint32).
+#
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Unlicense OR CC0-1.0
+import argparse
+import os
+import struct
+import sys
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+import compress_ota_image  # noqa: E402
+
+WINDOW_BITS = (compress_ota_image.DEFAULT_WINDOW_BITS, 9)
+
+
+def main():  # type: () -> None
+    parser = argparse.ArgumentParser(description='Compresses the test app for the compressed update cases')
+    parser.add_argument('image', help='App image to compress')
+    parser.add_argument('--output', '-o', help='Path of the partition image', required=True)
+    args = parser.parse_args()
+
+    with open(args.image, 'rb') as f:
+        image = f.read()
+    with open(args.output, 'wb') as f:
+        for window_bits in WINDOW_BITS:
+            stream = compress_ota_image.compress_image(image, window_bits)
+            f.write(struct.pack('<I', len(stream)) + stream)
+
+
+if __name__ == '__main__':
+    main()
@@ -0,0 +1,14 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include "unity.h"
+#include "esp_event.h"
+
+void app_main(void)
+{
+    // esp_https_ota posts its events to the default loop
+    ESP_ERROR_CHECK(esp_event_loop_create_default());
+    unity_run_menu();
+}
@@ -0,0 +1,158 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_ota_ops.h"
+#include "esp_https_ota.h"
+#include "test_https_ota_server.h"
+
+/* Partition holding the streams written by gen_compressed_images.py, each after its length */
+#define COMPRESSED_PARTITION_LABEL  "compressed"
+/* Window sizes of the streams, in the order of the partition */
+static const unsigned s_window_sizes[] = { 4096, 512 };
+
+/* Returns the data serving the stream of the running app compressed with the window of the index */
+static test_server_data_t test_compressed_data(int index)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, COMPRESSED_PARTITION_LABEL);
+    TEST_ASSERT_NOT_NULL(partition);
+    test_server_data_t data = {
+        .partition = partition,
+    };
+    for (int i = 0; i <= index; i++) {
+        data.offset += data.len;
+        uint32_t len;
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_read(partition, data.offset, &len, sizeof(len)));
+        TEST_ASSERT_LESS_THAN(partition->size, len);
+        data.offset += sizeof(len);
+        data.len = len;
+    }
+    return data;
+}
+
+/* Downloads the data as a compressed image, returns the first error of the update */
+static esp_err_t test_compressed_update(const test_server_data_t *data, int pipeline_depth)
+{
+    test_server_start(data);
+    esp_http_client_config_t http_config = {
+        .url = TEST_SERVER_URL,
+        .timeout_ms = 5000,
+        .buffer_size = 4096,
+    };
+    esp_https_ota_config_t ota_config = {
+        .http_config = &http_config,
+        .compressed_image = true,
+        .pipeline_depth = pipeline_depth,
+    };
+    esp_https_ota_handle_t handle = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_begin(&ota_config, &handle));
+    esp_err_t err;
+    while ((err = esp_https_ota_perform(handle)) == ESP_ERR_HTTPS_OTA_IN_PROGRESS) {
+    }
+    if (err == ESP_OK) {
+        TEST_ASSERT_EQUAL(data->len, esp_https_ota_get_image_len_read(handle));
+        err = esp_https_ota_finish(handle);
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_abort(handle));
+    }
+    test_server_stop();
+    return err;
+}
+
+TEST_CASE("compressed update rebuilds the running app", "[compressed]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *update = esp_ota_get_next_update_partition(NULL);
+    uint8_t expected[32];
+    uint8_t written[32];
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(running, expected));
+
+    for (int i = 0; i < sizeof(s_window_sizes) / sizeof(s_window_sizes[0]); i++) {
+        test_server_data_t data = test_compressed_data(i);
+        for (int depth = 1; depth <= 2; depth++) {
+            TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(update, 0, update->erase_size));
+            TEST_ASSERT_EQUAL(ESP_OK, test_compressed_update(&data, depth));
+            TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(update, written));
+            TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, written, sizeof(expected));
+        }
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_ota_set_boot_partition(running));
+}
+
+TEST_CASE("compressed update fails on truncated or corrupt streams", "[compressed]")
+{
+    test_case_uses_tcpip();
+    for (int depth = 1; depth <= 2; depth++) {
+        test_server_data_t data = test_compressed_data(0);
+        const size_t len = data.len;
+
+        // The whole download succeeds, the stream is found incomplete when the update ends
+        data.len = len / 2;
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, test_compressed_update(&data, depth));
+        data.len = len - 1;
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, test_compressed_update(&data, depth));
+
+        // The zlib header, the deflate data and the Adler-32 which ends the stream
+        data.len = len;
+        const size_t corrupt_at[] = { 1, len / 2, len - 1 };
+        for (int i = 0; i < sizeof(corrupt_at) / sizeof(corrupt_at[0]); i++) {
+            data.corrupt_at = corrupt_at[i];
+            TEST_ASSERT_EQUAL(ESP_ERR_OTA_VALIDATE_FAILED, test_compressed_update(&data, depth));
+        }
+
+        // Data after the end of the stream, here the length of the next one
+        data.corrupt_at = 0;
+        data.len = len + sizeof(uint32_t);
+        TEST_ASSERT_EQUAL(ESP_ERR_OTA_VALIDATE_FAILED, test_compressed_update(&data, depth));
+    }
+}
+
+static void bench_update(const char *name, const test_server_data_t *data, bool compressed)
+{
+    test_server_start(data);
+    esp_http_client_config_t http_config = {
+        .url = TEST_SERVER_URL,
+        .timeout_ms = 5000,
+        .buffer_size = 4096,
+    };
+    esp_https_ota_config_t ota_config = {
+        .http_config = &http_config,
+        .compressed_image = compressed,
+    };
+    TEST_ASSERT_EQUAL(ESP_OK, heap_caps_monitor_local_minimum_free_size_start());
+    const size_t free_before = heap_caps_get_free_size(MALLOC_CAP_DEFAULT);
+    int64_t start = esp_timer_get_time();
+    esp_err_t err = esp_https_ota(&ota_config);
+    int64_t elapsed_ms = (esp_timer_get_time() - start) / 1000;
+    const size_t peak = free_before - heap_caps_get_minimum_free_size(MALLOC_CAP_DEFAULT);
+    TEST_ASSERT_EQUAL(ESP_OK, heap_caps_monitor_local_minimum_free_size_stop());
+    test_server_stop();
+    TEST_ASSERT_EQUAL(ESP_OK, err);
+    printf("%-28s %10u %10d %10u\n", name, (unsigned)data->len, (int)elapsed_ms, (unsigned)peak);
+}
+
+TEST_CASE("update time and heap use with and without compression", "[compressed]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const test_server_data_t image = {
+        .partition = running,
+        .len = test_image_len(running),
+    };
+    char name[32];
+    printf("%-28s %10s %10s %10s\n", "Update", "Bytes", "Time (ms)", "Peak heap");
+    bench_update("plain image", &image, false);
+    for (int i = 0; i < sizeof(s_window_sizes) / sizeof(s_window_sizes[0]); i++) {
+        test_server_data_t data = test_compressed_data(i);
+        snprintf(name, sizeof(name), "compressed, %u B window", s_window_sizes[i]);
+        bench_update(name, &data, true);
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_ota_set_boot_partition(running));
+}
@@ -0,0 +1,161 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <string.h>
+#include <stddef.h>
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_ota_ops.h"
+#include "esp_ota_delta.h"
+#include "esp_app_desc.h"
+#include "esp_image_format.h"
+#include "esp_https_ota.h"
+#include "test_https_ota_server.h"
+
+/* Start of the image holding the image header and the app description, which are checked once rebuilt */
+#define TEST_HEADER_LEN     (sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t) + sizeof(esp_app_desc_t))
+
+typedef struct {
+    uint8_t buf[ESP_OTA_DELTA_HEADER_SIZE + TEST_HEADER_LEN + 16];
+    size_t len;
+} test_delta_t;
+
+static void delta_put_u32(test_delta_t *delta, uint32_t value)
+{
+    for (int i = 0; i < 4; i++) {
+        delta->buf[delta->len++] = value >> (8 * i);
+    }
+}
+
+static void delta_put_varint(test_delta_t *delta, uint32_t value)
+{
+    while (value >= 0x80) {
+        delta->buf[delta->len++] = (value & 0x7f) | 0x80;
+        value >>= 7;
+    }
+    delta->buf[delta->len++] = value;
+}
+
+/* Builds the delta rebuilding the running app, with its first prefix_len bytes replaced by prefix */
+static void test_delta_build(test_delta_t *delta, const uint8_t *prefix, size_t prefix_len)
+{
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const uint32_t image_len = test_image_len(running);
+    delta->len = 0;
+    delta_put_u32(delta, ESP_OTA_DELTA_MAGIC);
+    delta_put_u32(delta, ESP_OTA_DELTA_VERSION);
+    delta_put_u32(delta, image_len);
+    delta_put_u32(delta, image_len);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(running, delta->buf + delta->len));
+    delta->len += 32;
+    TEST_ASSERT_EQUAL(ESP_OTA_DELTA_HEADER_SIZE, delta->len);
+    if (prefix_len) {
+        // Insert of the prefix
+        delta_put_varint(delta, prefix_len << 1);
+        memcpy(delta->buf + delta->len, prefix, prefix_len);
+        delta->len += prefix_len;
+    }
+    // Copy of the rest of the image, the distance is zigzag encoded
+    delta_put_varint(delta, ((image_len - prefix_len) << 1) | 1);
+    delta_put_varint(delta, prefix_len << 1);
+}
+
+static esp_err_t test_delta_update(const test_delta_t *delta, int pipeline_depth)
+{
+    test_server_data_t data = {
+        .buf = delta->buf,
+        .len = delta->len,
+    };
+    test_server_start(&data);
+    esp_http_client_config_t http_config = {
+        .url = TEST_SERVER_URL,
+        .timeout_ms = 5000,
+    };
+    esp_https_ota_config_t ota_config = {
+        .http_config = &http_config,
+        .delta_update = true,
+        .pipeline_depth = pipeline_depth,
+    };
+    esp_https_ota_handle_t handle = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_begin(&ota_config, &handle));
+    esp_err_t err;
+    while ((err = esp_https_ota_perform(handle)) == ESP_ERR_HTTPS_OTA_IN_PROGRESS) {
+    }
+    if (err == ESP_OK) {
+        err = esp_https_ota_finish(handle);
+    } else {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_abort(handle));
+    }
+    test_server_stop();
+    return err;
+}
+
+/* Reads the start of the running app, to be altered and inserted by a delta */
+static void test_read_header(uint8_t *header)
+{
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_read(esp_ota_get_running_partition(), 0, header, TEST_HEADER_LEN));
+}
+
+TEST_CASE("delta update rebuilds the running app", "[delta]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *update = esp_ota_get_next_update_partition(NULL);
+    uint8_t header[TEST_HEADER_LEN];
+    test_read_header(header);
+    uint8_t expected[32];
+    uint8_t written[32];
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(running, expected));
+
+    test_delta_t delta;
+    for (int depth = 1; depth <= 2; depth++) {
+        // A single copy, and the same image with its header sent as literal bytes
+        test_delta_build(&delta, NULL, 0);
+        TEST_ASSERT_EQUAL(ESP_OK, test_delta_update(&delta, depth));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(update, written));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, written, sizeof(expected));
+
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(update, 0, update->erase_size));
+        test_delta_build(&delta, header, sizeof(header));
+        TEST_ASSERT_EQUAL(ESP_OK, test_delta_update(&delta, depth));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(update, written));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, written, sizeof(expected));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_ota_set_boot_partition(running));
+}
+
+TEST_CASE("delta update checks the header of the rebuilt image", "[delta]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *update = esp_ota_get_next_update_partition(NULL);
+    uint8_t header[TEST_HEADER_LEN];
+    esp_image_header_t *image_header = (esp_image_header_t *)header;
+    esp_app_desc_t *app_desc = (esp_app_desc_t *)(header + sizeof(esp_image_header_t) + sizeof(esp_image_segment_header_t));
+    uint8_t magic;
+    test_delta_t delta;
+
+    for (int depth = 1; depth <= 2; depth++) {
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_erase_range(update, 0, update->erase_size));
+
+        test_read_header(header);
+        image_header->chip_id = ESP_CHIP_ID_INVALID;
+        test_delta_build(&delta, header, sizeof(header));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_VERSION, test_delta_update(&delta, depth));
+
+        test_read_header(header);
+        app_desc->magic_word = ~ESP_APP_DESC_MAGIC_WORD;
+        test_delta_build(&delta, header, sizeof(header));
+        TEST_ASSERT_EQUAL(ESP_ERR_OTA_VALIDATE_FAILED, test_delta_update(&delta, depth));
+
+        test_read_header(header);
+        image_header->magic = 0;
+        test_delta_build(&delta, header, sizeof(header));
+        TEST_ASSERT_EQUAL(ESP_ERR_OTA_VALIDATE_FAILED, test_delta_update(&delta, depth));
+
+        // The update stops before the first part of the image is written
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_read(update, 0, &magic, sizeof(magic)));
+        TEST_ASSERT_EQUAL_HEX8(0xff, magic);
+    }
+}
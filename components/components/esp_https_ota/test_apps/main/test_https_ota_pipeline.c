@@ -0,0 +1,154 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_timer.h"
+#include "esp_ota_ops.h"
+#include "esp_https_ota.h"
+#include "test_https_ota_server.h"
+
+/* Name of the flash write task of esp_https_ota */
+#define PIPELINE_TASK_NAME  "https_ota_write"
+
+static esp_https_ota_handle_t test_ota_begin(int pipeline_depth, const esp_partition_t *staging)
+{
+    esp_http_client_config_t http_config = {
+        .url = TEST_SERVER_URL,
+        .timeout_ms = 5000,
+        .buffer_size = 4096,
+    };
+    esp_https_ota_config_t ota_config = {
+        .http_config = &http_config,
+        .pipeline_depth = pipeline_depth,
+        .partition.staging = staging,
+    };
+    esp_https_ota_handle_t handle = NULL;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_begin(&ota_config, &handle));
+    return handle;
+}
+
+static esp_err_t test_ota_perform(esp_https_ota_handle_t handle)
+{
+    esp_err_t err;
+    while ((err = esp_https_ota_perform(handle)) == ESP_ERR_HTTPS_OTA_IN_PROGRESS) {
+    }
+    return err;
+}
+
+static bool pipeline_task_running(void)
+{
+    // The task deletes itself once it has signalled the end of the update
+    vTaskDelay(pdMS_TO_TICKS(10));
+    return xTaskGetHandle(PIPELINE_TASK_NAME) != NULL;
+}
+
+TEST_CASE("pipelined download writes the image written without pipeline", "[pipeline]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *update = esp_ota_get_next_update_partition(NULL);
+    TEST_ASSERT_NOT_NULL(update);
+    test_server_data_t data = {
+        .partition = running,
+        .len = test_image_len(running),
+    };
+    test_server_start(&data);
+
+    uint8_t expected[32];
+    uint8_t written[32];
+    TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(running, expected));
+    for (int depth = 1; depth <= 3; depth++) {
+        esp_https_ota_handle_t handle = test_ota_begin(depth, NULL);
+        int64_t start = esp_timer_get_time();
+        TEST_ASSERT_EQUAL(ESP_OK, test_ota_perform(handle));
+        int64_t elapsed_ms = (esp_timer_get_time() - start) / 1000;
+        // All the data is in flash, the task only stops with the update
+        TEST_ASSERT_EQUAL(depth > 1, pipeline_task_running());
+        TEST_ASSERT_TRUE(esp_https_ota_is_complete_data_received(handle));
+        TEST_ASSERT_EQUAL(data.len, esp_https_ota_get_image_len_read(handle));
+        TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_finish(handle));
+        TEST_ASSERT_FALSE(pipeline_task_running());
+        printf("Pipeline depth %d: %u bytes in %d ms\n", depth, (unsigned)data.len, (int)elapsed_ms);
+
+        TEST_ASSERT_EQUAL(ESP_OK, esp_partition_get_sha256(update, written));
+        TEST_ASSERT_EQUAL_HEX8_ARRAY(expected, written, sizeof(expected));
+    }
+
+    test_server_stop();
+    TEST_ASSERT_EQUAL(ESP_OK, esp_ota_set_boot_partition(running));
+}
+
+TEST_CASE("pipelined download fails when the connection is closed early", "[pipeline]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    test_server_data_t data = {
+        .partition = running,
+        .len = test_image_len(running),
+    };
+    data.close_after = data.len / 2;
+    test_server_start(&data);
+
+    esp_https_ota_handle_t handle = test_ota_begin(3, NULL);
+    TEST_ASSERT_EQUAL(ESP_FAIL, test_ota_perform(handle));
+    TEST_ASSERT_FALSE(esp_https_ota_is_complete_data_received(handle));
+    TEST_ASSERT_EQUAL(data.close_after, esp_https_ota_get_image_len_read(handle));
+    // The chunks still waiting to be written are dropped with the update
+    TEST_ASSERT_TRUE(pipeline_task_running());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_abort(handle));
+    TEST_ASSERT_FALSE(pipeline_task_running());
+
+    test_server_stop();
+}
+
+TEST_CASE("pipelined download stops at the first flash write error", "[pipeline]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    const esp_partition_t *small = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_OTA_1, NULL);
+    TEST_ASSERT_NOT_NULL(small);
+    test_server_data_t data = {
+        .partition = running,
+        .len = test_image_len(running),
+    };
+    TEST_ASSERT_GREATER_THAN(small->size, data.len);
+    test_server_start(&data);
+
+    // The image does not fit: esp_ota_write() fails in the flash write task once the partition is full
+    esp_https_ota_handle_t handle = test_ota_begin(3, small);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, test_ota_perform(handle));
+    // The download stops with it, and the error is returned again until the update ends
+    TEST_ASSERT_LESS_THAN(data.len, esp_https_ota_get_image_len_read(handle));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_https_ota_perform(handle));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_https_ota_finish(handle));
+    TEST_ASSERT_FALSE(pipeline_task_running());
+
+    test_server_stop();
+}
+
+TEST_CASE("pipelined download can be aborted while chunks wait to be written", "[pipeline]")
+{
+    test_case_uses_tcpip();
+    const esp_partition_t *running = esp_ota_get_running_partition();
+    test_server_data_t data = {
+        .partition = running,
+        .len = test_image_len(running),
+    };
+    test_server_start(&data);
+
+    esp_https_ota_handle_t handle = test_ota_begin(3, NULL);
+    for (int i = 0; i < 8; i++) {
+        TEST_ASSERT_EQUAL(ESP_ERR_HTTPS_OTA_IN_PROGRESS, esp_https_ota_perform(handle));
+    }
+    TEST_ASSERT_TRUE(pipeline_task_running());
+    TEST_ASSERT_EQUAL(ESP_OK, esp_https_ota_abort(handle));
+    TEST_ASSERT_FALSE(pipeline_task_running());
+
+    test_server_stop();
+}
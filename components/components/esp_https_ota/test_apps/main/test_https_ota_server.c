@@ -0,0 +1,152 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#include <stdio.h>
+#include <string.h>
+#include <sys/param.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "lwip/sockets.h"
+#include "unity.h"
+#include "test_utils.h"
+#include "esp_image_format.h"
+#include "test_https_ota_server.h"
+
+#define SERVER_TASK_PRIORITY    (UNITY_FREERTOS_PRIORITY + 1)
+#define SERVER_POLL_MS          100
+
+static struct {
+    test_server_data_t data;
+    int listen_sock;
+    volatile bool stop;
+    SemaphoreHandle_t stopped;
+} s_server;
+
+/* Reads the request up to the end of its headers, the request itself is not looked at */
+static bool server_read_request(int sock)
+{
+    char buf[256];
+    size_t len = 0;
+    while (len < sizeof(buf) - 1) {
+        int ret = recv(sock, buf + len, sizeof(buf) - 1 - len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        len += ret;
+        buf[len] = '\0';
+        if (strstr(buf, "\r\n\r\n")) {
+            return true;
+        }
+        // Only the end of the headers is kept
+        if (len > 3) {
+            memmove(buf, buf + len - 3, 3);
+            len = 3;
+        }
+    }
+    return false;
+}
+
+static bool server_send(int sock, const void *data, size_t len)
+{
+    while (len > 0) {
+        int ret = send(sock, data, len, 0);
+        if (ret <= 0) {
+            return false;
+        }
+        data = (const char *)data + ret;
+        len -= ret;
+    }
+    return true;
+}
+
+static void server_respond(int sock)
+{
+    static char buf[1024];
+    const test_server_data_t *data = &s_server.data;
+    int len = snprintf(buf, sizeof(buf), "HTTP/1.1 200 OK\r\nContent-Type: application/octet-stream\r\n"
+                       "Content-Length: %u\r\nConnection: close\r\n\r\n", (unsigned)data->len);
+    if (!server_send(sock, buf, len)) {
+        return;
+    }
+    const size_t end = data->close_after ? data->close_after : data->len;
+    for (size_t sent = 0; sent < end;) {
+        size_t chunk = MIN(sizeof(buf), end - sent);
+        if (data->buf) {
+            memcpy(buf, (const char *)data->buf + data->offset + sent, chunk);
+        } else if (esp_partition_read(data->partition, data->offset + sent, buf, chunk) != ESP_OK) {
+            return;
+        }
+        if (data->corrupt_at && data->corrupt_at >= sent && data->corrupt_at < sent + chunk) {
+            buf[data->corrupt_at - sent] ^= 0xff;
+        }
+        if (!server_send(sock, buf, chunk)) {
+            return;
+        }
+        sent += chunk;
+    }
+}
+
+static void server_task(void *arg)
+{
+    while (!s_server.stop) {
+        fd_set readset;
+        FD_ZERO(&readset);
+        FD_SET(s_server.listen_sock, &readset);
+        struct timeval timeout = { .tv_usec = SERVER_POLL_MS * 1000 };
+        if (select(s_server.listen_sock + 1, &readset, NULL, NULL, &timeout) <= 0) {
+            continue;
+        }
+        int sock = accept(s_server.listen_sock, NULL, NULL);
+        if (sock < 0) {
+            continue;
+        }
+        if (server_read_request(sock)) {
+            server_respond(sock);
+        }
+        close(sock);
+    }
+    xSemaphoreGive(s_server.stopped);
+    vTaskDelete(NULL);
+}
+
+void test_server_start(const test_server_data_t *data)
+{
+    s_server.data = *data;
+    s_server.stop = false;
+    s_server.stopped = xSemaphoreCreateBinary();
+    TEST_ASSERT_NOT_NULL(s_server.stopped);
+    s_server.listen_sock = socket(AF_INET, SOCK_STREAM, IPPROTO_IP);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, s_server.listen_sock);
+    int opt = 1;
+    setsockopt(s_server.listen_sock, SOL_SOCKET, SO_REUSEADDR, &opt, sizeof(opt));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_SERVER_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, bind(s_server.listen_sock, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(s_server.listen_sock, 1));
+    TEST_ASSERT_EQUAL(pdPASS, xTaskCreate(server_task, "ota_server", 4096, NULL, SERVER_TASK_PRIORITY, NULL));
+}
+
+void test_server_stop(void)
+{
+    s_server.stop = true;
+    xSemaphoreTake(s_server.stopped, portMAX_DELAY);
+    vSemaphoreDelete(s_server.stopped);
+    close(s_server.listen_sock);
+}
+
+size_t test_image_len(const esp_partition_t *partition)
+{
+    const esp_partition_pos_t pos = {
+        .offset = partition->address,
+        .size = partition->size,
+    };
+    esp_image_metadata_t metadata;
+    TEST_ASSERT_EQUAL(ESP_OK, esp_image_get_metadata(&pos, &metadata));
+    return metadata.image_len;
+}
@@ -0,0 +1,41 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+#pragma once
+
+#include <stddef.h>
+#include "esp_partition.h"
+
+#define TEST_SERVER_PORT    8070
+#define TEST_SERVER_URL     "http://127.0.0.1:8070/image.bin"
+
+/**
+ * @brief Data served by the HTTP server stand-in, read from a partition or from RAM
+ */
+typedef struct {
+    const void *buf;                    /*!< Data in RAM, or NULL to read it from the partition */
+    const esp_partition_t *partition;   /*!< Partition the data is read from */
+    size_t offset;                      /*!< Offset of the data in the partition */
+    size_t len;                         /*!< Length of the data, sent as the Content-Length */
+    size_t close_after;                 /*!< The connection is closed after this many bytes of the data, 0 to send all of it */
+    size_t corrupt_at;                  /*!< Offset in the data of a byte sent inverted, 0 to send the data unaltered */
+} test_server_data_t;
+
+/**
+ * @brief Starts a task which answers every request on TEST_SERVER_PORT of the loopback interface with the data
+ *
+ * @param data  Data to serve, used until test_server_stop()
+ */
+void test_server_start(const test_server_data_t *data);
+
+/**
+ * @brief Stops the task started by test_server_start()
+ */
+void test_server_stop(void);
+
+/**
+ * @brief Returns the length of the app image in a partition
+ */
+size_t test_image_len(const esp_partition_t *partition);
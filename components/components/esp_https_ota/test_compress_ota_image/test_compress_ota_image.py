@@ -0,0 +1,67 @@
+#!/usr/bin/env python
+# SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+# SPDX-License-Identifier: Apache-2.0
+import os
+import random
+import shutil
+import subprocess
+import sys
+import tempfile
+import unittest
+import zlib
+
+sys.path.append(os.path.join(os.path.dirname(__file__), '..'))
+try:
+    import compress_ota_image
+except ImportError:
+    raise
+
+
+class CompressOtaImageTest(unittest.TestCase):
+    def setUp(self):  # type: () -> None
+        rand = random.Random(0)
+        # Compressible like an app image: repeated code sequences among random data
+        words = [bytes(rand.getrandbits(8) for _ in range(4)) for _ in range(64)]
+        self.image = b''.join(rand.choice(words) for _ in range(16 * 1024)) + bytes(rand.getrandbits(8) for _ in range(4096))
+
+    def test_round_trip(self):  # type: () -> None
+        for window_bits in range(9, 16):
+            stream = compress_ota_image.compress_image(self.image, window_bits)
+            self.assertEqual(zlib.decompress(stream), self.image)
+            self.assertLess(len(stream), len(self.image))
+            # The device sizes its window from CINFO, the high nibble of the first byte
+            self.assertEqual(stream[0] >> 4, window_bits - 8)
+            self.assertEqual(stream[0] & 0xf, 8)
+
+    def test_corrupt_streams(self):  # type: () -> None
+        stream = compress_ota_image.compress_image(self.image, compress_ota_image.DEFAULT_WINDOW_BITS)
+        for offset in (1, len(stream) // 2, len(stream) - 1):
+            corrupt = bytearray(stream)
+            corrupt[offset] ^= 0xff
+            with self.assertRaises(zlib.error):
+                zlib.decompress(bytes(corrupt))
+        with self.assertRaises(zlib.error):
+            zlib.decompress(stream[:-1])
+
+    def test_command_line(self):  # type: () -> None
+        tmp = tempfile.mkdtemp()
+        self.addCleanup(shutil.rmtree, tmp)
+        image_path = os.path.join(tmp, 'app.bin')
+        output_path = os.path.join(tmp, 'app.bin.zlib')
+        with open(image_path, 'wb') as f:
+            f.write(self.image)
+        script = os.path.join(os.path.dirname(__file__), '..', 'compress_ota_image.py')
+        args = [sys.executable, script, '--quiet', image_path, '-o', output_path, '--window-bits', '10']
+        self.assertEqual(subprocess.call(args), 0)
+        with open(output_path, 'rb') as f:
+            stream = f.read()
+        self.assertEqual(stream[0] >> 4, 2)
+        self.assertEqual(zlib.decompress(stream), self.image)
+
+        # The device allocates at most a 32 KB window
+        with open(os.devnull, 'w') as devnull:
+            self.assertNotEqual(subprocess.call(args[:-1] + ['16'], stderr=devnull), 0)
+
+
+if __name__ == '__main__':
+    unittest.main()
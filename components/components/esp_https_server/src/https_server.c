@@ -250,7 +250,8 @@ static void free_secure_context(void *ctx)
     if (cfg->serverkey_buf) {
         free((void *)cfg->serverkey_buf);
     }
-    esp_tls_cfg_server_session_tickets_free(cfg);
+    esp_tls_cfg_server_session_tickets_deinit(cfg);
+    esp_tls_cfg_server_session_cache_free(cfg);
     free(cfg);
     free(ssl_ctx);
 }
@@ -275,6 +276,14 @@ static esp_err_t create_secure_context(const struct httpd_ssl_config *config, ht
         }
     }
 
+#if defined(CONFIG_ESP_TLS_SERVER_SESSION_CACHE)
+    ret = esp_tls_cfg_server_session_cache_init(cfg);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to init session cache. error: %s", esp_err_to_name(ret));
+        goto exit;
+    }
+#endif
+
     cfg->userdata = config->ssl_userdata;
     cfg->alpn_protos = config->alpn_protos;
     cfg->tls_handshake_timeout_ms = config->tls_handshake_timeout_ms;
@@ -376,6 +385,8 @@ exit:
     if (cfg) {
         free((void *) cfg->servercert_buf);
         free((void *) cfg->cacert_buf);
+        esp_tls_cfg_server_session_tickets_deinit(cfg);
+        esp_tls_cfg_server_session_cache_free(cfg);
     }
     free(cfg);
     return ret;
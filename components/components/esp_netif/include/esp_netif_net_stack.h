@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -80,6 +80,20 @@ esp_err_t esp_netif_transmit(esp_netif_t *esp_netif, void* data, size_t len);
   */
 esp_err_t esp_netif_transmit_wrap(esp_netif_t *esp_netif, void *data, size_t len, void *netstack_buf);
 
+/**
+  * @brief  Outputs several packets from the TCP/IP stack to the media to be transmitted
+  *
+  * This function gets called from network stack to output packets to IO driver,
+  * if the IO driver provides a transmit list function.
+  *
+  * @param[in]  esp_netif Handle to esp-netif instance
+  * @param[in]  frames Frames to be transmitted
+  * @param[in]  count Number of frames
+  *
+  * @return   ESP_OK on success, an error passed from the I/O driver otherwise
+  */
+esp_err_t esp_netif_transmit_list(esp_netif_t *esp_netif, esp_netif_tx_frame_t *frames, size_t count);
+
 /**
   * @brief  Free the rx buffer allocated by the media driver
   *
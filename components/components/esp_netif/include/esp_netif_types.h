@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -236,6 +236,14 @@ typedef struct esp_netif_driver_base_s {
     esp_netif_t *netif; /*!< netif handle */
 } esp_netif_driver_base_t;
 
+/**
+ * @brief  Frame passed to the transmit list function of an IO driver
+ */
+typedef struct esp_netif_tx_frame {
+    void *buffer;   /*!< data of the frame */
+    size_t len;     /*!< length of the frame */
+} esp_netif_tx_frame_t;
+
 /**
  * @brief  Specific IO driver configuration
  */
@@ -245,6 +253,7 @@ struct esp_netif_driver_ifconfig {
     esp_err_t (*transmit_wrap)(void *h, void *buffer, size_t len, void *netstack_buffer); /*!< transmit wrap function pointer */
     void (*driver_free_rx_buffer)(void *h, void* buffer); /*!< free rx buffer function pointer */
     esp_err_t (*driver_set_mac_filter)(void *h, const uint8_t *mac, size_t mac_len, bool add); /*!< set mac filter function pointer */
+    esp_err_t (*transmit_list)(void *h, esp_netif_tx_frame_t *frames, size_t count); /*!< optional function transmitting several frames at once, the frames are copied or sent before it returns */
 };
 
 typedef struct esp_netif_driver_ifconfig esp_netif_driver_ifconfig_t;
@@ -12,6 +12,7 @@
 #include "esp_compiler.h"
 #include "esp_check.h"
 #include "esp_netif_lwip_internal.h"
+#include "esp_netif_lwip_batch.h"
 #include "lwip/esp_netif_net_stack.h"
 
 
@@ -61,6 +62,12 @@
 
 #define ESP_NETIF_HOSTNAME_MAX_SIZE    32
 
+#if CONFIG_ESP_NETIF_RX_BATCHING
+#define ESP_NETIF_LWIP_INPUT_FN esp_netif_lwip_rx_batch_input
+#else
+#define ESP_NETIF_LWIP_INPUT_FN tcpip_input
+#endif
+
 #define DHCP_CB_CHANGE (LWIP_NSC_IPV4_SETTINGS_CHANGED | LWIP_NSC_IPV4_ADDRESS_CHANGED | LWIP_NSC_IPV4_GATEWAY_CHANGED | LWIP_NSC_IPV4_NETMASK_CHANGED)
 
 /**
@@ -746,6 +753,9 @@ static esp_err_t esp_netif_init_configuration(esp_netif_t *esp_netif, const esp_
         if (esp_netif_driver_config->driver_free_rx_buffer) {
             esp_netif->driver_free_rx_buffer = esp_netif_driver_config->driver_free_rx_buffer;
         }
+        if (esp_netif_driver_config->transmit_list) {
+            esp_netif->driver_transmit_list = esp_netif_driver_config->transmit_list;
+        }
 #if (LWIP_IPV4 && LWIP_IGMP) || (LWIP_IPV6 && LWIP_IPV6_MLD)
         if (esp_netif_driver_config->driver_set_mac_filter) {
             esp_netif->driver_set_mac_filter = esp_netif_driver_config->driver_set_mac_filter;
@@ -912,6 +922,7 @@ esp_netif_t *esp_netif_find_if(esp_netif_find_predicate_t fn, void *ctx)
 
 static void esp_netif_lwip_remove(esp_netif_t *esp_netif)
 {
+    esp_netif_lwip_batch_remove(esp_netif);
     if (esp_netif->lwip_netif) {
         if (netif_is_up(esp_netif->lwip_netif)) {
             netif_set_down(esp_netif->lwip_netif);
@@ -981,7 +992,7 @@ static esp_err_t esp_netif_lwip_add(esp_netif_t *esp_netif)
                             (struct ip4_addr*)&esp_netif->ip_info->netmask,
                             (struct ip4_addr*)&esp_netif->ip_info->gw,
 #endif
-                            esp_netif, esp_netif->lwip_init_fn, tcpip_input)) {
+                            esp_netif, esp_netif->lwip_init_fn, ESP_NETIF_LWIP_INPUT_FN)) {
             esp_netif_lwip_remove(esp_netif);
             return ESP_ERR_ESP_NETIF_IF_NOT_READY;
         }
@@ -1066,6 +1077,7 @@ esp_err_t esp_netif_set_driver_config(esp_netif_t *esp_netif,
     esp_netif->driver_transmit = driver_config->transmit;
     esp_netif->driver_transmit_wrap = driver_config->transmit_wrap;
     esp_netif->driver_free_rx_buffer = driver_config->driver_free_rx_buffer;
+    esp_netif->driver_transmit_list = driver_config->transmit_list;
 #if (LWIP_IPV4 && LWIP_IGMP) || (LWIP_IPV6 && LWIP_IPV6_MLD)
     esp_netif->driver_set_mac_filter = driver_config->driver_set_mac_filter;
 #endif /* LWIP_IPV4 && LWIP_IGMP */
@@ -1385,6 +1397,23 @@ esp_err_t esp_netif_transmit_wrap(esp_netif_t *esp_netif, void *data, size_t len
     return (esp_netif->driver_transmit_wrap)(esp_netif->driver_handle, data, len, pbuf);
 }
 
+esp_err_t esp_netif_transmit_list(esp_netif_t *esp_netif, esp_netif_tx_frame_t *frames, size_t count)
+{
+#ifdef CONFIG_ESP_NETIF_REPORT_DATA_TRAFFIC
+    if (unlikely(esp_netif->tx_rx_events_enabled)) {
+        for (size_t i = 0; i < count; i++) {
+            ip_event_tx_rx_t evt = {
+                .esp_netif = esp_netif,
+                .len = frames[i].len,
+                .dir = ESP_NETIF_TX,
+            };
+            esp_event_post(IP_EVENT, IP_EVENT_TX_RX, &evt, sizeof(evt), 0);
+        }
+    }
+#endif
+    return (esp_netif->driver_transmit_list)(esp_netif->driver_handle, frames, count);
+}
+
 esp_err_t esp_netif_receive(esp_netif_t *esp_netif, void *buffer, size_t len, void *eb)
 {
 #ifdef CONFIG_ESP_NETIF_REPORT_DATA_TRAFFIC
@@ -0,0 +1,245 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include "lwip/opt.h"
+#include "lwip/sys.h"
+#include "lwip/tcpip.h"
+#include "lwip/ip.h"
+#include "lwip/stats.h"
+#include "netif/ethernet.h"
+
+#include "esp_netif.h"
+#include "esp_netif_net_stack.h"
+#include "esp_netif_lwip_internal.h"
+#include "esp_netif_lwip_batch.h"
+
+#if CONFIG_ESP_NETIF_RX_BATCHING
+typedef struct rx_batch_pkt {
+    struct pbuf *p;
+    struct netif *netif;
+} rx_batch_pkt_t;
+
+/* Packets received since the TCP/IP task processed the previous batch.
+ * Protected by SYS_ARCH_PROTECT, as the packets are added by the driver tasks */
+static struct {
+    rx_batch_pkt_t pkts[CONFIG_ESP_NETIF_RX_BATCH_SIZE];
+    uint8_t len;
+    bool scheduled;     // a message to process the batch is in the TCP/IP task mailbox
+} s_rx_batch;
+
+static void rx_batch_input(struct pbuf *p, struct netif *netif)
+{
+    err_t err;
+#if LWIP_ETHERNET
+    if (netif->flags & (NETIF_FLAG_ETHARP | NETIF_FLAG_ETHERNET)) {
+        err = ethernet_input(p, netif);
+    } else
+#endif /* LWIP_ETHERNET */
+    {
+        err = ip_input(p, netif);
+    }
+    if (err != ERR_OK) {
+        pbuf_free(p);
+    }
+}
+
+/* Runs in the TCP/IP task, which holds the core lock for the whole batch */
+static void rx_batch_process(void *ctx)
+{
+    rx_batch_pkt_t pkts[CONFIG_ESP_NETIF_RX_BATCH_SIZE];
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    uint8_t len = s_rx_batch.len;
+    memcpy(pkts, s_rx_batch.pkts, len * sizeof(pkts[0]));
+    s_rx_batch.len = 0;
+    s_rx_batch.scheduled = false;
+    SYS_ARCH_UNPROTECT(lev);
+
+    for (uint8_t i = 0; i < len; i++) {
+        rx_batch_input(pkts[i].p, pkts[i].netif);
+    }
+}
+
+err_t esp_netif_lwip_rx_batch_input(struct pbuf *p, struct netif *netif)
+{
+    bool schedule = false;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    if (s_rx_batch.len == CONFIG_ESP_NETIF_RX_BATCH_SIZE) {
+        SYS_ARCH_UNPROTECT(lev);
+        return ERR_MEM;
+    }
+    s_rx_batch.pkts[s_rx_batch.len].p = p;
+    s_rx_batch.pkts[s_rx_batch.len].netif = netif;
+    s_rx_batch.len++;
+    if (!s_rx_batch.scheduled) {
+        s_rx_batch.scheduled = true;
+        schedule = true;
+    }
+    SYS_ARCH_UNPROTECT(lev);
+
+    if (!schedule || tcpip_try_callback(rx_batch_process, NULL) == ERR_OK) {
+        return ERR_OK;
+    }
+
+    /* The mailbox is full: drop the packet being input, as tcpip_input() would, it is freed
+     * by the caller. The packets before it stay in the batch, scheduled with the next packet */
+    SYS_ARCH_PROTECT(lev);
+    for (uint8_t i = 0; i < s_rx_batch.len; i++) {
+        if (s_rx_batch.pkts[i].p == p) {
+            s_rx_batch.len--;
+            memmove(&s_rx_batch.pkts[i], &s_rx_batch.pkts[i + 1], (s_rx_batch.len - i) * sizeof(s_rx_batch.pkts[0]));
+            break;
+        }
+    }
+    s_rx_batch.scheduled = false;
+    SYS_ARCH_UNPROTECT(lev);
+    return ERR_MEM;
+}
+
+static void rx_batch_remove(struct netif *netif)
+{
+    rx_batch_pkt_t removed[CONFIG_ESP_NETIF_RX_BATCH_SIZE];
+    uint8_t nr_removed = 0;
+    uint8_t len = 0;
+    SYS_ARCH_DECL_PROTECT(lev);
+
+    SYS_ARCH_PROTECT(lev);
+    for (uint8_t i = 0; i < s_rx_batch.len; i++) {
+        if (s_rx_batch.pkts[i].netif == netif) {
+            removed[nr_removed++] = s_rx_batch.pkts[i];
+        } else {
+            s_rx_batch.pkts[len++] = s_rx_batch.pkts[i];
+        }
+    }
+    s_rx_batch.len = len;
+    SYS_ARCH_UNPROTECT(lev);
+    for (uint8_t i = 0; i < nr_removed; i++) {
+        pbuf_free(removed[i].p);
+    }
+}
+#endif /* CONFIG_ESP_NETIF_RX_BATCHING */
+
+#if CONFIG_ESP_NETIF_TX_BATCHING
+/* The TX batches are only used with the core lock held (in the TCP/IP task or by
+ * a task which locked the core), so they don't need another protection */
+static esp_netif_t *s_tx_pending;       // netifs with queued frames
+static bool s_tx_flush_scheduled;       // a message to flush them is in the TCP/IP task mailbox
+
+static void tx_batch_unlink(esp_netif_t *esp_netif)
+{
+    esp_netif_t **it = &s_tx_pending;
+    while (*it) {
+        if (*it == esp_netif) {
+            *it = esp_netif->tx_batch_next;
+            break;
+        }
+        it = &(*it)->tx_batch_next;
+    }
+    esp_netif->tx_batch_next = NULL;
+}
+
+static void tx_batch_transmit(esp_netif_t *esp_netif)
+{
+    esp_netif_tx_frame_t frames[CONFIG_ESP_NETIF_TX_BATCH_SIZE];
+    uint8_t len = esp_netif->tx_batch_len;
+
+    for (uint8_t i = 0; i < len; i++) {
+        frames[i].buffer = esp_netif->tx_batch[i]->payload;
+        frames[i].len = esp_netif->tx_batch[i]->len;
+    }
+    esp_netif->tx_batch_len = 0;
+    /* As with drivers which queue the frames, lwIP already considers them sent */
+    bool dropped = esp_netif_transmit_list(esp_netif, frames, len) != ESP_OK;
+    if (dropped) {
+        LWIP_DEBUGF(NETIF_DEBUG, ("tx_batch_transmit: driver failed to transmit %d frames\n", len));
+    }
+    for (uint8_t i = 0; i < len; i++) {
+        if (dropped) {
+            LINK_STATS_INC(link.drop);
+        }
+        pbuf_free(esp_netif->tx_batch[i]);
+    }
+}
+
+static void tx_batch_flush(void *ctx)
+{
+    s_tx_flush_scheduled = false;
+    while (s_tx_pending) {
+        esp_netif_t *esp_netif = s_tx_pending;
+        s_tx_pending = esp_netif->tx_batch_next;
+        esp_netif->tx_batch_next = NULL;
+        tx_batch_transmit(esp_netif);
+    }
+}
+
+bool esp_netif_lwip_tx_batch_enabled(esp_netif_t *esp_netif)
+{
+    return esp_netif->driver_transmit_list != NULL;
+}
+
+err_t esp_netif_lwip_tx_batch_output(esp_netif_t *esp_netif, struct pbuf *p)
+{
+    struct pbuf *q = p;
+    if (p->next == NULL && !PBUF_NEEDS_COPY(p)) {
+        /* Keep the frame until it is transmitted. lwIP does not retransmit a TCP
+         * segment while its pbuf is referenced, see tcp_output_segment_busy() */
+        pbuf_ref(p);
+    } else {
+        /* Chained frames are sent as one buffer, and the data of volatile frames
+         * (PBUF_REF) may be reused by the caller when this function returns */
+        q = pbuf_clone(PBUF_RAW_TX, PBUF_RAM, p);
+        if (q == NULL) {
+            return ERR_MEM;
+        }
+    }
+
+    if (esp_netif->tx_batch_len == 0) {
+        esp_netif->tx_batch_next = s_tx_pending;
+        s_tx_pending = esp_netif;
+    }
+    esp_netif->tx_batch[esp_netif->tx_batch_len++] = q;
+
+    if (esp_netif->tx_batch_len == CONFIG_ESP_NETIF_TX_BATCH_SIZE) {
+        tx_batch_unlink(esp_netif);
+        tx_batch_transmit(esp_netif);
+    } else if (!s_tx_flush_scheduled) {
+        if (tcpip_try_callback(tx_batch_flush, NULL) == ERR_OK) {
+            s_tx_flush_scheduled = true;
+        } else {
+            /* The mailbox is full: don't keep the frames waiting for it */
+            tx_batch_flush(NULL);
+        }
+    }
+    return ERR_OK;
+}
+
+static void tx_batch_remove(esp_netif_t *esp_netif)
+{
+    if (esp_netif->tx_batch_len) {
+        tx_batch_unlink(esp_netif);
+        for (uint8_t i = 0; i < esp_netif->tx_batch_len; i++) {
+            pbuf_free(esp_netif->tx_batch[i]);
+        }
+        esp_netif->tx_batch_len = 0;
+    }
+}
+#endif /* CONFIG_ESP_NETIF_TX_BATCHING */
+
+void esp_netif_lwip_batch_remove(esp_netif_t *esp_netif)
+{
+#if CONFIG_ESP_NETIF_RX_BATCHING
+    if (esp_netif->lwip_netif) {
+        rx_batch_remove(esp_netif->lwip_netif);
+    }
+#endif
+#if CONFIG_ESP_NETIF_TX_BATCHING
+    tx_batch_remove(esp_netif);
+#endif
+}
@@ -0,0 +1,68 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include "esp_netif.h"
+#include "lwip/netif.h"
+#include "lwip/pbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#if CONFIG_ESP_NETIF_RX_BATCHING
+/**
+ * @brief  Input function of the lwIP netifs, used instead of tcpip_input()
+ *
+ * Queues the packet and posts one message to the TCP/IP task for all the packets
+ * queued until the task processes them.
+ *
+ * @param[in]  p     Received packet
+ * @param[in]  netif lwIP netif which received the packet
+ *
+ * @return ERR_OK if the packet was queued, ERR_MEM otherwise (the caller frees the packet)
+ */
+err_t esp_netif_lwip_rx_batch_input(struct pbuf *p, struct netif *netif);
+#endif
+
+#if CONFIG_ESP_NETIF_TX_BATCHING
+/**
+ * @brief  Checks if the frames of a netif are output in batches,
+ * i.e. if its I/O driver provides a transmit list function
+ *
+ * @param[in]  esp_netif Handle to esp-netif instance
+ *
+ * @return true if the frames are output with esp_netif_lwip_tx_batch_output()
+ */
+bool esp_netif_lwip_tx_batch_enabled(esp_netif_t *esp_netif);
+
+/**
+ * @brief  Outputs a frame through the transmit list function of the I/O driver
+ *
+ * The frame is queued and passed to the driver with the other frames output
+ * while the TCP/IP stack processes the current message.
+ * This needs to be called within lwIP context (or with the core lock held)
+ *
+ * @param[in]  esp_netif Handle to esp-netif instance, whose driver provides transmit_list
+ * @param[in]  p         Frame to transmit
+ *
+ * @return ERR_OK if the frame was queued or transmitted, ERR_MEM or ERR_IF otherwise
+ */
+err_t esp_netif_lwip_tx_batch_output(esp_netif_t *esp_netif, struct pbuf *p);
+#endif
+
+/**
+ * @brief  Drops the received packets and the frames to transmit queued for a netif
+ * This needs to be called within lwIP context, before the netif is removed
+ *
+ * @param[in]  esp_netif Handle to esp-netif instance
+ */
+void esp_netif_lwip_batch_remove(esp_netif_t *esp_netif);
+
+#ifdef __cplusplus
+}
+#endif
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -90,6 +90,13 @@ struct esp_netif_obj {
     esp_err_t (*driver_transmit_wrap)(void *h, void *buffer, size_t len, void *pbuf);
     void (*driver_free_rx_buffer)(void *h, void* buffer);
     esp_err_t (*driver_set_mac_filter)(void *h, const uint8_t *mac, size_t mac_len, bool add);
+    esp_err_t (*driver_transmit_list)(void *h, esp_netif_tx_frame_t *frames, size_t count);
+#if CONFIG_ESP_NETIF_TX_BATCHING
+    // frames output by lwIP, waiting to be passed to driver_transmit_list
+    struct pbuf *tx_batch[CONFIG_ESP_NETIF_TX_BATCH_SIZE];
+    uint8_t tx_batch_len;
+    esp_netif_t *tx_batch_next;
+#endif
 
     // dhcp related
     esp_netif_dhcp_status_t dhcpc_status;
@@ -3,7 +3,7 @@
  *
  * SPDX-License-Identifier: BSD-3-Clause
  *
- * SPDX-FileContributor: 2015-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileContributor: 2015-2025 Espressif Systems (Shanghai) CO LTD
  */
 /**
  * @file
@@ -23,6 +23,7 @@
 #include "esp_netif_net_stack.h"
 #include "lwip/esp_netif_net_stack.h"
 #include "lwip/esp_pbuf_ref.h"
+#include "esp_netif_lwip_batch.h"
 
 /* Define those to better describe your network interface. */
 #define IFNAME0 'e'
@@ -80,6 +81,11 @@ static err_t ethernet_low_level_output(struct netif *netif, struct pbuf *p)
         return ERR_IF;
     }
 
+#if CONFIG_ESP_NETIF_TX_BATCHING
+    if (esp_netif_lwip_tx_batch_enabled(esp_netif)) {
+        return esp_netif_lwip_tx_batch_output(esp_netif, p);
+    }
+#endif
     if (q->next == NULL) {
         ret = esp_netif_transmit(esp_netif, q->payload, q->len);
     } else {
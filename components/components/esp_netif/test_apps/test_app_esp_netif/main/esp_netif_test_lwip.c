@@ -1,10 +1,11 @@
 /*
- * SPDX-FileCopyrightText: 2022-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2022-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Unlicense OR CC0-1.0
  */
 #include <stdio.h>
 #include <string.h>
+#include <inttypes.h>
 #include "unity.h"
 #include "unity_fixture.h"
 #include "esp_netif.h"
@@ -16,7 +17,11 @@
 #include "sdkconfig.h"
 #include "test_utils.h"
 #include "memory_checks.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "lwip/netif.h"
+#include "lwip/sockets.h"
 #include "esp_netif_test.h"
 
 TEST_GROUP(esp_netif);
@@ -504,6 +509,190 @@ TEST(esp_netif, route_priority)
     }
 }
 
+#define BATCH_TEST_FRAMES       2000
+#define BATCH_TEST_WINDOW       4       // frames in flight, below the default UDP receive mailbox size
+#define BATCH_TEST_PAYLOAD_LEN  64
+#define BATCH_TEST_PORT         5000
+#define ETH_HDR_LEN             14
+#define ARP_FRAME_LEN           (ETH_HDR_LEN + 28)
+#define UDP_FRAME_LEN           (ETH_HDR_LEN + 20 + 8 + BATCH_TEST_PAYLOAD_LEN)
+
+static const uint8_t s_dev_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x01 };
+static const uint8_t s_peer_mac[6] = { 0x02, 0x00, 0x00, 0x00, 0x00, 0x02 };
+static const uint8_t s_dev_ip[4] = { 192, 168, 7, 1 };
+static const uint8_t s_peer_ip[4] = { 192, 168, 7, 2 };
+
+typedef struct {
+    esp_netif_t *esp_netif;
+    volatile int udp_frames;        // UDP frames transmitted to the peer
+    volatile int transmit_calls;    // calls of transmit() and transmit_list()
+} batch_test_driver_t;
+
+static void batch_test_eth_header(uint8_t *frame, uint16_t type)
+{
+    memcpy(frame, s_dev_mac, 6);
+    memcpy(frame + 6, s_peer_mac, 6);
+    frame[12] = type >> 8;
+    frame[13] = type & 0xff;
+}
+
+static void batch_test_free_rx_buffer(void *h, void *buffer)
+{
+    free(buffer);
+}
+
+/* Answers the ARP requests for the peer address, so that the frames to transmit get resolved */
+static void batch_test_handle_frame(batch_test_driver_t *driver, const uint8_t *frame, size_t len)
+{
+    if (len >= ARP_FRAME_LEN && frame[12] == 0x08 && frame[13] == 0x06 &&
+            frame[ETH_HDR_LEN + 7] == 1 && memcmp(frame + ETH_HDR_LEN + 24, s_peer_ip, 4) == 0) {
+        uint8_t *reply = calloc(1, ARP_FRAME_LEN);
+        if (reply == NULL) {
+            return;
+        }
+        batch_test_eth_header(reply, 0x0806);
+        uint8_t *arp = reply + ETH_HDR_LEN;
+        arp[1] = 1;                 // Ethernet
+        arp[2] = 0x08;              // IPv4
+        arp[4] = 6;
+        arp[5] = 4;
+        arp[7] = 2;                 // reply
+        memcpy(arp + 8, s_peer_mac, 6);
+        memcpy(arp + 14, s_peer_ip, 4);
+        memcpy(arp + 18, s_dev_mac, 6);
+        memcpy(arp + 24, s_dev_ip, 4);
+        esp_netif_receive(driver->esp_netif, reply, ARP_FRAME_LEN, NULL);
+    } else if (len >= ETH_HDR_LEN + 20 && frame[12] == 0x08 && frame[13] == 0x00 && frame[ETH_HDR_LEN + 9] == 17) {
+        driver->udp_frames++;
+    }
+}
+
+static esp_err_t batch_test_transmit(void *h, void *buffer, size_t len)
+{
+    batch_test_driver_t *driver = h;
+    driver->transmit_calls++;
+    batch_test_handle_frame(driver, buffer, len);
+    return ESP_OK;
+}
+
+static esp_err_t batch_test_transmit_list(void *h, esp_netif_tx_frame_t *frames, size_t count)
+{
+    batch_test_driver_t *driver = h;
+    driver->transmit_calls++;
+    for (size_t i = 0; i < count; i++) {
+        batch_test_handle_frame(driver, frames[i].buffer, frames[i].len);
+    }
+    return ESP_OK;
+}
+
+static void *batch_test_udp_frame(uint16_t seq)
+{
+    uint8_t *frame = calloc(1, UDP_FRAME_LEN);
+    TEST_ASSERT_NOT_NULL(frame);
+    batch_test_eth_header(frame, 0x0800);
+    uint8_t *ip = frame + ETH_HDR_LEN;
+    ip[0] = 0x45;
+    ip[2] = (UDP_FRAME_LEN - ETH_HDR_LEN) >> 8;
+    ip[3] = (UDP_FRAME_LEN - ETH_HDR_LEN) & 0xff;
+    ip[4] = seq >> 8;
+    ip[5] = seq & 0xff;
+    ip[8] = 64;                     // TTL
+    ip[9] = 17;                     // UDP
+    memcpy(ip + 12, s_peer_ip, 4);
+    memcpy(ip + 16, s_dev_ip, 4);
+    uint32_t sum = 0;
+    for (int i = 0; i < 20; i += 2) {
+        sum += (ip[i] << 8) | ip[i + 1];
+    }
+    sum = (sum & 0xffff) + (sum >> 16);
+    sum = ~((sum & 0xffff) + (sum >> 16));
+    ip[10] = (sum >> 8) & 0xff;
+    ip[11] = sum & 0xff;
+    uint8_t *udp = ip + 20;
+    udp[0] = (BATCH_TEST_PORT + 1) >> 8;
+    udp[1] = (BATCH_TEST_PORT + 1) & 0xff;
+    udp[2] = BATCH_TEST_PORT >> 8;
+    udp[3] = BATCH_TEST_PORT & 0xff;
+    udp[5] = 8 + BATCH_TEST_PAYLOAD_LEN;   // no checksum
+    udp[8] = seq >> 8;
+    udp[9] = seq & 0xff;
+    return frame;
+}
+
+/*
+ * This test passes UDP datagrams through an Ethernet netif with a mock driver, in both directions,
+ * and reports the frame rates, to compare the configurations with and without RX/TX batching.
+ * - The received frames are input with esp_netif_receive(), a few frames at a time, and read from a socket
+ * - The datagrams sent to the peer are counted by the driver, which also answers the ARP requests
+ */
+TEST(esp_netif, udp_rx_tx_frames)
+{
+    test_case_uses_tcpip();
+    batch_test_driver_t driver = { 0 };
+    esp_netif_driver_ifconfig_t driver_config = { .handle = &driver,
+            .transmit = batch_test_transmit,
+            .transmit_list = batch_test_transmit_list,
+            .driver_free_rx_buffer = batch_test_free_rx_buffer };
+    esp_netif_ip_info_t ip_info = { .ip.addr = ESP_IP4TOADDR(192, 168, 7, 1),
+                                    .netmask.addr = ESP_IP4TOADDR(255, 255, 255, 0) };
+    esp_netif_inherent_config_t base_netif_config = { .if_key = "batch", .if_desc = "batch", .ip_info = &ip_info };
+    memcpy(base_netif_config.mac, s_dev_mac, sizeof(s_dev_mac));
+    esp_netif_config_t cfg = { .base = &base_netif_config,
+            .stack = ESP_NETIF_NETSTACK_DEFAULT_ETH,
+            .driver = &driver_config };
+    driver.esp_netif = esp_netif_new(&cfg);
+    TEST_ASSERT_NOT_NULL(driver.esp_netif);
+    esp_netif_action_start(driver.esp_netif, 0, 0, 0);
+    esp_netif_action_connected(driver.esp_netif, 0, 0, 0);
+
+    int sock = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, sock);
+    struct sockaddr_in addr = { .sin_family = AF_INET, .sin_port = htons(BATCH_TEST_PORT),
+                                .sin_addr.s_addr = htonl(INADDR_ANY) };
+    TEST_ASSERT_EQUAL(0, bind(sock, (struct sockaddr *)&addr, sizeof(addr)));
+    struct timeval timeout = { .tv_sec = 1 };
+    TEST_ASSERT_EQUAL(0, setsockopt(sock, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout)));
+
+    // receive path: every frame input has to reach the socket
+    uint8_t payload[BATCH_TEST_PAYLOAD_LEN] = { 0 };
+    int64_t start = esp_timer_get_time();
+    for (int seq = 0; seq < BATCH_TEST_FRAMES; seq += BATCH_TEST_WINDOW) {
+        for (int i = 0; i < BATCH_TEST_WINDOW; i++) {
+            TEST_ESP_OK(esp_netif_receive(driver.esp_netif, batch_test_udp_frame(seq + i), UDP_FRAME_LEN, NULL));
+        }
+        for (int i = 0; i < BATCH_TEST_WINDOW; i++) {
+            TEST_ASSERT_EQUAL(sizeof(payload), recv(sock, payload, sizeof(payload), 0));
+            TEST_ASSERT_EQUAL(seq + i, (payload[0] << 8) | payload[1]);
+        }
+    }
+    int64_t rx_time = esp_timer_get_time() - start;
+
+    // transmit path: every datagram sent has to reach the driver
+    struct sockaddr_in peer = { .sin_family = AF_INET, .sin_port = htons(BATCH_TEST_PORT + 1),
+                                .sin_addr.s_addr = ESP_IP4TOADDR(192, 168, 7, 2) };
+    // the first datagram waits for the ARP reply, send it before measuring
+    TEST_ASSERT_EQUAL(sizeof(payload), sendto(sock, payload, sizeof(payload), 0, (struct sockaddr *)&peer, sizeof(peer)));
+    for (int i = 0; i < 100 && driver.udp_frames < 1; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    TEST_ASSERT_EQUAL(1, driver.udp_frames);
+    start = esp_timer_get_time();
+    for (int seq = 0; seq < BATCH_TEST_FRAMES; seq++) {
+        TEST_ASSERT_EQUAL(sizeof(payload), sendto(sock, payload, sizeof(payload), 0, (struct sockaddr *)&peer, sizeof(peer)));
+    }
+    for (int i = 0; i < 100 && driver.udp_frames < BATCH_TEST_FRAMES + 1; i++) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    int64_t tx_time = esp_timer_get_time() - start;
+    TEST_ASSERT_EQUAL(BATCH_TEST_FRAMES + 1, driver.udp_frames);
+
+    printf("RX: %d frames in %" PRIi64 " us, TX: %d frames in %" PRIi64 " us (%d driver calls)\n",
+           BATCH_TEST_FRAMES, rx_time, BATCH_TEST_FRAMES, tx_time, driver.transmit_calls);
+
+    close(sock);
+    esp_netif_destroy(driver.esp_netif);
+}
+
 // to probe DNS server info directly in LWIP
 const ip_addr_t * dns_getserver(u8_t numdns);
 
@@ -610,6 +799,7 @@ TEST_GROUP_RUNNER(esp_netif)
 #endif
     RUN_TEST_CASE(esp_netif, route_priority)
     RUN_TEST_CASE(esp_netif, set_get_dnsserver)
+    RUN_TEST_CASE(esp_netif, udp_rx_tx_frames)
 }
 
 void app_main(void)
@@ -11,6 +11,7 @@ from pytest_embedded_idf.utils import idf_parametrize
     [
         'global_dns',
         'dns_per_netif',
+        'batching',
         'loopback',  # test config without LWIP
     ],
     indirect=True,
@@ -7,11 +7,13 @@
  */
 
 #include <string.h>
+#include <limits.h>
 #include <unistd.h>
 #include <sys/time.h>
 #include "esp_err.h"
 #include "esp_partition.h"
 #include "esp_private/partition_linux.h"
+#include "esp_private/partition_io.h"
 #include "unity.h"
 #include "unity_fixture.h"
 #include "esp_log.h"
@@ -702,6 +704,249 @@ TEST(partition_api, test_partition_power_off_emulation)
     free(test_data_ptr);
 }
 
+TEST(partition_api, test_partition_timing_profile)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    static const esp_partition_timing_profile_t profile = {
+        .name = "test",
+        .read_times = {1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11},
+        .write_times = {10, 20, 30, 40, 50, 60, 70, 80, 90, 100, 110},
+        .sector_erase_time = 1000,
+    };
+    TEST_ASSERT_EQUAL_PTR(&esp_partition_timing_profile_default, esp_partition_get_timing_profile());
+    esp_partition_set_timing_profile(&profile);
+    TEST_ASSERT_EQUAL_PTR(&profile, esp_partition_get_timing_profile());
+
+    uint8_t buf[256];
+    memset(buf, 0xff, sizeof(buf));
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL(1000, esp_partition_get_total_time());
+    // 256 bytes is a LUT entry, 384 bytes is interpolated between 256 and 512 bytes
+    TEST_ESP_OK(esp_partition_write(partition_data, 0, buf, sizeof(buf)));
+    TEST_ASSERT_EQUAL(1000 + 70, esp_partition_get_total_time());
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, buf, 128));
+    TEST_ESP_OK(esp_partition_read(partition_data, 128, buf, 128));
+    TEST_ASSERT_EQUAL(1000 + 70 + 6 + 6, esp_partition_get_total_time());
+    // sizes above 4096 bytes are accounted per 4096 bytes
+    void *big = malloc(3 * ESP_PARTITION_EMULATED_SECTOR_SIZE);
+    TEST_ASSERT_NOT_NULL(big);
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, big, 3 * ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ASSERT_EQUAL(1000 + 70 + 6 + 6 + 3 * 11, esp_partition_get_total_time());
+    free(big);
+
+    esp_partition_set_timing_profile(NULL);
+    TEST_ASSERT_EQUAL_PTR(&esp_partition_timing_profile_default, esp_partition_get_timing_profile());
+    esp_partition_clear_stats();
+}
+
+TEST(partition_api, test_partition_wear_stats)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+    const size_t sectors = partition_data->size / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+
+    esp_partition_wear_stats_t stats;
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_get_wear_stats(partition_data, NULL));
+
+    esp_partition_clear_stats();
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, partition_data->size));
+    for (int i = 0; i < 3; i++) {
+        TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    }
+
+    TEST_ESP_OK(esp_partition_get_wear_stats(partition_data, &stats));
+    TEST_ASSERT_EQUAL(sectors, stats.sector_count);
+    TEST_ASSERT_EQUAL(sectors, stats.erased_sector_count);
+    TEST_ASSERT_EQUAL(sectors + 3, stats.total_erase_count);
+    TEST_ASSERT_EQUAL(1, stats.min_erase_count);
+    TEST_ASSERT_EQUAL(4, stats.max_erase_count);
+
+    // the whole flash contains sectors which were not erased
+    TEST_ESP_OK(esp_partition_get_wear_stats(NULL, &stats));
+    TEST_ASSERT_GREATER_THAN(sectors, stats.sector_count);
+    TEST_ASSERT_EQUAL(sectors, stats.erased_sector_count);
+    TEST_ASSERT_EQUAL(0, stats.min_erase_count);
+    TEST_ASSERT_EQUAL(4, stats.max_erase_count);
+
+    esp_partition_clear_stats();
+}
+
+TEST(partition_api, test_partition_trace_replay)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    char trace_file[PATH_MAX];
+    partition_test_get_unique_filename(trace_file, sizeof(trace_file));
+
+    const size_t size = 4 * ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    uint8_t *buf = malloc(size);
+    uint8_t *recorded = malloc(size);
+    TEST_ASSERT_NOT_NULL(buf);
+    TEST_ASSERT_NOT_NULL(recorded);
+
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, size));
+    esp_partition_clear_stats();
+
+    // record a workload
+    TEST_ESP_OK(esp_partition_trace_start(trace_file));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_partition_trace_start(trace_file));
+    for (size_t i = 0; i < size; i++) {
+        buf[i] = (uint8_t) (i * 7);
+    }
+    TEST_ESP_OK(esp_partition_write(partition_data, 0, buf, size));
+    TEST_ESP_OK(esp_partition_read(partition_data, 100, buf, 1000));
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE, ESP_PARTITION_EMULATED_SECTOR_SIZE));
+    TEST_ESP_OK(esp_partition_write(partition_data, ESP_PARTITION_EMULATED_SECTOR_SIZE + 10, "replay", 6));
+    TEST_ESP_OK(esp_partition_trace_stop());
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_partition_trace_stop());
+
+    size_t recorded_time = esp_partition_get_total_time();
+    size_t recorded_write_bytes = esp_partition_get_write_bytes();
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, recorded, size));
+
+    // replay on erased flash gives the same contents and statistics
+    TEST_ESP_OK(esp_partition_erase_range(partition_data, 0, size));
+    esp_partition_clear_stats();
+    size_t op_count = 0;
+    TEST_ESP_OK(esp_partition_trace_replay(trace_file, &op_count));
+    TEST_ASSERT_EQUAL(4, op_count);
+    TEST_ASSERT_EQUAL(recorded_time, esp_partition_get_total_time());
+    TEST_ASSERT_EQUAL(recorded_write_bytes, esp_partition_get_write_bytes());
+    TEST_ASSERT_EQUAL(2, esp_partition_get_write_ops());
+    TEST_ASSERT_EQUAL(1, esp_partition_get_read_ops());
+    TEST_ASSERT_EQUAL(1, esp_partition_get_erase_ops());
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, buf, size));
+    TEST_ASSERT_EQUAL_HEX8_ARRAY(recorded, buf, size);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FOUND, esp_partition_trace_replay("/nonexistent/trace", NULL));
+
+    remove(trace_file);
+    free(buf);
+    free(recorded);
+    esp_partition_clear_stats();
+}
+
+typedef struct {
+    int completed[8];
+    int completed_count;
+} partition_submit_ctx_t;
+
+static void partition_submit_done_cb(const esp_partition_t *partition, esp_partition_op_t *ops, size_t op_count,
+                                     esp_err_t result, void *user_ctx)
+{
+    partition_submit_ctx_t *ctx = (partition_submit_ctx_t *) user_ctx;
+    // the batch index is stored in the offset of its first operation
+    ctx->completed[ctx->completed_count++] = result == ESP_OK ? (int)(ops[0].offset / partition->erase_size) : -1;
+}
+
+TEST(partition_api, test_partition_submit)
+{
+    const esp_partition_t *partition_data = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_ANY, "storage");
+    TEST_ASSERT_NOT_NULL(partition_data);
+
+    const size_t sector_size = partition_data->erase_size;
+    const int batch_count = 8;
+    static uint8_t header[8][4];
+    static uint8_t payload[8][256];
+    esp_partition_op_t ops[8][3];
+    partition_submit_ctx_t ctx = {0};
+
+    // queue several erase + write batches at once, each one rewrites one sector
+    for (int b = 0; b < batch_count; b++) {
+        memset(header[b], 0xA0 + b, sizeof(header[b]));
+        memset(payload[b], b, sizeof(payload[b]));
+        ops[b][0] = (esp_partition_op_t) {
+            .type = ESP_PARTITION_OP_ERASE, .offset = b * sector_size, .size = sector_size
+        };
+        ops[b][1] = (esp_partition_op_t) {
+            .type = ESP_PARTITION_OP_WRITE, .offset = b * sector_size, .size = sizeof(header[b]), .src = header[b]
+        };
+        ops[b][2] = (esp_partition_op_t) {
+            .type = ESP_PARTITION_OP_WRITE, .offset = b * sector_size + 16, .size = sizeof(payload[b]), .src = payload[b]
+        };
+        TEST_ESP_OK(esp_partition_submit(partition_data, ops[b], 3, partition_submit_done_cb, &ctx));
+    }
+    TEST_ESP_OK(esp_partition_wait_all());
+
+    // batches complete in submission order
+    TEST_ASSERT_EQUAL(batch_count, ctx.completed_count);
+    for (int b = 0; b < batch_count; b++) {
+        TEST_ASSERT_EQUAL(b, ctx.completed[b]);
+        for (int i = 0; i < 3; i++) {
+            TEST_ESP_OK(ops[b][i].result);
+        }
+    }
+
+    // gather the data back with one batch, waiting for it to complete
+    uint8_t header_out[8][4];
+    uint8_t payload_out[8][256];
+    esp_partition_op_t read_ops[16];
+    for (int b = 0; b < batch_count; b++) {
+        read_ops[2 * b] = (esp_partition_op_t) {
+            .type = ESP_PARTITION_OP_READ, .offset = b * sector_size, .size = sizeof(header_out[b]), .dst = header_out[b]
+        };
+        read_ops[2 * b + 1] = (esp_partition_op_t) {
+            .type = ESP_PARTITION_OP_READ, .offset = b * sector_size + 16, .size = sizeof(payload_out[b]), .dst = payload_out[b]
+        };
+    }
+    TEST_ESP_OK(esp_partition_submit(partition_data, read_ops, 16, NULL, NULL));
+    TEST_ASSERT_EQUAL_MEMORY(header, header_out, sizeof(header));
+    TEST_ASSERT_EQUAL_MEMORY(payload, payload_out, sizeof(payload));
+
+    // invalid operations reject the whole batch, nothing is executed
+    uint8_t pattern[4] = {0x12, 0x34, 0x56, 0x78};
+    esp_partition_op_t invalid_ops[2] = {
+        { .type = ESP_PARTITION_OP_ERASE, .offset = 0, .size = sector_size },
+        { .type = ESP_PARTITION_OP_WRITE, .offset = partition_data->size - 2, .size = sizeof(pattern), .src = pattern },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_partition_submit(partition_data, invalid_ops, 2, NULL, NULL));
+    invalid_ops[1] = (esp_partition_op_t) {
+        .type = ESP_PARTITION_OP_ERASE, .offset = 16, .size = sector_size
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_submit(partition_data, invalid_ops, 2, NULL, NULL));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_submit(partition_data, invalid_ops, 0, NULL, NULL));
+    TEST_ESP_OK(esp_partition_read(partition_data, 0, header_out[0], sizeof(header_out[0])));
+    TEST_ASSERT_EQUAL_MEMORY(header[0], header_out[0], sizeof(header_out[0]));
+
+    // writes to encrypted partitions are checked for the alignment esp_partition_write requires
+    esp_partition_t encrypted_partition = *partition_data;
+    encrypted_partition.encrypted = true;
+    esp_partition_op_t encrypted_ops[2] = {
+        { .type = ESP_PARTITION_OP_WRITE, .offset = 0, .size = 32, .src = payload[0] },
+        { .type = ESP_PARTITION_OP_WRITE, .offset = 32, .size = sizeof(pattern), .src = pattern },
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_partition_ops_check(&encrypted_partition, encrypted_ops, 2));
+    encrypted_ops[1] = (esp_partition_op_t) {
+        .type = ESP_PARTITION_OP_WRITE, .offset = 40, .size = 16, .src = payload[0]
+    };
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_partition_ops_check(&encrypted_partition, encrypted_ops, 2));
+    encrypted_ops[1].offset = 48;
+    TEST_ESP_OK(esp_partition_ops_check(&encrypted_partition, encrypted_ops, 2));
+    TEST_ESP_OK(esp_partition_ops_check(partition_data, encrypted_ops, 2));
+
+    // a failing operation stops the batch, the remaining ones are not executed
+    // esp_partition_write consumes one power off failure cycle per 4 bytes written
+    esp_partition_fail_after(2, ESP_PARTITION_FAIL_AFTER_MODE_WRITE);
+    esp_partition_op_t failing_ops[3] = {
+        { .type = ESP_PARTITION_OP_WRITE, .offset = 32 * 1024, .size = sizeof(pattern), .src = pattern },
+        { .type = ESP_PARTITION_OP_WRITE, .offset = 32 * 1024 + 16, .size = sizeof(payload[0]), .src = payload[0] },
+        { .type = ESP_PARTITION_OP_READ, .offset = 32 * 1024, .size = sizeof(header_out[0]), .dst = header_out[0] },
+    };
+    ctx.completed_count = 0;
+    TEST_ESP_OK(esp_partition_submit(partition_data, failing_ops, 3, partition_submit_done_cb, &ctx));
+    TEST_ESP_OK(esp_partition_wait_all());
+    esp_partition_fail_after(SIZE_MAX, 0);
+    TEST_ASSERT_EQUAL(1, ctx.completed_count);
+    TEST_ASSERT_EQUAL(-1, ctx.completed[0]);
+    TEST_ESP_OK(failing_ops[0].result);
+    TEST_ASSERT_EQUAL(ESP_ERR_FLASH_OP_FAIL, failing_ops[1].result);
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FINISHED, failing_ops[2].result);
+}
+
 TEST(partition_api, test_partition_copy)
 {
     const esp_partition_t *factory_part = esp_partition_find_first(ESP_PARTITION_TYPE_APP, ESP_PARTITION_SUBTYPE_APP_FACTORY, NULL);
@@ -763,6 +1008,10 @@ TEST_GROUP_RUNNER(partition_api)
     RUN_TEST_CASE(partition_api, test_partition_mmap_pfile_nf);
     RUN_TEST_CASE(partition_api, test_partition_stats);
     RUN_TEST_CASE(partition_api, test_partition_power_off_emulation);
+    RUN_TEST_CASE(partition_api, test_partition_timing_profile);
+    RUN_TEST_CASE(partition_api, test_partition_wear_stats);
+    RUN_TEST_CASE(partition_api, test_partition_trace_replay);
+    RUN_TEST_CASE(partition_api, test_partition_submit);
     RUN_TEST_CASE(partition_api, test_partition_copy);
     RUN_TEST_CASE(partition_api, test_partition_register_external);
 }
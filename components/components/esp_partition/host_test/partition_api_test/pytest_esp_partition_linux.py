@@ -6,6 +6,7 @@ from pytest_embedded_idf.utils import idf_parametrize
 
 
 @pytest.mark.host_test
+@pytest.mark.parametrize('config', ['default', 'async_io'])
 @idf_parametrize('target', ['linux'], indirect=['target'])
 def test_esp_partition_linux(dut: Dut) -> None:
     dut.expect_unity_test_output(timeout=5)
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -366,6 +366,90 @@ esp_err_t esp_partition_write_raw(const esp_partition_t* partition,
 esp_err_t esp_partition_erase_range(const esp_partition_t* partition,
                                     size_t offset, size_t size);
 
+/**
+ * @brief Type of an operation submitted using esp_partition_submit
+ */
+typedef enum {
+    ESP_PARTITION_OP_READ,      /*!< Read, same as esp_partition_read */
+    ESP_PARTITION_OP_WRITE,     /*!< Write, same as esp_partition_write */
+    ESP_PARTITION_OP_ERASE,     /*!< Erase, same as esp_partition_erase_range */
+} esp_partition_op_type_t;
+
+/**
+ * @brief Single operation of a batch submitted using esp_partition_submit
+ */
+typedef struct {
+    esp_partition_op_type_t type;   /*!< Type of the operation */
+    size_t offset;                  /*!< Offset from the beginning of the partition */
+    size_t size;                    /*!< Size of the range, in bytes */
+    union {
+        void *dst;                  /*!< Destination buffer of a read */
+        const void *src;            /*!< Source buffer of a write */
+    };
+    esp_err_t result;               /*!< Output, result of the operation once the batch has completed */
+} esp_partition_op_t;
+
+/**
+ * @brief Callback invoked when all operations of a batch have completed
+ *
+ * @param partition  Partition the batch was submitted for
+ * @param ops  Operations of the batch, with the result field of each of them set
+ * @param op_count  Number of operations in the batch
+ * @param result  ESP_OK if all operations succeeded, otherwise the result of the first failed operation
+ * @param user_ctx  User context passed to esp_partition_submit
+ */
+typedef void (*esp_partition_batch_done_cb_t)(const esp_partition_t* partition, esp_partition_op_t* ops,
+                                              size_t op_count, esp_err_t result, void* user_ctx);
+
+/**
+ * @brief Submit a batch of read, write and erase operations
+ *
+ * Operations of a batch are executed one after another in the order given. If an operation
+ * fails, the following ones are not executed and their result is set to ESP_ERR_NOT_FINISHED.
+ * Batches are executed and completed in the order they were submitted.
+ *
+ * Where the flash driver can execute operations in the background, this function returns
+ * as soon as the batch is queued and done_cb is invoked from the context executing the batch.
+ * The caller can then prepare and submit the next batch while the previous one is running.
+ * Otherwise the batch is executed synchronously and done_cb is invoked before this function
+ * returns. The operations array and all buffers it points to must stay valid until done_cb
+ * has been invoked.
+ *
+ * @note On the Linux target the batches are executed by a background thread if
+ *       CONFIG_ESP_PARTITION_ASYNC_IO is enabled. done_cb runs in that thread, which is not
+ *       a FreeRTOS task, and so it must not call FreeRTOS functions. It may submit further
+ *       batches with a callback, but not wait for a batch to complete.
+ *
+ * @param partition Pointer to partition structure obtained using
+ *                  esp_partition_find_first or esp_partition_get.
+ *                  Must be non-NULL.
+ * @param ops  Operations to execute. Must be non-NULL.
+ * @param op_count  Number of operations, must be greater than 0.
+ * @param done_cb  Callback invoked once the batch has completed. If NULL, this function
+ *                 waits for the batch to complete and returns its result.
+ * @param user_ctx  User context passed to done_cb.
+ *
+ * @return ESP_OK, if the batch was submitted (with done_cb) or all operations succeeded (without done_cb);
+ *         ESP_ERR_INVALID_ARG, if ops is NULL, op_count is 0, or an operation is out of the partition
+ *         or not aligned as required by the corresponding synchronous function;
+ *         ESP_ERR_INVALID_SIZE, if an operation would go out of bounds of the partition;
+ *         ESP_ERR_NOT_ALLOWED, if the batch writes to or erases a read-only partition;
+ *         ESP_ERR_NO_MEM, if the batch could not be queued;
+ *         ESP_ERR_INVALID_STATE, if called without done_cb from a completion callback;
+ *         or, without done_cb, the result of the first failed operation.
+ *         If any argument is invalid, no operation of the batch is executed.
+ */
+esp_err_t esp_partition_submit(const esp_partition_t* partition, esp_partition_op_t* ops, size_t op_count,
+                               esp_partition_batch_done_cb_t done_cb, void* user_ctx);
+
+/**
+ * @brief Wait until all batches submitted using esp_partition_submit have completed
+ *
+ * @return ESP_OK once all batches have completed;
+ *         ESP_ERR_INVALID_STATE, if called from a completion callback
+ */
+esp_err_t esp_partition_wait_all(void);
+
 /**
  * @brief Configure MMU to map partition into data memory
  *
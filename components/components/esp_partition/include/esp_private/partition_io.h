@@ -0,0 +1,54 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "esp_partition.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @file partition_io.h
+ *
+ * @brief Private functions shared by the implementations of esp_partition_submit
+ */
+
+/**
+ * @brief Check the arguments of all operations of a batch
+ *
+ * Applies the same checks as esp_partition_read, esp_partition_write and
+ * esp_partition_erase_range, so that a batch is either rejected as a whole
+ * or executed.
+ *
+ * @param partition  Partition the batch is submitted for
+ * @param ops  Operations of the batch
+ * @param op_count  Number of operations
+ *
+ * @return ESP_OK if the batch can be executed, otherwise the error returned by esp_partition_submit
+ */
+esp_err_t esp_partition_ops_check(const esp_partition_t *partition, const esp_partition_op_t *ops, size_t op_count);
+
+/**
+ * @brief Execute the operations of a batch in order, in the context of the caller
+ *
+ * Sets the result field of every operation. Operations following a failed one are
+ * not executed and get ESP_ERR_NOT_FINISHED.
+ *
+ * @param partition  Partition the batch is submitted for
+ * @param ops  Operations of the batch
+ * @param op_count  Number of operations
+ *
+ * @return ESP_OK if all operations succeeded, otherwise the result of the first failed one
+ */
+esp_err_t esp_partition_ops_execute(const esp_partition_t *partition, esp_partition_op_t *ops, size_t op_count);
+
+#ifdef __cplusplus
+}
+#endif
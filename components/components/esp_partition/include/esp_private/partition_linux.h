@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2021-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2021-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -10,6 +10,7 @@
 #include <stdbool.h>
 #include <limits.h>
 #include "esp_err.h"
+#include "esp_partition.h"
 
 #ifdef __cplusplus
 extern "C" {
@@ -166,8 +167,10 @@ size_t esp_partition_get_write_bytes(void);
  * Function returns estimated total time spent in esp_partition_read,
  * esp_partition_write and esp_partition_erase_range operations.
  *
+ * The estimate is based on the timing profile set by esp_partition_set_timing_profile.
+ *
  * @return
- *      - estimated total time spent in read/write/erase operations in milliseconds
+ *      - estimated total time spent in read/write/erase operations in microseconds
  */
 size_t esp_partition_get_total_time(void);
 
@@ -200,6 +203,129 @@ void esp_partition_fail_after(size_t count, uint8_t mode);
 */
 size_t esp_partition_get_sector_erase_count(size_t sector);
 
+/** @brief number of entries of the read and write time LUTs, for block sizes 4, 8, ..., 4096 bytes */
+#define ESP_PARTITION_TIMING_LUT_SIZE 11
+
+/**
+ * @brief Timing profile of the emulated SPI FLASH chip
+ *
+ * Read and write times of sizes between the LUT entries are interpolated linearly,
+ * sizes above 4096 bytes are accounted as a sequence of 4096 byte operations.
+ */
+typedef struct {
+    const char *name;                                       /*!< name of the profile, for reporting */
+    size_t read_times[ESP_PARTITION_TIMING_LUT_SIZE];       /*!< read time in microseconds of 4, 8, ..., 4096 bytes */
+    size_t write_times[ESP_PARTITION_TIMING_LUT_SIZE];      /*!< write time in microseconds of 4, 8, ..., 4096 bytes */
+    size_t sector_erase_time;                               /*!< erase time of one emulated sector in microseconds */
+} esp_partition_timing_profile_t;
+
+/** @brief timing profile used by default, measured on ESP8266 at 160MHz CPU and 80MHz flash frequency */
+extern const esp_partition_timing_profile_t esp_partition_timing_profile_default;
+
+/**
+ * @brief Sets the timing profile used to estimate the time of emulated operations
+ *
+ * Only operations performed after the call are affected, the time accumulated so far is kept.
+ *
+ * @param[in] profile Timing profile, the structure must stay valid until another profile is set.
+ *                    NULL selects esp_partition_timing_profile_default.
+ */
+void esp_partition_set_timing_profile(const esp_partition_timing_profile_t *profile);
+
+/**
+ * @brief Returns the timing profile in use
+ *
+ * @return
+ *      - pointer to the active timing profile
+ */
+const esp_partition_timing_profile_t *esp_partition_get_timing_profile(void);
+
+/**
+ * @brief Wear statistics of a range of emulated sectors
+ */
+typedef struct {
+    size_t sector_count;            /*!< number of sectors in the range */
+    size_t erased_sector_count;     /*!< number of sectors erased at least once */
+    size_t total_erase_count;       /*!< sum of erase counts of all sectors */
+    size_t min_erase_count;         /*!< lowest erase count of a sector */
+    size_t max_erase_count;         /*!< highest erase count of a sector */
+} esp_partition_wear_stats_t;
+
+/**
+ * @brief Summarizes per-sector erase counts of a partition
+ *
+ * Useful to compare wear levelling of different storage implementations on the same workload.
+ * The counts are those returned by esp_partition_get_sector_erase_count, i.e. since the recent esp_partition_clear_stats.
+ *
+ * @param[in] partition Partition to summarize, NULL for the whole emulated flash
+ * @param[out] stats Wear statistics
+ *
+ * @return
+ *      - ESP_OK: Operation successful
+ *      - ESP_ERR_INVALID_ARG: stats is NULL
+ *      - ESP_ERR_INVALID_STATE: Flash emulation is not initialized
+ *      - ESP_ERR_INVALID_SIZE: Partition lies outside of the emulated flash
+ */
+esp_err_t esp_partition_get_wear_stats(const esp_partition_t *partition, esp_partition_wear_stats_t *stats);
+
+/** @brief operation types in the I/O trace */
+typedef enum {
+    ESP_PARTITION_TRACE_OP_READ = 0,    /*!< esp_partition_read */
+    ESP_PARTITION_TRACE_OP_WRITE = 1,   /*!< esp_partition_write, the trace contains the data written */
+    ESP_PARTITION_TRACE_OP_ERASE = 2,   /*!< esp_partition_erase_range */
+} esp_partition_trace_op_t;
+
+/**
+ * @brief Starts recording of partition read, write and erase operations to a file
+ *
+ * Every operation is stored with its address relative to the beginning of the emulated flash and its size,
+ * write operations also with the data. The trace can be replayed by esp_partition_trace_replay, e.g. to compare
+ * timing profiles or the wear caused by a workload captured from a storage component.
+ *
+ * @param[in] path Name of the trace file, an existing file is overwritten
+ *
+ * @return
+ *      - ESP_OK: Operation successful
+ *      - ESP_ERR_INVALID_ARG: path is NULL
+ *      - ESP_ERR_INVALID_STATE: Trace is already being recorded
+ *      - ESP_ERR_NOT_FOUND: File could not be created
+ *      - ESP_FAIL: File header could not be written
+ */
+esp_err_t esp_partition_trace_start(const char *path);
+
+/**
+ * @brief Stops recording of the trace started by esp_partition_trace_start and closes the file
+ *
+ * @return
+ *      - ESP_OK: Operation successful
+ *      - ESP_ERR_INVALID_STATE: No trace is being recorded
+ *      - ESP_FAIL: File could not be closed
+ */
+esp_err_t esp_partition_trace_stop(void);
+
+/**
+ * @brief Replays a trace recorded by esp_partition_trace_start on the emulated flash
+ *
+ * Writes and erases are applied to the emulated flash, and all operations are accounted in the statistics
+ * using the active timing profile, exactly as if they were issued through the partition API.
+ * Power-off emulation set by esp_partition_fail_after applies as well.
+ *
+ * @param[in] path Name of the trace file
+ * @param[out] op_count Optional, number of operations replayed
+ *
+ * @return
+ *      - ESP_OK: Operation successful
+ *      - ESP_ERR_INVALID_ARG: path is NULL
+ *      - ESP_ERR_INVALID_STATE: Flash emulation is not initialized
+ *      - ESP_ERR_NOT_FOUND: File could not be opened
+ *      - ESP_ERR_INVALID_RESPONSE: File is not a trace or is truncated
+ *      - ESP_ERR_INVALID_VERSION: Trace file version is not supported
+ *      - ESP_ERR_INVALID_SIZE: Trace accesses memory outside of the emulated flash
+ *      - ESP_ERR_NO_MEM: Buffer for write data could not be allocated
+ *      - ESP_ERR_FLASH_OP_FAIL: Emulated power-off occurred
+ */
+esp_err_t esp_partition_trace_replay(const char *path, size_t *op_count);
+
 typedef struct {
     char flash_file_name[PATH_MAX];      /*!< name of flash dump file, zero-terminated ASCII string */
     size_t flash_file_size;              /*!< size of flash dump file in bytes */
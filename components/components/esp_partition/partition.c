@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -35,6 +35,7 @@
 #include "bootloader_util.h"
 #include "hal/efuse_hal.h"
 
+#include "esp_private/partition_io.h"
 #if CONFIG_IDF_TARGET_LINUX
 #include "esp_private/partition_linux.h"
 #endif
@@ -564,3 +565,115 @@ esp_err_t esp_partition_copy(const esp_partition_t* dest_part, uint32_t dest_off
     }
     return error;
 }
+
+esp_err_t esp_partition_ops_check(const esp_partition_t *partition, const esp_partition_op_t *ops, size_t op_count)
+{
+    if (partition == NULL || ops == NULL || op_count == 0) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    for (size_t i = 0; i < op_count; i++) {
+        const esp_partition_op_t *op = &ops[i];
+        switch (op->type) {
+        case ESP_PARTITION_OP_READ:
+            if (op->dst == NULL) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            break;
+        case ESP_PARTITION_OP_WRITE:
+            if (partition->readonly) {
+                return ESP_ERR_NOT_ALLOWED;
+            }
+            if (op->src == NULL) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            /* Same alignment as required by esp_flash_write_encrypted, so that a batch
+             * does not fail halfway through */
+            if (partition->encrypted) {
+                if ((partition->address + op->offset) % 16 != 0) {
+                    return ESP_ERR_INVALID_ARG;
+                }
+                if (op->size % 16 != 0) {
+                    return ESP_ERR_INVALID_SIZE;
+                }
+            }
+            break;
+        case ESP_PARTITION_OP_ERASE:
+            if (partition->readonly) {
+                return ESP_ERR_NOT_ALLOWED;
+            }
+            if (op->offset % partition->erase_size != 0) {
+                return ESP_ERR_INVALID_ARG;
+            }
+            if (op->size % partition->erase_size != 0) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            break;
+        default:
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (op->offset > partition->size) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        if (op->size > partition->size - op->offset) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_ops_execute(const esp_partition_t *partition, esp_partition_op_t *ops, size_t op_count)
+{
+    esp_err_t result = ESP_OK;
+    for (size_t i = 0; i < op_count; i++) {
+        esp_partition_op_t *op = &ops[i];
+        if (result != ESP_OK) {
+            op->result = ESP_ERR_NOT_FINISHED;
+            continue;
+        }
+        switch (op->type) {
+        case ESP_PARTITION_OP_READ:
+            op->result = esp_partition_read(partition, op->offset, op->dst, op->size);
+            break;
+        case ESP_PARTITION_OP_WRITE:
+            op->result = esp_partition_write(partition, op->offset, op->src, op->size);
+            break;
+        case ESP_PARTITION_OP_ERASE:
+            op->result = esp_partition_erase_range(partition, op->offset, op->size);
+            break;
+        default:
+            op->result = ESP_ERR_INVALID_ARG;
+            break;
+        }
+        if (op->result != ESP_OK) {
+            ESP_LOGD(TAG, "batch operation %u failed (err=0x%x)", (unsigned) i, op->result);
+            result = op->result;
+        }
+    }
+    return result;
+}
+
+#if !CONFIG_ESP_PARTITION_ASYNC_IO
+/* Synchronous fallback, the batch is executed right away in the context of the caller.
+ * The Linux emulator provides an implementation executing batches in the background,
+ * see partition_linux.c.
+ */
+esp_err_t esp_partition_submit(const esp_partition_t *partition, esp_partition_op_t *ops, size_t op_count,
+                               esp_partition_batch_done_cb_t done_cb, void *user_ctx)
+{
+    esp_err_t err = esp_partition_ops_check(partition, ops, op_count);
+    if (err != ESP_OK) {
+        return err;
+    }
+    err = esp_partition_ops_execute(partition, ops, op_count);
+    if (done_cb == NULL) {
+        return err;
+    }
+    done_cb(partition, ops, op_count, err, user_ctx);
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_wait_all(void)
+{
+    return ESP_OK;
+}
+#endif // !CONFIG_ESP_PARTITION_ASYNC_IO
@@ -19,6 +19,7 @@
 #include "esp_partition.h"
 #include "esp_flash_partitions.h"
 #include "esp_private/partition_linux.h"
+#include "esp_private/partition_io.h"
 #include "esp_log.h"
 #include "spi_flash_mmap.h"
 
@@ -47,22 +48,62 @@ static uint8_t s_esp_partition_emulated_power_off_mode = 0;
 // tracking erase count individually for each emulated sector
 static size_t *s_esp_partition_stat_sector_erase_count = NULL;
 
+// I/O trace being recorded, NULL if tracing is off
+static FILE *s_esp_partition_trace_file = NULL;
+
 // forward declaration of hooks
 static void esp_partition_hook_read(const void *srcAddr, const size_t size);
 static bool esp_partition_hook_write(const void *dstAddr, size_t *size);
 static bool esp_partition_hook_erase(const void *dstAddr, size_t *size);
+static void esp_partition_trace_record(uint8_t op, const void *addr, size_t size, const void *data);
 
 // redirect hooks to functions
 #define ESP_PARTITION_HOOK_READ(srcAddr, size) esp_partition_hook_read(srcAddr, size)
 #define ESP_PARTITION_HOOK_WRITE(dstAddr, size) esp_partition_hook_write(dstAddr, size)
 #define ESP_PARTITION_HOOK_ERASE(dstAddr, size) esp_partition_hook_erase(dstAddr, size)
+#define ESP_PARTITION_TRACE(op, addr, size, data) esp_partition_trace_record(op, addr, size, data)
 #else
 // redirect hooks to "do nothing code"
 #define ESP_PARTITION_HOOK_READ(srcAddr, size)
 #define ESP_PARTITION_HOOK_WRITE(dstAddr, size) true
 #define ESP_PARTITION_HOOK_ERASE(dstAddr, size) true
+#define ESP_PARTITION_TRACE(op, addr, size, data)
 #endif
 
+#ifdef CONFIG_ESP_PARTITION_ASYNC_IO
+#include <pthread.h>
+
+// batch queued by esp_partition_submit
+typedef struct esp_partition_batch_ {
+    const esp_partition_t *partition;
+    esp_partition_op_t *ops;
+    size_t op_count;
+    esp_partition_batch_done_cb_t done_cb;
+    void *user_ctx;
+    esp_err_t result;
+    bool done;
+    struct esp_partition_batch_ *next;
+} esp_partition_batch_t;
+
+// serializes accesses to the emulated flash between the background thread and other callers
+static pthread_mutex_t s_esp_partition_io_lock = PTHREAD_MUTEX_INITIALIZER;
+// protects the queue, the pending count and the state of the background thread
+static pthread_mutex_t s_esp_partition_queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t s_esp_partition_queue_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t s_esp_partition_done_cond = PTHREAD_COND_INITIALIZER;
+static esp_partition_batch_t *s_esp_partition_queue_head = NULL;
+static esp_partition_batch_t *s_esp_partition_queue_tail = NULL;
+static size_t s_esp_partition_pending_batches = 0;
+static bool s_esp_partition_worker_started = false;
+static pthread_t s_esp_partition_worker;
+
+#define ESP_PARTITION_IO_LOCK() pthread_mutex_lock(&s_esp_partition_io_lock)
+#define ESP_PARTITION_IO_UNLOCK() pthread_mutex_unlock(&s_esp_partition_io_lock)
+#else
+#define ESP_PARTITION_IO_LOCK()
+#define ESP_PARTITION_IO_UNLOCK()
+#endif // CONFIG_ESP_PARTITION_ASYNC_IO
+
 const char *esp_partition_type_to_str(const uint32_t type)
 {
     switch (type) {
@@ -396,6 +437,11 @@ esp_err_t esp_partition_file_munmap(void)
         return ESP_ERR_NOT_FOUND;
     }
 
+#ifdef CONFIG_ESP_PARTITION_ASYNC_IO
+    // batches still in flight would access the memory which is about to be unmapped
+    esp_partition_wait_all();
+#endif
+
     esp_partition_unload_all();
 
 #ifdef CONFIG_ESP_PARTITION_ENABLE_STATS
@@ -465,6 +511,8 @@ esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offse
 
     esp_err_t ret = ESP_OK;
 
+    ESP_PARTITION_IO_LOCK();
+
     // hook gathers statistics and can emulate power-off
     // in case of power - off it decreases new_size to the number of bytes written
     // before power event occurred
@@ -487,6 +535,10 @@ esp_err_t esp_partition_write(const esp_partition_t *partition, size_t dst_offse
         ((uint8_t *)dst_addr)[x] &= ((uint8_t *)src)[x];
     }
 
+    ESP_PARTITION_TRACE(ESP_PARTITION_TRACE_OP_WRITE, dst_addr, new_size, src);
+
+    ESP_PARTITION_IO_UNLOCK();
+
     return ret;
 }
 
@@ -516,9 +568,14 @@ esp_err_t esp_partition_read(const esp_partition_t *partition, size_t src_offset
     void *src_addr = s_spiflash_mem_file_buf + partition->address + src_offset;
     ESP_LOGV(TAG, "esp_partition_read(): partition=%s src_offset=%" PRIu32 " dst=%p size=%" PRIu32 " (real src address: %p)", partition->label, (uint32_t) src_offset, dst, (uint32_t) size, src_addr);
 
+    ESP_PARTITION_IO_LOCK();
+
     memcpy(dst, src_addr, size);
 
     ESP_PARTITION_HOOK_READ(src_addr, size); // statistics
+    ESP_PARTITION_TRACE(ESP_PARTITION_TRACE_OP_READ, src_addr, size, NULL);
+
+    ESP_PARTITION_IO_UNLOCK();
 
     return ESP_OK;
 }
@@ -567,6 +624,8 @@ esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t off
     // hook gathers statistics and can emulate power-off
     esp_err_t ret = ESP_OK;
 
+    ESP_PARTITION_IO_LOCK();
+
     if(!ESP_PARTITION_HOOK_ERASE(target_addr, &new_size)) {
         ret =  ESP_ERR_FLASH_OP_FAIL;
     }
@@ -574,6 +633,10 @@ esp_err_t esp_partition_erase_range(const esp_partition_t *partition, size_t off
     //set all bits to 1 (NOR FLASH default)
     memset(target_addr, 0xFF, new_size);
 
+    ESP_PARTITION_TRACE(ESP_PARTITION_TRACE_OP_ERASE, target_addr, new_size, NULL);
+
+    ESP_PARTITION_IO_UNLOCK();
+
     return ret;
 }
 
@@ -649,21 +712,38 @@ uint32_t esp_partition_get_main_flash_sector_size(void)
 // timing data for ESP8266, 160MHz CPU frequency, 80MHz flash frequency
 // all values in microseconds
 // values are for block sizes starting at 4 bytes and going up to 4096 bytes
-static size_t s_esp_partition_stat_read_times[] = {7, 5, 6, 7, 11, 18, 32, 60, 118, 231, 459};
-static size_t s_esp_partition_stat_write_times[] = {19, 23, 35, 57, 106, 205, 417, 814, 1622, 3200, 6367};
-static size_t s_esp_partition_stat_block_erase_time = 37142;
-
-static size_t esp_partition_stat_time_interpolate(uint32_t bytes, size_t *lut)
+const esp_partition_timing_profile_t esp_partition_timing_profile_default = {
+    .name = "esp8266_160mhz_flash_80mhz",
+    .read_times = {7, 5, 6, 7, 11, 18, 32, 60, 118, 231, 459},
+    .write_times = {19, 23, 35, 57, 106, 205, 417, 814, 1622, 3200, 6367},
+    .sector_erase_time = 37142,
+};
+
+static const esp_partition_timing_profile_t *s_esp_partition_timing_profile = &esp_partition_timing_profile_default;
+
+// Interpolates operation time from the LUT, sizes above 4096 bytes are accounted as
+// a sequence of 4096 byte operations followed by the remainder
+static size_t esp_partition_stat_time_interpolate(uint32_t bytes, const size_t *lut)
 {
-    const int lut_size = sizeof(s_esp_partition_stat_read_times) / sizeof(s_esp_partition_stat_read_times[0]);
+    const size_t max_lut_bytes = 4 << (ESP_PARTITION_TIMING_LUT_SIZE - 1);
+    size_t time = (bytes / max_lut_bytes) * lut[ESP_PARTITION_TIMING_LUT_SIZE - 1];
+    bytes %= max_lut_bytes;
+    if (bytes == 0) {
+        return time;
+    }
+    if (bytes < 4) {
+        bytes = 4;
+    }
     int lz = __builtin_clz(bytes / 4);
     int log_size = 32 - lz;
     size_t x2 = 1 << (log_size + 2);
-    size_t upper_index = (log_size < lut_size - 1) ? log_size : lut_size - 1;
+    size_t upper_index = (log_size < ESP_PARTITION_TIMING_LUT_SIZE - 1) ? log_size : ESP_PARTITION_TIMING_LUT_SIZE - 1;
     size_t y2 = lut[upper_index];
     size_t x1 = 1 << (log_size + 1);
     size_t y1 = lut[log_size - 1];
-    return (bytes - x1) * (y2 - y1) / (x2 - x1) + y1;
+    // the table is not monotonic for the smallest sizes, so interpolate in signed arithmetic
+    int64_t delta = ((int64_t) bytes - (int64_t) x1) * ((int64_t) y2 - (int64_t) y1) / (int64_t)(x2 - x1);
+    return time + (size_t)((int64_t) y1 + delta);
 }
 
 // Registers read access statistics of emulated SPI FLASH device (Linux host)
@@ -676,7 +756,7 @@ static void esp_partition_hook_read(const void *srcAddr, const size_t size)
     // stats
     ++s_esp_partition_stat_read_ops;
     s_esp_partition_stat_read_bytes += size;
-    s_esp_partition_stat_total_time += esp_partition_stat_time_interpolate((uint32_t) size, s_esp_partition_stat_read_times);
+    s_esp_partition_stat_total_time += esp_partition_stat_time_interpolate((uint32_t) size, s_esp_partition_timing_profile->read_times);
 }
 
 // Registers write access statistics of emulated SPI FLASH device (Linux host)
@@ -719,7 +799,7 @@ static bool esp_partition_hook_write(const void *dstAddr, size_t *size)
         // stats
         ++s_esp_partition_stat_write_ops;
         s_esp_partition_stat_write_bytes += write_cycles * 4;
-        s_esp_partition_stat_total_time += esp_partition_stat_time_interpolate((uint32_t) (*size), s_esp_partition_stat_write_times);
+        s_esp_partition_stat_total_time += esp_partition_stat_time_interpolate((uint32_t) (*size), s_esp_partition_timing_profile->write_times);
     }
 
     return ret_val;
@@ -772,7 +852,7 @@ static bool esp_partition_hook_erase(const void *dstAddr, size_t *size)
     for (size_t sector_index = first_sector_idx; sector_index < first_sector_idx + sector_count; sector_index++) {
         ++s_esp_partition_stat_erase_ops;
         s_esp_partition_stat_sector_erase_count[sector_index]++;
-        s_esp_partition_stat_total_time += s_esp_partition_stat_block_erase_time;
+        s_esp_partition_stat_total_time += s_esp_partition_timing_profile->sector_erase_time;
     }
 
     return ret_val;
@@ -830,4 +910,334 @@ size_t esp_partition_get_sector_erase_count(size_t sector)
 {
     return s_esp_partition_stat_sector_erase_count[sector];
 }
+
+void esp_partition_set_timing_profile(const esp_partition_timing_profile_t *profile)
+{
+    s_esp_partition_timing_profile = (profile != NULL) ? profile : &esp_partition_timing_profile_default;
+}
+
+const esp_partition_timing_profile_t *esp_partition_get_timing_profile(void)
+{
+    return s_esp_partition_timing_profile;
+}
+
+esp_err_t esp_partition_get_wear_stats(const esp_partition_t *partition, esp_partition_wear_stats_t *stats)
+{
+    if (stats == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_esp_partition_stat_sector_erase_count == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    size_t first_sector = 0;
+    size_t sector_count = s_esp_partition_file_mmap_ctrl_act.flash_file_size / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+    if (partition != NULL) {
+        first_sector = partition->address / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        size_t last_sector = (partition->address + partition->size - 1) / ESP_PARTITION_EMULATED_SECTOR_SIZE;
+        if (last_sector >= sector_count) {
+            return ESP_ERR_INVALID_SIZE;
+        }
+        sector_count = last_sector - first_sector + 1;
+    }
+
+    memset(stats, 0, sizeof(*stats));
+    stats->sector_count = sector_count;
+    stats->min_erase_count = SIZE_MAX;
+    for (size_t sector = first_sector; sector < first_sector + sector_count; sector++) {
+        size_t count = s_esp_partition_stat_sector_erase_count[sector];
+        stats->total_erase_count += count;
+        if (count < stats->min_erase_count) {
+            stats->min_erase_count = count;
+        }
+        if (count > stats->max_erase_count) {
+            stats->max_erase_count = count;
+        }
+        if (count > 0) {
+            stats->erased_sector_count++;
+        }
+    }
+    return ESP_OK;
+}
+
+// Trace file layout: esp_partition_trace_header_t, followed by esp_partition_trace_record_t
+// for each operation. Write records are followed by the data written.
+#define ESP_PARTITION_TRACE_MAGIC   0x52545045  // "EPTR"
+#define ESP_PARTITION_TRACE_VERSION 1
+
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+} esp_partition_trace_header_t;
+
+typedef struct {
+    uint8_t op;             // esp_partition_trace_op_t
+    uint8_t reserved[3];
+    uint32_t address;       // offset from the beginning of the emulated flash
+    uint32_t size;
+} esp_partition_trace_record_t;
+
+static void esp_partition_trace_record(uint8_t op, const void *addr, size_t size, const void *data)
+{
+    if (s_esp_partition_trace_file == NULL) {
+        return;
+    }
+    esp_partition_trace_record_t record = {
+        .op = op,
+        .address = (uint32_t) ((const uint8_t *) addr - (const uint8_t *) s_spiflash_mem_file_buf),
+        .size = (uint32_t) size,
+    };
+    if (fwrite(&record, sizeof(record), 1, s_esp_partition_trace_file) != 1 ||
+            (data != NULL && size > 0 && fwrite(data, size, 1, s_esp_partition_trace_file) != 1)) {
+        ESP_LOGE(TAG, "Failed to write partition trace: %s, tracing stopped", strerror(errno));
+        fclose(s_esp_partition_trace_file);
+        s_esp_partition_trace_file = NULL;
+    }
+}
+
+esp_err_t esp_partition_trace_start(const char *path)
+{
+    if (path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_esp_partition_trace_file != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    FILE *f = fopen(path, "wb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to create partition trace file %s: %s", path, strerror(errno));
+        return ESP_ERR_NOT_FOUND;
+    }
+    const esp_partition_trace_header_t header = {
+        .magic = ESP_PARTITION_TRACE_MAGIC,
+        .version = ESP_PARTITION_TRACE_VERSION,
+    };
+    if (fwrite(&header, sizeof(header), 1, f) != 1) {
+        ESP_LOGE(TAG, "Failed to write partition trace file %s: %s", path, strerror(errno));
+        fclose(f);
+        return ESP_FAIL;
+    }
+    s_esp_partition_trace_file = f;
+    return ESP_OK;
+}
+
+esp_err_t esp_partition_trace_stop(void)
+{
+    if (s_esp_partition_trace_file == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    int res = fclose(s_esp_partition_trace_file);
+    s_esp_partition_trace_file = NULL;
+    return (res == 0) ? ESP_OK : ESP_FAIL;
+}
+
+esp_err_t esp_partition_trace_replay(const char *path, size_t *op_count)
+{
+    if (path == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (s_spiflash_mem_file_buf == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    FILE *f = fopen(path, "rb");
+    if (f == NULL) {
+        ESP_LOGE(TAG, "Failed to open partition trace file %s: %s", path, strerror(errno));
+        return ESP_ERR_NOT_FOUND;
+    }
+
+    esp_err_t ret = ESP_OK;
+    uint8_t *data = NULL;
+    size_t data_size = 0;
+    size_t count = 0;
+    const size_t flash_size = s_esp_partition_file_mmap_ctrl_act.flash_file_size;
+
+    esp_partition_trace_header_t header;
+    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != ESP_PARTITION_TRACE_MAGIC) {
+        ESP_LOGE(TAG, "%s is not a partition trace file", path);
+        fclose(f);
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+    if (header.version != ESP_PARTITION_TRACE_VERSION) {
+        ESP_LOGE(TAG, "Unsupported partition trace version %" PRIu32, header.version);
+        fclose(f);
+        return ESP_ERR_INVALID_VERSION;
+    }
+
+    esp_partition_trace_record_t record;
+    while (fread(&record, sizeof(record), 1, f) == 1) {
+        if ((size_t) record.address > flash_size || (size_t) record.size > flash_size - record.address) {
+            ESP_LOGE(TAG, "Partition trace record %zu is out of the emulated flash range", count);
+            ret = ESP_ERR_INVALID_SIZE;
+            break;
+        }
+        uint8_t *addr = (uint8_t *) s_spiflash_mem_file_buf + record.address;
+        size_t size = record.size;
+
+        if (record.op == ESP_PARTITION_TRACE_OP_READ) {
+            ESP_PARTITION_HOOK_READ(addr, size);
+        } else if (record.op == ESP_PARTITION_TRACE_OP_WRITE) {
+            if (size > data_size) {
+                uint8_t *new_data = realloc(data, size);
+                if (new_data == NULL) {
+                    ret = ESP_ERR_NO_MEM;
+                    break;
+                }
+                data = new_data;
+                data_size = size;
+            }
+            if (size > 0 && fread(data, size, 1, f) != 1) {
+                ESP_LOGE(TAG, "Partition trace record %zu is truncated", count);
+                ret = ESP_ERR_INVALID_RESPONSE;
+                break;
+            }
+            if (!ESP_PARTITION_HOOK_WRITE(addr, &size)) {
+                ret = ESP_ERR_FLASH_OP_FAIL;
+            }
+            for (size_t x = 0; x < size; x++) {
+#ifdef CONFIG_ESP_PARTITION_ERASE_CHECK
+                // same as esp_partition_write, so that the flash contents match the recording
+                if ((~addr[x] & data[x]) != 0) {
+                    break;
+                }
+#endif // CONFIG_ESP_PARTITION_ERASE_CHECK
+                addr[x] &= data[x];
+            }
+        } else if (record.op == ESP_PARTITION_TRACE_OP_ERASE) {
+            if (!ESP_PARTITION_HOOK_ERASE(addr, &size)) {
+                ret = ESP_ERR_FLASH_OP_FAIL;
+            }
+            memset(addr, 0xFF, size);
+        } else {
+            ESP_LOGE(TAG, "Unknown operation %d in partition trace record %zu", record.op, count);
+            ret = ESP_ERR_INVALID_RESPONSE;
+            break;
+        }
+        ESP_PARTITION_TRACE(record.op, addr, size, record.op == ESP_PARTITION_TRACE_OP_WRITE ? data : NULL);
+        count++;
+        if (ret != ESP_OK) {
+            break;
+        }
+    }
+
+    free(data);
+    fclose(f);
+    if (op_count != NULL) {
+        *op_count = count;
+    }
+    return ret;
+}
 #endif
+
+#ifdef CONFIG_ESP_PARTITION_ASYNC_IO
+// Background thread executing the queued batches in the order they were submitted
+static void *esp_partition_worker_main(void *arg)
+{
+    (void) arg;
+    pthread_mutex_lock(&s_esp_partition_queue_lock);
+    while (true) {
+        while (s_esp_partition_queue_head == NULL) {
+            pthread_cond_wait(&s_esp_partition_queue_cond, &s_esp_partition_queue_lock);
+        }
+        esp_partition_batch_t *batch = s_esp_partition_queue_head;
+        s_esp_partition_queue_head = batch->next;
+        if (s_esp_partition_queue_head == NULL) {
+            s_esp_partition_queue_tail = NULL;
+        }
+        pthread_mutex_unlock(&s_esp_partition_queue_lock);
+
+        batch->result = esp_partition_ops_execute(batch->partition, batch->ops, batch->op_count);
+        // batches without callback belong to a caller waiting for them, and must not be
+        // accessed once they are marked as done
+        bool owned = batch->done_cb != NULL;
+        if (owned) {
+            batch->done_cb(batch->partition, batch->ops, batch->op_count, batch->result, batch->user_ctx);
+        }
+
+        pthread_mutex_lock(&s_esp_partition_queue_lock);
+        batch->done = true;
+        s_esp_partition_pending_batches--;
+        pthread_cond_broadcast(&s_esp_partition_done_cond);
+        if (owned) {
+            free(batch);
+        }
+    }
+    return NULL;
+}
+
+static bool esp_partition_in_worker(void)
+{
+    return s_esp_partition_worker_started && pthread_equal(pthread_self(), s_esp_partition_worker);
+}
+
+esp_err_t esp_partition_submit(const esp_partition_t *partition, esp_partition_op_t *ops, size_t op_count,
+                               esp_partition_batch_done_cb_t done_cb, void *user_ctx)
+{
+    esp_err_t err = esp_partition_ops_check(partition, ops, op_count);
+    if (err != ESP_OK) {
+        return err;
+    }
+
+    esp_partition_batch_t local_batch;
+    esp_partition_batch_t *batch = &local_batch;
+    if (done_cb != NULL) {
+        batch = malloc(sizeof(esp_partition_batch_t));
+        if (batch == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+    } else if (esp_partition_in_worker()) {
+        // waiting for the batch from a completion callback would never return
+        return ESP_ERR_INVALID_STATE;
+    }
+    *batch = (esp_partition_batch_t) {
+        .partition = partition,
+        .ops = ops,
+        .op_count = op_count,
+        .done_cb = done_cb,
+        .user_ctx = user_ctx,
+    };
+
+    pthread_mutex_lock(&s_esp_partition_queue_lock);
+    if (!s_esp_partition_worker_started) {
+        if (pthread_create(&s_esp_partition_worker, NULL, esp_partition_worker_main, NULL) != 0) {
+            pthread_mutex_unlock(&s_esp_partition_queue_lock);
+            ESP_LOGE(TAG, "Failed to start the partition I/O thread");
+            if (batch != &local_batch) {
+                free(batch);
+            }
+            return ESP_ERR_NO_MEM;
+        }
+        pthread_detach(s_esp_partition_worker);
+        s_esp_partition_worker_started = true;
+    }
+    if (s_esp_partition_queue_tail != NULL) {
+        s_esp_partition_queue_tail->next = batch;
+    } else {
+        s_esp_partition_queue_head = batch;
+    }
+    s_esp_partition_queue_tail = batch;
+    s_esp_partition_pending_batches++;
+    pthread_cond_signal(&s_esp_partition_queue_cond);
+
+    if (done_cb == NULL) {
+        while (!local_batch.done) {
+            pthread_cond_wait(&s_esp_partition_done_cond, &s_esp_partition_queue_lock);
+        }
+        err = local_batch.result;
+    }
+    pthread_mutex_unlock(&s_esp_partition_queue_lock);
+    return err;
+}
+
+esp_err_t esp_partition_wait_all(void)
+{
+    if (esp_partition_in_worker()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    pthread_mutex_lock(&s_esp_partition_queue_lock);
+    while (s_esp_partition_pending_batches > 0) {
+        pthread_cond_wait(&s_esp_partition_done_cond, &s_esp_partition_queue_lock);
+    }
+    pthread_mutex_unlock(&s_esp_partition_queue_lock);
+    return ESP_OK;
+}
+#endif // CONFIG_ESP_PARTITION_ASYNC_IO
@@ -0,0 +1,359 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <stdio.h>
+#include <stdlib.h>
+#include <inttypes.h>
+#include <sys/param.h>
+#include "unity.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/* Note: on Linux, alarms are handled with a resolution of one FreeRTOS tick,
+   the tests only check the order of the callbacks and that they were called.
+*/
+
+#define NUM_TIMERS 200
+#define BENCH_TIMERS 4000
+
+typedef struct {
+    int index;
+    uint64_t expiry;
+    int64_t called_at;
+} test_timer_arg_t;
+
+static test_timer_arg_t s_args[NUM_TIMERS];
+static int s_order[NUM_TIMERS];
+static volatile int s_calls;
+
+static uint32_t s_seed;
+
+static uint32_t test_random(void)
+{
+    s_seed = s_seed * 1103515245 + 12345;
+    return s_seed >> 8;
+}
+
+static void record_cb(void *arg)
+{
+    test_timer_arg_t *p_arg = (test_timer_arg_t *) arg;
+    p_arg->called_at = esp_timer_get_time();
+    s_order[s_calls++] = p_arg->index;
+}
+
+static int64_t s_first_call;
+static int64_t s_last_call;
+
+static void bench_cb(void *arg)
+{
+    s_last_call = esp_timer_get_time();
+    if (s_first_call == 0) {
+        s_first_call = s_last_call;
+    }
+}
+
+static void create_timers(esp_timer_handle_t *timers, size_t count)
+{
+    s_calls = 0;
+    for (size_t i = 0; i < count; ++i) {
+        s_args[i].index = i;
+        s_args[i].called_at = 0;
+        esp_timer_create_args_t args = {
+            .callback = &record_cb,
+            .arg = &s_args[i],
+        };
+        TEST_ESP_OK(esp_timer_create(&args, &timers[i]));
+    }
+}
+
+static void delete_timers(esp_timer_handle_t *timers, size_t count)
+{
+    for (size_t i = 0; i < count; ++i) {
+        TEST_ESP_OK(esp_timer_delete(timers[i]));
+    }
+    vTaskDelay(10); // wait for the esp_timer task to free the timers
+}
+
+TEST_CASE("one-shot timers run in the order of their alarms", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    create_timers(timers, NUM_TIMERS);
+    s_seed = 1;
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 1000 + test_random() % 50000));
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_args[i].expiry));
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ASSERT_EQUAL(NUM_TIMERS, s_calls);
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        const test_timer_arg_t *p_arg = &s_args[s_order[i]];
+        TEST_ASSERT_FALSE(esp_timer_is_active(timers[i]));
+        TEST_ASSERT_GREATER_OR_EQUAL_INT64(p_arg->expiry, p_arg->called_at);
+        if (i > 0) {
+            TEST_ASSERT_GREATER_OR_EQUAL_INT64(s_args[s_order[i - 1]].expiry, p_arg->expiry);
+        }
+    }
+    delete_timers(timers, NUM_TIMERS);
+}
+
+TEST_CASE("timers with equal alarms run in the order they were started", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    create_timers(timers, NUM_TIMERS);
+    // started in a tight loop, many of the timers get the same alarm
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 20000));
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_args[i].expiry));
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL(NUM_TIMERS, s_calls);
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ASSERT_EQUAL(i, s_order[i]);
+    }
+    delete_timers(timers, NUM_TIMERS);
+}
+
+TEST_CASE("stopped timers don't run", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    create_timers(timers, NUM_TIMERS);
+    s_seed = 2;
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 10000 + test_random() % 40000));
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_args[i].expiry));
+    }
+    // stop the timers with even indices, in a different order than they were started
+    for (size_t i = 0; i < NUM_TIMERS; i += 2) {
+        size_t index = (i * 7) % NUM_TIMERS;
+        TEST_ESP_OK(esp_timer_stop(timers[index]));
+        TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_timer_stop(timers[index]));
+    }
+
+    int64_t next_alarm = INT64_MAX;
+    for (size_t i = 1; i < NUM_TIMERS; i += 2) {
+        next_alarm = MIN(next_alarm, (int64_t) s_args[i].expiry);
+    }
+    TEST_ASSERT_EQUAL_INT64(next_alarm, esp_timer_get_next_alarm());
+
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ASSERT_EQUAL(NUM_TIMERS / 2, s_calls);
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ASSERT_EQUAL(i % 2 == 1, s_args[i].called_at != 0);
+    }
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, esp_timer_get_next_alarm());
+    delete_timers(timers, NUM_TIMERS);
+}
+
+TEST_CASE("restarted timers run at the new alarm", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    create_timers(timers, NUM_TIMERS);
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 20000 + i * 100));
+    }
+    // reverse the order of the timers
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_restart(timers[i], 40000 - i * 100));
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ASSERT_EQUAL(NUM_TIMERS, s_calls);
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ASSERT_EQUAL(NUM_TIMERS - 1 - i, s_order[i]);
+    }
+    delete_timers(timers, NUM_TIMERS);
+}
+
+static void create_timers_with_slack(esp_timer_handle_t *timers, size_t count, const uint32_t *slack_us)
+{
+    s_calls = 0;
+    for (size_t i = 0; i < count; ++i) {
+        s_args[i].index = i;
+        s_args[i].called_at = 0;
+        esp_timer_create_args_t args = {
+            .callback = &record_cb,
+            .arg = &s_args[i],
+            .slack_us = slack_us[i],
+        };
+        TEST_ESP_OK(esp_timer_create(&args, &timers[i]));
+    }
+}
+
+TEST_CASE("timers with slack are dispatched together", "[esp_timer]")
+{
+    const size_t num_timers = 10;
+    esp_timer_handle_t timers[num_timers];
+    uint32_t slack[num_timers];
+    for (size_t i = 0; i < num_timers; ++i) {
+        slack[i] = 20000;
+    }
+    create_timers_with_slack(timers, num_timers, slack);
+    for (size_t i = 0; i < num_timers; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 10000 + i * 1000));
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_args[i].expiry));
+    }
+    // the first timer can wait for all the others
+    TEST_ASSERT_EQUAL_INT64(s_args[0].expiry, esp_timer_get_next_alarm());
+    TEST_ASSERT_EQUAL_INT64(s_args[0].expiry + 20000, esp_timer_get_next_alarm_for_wake_up());
+
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL(num_timers, s_calls);
+    for (size_t i = 0; i < num_timers; ++i) {
+        TEST_ASSERT_EQUAL(i, s_order[i]);
+        TEST_ASSERT_GREATER_OR_EQUAL_INT64(s_args[num_timers - 1].expiry, s_args[i].called_at);
+    }
+    delete_timers(timers, num_timers);
+}
+
+TEST_CASE("timers with slack run within their window", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    uint32_t slack[NUM_TIMERS];
+    s_seed = 5;
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        slack[i] = (i % 3 == 0) ? 0 : test_random() % 20000;
+    }
+    create_timers_with_slack(timers, NUM_TIMERS, slack);
+    int64_t next_wake_up = INT64_MAX;
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 1000 + test_random() % 50000));
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_args[i].expiry));
+        next_wake_up = MIN(next_wake_up, (int64_t)(s_args[i].expiry + slack[i]));
+    }
+    TEST_ASSERT_EQUAL_INT64(next_wake_up, esp_timer_get_next_alarm_for_wake_up());
+
+    vTaskDelay(pdMS_TO_TICKS(200));
+    TEST_ASSERT_EQUAL(NUM_TIMERS, s_calls);
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        const test_timer_arg_t *p_arg = &s_args[s_order[i]];
+        TEST_ASSERT_GREATER_OR_EQUAL_INT64(p_arg->expiry, p_arg->called_at);
+        // one tick of resolution, and some time for the other callbacks and the scheduler
+        TEST_ASSERT_LESS_OR_EQUAL_INT64(p_arg->expiry + slack[s_order[i]] + 5000, p_arg->called_at);
+    }
+    delete_timers(timers, NUM_TIMERS);
+}
+
+TEST_CASE("next wake-up alarm follows the stopped timers", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    create_timers(timers, NUM_TIMERS);
+    s_seed = 6;
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 100000 + test_random() % 50000));
+        TEST_ESP_OK(esp_timer_get_expiry_time(timers[i], &s_args[i].expiry));
+    }
+    // stop the timers in a different order than they were started,
+    // the first timer to run is stopped every now and then
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        int64_t next_wake_up = INT64_MAX;
+        size_t first = 0;
+        for (size_t j = 0; j < NUM_TIMERS; ++j) {
+            if (esp_timer_is_active(timers[j]) && (int64_t) s_args[j].expiry < next_wake_up) {
+                next_wake_up = s_args[j].expiry;
+                first = j;
+            }
+        }
+        TEST_ASSERT_EQUAL_INT64(next_wake_up, esp_timer_get_next_alarm_for_wake_up());
+        size_t index = (i % 4 == 0) ? first : (i * 7) % NUM_TIMERS;
+        if (!esp_timer_is_active(timers[index])) {
+            index = first;
+        }
+        TEST_ESP_OK(esp_timer_stop(timers[index]));
+    }
+    TEST_ASSERT_EQUAL_INT64(INT64_MAX, esp_timer_get_next_alarm_for_wake_up());
+    TEST_ASSERT_EQUAL(0, s_calls);
+    delete_timers(timers, NUM_TIMERS);
+}
+
+static void count_cb(void *arg)
+{
+    (*(volatile int *) arg)++;
+}
+
+TEST_CASE("periodic timers keep running among one-shot timers", "[esp_timer]")
+{
+    esp_timer_handle_t timers[NUM_TIMERS];
+    create_timers(timers, NUM_TIMERS);
+    volatile int periodic_calls = 0;
+    esp_timer_handle_t periodic;
+    esp_timer_create_args_t args = {
+        .callback = &count_cb,
+        .arg = (void *) &periodic_calls,
+    };
+    TEST_ESP_OK(esp_timer_create(&args, &periodic));
+    TEST_ESP_OK(esp_timer_start_periodic(periodic, 10000));
+    s_seed = 3;
+    for (size_t i = 0; i < NUM_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 1000 + test_random() % 100000));
+    }
+
+    vTaskDelay(pdMS_TO_TICKS(205));
+    TEST_ESP_OK(esp_timer_stop(periodic));
+    TEST_ASSERT_EQUAL(NUM_TIMERS, s_calls);
+    TEST_ASSERT_INT_WITHIN(2, 20, periodic_calls);
+    TEST_ESP_OK(esp_timer_delete(periodic));
+    delete_timers(timers, NUM_TIMERS);
+}
+
+TEST_CASE("esp_timer insert and expiry benchmark", "[esp_timer]")
+{
+    esp_timer_handle_t *timers = calloc(BENCH_TIMERS, sizeof(esp_timer_handle_t));
+    TEST_ASSERT_NOT_NULL(timers);
+    esp_timer_create_args_t args = {
+        .callback = &bench_cb,
+    };
+    for (size_t i = 0; i < BENCH_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_create(&args, &timers[i]));
+    }
+
+    // far in the future, so that no timer expires while measuring
+    s_seed = 4;
+    int64_t start = esp_timer_get_time();
+    for (size_t i = 0; i < BENCH_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 10000000 + test_random() % 10000000));
+    }
+    int64_t start_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (size_t i = 0; i < BENCH_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_restart(timers[i], 10000000 + test_random() % 10000000));
+    }
+    int64_t restart_us = esp_timer_get_time() - start;
+
+    start = esp_timer_get_time();
+    for (size_t i = 0; i < BENCH_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_stop(timers[(i * 7) % BENCH_TIMERS]));
+    }
+    int64_t stop_us = esp_timer_get_time() - start;
+
+    // all the alarms within one tick, so that they expire in one batch
+    s_first_call = 0;
+    for (size_t i = 0; i < BENCH_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_start_once(timers[i], 20000 + test_random() % 500));
+    }
+    while (esp_timer_get_next_alarm() != INT64_MAX) {
+        vTaskDelay(1);
+    }
+    int64_t expire_us = s_last_call - s_first_call;
+
+    printf("%d timers: start %" PRIi64 " ns, restart %" PRIi64 " ns, stop %" PRIi64 " ns, expire %" PRIi64 " ns per timer\n",
+           BENCH_TIMERS, start_us * 1000 / BENCH_TIMERS, restart_us * 1000 / BENCH_TIMERS,
+           stop_us * 1000 / BENCH_TIMERS, expire_us * 1000 / BENCH_TIMERS);
+    for (size_t i = 0; i < BENCH_TIMERS; ++i) {
+        TEST_ESP_OK(esp_timer_delete(timers[i]));
+    }
+    free(timers);
+    vTaskDelay(10);
+}
+
+void app_main(void)
+{
+    printf("Running esp_timer linux host test app\n");
+    ESP_ERROR_CHECK(esp_timer_init());
+    unity_run_menu();
+}
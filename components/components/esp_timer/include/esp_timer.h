@@ -76,6 +76,9 @@ typedef struct {
     //                                !< `CONFIG_ESP_TIMER_SUPPORTS_ISR_DISPATCH_METHOD`
     const char* name;               //!< Timer name, used in esp_timer_dump() function
     bool skip_unhandled_events;     //!< Setting to skip unhandled events in light sleep for periodic timers
+    uint32_t slack_us;              //!< Time by which the callback may be delayed, so that timers expiring close
+    //                                !< together are dispatched in one pass, with one wakeup; 0 (default) dispatches
+    //                                !< the callback as soon as the timer expires
 } esp_timer_create_args_t;
 
 /**
@@ -105,6 +108,10 @@ esp_err_t esp_timer_early_init(void);
  * it allocates the timer ISR on MULTIPLE cores and
  * creates the timer task which can be run on any core.
  *
+ * @note On the Linux target, there is no startup code to call this function.
+ * Applications have to call it before creating timers; esp_timer_get_time()
+ * can be used without it.
+ *
  * @return
  *      - ESP_OK on success
  *      - ESP_ERR_NO_MEM if allocation has failed
@@ -233,6 +240,9 @@ int64_t esp_timer_get_next_alarm(void);
  * @brief Get the timestamp of the next expected timeout excluding those timers
  *        that should not interrupt light sleep (such timers have
  *        ::esp_timer_create_args_t::skip_unhandled_events enabled)
+ *
+ * The timeout of each timer is delayed by its ::esp_timer_create_args_t::slack_us.
+ *
  * @return Timestamp of the nearest timer event, in microseconds.
  *         The timebase is the same as for the values returned by esp_timer_get_time().
  */
@@ -292,6 +302,15 @@ esp_err_t esp_timer_get_expiry_time(esp_timer_handle_t timer, uint64_t *expiry);
  * - Times_skipped - number of times the callback was skipped
  * - Callback_exec_time - total time taken by callback to execute, across all calls
  *
+ * It is followed by the statistics of each dispatch method:
+ *
+ * | Dispatch | Wakeups | Callbacks | Coalesced | Lat<10us | Lat<100us | Lat<1ms | Lat<10ms | Lat>=10ms |
+ *
+ * - Wakeups — number of times expired timers were dispatched
+ * - Callbacks — number of callbacks dispatched
+ * - Coalesced — number of callbacks dispatched together with an earlier one, i.e. wakeups saved
+ * - Lat... — number of callbacks by the time from the alarm to the start of the callback
+ *
  * @param stream stream (such as stdout) to which to dump the information
  * @return
  *      - ESP_OK on success
@@ -6,10 +6,12 @@
 
 #include <sys/param.h>
 #include <string.h>
+#include <inttypes.h>
 #include "soc/soc.h"
 #include "esp_types.h"
 #include "esp_attr.h"
 #include "esp_err.h"
+#include "esp_heap_caps.h"
 #include "esp_task.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
@@ -18,7 +20,9 @@
 #include "esp_timer.h"
 #include "esp_timer_impl.h"
 #include "esp_compiler.h"
+#if !CONFIG_IDF_TARGET_LINUX
 #include "esp_private/startup_internal.h"
+#endif
 #include "esp_private/esp_timer_private.h"
 #include "esp_private/system_internal.h"
 #include "sdkconfig.h"
@@ -49,22 +53,44 @@ struct esp_timer {
         uint32_t event_id;
     };
     void* arg;
+    uint32_t slack;
 #if WITH_PROFILING
     const char* name;
     size_t times_triggered;
     size_t times_armed;
     size_t times_skipped;
     uint64_t total_callback_run_time;
-#endif // WITH_PROFILING
     LIST_ENTRY(esp_timer) list_entry;
+#endif // WITH_PROFILING
+    size_t heap_index;
+    uint32_t seq;       // order in which the timer was inserted, so that equal alarms run first come, first served
 };
 
+/* Armed timers of one dispatch method, kept in a binary min-heap ordered by alarm,
+ * then by the order of insertion. The earliest alarm is timers[0]; the children of
+ * timers[i] are timers[2i+1] and timers[2i+2].
+ * Each timer knows its position in the array, so it can be removed in O(log n).
+ */
+typedef struct {
+    esp_timer_handle_t* timers;
+    size_t count;
+    size_t capacity;
+    uint64_t alarm;         // alarm set for this heap, see timer_heap_next_alarm; UINT64_MAX if none
+    uint32_t next_seq;      // sequence number of the next inserted timer
+    bool wake_alarm_valid;  // wake_alarm is up to date, see esp_timer_get_next_alarm_for_wake_up
+    uint64_t wake_alarm;    // earliest deadline of the timers which wake up the CPU; UINT64_MAX if none
+} timer_heap_t;
+
+#define TIMER_HEAP_MIN_CAPACITY 8
+
 static inline bool is_initialized(void);
 static esp_err_t timer_insert(esp_timer_handle_t timer, bool without_update_alarm);
 static esp_err_t timer_remove(esp_timer_handle_t timer);
 static bool timer_armed(esp_timer_handle_t timer);
 static void timer_list_lock(esp_timer_dispatch_t timer_type);
 static void timer_list_unlock(esp_timer_dispatch_t timer_type);
+static esp_err_t timer_heap_reserve(void);
+static void timer_heap_release(void);
 
 #if WITH_PROFILING
 static void timer_insert_inactive(esp_timer_handle_t timer);
@@ -73,16 +99,33 @@ static void timer_remove_inactive(esp_timer_handle_t timer);
 
 __attribute__((unused)) static const char* TAG = "esp_timer";
 
-// lists of currently armed timers for two dispatch methods: ISR and TASK
-static LIST_HEAD(esp_timer_list, esp_timer) s_timers[ESP_TIMER_MAX] = {
-    [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_timers)
+// heaps of currently armed timers for two dispatch methods: ISR and TASK
+static timer_heap_t s_timers[ESP_TIMER_MAX] = {
+    [0 ...(ESP_TIMER_MAX - 1)] = { .alarm = UINT64_MAX, .wake_alarm_valid = true, .wake_alarm = UINT64_MAX }
 };
+
+// number of timers which were created and not freed yet.
+// Every heap has room for all of them, so arming a timer never allocates memory.
+// Protected by s_timer_lock[ESP_TIMER_TASK].
+static size_t s_timer_count;
 #if WITH_PROFILING
 // lists of unarmed timers for two dispatch methods: ISR and TASK,
 // used only to be able to dump statistics about all the timers
 static LIST_HEAD(esp_inactive_timer_list, esp_timer) s_inactive_timers[ESP_TIMER_MAX] = {
     [0 ...(ESP_TIMER_MAX - 1)] = LIST_HEAD_INITIALIZER(s_timers)
 };
+
+// Limits of the callback latency ranges: <10 us, <100 us, <1 ms, <10 ms, >=10 ms
+#define LATENCY_RANGES 5
+
+// statistics of the timer_process_alarm passes for two dispatch methods: ISR and TASK
+typedef struct {
+    size_t wakeups;                     // passes which ran at least one callback
+    size_t callbacks;                   // callbacks run, callbacks - wakeups were coalesced with others
+    size_t latency[LATENCY_RANGES];     // number of callbacks by the time between their alarm and the call
+} dispatch_stats_t;
+
+static dispatch_stats_t s_dispatch_stats[ESP_TIMER_MAX];
 #endif
 // task used to dispatch timer callbacks
 static TaskHandle_t s_timer_task;
@@ -111,8 +154,13 @@ esp_err_t esp_timer_create(const esp_timer_create_args_t* args,
     if (result == NULL) {
         return ESP_ERR_NO_MEM;
     }
+    if (timer_heap_reserve() != ESP_OK) {
+        free(result);
+        return ESP_ERR_NO_MEM;
+    }
     result->callback = args->callback;
     result->arg = args->arg;
+    result->slack = args->slack_us;
     result->flags = (args->dispatch_method ? FL_ISR_DISPATCH_METHOD : 0) |
                     (args->skip_unhandled_events ? FL_SKIP_UNHANDLED_EVENTS : 0);
 #if WITH_PROFILING
@@ -150,8 +198,8 @@ esp_err_t ESP_TIMER_IRAM_ATTR esp_timer_restart(esp_timer_handle_t timer, uint64
     const int64_t now = esp_timer_impl_get_time();
     const uint64_t period = timer->period;
 
-    /* We need to remove the timer to the list of timers and reinsert it at
-     * the right position. In fact, the timers are sorted by their alarm value
+    /* We need to remove the timer from the heap of timers and reinsert it at
+     * the right position. In fact, the timers are ordered by their alarm value
      * (earliest first) */
     ret = timer_remove(timer);
 
@@ -278,8 +326,8 @@ esp_err_t esp_timer_delete(esp_timer_handle_t timer)
         err = ESP_ERR_INVALID_STATE;
     } else {
         // A case for the timer with ESP_TIMER_ISR:
-        // This ISR timer was removed from the ISR list in esp_timer_stop() or in timer_process_alarm() -> LIST_REMOVE(it, list_entry)
-        // and here this timer will be added to another the TASK list, see below.
+        // This ISR timer was removed from the ISR heap in esp_timer_stop() or in timer_process_alarm() -> timer_heap_remove()
+        // and here this timer will be added to the TASK heap, see below.
         // We do this because we want to free memory of the timer in a task context instead of an isr context.
         timer->flags &= ~FL_ISR_DISPATCH_METHOD;
         timer->event_id = EVENT_ID_DELETE_TIMER;
@@ -291,30 +339,193 @@ esp_err_t esp_timer_delete(esp_timer_handle_t timer)
     return err;
 }
 
-static ESP_TIMER_IRAM_ATTR esp_err_t timer_insert(esp_timer_handle_t timer, bool without_update_alarm)
+static ESP_TIMER_IRAM_ATTR uint64_t timer_deadline(esp_timer_handle_t timer)
 {
-#if WITH_PROFILING
-    timer_remove_inactive(timer);
-#endif
-    esp_timer_handle_t it, last = NULL;
-    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
-    if (LIST_FIRST(&s_timers[dispatch_method]) == NULL) {
-        LIST_INSERT_HEAD(&s_timers[dispatch_method], timer, list_entry);
+    return timer->alarm + timer->slack;
+}
+
+static ESP_TIMER_IRAM_ATTR void timer_heap_place(timer_heap_t* heap, esp_timer_handle_t timer, size_t index)
+{
+    heap->timers[index] = timer;
+    timer->heap_index = index;
+}
+
+/* Returns true if timer a has to run before timer b.
+ * Timers with equal alarms run in the order they were armed, as they did when
+ * the armed timers were kept in a sorted list.
+ */
+static ESP_TIMER_IRAM_ATTR bool timer_before(esp_timer_handle_t a, esp_timer_handle_t b)
+{
+    if (a->alarm != b->alarm) {
+        return a->alarm < b->alarm;
+    }
+    return (int32_t)(a->seq - b->seq) < 0;
+}
+
+static ESP_TIMER_IRAM_ATTR void timer_heap_sift_up(timer_heap_t* heap, esp_timer_handle_t timer, size_t index)
+{
+    while (index > 0) {
+        size_t parent = (index - 1) / 2;
+        if (!timer_before(timer, heap->timers[parent])) {
+            break;
+        }
+        timer_heap_place(heap, heap->timers[parent], index);
+        index = parent;
+    }
+    timer_heap_place(heap, timer, index);
+}
+
+static ESP_TIMER_IRAM_ATTR void timer_heap_sift_down(timer_heap_t* heap, esp_timer_handle_t timer, size_t index)
+{
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child >= heap->count) {
+            break;
+        }
+        if (child + 1 < heap->count && timer_before(heap->timers[child + 1], heap->timers[child])) {
+            ++child;
+        }
+        if (!timer_before(heap->timers[child], timer)) {
+            break;
+        }
+        timer_heap_place(heap, heap->timers[child], index);
+        index = child;
+    }
+    timer_heap_place(heap, timer, index);
+}
+
+static ESP_TIMER_IRAM_ATTR void timer_heap_remove(timer_heap_t* heap, size_t index)
+{
+    esp_timer_handle_t removed = heap->timers[index];
+    if (heap->wake_alarm_valid && (removed->flags & FL_SKIP_UNHANDLED_EVENTS) == 0 &&
+            timer_deadline(removed) == heap->wake_alarm) {
+        // Another timer may have the same deadline, it is only known after a full scan
+        heap->wake_alarm_valid = false;
+    }
+    esp_timer_handle_t last = heap->timers[--heap->count];
+    if (index == heap->count) {
+        return;
+    }
+    // Put the last timer into the gap and move it up or down to restore the heap order
+    if (index > 0 && timer_before(last, heap->timers[(index - 1) / 2])) {
+        timer_heap_sift_up(heap, last, index);
     } else {
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            if (timer->alarm < it->alarm) {
-                LIST_INSERT_BEFORE(it, timer, list_entry);
+        timer_heap_sift_down(heap, last, index);
+    }
+}
+
+/* Makes sure that the heaps of all dispatch methods have room for every timer,
+ * including the one being created. ISR timers are moved to the TASK heap by
+ * esp_timer_delete, so each heap has to be able to hold all of them.
+ * Called from esp_timer_create only, allocates outside of the critical sections.
+ */
+static esp_err_t timer_heap_reserve(void)
+{
+    timer_list_lock(ESP_TIMER_TASK);
+    size_t required = ++s_timer_count;
+    timer_list_unlock(ESP_TIMER_TASK);
+
+    for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
+        timer_heap_t* heap = &s_timers[dispatch_method];
+        while (true) {
+            timer_list_lock(dispatch_method);
+            size_t capacity = heap->capacity;
+            timer_list_unlock(dispatch_method);
+            if (capacity >= required) {
                 break;
             }
-            last = it;
+            size_t new_capacity = MAX(MAX(capacity * 2, required), TIMER_HEAP_MIN_CAPACITY);
+            esp_timer_handle_t* timers = heap_caps_malloc(new_capacity * sizeof(*timers), MALLOC_CAP_8BIT | MALLOC_CAP_INTERNAL);
+            if (timers == NULL) {
+                timer_heap_release();
+                return ESP_ERR_NO_MEM;
+            }
+            timer_list_lock(dispatch_method);
+            // Another task may have grown the heap in the meantime
+            if (heap->capacity < new_capacity) {
+                if (heap->count > 0) {
+                    memcpy(timers, heap->timers, heap->count * sizeof(*timers));
+                }
+                esp_timer_handle_t* old_timers = heap->timers;
+                heap->timers = timers;
+                heap->capacity = new_capacity;
+                timers = old_timers;
+            }
+            timer_list_unlock(dispatch_method);
+            free(timers);
         }
-        if (it == NULL) {
-            assert(last);
-            LIST_INSERT_AFTER(last, timer, list_entry);
+    }
+    return ESP_OK;
+}
+
+static void timer_heap_release(void)
+{
+    timer_list_lock(ESP_TIMER_TASK);
+    --s_timer_count;
+    timer_list_unlock(ESP_TIMER_TASK);
+}
+
+/* Returns the time when the timers at the start of the heap have to run.
+ *
+ * The first timer may be delayed by its slack, so that the following timers
+ * are run in the same pass, unless one of them has to run earlier. Only timers
+ * with an alarm before that time need to be checked. They form a subtree at the
+ * root of the heap, which is walked here without recursion.
+ * Without slack, this is the alarm of the first timer.
+ */
+static ESP_TIMER_IRAM_ATTR uint64_t timer_heap_next_alarm(const timer_heap_t* heap)
+{
+    if (heap->count == 0) {
+        return UINT64_MAX;
+    }
+    esp_timer_handle_t* timers = heap->timers;
+    uint64_t next_alarm = timer_deadline(timers[0]);
+    size_t index = 0;
+    while (true) {
+        size_t child = 2 * index + 1;
+        if (child < heap->count && timers[child]->alarm < next_alarm) {
+            index = child;
+        } else if (child + 1 < heap->count && timers[child + 1]->alarm < next_alarm) {
+            index = child + 1;
+        } else {
+            // Go up until there is a right sibling which was not visited yet
+            while (index > 0 && !(index % 2 == 1 && index + 1 < heap->count && timers[index + 1]->alarm < next_alarm)) {
+                index = (index - 1) / 2;
+            }
+            if (index == 0) {
+                break;
+            }
+            ++index;
         }
+        next_alarm = MIN(next_alarm, timer_deadline(timers[index]));
     }
-    if (without_update_alarm == false && timer == LIST_FIRST(&s_timers[dispatch_method])) {
-        esp_timer_impl_set_alarm_id(timer->alarm, dispatch_method);
+    return next_alarm;
+}
+
+static ESP_TIMER_IRAM_ATTR void timer_heap_set_alarm(esp_timer_dispatch_t dispatch_method, uint64_t alarm)
+{
+    s_timers[dispatch_method].alarm = alarm;
+    esp_timer_impl_set_alarm_id(alarm, dispatch_method);
+}
+
+static ESP_TIMER_IRAM_ATTR esp_err_t timer_insert(esp_timer_handle_t timer, bool without_update_alarm)
+{
+#if WITH_PROFILING
+    timer_remove_inactive(timer);
+#endif
+    esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
+    timer_heap_t* heap = &s_timers[dispatch_method];
+    // timer_heap_reserve has made room for all the existing timers
+    assert(heap->count < heap->capacity);
+    timer->seq = heap->next_seq++;
+    ++heap->count;
+    timer_heap_sift_up(heap, timer, heap->count - 1);
+    if (heap->wake_alarm_valid && (timer->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
+        heap->wake_alarm = MIN(heap->wake_alarm, timer_deadline(timer));
+    }
+    // The alarm only moves if this timer has to run before the timers already in the heap
+    if (without_update_alarm == false && timer_deadline(timer) < heap->alarm) {
+        timer_heap_set_alarm(dispatch_method, timer_deadline(timer));
     }
     return ESP_OK;
 }
@@ -323,17 +534,15 @@ static ESP_TIMER_IRAM_ATTR esp_err_t timer_remove(esp_timer_handle_t timer)
 {
     esp_timer_dispatch_t dispatch_method = timer->flags & FL_ISR_DISPATCH_METHOD;
     timer_list_lock(dispatch_method);
-    esp_timer_handle_t first_timer = LIST_FIRST(&s_timers[dispatch_method]);
-    LIST_REMOVE(timer, list_entry);
+    timer_heap_t* heap = &s_timers[dispatch_method];
+    size_t index = timer->heap_index;
+    uint64_t deadline = timer_deadline(timer);
+    timer_heap_remove(heap, index);
     timer->alarm = 0;
     timer->period = 0;
-    if (timer == first_timer) { // if this timer was the first in the list.
-        uint64_t next_timestamp = UINT64_MAX;
-        first_timer = LIST_FIRST(&s_timers[dispatch_method]);
-        if (first_timer) { // if after removing the timer from the list, this list is not empty.
-            next_timestamp = first_timer->alarm;
-        }
-        esp_timer_impl_set_alarm_id(next_timestamp, dispatch_method);
+    // if this timer was the first in the heap, or the alarm was set for it
+    if (index == 0 || deadline == heap->alarm) {
+        timer_heap_set_alarm(dispatch_method, timer_heap_next_alarm(heap));
     }
 #if WITH_PROFILING
     timer_insert_inactive(timer);
@@ -390,10 +599,15 @@ static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
 #endif
 {
     timer_list_lock(dispatch_method);
+    timer_heap_t* heap = &s_timers[dispatch_method];
     bool processed = false;
+#if WITH_PROFILING
+    // passes which only freed deleted timers are not counted as wakeups
+    bool callbacks_run = false;
+#endif
     esp_timer_handle_t it;
     while (1) {
-        it = LIST_FIRST(&s_timers[dispatch_method]);
+        it = (heap->count > 0) ? heap->timers[0] : NULL;
         int64_t now = esp_timer_impl_get_time();
         ESP_COMPILER_DIAGNOSTIC_PUSH_IGNORE("-Wanalyzer-use-after-free") // False-positive detection. TODO GCC-366
         if (it == NULL || it->alarm > now) {
@@ -401,14 +615,26 @@ static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
         }
         ESP_COMPILER_DIAGNOSTIC_POP("-Wanalyzer-use-after-free")
         processed = true;
-        LIST_REMOVE(it, list_entry);
+        timer_heap_remove(heap, 0);
         if (it->event_id == EVENT_ID_DELETE_TIMER) {
             // It is handled only by ESP_TIMER_TASK (see esp_timer_delete()).
-            // All the ESP_TIMER_ISR timers which should be deleted are moved by esp_timer_delete() to the ESP_TIMER_TASK list.
+            // All the ESP_TIMER_ISR timers which should be deleted are moved by esp_timer_delete() to the ESP_TIMER_TASK heap.
             // We want to free memory of the timer in a task context instead of an isr context.
             free(it);
             it = NULL;
+            // s_timer_count is protected by the ESP_TIMER_TASK lock, which is held here
+            --s_timer_count;
         } else {
+#if WITH_PROFILING
+            dispatch_stats_t* stats = &s_dispatch_stats[dispatch_method];
+            size_t range = 0;
+            for (int64_t limit = 10; range < LATENCY_RANGES - 1 && now - (int64_t) it->alarm >= limit; limit *= 10) {
+                ++range;
+            }
+            ++stats->latency[range];
+            ++stats->callbacks;
+            callbacks_run = true;
+#endif
             if (it->period > 0) {
                 int skipped = (now - it->alarm) / it->period;
                 if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) && (skipped > 1)) {
@@ -440,13 +666,18 @@ static bool timer_process_alarm(esp_timer_dispatch_t dispatch_method)
 #endif
         }
     } // while(1)
+#if WITH_PROFILING
+    if (callbacks_run) {
+        s_dispatch_stats[dispatch_method].wakeups++;
+    }
+#endif
     if (it) {
         if (dispatch_method == ESP_TIMER_TASK || (dispatch_method != ESP_TIMER_TASK && processed == true)) {
-            esp_timer_impl_set_alarm_id(it->alarm, dispatch_method);
+            timer_heap_set_alarm(dispatch_method, timer_heap_next_alarm(heap));
         }
     } else {
         if (processed) {
-            esp_timer_impl_set_alarm_id(UINT64_MAX, dispatch_method);
+            timer_heap_set_alarm(dispatch_method, UINT64_MAX);
         }
     }
     timer_list_unlock(dispatch_method);
@@ -486,9 +717,7 @@ static void ESP_TIMER_IRAM_ATTR timer_alarm_handler(void* arg)
     if (isr_timers_processed == false) {
         vTaskNotifyGiveFromISR(s_timer_task, &xHigherPriorityTaskWoken);
     }
-    if (xHigherPriorityTaskWoken == pdTRUE) {
-        portYIELD_FROM_ISR();
-    }
+    portYIELD_FROM_ISR(xHigherPriorityTaskWoken);
 }
 
 static ESP_TIMER_IRAM_ATTR inline bool is_initialized(void)
@@ -547,6 +776,7 @@ esp_err_t esp_timer_init(void)
     return err;
 }
 
+#if !CONFIG_IDF_TARGET_LINUX
 #if CONFIG_ESP_TIMER_ISR_AFFINITY_CPU0
 #define ESP_TIMER_INIT_MASK BIT(0)
 #elif CONFIG_ESP_TIMER_ISR_AFFINITY_CPU1
@@ -566,6 +796,7 @@ ESP_SYSTEM_INIT_FN(esp_timer_init_os, SECONDARY, ESP_TIMER_INIT_MASK, 100)
 {
     return esp_timer_init();
 }
+#endif // !CONFIG_IDF_TARGET_LINUX
 
 esp_err_t esp_timer_deinit(void)
 {
@@ -575,7 +806,7 @@ esp_err_t esp_timer_deinit(void)
 
     /* Check if there are any active timers */
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
-        if (!LIST_EMPTY(&s_timers[dispatch_method])) {
+        if (s_timers[dispatch_method].count != 0) {
             return ESP_ERR_INVALID_STATE;
         }
     }
@@ -593,10 +824,23 @@ esp_err_t esp_timer_deinit(void)
 
     esp_timer_impl_deinit();
     deinit_timer_task();
+
+    /* The heaps are empty, they grow again when timers are created */
+    for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
+        free(s_timers[dispatch_method].timers);
+        s_timers[dispatch_method].timers = NULL;
+        s_timers[dispatch_method].capacity = 0;
+        s_timers[dispatch_method].alarm = UINT64_MAX;
+        s_timers[dispatch_method].wake_alarm_valid = true;
+        s_timers[dispatch_method].wake_alarm = UINT64_MAX;
+    }
     return ESP_OK;
 }
 
-static void print_timer_info(esp_timer_handle_t t, char** dst, size_t* dst_size)
+/* Prints the fields of timer t. They may be a copy of the timer,
+ * so its address is passed separately in handle.
+ */
+static void print_timer_info(const struct esp_timer* t, esp_timer_handle_t handle, char** dst, size_t* dst_size)
 {
 #if WITH_PROFILING
     size_t cb;
@@ -604,22 +848,40 @@ static void print_timer_info(esp_timer_handle_t t, char** dst, size_t* dst_size)
     if (t->name) {
         cb = snprintf(*dst, *dst_size, "%-20.20s  ", t->name);
     } else {
-        cb = snprintf(*dst, *dst_size, "timer@%-10p  ", t);
+        cb = snprintf(*dst, *dst_size, "timer@%-10p  ", handle);
     }
 
-    cb += snprintf(*dst + cb, *dst_size - cb, "%-10lld  %-12lld  %-12d  %-12d  %-12d  %-12lld\n",
-                   (uint64_t)t->period, t->alarm, t->times_armed,
-                   t->times_triggered, t->times_skipped, t->total_callback_run_time);
+    cb += snprintf(*dst + cb, *dst_size - cb, "%-10" PRIu64 "  %-12" PRIu64 "  %-12u  %-12u  %-12u  %-12" PRIu64 "\n",
+                   (uint64_t)t->period, t->alarm, (unsigned) t->times_armed,
+                   (unsigned) t->times_triggered, (unsigned) t->times_skipped, t->total_callback_run_time);
     /* keep this in sync with the format string, used in esp_timer_dump */
 #define TIMER_INFO_LINE_LEN 103
 #else
-    size_t cb = snprintf(*dst, *dst_size, "timer@%-14p  %-10lld  %-12lld\n", t, (uint64_t)t->period, t->alarm);
+    size_t cb = snprintf(*dst, *dst_size, "timer@%-14p  %-10" PRIu64 "  %-12" PRIu64 "\n", handle, (uint64_t)t->period, t->alarm);
 #define TIMER_INFO_LINE_LEN 47
 #endif
     *dst += cb;
     *dst_size -= cb;
 }
 
+/* Copy of an armed timer, taken by esp_timer_dump so that it can be sorted outside of the critical section */
+typedef struct {
+    esp_timer_handle_t handle;
+    struct esp_timer timer;
+} timer_snapshot_t;
+
+static int timer_compare_alarm(const void* a, const void* b)
+{
+    const struct esp_timer* timer_a = &((const timer_snapshot_t*) a)->timer;
+    const struct esp_timer* timer_b = &((const timer_snapshot_t*) b)->timer;
+    if (timer_a->alarm != timer_b->alarm) {
+        return (timer_a->alarm > timer_b->alarm) ? 1 : -1;
+    }
+    // same order as in the heap, see timer_before
+    int32_t seq_diff = (int32_t)(timer_a->seq - timer_b->seq);
+    return (seq_diff > 0) - (seq_diff < 0);
+}
+
 esp_err_t esp_timer_dump(FILE* stream)
 {
     /* Since timer lock is a critical section, we don't want to print directly
@@ -628,15 +890,15 @@ esp_err_t esp_timer_dump(FILE* stream)
      * print to it, then dump this memory to stdout.
      */
 
+#if WITH_PROFILING
     esp_timer_handle_t it;
+#endif
 
     /* First count the number of timers */
     size_t timer_count = 0;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            ++timer_count;
-        }
+        timer_count += s_timers[dispatch_method].count;
 #if WITH_PROFILING
         LIST_FOREACH(it, &s_inactive_timers[dispatch_method], list_entry) {
             ++timer_count;
@@ -652,7 +914,13 @@ esp_err_t esp_timer_dump(FILE* stream)
      */
     size_t buf_size = TIMER_INFO_LINE_LEN * (timer_count + 3);
     char* print_buf = calloc(1, buf_size + 1);
-    if (print_buf == NULL) {
+    /* Armed timers are printed in the order of their alarms. They are copied to this array
+     * in the critical section and sorted after it. */
+    size_t sorted_size = timer_count + 3;
+    timer_snapshot_t* sorted = calloc(sorted_size, sizeof(*sorted));
+    if (print_buf == NULL || sorted == NULL) {
+        free(print_buf);
+        free(sorted);
         return ESP_ERR_NO_MEM;
     }
 
@@ -660,15 +928,24 @@ esp_err_t esp_timer_dump(FILE* stream)
     char* pos = print_buf;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            print_timer_info(it, &pos, &buf_size);
+        size_t sorted_count = MIN(s_timers[dispatch_method].count, sorted_size);
+        for (size_t i = 0; i < sorted_count; ++i) {
+            sorted[i].handle = s_timers[dispatch_method].timers[i];
+            sorted[i].timer = *sorted[i].handle;
+        }
+        timer_list_unlock(dispatch_method);
+
+        qsort(sorted, sorted_count, sizeof(*sorted), timer_compare_alarm);
+        for (size_t i = 0; i < sorted_count; ++i) {
+            print_timer_info(&sorted[i].timer, sorted[i].handle, &pos, &buf_size);
         }
 #if WITH_PROFILING
+        timer_list_lock(dispatch_method);
         LIST_FOREACH(it, &s_inactive_timers[dispatch_method], list_entry) {
-            print_timer_info(it, &pos, &buf_size);
+            print_timer_info(it, it, &pos, &buf_size);
         }
-#endif
         timer_list_unlock(dispatch_method);
+#endif
     }
 
     if (stream != NULL) {
@@ -682,8 +959,25 @@ esp_err_t esp_timer_dump(FILE* stream)
 
         /* Print the buffer */
         fputs(print_buf, stream);
+
+#if WITH_PROFILING
+        fprintf(stream, "%-8s  %-10s  %-10s  %-10s  %-10s  %-10s  %-10s  %-10s  %-10s\n",
+                "Dispatch", "Wakeups", "Callbacks", "Coalesced", "Lat<10us", "Lat<100us", "Lat<1ms", "Lat<10ms", "Lat>=10ms");
+        for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
+            timer_list_lock(dispatch_method);
+            dispatch_stats_t stats = s_dispatch_stats[dispatch_method];
+            timer_list_unlock(dispatch_method);
+            fprintf(stream, "%-8s  %-10u  %-10u  %-10u", (dispatch_method == ESP_TIMER_TASK) ? "task" : "isr",
+                    (unsigned) stats.wakeups, (unsigned) stats.callbacks, (unsigned) (stats.callbacks - stats.wakeups));
+            for (size_t i = 0; i < LATENCY_RANGES; ++i) {
+                fprintf(stream, "  %-10u", (unsigned) stats.latency[i]);
+            }
+            fprintf(stream, "\n");
+        }
+#endif
     }
 
+    free(sorted);
     free(print_buf);
     return ESP_OK;
 }
@@ -693,8 +987,8 @@ int64_t ESP_TIMER_IRAM_ATTR esp_timer_get_next_alarm(void)
     int64_t next_alarm = INT64_MAX;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        esp_timer_handle_t it = LIST_FIRST(&s_timers[dispatch_method]);
-        if (it) {
+        if (s_timers[dispatch_method].count > 0) {
+            esp_timer_handle_t it = s_timers[dispatch_method].timers[0];
             if (next_alarm > it->alarm) {
                 next_alarm = it->alarm;
             }
@@ -709,15 +1003,24 @@ int64_t ESP_TIMER_IRAM_ATTR esp_timer_get_next_alarm_for_wake_up(void)
     int64_t next_alarm = INT64_MAX;
     for (esp_timer_dispatch_t dispatch_method = ESP_TIMER_TASK; dispatch_method < ESP_TIMER_MAX; ++dispatch_method) {
         timer_list_lock(dispatch_method);
-        esp_timer_handle_t it = NULL;
-        LIST_FOREACH(it, &s_timers[dispatch_method], list_entry) {
-            // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
-            if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
-                if (next_alarm > it->alarm) {
-                    next_alarm = it->alarm;
+        timer_heap_t* heap = &s_timers[dispatch_method];
+        // The heap is only ordered along its paths, so all the timers have to be checked.
+        // The result is kept until the timer it came from is removed from the heap.
+        if (!heap->wake_alarm_valid) {
+            uint64_t wake_alarm = UINT64_MAX;
+            for (size_t i = 0; i < heap->count; ++i) {
+                esp_timer_handle_t it = heap->timers[i];
+                // timers with the SKIP_UNHANDLED_EVENTS flag do not want to wake up CPU from a sleep mode.
+                // the wake up may be delayed by the slack of the timer
+                if ((it->flags & FL_SKIP_UNHANDLED_EVENTS) == 0) {
+                    wake_alarm = MIN(wake_alarm, timer_deadline(it));
                 }
-                break;
             }
+            heap->wake_alarm = wake_alarm;
+            heap->wake_alarm_valid = true;
+        }
+        if (next_alarm > heap->wake_alarm) {
+            next_alarm = heap->wake_alarm;
         }
         timer_list_unlock(dispatch_method);
     }
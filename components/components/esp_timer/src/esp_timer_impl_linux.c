@@ -0,0 +1,205 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <time.h>
+#include <sys/param.h>
+#include "sdkconfig.h"
+#include "esp_timer_impl.h"
+#include "esp_err.h"
+#include "esp_timer.h"
+#include "esp_task.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+
+/**
+ * @file esp_timer_impl_linux.c
+ * @brief Implementation of esp_timer for the Linux target.
+ *
+ * Time is counted by CLOCK_MONOTONIC. There is no timer interrupt on Linux, so a task
+ * with the highest FreeRTOS priority takes its place: it blocks until the alarm and
+ * calls the handler of the upper layer once the alarm has expired. It is notified when
+ * the alarm is moved to an earlier time or the time is changed. Like the hardware alarm,
+ * it fires once and has to be set again by the upper layer.
+ * Alarms are handled with a resolution of one FreeRTOS tick, the wait is rounded up.
+ */
+
+static const char *TAG = "esp_timer_linux";
+
+/* Function from the upper layer to be called when the alarm expires.
+ * Registered in esp_timer_impl_init.
+ */
+static intr_handler_t s_alarm_handler = NULL;
+
+/* Task which calls s_alarm_handler, in place of the timer interrupt */
+static TaskHandle_t s_alarm_task = NULL;
+
+/* Value of CLOCK_MONOTONIC when the application started, in microseconds */
+static int64_t s_time_origin_us;
+
+/* Adjustment applied by esp_timer_impl_advance and esp_timer_impl_set */
+static int64_t s_time_offset_us;
+
+/* Earliest of timestamp_id, UINT64_MAX once it has fired */
+static uint64_t s_alarm = UINT64_MAX;
+
+/* Time until which the alarm task waits, UINT64_MAX if it waits for a notification only */
+static uint64_t s_alarm_task_wait_until = UINT64_MAX;
+
+/* Spinlock used to protect access to the alarm and time offset. */
+extern portMUX_TYPE s_time_update_lock;
+
+/* Alarm values to generate interrupt on match */
+extern uint64_t timestamp_id[2];
+
+static int64_t monotonic_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+uint64_t esp_timer_impl_get_counter_reg(void)
+{
+    return monotonic_time_us() - s_time_origin_us;
+}
+
+int64_t esp_timer_impl_get_time(void)
+{
+    return monotonic_time_us() - s_time_origin_us + s_time_offset_us;
+}
+
+int64_t esp_timer_get_time(void)
+{
+    return esp_timer_impl_get_time();
+}
+
+/* Makes the alarm task check the alarm again, as if its wait had timed out */
+static void wake_alarm_task(void)
+{
+    if (s_alarm_task != NULL) {
+        xTaskNotifyGive(s_alarm_task);
+    }
+}
+
+void esp_timer_impl_set_alarm_id(uint64_t timestamp, unsigned alarm_id)
+{
+    assert(alarm_id < sizeof(timestamp_id) / sizeof(timestamp_id[0]));
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    timestamp_id[alarm_id] = timestamp;
+    s_alarm = MIN(timestamp_id[0], timestamp_id[1]);
+    // A later alarm is found when the task wakes up, as is an alarm less than a tick before that
+    if (s_alarm != UINT64_MAX && s_alarm + portTICK_PERIOD_MS * 1000 < s_alarm_task_wait_until) {
+        s_alarm_task_wait_until = 0;
+        wake_alarm_task();
+    }
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+}
+
+static void alarm_task(void *arg)
+{
+    const uint64_t tick_us = portTICK_PERIOD_MS * 1000;
+    while (true) {
+        bool expired = false;
+        TickType_t wait_ticks = portMAX_DELAY;
+        portENTER_CRITICAL(&s_time_update_lock);
+        uint64_t now = esp_timer_impl_get_time();
+        s_alarm_task_wait_until = UINT64_MAX;
+        if (s_alarm != UINT64_MAX) {
+            if (s_alarm <= now) {
+                s_alarm = UINT64_MAX;
+                expired = true;
+                // esp_timer_impl_set_alarm_id must not wake up the task while it runs the handler
+                s_alarm_task_wait_until = 0;
+            } else {
+                wait_ticks = MIN((s_alarm - now + tick_us - 1) / tick_us, portMAX_DELAY - 1);
+                s_alarm_task_wait_until = now + wait_ticks * tick_us;
+            }
+        }
+        portEXIT_CRITICAL(&s_time_update_lock);
+        if (expired) {
+            (*s_alarm_handler)(NULL);
+        } else {
+            // A notification given since the alarm was read ends the wait at once
+            ulTaskNotifyTake(pdTRUE, wait_ticks);
+        }
+    }
+}
+
+void esp_timer_impl_set(uint64_t new_us)
+{
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    s_time_offset_us = (int64_t)new_us - (monotonic_time_us() - s_time_origin_us);
+    wake_alarm_task();
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+}
+
+void esp_timer_impl_advance(int64_t time_diff_us)
+{
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    s_time_offset_us += time_diff_us;
+    wake_alarm_task();
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+}
+
+esp_err_t esp_timer_impl_early_init(void)
+{
+    s_time_origin_us = monotonic_time_us();
+    return ESP_OK;
+}
+
+/* Start counting the time when the application starts, as on the chips */
+__attribute__((constructor)) static void esp_timer_impl_linux_early_init(void)
+{
+    esp_timer_impl_early_init();
+}
+
+esp_err_t esp_timer_impl_init(intr_handler_t alarm_handler)
+{
+    if (s_alarm_task != NULL) {
+        ESP_EARLY_LOGE(TAG, "alarm task is already initialized");
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    s_alarm_handler = alarm_handler;
+    if (xTaskCreate(&alarm_task, "esp_timer_alarm", ESP_TASK_TIMER_STACK, NULL,
+                    configMAX_PRIORITIES - 1, &s_alarm_task) != pdPASS) {
+        ESP_EARLY_LOGE(TAG, "Not enough memory to create alarm task");
+        s_alarm_handler = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+void esp_timer_impl_deinit(void)
+{
+    if (s_alarm_task != NULL) {
+        vTaskDelete(s_alarm_task);
+        s_alarm_task = NULL;
+    }
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    s_alarm = UINT64_MAX;
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+    s_alarm_handler = NULL;
+}
+
+uint64_t esp_timer_impl_get_alarm_reg(void)
+{
+    portENTER_CRITICAL_SAFE(&s_time_update_lock);
+    uint64_t val = s_alarm;
+    portEXIT_CRITICAL_SAFE(&s_time_update_lock);
+    return val;
+}
+
+void esp_timer_private_set(uint64_t new_us)
+{
+    esp_timer_impl_set(new_us);
+}
+
+void esp_timer_private_advance(int64_t time_diff_us)
+{
+    esp_timer_impl_advance(time_diff_us);
+}
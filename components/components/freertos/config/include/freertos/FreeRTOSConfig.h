@@ -239,6 +239,10 @@
         #undef INLINE /* to avoid redefinition */
     #endif /* CONFIG_SYSVIEW_ENABLE */
 
+    #if CONFIG_APPTRACE_METRICS_TASK_SWITCHES
+        #include "esp_app_trace_metrics_freertos.h"
+    #endif /* CONFIG_APPTRACE_METRICS_TASK_SWITCHES */
+
     #if CONFIG_FREERTOS_SMP
 
 /* Default values for trace macros added to ESP-IDF implementation of SYSVIEW
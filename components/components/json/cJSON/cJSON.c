@@ -237,6 +237,195 @@ CJSON_PUBLIC(void) cJSON_InitHooks(cJSON_Hooks* hooks)
     }
 }
 
+/* Arena allocator for cJSON_ParseWithArena.
+ * Items and strings are carved out of blocks with a bump pointer, and are only
+ * released all at once by cJSON_ResetArena or cJSON_DeleteArena. */
+typedef struct arena_block
+{
+    struct arena_block *next;
+    size_t size; /* usable bytes after the header */
+} arena_block;
+
+struct cJSON_Arena
+{
+    arena_block *blocks; /* blocks allocated through the hooks, most recent first; NULL for a fixed arena */
+    unsigned char *start; /* start of the usable memory of a fixed arena */
+    unsigned char *pointer; /* next free byte */
+    unsigned char *end; /* end of the current block */
+    size_t block_size; /* size of new blocks, 0 if the arena can't grow */
+    size_t used; /* bytes handed out since the arena was created or reset */
+    internal_hooks hooks;
+};
+
+/* strictest alignment needed by a cJSON item */
+typedef union
+{
+    double number;
+    void *pointer;
+    size_t size;
+} arena_align;
+#define arena_alignment sizeof(arena_align)
+#define arena_align_up(pointer) ((unsigned char*)(((size_t)(pointer) + (arena_alignment - 1)) & ~(size_t)(arena_alignment - 1)))
+
+#ifndef CJSON_ARENA_DEFAULT_BLOCK_SIZE
+#define CJSON_ARENA_DEFAULT_BLOCK_SIZE 4096
+#endif
+
+static unsigned char *arena_block_data(arena_block * const block)
+{
+    return arena_align_up((unsigned char*)block + sizeof(arena_block));
+}
+
+static void *arena_allocate(cJSON_Arena * const arena, size_t size, cJSON_bool aligned)
+{
+    unsigned char *pointer = arena->pointer;
+    arena_block *block = NULL;
+    size_t block_size = 0;
+
+    if ((pointer != NULL) && aligned)
+    {
+        pointer = arena_align_up(pointer);
+    }
+    if ((pointer != NULL) && (pointer <= arena->end) && ((size_t)(arena->end - pointer) >= size))
+    {
+        arena->pointer = pointer + size;
+        arena->used += size;
+        return pointer;
+    }
+
+    if (arena->block_size == 0)
+    {
+        return NULL; /* fixed arena is exhausted */
+    }
+
+    /* oversized requests get a block of their own, so the current block can still be used */
+    block_size = (size > arena->block_size) ? size : arena->block_size;
+    block = (arena_block*)arena->hooks.allocate(sizeof(arena_block) + arena_alignment + block_size);
+    if (block == NULL)
+    {
+        return NULL;
+    }
+    block->size = block_size;
+    pointer = arena_block_data(block);
+
+    if ((size > arena->block_size) && (arena->blocks != NULL))
+    {
+        block->next = arena->blocks->next;
+        arena->blocks->next = block;
+    }
+    else
+    {
+        block->next = arena->blocks;
+        arena->blocks = block;
+        arena->pointer = pointer + size;
+        arena->end = pointer + block_size;
+    }
+    arena->used += size;
+
+    return pointer;
+}
+
+CJSON_PUBLIC(cJSON_Arena *) cJSON_InitArena(void *buffer, size_t buffer_size)
+{
+    unsigned char *start = NULL;
+    cJSON_Arena *arena = NULL;
+
+    if (buffer == NULL)
+    {
+        return NULL;
+    }
+
+    start = arena_align_up(buffer);
+    if (((size_t)(start - (unsigned char*)buffer) + sizeof(cJSON_Arena)) > buffer_size)
+    {
+        return NULL;
+    }
+
+    arena = (cJSON_Arena*)start;
+    memset(arena, '\0', sizeof(cJSON_Arena));
+    arena->start = start + sizeof(cJSON_Arena);
+    arena->pointer = arena->start;
+    arena->end = (unsigned char*)buffer + buffer_size;
+    arena->hooks = global_hooks;
+
+    return arena;
+}
+
+CJSON_PUBLIC(cJSON_Arena *) cJSON_CreateArena(size_t block_size)
+{
+    cJSON_Arena *arena = (cJSON_Arena*)global_hooks.allocate(sizeof(cJSON_Arena));
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    memset(arena, '\0', sizeof(cJSON_Arena));
+    arena->block_size = (block_size > 0) ? block_size : CJSON_ARENA_DEFAULT_BLOCK_SIZE;
+    arena->hooks = global_hooks;
+
+    return arena;
+}
+
+CJSON_PUBLIC(void) cJSON_ResetArena(cJSON_Arena *arena)
+{
+    arena_block *block = NULL;
+    arena_block *next = NULL;
+
+    if (arena == NULL)
+    {
+        return;
+    }
+
+    if (arena->block_size == 0)
+    {
+        arena->pointer = arena->start;
+    }
+    else if (arena->blocks != NULL)
+    {
+        /* keep the oldest block for the next parse, free all others */
+        block = arena->blocks;
+        while (block->next != NULL)
+        {
+            next = block->next;
+            arena->hooks.deallocate(block);
+            block = next;
+        }
+        arena->blocks = block;
+        arena->pointer = arena_block_data(block);
+        arena->end = arena->pointer + block->size;
+    }
+    arena->used = 0;
+}
+
+CJSON_PUBLIC(void) cJSON_DeleteArena(cJSON_Arena *arena)
+{
+    arena_block *next = NULL;
+
+    if ((arena == NULL) || (arena->block_size == 0))
+    {
+        /* a fixed arena lives in memory owned by the caller */
+        return;
+    }
+
+    while (arena->blocks != NULL)
+    {
+        next = arena->blocks->next;
+        arena->hooks.deallocate(arena->blocks);
+        arena->blocks = next;
+    }
+    arena->hooks.deallocate(arena);
+}
+
+CJSON_PUBLIC(size_t) cJSON_GetArenaUsed(const cJSON_Arena *arena)
+{
+    if (arena == NULL)
+    {
+        return 0;
+    }
+
+    return arena->used;
+}
+
 /* Internal constructor. */
 static cJSON *cJSON_New_Item(const internal_hooks * const hooks)
 {
@@ -293,8 +482,54 @@ typedef struct
     size_t offset;
     size_t depth; /* How deeply nested (in arrays/objects) is the input at the current offset. */
     internal_hooks hooks;
+    cJSON_Arena *arena; /* if not NULL, items and strings are allocated from the arena instead of the hooks */
 } parse_buffer;
 
+/* allocate memory for the parsed items and strings */
+static void *parse_allocate(parse_buffer * const input_buffer, size_t size, cJSON_bool aligned)
+{
+    if (input_buffer->arena != NULL)
+    {
+        return arena_allocate(input_buffer->arena, size, aligned);
+    }
+
+    return input_buffer->hooks.allocate(size);
+}
+
+static void parse_deallocate(parse_buffer * const input_buffer, void *pointer)
+{
+    if (input_buffer->arena == NULL)
+    {
+        input_buffer->hooks.deallocate(pointer);
+    }
+}
+
+static cJSON *parse_new_item(parse_buffer * const input_buffer)
+{
+    cJSON *node = NULL;
+
+    if (input_buffer->arena == NULL)
+    {
+        return cJSON_New_Item(&(input_buffer->hooks));
+    }
+
+    node = (cJSON*)arena_allocate(input_buffer->arena, sizeof(cJSON), true);
+    if (node)
+    {
+        memset(node, '\0', sizeof(cJSON));
+    }
+
+    return node;
+}
+
+static void parse_delete(parse_buffer * const input_buffer, cJSON *item)
+{
+    if (input_buffer->arena == NULL)
+    {
+        cJSON_Delete(item);
+    }
+}
+
 /* check if the given size is left to read in a given parse buffer (starting with 1) */
 #define can_read(buffer, size) ((buffer != NULL) && (((buffer)->offset + size) <= (buffer)->length))
 /* check if the buffer can be accessed at the given index (starting with 0) */
@@ -309,6 +544,7 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
     double number = 0;
     unsigned char *after_end = NULL;
     unsigned char *number_c_string;
+    unsigned char number_c_string_local[64]; /* fits all numbers cJSON prints, avoids an allocation per number */
     unsigned char decimal_point = get_decimal_point();
     size_t i = 0;
     size_t number_string_length = 0;
@@ -353,8 +589,12 @@ static cJSON_bool parse_number(cJSON * const item, parse_buffer * const input_bu
         }
     }
 loop_end:
-    /* malloc for temporary buffer, add 1 for '\0' */
-    number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
+    /* malloc for temporary buffer if it doesn't fit on the stack, add 1 for '\0' */
+    number_c_string = number_c_string_local;
+    if (number_string_length >= sizeof(number_c_string_local))
+    {
+        number_c_string = (unsigned char *) input_buffer->hooks.allocate(number_string_length + 1);
+    }
     if (number_c_string == NULL)
     {
         return false; /* allocation failure */
@@ -379,7 +619,10 @@ loop_end:
     if (number_c_string == after_end)
     {
         /* free the temporary buffer */
-        input_buffer->hooks.deallocate(number_c_string);
+        if (number_c_string != number_c_string_local)
+        {
+            input_buffer->hooks.deallocate(number_c_string);
+        }
         return false; /* parse_error */
     }
 
@@ -403,7 +646,10 @@ loop_end:
 
     input_buffer->offset += (size_t)(after_end - number_c_string);
     /* free the temporary buffer */
-    input_buffer->hooks.deallocate(number_c_string);
+    if (number_c_string != number_c_string_local)
+    {
+        input_buffer->hooks.deallocate(number_c_string);
+    }
     return true;
 }
 
@@ -822,6 +1068,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
     const unsigned char *input_end = buffer_at_offset(input_buffer) + 1;
     unsigned char *output_pointer = NULL;
     unsigned char *output = NULL;
+    size_t allocation_length = 0;
 
     /* not a string */
     if (buffer_at_offset(input_buffer)[0] != '\"')
@@ -831,7 +1078,6 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
 
     {
         /* calculate approximate size of the output (overestimate) */
-        size_t allocation_length = 0;
         size_t skipped_bytes = 0;
         while (((size_t)(input_end - input_buffer->content) < input_buffer->length) && (*input_end != '\"'))
         {
@@ -855,7 +1101,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
 
         /* This is at most how much we need for the output */
         allocation_length = (size_t) (input_end - buffer_at_offset(input_buffer)) - skipped_bytes;
-        output = (unsigned char*)input_buffer->hooks.allocate(allocation_length + sizeof(""));
+        output = (unsigned char*)parse_allocate(input_buffer, allocation_length + sizeof(""), false);
         if (output == NULL)
         {
             goto fail; /* allocation failure */
@@ -922,6 +1168,13 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
     /* zero terminate the output */
     *output_pointer = '\0';
 
+    /* give the overestimated part back to the arena */
+    if ((input_buffer->arena != NULL) && (input_buffer->arena->pointer == output + allocation_length + sizeof("")))
+    {
+        input_buffer->arena->pointer = output_pointer + sizeof("");
+        input_buffer->arena->used -= (size_t)(output + allocation_length - output_pointer);
+    }
+
     item->type = cJSON_String;
     item->valuestring = (char*)output;
 
@@ -933,7 +1186,7 @@ static cJSON_bool parse_string(cJSON * const item, parse_buffer * const input_bu
 fail:
     if (output != NULL)
     {
-        input_buffer->hooks.deallocate(output);
+        parse_deallocate(input_buffer, output);
         output = NULL;
     }
 
@@ -1139,10 +1392,14 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return
 }
 
 /* Parse an object - create a new root, and populate. */
-CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+static cJSON *parse(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated, cJSON_Arena * const arena)
 {
-    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 } };
+    parse_buffer buffer = { 0, 0, 0, 0, { 0, 0, 0 }, NULL };
     cJSON *item = NULL;
+    /* arena state to roll back to if parsing fails */
+    arena_block *arena_blocks = (arena != NULL) ? arena->blocks : NULL;
+    unsigned char *arena_pointer = (arena != NULL) ? arena->pointer : NULL;
+    size_t arena_used = (arena != NULL) ? arena->used : 0;
 
     /* reset error position */
     global_error.json = NULL;
@@ -1157,8 +1414,9 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
     buffer.length = buffer_length;
     buffer.offset = 0;
     buffer.hooks = global_hooks;
+    buffer.arena = arena;
 
-    item = cJSON_New_Item(&global_hooks);
+    item = parse_new_item(&buffer);
     if (item == NULL) /* memory fail */
     {
         goto fail;
@@ -1189,7 +1447,14 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer
 fail:
     if (item != NULL)
     {
-        cJSON_Delete(item);
+        parse_delete(&buffer, item);
+    }
+
+    /* memory taken from the current block can be reused; blocks added by this parse are kept until reset */
+    if ((arena != NULL) && (arena->blocks == arena_blocks))
+    {
+        arena->pointer = arena_pointer;
+        arena->used = arena_used;
     }
 
     if (value != NULL)
@@ -1218,6 +1483,21 @@ fail:
     return NULL;
 }
 
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    return parse(value, buffer_length, return_parse_end, require_null_terminated, NULL);
+}
+
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithArena(cJSON_Arena *arena, const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated)
+{
+    if (arena == NULL)
+    {
+        return NULL;
+    }
+
+    return parse(value, buffer_length, return_parse_end, require_null_terminated, arena);
+}
+
 /* Default options for cJSON_Parse */
 CJSON_PUBLIC(cJSON *) cJSON_Parse(const char *value)
 {
@@ -1527,7 +1807,7 @@ static cJSON_bool parse_array(cJSON * const item, parse_buffer * const input_buf
     do
     {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_new_item(input_buffer);
         if (new_item == NULL)
         {
             goto fail; /* allocation failure */
@@ -1580,7 +1860,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        parse_delete(input_buffer, head);
     }
 
     return false;
@@ -1685,7 +1965,7 @@ static cJSON_bool parse_object(cJSON * const item, parse_buffer * const input_bu
     do
     {
         /* allocate next item */
-        cJSON *new_item = cJSON_New_Item(&(input_buffer->hooks));
+        cJSON *new_item = parse_new_item(input_buffer);
         if (new_item == NULL)
         {
             goto fail; /* allocation failure */
@@ -1760,7 +2040,7 @@ success:
 fail:
     if (head != NULL)
     {
-        cJSON_Delete(head);
+        parse_delete(input_buffer, head);
     }
 
     return false;
@@ -158,6 +158,23 @@ CJSON_PUBLIC(cJSON *) cJSON_ParseWithLength(const char *value, size_t buffer_len
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithOpts(const char *value, const char **return_parse_end, cJSON_bool require_null_terminated);
 CJSON_PUBLIC(cJSON *) cJSON_ParseWithLengthOpts(const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
 
+/* Arena-backed parsing: all items and strings of a parsed tree are taken from an arena instead of one malloc per node.
+ * A tree parsed into an arena must NOT be passed to cJSON_Delete and must not get items added, replaced or detached.
+ * It is released as a whole by cJSON_ResetArena or cJSON_DeleteArena, which invalidate all trees parsed into the arena. */
+typedef struct cJSON_Arena cJSON_Arena;
+/* Create an arena in a caller supplied buffer. The arena never allocates; parsing fails once the buffer is exhausted. Returns NULL if the buffer is too small to hold the arena itself. */
+CJSON_PUBLIC(cJSON_Arena *) cJSON_InitArena(void *buffer, size_t buffer_size);
+/* Create an arena which allocates blocks of block_size bytes with the hooks as needed (0 selects CJSON_ARENA_DEFAULT_BLOCK_SIZE). */
+CJSON_PUBLIC(cJSON_Arena *) cJSON_CreateArena(size_t block_size);
+/* Release all trees parsed into the arena. The first block of a growing arena is kept for reuse. */
+CJSON_PUBLIC(void) cJSON_ResetArena(cJSON_Arena *arena);
+/* Free an arena created with cJSON_CreateArena. Does nothing for an arena created with cJSON_InitArena. */
+CJSON_PUBLIC(void) cJSON_DeleteArena(cJSON_Arena *arena);
+/* Returns the number of bytes taken from the arena since it was created or reset. */
+CJSON_PUBLIC(size_t) cJSON_GetArenaUsed(const cJSON_Arena *arena);
+/* Same as cJSON_ParseWithLengthOpts, but allocates the tree from the arena. Memory used by a failed parse is given back where possible. */
+CJSON_PUBLIC(cJSON *) cJSON_ParseWithArena(cJSON_Arena *arena, const char *value, size_t buffer_length, const char **return_parse_end, cJSON_bool require_null_terminated);
+
 /* Render a cJSON entity to text for transfer/storage. */
 CJSON_PUBLIC(char *) cJSON_Print(const cJSON *item);
 /* Render a cJSON entity to text for transfer/storage without any formatting. */
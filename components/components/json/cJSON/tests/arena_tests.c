@@ -0,0 +1,298 @@
+/*
+  Copyright (c) 2009-2017 Dave Gamble and cJSON contributors
+
+  Permission is hereby granted, free of charge, to any person obtaining a copy
+  of this software and associated documentation files (the "Software"), to deal
+  in the Software without restriction, including without limitation the rights
+  to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+  copies of the Software, and to permit persons to whom the Software is
+  furnished to do so, subject to the following conditions:
+
+  The above copyright notice and this permission notice shall be included in
+  all copies or substantial portions of the Software.
+
+  THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+  IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+  FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+  AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+  LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+  OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+  THE SOFTWARE.
+*/
+
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "unity/examples/unity_config.h"
+#include "unity/src/unity.h"
+#include "common.h"
+
+static size_t allocation_count = 0;
+
+static void * CJSON_CDECL counting_malloc(size_t size)
+{
+    allocation_count++;
+    return malloc(size);
+}
+
+static void CJSON_CDECL counting_free(void *pointer)
+{
+    free(pointer);
+}
+
+static void compare_with_heap_parse(const char *json)
+{
+    cJSON_Arena *arena = NULL;
+    cJSON *expected = NULL;
+    cJSON *actual = NULL;
+    char *expected_printed = NULL;
+    char *actual_printed = NULL;
+
+    arena = cJSON_CreateArena(256);
+    TEST_ASSERT_NOT_NULL(arena);
+
+    expected = cJSON_Parse(json);
+    actual = cJSON_ParseWithArena(arena, json, strlen(json) + sizeof(""), NULL, false);
+    TEST_ASSERT_NOT_NULL(expected);
+    TEST_ASSERT_NOT_NULL(actual);
+    TEST_ASSERT_TRUE(cJSON_Compare(expected, actual, true));
+
+    expected_printed = cJSON_Print(expected);
+    actual_printed = cJSON_Print(actual);
+    TEST_ASSERT_EQUAL_STRING(expected_printed, actual_printed);
+
+    free(expected_printed);
+    free(actual_printed);
+    cJSON_Delete(expected);
+    cJSON_DeleteArena(arena);
+}
+
+static void arena_parse_should_match_heap_parse(void)
+{
+    const char *files[] = {
+        "inputs/test1", "inputs/test2", "inputs/test3", "inputs/test4", "inputs/test5",
+        "inputs/test7", "inputs/test8", "inputs/test9", "inputs/test10", "inputs/test11"
+    };
+    size_t i;
+
+    for (i = 0; i < sizeof(files) / sizeof(files[0]); i++)
+    {
+        char *content = read_file(files[i]);
+        TEST_ASSERT_NOT_NULL_MESSAGE(content, files[i]);
+        compare_with_heap_parse(content);
+        free(content);
+    }
+
+    compare_with_heap_parse("\"\\u00e4\\n\\ud83d\\ude00\"");
+    compare_with_heap_parse("[1e300, -0.5, 123456789012345678901234567890123456789012345678901234567890123456789012345678901234567890]");
+}
+
+static void fixed_arena_should_not_allocate(void)
+{
+    unsigned char buffer[1024];
+    const char json[] = "{\"name\":\"esp\",\"values\":[1,2,3],\"nested\":{\"flag\":true}}";
+    cJSON_Arena *arena = NULL;
+    cJSON *tree = NULL;
+
+    cJSON_Hooks hooks = { counting_malloc, counting_free };
+    cJSON_InitHooks(&hooks);
+    allocation_count = 0;
+
+    arena = cJSON_InitArena(buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_NULL(arena);
+    tree = cJSON_ParseWithArena(arena, json, sizeof(json), NULL, true);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_STRING("esp", cJSON_GetObjectItem(tree, "name")->valuestring);
+    TEST_ASSERT_EQUAL_INT(3, cJSON_GetArraySize(cJSON_GetObjectItem(tree, "values")));
+    TEST_ASSERT_TRUE(cJSON_IsTrue(cJSON_GetObjectItem(cJSON_GetObjectItem(tree, "nested"), "flag")));
+    TEST_ASSERT_TRUE((unsigned char*)tree >= buffer && (unsigned char*)tree < buffer + sizeof(buffer));
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)allocation_count);
+
+    cJSON_InitHooks(NULL);
+}
+
+static void fixed_arena_should_fail_when_exhausted(void)
+{
+    unsigned char buffer[sizeof(cJSON_Arena) + 4 * sizeof(cJSON) + 32];
+    const char small[] = "[true,false]";
+    const char large[] = "[1,2,3,4,5,6,7,8,9,10]";
+    cJSON_Arena *arena = NULL;
+    cJSON *tree = NULL;
+    size_t used = 0;
+
+    TEST_ASSERT_NULL(cJSON_InitArena(buffer, sizeof(cJSON_Arena) - 1));
+
+    arena = cJSON_InitArena(buffer, sizeof(buffer));
+    TEST_ASSERT_NOT_NULL(arena);
+
+    tree = cJSON_ParseWithArena(arena, small, sizeof(small), NULL, true);
+    TEST_ASSERT_NOT_NULL(tree);
+    used = cJSON_GetArenaUsed(arena);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)(3 * sizeof(cJSON)), (unsigned int)used);
+
+    /* a failed parse gives its memory back, the previous tree stays valid */
+    TEST_ASSERT_NULL(cJSON_ParseWithArena(arena, large, sizeof(large), NULL, true));
+    TEST_ASSERT_EQUAL_UINT((unsigned int)used, (unsigned int)cJSON_GetArenaUsed(arena));
+    TEST_ASSERT_TRUE(cJSON_IsFalse(cJSON_GetArrayItem(tree, 1)));
+
+    cJSON_ResetArena(arena);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)cJSON_GetArenaUsed(arena));
+    TEST_ASSERT_NOT_NULL(cJSON_ParseWithArena(arena, small, sizeof(small), NULL, true));
+}
+
+static void growing_arena_should_handle_large_strings(void)
+{
+    cJSON_Arena *arena = NULL;
+    cJSON *tree = NULL;
+    char *json = NULL;
+    size_t i;
+    const size_t string_length = 1000;
+
+    json = (char*)malloc(string_length + sizeof("[\"\",\"x\"]"));
+    TEST_ASSERT_NOT_NULL(json);
+    strcpy(json, "[\"");
+    for (i = 0; i < string_length; i++)
+    {
+        json[i + 2] = (char)('a' + (i % 26));
+    }
+    strcpy(json + 2 + string_length, "\",\"x\"]");
+
+    /* the string doesn't fit into a block and gets a dedicated one */
+    arena = cJSON_CreateArena(128);
+    TEST_ASSERT_NOT_NULL(arena);
+    tree = cJSON_ParseWithArena(arena, json, strlen(json) + sizeof(""), NULL, true);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_UINT((unsigned int)string_length, (unsigned int)strlen(cJSON_GetArrayItem(tree, 0)->valuestring));
+    TEST_ASSERT_EQUAL_STRING("x", cJSON_GetArrayItem(tree, 1)->valuestring);
+
+    cJSON_ResetArena(arena);
+    TEST_ASSERT_EQUAL_UINT(0, (unsigned int)cJSON_GetArenaUsed(arena));
+    tree = cJSON_ParseWithArena(arena, json, strlen(json) + sizeof(""), NULL, true);
+    TEST_ASSERT_NOT_NULL(tree);
+    TEST_ASSERT_EQUAL_STRING("x", cJSON_GetArrayItem(tree, 1)->valuestring);
+
+    cJSON_DeleteArena(arena);
+    free(json);
+}
+
+static void arena_parse_should_report_errors(void)
+{
+    const char json[] = "{\"a\":[1,2,}";
+    const char *parse_end = NULL;
+    cJSON_Arena *arena = cJSON_CreateArena(0);
+
+    TEST_ASSERT_NULL(cJSON_ParseWithArena(NULL, "[]", sizeof("[]"), NULL, true));
+    TEST_ASSERT_NULL(cJSON_ParseWithArena(arena, NULL, 0, NULL, true));
+    TEST_ASSERT_NULL(cJSON_ParseWithArena(arena, json, sizeof(json), &parse_end, true));
+    TEST_ASSERT_EQUAL_PTR(json + 10, parse_end);
+    TEST_ASSERT_EQUAL_PTR(json + 10, cJSON_GetErrorPtr());
+
+    cJSON_DeleteArena(arena);
+    cJSON_DeleteArena(NULL);
+    cJSON_ResetArena(NULL);
+}
+
+/* Builds a configuration like document of roughly 20 KB */
+static char *create_config_document(void)
+{
+    char *json = NULL;
+    size_t length = 0;
+    int i;
+    const size_t size = 32 * 1024;
+
+    json = (char*)malloc(size);
+    TEST_ASSERT_NOT_NULL(json);
+
+    length += (size_t)sprintf(json + length, "{\"version\":3,\"devices\":[");
+    for (i = 0; i < 135; i++)
+    {
+        length += (size_t)sprintf(json + length,
+                                  "%s{\"id\":%d,\"name\":\"sensor_%d\",\"enabled\":%s,\"interval_ms\":%d,"
+                                  "\"threshold\":%d.%d,\"tags\":[\"room%d\",\"floor%d\"],\"calibration\":{\"offset\":-%d.25,\"gain\":1.0%d}}",
+                                  (i > 0) ? "," : "", i, i, (i % 3) ? "true" : "false", 100 * (i + 1),
+                                  i, i % 10, i % 20, i % 4, i % 7, i % 9);
+    }
+    length += (size_t)sprintf(json + length, "]}");
+    TEST_ASSERT_TRUE(length < size);
+
+    return json;
+}
+
+static void arena_parse_benchmark(void)
+{
+    const int iterations = 200;
+    cJSON_Hooks hooks = { counting_malloc, counting_free };
+    cJSON_Arena *arena = NULL;
+    cJSON *tree = NULL;
+    char *json = create_config_document();
+    size_t json_length = strlen(json) + sizeof("");
+    size_t heap_allocations = 0;
+    size_t arena_allocations = 0;
+    clock_t heap_parse = 0;
+    clock_t heap_free = 0;
+    clock_t arena_parse = 0;
+    clock_t arena_free = 0;
+    clock_t start = 0;
+    int i;
+
+    cJSON_InitHooks(&hooks);
+
+    allocation_count = 0;
+    for (i = 0; i < iterations; i++)
+    {
+        start = clock();
+        tree = cJSON_ParseWithLength(json, json_length);
+        heap_parse += clock() - start;
+        TEST_ASSERT_NOT_NULL(tree);
+
+        start = clock();
+        cJSON_Delete(tree);
+        heap_free += clock() - start;
+    }
+    heap_allocations = allocation_count / (size_t)iterations;
+
+    allocation_count = 0;
+    arena = cJSON_CreateArena(0);
+    TEST_ASSERT_NOT_NULL(arena);
+    for (i = 0; i < iterations; i++)
+    {
+        start = clock();
+        tree = cJSON_ParseWithArena(arena, json, json_length, NULL, true);
+        arena_parse += clock() - start;
+        TEST_ASSERT_NOT_NULL(tree);
+
+        start = clock();
+        cJSON_ResetArena(arena);
+        arena_free += clock() - start;
+    }
+    cJSON_DeleteArena(arena);
+    arena_allocations = allocation_count / (size_t)iterations;
+
+    cJSON_InitHooks(NULL);
+
+    printf("parsing %u bytes, %d iterations\n", (unsigned)json_length, iterations);
+    printf("heap:  %u allocations per parse, parse %.1f us, free %.1f us\n", (unsigned)heap_allocations,
+           1e6 * (double)heap_parse / CLOCKS_PER_SEC / iterations, 1e6 * (double)heap_free / CLOCKS_PER_SEC / iterations);
+    printf("arena: %u allocations per parse, parse %.1f us, free %.1f us\n", (unsigned)arena_allocations,
+           1e6 * (double)arena_parse / CLOCKS_PER_SEC / iterations, 1e6 * (double)arena_free / CLOCKS_PER_SEC / iterations);
+
+    TEST_ASSERT_TRUE(heap_allocations > 1000);
+    TEST_ASSERT_TRUE(arena_allocations * 50 < heap_allocations);
+
+    free(json);
+}
+
+int CJSON_CDECL main(void)
+{
+    UNITY_BEGIN();
+    RUN_TEST(arena_parse_should_match_heap_parse);
+    RUN_TEST(fixed_arena_should_not_allocate);
+    RUN_TEST(fixed_arena_should_fail_when_exhausted);
+    RUN_TEST(growing_arena_should_handle_large_strings);
+    RUN_TEST(arena_parse_should_report_errors);
+    RUN_TEST(arena_parse_benchmark);
+    return UNITY_END();
+}
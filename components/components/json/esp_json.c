@@ -0,0 +1,91 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_json.h"
+
+static const char *TAG = "esp_json";
+
+struct esp_json_doc {
+    cJSON_Arena *arena;
+    cJSON *root;
+    bool in_buffer;     /* the document lives in the buffer of the caller */
+};
+
+esp_err_t esp_json_parse(const char *json, size_t len, const esp_json_parse_config_t *config, esp_json_doc_handle_t *out_doc)
+{
+    const esp_json_parse_config_t default_config = ESP_JSON_PARSE_CONFIG_DEFAULT();
+    struct esp_json_doc *doc = NULL;
+    const char *parse_end = NULL;
+
+    if (json == NULL || len == 0 || out_doc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (config == NULL) {
+        config = &default_config;
+    }
+
+    if (config->buffer != NULL) {
+        /* the document header and the arena are placed at the start of the buffer */
+        uintptr_t start = ((uintptr_t) config->buffer + sizeof(void *) - 1) & ~(uintptr_t)(sizeof(void *) - 1);
+        size_t offset = (start - (uintptr_t) config->buffer) + sizeof(struct esp_json_doc);
+        if (offset >= config->buffer_size) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        doc = (struct esp_json_doc *) start;
+        doc->arena = cJSON_InitArena((uint8_t *) config->buffer + offset, config->buffer_size - offset);
+        if (doc->arena == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        doc->in_buffer = true;
+    } else {
+        doc = calloc(1, sizeof(struct esp_json_doc));
+        if (doc == NULL) {
+            return ESP_ERR_NO_MEM;
+        }
+        doc->arena = cJSON_CreateArena(config->block_size);
+        if (doc->arena == NULL) {
+            free(doc);
+            return ESP_ERR_NO_MEM;
+        }
+        doc->in_buffer = false;
+    }
+
+    doc->root = cJSON_ParseWithArena(doc->arena, json, len, &parse_end, false);
+    if (doc->root == NULL) {
+        ESP_LOGD(TAG, "parsing failed at offset %u of %u", (unsigned) (parse_end - json), (unsigned) len);
+        esp_json_doc_delete(doc);
+        return ESP_FAIL;
+    }
+
+    *out_doc = doc;
+    return ESP_OK;
+}
+
+const cJSON *esp_json_doc_get_root(esp_json_doc_handle_t doc)
+{
+    return doc ? doc->root : NULL;
+}
+
+size_t esp_json_doc_get_used(esp_json_doc_handle_t doc)
+{
+    return doc ? cJSON_GetArenaUsed(doc->arena) : 0;
+}
+
+esp_err_t esp_json_doc_delete(esp_json_doc_handle_t doc)
+{
+    if (doc == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!doc->in_buffer) {
+        cJSON_DeleteArena(doc->arena);
+        free(doc);
+    }
+    return ESP_OK;
+}
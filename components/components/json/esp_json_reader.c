@@ -0,0 +1,613 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_json_reader.h"
+
+#define READER_DEFAULT_MAX_TOKEN_LEN    256
+#define READER_DEFAULT_MAX_DEPTH        32
+
+typedef enum {
+    READER_STATE_VALUE,             /* expecting a value */
+    READER_STATE_VALUE_OR_END,      /* after '[' */
+    READER_STATE_KEY_OR_END,        /* after '{' */
+    READER_STATE_KEY,               /* after ',' in an object */
+    READER_STATE_COLON,             /* after a key */
+    READER_STATE_AFTER_VALUE,       /* expecting ',' or the end of the container */
+    READER_STATE_STRING,
+    READER_STATE_ESCAPE,            /* after '\' in a string */
+    READER_STATE_UNICODE,           /* reading the hex digits of "\u" */
+    READER_STATE_NUMBER,
+    READER_STATE_LITERAL,           /* true, false or null */
+    READER_STATE_DONE,              /* top level value complete */
+    READER_STATE_ERROR,
+} reader_state_t;
+
+struct esp_json_reader {
+    esp_json_event_cb_t event_cb;
+    void *user_ctx;
+    reader_state_t state;
+    esp_err_t error;
+    size_t offset;                  /* bytes consumed */
+    size_t depth;
+    size_t max_depth;
+    uint8_t *stack;                 /* one bit per nesting level, set for objects */
+    char *token;                    /* key, string part or number being read, max_token_len + 1 bytes */
+    size_t token_len;
+    size_t max_token_len;
+    bool string_is_key;
+    const char *literal;            /* literal being matched */
+    uint8_t literal_pos;
+    uint8_t unicode_digits;
+    uint16_t unicode;
+    uint16_t high_surrogate;        /* first half of a surrogate pair, waiting for the second */
+};
+
+static inline bool is_whitespace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+static inline bool is_digit(char c)
+{
+    return c >= '0' && c <= '9';
+}
+
+static inline bool in_object(esp_json_reader_handle_t r)
+{
+    size_t level = r->depth - 1;
+    return (r->stack[level / 8] >> (level % 8)) & 1;
+}
+
+static esp_err_t emit(esp_json_reader_handle_t r, esp_json_event_t *event)
+{
+    if (event->value == NULL) {
+        event->value_len = 0;
+    }
+    return r->event_cb(event, r->user_ctx);
+}
+
+static esp_err_t emit_simple(esp_json_reader_handle_t r, esp_json_event_type_t type)
+{
+    esp_json_event_t event = {
+        .type = type,
+        .depth = r->depth,
+    };
+    return emit(r, &event);
+}
+
+static esp_err_t emit_token(esp_json_reader_handle_t r, esp_json_event_type_t type, bool partial)
+{
+    r->token[r->token_len] = '\0';
+    esp_json_event_t event = {
+        .type = type,
+        .value = r->token,
+        .value_len = r->token_len,
+        .partial = partial,
+        .depth = r->depth,
+    };
+    esp_err_t err = emit(r, &event);
+    r->token_len = 0;
+    return err;
+}
+
+/* Append bytes to the current token. String values which don't fit are delivered in parts. */
+static esp_err_t token_append(esp_json_reader_handle_t r, const char *data, size_t len)
+{
+    while (len > 0) {
+        size_t space = r->max_token_len - r->token_len;
+        if (space == 0) {
+            if (r->state == READER_STATE_NUMBER || r->string_is_key) {
+                return ESP_ERR_INVALID_SIZE;
+            }
+            esp_err_t err = emit_token(r, ESP_JSON_EVENT_STRING, true);
+            if (err != ESP_OK) {
+                return err;
+            }
+            continue;
+        }
+        size_t n = len < space ? len : space;
+        memcpy(r->token + r->token_len, data, n);
+        r->token_len += n;
+        data += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t token_append_utf8(esp_json_reader_handle_t r, uint32_t code_point)
+{
+    char utf8[4];
+    size_t len;
+
+    if (code_point < 0x80) {
+        utf8[0] = (char) code_point;
+        len = 1;
+    } else if (code_point < 0x800) {
+        utf8[0] = (char) (0xC0 | (code_point >> 6));
+        utf8[1] = (char) (0x80 | (code_point & 0x3F));
+        len = 2;
+    } else if (code_point < 0x10000) {
+        utf8[0] = (char) (0xE0 | (code_point >> 12));
+        utf8[1] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+        utf8[2] = (char) (0x80 | (code_point & 0x3F));
+        len = 3;
+    } else {
+        utf8[0] = (char) (0xF0 | (code_point >> 18));
+        utf8[1] = (char) (0x80 | ((code_point >> 12) & 0x3F));
+        utf8[2] = (char) (0x80 | ((code_point >> 6) & 0x3F));
+        utf8[3] = (char) (0x80 | (code_point & 0x3F));
+        len = 4;
+    }
+    return token_append(r, utf8, len);
+}
+
+/* Strict JSON number grammar: -?(0|[1-9][0-9]*)(\.[0-9]+)?([eE][+-]?[0-9]+)? */
+static bool number_is_valid(const char *s, size_t len)
+{
+    size_t i = 0;
+
+    if (i < len && s[i] == '-') {
+        i++;
+    }
+    if (i < len && s[i] == '0') {
+        i++;
+    } else if (i < len && is_digit(s[i])) {
+        while (i < len && is_digit(s[i])) {
+            i++;
+        }
+    } else {
+        return false;
+    }
+    if (i < len && s[i] == '.') {
+        i++;
+        if (i == len || !is_digit(s[i])) {
+            return false;
+        }
+        while (i < len && is_digit(s[i])) {
+            i++;
+        }
+    }
+    if (i < len && (s[i] == 'e' || s[i] == 'E')) {
+        i++;
+        if (i < len && (s[i] == '+' || s[i] == '-')) {
+            i++;
+        }
+        if (i == len || !is_digit(s[i])) {
+            return false;
+        }
+        while (i < len && is_digit(s[i])) {
+            i++;
+        }
+    }
+    return i == len;
+}
+
+static esp_err_t value_end(esp_json_reader_handle_t r)
+{
+    r->state = (r->depth == 0) ? READER_STATE_DONE : READER_STATE_AFTER_VALUE;
+    return ESP_OK;
+}
+
+static esp_err_t number_end(esp_json_reader_handle_t r)
+{
+    if (!number_is_valid(r->token, r->token_len)) {
+        return ESP_FAIL;
+    }
+    r->token[r->token_len] = '\0';
+    esp_json_event_t event = {
+        .type = ESP_JSON_EVENT_NUMBER,
+        .value = r->token,
+        .value_len = r->token_len,
+        .number = strtod(r->token, NULL),
+        .depth = r->depth,
+    };
+    r->token_len = 0;
+    esp_err_t err = emit(r, &event);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return value_end(r);
+}
+
+static esp_err_t container_start(esp_json_reader_handle_t r, bool object)
+{
+    if (r->depth >= r->max_depth) {
+        return ESP_ERR_INVALID_SIZE;
+    }
+    esp_err_t err = emit_simple(r, object ? ESP_JSON_EVENT_OBJECT_START : ESP_JSON_EVENT_ARRAY_START);
+    if (err != ESP_OK) {
+        return err;
+    }
+    size_t level = r->depth++;
+    if (object) {
+        r->stack[level / 8] |= (uint8_t) (1 << (level % 8));
+    } else {
+        r->stack[level / 8] &= (uint8_t) ~(1 << (level % 8));
+    }
+    r->state = object ? READER_STATE_KEY_OR_END : READER_STATE_VALUE_OR_END;
+    return ESP_OK;
+}
+
+static esp_err_t container_end(esp_json_reader_handle_t r)
+{
+    bool object = in_object(r);
+    r->depth--;
+    esp_err_t err = emit_simple(r, object ? ESP_JSON_EVENT_OBJECT_END : ESP_JSON_EVENT_ARRAY_END);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return value_end(r);
+}
+
+static esp_err_t value_start(esp_json_reader_handle_t r, char c)
+{
+    switch (c) {
+    case '{':
+        return container_start(r, true);
+    case '[':
+        return container_start(r, false);
+    case '"':
+        r->string_is_key = false;
+        r->token_len = 0;
+        r->state = READER_STATE_STRING;
+        return ESP_OK;
+    case 't':
+        r->literal = "true";
+        break;
+    case 'f':
+        r->literal = "false";
+        break;
+    case 'n':
+        r->literal = "null";
+        break;
+    default:
+        if (c == '-' || is_digit(c)) {
+            r->token_len = 0;
+            r->state = READER_STATE_NUMBER;
+            return token_append(r, &c, 1);
+        }
+        return ESP_FAIL;
+    }
+    r->literal_pos = 1;
+    r->state = READER_STATE_LITERAL;
+    return ESP_OK;
+}
+
+static esp_err_t string_end(esp_json_reader_handle_t r)
+{
+    if (r->string_is_key) {
+        r->state = READER_STATE_COLON;
+        return emit_token(r, ESP_JSON_EVENT_KEY, false);
+    }
+    esp_err_t err = emit_token(r, ESP_JSON_EVENT_STRING, false);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return value_end(r);
+}
+
+static esp_err_t unicode_end(esp_json_reader_handle_t r)
+{
+    uint16_t unit = r->unicode;
+
+    r->state = READER_STATE_STRING;
+    if (r->high_surrogate != 0) {
+        if (unit < 0xDC00 || unit > 0xDFFF) {
+            return ESP_FAIL;
+        }
+        uint32_t code_point = 0x10000 + (((uint32_t) r->high_surrogate - 0xD800) << 10) + (unit - 0xDC00);
+        r->high_surrogate = 0;
+        return token_append_utf8(r, code_point);
+    }
+    if (unit >= 0xD800 && unit <= 0xDBFF) {
+        r->high_surrogate = unit;
+        return ESP_OK;
+    }
+    if (unit >= 0xDC00 && unit <= 0xDFFF) {
+        return ESP_FAIL;
+    }
+    return token_append_utf8(r, unit);
+}
+
+/* Process one byte. Sets *consumed to false if the byte has to be processed again in the new state. */
+static esp_err_t reader_step(esp_json_reader_handle_t r, char c, bool *consumed)
+{
+    *consumed = true;
+
+    switch (r->state) {
+    case READER_STATE_VALUE:
+        if (is_whitespace(c)) {
+            return ESP_OK;
+        }
+        return value_start(r, c);
+
+    case READER_STATE_VALUE_OR_END:
+        if (is_whitespace(c)) {
+            return ESP_OK;
+        }
+        if (c == ']') {
+            return container_end(r);
+        }
+        return value_start(r, c);
+
+    case READER_STATE_KEY_OR_END:
+    case READER_STATE_KEY:
+        if (is_whitespace(c)) {
+            return ESP_OK;
+        }
+        if (c == '}' && r->state == READER_STATE_KEY_OR_END) {
+            return container_end(r);
+        }
+        if (c != '"') {
+            return ESP_FAIL;
+        }
+        r->string_is_key = true;
+        r->token_len = 0;
+        r->state = READER_STATE_STRING;
+        return ESP_OK;
+
+    case READER_STATE_COLON:
+        if (is_whitespace(c)) {
+            return ESP_OK;
+        }
+        if (c != ':') {
+            return ESP_FAIL;
+        }
+        r->state = READER_STATE_VALUE;
+        return ESP_OK;
+
+    case READER_STATE_AFTER_VALUE:
+        if (is_whitespace(c)) {
+            return ESP_OK;
+        }
+        if (c == ',') {
+            r->state = in_object(r) ? READER_STATE_KEY : READER_STATE_VALUE;
+            return ESP_OK;
+        }
+        if (c == (in_object(r) ? '}' : ']')) {
+            return container_end(r);
+        }
+        return ESP_FAIL;
+
+    case READER_STATE_STRING:
+        if (r->high_surrogate != 0 && c != '\\') {
+            return ESP_FAIL;
+        }
+        if (c == '"') {
+            return string_end(r);
+        }
+        if (c == '\\') {
+            r->state = READER_STATE_ESCAPE;
+            return ESP_OK;
+        }
+        if ((unsigned char) c < 0x20) {
+            return ESP_FAIL;
+        }
+        return token_append(r, &c, 1);
+
+    case READER_STATE_ESCAPE: {
+        if (r->high_surrogate != 0 && c != 'u') {
+            return ESP_FAIL;
+        }
+        char unescaped;
+        switch (c) {
+        case '"':
+        case '\\':
+        case '/':
+            unescaped = c;
+            break;
+        case 'b':
+            unescaped = '\b';
+            break;
+        case 'f':
+            unescaped = '\f';
+            break;
+        case 'n':
+            unescaped = '\n';
+            break;
+        case 'r':
+            unescaped = '\r';
+            break;
+        case 't':
+            unescaped = '\t';
+            break;
+        case 'u':
+            r->unicode = 0;
+            r->unicode_digits = 0;
+            r->state = READER_STATE_UNICODE;
+            return ESP_OK;
+        default:
+            return ESP_FAIL;
+        }
+        r->state = READER_STATE_STRING;
+        return token_append(r, &unescaped, 1);
+    }
+
+    case READER_STATE_UNICODE: {
+        uint16_t digit;
+        if (is_digit(c)) {
+            digit = (uint16_t) (c - '0');
+        } else if (c >= 'a' && c <= 'f') {
+            digit = (uint16_t) (c - 'a' + 10);
+        } else if (c >= 'A' && c <= 'F') {
+            digit = (uint16_t) (c - 'A' + 10);
+        } else {
+            return ESP_FAIL;
+        }
+        r->unicode = (uint16_t) ((r->unicode << 4) | digit);
+        if (++r->unicode_digits < 4) {
+            return ESP_OK;
+        }
+        return unicode_end(r);
+    }
+
+    case READER_STATE_NUMBER:
+        if (is_digit(c) || c == '-' || c == '+' || c == '.' || c == 'e' || c == 'E') {
+            return token_append(r, &c, 1);
+        }
+        *consumed = false;
+        return number_end(r);
+
+    case READER_STATE_LITERAL: {
+        if (c != r->literal[r->literal_pos]) {
+            return ESP_FAIL;
+        }
+        if (r->literal[++r->literal_pos] != '\0') {
+            return ESP_OK;
+        }
+        esp_err_t err;
+        if (r->literal[0] == 'n') {
+            err = emit_simple(r, ESP_JSON_EVENT_NULL);
+        } else {
+            esp_json_event_t event = {
+                .type = ESP_JSON_EVENT_BOOL,
+                .boolean = (r->literal[0] == 't'),
+                .depth = r->depth,
+            };
+            err = emit(r, &event);
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+        return value_end(r);
+    }
+
+    case READER_STATE_DONE:
+        return is_whitespace(c) ? ESP_OK : ESP_FAIL;
+
+    case READER_STATE_ERROR:
+    default:
+        return r->error;
+    }
+}
+
+/* Length of the run of bytes at the start of data which can be copied into a string as they are */
+static size_t plain_string_len(const char *data, size_t len)
+{
+    size_t i = 0;
+    while (i < len && data[i] != '"' && data[i] != '\\' && (unsigned char) data[i] >= 0x20) {
+        i++;
+    }
+    return i;
+}
+
+esp_err_t esp_json_reader_create(const esp_json_reader_config_t *config, esp_json_reader_handle_t *out_reader)
+{
+    if (config == NULL || config->event_cb == NULL || out_reader == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t max_token_len = config->max_token_len ? config->max_token_len : READER_DEFAULT_MAX_TOKEN_LEN;
+    size_t max_depth = config->max_depth ? config->max_depth : READER_DEFAULT_MAX_DEPTH;
+
+    /* reader, token buffer and nesting stack in one allocation */
+    size_t stack_size = (max_depth + 7) / 8;
+    esp_json_reader_handle_t r = calloc(1, sizeof(struct esp_json_reader) + stack_size + max_token_len + 1);
+    if (r == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    r->event_cb = config->event_cb;
+    r->user_ctx = config->user_ctx;
+    r->max_depth = max_depth;
+    r->max_token_len = max_token_len;
+    r->stack = (uint8_t *) (r + 1);
+    r->token = (char *) r->stack + stack_size;
+    esp_json_reader_reset(r);
+
+    *out_reader = r;
+    return ESP_OK;
+}
+
+esp_err_t esp_json_reader_feed(esp_json_reader_handle_t reader, const char *data, size_t len)
+{
+    if (reader == NULL || (data == NULL && len > 0)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (reader->state == READER_STATE_ERROR) {
+        return reader->error;
+    }
+
+    size_t i = 0;
+    while (i < len) {
+        esp_err_t err = ESP_OK;
+        if (reader->state == READER_STATE_STRING && reader->high_surrogate == 0) {
+            /* copy runs of plain characters at once */
+            size_t run = plain_string_len(data + i, len - i);
+            if (run > 0) {
+                err = token_append(reader, data + i, run);
+                if (err == ESP_OK) {
+                    i += run;
+                    reader->offset += run;
+                    continue;
+                }
+            }
+        }
+        if (err == ESP_OK) {
+            bool consumed;
+            err = reader_step(reader, data[i], &consumed);
+            if (err == ESP_OK && consumed) {
+                i++;
+                reader->offset++;
+            }
+        }
+        if (err != ESP_OK) {
+            reader->state = READER_STATE_ERROR;
+            reader->error = err;
+            return err;
+        }
+    }
+    return ESP_OK;
+}
+
+esp_err_t esp_json_reader_finish(esp_json_reader_handle_t reader)
+{
+    if (reader == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (reader->state == READER_STATE_NUMBER && reader->depth == 0) {
+        esp_err_t err = number_end(reader);
+        if (err != ESP_OK) {
+            reader->state = READER_STATE_ERROR;
+            reader->error = err;
+        }
+    }
+    if (reader->state == READER_STATE_ERROR) {
+        return reader->error;
+    }
+    return reader->state == READER_STATE_DONE ? ESP_OK : ESP_FAIL;
+}
+
+size_t esp_json_reader_get_offset(esp_json_reader_handle_t reader)
+{
+    return reader ? reader->offset : 0;
+}
+
+esp_err_t esp_json_reader_reset(esp_json_reader_handle_t reader)
+{
+    if (reader == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    reader->state = READER_STATE_VALUE;
+    reader->error = ESP_OK;
+    reader->offset = 0;
+    reader->depth = 0;
+    reader->token_len = 0;
+    reader->high_surrogate = 0;
+    return ESP_OK;
+}
+
+esp_err_t esp_json_reader_delete(esp_json_reader_handle_t reader)
+{
+    if (reader == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    free(reader);
+    return ESP_OK;
+}
@@ -0,0 +1,416 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <inttypes.h>
+#include <limits.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "esp_json_writer.h"
+
+#define WRITER_DEFAULT_MAX_DEPTH    32
+
+struct esp_json_writer {
+    char *buffer;
+    size_t capacity;                /* usable size of buffer, without the null terminator if there is no write_cb */
+    size_t used;                    /* bytes in buffer */
+    size_t flushed;                 /* bytes passed to write_cb */
+    esp_json_write_cb_t write_cb;
+    void *user_ctx;
+    esp_err_t error;
+    size_t depth;
+    size_t max_depth;
+    uint8_t *stack;                 /* one bit per nesting level, set for objects */
+    bool need_comma;                /* a value was written in the current container */
+    bool after_key;                 /* a key was written and its value is expected */
+    bool done;                      /* the top level value is complete */
+};
+
+static esp_err_t writer_fail(esp_json_writer_handle_t w, esp_err_t err)
+{
+    w->error = err;
+    return err;
+}
+
+static esp_err_t flush(esp_json_writer_handle_t w)
+{
+    if (w->used == 0) {
+        return ESP_OK;
+    }
+    esp_err_t err = w->write_cb(w->buffer, w->used, w->user_ctx);
+    if (err != ESP_OK) {
+        return err;
+    }
+    w->flushed += w->used;
+    w->used = 0;
+    return ESP_OK;
+}
+
+static esp_err_t out(esp_json_writer_handle_t w, const char *data, size_t len)
+{
+    while (len > 0) {
+        size_t space = w->capacity - w->used;
+        if (space == 0) {
+            if (w->write_cb == NULL) {
+                return writer_fail(w, ESP_ERR_INVALID_SIZE);
+            }
+            esp_err_t err = flush(w);
+            if (err != ESP_OK) {
+                return writer_fail(w, err);
+            }
+            continue;
+        }
+        size_t n = len < space ? len : space;
+        memcpy(w->buffer + w->used, data, n);
+        w->used += n;
+        data += n;
+        len -= n;
+    }
+    return ESP_OK;
+}
+
+static inline bool in_object(esp_json_writer_handle_t w)
+{
+    size_t level = w->depth - 1;
+    return w->depth > 0 && ((w->stack[level / 8] >> (level % 8)) & 1);
+}
+
+/* Check that a value may be written here and write the separator */
+static esp_err_t value_begin(esp_json_writer_handle_t w)
+{
+    if (w->error != ESP_OK) {
+        return w->error;
+    }
+    if (w->depth == 0) {
+        return w->done ? writer_fail(w, ESP_ERR_INVALID_STATE) : ESP_OK;
+    }
+    if (in_object(w)) {
+        if (!w->after_key) {
+            return writer_fail(w, ESP_ERR_INVALID_STATE);
+        }
+        w->after_key = false;
+        return ESP_OK;
+    }
+    return w->need_comma ? out(w, ",", 1) : ESP_OK;
+}
+
+static esp_err_t value_end(esp_json_writer_handle_t w)
+{
+    if (w->error != ESP_OK) {
+        return w->error;
+    }
+    w->need_comma = true;
+    if (w->depth == 0) {
+        w->done = true;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t write_escaped(esp_json_writer_handle_t w, const char *str)
+{
+    esp_err_t err = out(w, "\"", 1);
+    while (err == ESP_OK && *str != '\0') {
+        /* write runs of characters which need no escaping at once */
+        size_t run = 0;
+        while (str[run] != '\0' && str[run] != '"' && str[run] != '\\' && (unsigned char) str[run] >= 0x20) {
+            run++;
+        }
+        if (run > 0) {
+            err = out(w, str, run);
+            str += run;
+            continue;
+        }
+
+        char escaped[7];
+        size_t len = 2;
+        escaped[0] = '\\';
+        switch (*str) {
+        case '"':
+        case '\\':
+            escaped[1] = *str;
+            break;
+        case '\b':
+            escaped[1] = 'b';
+            break;
+        case '\f':
+            escaped[1] = 'f';
+            break;
+        case '\n':
+            escaped[1] = 'n';
+            break;
+        case '\r':
+            escaped[1] = 'r';
+            break;
+        case '\t':
+            escaped[1] = 't';
+            break;
+        default:
+            len = (size_t) snprintf(escaped, sizeof(escaped), "\\u%04x", (unsigned char) *str);
+            break;
+        }
+        err = out(w, escaped, len);
+        str++;
+    }
+    return err == ESP_OK ? out(w, "\"", 1) : err;
+}
+
+esp_err_t esp_json_writer_create(const esp_json_writer_config_t *config, esp_json_writer_handle_t *out_writer)
+{
+    if (config == NULL || config->buffer == NULL || out_writer == NULL ||
+            config->buffer_size < (config->write_cb ? 1 : 2)) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    size_t max_depth = config->max_depth ? config->max_depth : WRITER_DEFAULT_MAX_DEPTH;
+    esp_json_writer_handle_t w = calloc(1, sizeof(struct esp_json_writer) + (max_depth + 7) / 8);
+    if (w == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    w->buffer = config->buffer;
+    w->capacity = config->write_cb ? config->buffer_size : config->buffer_size - 1;
+    w->write_cb = config->write_cb;
+    w->user_ctx = config->user_ctx;
+    w->max_depth = max_depth;
+    w->stack = (uint8_t *) (w + 1);
+
+    *out_writer = w;
+    return ESP_OK;
+}
+
+esp_err_t esp_json_writer_delete(esp_json_writer_handle_t writer)
+{
+    if (writer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    free(writer);
+    return ESP_OK;
+}
+
+static esp_err_t container_begin(esp_json_writer_handle_t w, bool object)
+{
+    if (w == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = value_begin(w);
+    if (err != ESP_OK) {
+        return err;
+    }
+    if (w->depth >= w->max_depth) {
+        return writer_fail(w, ESP_ERR_INVALID_SIZE);
+    }
+    size_t level = w->depth++;
+    if (object) {
+        w->stack[level / 8] |= (uint8_t) (1 << (level % 8));
+    } else {
+        w->stack[level / 8] &= (uint8_t) ~(1 << (level % 8));
+    }
+    w->need_comma = false;
+    return out(w, object ? "{" : "[", 1);
+}
+
+static esp_err_t container_end(esp_json_writer_handle_t w, bool object)
+{
+    if (w == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (w->error != ESP_OK) {
+        return w->error;
+    }
+    if (w->depth == 0 || in_object(w) != object || w->after_key) {
+        return writer_fail(w, ESP_ERR_INVALID_STATE);
+    }
+    w->depth--;
+    esp_err_t err = out(w, object ? "}" : "]", 1);
+    if (err != ESP_OK) {
+        return err;
+    }
+    return value_end(w);
+}
+
+esp_err_t esp_json_writer_begin_object(esp_json_writer_handle_t writer)
+{
+    return container_begin(writer, true);
+}
+
+esp_err_t esp_json_writer_begin_array(esp_json_writer_handle_t writer)
+{
+    return container_begin(writer, false);
+}
+
+esp_err_t esp_json_writer_end_object(esp_json_writer_handle_t writer)
+{
+    return container_end(writer, true);
+}
+
+esp_err_t esp_json_writer_end_array(esp_json_writer_handle_t writer)
+{
+    return container_end(writer, false);
+}
+
+esp_err_t esp_json_writer_key(esp_json_writer_handle_t writer, const char *key)
+{
+    if (writer == NULL || key == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (writer->error != ESP_OK) {
+        return writer->error;
+    }
+    if (!in_object(writer) || writer->after_key) {
+        return writer_fail(writer, ESP_ERR_INVALID_STATE);
+    }
+    esp_err_t err = writer->need_comma ? out(writer, ",", 1) : ESP_OK;
+    if (err == ESP_OK) {
+        err = write_escaped(writer, key);
+    }
+    if (err == ESP_OK) {
+        err = out(writer, ":", 1);
+    }
+    writer->after_key = true;
+    return err;
+}
+
+/* Write a value which is given as text */
+static esp_err_t write_value(esp_json_writer_handle_t w, const char *text, size_t len)
+{
+    if (w == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = value_begin(w);
+    if (err == ESP_OK) {
+        err = out(w, text, len);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    return value_end(w);
+}
+
+esp_err_t esp_json_writer_string(esp_json_writer_handle_t writer, const char *str)
+{
+    if (writer == NULL || str == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    esp_err_t err = value_begin(writer);
+    if (err == ESP_OK) {
+        err = write_escaped(writer, str);
+    }
+    if (err != ESP_OK) {
+        return err;
+    }
+    return value_end(writer);
+}
+
+esp_err_t esp_json_writer_number(esp_json_writer_handle_t writer, double number)
+{
+    char text[26];
+    int len;
+
+    /* same format as print_number of cJSON */
+    if (isnan(number) || isinf(number)) {
+        return write_value(writer, "null", 4);
+    }
+    if (number >= INT_MIN && number <= INT_MAX && number == (double) (int) number) {
+        len = snprintf(text, sizeof(text), "%d", (int) number);
+    } else {
+        /* try 15 decimal places of precision to avoid nonsignificant nonzero digits */
+        len = snprintf(text, sizeof(text), "%1.15g", number);
+        if (strtod(text, NULL) != number) {
+            /* if not, print with 17 decimal places of precision */
+            len = snprintf(text, sizeof(text), "%1.17g", number);
+        }
+    }
+    return write_value(writer, text, (size_t) len);
+}
+
+esp_err_t esp_json_writer_int(esp_json_writer_handle_t writer, int64_t number)
+{
+    char text[21];
+    int len = snprintf(text, sizeof(text), "%" PRId64, number);
+    return write_value(writer, text, (size_t) len);
+}
+
+esp_err_t esp_json_writer_bool(esp_json_writer_handle_t writer, bool value)
+{
+    return value ? write_value(writer, "true", 4) : write_value(writer, "false", 5);
+}
+
+esp_err_t esp_json_writer_null(esp_json_writer_handle_t writer)
+{
+    return write_value(writer, "null", 4);
+}
+
+esp_err_t esp_json_writer_cjson(esp_json_writer_handle_t writer, const cJSON *item)
+{
+    esp_err_t err;
+
+    if (writer == NULL || item == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    switch (item->type & 0xFF) {
+    case cJSON_NULL:
+        return esp_json_writer_null(writer);
+    case cJSON_False:
+        return esp_json_writer_bool(writer, false);
+    case cJSON_True:
+        return esp_json_writer_bool(writer, true);
+    case cJSON_Number:
+        return esp_json_writer_number(writer, item->valuedouble);
+    case cJSON_String:
+        return esp_json_writer_string(writer, item->valuestring ? item->valuestring : "");
+    case cJSON_Raw:
+        if (item->valuestring == NULL) {
+            return ESP_ERR_INVALID_ARG;
+        }
+        return write_value(writer, item->valuestring, strlen(item->valuestring));
+    case cJSON_Array:
+    case cJSON_Object: {
+        bool object = (item->type & 0xFF) == cJSON_Object;
+        err = container_begin(writer, object);
+        for (const cJSON *child = item->child; err == ESP_OK && child != NULL; child = child->next) {
+            if (object) {
+                err = esp_json_writer_key(writer, child->string ? child->string : "");
+            }
+            if (err == ESP_OK) {
+                err = esp_json_writer_cjson(writer, child);
+            }
+        }
+        if (err != ESP_OK) {
+            return err;
+        }
+        return container_end(writer, object);
+    }
+    default:
+        return ESP_ERR_INVALID_ARG;
+    }
+}
+
+esp_err_t esp_json_writer_finish(esp_json_writer_handle_t writer, size_t *out_len)
+{
+    if (writer == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (writer->error != ESP_OK) {
+        return writer->error;
+    }
+    if (!writer->done) {
+        return writer_fail(writer, ESP_ERR_INVALID_STATE);
+    }
+    size_t len = writer->flushed + writer->used;
+    if (writer->write_cb) {
+        esp_err_t err = flush(writer);
+        if (err != ESP_OK) {
+            return writer_fail(writer, err);
+        }
+    } else {
+        writer->buffer[writer->used] = '\0';
+    }
+    if (out_len) {
+        *out_len = len;
+    }
+    return ESP_OK;
+}
@@ -0,0 +1,576 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ *
+ * Linux host test of the streaming JSON reader and the incremental JSON writer
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "esp_err.h"
+#include "cJSON.h"
+#include "esp_json_reader.h"
+#include "esp_json_writer.h"
+#include "unity.h"
+#include "unity_fixture.h"
+
+/* Text log of reader events, used to compare event sequences */
+typedef struct {
+    char *text;
+    size_t len;
+    size_t size;
+} event_log_t;
+
+static void log_append(event_log_t *log, const char *text, size_t len)
+{
+    if (log->len + len + 1 > log->size) {
+        log->size = (log->len + len + 1) * 2;
+        log->text = realloc(log->text, log->size);
+        TEST_ASSERT_NOT_NULL(log->text);
+    }
+    memcpy(log->text + log->len, text, len);
+    log->len += len;
+    log->text[log->len] = '\0';
+}
+
+static esp_err_t log_event(const esp_json_event_t *event, void *user_ctx)
+{
+    static const char *const names[] = { "{", "}", "[", "]", "K", "S", "N", "B", "null" };
+    event_log_t *log = user_ctx;
+    char prefix[32];
+
+    int len = snprintf(prefix, sizeof(prefix), "%u%s%s", (unsigned) event->depth, names[event->type], event->partial ? "+" : "");
+    log_append(log, prefix, len);
+    if (event->type == ESP_JSON_EVENT_BOOL) {
+        log_append(log, event->boolean ? "1" : "0", 1);
+    }
+    if (event->value) {
+        log_append(log, "(", 1);
+        log_append(log, event->value, event->value_len);
+        log_append(log, ")", 1);
+    }
+    log_append(log, " ", 1);
+    return ESP_OK;
+}
+
+static esp_err_t feed_in_chunks(esp_json_reader_handle_t reader, const char *json, size_t len, size_t chunk)
+{
+    for (size_t offset = 0; offset < len; offset += chunk) {
+        size_t n = (len - offset < chunk) ? len - offset : chunk;
+        esp_err_t err = esp_json_reader_feed(reader, json + offset, n);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    return esp_json_reader_finish(reader);
+}
+
+/* Parse json with the reader in chunks of the given size and return the event log */
+static char *read_events(const char *json, size_t chunk, size_t max_token_len, esp_err_t *out_err)
+{
+    event_log_t log = { 0 };
+    esp_json_reader_config_t config = {
+        .event_cb = log_event,
+        .user_ctx = &log,
+        .max_token_len = max_token_len,
+    };
+    esp_json_reader_handle_t reader;
+
+    TEST_ESP_OK(esp_json_reader_create(&config, &reader));
+    *out_err = feed_in_chunks(reader, json, strlen(json), chunk);
+    TEST_ESP_OK(esp_json_reader_delete(reader));
+    log_append(&log, "", 0);
+    return log.text;
+}
+
+/* Build a configuration like document of about the given size */
+static char *create_document(size_t size)
+{
+    char *json = malloc(size + 1024);
+    TEST_ASSERT_NOT_NULL(json);
+    size_t len = sprintf(json, "{\"version\":3,\"unicode\":\"\\u00e4\\ud83d\\ude00\",\"devices\":[");
+    for (int i = 0; len < size; i++) {
+        len += sprintf(json + len,
+                       "%s{\"id\":%d,\"name\":\"sensor \\\"%d\\\"\",\"enabled\":%s,\"interval_ms\":%d,\"threshold\":%d.%d,"
+                       "\"tags\":[\"room%d\",\"floor%d\",null],\"calibration\":{\"offset\":-%d.25,\"gain\":1.5e-%d}}",
+                       (i > 0) ? "," : "", i, i, (i % 3) ? "true" : "false", 100 * (i + 1),
+                       i, i % 10, i % 20, i % 4, i % 7, i % 9 + 1);
+    }
+    strcpy(json + len, "]}");
+    return json;
+}
+
+static uint64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+TEST_GROUP(json_stream);
+
+TEST_SETUP(json_stream)
+{
+}
+
+TEST_TEAR_DOWN(json_stream)
+{
+    cJSON_InitHooks(NULL);
+}
+
+TEST(json_stream, reader_reports_events)
+{
+    const char *json = " {\"a\" : [1, -2.5e3, \"x\\ty\", true, false, null, {}, []], \"b\\u00e4\":{\"c\":\"\\ud83d\\ude00\"}} ";
+    const char *expected = "0{ 1K(a) 1[ 2N(1) 2N(-2.5e3) 2S(x\ty) 2B1 2B0 2null 2{ 2} 2[ 2] 1] "
+                           "1K(b\xc3\xa4) 1{ 2K(c) 2S(\xf0\x9f\x98\x80) 1} 0} ";
+    esp_err_t err;
+
+    for (size_t chunk = 1; chunk <= strlen(json); chunk++) {
+        char *events = read_events(json, chunk, 0, &err);
+        TEST_ESP_OK(err);
+        TEST_ASSERT_EQUAL_STRING(expected, events);
+        free(events);
+    }
+}
+
+TEST(json_stream, reader_top_level_values)
+{
+    esp_err_t err;
+    char *events;
+
+    events = read_events("42", 1, 0, &err);
+    TEST_ESP_OK(err);
+    TEST_ASSERT_EQUAL_STRING("0N(42) ", events);
+    free(events);
+
+    events = read_events("\"s\"  ", 2, 0, &err);
+    TEST_ESP_OK(err);
+    TEST_ASSERT_EQUAL_STRING("0S(s) ", events);
+    free(events);
+
+    events = read_events("", 1, 0, &err);
+    TEST_ASSERT_EQUAL(ESP_FAIL, err);
+    free(events);
+}
+
+TEST(json_stream, reader_rejects_invalid_json)
+{
+    static const struct {
+        const char *json;
+        size_t offset;
+    } cases[] = {
+        { "[1,]", 3 },
+        { "{\"a\" 1}", 5 },
+        { "{\"a\":1,}", 7 },
+        { "[01]", 3 },
+        { "[1.]", 3 },
+        { "[-]", 2 },
+        { "[1e]", 3 },
+        { "[tru]", 4 },
+        { "[nul", 4 },
+        { "[\"a\nb\"]", 3 },
+        { "[\"\\x\"]", 3 },
+        { "[\"\\ud83d\"]", 8 },
+        { "[\"\\ude00\"]", 7 },
+        { "[1] 2", 4 },
+        { "{1:2}", 1 },
+        { "[1}", 2 },
+        { "{\"a\":1]", 6 },
+    };
+    event_log_t log = { 0 };
+    esp_json_reader_config_t config = {
+        .event_cb = log_event,
+        .user_ctx = &log,
+    };
+    esp_json_reader_handle_t reader;
+
+    TEST_ESP_OK(esp_json_reader_create(&config, &reader));
+    for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); i++) {
+        TEST_ESP_OK(esp_json_reader_reset(reader));
+        esp_err_t err = feed_in_chunks(reader, cases[i].json, strlen(cases[i].json), 1);
+        TEST_ASSERT_EQUAL_MESSAGE(ESP_FAIL, err, cases[i].json);
+        TEST_ASSERT_EQUAL_MESSAGE(cases[i].offset, esp_json_reader_get_offset(reader), cases[i].json);
+        /* the error is sticky */
+        TEST_ASSERT_EQUAL(ESP_FAIL, esp_json_reader_feed(reader, "1", 1));
+    }
+    TEST_ESP_OK(esp_json_reader_delete(reader));
+    free(log.text);
+}
+
+TEST(json_stream, reader_limits)
+{
+    esp_err_t err;
+    char *events;
+
+    /* string values longer than max_token_len are delivered in parts */
+    events = read_events("[\"abcdefghij\"]", 3, 4, &err);
+    TEST_ESP_OK(err);
+    TEST_ASSERT_EQUAL_STRING("0[ 1S+(abcd) 1S+(efgh) 1S(ij) 0] ", events);
+    free(events);
+
+    /* keys and numbers must fit */
+    events = read_events("{\"abcde\":1}", 1, 4, &err);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, err);
+    free(events);
+    events = read_events("[12345]", 1, 4, &err);
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, err);
+    free(events);
+
+    /* nesting depth */
+    event_log_t log = { 0 };
+    esp_json_reader_config_t config = {
+        .event_cb = log_event,
+        .user_ctx = &log,
+        .max_depth = 3,
+    };
+    esp_json_reader_handle_t reader;
+    TEST_ESP_OK(esp_json_reader_create(&config, &reader));
+    TEST_ESP_OK(feed_in_chunks(reader, "[[[]]]", 6, 6));
+    TEST_ESP_OK(esp_json_reader_reset(reader));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, feed_in_chunks(reader, "[[[[]]]]", 8, 8));
+    TEST_ESP_OK(esp_json_reader_delete(reader));
+    free(log.text);
+
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_json_reader_create(NULL, &reader));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_ARG, esp_json_reader_feed(NULL, "1", 1));
+}
+
+static esp_err_t stop_at_key(const esp_json_event_t *event, void *user_ctx)
+{
+    return event->type == ESP_JSON_EVENT_KEY ? ESP_ERR_NOT_FINISHED : ESP_OK;
+}
+
+TEST(json_stream, reader_callback_stops_parsing)
+{
+    esp_json_reader_config_t config = {
+        .event_cb = stop_at_key,
+    };
+    esp_json_reader_handle_t reader;
+
+    TEST_ESP_OK(esp_json_reader_create(&config, &reader));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FINISHED, esp_json_reader_feed(reader, "{\"a\":1}", 7));
+    TEST_ASSERT_EQUAL(ESP_ERR_NOT_FINISHED, esp_json_reader_finish(reader));
+    TEST_ESP_OK(esp_json_reader_delete(reader));
+}
+
+TEST(json_stream, writer_writes_tokens)
+{
+    char buffer[128];
+    esp_json_writer_config_t config = {
+        .buffer = buffer,
+        .buffer_size = sizeof(buffer),
+    };
+    esp_json_writer_handle_t writer;
+    size_t len;
+
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_begin_object(writer));
+    TEST_ESP_OK(esp_json_writer_key(writer, "name"));
+    TEST_ESP_OK(esp_json_writer_string(writer, "a\"b\\c\n\x01"));
+    TEST_ESP_OK(esp_json_writer_key(writer, "values"));
+    TEST_ESP_OK(esp_json_writer_begin_array(writer));
+    TEST_ESP_OK(esp_json_writer_int(writer, -9007199254740993LL));
+    TEST_ESP_OK(esp_json_writer_number(writer, 0.1));
+    TEST_ESP_OK(esp_json_writer_number(writer, 1.0 / 0.0));
+    TEST_ESP_OK(esp_json_writer_bool(writer, true));
+    TEST_ESP_OK(esp_json_writer_null(writer));
+    TEST_ESP_OK(esp_json_writer_begin_object(writer));
+    TEST_ESP_OK(esp_json_writer_end_object(writer));
+    TEST_ESP_OK(esp_json_writer_end_array(writer));
+    TEST_ESP_OK(esp_json_writer_end_object(writer));
+    TEST_ESP_OK(esp_json_writer_finish(writer, &len));
+    TEST_ASSERT_EQUAL_STRING("{\"name\":\"a\\\"b\\\\c\\n\\u0001\",\"values\":[-9007199254740993,0.1,null,true,null,{}]}", buffer);
+    TEST_ASSERT_EQUAL(strlen(buffer), len);
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+}
+
+TEST(json_stream, writer_checks_structure)
+{
+    char buffer[16];
+    esp_json_writer_config_t config = {
+        .buffer = buffer,
+        .buffer_size = sizeof(buffer),
+    };
+    esp_json_writer_handle_t writer;
+
+    /* value without key */
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_begin_object(writer));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_json_writer_int(writer, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_json_writer_end_object(writer));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+
+    /* mismatched end, key in array */
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_begin_array(writer));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_json_writer_key(writer, "a"));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_begin_array(writer));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_json_writer_end_object(writer));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+
+    /* unfinished document, second top level value */
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_begin_array(writer));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_json_writer_finish(writer, NULL));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_int(writer, 1));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_STATE, esp_json_writer_int(writer, 2));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+
+    /* output doesn't fit and there is no callback */
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_json_writer_string(writer, "0123456789abcdef"));
+    TEST_ASSERT_EQUAL(ESP_ERR_INVALID_SIZE, esp_json_writer_finish(writer, NULL));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+}
+
+static esp_err_t collect_output(const char *data, size_t len, void *user_ctx)
+{
+    log_append(user_ctx, data, len);
+    return ESP_OK;
+}
+
+TEST(json_stream, writer_matches_cjson_print)
+{
+    char buffer[16];
+    event_log_t output = { 0 };
+    esp_json_writer_config_t config = {
+        .buffer = buffer,
+        .buffer_size = sizeof(buffer),
+        .write_cb = collect_output,
+        .user_ctx = &output,
+    };
+    esp_json_writer_handle_t writer;
+    char *json = create_document(16 * 1024);
+    cJSON *tree = cJSON_Parse(json);
+    TEST_ASSERT_NOT_NULL(tree);
+    char *expected = cJSON_PrintUnformatted(tree);
+    size_t len;
+
+    TEST_ESP_OK(esp_json_writer_create(&config, &writer));
+    TEST_ESP_OK(esp_json_writer_cjson(writer, tree));
+    TEST_ESP_OK(esp_json_writer_finish(writer, &len));
+    TEST_ASSERT_EQUAL_STRING(expected, output.text);
+    TEST_ASSERT_EQUAL(strlen(expected), len);
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+
+    cJSON_free(expected);
+    cJSON_Delete(tree);
+    free(output.text);
+    free(json);
+}
+
+/* Reproduce the document read by the reader with the writer */
+static esp_err_t copy_event(const esp_json_event_t *event, void *user_ctx)
+{
+    esp_json_writer_handle_t writer = user_ctx;
+
+    switch (event->type) {
+    case ESP_JSON_EVENT_OBJECT_START:
+        return esp_json_writer_begin_object(writer);
+    case ESP_JSON_EVENT_OBJECT_END:
+        return esp_json_writer_end_object(writer);
+    case ESP_JSON_EVENT_ARRAY_START:
+        return esp_json_writer_begin_array(writer);
+    case ESP_JSON_EVENT_ARRAY_END:
+        return esp_json_writer_end_array(writer);
+    case ESP_JSON_EVENT_KEY:
+        return esp_json_writer_key(writer, event->value);
+    case ESP_JSON_EVENT_STRING:
+        return esp_json_writer_string(writer, event->value);
+    case ESP_JSON_EVENT_NUMBER:
+        return esp_json_writer_number(writer, event->number);
+    case ESP_JSON_EVENT_BOOL:
+        return esp_json_writer_bool(writer, event->boolean);
+    case ESP_JSON_EVENT_NULL:
+        return esp_json_writer_null(writer);
+    }
+    return ESP_FAIL;
+}
+
+TEST(json_stream, reader_to_writer_round_trip)
+{
+    char buffer[64];
+    event_log_t output = { 0 };
+    esp_json_writer_config_t writer_config = {
+        .buffer = buffer,
+        .buffer_size = sizeof(buffer),
+        .write_cb = collect_output,
+        .user_ctx = &output,
+    };
+    esp_json_writer_handle_t writer;
+    esp_json_reader_handle_t reader;
+    char *json = create_document(16 * 1024);
+    cJSON *tree = cJSON_Parse(json);
+    TEST_ASSERT_NOT_NULL(tree);
+    char *expected = cJSON_PrintUnformatted(tree);
+
+    TEST_ESP_OK(esp_json_writer_create(&writer_config, &writer));
+    esp_json_reader_config_t reader_config = {
+        .event_cb = copy_event,
+        .user_ctx = writer,
+    };
+    TEST_ESP_OK(esp_json_reader_create(&reader_config, &reader));
+    TEST_ESP_OK(feed_in_chunks(reader, json, strlen(json), 100));
+    TEST_ESP_OK(esp_json_writer_finish(writer, NULL));
+    TEST_ASSERT_EQUAL_STRING(expected, output.text);
+
+    TEST_ESP_OK(esp_json_reader_delete(reader));
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+    cJSON_free(expected);
+    cJSON_Delete(tree);
+    free(output.text);
+    free(json);
+}
+
+/* Allocation hooks for cJSON which track the peak amount of allocated memory */
+static size_t s_heap_used;
+static size_t s_heap_peak;
+
+static void *tracking_malloc(size_t size)
+{
+    size_t *block = malloc(sizeof(size_t) + size);
+    if (block == NULL) {
+        return NULL;
+    }
+    *block = size;
+    s_heap_used += size;
+    if (s_heap_used > s_heap_peak) {
+        s_heap_peak = s_heap_used;
+    }
+    return block + 1;
+}
+
+static void tracking_free(void *pointer)
+{
+    if (pointer) {
+        size_t *block = (size_t *) pointer - 1;
+        s_heap_used -= *block;
+        free(block);
+    }
+}
+
+static esp_err_t count_event(const esp_json_event_t *event, void *user_ctx)
+{
+    (*(size_t *) user_ctx)++;
+    return ESP_OK;
+}
+
+static esp_err_t discard_output(const char *data, size_t len, void *user_ctx)
+{
+    *(size_t *) user_ctx += len;
+    return ESP_OK;
+}
+
+TEST(json_stream, compare_with_cjson)
+{
+    const size_t chunk_size = 1024;
+    const size_t reader_token_len = 256;
+    const size_t writer_buffer_size = 512;
+    char *json = create_document(300 * 1024);
+    size_t json_len = strlen(json);
+    cJSON_Hooks hooks = {
+        .malloc_fn = tracking_malloc,
+        .free_fn = tracking_free,
+    };
+    uint64_t start;
+
+    cJSON_InitHooks(&hooks);
+
+    /* cJSON_Parse needs the whole text and the whole tree at the same time */
+    s_heap_used = s_heap_peak = 0;
+    start = time_us();
+    cJSON *tree = cJSON_ParseWithLength(json, json_len);
+    uint64_t cjson_parse_us = time_us() - start;
+    TEST_ASSERT_NOT_NULL(tree);
+    size_t cjson_parse_peak = s_heap_peak + json_len;
+
+    /* the reader needs one chunk of the text, and allocates its state (less than 128 bytes), token buffer and nesting stack once */
+    size_t events = 0;
+    esp_json_reader_config_t reader_config = {
+        .event_cb = count_event,
+        .user_ctx = &events,
+        .max_token_len = reader_token_len,
+    };
+    esp_json_reader_handle_t reader;
+    TEST_ESP_OK(esp_json_reader_create(&reader_config, &reader));
+    start = time_us();
+    TEST_ESP_OK(feed_in_chunks(reader, json, json_len, chunk_size));
+    uint64_t reader_us = time_us() - start;
+    TEST_ESP_OK(esp_json_reader_delete(reader));
+    size_t reader_peak = chunk_size + reader_token_len + 1 + 32 / 8 + 128;
+
+    /* cJSON_PrintUnformatted builds the whole output */
+    s_heap_used = s_heap_peak = 0;
+    start = time_us();
+    char *printed = cJSON_PrintUnformatted(tree);
+    uint64_t cjson_print_us = time_us() - start;
+    TEST_ASSERT_NOT_NULL(printed);
+    size_t cjson_print_peak = s_heap_peak;
+    size_t printed_len = strlen(printed);
+    cJSON_free(printed);
+
+    /* the writer needs its buffer only */
+    char *buffer = malloc(writer_buffer_size);
+    size_t written = 0;
+    esp_json_writer_config_t writer_config = {
+        .buffer = buffer,
+        .buffer_size = writer_buffer_size,
+        .write_cb = discard_output,
+        .user_ctx = &written,
+    };
+    esp_json_writer_handle_t writer;
+    TEST_ESP_OK(esp_json_writer_create(&writer_config, &writer));
+    start = time_us();
+    TEST_ESP_OK(esp_json_writer_cjson(writer, tree));
+    TEST_ESP_OK(esp_json_writer_finish(writer, NULL));
+    uint64_t writer_us = time_us() - start;
+    TEST_ESP_OK(esp_json_writer_delete(writer));
+    TEST_ASSERT_EQUAL(printed_len, written);
+    free(buffer);
+
+    cJSON_Delete(tree);
+    cJSON_InitHooks(NULL);
+
+    printf("parsing %u bytes, %u events\n", (unsigned) json_len, (unsigned) events);
+    printf("cJSON_Parse:            peak %7u bytes, %6.1f MB/s\n", (unsigned) cjson_parse_peak, (double) json_len / (cjson_parse_us + 1));
+    printf("esp_json_reader:        peak %7u bytes, %6.1f MB/s\n", (unsigned) reader_peak, (double) json_len / (reader_us + 1));
+    printf("printing %u bytes\n", (unsigned) printed_len);
+    printf("cJSON_PrintUnformatted: peak %7u bytes, %6.1f MB/s\n", (unsigned) cjson_print_peak, (double) printed_len / (cjson_print_us + 1));
+    printf("esp_json_writer:        peak %7u bytes, %6.1f MB/s\n", (unsigned) writer_buffer_size, (double) printed_len / (writer_us + 1));
+
+    TEST_ASSERT_LESS_THAN(cjson_parse_peak / 100, reader_peak);
+    TEST_ASSERT_LESS_THAN(cjson_print_peak / 100, writer_buffer_size);
+    free(json);
+}
+
+TEST_GROUP_RUNNER(json_stream)
+{
+    RUN_TEST_CASE(json_stream, reader_reports_events);
+    RUN_TEST_CASE(json_stream, reader_top_level_values);
+    RUN_TEST_CASE(json_stream, reader_rejects_invalid_json);
+    RUN_TEST_CASE(json_stream, reader_limits);
+    RUN_TEST_CASE(json_stream, reader_callback_stops_parsing);
+    RUN_TEST_CASE(json_stream, writer_writes_tokens);
+    RUN_TEST_CASE(json_stream, writer_checks_structure);
+    RUN_TEST_CASE(json_stream, writer_matches_cjson_print);
+    RUN_TEST_CASE(json_stream, reader_to_writer_round_trip);
+    RUN_TEST_CASE(json_stream, compare_with_cjson);
+}
+
+static void run_all_tests(void)
+{
+    RUN_TEST_GROUP(json_stream);
+}
+
+int main(int argc, char **argv)
+{
+    UNITY_MAIN_FUNC(run_all_tests);
+    return 0;
+}
@@ -0,0 +1,96 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include "esp_err.h"
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of a parsed JSON document
+ *
+ * All items and strings of the document are allocated from one arena, so the whole
+ * tree is released by a single call to esp_json_doc_delete.
+ */
+typedef struct esp_json_doc *esp_json_doc_handle_t;
+
+/**
+ * @brief Configuration of esp_json_parse
+ */
+typedef struct {
+    void *buffer;           /*!< Memory for the document. If NULL, the document is allocated from the heap in blocks of block_size bytes */
+    size_t buffer_size;     /*!< Size of buffer, in bytes */
+    size_t block_size;      /*!< Size of the heap blocks, 0 selects the cJSON default. Ignored if buffer is set */
+} esp_json_parse_config_t;
+
+/**
+ * @brief Default configuration: document allocated from the heap in default sized blocks
+ */
+#define ESP_JSON_PARSE_CONFIG_DEFAULT() { \
+    .buffer = NULL, \
+    .buffer_size = 0, \
+    .block_size = 0, \
+}
+
+/**
+ * @brief Parse a JSON text into a document
+ *
+ * Compared to cJSON_Parse, the tree is not allocated node by node: with a caller supplied
+ * buffer parsing does not touch the heap at all, otherwise a few large blocks are allocated.
+ *
+ * The tree returned by esp_json_doc_get_root must not be modified structurally and must
+ * not be passed to cJSON_Delete.
+ *
+ * @param json  JSON text, does not need to be null terminated
+ * @param len  Length of the JSON text, in bytes
+ * @param config  Parser configuration, NULL for ESP_JSON_PARSE_CONFIG_DEFAULT()
+ * @param[out] out_doc  Handle of the parsed document
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if json or out_doc is NULL, len is 0 or config->buffer is too small to hold a document
+ *          - ESP_ERR_NO_MEM if the document could not be allocated
+ *          - ESP_FAIL if json is not valid JSON, or the tree did not fit into config->buffer or the heap
+ */
+esp_err_t esp_json_parse(const char *json, size_t len, const esp_json_parse_config_t *config, esp_json_doc_handle_t *out_doc);
+
+/**
+ * @brief Get the root item of a parsed document
+ *
+ * @param doc  Document handle
+ * @return root item, NULL if doc is NULL
+ */
+const cJSON *esp_json_doc_get_root(esp_json_doc_handle_t doc);
+
+/**
+ * @brief Get the amount of memory taken by the items and strings of a document
+ *
+ * @param doc  Document handle
+ * @return number of bytes, 0 if doc is NULL
+ */
+size_t esp_json_doc_get_used(esp_json_doc_handle_t doc);
+
+/**
+ * @brief Release a document and all its items
+ *
+ * For a document parsed into a caller supplied buffer, the buffer can be reused afterwards.
+ *
+ * @param doc  Document handle
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if doc is NULL
+ */
+esp_err_t esp_json_doc_delete(esp_json_doc_handle_t doc);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,159 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of a streaming JSON reader
+ *
+ * The reader parses JSON text which is fed in chunks of any size and reports every
+ * token through a callback, without building a tree. All memory is allocated when
+ * the reader is created, so the memory needed to parse a document does not depend
+ * on its size.
+ */
+typedef struct esp_json_reader *esp_json_reader_handle_t;
+
+/**
+ * @brief Types of the reader events
+ */
+typedef enum {
+    ESP_JSON_EVENT_OBJECT_START,    /*!< '{' */
+    ESP_JSON_EVENT_OBJECT_END,      /*!< '}' */
+    ESP_JSON_EVENT_ARRAY_START,     /*!< '[' */
+    ESP_JSON_EVENT_ARRAY_END,       /*!< ']' */
+    ESP_JSON_EVENT_KEY,             /*!< Key of the next object member, in value */
+    ESP_JSON_EVENT_STRING,          /*!< String, in value; long strings are delivered in several parts */
+    ESP_JSON_EVENT_NUMBER,          /*!< Number, in number; value holds the number as written in the input */
+    ESP_JSON_EVENT_BOOL,            /*!< true or false, in boolean */
+    ESP_JSON_EVENT_NULL,            /*!< null */
+} esp_json_event_type_t;
+
+/**
+ * @brief Event reported by the reader
+ *
+ * value is only valid during the callback.
+ */
+typedef struct {
+    esp_json_event_type_t type;     /*!< Type of the event */
+    const char *value;              /*!< KEY and STRING: unescaped text, NUMBER: literal. Null terminated. NULL for other events */
+    size_t value_len;               /*!< Length of value, in bytes */
+    double number;                  /*!< Value of a NUMBER */
+    bool boolean;                   /*!< Value of a BOOL */
+    bool partial;                   /*!< STRING only: more parts of the same string follow */
+    size_t depth;                   /*!< Nesting level; 0 for the top level value, START and END events of a container have the same depth */
+} esp_json_event_t;
+
+/**
+ * @brief Reader event callback
+ *
+ * @param event  Event
+ * @param user_ctx  User context from the reader configuration
+ *
+ * @return ESP_OK to continue parsing, any other value stops the reader and is returned by esp_json_reader_feed
+ */
+typedef esp_err_t (*esp_json_event_cb_t)(const esp_json_event_t *event, void *user_ctx);
+
+/**
+ * @brief Configuration of a streaming JSON reader
+ */
+typedef struct {
+    esp_json_event_cb_t event_cb;   /*!< Event callback */
+    void *user_ctx;                 /*!< User context passed to event_cb */
+    size_t max_token_len;           /*!< Longest key or number, and size of the string parts, in bytes. 0 selects 256 */
+    size_t max_depth;               /*!< Deepest nesting of arrays and objects. 0 selects 32 */
+} esp_json_reader_config_t;
+
+/**
+ * @brief Create a streaming JSON reader
+ *
+ * @param config  Reader configuration
+ * @param[out] out_reader  Handle of the new reader
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if config, config->event_cb or out_reader is NULL
+ *          - ESP_ERR_NO_MEM if the reader could not be allocated
+ */
+esp_err_t esp_json_reader_create(const esp_json_reader_config_t *config, esp_json_reader_handle_t *out_reader);
+
+/**
+ * @brief Feed the next chunk of the JSON text to the reader
+ *
+ * Events are reported from this function as soon as the tokens are complete. Tokens
+ * may span any number of chunks.
+ *
+ * @param reader  Reader handle
+ * @param data  Chunk of the JSON text
+ * @param len  Length of the chunk, in bytes
+ *
+ * @return
+ *          - ESP_OK if the chunk was consumed
+ *          - ESP_ERR_INVALID_ARG if reader is NULL, or data is NULL and len is not 0
+ *          - ESP_FAIL if the text is not valid JSON
+ *          - ESP_ERR_INVALID_SIZE if a key or number is longer than max_token_len, or the nesting is deeper than max_depth
+ *          - the value returned by the event callback if it stopped the reader
+ *          Once an error was returned, the reader keeps returning it until it is reset.
+ */
+esp_err_t esp_json_reader_feed(esp_json_reader_handle_t reader, const char *data, size_t len);
+
+/**
+ * @brief Signal the end of the JSON text
+ *
+ * Completes a number at the top level, which can't be terminated otherwise.
+ *
+ * @param reader  Reader handle
+ *
+ * @return
+ *          - ESP_OK if a complete JSON value was read
+ *          - ESP_ERR_INVALID_ARG if reader is NULL
+ *          - ESP_FAIL if the text ended before the value was complete
+ *          - the error returned earlier by esp_json_reader_feed
+ */
+esp_err_t esp_json_reader_finish(esp_json_reader_handle_t reader);
+
+/**
+ * @brief Get the number of bytes consumed by the reader
+ *
+ * After an error, this is the offset of the byte which caused it.
+ *
+ * @param reader  Reader handle
+ * @return offset from the start of the JSON text, 0 if reader is NULL
+ */
+size_t esp_json_reader_get_offset(esp_json_reader_handle_t reader);
+
+/**
+ * @brief Prepare the reader for a new JSON text
+ *
+ * @param reader  Reader handle
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if reader is NULL
+ */
+esp_err_t esp_json_reader_reset(esp_json_reader_handle_t reader);
+
+/**
+ * @brief Delete a reader
+ *
+ * @param reader  Reader handle
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if reader is NULL
+ */
+esp_err_t esp_json_reader_delete(esp_json_reader_handle_t reader);
+
+#ifdef __cplusplus
+}
+#endif
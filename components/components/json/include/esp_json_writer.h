@@ -0,0 +1,200 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "cJSON.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief Handle of an incremental JSON writer
+ *
+ * The writer produces unformatted JSON text token by token into a fixed buffer,
+ * which is passed to a callback whenever it is full. A document of any size can
+ * be produced without holding it in memory, e.g. directly into a socket.
+ */
+typedef struct esp_json_writer *esp_json_writer_handle_t;
+
+/**
+ * @brief Writer output callback
+ *
+ * @param data  Next part of the JSON text
+ * @param len  Length of data, in bytes
+ * @param user_ctx  User context from the writer configuration
+ *
+ * @return ESP_OK to continue, any other value stops the writer and is returned by the writer functions
+ */
+typedef esp_err_t (*esp_json_write_cb_t)(const char *data, size_t len, void *user_ctx);
+
+/**
+ * @brief Configuration of an incremental JSON writer
+ */
+typedef struct {
+    char *buffer;                   /*!< Output buffer, owned by the caller */
+    size_t buffer_size;             /*!< Size of buffer, in bytes */
+    esp_json_write_cb_t write_cb;   /*!< Called when buffer is full and by esp_json_writer_finish. If NULL, the whole output and a null terminator must fit into buffer */
+    void *user_ctx;                 /*!< User context passed to write_cb */
+    size_t max_depth;               /*!< Deepest nesting of arrays and objects. 0 selects 32 */
+} esp_json_writer_config_t;
+
+/**
+ * @brief Create an incremental JSON writer
+ *
+ * @param config  Writer configuration
+ * @param[out] out_writer  Handle of the new writer
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if config, config->buffer or out_writer is NULL, or buffer_size is 0
+ *          - ESP_ERR_NO_MEM if the writer could not be allocated
+ */
+esp_err_t esp_json_writer_create(const esp_json_writer_config_t *config, esp_json_writer_handle_t *out_writer);
+
+/**
+ * @brief Delete a writer
+ *
+ * Output which was not flushed by esp_json_writer_finish is discarded.
+ *
+ * @param writer  Writer handle
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if writer is NULL
+ */
+esp_err_t esp_json_writer_delete(esp_json_writer_handle_t writer);
+
+/**
+ * @brief Start an object or an array
+ *
+ * Like all functions writing a value, these must be called at the top level before
+ * any value was written, in an array, or in an object after esp_json_writer_key.
+ *
+ * @param writer  Writer handle
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if writer is NULL
+ *          - ESP_ERR_INVALID_STATE if a value is not expected here
+ *          - ESP_ERR_INVALID_SIZE if the nesting would get deeper than max_depth, or the output doesn't fit into the buffer and write_cb is NULL
+ *          - the value returned by write_cb if it failed
+ *          Once an error was returned, all further calls return it.
+ */
+esp_err_t esp_json_writer_begin_object(esp_json_writer_handle_t writer);
+
+/** @brief Start an array, see esp_json_writer_begin_object */
+esp_err_t esp_json_writer_begin_array(esp_json_writer_handle_t writer);
+
+/**
+ * @brief End the innermost object or array
+ *
+ * @param writer  Writer handle
+ *
+ * @return same as esp_json_writer_begin_object; ESP_ERR_INVALID_STATE if the innermost container is not of this type or a key has no value
+ */
+esp_err_t esp_json_writer_end_object(esp_json_writer_handle_t writer);
+
+/** @brief End the innermost array, see esp_json_writer_end_object */
+esp_err_t esp_json_writer_end_array(esp_json_writer_handle_t writer);
+
+/**
+ * @brief Write the key of the next object member
+ *
+ * @param writer  Writer handle
+ * @param key  Null terminated key, escaped as needed
+ *
+ * @return same as esp_json_writer_begin_object; ESP_ERR_INVALID_STATE if not in an object or the previous key has no value
+ */
+esp_err_t esp_json_writer_key(esp_json_writer_handle_t writer, const char *key);
+
+/**
+ * @brief Write a string value
+ *
+ * @param writer  Writer handle
+ * @param str  Null terminated string, escaped as needed
+ *
+ * @return see esp_json_writer_begin_object
+ */
+esp_err_t esp_json_writer_string(esp_json_writer_handle_t writer, const char *str);
+
+/**
+ * @brief Write a number value
+ *
+ * Formatted like cJSON_Print does. Infinity and NaN are written as null.
+ *
+ * @param writer  Writer handle
+ * @param number  Number
+ *
+ * @return see esp_json_writer_begin_object
+ */
+esp_err_t esp_json_writer_number(esp_json_writer_handle_t writer, double number);
+
+/**
+ * @brief Write an integer value
+ *
+ * @param writer  Writer handle
+ * @param number  Integer
+ *
+ * @return see esp_json_writer_begin_object
+ */
+esp_err_t esp_json_writer_int(esp_json_writer_handle_t writer, int64_t number);
+
+/**
+ * @brief Write true or false
+ *
+ * @param writer  Writer handle
+ * @param value  Boolean
+ *
+ * @return see esp_json_writer_begin_object
+ */
+esp_err_t esp_json_writer_bool(esp_json_writer_handle_t writer, bool value);
+
+/**
+ * @brief Write null
+ *
+ * @param writer  Writer handle
+ *
+ * @return see esp_json_writer_begin_object
+ */
+esp_err_t esp_json_writer_null(esp_json_writer_handle_t writer);
+
+/**
+ * @brief Write a cJSON item and all its children as a value
+ *
+ * Produces the same text as cJSON_PrintUnformatted, without building it in memory.
+ *
+ * @param writer  Writer handle
+ * @param item  cJSON item
+ *
+ * @return see esp_json_writer_begin_object; ESP_ERR_INVALID_ARG if item is NULL or invalid
+ */
+esp_err_t esp_json_writer_cjson(esp_json_writer_handle_t writer, const cJSON *item);
+
+/**
+ * @brief Complete the document and pass the remaining output to write_cb
+ *
+ * Without write_cb, the output is null terminated in the buffer.
+ *
+ * @param writer  Writer handle
+ * @param[out] out_len  Total length of the output, may be NULL
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if writer is NULL
+ *          - ESP_ERR_INVALID_STATE if no value was written or a container is still open
+ *          - the error returned earlier by another writer function
+ */
+esp_err_t esp_json_writer_finish(esp_json_writer_handle_t writer, size_t *out_len);
+
+#ifdef __cplusplus
+}
+#endif
@@ -5,6 +5,10 @@
  */
 
 #include <string.h>
+#include <stdint.h>
+#include <sys/lock.h>
+#include <sys/param.h>
+#include "mbedtls/platform_util.h"
 #include "esp_mbedtls_dynamic_impl.h"
 #include "sdkconfig.h"
 
@@ -18,6 +22,27 @@
 
 #define TX_IDLE_BUFFER_SIZE (MBEDTLS_SSL_HEADER_LEN + CACHE_BUFFER_SIZE)
 
+#define RECORD_BUFFER_LEN(_len) ((_len) + MBEDTLS_SSL_HEADER_LEN \
+                                        + MBEDTLS_MAX_IV_LENGTH \
+                                        + MBEDTLS_SSL_MAC_ADD \
+                                        + MBEDTLS_SSL_PADDING_ADD \
+                                        + MBEDTLS_SSL_MAX_CID_EXPANSION)
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL
+/* Large enough for any received record, and for any record sent after the handshake */
+#define POOL_BUFFER_LEN MAX(MBEDTLS_SSL_OUT_BUFFER_LEN, RECORD_BUFFER_LEN(MBEDTLS_SSL_IN_PAYLOAD_LEN))
+
+typedef struct {
+    struct esp_mbedtls_ssl_buf *buf;    /*!< Pooled buffer, NULL until a record needs it */
+    bool borrowed;                      /*!< The buffer is in use by a connection */
+} pool_slot_t;
+
+static pool_slot_t s_pool[CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL_SIZE];
+#endif /* CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL */
+
+static _lock_t s_buf_lock;
+static esp_mbedtls_dynamic_buf_stats_t s_buf_stats;
+
 #define ESP_MBEDTLS_RETURN_IF_RX_BUF_STATIC(ssl) \
     do { \
         if (ssl->MBEDTLS_PRIVATE(in_buf)) { \
@@ -43,19 +68,202 @@ static esp_mbedtls_ssl_buf_states esp_mbedtls_get_buf_state(unsigned char *buf)
     return temp->state;
 }
 
+static void esp_mbedtls_init_ssl_buf(struct esp_mbedtls_ssl_buf *buf, unsigned int len)
+{
+    if (buf) {
+        buf->state = ESP_MBEDTLS_SSL_BUF_CACHED;
+        buf->len = len;
+    }
+}
+
+/* Called with s_buf_lock held */
+static void esp_mbedtls_account_alloc(size_t bytes)
+{
+    s_buf_stats.allocs++;
+    s_buf_stats.bytes += bytes;
+    if (s_buf_stats.bytes > s_buf_stats.peak_bytes) {
+        s_buf_stats.peak_bytes = s_buf_stats.bytes;
+    }
+}
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL
+/**
+ * Borrow a pooled buffer for a record of len bytes: an idle pooled buffer if there is one,
+ * else a new one if the pool is not full yet. Returns NULL when all the pooled buffers
+ * are borrowed by other connections.
+ */
+static struct esp_mbedtls_ssl_buf *esp_mbedtls_pool_borrow(size_t len)
+{
+    pool_slot_t *slot = NULL;
+
+    _lock_acquire(&s_buf_lock);
+    for (int i = 0; i < CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL_SIZE; i++) {
+        if (!s_pool[i].borrowed && (slot == NULL || (s_pool[i].buf && !slot->buf))) {
+            slot = &s_pool[i];
+        }
+    }
+    if (slot && !slot->buf) {
+        slot->buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + POOL_BUFFER_LEN);
+        if (slot->buf) {
+            esp_mbedtls_account_alloc(SSL_BUF_HEAD_OFFSET_SIZE + POOL_BUFFER_LEN);
+            s_buf_stats.pooled++;
+        } else {
+            slot = NULL;
+        }
+    }
+    if (slot) {
+        slot->borrowed = true;
+        s_buf_stats.hits++;
+        if (++s_buf_stats.borrowed > s_buf_stats.peak_borrowed) {
+            s_buf_stats.peak_borrowed = s_buf_stats.borrowed;
+        }
+    } else {
+        s_buf_stats.misses++;
+    }
+    _lock_release(&s_buf_lock);
+
+    if (!slot) {
+        return NULL;
+    }
+
+    ESP_LOGV(TAG, "borrow pooled buffer @ %p for %zu bytes", slot->buf, len);
+    esp_mbedtls_init_ssl_buf(slot->buf, len);
+    return slot->buf;
+}
+
+/**
+ * Give a pooled buffer back to the pool, returns false if buf is not a pooled buffer.
+ */
+static bool esp_mbedtls_pool_return(struct esp_mbedtls_ssl_buf *buf)
+{
+    pool_slot_t *slot = NULL;
+
+    _lock_acquire(&s_buf_lock);
+    for (int i = 0; i < CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL_SIZE; i++) {
+        if (s_pool[i].buf == buf) {
+            slot = &s_pool[i];
+            break;
+        }
+    }
+    _lock_release(&s_buf_lock);
+
+    if (!slot) {
+        return false;
+    }
+
+    /*
+     * The record may hold plaintext of the connection, and the next borrower expects
+     * a zeroed buffer like one from mbedtls_calloc(). Only the borrowed length has been used.
+     */
+    mbedtls_platform_zeroize(buf->buf, buf->len);
+    ESP_LOGV(TAG, "return pooled buffer @ %p", buf);
+
+    _lock_acquire(&s_buf_lock);
+    slot->borrowed = false;
+    s_buf_stats.borrowed--;
+    _lock_release(&s_buf_lock);
+    return true;
+}
+#endif /* CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL */
+
+/**
+ * Allocate a buffer of len bytes. Record buffers are borrowed from the pool when it is enabled
+ * and not exhausted, the small buffers which only keep the counter and the IV of idle
+ * connections are always allocated from the heap.
+ */
+static struct esp_mbedtls_ssl_buf *esp_mbedtls_alloc_buf(size_t len, bool record)
+{
+    struct esp_mbedtls_ssl_buf *esp_buf;
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL
+    if (record && len <= POOL_BUFFER_LEN) {
+        esp_buf = esp_mbedtls_pool_borrow(len);
+        if (esp_buf) {
+            return esp_buf;
+        }
+    }
+#else
+    (void)record;
+#endif
+
+    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + len);
+    if (!esp_buf) {
+        ESP_LOGE(TAG, "alloc(%zu bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + len);
+        return NULL;
+    }
+
+    _lock_acquire(&s_buf_lock);
+    esp_mbedtls_account_alloc(SSL_BUF_HEAD_OFFSET_SIZE + len);
+    _lock_release(&s_buf_lock);
+
+    esp_mbedtls_init_ssl_buf(esp_buf, len);
+    return esp_buf;
+}
+
 void esp_mbedtls_free_buf(unsigned char *buf)
 {
     struct esp_mbedtls_ssl_buf *temp = __containerof(buf, struct esp_mbedtls_ssl_buf, buf[0]);
+
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL
+    if (esp_mbedtls_pool_return(temp)) {
+        return;
+    }
+#endif
+
     ESP_LOGV(TAG, "free buffer @ %p", temp);
+    _lock_acquire(&s_buf_lock);
+    s_buf_stats.bytes -= SSL_BUF_HEAD_OFFSET_SIZE + temp->len;
+    _lock_release(&s_buf_lock);
     mbedtls_free(temp);
 }
 
-static void esp_mbedtls_init_ssl_buf(struct esp_mbedtls_ssl_buf *buf, unsigned int len)
+esp_err_t esp_mbedtls_dynamic_get_buf_stats(esp_mbedtls_dynamic_buf_stats_t *stats)
 {
-    if (buf) {
-        buf->state = ESP_MBEDTLS_SSL_BUF_CACHED;
-        buf->len = len;
+    if (!stats) {
+        return ESP_ERR_INVALID_ARG;
     }
+
+    _lock_acquire(&s_buf_lock);
+    *stats = s_buf_stats;
+    _lock_release(&s_buf_lock);
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL
+    stats->pool_buf_size = POOL_BUFFER_LEN;
+#endif
+    return ESP_OK;
+}
+
+void esp_mbedtls_dynamic_reset_buf_stats(void)
+{
+    _lock_acquire(&s_buf_lock);
+    s_buf_stats.allocs = 0;
+    s_buf_stats.hits = 0;
+    s_buf_stats.misses = 0;
+    s_buf_stats.peak_bytes = s_buf_stats.bytes;
+    s_buf_stats.peak_borrowed = s_buf_stats.borrowed;
+    _lock_release(&s_buf_lock);
+}
+
+void esp_mbedtls_dynamic_pool_trim(void)
+{
+#if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL
+    struct esp_mbedtls_ssl_buf *idle[CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL_SIZE];
+    int n = 0;
+
+    _lock_acquire(&s_buf_lock);
+    for (int i = 0; i < CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL_SIZE; i++) {
+        if (s_pool[i].buf && !s_pool[i].borrowed) {
+            idle[n++] = s_pool[i].buf;
+            s_pool[i].buf = NULL;
+            s_buf_stats.pooled--;
+            s_buf_stats.bytes -= SSL_BUF_HEAD_OFFSET_SIZE + POOL_BUFFER_LEN;
+        }
+    }
+    _lock_release(&s_buf_lock);
+
+    for (int i = 0; i < n; i++) {
+        mbedtls_free(idle[i]);
+    }
+#endif
 }
 
 static void esp_mbedtls_parse_record_header(mbedtls_ssl_context *ssl)
@@ -71,11 +279,7 @@ static int tx_buffer_len(mbedtls_ssl_context *ssl, int len)
     if (!len) {
         return MBEDTLS_SSL_OUT_BUFFER_LEN;
     } else {
-        return len + MBEDTLS_SSL_HEADER_LEN
-                   + MBEDTLS_MAX_IV_LENGTH
-                   + MBEDTLS_SSL_MAC_ADD
-                   + MBEDTLS_SSL_PADDING_ADD
-                   + MBEDTLS_SSL_MAX_CID_EXPANSION;
+        return RECORD_BUFFER_LEN(len);
     }
 }
 
@@ -85,7 +289,7 @@ static void init_tx_buffer(mbedtls_ssl_context *ssl, unsigned char *buf)
      * In mbedtls, ssl->MBEDTLS_PRIVATE(out_msg) = ssl->MBEDTLS_PRIVATE(out_buf) + offset;
      */
     if (!buf) {
-        int out_msg_off = (int)ssl->MBEDTLS_PRIVATE(out_msg) - (int)ssl->MBEDTLS_PRIVATE(out_buf);
+        int out_msg_off = (intptr_t)ssl->MBEDTLS_PRIVATE(out_msg) - (intptr_t)ssl->MBEDTLS_PRIVATE(out_buf);
 
         if (!out_msg_off) {
             out_msg_off = MBEDTLS_SSL_HEADER_LEN;
@@ -96,9 +300,9 @@ static void init_tx_buffer(mbedtls_ssl_context *ssl, unsigned char *buf)
         ssl->MBEDTLS_PRIVATE(out_hdr) = NULL;
         ssl->MBEDTLS_PRIVATE(out_len) = NULL;
         ssl->MBEDTLS_PRIVATE(out_iv)  = NULL;
-        ssl->MBEDTLS_PRIVATE(out_msg) = (unsigned char *)out_msg_off;
+        ssl->MBEDTLS_PRIVATE(out_msg) = (unsigned char *)(intptr_t)out_msg_off;
     } else {
-        int out_msg_off = (int)ssl->MBEDTLS_PRIVATE(out_msg);
+        int out_msg_off = (intptr_t)ssl->MBEDTLS_PRIVATE(out_msg);
 
         ssl->MBEDTLS_PRIVATE(out_buf) = buf;
         ssl->MBEDTLS_PRIVATE(out_ctr) = ssl->MBEDTLS_PRIVATE(out_buf);
@@ -121,7 +325,7 @@ static void init_rx_buffer(mbedtls_ssl_context *ssl, unsigned char *buf)
      * In mbedtls, ssl->MBEDTLS_PRIVATE(in_msg) = ssl->MBEDTLS_PRIVATE(in_buf) + offset;
      */
     if (!buf) {
-        int in_msg_off = (int)ssl->MBEDTLS_PRIVATE(in_msg) - (int)ssl->MBEDTLS_PRIVATE(in_buf);
+        int in_msg_off = (intptr_t)ssl->MBEDTLS_PRIVATE(in_msg) - (intptr_t)ssl->MBEDTLS_PRIVATE(in_buf);
 
         if (!in_msg_off) {
             in_msg_off = MBEDTLS_SSL_HEADER_LEN;
@@ -132,9 +336,9 @@ static void init_rx_buffer(mbedtls_ssl_context *ssl, unsigned char *buf)
         ssl->MBEDTLS_PRIVATE(in_hdr) = NULL;
         ssl->MBEDTLS_PRIVATE(in_len) = NULL;
         ssl->MBEDTLS_PRIVATE(in_iv)  = NULL;
-        ssl->MBEDTLS_PRIVATE(in_msg) = (unsigned char *)in_msg_off;
+        ssl->MBEDTLS_PRIVATE(in_msg) = (unsigned char *)(intptr_t)in_msg_off;
     } else {
-        int in_msg_off = (int)ssl->MBEDTLS_PRIVATE(in_msg);
+        int in_msg_off = (intptr_t)ssl->MBEDTLS_PRIVATE(in_msg);
 
         ssl->MBEDTLS_PRIVATE(in_buf) = buf;
         ssl->MBEDTLS_PRIVATE(in_ctr) = ssl->MBEDTLS_PRIVATE(in_buf);
@@ -159,12 +363,11 @@ esp_err_t esp_mbedtls_dynamic_set_rx_buf_static(mbedtls_ssl_context *ssl)
 
     struct esp_mbedtls_ssl_buf *esp_buf;
     int buffer_len = tx_buffer_len(ssl, MBEDTLS_SSL_IN_BUFFER_LEN);
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
+    /* The static buffer is kept for the lifetime of the connection, it is not borrowed from the pool */
+    esp_buf = esp_mbedtls_alloc_buf(buffer_len, false);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "rx buf alloc(%d bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
         return ESP_ERR_NO_MEM;
     }
-    esp_mbedtls_init_ssl_buf(esp_buf, buffer_len);
     init_rx_buffer(ssl, esp_buf->buf);
 
     memcpy(ssl->MBEDTLS_PRIVATE(in_ctr), cache_buf, 8);
@@ -174,7 +377,7 @@ esp_err_t esp_mbedtls_dynamic_set_rx_buf_static(mbedtls_ssl_context *ssl)
 
 }
 
-static int esp_mbedtls_alloc_tx_buf(mbedtls_ssl_context *ssl, int len)
+static int esp_mbedtls_alloc_tx_buf(mbedtls_ssl_context *ssl, int len, bool record)
 {
     struct esp_mbedtls_ssl_buf *esp_buf;
 
@@ -183,15 +386,13 @@ static int esp_mbedtls_alloc_tx_buf(mbedtls_ssl_context *ssl, int len)
         ssl->MBEDTLS_PRIVATE(out_buf) = NULL;
     }
 
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + len);
+    esp_buf = esp_mbedtls_alloc_buf(len, record);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "alloc(%d bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + len);
         return MBEDTLS_ERR_SSL_ALLOC_FAILED;
     }
 
     ESP_LOGV(TAG, "add out buffer %d bytes @ %p", len, esp_buf->buf);
 
-    esp_mbedtls_init_ssl_buf(esp_buf, len);
     /**
      * Mark the out_msg offset from ssl->MBEDTLS_PRIVATE(out_buf).
      *
@@ -206,7 +407,7 @@ static int esp_mbedtls_alloc_tx_buf(mbedtls_ssl_context *ssl, int len)
 
 int esp_mbedtls_setup_tx_buffer(mbedtls_ssl_context *ssl)
 {
-    CHECK_OK(esp_mbedtls_alloc_tx_buf(ssl, TX_IDLE_BUFFER_SIZE));
+    CHECK_OK(esp_mbedtls_alloc_tx_buf(ssl, TX_IDLE_BUFFER_SIZE, false));
 
     /* mark the out buffer has no data cached */
     esp_mbedtls_set_buf_state(ssl->MBEDTLS_PRIVATE(out_buf), ESP_MBEDTLS_SSL_BUF_NO_CACHED);
@@ -222,7 +423,7 @@ void esp_mbedtls_setup_rx_buffer(mbedtls_ssl_context *ssl)
 
 int esp_mbedtls_reset_add_tx_buffer(mbedtls_ssl_context *ssl)
 {
-    return esp_mbedtls_alloc_tx_buf(ssl, MBEDTLS_SSL_OUT_BUFFER_LEN);
+    return esp_mbedtls_alloc_tx_buf(ssl, MBEDTLS_SSL_OUT_BUFFER_LEN, true);
 }
 
 int esp_mbedtls_reset_free_tx_buffer(mbedtls_ssl_context *ssl)
@@ -244,15 +445,13 @@ int esp_mbedtls_reset_add_rx_buffer(mbedtls_ssl_context *ssl)
         ssl->MBEDTLS_PRIVATE(in_buf) = NULL;
     }
 
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + MBEDTLS_SSL_IN_BUFFER_LEN);
+    esp_buf = esp_mbedtls_alloc_buf(MBEDTLS_SSL_IN_BUFFER_LEN, true);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "alloc(%d bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + MBEDTLS_SSL_IN_BUFFER_LEN);
         return MBEDTLS_ERR_SSL_ALLOC_FAILED;
     }
 
     ESP_LOGV(TAG, "add in buffer %d bytes @ %p", MBEDTLS_SSL_IN_BUFFER_LEN, esp_buf->buf);
 
-    esp_mbedtls_init_ssl_buf(esp_buf, MBEDTLS_SSL_IN_BUFFER_LEN);
     /**
      * Mark the in_msg offset from ssl->MBEDTLS_PRIVATE(in_buf).
      *
@@ -295,16 +494,14 @@ int esp_mbedtls_add_tx_buffer(mbedtls_ssl_context *ssl, size_t buffer_len)
 
     buffer_len = tx_buffer_len(ssl, buffer_len);
 
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
+    esp_buf = esp_mbedtls_alloc_buf(buffer_len, true);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "alloc(%zu bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto exit;
     }
 
     ESP_LOGV(TAG, "add out buffer %zu bytes @ %p", buffer_len, esp_buf->buf);
 
-    esp_mbedtls_init_ssl_buf(esp_buf, buffer_len);
     init_tx_buffer(ssl, esp_buf->buf);
 
     if (cached) {
@@ -340,13 +537,11 @@ int esp_mbedtls_free_tx_buffer(mbedtls_ssl_context *ssl)
     esp_mbedtls_free_buf(ssl->MBEDTLS_PRIVATE(out_buf));
     init_tx_buffer(ssl, NULL);
 
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + TX_IDLE_BUFFER_SIZE);
+    esp_buf = esp_mbedtls_alloc_buf(TX_IDLE_BUFFER_SIZE, false);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "alloc(%d bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + TX_IDLE_BUFFER_SIZE);
         return MBEDTLS_ERR_SSL_ALLOC_FAILED;
     }
 
-    esp_mbedtls_init_ssl_buf(esp_buf, TX_IDLE_BUFFER_SIZE);
     memcpy(esp_buf->buf, buf, CACHE_BUFFER_SIZE);
     init_tx_buffer(ssl, esp_buf->buf);
     esp_mbedtls_set_buf_state(ssl->MBEDTLS_PRIVATE(out_buf), ESP_MBEDTLS_SSL_BUF_NO_CACHED);
@@ -416,16 +611,14 @@ int esp_mbedtls_add_rx_buffer(mbedtls_ssl_context *ssl)
         init_rx_buffer(ssl, NULL);
     }
 
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
+    esp_buf = esp_mbedtls_alloc_buf(buffer_len, true);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "alloc(%d bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + buffer_len);
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto exit;
     }
 
     ESP_LOGV(TAG, "add in buffer %d bytes @ %p", buffer_len, esp_buf->buf);
 
-    esp_mbedtls_init_ssl_buf(esp_buf, buffer_len);
     init_rx_buffer(ssl, esp_buf->buf);
 
     if (cached) {
@@ -488,14 +681,12 @@ int esp_mbedtls_free_rx_buffer(mbedtls_ssl_context *ssl)
     esp_mbedtls_free_buf(ssl->MBEDTLS_PRIVATE(in_buf));
     init_rx_buffer(ssl, NULL);
 
-    esp_buf = mbedtls_calloc(1, SSL_BUF_HEAD_OFFSET_SIZE + 16);
+    esp_buf = esp_mbedtls_alloc_buf(16, false);
     if (!esp_buf) {
-        ESP_LOGE(TAG, "alloc(%d bytes) failed", SSL_BUF_HEAD_OFFSET_SIZE + 16);
         ret = MBEDTLS_ERR_SSL_ALLOC_FAILED;
         goto exit;
     }
 
-    esp_mbedtls_init_ssl_buf(esp_buf, 16);
     memcpy(esp_buf->buf, buf, 16);
     init_rx_buffer(ssl, esp_buf->buf);
     esp_mbedtls_set_buf_state(ssl->MBEDTLS_PRIVATE(in_buf), ESP_MBEDTLS_SSL_BUF_NO_CACHED);
@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include <stddef.h>
+#include <stdint.h>
 #include "mbedtls/ssl.h"
 #include "esp_err.h"
 
@@ -23,6 +25,46 @@ extern "C" {
  */
 esp_err_t esp_mbedtls_dynamic_set_rx_buf_static(mbedtls_ssl_context *ssl);
 
+/**
+ * @brief Statistics of the TX/RX buffers allocated by the dynamic buffer implementation, for all the connections
+ */
+typedef struct {
+    size_t bytes;                   /*!< Bytes currently allocated for TX/RX buffers, including the idle pooled buffers */
+    size_t peak_bytes;              /*!< Highest value of bytes since the last reset */
+    uint32_t allocs;                /*!< Number of heap allocations of TX/RX buffers since the last reset */
+    size_t pool_buf_size;           /*!< Size of each pooled record buffer, 0 if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL is disabled */
+    uint32_t pooled;                /*!< Number of record buffers currently owned by the pool, idle or borrowed */
+    uint32_t borrowed;              /*!< Number of pooled record buffers currently borrowed by connections */
+    uint32_t peak_borrowed;         /*!< Highest value of borrowed since the last reset */
+    uint32_t hits;                  /*!< Number of records which have borrowed a pooled buffer since the last reset */
+    uint32_t misses;                /*!< Number of records which have allocated a buffer from the heap because
+                                         all the pooled buffers were borrowed, since the last reset */
+} esp_mbedtls_dynamic_buf_stats_t;
+
+/**
+ * @brief Get the statistics of the dynamic TX/RX buffers
+ *
+ * @param stats Filled with the current statistics
+ * @return esp_err_t
+ *         - ESP_OK: Success
+ *         - ESP_ERR_INVALID_ARG: stats is NULL
+ */
+esp_err_t esp_mbedtls_dynamic_get_buf_stats(esp_mbedtls_dynamic_buf_stats_t *stats);
+
+/**
+ * @brief Reset the counters of the dynamic TX/RX buffer statistics, the peak values are set to the current values
+ */
+void esp_mbedtls_dynamic_reset_buf_stats(void);
+
+/**
+ * @brief Free the pooled record buffers which are not borrowed by any connection
+ *
+ * The pool allocates its buffers again when connections need them. This can be called when the application
+ * does not expect TLS traffic for a while, to give the memory of the pool back to the heap.
+ * It does nothing if CONFIG_MBEDTLS_DYNAMIC_BUFFER_POOL is disabled.
+ */
+void esp_mbedtls_dynamic_pool_trim(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -126,6 +126,21 @@ SCENARIO("MQTT Client Operation")
                     REQUIRE(esp_mqtt_set_config(client.get(), &config)== ESP_OK);
                 }
             }
+            SECTION("User enables publish batching") {
+                http_parser_parse_url_ExpectAnyArgsAndReturn(0);
+                http_parser_parse_url_ReturnThruPtr_u(&ret_uri);
+                config.batch.size = 512;
+                REQUIRE(esp_mqtt_set_config(client.get(), &config) == ESP_OK);
+                SECTION("Nothing to flush before the client connects") {
+                    REQUIRE(esp_mqtt_client_flush(client.get()) == ESP_OK);
+                    REQUIRE(esp_mqtt_client_flush(nullptr) == ESP_ERR_INVALID_ARG);
+                }
+                SECTION("Messages are not batched while disconnected") {
+                    REQUIRE(esp_mqtt_client_publish(client.get(), "topic", "data", 0, 0, 0) == -1);
+                    REQUIRE(esp_mqtt_client_publish(client.get(), "topic", "data", 0, 1, 0) > 0);
+                    REQUIRE(esp_mqtt_client_get_outbox_size(client.get()) > 0);
+                }
+            }
             SECTION("After Start Client Is Cleanly destroyed") {
                 REQUIRE(esp_mqtt_client_start(client.get()) == ESP_OK);
                 // Only need to start the client, destroy is called automatically at the end of
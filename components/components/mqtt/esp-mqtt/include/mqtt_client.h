@@ -376,6 +376,24 @@ typedef struct esp_mqtt_client_config_t {
     struct outbox_config_t {
         uint64_t limit; /*!< Size limit for the outbox in bytes.*/
     } outbox; /*!< Outbox configuration. */
+
+    /**
+     * Client publish batching configuration
+     *
+     * With batching enabled, messages published with `esp_mqtt_client_publish` are collected in a send
+     * buffer and written together, once the buffer is full, once the oldest message has waited for
+     * ``timeout_ms``, or before any other packet is sent. Messages which do not fit the send buffer are
+     * written right away.
+     *
+     * The client task only shortens its read poll to ``timeout_ms`` while messages are waiting in the
+     * send buffer. A message published to an empty send buffer while the task is already waiting for
+     * incoming data is written out by the first publish after ``timeout_ms``, by `esp_mqtt_client_flush`,
+     * or at the latest when that wait ends (MQTT_POLL_READ_TIMEOUT_MS).
+     */
+    struct batch_config_t {
+        int size;       /*!< size of the send buffer in bytes, batching is disabled if 0 (default)*/
+        int timeout_ms; /*!< longest time a message waits in the send buffer, defaults to 10 ms*/
+    } batch; /*!< Publish batching configuration. */
 } esp_mqtt_client_config_t;
 
 /**
@@ -545,13 +563,18 @@ int esp_mqtt_client_unsubscribe(esp_mqtt_client_handle_t client,
  *
  * Notes:
  * - This API might block for several seconds, either due to network timeout
- * (10s) or if publishing payloads longer than internal buffer (due to message
- *   fragmentation)
+ * (10s) or if publishing payloads longer than internal buffer (the payload is
+ *   then written directly from `data`, without copying it to the buffer)
  * - Client doesn't have to be connected for this API to work, enqueueing the
  * messages with qos>1 (returning -1 for all the qos=0 messages if
  * disconnected). If MQTT_SKIP_PUBLISH_IF_DISCONNECTED is enabled, this API will
  * not attempt to publish when the client is not connected and will always
  * return -1.
+ * - If publish batching is configured (see `batch` in `esp_mqtt_client_config_t`),
+ * the message might be held in the send buffer on return, until it is written
+ * together with the following messages. Use `esp_mqtt_client_flush` to write it
+ * out right away. QoS 0 messages still in the send buffer are lost if the
+ * connection breaks.
  * - It is thread safe, please refer to `esp_mqtt_client_subscribe` for details
  *
  * @param client    *MQTT* client handle
@@ -594,6 +617,23 @@ int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char *topic,
                             const char *data, int len, int qos, int retain,
                             bool store);
 
+/**
+ * @brief Write out the publish messages waiting in the send buffer
+ *
+ * Only needed with publish batching, see `batch` in `esp_mqtt_client_config_t`.
+ *
+ * Notes:
+ * - The connection is aborted if writing fails
+ * - It is thread safe, please refer to `esp_mqtt_client_subscribe` for details
+ *
+ * @param client    *MQTT* client handle
+ *
+ * @return ESP_OK on success (also if there was nothing to write)
+ *         ESP_ERR_INVALID_ARG on wrong initialization
+ *         ESP_FAIL if writing failed
+ */
+esp_err_t esp_mqtt_client_flush(esp_mqtt_client_handle_t client);
+
 /**
  * @brief Destroys the client handle
  *
@@ -100,6 +100,8 @@ typedef struct {
     uint8_t ecdsa_key_efuse_blk;
     int message_retransmit_timeout;
     uint64_t outbox_limit;
+    int batch_size;
+    int batch_timeout_ms;
     esp_transport_handle_t transport;
     struct ifreq * if_name;
     esp_transport_keep_alive_t tcp_keep_alive_cfg;
@@ -131,6 +133,9 @@ struct esp_mqtt_client {
     bool run;
     bool wait_for_ping_resp;
     outbox_handle_t outbox;
+    uint8_t *batch_buffer;      /*!< Publish messages waiting to be written, NULL if batching is disabled */
+    int batch_len;
+    uint64_t batch_tick;        /*!< When the oldest message in the batch buffer was added */
     EventGroupHandle_t status_bits;
     SemaphoreHandle_t  api_lock;
     TaskHandle_t       task_handle;
@@ -101,6 +101,7 @@
 #define MQTT_ENABLE_WS              CONFIG_MQTT_TRANSPORT_WEBSOCKET
 #define MQTT_ENABLE_WSS             CONFIG_MQTT_TRANSPORT_WEBSOCKET_SECURE
 #define MQTT_DEFAULT_RETRANSMIT_TIMEOUT_MS 1000
+#define MQTT_BATCH_DEFAULT_TIMEOUT_MS      10
 
 #ifdef CONFIG_MQTT_EVENT_QUEUE_SIZE
 #define MQTT_EVENT_QUEUE_SIZE       CONFIG_MQTT_EVENT_QUEUE_SIZE
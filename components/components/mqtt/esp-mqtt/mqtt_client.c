@@ -38,6 +38,7 @@ static char *create_string(const char *ptr, int len);
 static int mqtt_message_receive(esp_mqtt_client_handle_t client, int read_poll_timeout_ms);
 static void esp_mqtt_client_dispatch_transport_error(esp_mqtt_client_handle_t client);
 static esp_err_t send_disconnect_msg(esp_mqtt_client_handle_t client);
+static esp_err_t esp_mqtt_flush_batch(esp_mqtt_client_handle_t client);
 
 /**
  * @brief Processes error reported from transport layer (considering the message read status)
@@ -631,6 +632,24 @@ esp_err_t esp_mqtt_set_config(esp_mqtt_client_handle_t client, const esp_mqtt_cl
         }
     }
     client->config->outbox_limit = config->outbox.limit;
+
+    client->config->batch_timeout_ms = config->batch.timeout_ms;
+    if (client->config->batch_timeout_ms <= 0) {
+        client->config->batch_timeout_ms = MQTT_BATCH_DEFAULT_TIMEOUT_MS;
+    }
+    int batch_size = config->batch.size > 0 ? config->batch.size : 0;
+    if (batch_size != client->config->batch_size) {
+        // messages already in the batch buffer are written out before it is replaced
+        esp_mqtt_flush_batch(client);
+        free(client->batch_buffer);
+        client->batch_buffer = NULL;
+        client->config->batch_size = 0;
+        if (batch_size > 0) {
+            client->batch_buffer = malloc(batch_size);
+            ESP_MEM_CHECK(TAG, client->batch_buffer, goto _mqtt_set_config_failed);
+            client->config->batch_size = batch_size;
+        }
+    }
     esp_err_t config_has_conflict = esp_mqtt_check_cfg_conflict(client->config, config);
 
     MQTT_API_UNLOCK(client);
@@ -649,6 +668,9 @@ void esp_mqtt_destroy_config(esp_mqtt_client_handle_t client)
     }
     free(client->mqtt_state.in_buffer);
     mqtt_msg_buffer_destroy(&client->mqtt_state.connection);
+    free(client->batch_buffer);
+    client->batch_buffer = NULL;
+    client->batch_len = 0;
     free(client->config->host);
     free(client->config->uri);
     free(client->config->path);
@@ -713,14 +735,13 @@ static esp_err_t process_keepalive(esp_mqtt_client_handle_t client)
     return ESP_OK;
 }
 
-static inline esp_err_t esp_mqtt_write(esp_mqtt_client_handle_t client)
+/**
+ * @brief Writes all the buffers, the transport might write them with a single call (and send them in one segment)
+ */
+static esp_err_t esp_mqtt_writev(esp_mqtt_client_handle_t client, struct iovec *iov, int iovcnt)
 {
-    int wlen = 0, widx = 0, len = client->mqtt_state.connection.outbound_message.length;
-    while (len > 0) {
-        wlen = esp_transport_write(client->transport,
-                                   (char *)client->mqtt_state.connection.outbound_message.data + widx,
-                                   len,
-                                   client->config->network_timeout_ms);
+    while (iovcnt > 0) {
+        int wlen = esp_transport_writev(client->transport, iov, iovcnt, client->config->network_timeout_ms);
         if (wlen < 0) {
             ESP_LOGE(TAG, "Writing failed: errno=%d", errno);
             esp_mqtt_client_dispatch_transport_error(client);
@@ -731,8 +752,74 @@ static inline esp_err_t esp_mqtt_write(esp_mqtt_client_handle_t client)
             ESP_LOGE(TAG, "Writing didn't complete in specified timeout: errno=%d", errno);
             return ESP_ERR_TIMEOUT;
         }
-        widx += wlen;
-        len -= wlen;
+        while (iovcnt > 0 && (size_t)wlen >= iov->iov_len) {
+            wlen -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (uint8_t *)iov->iov_base + wlen;
+            iov->iov_len -= wlen;
+        }
+    }
+    return ESP_OK;
+}
+
+/**
+ * @brief Writes out the publish messages of the batch buffer, which is emptied even if writing fails
+ */
+static esp_err_t esp_mqtt_flush_batch(esp_mqtt_client_handle_t client)
+{
+    if (client->batch_len == 0) {
+        return ESP_OK;
+    }
+    struct iovec iov = {
+        .iov_base = client->batch_buffer,
+        .iov_len = client->batch_len,
+    };
+    client->batch_len = 0;
+    return esp_mqtt_writev(client, &iov, 1);
+}
+
+static inline esp_err_t esp_mqtt_write(esp_mqtt_client_handle_t client)
+{
+    // batched publish messages go first, to keep the order of the packets
+    esp_err_t err = esp_mqtt_flush_batch(client);
+    if (err != ESP_OK) {
+        return err;
+    }
+    struct iovec iov = {
+        .iov_base = client->mqtt_state.connection.outbound_message.data,
+        .iov_len = client->mqtt_state.connection.outbound_message.length,
+    };
+    return esp_mqtt_writev(client, &iov, 1);
+}
+
+/**
+ * @brief Adds the outbound message to the batch buffer, writing out the batch when it is full or has waited long enough
+ *
+ * @return ESP_ERR_NOT_SUPPORTED if the message does not fit the batch buffer and has to be written on its own
+ */
+static esp_err_t esp_mqtt_batch_outbound(esp_mqtt_client_handle_t client)
+{
+    mqtt_message_t *msg = &client->mqtt_state.connection.outbound_message;
+    int length = msg->length;
+    if (client->batch_buffer == NULL || length > client->config->batch_size) {
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+    if (client->batch_len + length > client->config->batch_size) {
+        esp_err_t err = esp_mqtt_flush_batch(client);
+        if (err != ESP_OK) {
+            return err;
+        }
+    }
+    if (client->batch_len == 0) {
+        client->batch_tick = platform_tick_get_ms();
+    }
+    memcpy(client->batch_buffer + client->batch_len, msg->data, length);
+    client->batch_len += length;
+    if (has_timed_out(client->batch_tick, client->config->batch_timeout_ms)) {
+        return esp_mqtt_flush_batch(client);
     }
     return ESP_OK;
 }
@@ -839,6 +926,8 @@ static void esp_mqtt_abort_connection(esp_mqtt_client_handle_t client)
 {
     MQTT_API_LOCK(client);
     esp_transport_close(client->transport);
+    // unsent qos>0 messages are retransmitted from the outbox
+    client->batch_len = 0;
     client->wait_timeout_ms = client->config->reconnect_timeout_ms;
     client->reconnect_tick = platform_tick_get_ms();
     client->state = MQTT_STATE_WAIT_RECONNECT;
@@ -1782,6 +1871,13 @@ static void esp_mqtt_task(void *pv)
                 break;
             }
 
+            if (client->batch_len > 0 && has_timed_out(client->batch_tick, client->config->batch_timeout_ms)) {
+                if (esp_mqtt_flush_batch(client) != ESP_OK) {
+                    esp_mqtt_abort_connection(client);
+                    break;
+                }
+            }
+
             if (client->config->refresh_connection_after_ms &&
                     has_timed_out(client->refresh_connection_tick, client->config->refresh_connection_after_ms)) {
                 ESP_LOGD(TAG, "Refreshing the connection...");
@@ -1814,9 +1910,17 @@ static void esp_mqtt_task(void *pv)
             ESP_LOGE(TAG, "MQTT client error, client is in an unrecoverable state.");
             break;
         }
+        // while publish messages wait in the batch buffer, wake up in time to write them out
+        int poll_timeout_ms = MQTT_POLL_READ_TIMEOUT_MS;
+        if (client->batch_len > 0) {
+            int64_t batch_left_ms = (int64_t)(client->batch_tick + client->config->batch_timeout_ms - platform_tick_get_ms());
+            if (batch_left_ms < poll_timeout_ms) {
+                poll_timeout_ms = batch_left_ms > 0 ? batch_left_ms : 0;
+            }
+        }
         MQTT_API_UNLOCK(client);
         if (MQTT_STATE_CONNECTED == client->state) {
-            if (esp_transport_poll_read(client->transport, max_poll_timeout(client, MQTT_POLL_READ_TIMEOUT_MS)) < 0) {
+            if (esp_transport_poll_read(client->transport, max_poll_timeout(client, poll_timeout_ms)) < 0) {
                 ESP_LOGE(TAG, "Poll read error: %d, aborting connection", errno);
                 esp_mqtt_abort_connection(client);
             }
@@ -2093,6 +2197,7 @@ static int make_publish(esp_mqtt_client_handle_t client, const char *topic, cons
                         int len, int qos, int retain)
 {
     uint16_t pending_msg_id = 0;
+    client->mqtt_state.connection.outbound_message.fragmented_msg_data_offset = 0;
     if (client->mqtt_state.connection.information.protocol_ver == MQTT_PROTOCOL_V_5) {
 #ifdef MQTT_PROTOCOL_5
         mqtt5_msg_publish(&client->mqtt_state.connection,
@@ -2204,38 +2309,33 @@ MQTT_API_LOCK(client);
         goto cannot_publish;
     }
 
-    /* Provide support for sending fragmented message if it doesn't fit buffer */
-    int remaining_len = len;
-    const char *current_data = data;
-    bool sending = true;
-
-    while (sending)  {
-
-        if (esp_mqtt_write(client) != ESP_OK) {
-            esp_mqtt_abort_connection(client);
-            ret = -1;
-            goto cannot_publish;
-        }
-
-        int data_sent = client->mqtt_state.connection.outbound_message.length - client->mqtt_state.connection.outbound_message.fragmented_msg_data_offset;
-        client->mqtt_state.connection.outbound_message.fragmented_msg_data_offset = 0;
-        client->mqtt_state.connection.outbound_message.fragmented_msg_total_length = 0;
-        remaining_len -= data_sent;
-        current_data +=  data_sent;
-
-        if (remaining_len > 0) {
-            mqtt_connection_t *connection = &client->mqtt_state.connection;
-            ESP_LOGD(TAG, "Sending fragmented message, remains to send %d bytes of %d", remaining_len, len);
-            int write_len = remaining_len > connection->buffer_length ? connection->buffer_length : remaining_len;
-            memcpy(connection->buffer, current_data, write_len);
-            connection->outbound_message.data = connection->buffer;
-            connection->outbound_message.length = write_len;
-            sending = true;
-        } else {
-            // Message was sent correctly
-            sending = false;
+    mqtt_message_t *msg = &client->mqtt_state.connection.outbound_message;
+    int data_in_buffer = msg->length - msg->fragmented_msg_data_offset;
+    msg->fragmented_msg_data_offset = 0;
+    msg->fragmented_msg_total_length = 0;
+    esp_err_t err;
+    if (data_in_buffer < len) {
+        /* The payload doesn't fit the buffer, write the packet header from the buffer and the payload from user data */
+        ESP_LOGD(TAG, "Sending fragmented message of %d bytes", len);
+        err = esp_mqtt_flush_batch(client);
+        if (err == ESP_OK) {
+            struct iovec iov[2] = {
+                { .iov_base = msg->data, .iov_len = msg->length - data_in_buffer },
+                { .iov_base = (void *)data, .iov_len = len },
+            };
+            err = esp_mqtt_writev(client, iov, 2);
+        }
+    } else {
+        err = esp_mqtt_batch_outbound(client);
+        if (err == ESP_ERR_NOT_SUPPORTED) {
+            err = esp_mqtt_write(client);
         }
     }
+    if (err != ESP_OK) {
+        esp_mqtt_abort_connection(client);
+        ret = -1;
+        goto cannot_publish;
+    }
 
     if (qos > 0) {
 #ifdef MQTT_PROTOCOL_5
@@ -2253,6 +2353,7 @@ MQTT_API_LOCK(client);
 cannot_publish:
     // clear out possible fragmented publish if failed or skipped
     client->mqtt_state.connection.outbound_message.fragmented_msg_total_length = 0;
+    client->mqtt_state.connection.outbound_message.fragmented_msg_data_offset = 0;
     if (qos == 0) {
         ESP_LOGW(TAG, "Publish: Losing qos0 data when client not connected");
     }
@@ -2303,6 +2404,22 @@ int esp_mqtt_client_enqueue(esp_mqtt_client_handle_t client, const char *topic,
     return ret;
 }
 
+esp_err_t esp_mqtt_client_flush(esp_mqtt_client_handle_t client)
+{
+    if (!client) {
+        ESP_LOGE(TAG, "Client was not initialized");
+        return ESP_ERR_INVALID_ARG;
+    }
+    MQTT_API_LOCK(client);
+    if (esp_mqtt_flush_batch(client) != ESP_OK) {
+        esp_mqtt_abort_connection(client);
+        MQTT_API_UNLOCK(client);
+        return ESP_FAIL;
+    }
+    MQTT_API_UNLOCK(client);
+    return ESP_OK;
+}
+
 esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event, esp_event_handler_t event_handler, void *event_handler_arg)
 {
     if (client == NULL) {
@@ -0,0 +1,277 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Unlicense OR CC0-1.0
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/event_groups.h"
+#include "unity.h"
+#include "esp_timer.h"
+#include "mqtt_client.h"
+
+#define TEST_PORT           31883
+#define TEST_URI            "mqtt://127.0.0.1:31883"
+#define TEST_TOPIC          "batch"
+#define TEST_PAYLOAD_LEN    16
+/* PUBLISH packet of a QoS 0 message: fixed header, topic length, topic and payload */
+#define TEST_PACKET_LEN     (2 + 2 + sizeof(TEST_TOPIC) - 1 + TEST_PAYLOAD_LEN)
+#define CONNECTED_BIT       BIT0
+
+#ifdef CONFIG_MQTT_POLL_READ_TIMEOUT_MS
+#define TEST_POLL_READ_TIMEOUT_MS   CONFIG_MQTT_POLL_READ_TIMEOUT_MS
+#else
+#define TEST_POLL_READ_TIMEOUT_MS   1000
+#endif
+
+/* Broker stand-in: accepts a single connection, acknowledges CONNECT, PINGREQ and QoS 1 PUBLISH packets,
+ * and checks that the payloads of the PUBLISH packets carry consecutive sequence numbers */
+typedef struct {
+    int listen_fd;
+    pthread_t thread;
+    atomic_int published;
+    atomic_int corrupted;
+} test_broker_t;
+
+typedef struct {
+    esp_mqtt_client_handle_t client;
+    EventGroupHandle_t events;
+    test_broker_t broker;
+} test_connection_t;
+
+static void test_broker_handle(test_broker_t *broker, int sock, const uint8_t *packet, size_t header_len, size_t remaining)
+{
+    int type = packet[0] >> 4;
+    if (type == 1) {        // CONNECT
+        const uint8_t connack[] = { 0x20, 2, 0, 0 };
+        send(sock, connack, sizeof(connack), 0);
+    } else if (type == 12) {    // PINGREQ
+        const uint8_t pingresp[] = { 0xd0, 0 };
+        send(sock, pingresp, sizeof(pingresp), 0);
+    } else if (type == 3) {     // PUBLISH
+        int qos = (packet[0] >> 1) & 3;
+        const uint8_t *topic = packet + header_len;
+        size_t topic_len = (topic[0] << 8) | topic[1];
+        const uint8_t *payload = topic + 2 + topic_len + (qos ? 2 : 0);
+        size_t payload_len = packet + header_len + remaining - payload;
+        char expected[TEST_PAYLOAD_LEN + 1];
+        snprintf(expected, sizeof(expected), "%08d%08d", broker->published, broker->published);
+        if (payload_len < TEST_PAYLOAD_LEN || memcmp(payload, expected, TEST_PAYLOAD_LEN) != 0) {
+            broker->corrupted++;
+        }
+        if (qos) {
+            const uint8_t puback[] = { 0x40, 2, topic[2 + topic_len], topic[3 + topic_len] };
+            send(sock, puback, sizeof(puback), 0);
+        }
+        broker->published++;
+    }
+}
+
+static void *test_broker_task(void *arg)
+{
+    test_broker_t *broker = arg;
+    static uint8_t buf[64 * 1024];
+    size_t len = 0;
+    int sock;
+    while ((sock = accept(broker->listen_fd, NULL, NULL)) < 0 && errno == EINTR) {
+    }
+    while (sock >= 0) {
+        ssize_t ret = recv(sock, buf + len, sizeof(buf) - len, 0);
+        if (ret < 0 && errno == EINTR) {
+            continue;
+        }
+        if (ret <= 0) {
+            break;
+        }
+        len += ret;
+        size_t offset = 0;
+        for (;;) {
+            // Remaining length, of up to four bytes
+            size_t remaining = 0;
+            size_t header_len = 1;
+            bool complete = false;
+            while (offset + header_len < len && header_len <= 4) {
+                uint8_t byte = buf[offset + header_len];
+                remaining |= (size_t)(byte & 0x7f) << (7 * (header_len - 1));
+                header_len++;
+                if (!(byte & 0x80)) {
+                    complete = true;
+                    break;
+                }
+            }
+            if (!complete || len - offset < header_len + remaining) {
+                break;
+            }
+            test_broker_handle(broker, sock, buf + offset, header_len, remaining);
+            offset += header_len + remaining;
+        }
+        memmove(buf, buf + offset, len - offset);
+        len -= offset;
+    }
+    if (sock >= 0) {
+        close(sock);
+    }
+    return NULL;
+}
+
+static void test_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data)
+{
+    test_connection_t *conn = arg;
+    if (event_id == MQTT_EVENT_CONNECTED) {
+        xEventGroupSetBits(conn->events, CONNECTED_BIT);
+    }
+}
+
+static void test_connect(test_connection_t *conn, int batch_size, int batch_timeout_ms)
+{
+    memset(conn, 0, sizeof(*conn));
+    test_broker_t *broker = &conn->broker;
+    broker->listen_fd = socket(AF_INET, SOCK_STREAM, 0);
+    TEST_ASSERT_GREATER_OR_EQUAL(0, broker->listen_fd);
+    int enable = 1;
+    setsockopt(broker->listen_fd, SOL_SOCKET, SO_REUSEADDR, &enable, sizeof(enable));
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(TEST_PORT),
+        .sin_addr.s_addr = htonl(INADDR_LOOPBACK),
+    };
+    TEST_ASSERT_EQUAL(0, bind(broker->listen_fd, (struct sockaddr *)&addr, sizeof(addr)));
+    TEST_ASSERT_EQUAL(0, listen(broker->listen_fd, 1));
+    TEST_ASSERT_EQUAL(0, pthread_create(&broker->thread, NULL, test_broker_task, broker));
+
+    esp_mqtt_client_config_t config = {
+        .broker.address.uri = TEST_URI,
+        .buffer.size = 1024,
+        .batch = {
+            .size = batch_size,
+            .timeout_ms = batch_timeout_ms,
+        },
+    };
+    conn->events = xEventGroupCreate();
+    TEST_ASSERT_NOT_NULL(conn->events);
+    conn->client = esp_mqtt_client_init(&config);
+    TEST_ASSERT_NOT_NULL(conn->client);
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mqtt_client_register_event(conn->client, MQTT_EVENT_ANY, test_event_handler, conn));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mqtt_client_start(conn->client));
+    EventBits_t bits = xEventGroupWaitBits(conn->events, CONNECTED_BIT, pdFALSE, pdTRUE, pdMS_TO_TICKS(5000));
+    TEST_ASSERT(bits & CONNECTED_BIT);
+}
+
+static void test_disconnect(test_connection_t *conn)
+{
+    esp_mqtt_client_destroy(conn->client);
+    pthread_join(conn->broker.thread, NULL);
+    close(conn->broker.listen_fd);
+    vEventGroupDelete(conn->events);
+    TEST_ASSERT_EQUAL(0, conn->broker.corrupted);
+}
+
+static int test_publish(test_connection_t *conn, int seq, int qos)
+{
+    char payload[TEST_PAYLOAD_LEN + 1];
+    snprintf(payload, sizeof(payload), "%08d%08d", seq, seq);
+    return esp_mqtt_client_publish(conn->client, TEST_TOPIC, payload, TEST_PAYLOAD_LEN, qos, 0);
+}
+
+/* Waits until the broker has received the messages */
+static void test_wait_published(test_connection_t *conn, int published, int timeout_ms)
+{
+    int64_t start = esp_timer_get_time();
+    while (conn->broker.published < published && esp_timer_get_time() - start < timeout_ms * 1000LL) {
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_EQUAL(published, conn->broker.published);
+}
+
+TEST_CASE("batched messages are held until the send buffer is full or flushed", "[batch]")
+{
+    test_connection_t conn;
+    const int batch_size = 1024;
+    const int batched = batch_size / TEST_PACKET_LEN;
+    test_connect(&conn, batch_size, 60000);
+
+    for (int i = 0; i < batched; i++) {
+        TEST_ASSERT_EQUAL(0, test_publish(&conn, i, 0));
+    }
+    vTaskDelay(pdMS_TO_TICKS(100));
+    TEST_ASSERT_EQUAL(0, conn.broker.published);
+
+    /* The next message does not fit: the buffer is written out in a single write, the message starts the next batch */
+    TEST_ASSERT_EQUAL(0, test_publish(&conn, batched, 0));
+    test_wait_published(&conn, batched, 1000);
+
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mqtt_client_flush(conn.client));
+    test_wait_published(&conn, batched + 1, 1000);
+
+    /* QoS 1 messages are batched as well, and are acknowledged */
+    TEST_ASSERT_GREATER_THAN(0, test_publish(&conn, batched + 1, 1));
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mqtt_client_flush(conn.client));
+    test_wait_published(&conn, batched + 2, 1000);
+    int64_t start = esp_timer_get_time();
+    while (esp_mqtt_client_get_outbox_size(conn.client) > 0 && esp_timer_get_time() - start < 1000 * 1000) {
+        vTaskDelay(1);
+    }
+    TEST_ASSERT_EQUAL(0, esp_mqtt_client_get_outbox_size(conn.client));
+
+    test_disconnect(&conn);
+}
+
+TEST_CASE("batched messages are written out after the batch timeout", "[batch]")
+{
+    test_connection_t conn;
+    const int batch_timeout_ms = 20;
+    test_connect(&conn, 1024, batch_timeout_ms);
+
+    /* A message left alone in the buffer is written out by the client task */
+    TEST_ASSERT_EQUAL(0, test_publish(&conn, 0, 0));
+    test_wait_published(&conn, 1, TEST_POLL_READ_TIMEOUT_MS + batch_timeout_ms + 500);
+
+    /* A publish after the timeout writes out the messages waiting in the buffer */
+    TEST_ASSERT_EQUAL(0, test_publish(&conn, 1, 0));
+    vTaskDelay(pdMS_TO_TICKS(batch_timeout_ms + 10));
+    TEST_ASSERT_EQUAL(0, test_publish(&conn, 2, 0));
+    test_wait_published(&conn, 3, 100);
+
+    test_disconnect(&conn);
+}
+
+static void bench_publish(int batch_size, int messages)
+{
+    test_connection_t conn;
+    test_connect(&conn, batch_size, 10);
+
+    int64_t start = esp_timer_get_time();
+    for (int i = 0; i < messages; i++) {
+        TEST_ASSERT_EQUAL(0, test_publish(&conn, i, 0));
+    }
+    TEST_ASSERT_EQUAL(ESP_OK, esp_mqtt_client_flush(conn.client));
+    test_wait_published(&conn, messages, 10000);
+    int64_t elapsed_us = esp_timer_get_time() - start;
+
+    printf("%-12d %12d %14.0f\n", batch_size, messages, messages * 1e6 / elapsed_us);
+    test_disconnect(&conn);
+}
+
+TEST_CASE("publish rate with and without batching", "[batch]")
+{
+    const int messages = 20000;
+    printf("%-12s %12s %14s\n", "Batch size", "Messages", "Messages/s");
+    bench_publish(0, messages);
+    bench_publish(1024, messages);
+    bench_publish(4096, messages);
+}
+
+void app_main(void)
+{
+    printf("Running MQTT publish batching linux host test app\n");
+    unity_run_menu();
+}
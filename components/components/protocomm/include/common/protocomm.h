@@ -147,6 +147,10 @@ esp_err_t protocomm_close_session(protocomm_t *pc, uint32_t session_id);
  *  - An endpoint must be bound to a valid protocomm instance,
  *    created using `protocomm_new()`.
  *  - Resulting output buffer must be deallocated by the caller.
+ *  - With security, encrypted requests are copied to a buffer kept by the
+ *    instance between requests. A request larger than 1024 bytes, or handled
+ *    while another task uses that buffer, is copied to a buffer allocated
+ *    for it instead.
  *
  * @param[in]  pc         Pointer to the protocomm instance
  * @param[in]  ep_name    Endpoint identifier(name) string
@@ -170,6 +174,34 @@ esp_err_t protocomm_req_handle(protocomm_t *pc, const char *ep_name, uint32_t se
                                const uint8_t *inbuf, ssize_t inlen,
                                uint8_t **outbuf, ssize_t *outlen);
 
+/**
+ * @brief   Same as protocomm_req_handle(), but the request is
+ *          decrypted in place in the input buffer
+ *
+ * Transports which own the buffer of the received request can use
+ * this function to avoid copying it before it is decrypted.
+ *
+ * @note
+ *  - The content of the input buffer is undefined on return.
+ *  - Resulting output buffer must be deallocated by the caller.
+ *
+ * @param[in]  pc         Pointer to the protocomm instance
+ * @param[in]  ep_name    Endpoint identifier(name) string
+ * @param[in]  session_id Unique ID for a communication session
+ * @param[in]  inbuf      Input buffer contains input request data which is to be
+ *                        processed by the registered handler
+ * @param[in]  inlen      Length of the input buffer
+ * @param[out] outbuf     Pointer to internally allocated output buffer,
+ *                        where the resulting response data output from
+ *                        the registered handler is to be stored
+ * @param[out] outlen     Buffer length of the allocated output buffer
+ *
+ * @return See protocomm_req_handle()
+ */
+esp_err_t protocomm_req_handle_inplace(protocomm_t *pc, const char *ep_name, uint32_t session_id,
+                                       uint8_t *inbuf, ssize_t inlen,
+                                       uint8_t **outbuf, ssize_t *outlen);
+
 /**
  * @brief   Add endpoint security for a protocomm instance
  *
@@ -140,6 +140,33 @@ typedef struct protocomm_security {
                          uint32_t session_id,
                          const uint8_t *inbuf, ssize_t inlen,
                          uint8_t **outbuf, ssize_t *outlen);
+
+    /**
+     * Optional function which encrypts the data in place.
+     * The buffer must have room for inlen + encrypt_overhead bytes.
+     * When available, it is used instead of `encrypt` so that
+     * no buffer is allocated for each message
+     */
+    esp_err_t (*encrypt_inplace)(protocomm_security_handle_t handle,
+                                 uint32_t session_id,
+                                 uint8_t *buf, ssize_t inlen,
+                                 ssize_t *outlen);
+
+    /**
+     * Optional function which decrypts the data in place.
+     * When available, it is used instead of `decrypt` so that
+     * no buffer is allocated for each message
+     */
+    esp_err_t (*decrypt_inplace)(protocomm_security_handle_t handle,
+                                 uint32_t session_id,
+                                 uint8_t *buf, ssize_t inlen,
+                                 ssize_t *outlen);
+
+    /**
+     * Number of bytes added to the data by encrypt_inplace,
+     * e.g. for an authentication tag
+     */
+    uint8_t encrypt_overhead;
 } protocomm_security_t;
 
 #ifdef __cplusplus
@@ -7,6 +7,8 @@
 #include <stdlib.h>
 #include <string.h>
 #include <inttypes.h>
+#include <stdbool.h>
+#include <stdatomic.h>
 
 #include <esp_err.h>
 #include <esp_log.h>
@@ -57,6 +59,7 @@ void protocomm_delete(protocomm_t *pc)
     if (pc->sec_params) {
         free(pc->sec_params);
     }
+    free(pc->rx_buf);
     free(pc);
 }
 
@@ -173,9 +176,91 @@ esp_err_t protocomm_close_session(protocomm_t *pc, uint32_t session_id)
     return ESP_OK;
 }
 
-esp_err_t protocomm_req_handle(protocomm_t *pc, const char *ep_name, uint32_t session_id,
-                               const uint8_t *inbuf, ssize_t inlen,
-                               uint8_t **outbuf, ssize_t *outlen)
+/* Returns a buffer of len bytes to copy a request to. The buffer of the instance is
+ * used by one request at a time, and only for requests up to PROTOCOMM_RX_BUF_MAX_SIZE.
+ * Other requests get a buffer of their own, *kept is set to false for them. */
+static uint8_t *protocomm_rx_buf_get(protocomm_t *pc, size_t len, bool *kept)
+{
+    *kept = false;
+    if (len > PROTOCOMM_RX_BUF_MAX_SIZE || atomic_exchange(&pc->rx_buf_busy, true)) {
+        return malloc(len);
+    }
+
+    if (pc->rx_buf_size < len) {
+        uint8_t *rx_buf = realloc(pc->rx_buf, len);
+        if (!rx_buf) {
+            atomic_store(&pc->rx_buf_busy, false);
+            return NULL;
+        }
+        pc->rx_buf = rx_buf;
+        pc->rx_buf_size = len;
+    }
+    *kept = true;
+    return pc->rx_buf;
+}
+
+/* Releases the buffer returned by protocomm_rx_buf_get() */
+static void protocomm_rx_buf_put(protocomm_t *pc, uint8_t *buf, bool kept)
+{
+    if (kept) {
+        atomic_store(&pc->rx_buf_busy, false);
+    } else {
+        free(buf);
+    }
+}
+
+/* Handles a request for an endpoint with encryption without allocating buffers for the
+ * decrypted request and the encrypted response: the request is decrypted in place in buf
+ * and the response is encrypted in place in the buffer allocated by the endpoint handler */
+static esp_err_t protocomm_req_handle_crypt_inplace(protocomm_t *pc, protocomm_ep_t *ep, uint32_t session_id,
+                                                    uint8_t *buf, ssize_t inlen,
+                                                    uint8_t **outbuf, ssize_t *outlen)
+{
+    ssize_t dec_len = 0;
+    esp_err_t ret = pc->sec->decrypt_inplace(pc->sec_inst, session_id, buf, inlen, &dec_len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Decryption of request failed for endpoint %s", ep->ep_name);
+        return ret;
+    }
+
+    /* Invoke the request handler */
+    uint8_t *resp = NULL;
+    ssize_t resp_len = 0;
+    ret = ep->req_handler(session_id, buf, dec_len, &resp, &resp_len, ep->priv_data);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Request handler for %s failed", ep->ep_name);
+        free(resp);
+        return ret;
+    }
+
+    /* Make room for the data added by the encryption, e.g. an authentication tag */
+    if (pc->sec->encrypt_overhead) {
+        uint8_t *enc_resp = realloc(resp, resp_len + pc->sec->encrypt_overhead);
+        if (!enc_resp) {
+            ESP_LOGE(TAG, "Failed to allocate response buf len %d", resp_len + pc->sec->encrypt_overhead);
+            free(resp);
+            return ESP_ERR_NO_MEM;
+        }
+        resp = enc_resp;
+    }
+
+    ssize_t enc_len = 0;
+    ret = pc->sec->encrypt_inplace(pc->sec_inst, session_id, resp, resp_len, &enc_len);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Encryption of response failed for endpoint %s", ep->ep_name);
+        free(resp);
+        return ret;
+    }
+
+    /* Set outbuf and outlen appropriately */
+    *outbuf = resp;
+    *outlen = enc_len;
+    return ESP_OK;
+}
+
+static esp_err_t protocomm_req_handle_internal(protocomm_t *pc, const char *ep_name, uint32_t session_id,
+                                               const uint8_t *inbuf, uint8_t *inplace_buf, ssize_t inlen,
+                                               uint8_t **outbuf, ssize_t *outlen)
 {
     if (!pc || !ep_name || !outbuf || !outlen) {
         ESP_LOGE(TAG, "Invalid params %p %p", pc, ep_name);
@@ -197,7 +282,24 @@ esp_err_t protocomm_req_handle(protocomm_t *pc, const char *ep_name, uint32_t se
         ret = ep->req_handler(session_id, inbuf, inlen, outbuf, outlen, ep->priv_data);
         ESP_LOGD(TAG, "SEC_EP Req handler returned %d", ret);
     } else if (ep->flag & REQ_EP) {
-        if (pc->sec && pc->sec->decrypt) {
+        if (pc->sec && pc->sec->decrypt_inplace && pc->sec->encrypt_inplace) {
+            if (inplace_buf) {
+                ret = protocomm_req_handle_crypt_inplace(pc, ep, session_id, inplace_buf, inlen, outbuf, outlen);
+            } else {
+                /* Copy the request to a buffer in which it can be decrypted */
+                bool kept;
+                uint8_t *rx_buf = protocomm_rx_buf_get(pc, inlen, &kept);
+                if (!rx_buf && inlen) {
+                    ESP_LOGE(TAG, "Failed to allocate request buf len %d", inlen);
+                    return ESP_ERR_NO_MEM;
+                }
+                if (inlen) {
+                    memcpy(rx_buf, inbuf, inlen);
+                }
+                ret = protocomm_req_handle_crypt_inplace(pc, ep, session_id, rx_buf, inlen, outbuf, outlen);
+                protocomm_rx_buf_put(pc, rx_buf, kept);
+            }
+        } else if (pc->sec && pc->sec->decrypt) {
             /* Decrypt the data first */
             ssize_t dec_inbuf_len = 0;
             uint8_t *dec_inbuf = NULL;
@@ -257,6 +359,20 @@ esp_err_t protocomm_req_handle(protocomm_t *pc, const char *ep_name, uint32_t se
     return ret;
 }
 
+esp_err_t protocomm_req_handle(protocomm_t *pc, const char *ep_name, uint32_t session_id,
+                               const uint8_t *inbuf, ssize_t inlen,
+                               uint8_t **outbuf, ssize_t *outlen)
+{
+    return protocomm_req_handle_internal(pc, ep_name, session_id, inbuf, NULL, inlen, outbuf, outlen);
+}
+
+esp_err_t protocomm_req_handle_inplace(protocomm_t *pc, const char *ep_name, uint32_t session_id,
+                                       uint8_t *inbuf, ssize_t inlen,
+                                       uint8_t **outbuf, ssize_t *outlen)
+{
+    return protocomm_req_handle_internal(pc, ep_name, session_id, inbuf, inbuf, inlen, outbuf, outlen);
+}
+
 static int protocomm_common_security_handler(uint32_t session_id,
                                              const uint8_t *inbuf, ssize_t inlen,
                                              uint8_t **outbuf, ssize_t *outlen,
@@ -1,17 +1,23 @@
 /*
- * SPDX-FileCopyrightText: 2018-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
 
 #pragma once
 
+#include <stdbool.h>
+#include <stdatomic.h>
 #include <sys/queue.h>
 #include <protocomm_security.h>
 #include <esp_err.h>
 
 #define PROTOCOMM_NO_SESSION_ID UINT32_MAX
 
+/* Largest request copied to the buffer kept by the instance. Larger requests
+ * are copied to a buffer allocated for the request only */
+#define PROTOCOMM_RX_BUF_MAX_SIZE   1024
+
 /* Bit Flags for indicating intended functionality of handler to either
  * process request or establish secure session */
 #define REQ_EP      (1 << 0)    /*!< Flag indicating request  handling endpoint */
@@ -71,4 +77,15 @@ struct protocomm {
 
     /* Application specific version string */
     const char* ver;
+
+    /* Buffer in which requests are decrypted in place, kept between
+     * requests and grown up to PROTOCOMM_RX_BUF_MAX_SIZE */
+    uint8_t *rx_buf;
+
+    /* Size of the allocated rx_buf */
+    size_t rx_buf_size;
+
+    /* Set while a request uses rx_buf. Requests handled at the same
+     * time from other tasks allocate a buffer of their own */
+    atomic_bool rx_buf_busy;
 };
@@ -510,17 +510,14 @@ static esp_err_t sec1_cleanup(protocomm_security_handle_t handle)
     return ESP_OK;
 }
 
-static esp_err_t sec1_decrypt(protocomm_security_handle_t handle,
-                              uint32_t session_id,
-                              const uint8_t *inbuf, ssize_t inlen,
-                              uint8_t **outbuf, ssize_t *outlen)
+static esp_err_t sec1_crypt(session_t *cur_session, uint32_t session_id,
+                            const uint8_t *inbuf, ssize_t inlen, uint8_t *outbuf)
 {
-    session_t *cur_session = (session_t *) handle;
     if (!cur_session) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!cur_session || cur_session->id != session_id) {
+    if (cur_session->id != session_id) {
         ESP_LOGE(TAG, "Session with ID %" PRId32 "not found", session_id);
         return ESP_ERR_INVALID_STATE;
     }
@@ -530,6 +527,26 @@ static esp_err_t sec1_decrypt(protocomm_security_handle_t handle,
         return ESP_ERR_INVALID_STATE;
     }
 
+    /* AES-CTR allows the input and output buffers to be the same */
+    int ret = mbedtls_aes_crypt_ctr(&cur_session->ctx_aes, inlen, &cur_session->nc_off,
+                                    cur_session->rand, cur_session->stb, inbuf, outbuf);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed at mbedtls_aes_crypt_ctr with error code : %d", ret);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t sec1_decrypt(protocomm_security_handle_t handle,
+                              uint32_t session_id,
+                              const uint8_t *inbuf, ssize_t inlen,
+                              uint8_t **outbuf, ssize_t *outlen)
+{
+    session_t *cur_session = (session_t *) handle;
+    if (!cur_session) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
     *outlen = inlen;
     *outbuf = (uint8_t *) malloc(*outlen);
     if (!*outbuf) {
@@ -537,13 +554,16 @@ static esp_err_t sec1_decrypt(protocomm_security_handle_t handle,
         return ESP_ERR_NO_MEM;
     }
 
-    int ret = mbedtls_aes_crypt_ctr(&cur_session->ctx_aes, inlen, &cur_session->nc_off,
-                                    cur_session->rand, cur_session->stb, inbuf, *outbuf);
-    if (ret != 0) {
-        ESP_LOGE(TAG, "Failed at mbedtls_aes_crypt_ctr with error code : %d", ret);
-        return ESP_FAIL;
-    }
-    return ESP_OK;
+    return sec1_crypt(cur_session, session_id, inbuf, inlen, *outbuf);
+}
+
+static esp_err_t sec1_decrypt_inplace(protocomm_security_handle_t handle,
+                                      uint32_t session_id,
+                                      uint8_t *buf, ssize_t inlen,
+                                      ssize_t *outlen)
+{
+    *outlen = inlen;
+    return sec1_crypt((session_t *) handle, session_id, buf, inlen, buf);
 }
 
 static esp_err_t sec1_req_handler(protocomm_security_handle_t handle,
@@ -611,4 +631,6 @@ const protocomm_security_t protocomm_security1 = {
     .security_req_handler = sec1_req_handler,
     .encrypt = sec1_decrypt, /* Encrypt == decrypt for AES-CTR */
     .decrypt = sec1_decrypt,
+    .encrypt_inplace = sec1_decrypt_inplace,
+    .decrypt_inplace = sec1_decrypt_inplace,
 };
@@ -447,17 +447,13 @@ static esp_err_t sec2_cleanup(protocomm_security_handle_t handle)
     return ESP_OK;
 }
 
-static esp_err_t sec2_encrypt(protocomm_security_handle_t handle,
-                              uint32_t session_id,
-                              const uint8_t *inbuf, ssize_t inlen,
-                              uint8_t **outbuf, ssize_t *outlen)
+static esp_err_t sec2_check_session(session_t *cur_session, uint32_t session_id)
 {
-    session_t *cur_session = (session_t *) handle;
     if (!cur_session) {
         return ESP_ERR_INVALID_ARG;
     }
 
-    if (!cur_session || cur_session->id != session_id) {
+    if (cur_session->id != session_id) {
         ESP_LOGE(TAG, "Session with ID %" PRId32 "not found", session_id);
         return ESP_ERR_INVALID_STATE;
     }
@@ -472,24 +468,25 @@ static esp_err_t sec2_encrypt(protocomm_security_handle_t handle,
         ESP_LOGE(TAG, "Invalid counter value, restart session");
         return ESP_ERR_INVALID_STATE;
     }
+    return ESP_OK;
+}
+
+/* The output buffer can be the same as the input buffer, it must have room for
+ * inlen + AES_GCM_TAG_LEN bytes */
+static esp_err_t sec2_gcm_encrypt(session_t *cur_session, const uint8_t *inbuf, ssize_t inlen, uint8_t *outbuf)
+{
     hexdump("Encrypt IV", (char *)cur_session->iv, AES_GCM_IV_SIZE);
 
-    *outlen = inlen + AES_GCM_TAG_LEN;
-    *outbuf = (uint8_t *) malloc(*outlen);
-    if (!*outbuf) {
-        ESP_LOGE(TAG, "Failed to allocate encrypt buf len %d", *outlen);
-        return ESP_ERR_NO_MEM;
-    }
     uint8_t gcm_tag[AES_GCM_TAG_LEN];
 
     int ret = mbedtls_gcm_crypt_and_tag(&cur_session->ctx_gcm, MBEDTLS_GCM_ENCRYPT, inlen, cur_session->iv,
                                         AES_GCM_IV_SIZE, NULL, 0, inbuf,
-                                        *outbuf, AES_GCM_TAG_LEN, gcm_tag);
+                                        outbuf, AES_GCM_TAG_LEN, gcm_tag);
     if (ret != 0) {
         ESP_LOGE(TAG, "Failed at mbedtls_gcm_crypt_and_tag with error code : %d", ret);
         return ESP_FAIL;
     }
-    memcpy(*outbuf + inlen, gcm_tag, AES_GCM_TAG_LEN);
+    memcpy(outbuf + inlen, gcm_tag, AES_GCM_TAG_LEN);
 
     /* Increment counter value for next operation */
     sec2_gcm_iv_counter_increment(cur_session->iv);
@@ -497,32 +494,60 @@ static esp_err_t sec2_encrypt(protocomm_security_handle_t handle,
     return ESP_OK;
 }
 
-static esp_err_t sec2_decrypt(protocomm_security_handle_t handle,
+/* The output buffer can be the same as the input buffer */
+static esp_err_t sec2_gcm_decrypt(session_t *cur_session, const uint8_t *inbuf, ssize_t inlen, uint8_t *outbuf)
+{
+    hexdump("Decrypt IV", (char *)cur_session->iv, AES_GCM_IV_SIZE);
+
+    int ret = mbedtls_gcm_auth_decrypt(&cur_session->ctx_gcm, inlen - AES_GCM_TAG_LEN, cur_session->iv,
+                                       AES_GCM_IV_SIZE, NULL, 0, inbuf + (inlen - AES_GCM_TAG_LEN), AES_GCM_TAG_LEN, inbuf, outbuf);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed at mbedtls_gcm_auth_decrypt : %d", ret);
+        return ESP_FAIL;
+    }
+
+    /* Increment counter value for next operation */
+    sec2_gcm_iv_counter_increment(cur_session->iv);
+
+    return ESP_OK;
+}
+
+static esp_err_t sec2_encrypt(protocomm_security_handle_t handle,
                               uint32_t session_id,
                               const uint8_t *inbuf, ssize_t inlen,
                               uint8_t **outbuf, ssize_t *outlen)
 {
     session_t *cur_session = (session_t *) handle;
-    if (!cur_session) {
-        return ESP_ERR_INVALID_ARG;
+    esp_err_t ret = sec2_check_session(cur_session, session_id);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    if (!cur_session || cur_session->id != session_id) {
-        ESP_LOGE(TAG, "Session with ID %" PRId32 "not found", session_id);
-        return ESP_ERR_INVALID_STATE;
+    *outlen = inlen + AES_GCM_TAG_LEN;
+    *outbuf = (uint8_t *) malloc(*outlen);
+    if (!*outbuf) {
+        ESP_LOGE(TAG, "Failed to allocate encrypt buf len %d", *outlen);
+        return ESP_ERR_NO_MEM;
     }
 
-    if (cur_session->state != SESSION_STATE_DONE) {
-        ESP_LOGE(TAG, "Secure session not established");
-        return ESP_ERR_INVALID_STATE;
+    return sec2_gcm_encrypt(cur_session, inbuf, inlen, *outbuf);
+}
+
+static esp_err_t sec2_decrypt(protocomm_security_handle_t handle,
+                              uint32_t session_id,
+                              const uint8_t *inbuf, ssize_t inlen,
+                              uint8_t **outbuf, ssize_t *outlen)
+{
+    session_t *cur_session = (session_t *) handle;
+    esp_err_t ret = sec2_check_session(cur_session, session_id);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    aes_gcm_iv_t *iv = (aes_gcm_iv_t *) cur_session->iv;
-    if (be32toh(iv->counter) == 0) {
-        ESP_LOGE(TAG, "Invalid counter value, restart session");
-        return ESP_ERR_INVALID_STATE;
+    if (inlen < AES_GCM_TAG_LEN) {
+        ESP_LOGE(TAG, "Encrypted data shorter than the tag");
+        return ESP_ERR_INVALID_ARG;
     }
-    hexdump("Decrypt IV", (char *)cur_session->iv, AES_GCM_IV_SIZE);
 
     *outlen = inlen - AES_GCM_TAG_LEN;
     *outbuf = (uint8_t *) malloc(*outlen);
@@ -531,17 +556,42 @@ static esp_err_t sec2_decrypt(protocomm_security_handle_t handle,
         return ESP_ERR_NO_MEM;
     }
 
-    int ret = mbedtls_gcm_auth_decrypt(&cur_session->ctx_gcm, inlen - AES_GCM_TAG_LEN, cur_session->iv,
-                                       AES_GCM_IV_SIZE, NULL, 0, inbuf + (inlen - AES_GCM_TAG_LEN), AES_GCM_TAG_LEN, inbuf, *outbuf);
-    if (ret != 0) {
-        ESP_LOGE(TAG, "Failed at mbedtls_gcm_auth_decrypt : %d", ret);
-        return ESP_FAIL;
+    return sec2_gcm_decrypt(cur_session, inbuf, inlen, *outbuf);
+}
+
+static esp_err_t sec2_encrypt_inplace(protocomm_security_handle_t handle,
+                                      uint32_t session_id,
+                                      uint8_t *buf, ssize_t inlen,
+                                      ssize_t *outlen)
+{
+    session_t *cur_session = (session_t *) handle;
+    esp_err_t ret = sec2_check_session(cur_session, session_id);
+    if (ret != ESP_OK) {
+        return ret;
     }
 
-    /* Increment counter value for next operation */
-    sec2_gcm_iv_counter_increment(cur_session->iv);
+    *outlen = inlen + AES_GCM_TAG_LEN;
+    return sec2_gcm_encrypt(cur_session, buf, inlen, buf);
+}
 
-    return ESP_OK;
+static esp_err_t sec2_decrypt_inplace(protocomm_security_handle_t handle,
+                                      uint32_t session_id,
+                                      uint8_t *buf, ssize_t inlen,
+                                      ssize_t *outlen)
+{
+    session_t *cur_session = (session_t *) handle;
+    esp_err_t ret = sec2_check_session(cur_session, session_id);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
+    if (inlen < AES_GCM_TAG_LEN) {
+        ESP_LOGE(TAG, "Encrypted data shorter than the tag");
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    *outlen = inlen - AES_GCM_TAG_LEN;
+    return sec2_gcm_decrypt(cur_session, buf, inlen, buf);
 }
 
 static esp_err_t sec2_req_handler(protocomm_security_handle_t handle,
@@ -610,4 +660,7 @@ const protocomm_security_t protocomm_security2 = {
     .security_req_handler = sec2_req_handler,
     .encrypt = sec2_encrypt,
     .decrypt = sec2_decrypt,
+    .encrypt_inplace = sec2_encrypt_inplace,
+    .decrypt_inplace = sec2_decrypt_inplace,
+    .encrypt_overhead = AES_GCM_TAG_LEN,
 };
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2022 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -134,11 +134,9 @@ static int common_cmd_handler(int argc, char** argv)
 
     uint32_t cur_session_id = atoi(argv[1]);
 
-    uint8_t *buf = (uint8_t *) malloc(strlen(argv[2]));
-    if (buf == NULL) {
-        ESP_LOGE(TAG, "Failed to allocate memory");
-        return ESP_ERR_NO_MEM;
-    }
+    /* The request is decoded in place, every byte being written
+     * over the two hex digits it was read from */
+    uint8_t *buf = (uint8_t *) argv[2];
     uint8_t *outbuf;
     ssize_t outlen;
     ssize_t len = hex2bin(argv[2], buf);
@@ -152,8 +150,7 @@ static int common_cmd_handler(int argc, char** argv)
         }
     }
 
-    ret = protocomm_req_handle(pc_console, argv[0], cur_session_id, buf, len, &outbuf, &outlen);
-    free(buf);
+    ret = protocomm_req_handle_inplace(pc_console, argv[0], cur_session_id, buf, len, &outbuf, &outlen);
 
     if (ret == ESP_OK) {
         printf("\r\n");
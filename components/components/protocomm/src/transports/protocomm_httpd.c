@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -25,6 +25,10 @@ static bool pc_ext_httpd_handle_provided = false;
 static uint32_t sock_session_id = PROTOCOMM_NO_SESSION_ID;
 /* Cookie session id, which is a random number passed through HTTP cookies */
 static uint32_t cookie_session_id = PROTOCOMM_NO_SESSION_ID;
+/* Buffer receiving the request bodies, kept between requests and grown to the
+ * size of the largest one. The requests are handled one at a time by the server task. */
+static uint8_t *req_body_buf;
+static size_t req_body_buf_size;
 
 #define MAX_REQ_BODY_LEN 4096
 
@@ -44,7 +48,6 @@ static esp_err_t common_post_handler(httpd_req_t *req)
 {
     esp_err_t ret;
     uint8_t *outbuf = NULL;
-    char *req_body = NULL;
     const char *ep_name = NULL;
     ssize_t outlen;
 
@@ -122,16 +125,20 @@ static esp_err_t common_post_handler(httpd_req_t *req)
         goto out;
     }
 
-    req_body = (char *) malloc(req->content_len);
-    if (!req_body) {
-        ESP_LOGE(TAG, "Unable to allocate for request length %d", req->content_len);
-        ret = ESP_ERR_NO_MEM;
-        goto out;
+    if (req_body_buf_size < req->content_len) {
+        uint8_t *buf = (uint8_t *) realloc(req_body_buf, req->content_len);
+        if (!buf) {
+            ESP_LOGE(TAG, "Unable to allocate for request length %d", req->content_len);
+            ret = ESP_ERR_NO_MEM;
+            goto out;
+        }
+        req_body_buf = buf;
+        req_body_buf_size = req->content_len;
     }
 
     size_t recv_size = 0;
     while (recv_size < req->content_len) {
-        ret = httpd_req_recv(req, req_body + recv_size, req->content_len - recv_size);
+        ret = httpd_req_recv(req, (char *) req_body_buf + recv_size, req->content_len - recv_size);
         if (ret <= 0) {
             ret = ESP_FAIL;
             goto out;
@@ -142,8 +149,9 @@ static esp_err_t common_post_handler(httpd_req_t *req)
     /* Extract the endpoint name from URI string of type "/ep_name" */
     ep_name = req->uri + 1;
 
-    ret = protocomm_req_handle(pc_httpd, ep_name, cookie_session_id,
-                               (uint8_t *)req_body, recv_size, &outbuf, &outlen);
+    /* The request body is not needed after the request, it is decrypted in place */
+    ret = protocomm_req_handle_inplace(pc_httpd, ep_name, cookie_session_id,
+                                       req_body_buf, recv_size, &outbuf, &outlen);
 
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "Data handler failed");
@@ -165,9 +173,6 @@ static esp_err_t common_post_handler(httpd_req_t *req)
     }
     ret = ESP_OK;
 out:
-    if (req_body) {
-        free(req_body);
-    }
     if (outbuf) {
         free(outbuf);
     }
@@ -311,6 +316,9 @@ esp_err_t protocomm_httpd_stop(protocomm_t *pc)
         }
         pc_httpd->priv = NULL;
         pc_httpd = NULL;
+        free(req_body_buf);
+        req_body_buf = NULL;
+        req_body_buf_size = 0;
         cookie_session_id = PROTOCOMM_NO_SESSION_ID;
         sock_session_id = PROTOCOMM_NO_SESSION_ID;
         return ESP_OK;
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2018-2023 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2018-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -10,6 +10,7 @@
 #include <esp_err.h>
 #include <esp_log.h>
 #include <esp_system.h>
+#include <esp_timer.h>
 #include <sys/random.h>
 #include <unistd.h>
 #include <unity.h>
@@ -29,7 +30,11 @@
 #endif
 
 #include <mbedtls/aes.h>
+#include <mbedtls/gcm.h>
+#include <mbedtls/dhm.h>
+#include <mbedtls/bignum.h>
 #include <mbedtls/sha256.h>
+#include <mbedtls/sha512.h>
 #include <mbedtls/entropy.h>
 #include <mbedtls/ctr_drbg.h>
 #include <mbedtls/ecdh.h>
@@ -39,6 +44,7 @@
 #include <protocomm_security.h>
 #include <protocomm_security0.h>
 #include <protocomm_security1.h>
+#include <protocomm_security2.h>
 #include "test_utils.h"
 
 #include "session.pb-c.h"
@@ -645,7 +651,7 @@ esp_err_t test_req_handler (uint32_t session_id,
     return ESP_OK;
 }
 
-static esp_err_t start_test_service(uint8_t sec_ver, const protocomm_security1_params_t *pop)
+static esp_err_t start_test_service(uint8_t sec_ver, const void *sec_params)
 {
     test_pc = protocomm_new();
     if (test_pc == NULL) {
@@ -660,11 +666,17 @@ static esp_err_t start_test_service(uint8_t sec_ver, const protocomm_security1_p
         }
         test_sec = &protocomm_security0;
     } else if (sec_ver == 1) {
-        if (protocomm_set_security(test_pc, "test-sec", &protocomm_security1, pop) != ESP_OK) {
+        if (protocomm_set_security(test_pc, "test-sec", &protocomm_security1, sec_params) != ESP_OK) {
             ESP_LOGE(TAG, "Failed to set Security1");
             return ESP_FAIL;
         }
         test_sec = &protocomm_security1;
+    } else if (sec_ver == 2) {
+        if (protocomm_set_security(test_pc, "test-sec", &protocomm_security2, sec_params) != ESP_OK) {
+            ESP_LOGE(TAG, "Failed to set Security2");
+            return ESP_FAIL;
+        }
+        test_sec = &protocomm_security2;
     }
 
     if (protocomm_set_version(test_pc, "test-ver", TEST_VER_STR) != ESP_OK) {
@@ -755,6 +767,632 @@ static esp_err_t test_security1_no_encryption (void)
     return ESP_OK;
 }
 
+/* With heap tracing enabled, counts the allocations made while handling requests */
+static void test_alloc_count_start(void)
+{
+#ifdef CONFIG_HEAP_TRACING
+    heap_trace_init_standalone(trace_record, NUM_RECORDS);
+    heap_trace_start(HEAP_TRACE_ALL);
+#endif
+}
+
+static void test_alloc_count_stop(int count)
+{
+#ifdef CONFIG_HEAP_TRACING
+    heap_trace_summary_t summary;
+    heap_trace_stop();
+    if (heap_trace_summary(&summary) == ESP_OK) {
+        ESP_LOGI(TAG, "%d allocations for %d requests", (int) summary.total_allocations, count);
+    }
+#endif
+}
+
+static esp_err_t test_security1_requests(session_t *session, int count)
+{
+    uint8_t req_data[128], req_buf[128], resp_data[128];
+    unsigned heap_before = 0;
+    int64_t start = esp_timer_get_time();
+
+    for (int i = 0; i < count; i++) {
+        getrandom(req_data, sizeof(req_data), 0);
+        mbedtls_aes_crypt_ctr(&session->ctx_aes, sizeof(req_data), &session->nc_off,
+                              session->rand, session->stb, req_data, req_buf);
+
+        uint8_t *enc_resp = NULL;
+        ssize_t enc_resp_len = 0;
+        esp_err_t ret;
+        /* Alternate between the request being copied and decrypted in place */
+        if (i % 2) {
+            ret = protocomm_req_handle_inplace(test_pc, "test-ep", session->id,
+                                               req_buf, sizeof(req_buf), &enc_resp, &enc_resp_len);
+        } else {
+            ret = protocomm_req_handle(test_pc, "test-ep", session->id,
+                                       req_buf, sizeof(req_buf), &enc_resp, &enc_resp_len);
+        }
+        if (ret != ESP_OK || enc_resp_len != sizeof(resp_data)) {
+            ESP_LOGE(TAG, "test-ep handler failed for request %d", i);
+            free(enc_resp);
+            return ESP_FAIL;
+        }
+        mbedtls_aes_crypt_ctr(&session->ctx_aes, enc_resp_len, &session->nc_off,
+                              session->rand, session->stb, enc_resp, resp_data);
+        free(enc_resp);
+
+        if (memcmp(req_data, resp_data, sizeof(req_data))) {
+            ESP_LOGE(TAG, "incorrect response data from test-ep for request %d", i);
+            return ESP_FAIL;
+        }
+        if (i == 1) {
+            /* The buffers kept between requests are allocated by now */
+            heap_before = esp_get_free_heap_size();
+            test_alloc_count_start();
+        }
+    }
+
+    int64_t elapsed = esp_timer_get_time() - start;
+    test_alloc_count_stop(count - 2);
+    ESP_LOGI(TAG, "%d requests in %lld us, %lld requests/s", count, elapsed,
+             elapsed ? count * 1000000LL / elapsed : 0);
+
+    if (esp_get_free_heap_size() != heap_before) {
+        ESP_LOGE(TAG, "Free heap size changed by %d bytes while handling the requests",
+                 (int) (esp_get_free_heap_size() - heap_before));
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t test_security1_many_requests (void)
+{
+    ESP_LOGI(TAG, "Starting Security 1 many requests test");
+
+    const char *pop_data = "test pop";
+    protocomm_security1_params_t pop = {
+        .data = (const uint8_t *)pop_data,
+        .len  = strlen(pop_data)
+    };
+
+    session_t *session = calloc(1, sizeof(session_t));
+    if (session == NULL) {
+        ESP_LOGE(TAG, "Error allocating session");
+        return ESP_ERR_NO_MEM;
+    }
+
+    session->id        = 9;
+    session->sec_ver   = 1;
+    session->pop       = &pop;
+
+    // Start protocomm service
+    if (start_test_service(1, &pop) != ESP_OK) {
+        ESP_LOGE(TAG, "Error starting test");
+        free(session);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Intialise protocomm session with zero public keys
+    if (test_new_session(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error creating new session");
+        stop_test_service();
+        free(session);
+        return ESP_FAIL;
+    }
+
+    // Perform 25519 security handshake to set public keys
+    if (test_sec_endpoint(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error testing security endpoint");
+        test_delete_session(session);
+        stop_test_service();
+        free(session);
+        return ESP_FAIL;
+    }
+
+    // Send many requests, the counter of the AES-CTR stream
+    // must stay in sync and no memory must be lost
+    if (test_security1_requests(session, 1000) != ESP_OK) {
+        ESP_LOGE(TAG, "Error sending many requests");
+        test_delete_session(session);
+        stop_test_service();
+        free(session);
+        return ESP_FAIL;
+    }
+
+    test_delete_session(session);
+    stop_test_service();
+    free(session);
+    ESP_LOGI(TAG, "Protocomm test successful");
+    return ESP_OK;
+}
+
+/* Security 2 client: SRP6a with the 3072-bit group of RFC 5054 and SHA-512,
+ * then AES-GCM keyed with the first half of the SRP session key */
+#define SEC2_SALT_LEN           16
+#define SEC2_PUBLIC_KEY_LEN     384
+#define SEC2_HASH_LEN           64
+#define SEC2_AES_KEY_BITS       256
+#define SEC2_IV_LEN             12
+#define SEC2_TAG_LEN            16
+
+static const uint8_t sec2_N[SEC2_PUBLIC_KEY_LEN] = MBEDTLS_DHM_RFC3526_MODP_3072_P_BIN;
+
+typedef struct {
+    uint32_t id;
+    const char *username;
+    const char *password;
+    uint8_t salt[SEC2_SALT_LEN];
+    uint8_t verifier[SEC2_PUBLIC_KEY_LEN];
+    size_t verifier_len;
+    uint8_t client_pubkey[SEC2_PUBLIC_KEY_LEN];
+    uint8_t session_key[SEC2_HASH_LEN];
+    uint8_t client_proof[SEC2_HASH_LEN];
+    uint8_t device_proof[SEC2_HASH_LEN];
+    uint8_t iv[SEC2_IV_LEN];
+
+    mbedtls_mpi N, g, a, A;
+    mbedtls_gcm_context ctx_gcm;
+} session2_t;
+
+/* H(PAD(a) | PAD(b)), both padded to the length of N */
+static int sec2_hash_padded(const mbedtls_mpi *a, const mbedtls_mpi *b, mbedtls_mpi *out)
+{
+    uint8_t buf[SEC2_PUBLIC_KEY_LEN], digest[SEC2_HASH_LEN];
+    mbedtls_sha512_context ctx;
+    int ret;
+
+    mbedtls_sha512_init(&ctx);
+    MBEDTLS_MPI_CHK(mbedtls_sha512_starts(&ctx, 0));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(a, buf, sizeof(buf)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, buf, sizeof(buf)));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(b, buf, sizeof(buf)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, buf, sizeof(buf)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_finish(&ctx, digest));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(out, digest, sizeof(digest)));
+cleanup:
+    mbedtls_sha512_free(&ctx);
+    return ret;
+}
+
+/* x = H(salt | H(username ":" password)) */
+static int sec2_calculate_x(session2_t *session, mbedtls_mpi *x)
+{
+    uint8_t digest[SEC2_HASH_LEN];
+    mbedtls_sha512_context ctx;
+    int ret;
+
+    mbedtls_sha512_init(&ctx);
+    MBEDTLS_MPI_CHK(mbedtls_sha512_starts(&ctx, 0));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, (const uint8_t *) session->username, strlen(session->username)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, (const uint8_t *) ":", 1));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, (const uint8_t *) session->password, strlen(session->password)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_finish(&ctx, digest));
+
+    MBEDTLS_MPI_CHK(mbedtls_sha512_starts(&ctx, 0));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->salt, sizeof(session->salt)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, digest, sizeof(digest)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_finish(&ctx, digest));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(x, digest, sizeof(digest)));
+cleanup:
+    mbedtls_sha512_free(&ctx);
+    return ret;
+}
+
+/* Generates the salt and verifier given to the device, and the client key pair */
+static int sec2_client_init(session2_t *session)
+{
+    uint8_t a[32];
+    mbedtls_mpi x, v;
+    int ret;
+
+    mbedtls_mpi_init(&x);
+    mbedtls_mpi_init(&v);
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&session->N, sec2_N, sizeof(sec2_N)));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_lset(&session->g, 5));
+
+    /* v = g^x mod N */
+    getrandom(session->salt, sizeof(session->salt), 0);
+    MBEDTLS_MPI_CHK(sec2_calculate_x(session, &x));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_exp_mod(&v, &session->g, &x, &session->N, NULL));
+    session->verifier_len = mbedtls_mpi_size(&v);
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&v, session->verifier, session->verifier_len));
+
+    /* A = g^a mod N */
+    getrandom(a, sizeof(a), 0);
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&session->a, a, sizeof(a)));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_exp_mod(&session->A, &session->g, &session->a, &session->N, NULL));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&session->A, session->client_pubkey, sizeof(session->client_pubkey)));
+cleanup:
+    mbedtls_mpi_free(&x);
+    mbedtls_mpi_free(&v);
+    return ret;
+}
+
+/* Computes the session key, the client proof and the expected device proof from the device public key */
+static int sec2_client_proofs(session2_t *session, const uint8_t *device_pubkey, size_t device_pubkey_len)
+{
+    uint8_t buf[SEC2_PUBLIC_KEY_LEN], hash_n[SEC2_HASH_LEN], hash_g[SEC2_HASH_LEN], hash_i[SEC2_HASH_LEN];
+    mbedtls_mpi B, k, u, x, t, e, S;
+    mbedtls_sha512_context ctx;
+    int ret;
+
+    mbedtls_mpi_init(&B);
+    mbedtls_mpi_init(&k);
+    mbedtls_mpi_init(&u);
+    mbedtls_mpi_init(&x);
+    mbedtls_mpi_init(&t);
+    mbedtls_mpi_init(&e);
+    mbedtls_mpi_init(&S);
+    mbedtls_sha512_init(&ctx);
+
+    MBEDTLS_MPI_CHK(mbedtls_mpi_read_binary(&B, device_pubkey, device_pubkey_len));
+    MBEDTLS_MPI_CHK(sec2_hash_padded(&session->N, &session->g, &k));
+    MBEDTLS_MPI_CHK(sec2_hash_padded(&session->A, &B, &u));
+    MBEDTLS_MPI_CHK(sec2_calculate_x(session, &x));
+
+    /* S = (B - k * g^x) ^ (a + u * x) mod N */
+    MBEDTLS_MPI_CHK(mbedtls_mpi_exp_mod(&t, &session->g, &x, &session->N, NULL));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&t, &t, &k));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_sub_mpi(&t, &B, &t));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mod_mpi(&t, &t, &session->N));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_mul_mpi(&e, &u, &x));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_add_mpi(&e, &e, &session->a));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_exp_mod(&S, &t, &e, &session->N, NULL));
+
+    /* K = H(S) */
+    size_t len_S = mbedtls_mpi_size(&S);
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&S, buf, len_S));
+    MBEDTLS_MPI_CHK(mbedtls_sha512(buf, len_S, session->session_key, 0));
+
+    /* M = H(H(N) xor H(PAD(g)) | H(username) | salt | A | B | K) */
+    MBEDTLS_MPI_CHK(mbedtls_sha512(sec2_N, sizeof(sec2_N), hash_n, 0));
+    MBEDTLS_MPI_CHK(mbedtls_mpi_write_binary(&session->g, buf, sizeof(buf)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512(buf, sizeof(buf), hash_g, 0));
+    MBEDTLS_MPI_CHK(mbedtls_sha512((const uint8_t *) session->username, strlen(session->username), hash_i, 0));
+    for (int i = 0; i < SEC2_HASH_LEN; i++) {
+        hash_n[i] ^= hash_g[i];
+    }
+    MBEDTLS_MPI_CHK(mbedtls_sha512_starts(&ctx, 0));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, hash_n, sizeof(hash_n)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, hash_i, sizeof(hash_i)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->salt, sizeof(session->salt)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->client_pubkey, sizeof(session->client_pubkey)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, device_pubkey, device_pubkey_len));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->session_key, sizeof(session->session_key)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_finish(&ctx, session->client_proof));
+
+    /* Device proof = H(A | M | K) */
+    MBEDTLS_MPI_CHK(mbedtls_sha512_starts(&ctx, 0));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->client_pubkey, sizeof(session->client_pubkey)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->client_proof, sizeof(session->client_proof)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_update(&ctx, session->session_key, sizeof(session->session_key)));
+    MBEDTLS_MPI_CHK(mbedtls_sha512_finish(&ctx, session->device_proof));
+cleanup:
+    mbedtls_mpi_free(&B);
+    mbedtls_mpi_free(&k);
+    mbedtls_mpi_free(&u);
+    mbedtls_mpi_free(&x);
+    mbedtls_mpi_free(&t);
+    mbedtls_mpi_free(&e);
+    mbedtls_mpi_free(&S);
+    mbedtls_sha512_free(&ctx);
+    return ret;
+}
+
+/* Sends a message of the security 2 handshake to the security endpoint */
+static SessionData *sec2_transaction(session2_t *session, Sec2Payload *payload)
+{
+    SessionData req;
+    session_data__init(&req);
+    req.sec_ver = SEC_SCHEME_VERSION__SecScheme2;
+    req.proto_case = SESSION_DATA__PROTO_SEC2;
+    req.sec2 = payload;
+
+    ssize_t inlen = session_data__get_packed_size(&req);
+    uint8_t *inbuf = (uint8_t *) malloc(inlen);
+    if (!inbuf) {
+        ESP_LOGE(TAG, "Failed to allocate inbuf");
+        return NULL;
+    }
+    session_data__pack(&req, inbuf);
+
+    uint8_t *outbuf = NULL;
+    ssize_t outlen = 0;
+    esp_err_t ret = protocomm_req_handle(test_pc, "test-sec", session->id, inbuf, inlen, &outbuf, &outlen);
+    free(inbuf);
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "test-sec handler failed");
+        free(outbuf);
+        return NULL;
+    }
+
+    SessionData *resp = session_data__unpack(NULL, outlen, outbuf);
+    free(outbuf);
+    if (!resp || resp->proto_case != SESSION_DATA__PROTO_SEC2) {
+        ESP_LOGE(TAG, "Invalid response type");
+        if (resp) {
+            session_data__free_unpacked(resp, NULL);
+        }
+        return NULL;
+    }
+    return resp;
+}
+
+static esp_err_t test_sec2_endpoint(session2_t *session)
+{
+    /*********** Transaction0 = S2SessionCmd0 + S2SessionResp0 ****************/
+    Sec2Payload payload;
+    S2SessionCmd0 cmd0;
+    sec2_payload__init(&payload);
+    s2_session_cmd0__init(&cmd0);
+    cmd0.client_username.data = (uint8_t *) session->username;
+    cmd0.client_username.len = strlen(session->username);
+    cmd0.client_pubkey.data = session->client_pubkey;
+    cmd0.client_pubkey.len = sizeof(session->client_pubkey);
+    payload.msg = SEC2_MSG_TYPE__S2Session_Command0;
+    payload.payload_case = SEC2_PAYLOAD__PAYLOAD_SC0;
+    payload.sc0 = &cmd0;
+
+    SessionData *resp = sec2_transaction(session, &payload);
+    if (!resp) {
+        return ESP_FAIL;
+    }
+    S2SessionResp0 *resp0 = resp->sec2->sr0;
+    if (resp->sec2->msg != SEC2_MSG_TYPE__S2Session_Response0 || resp0->status != STATUS__Success ||
+            resp0->device_pubkey.len > SEC2_PUBLIC_KEY_LEN ||
+            resp0->device_salt.len != sizeof(session->salt) ||
+            memcmp(resp0->device_salt.data, session->salt, sizeof(session->salt))) {
+        ESP_LOGE(TAG, "Invalid response 0");
+        session_data__free_unpacked(resp, NULL);
+        return ESP_FAIL;
+    }
+    int ret = sec2_client_proofs(session, resp0->device_pubkey.data, resp0->device_pubkey.len);
+    session_data__free_unpacked(resp, NULL);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed to compute the proofs with error code : %d", ret);
+        return ESP_FAIL;
+    }
+
+    /*********** Transaction1 = S2SessionCmd1 + S2SessionResp1 ****************/
+    S2SessionCmd1 cmd1;
+    sec2_payload__init(&payload);
+    s2_session_cmd1__init(&cmd1);
+    cmd1.client_proof.data = session->client_proof;
+    cmd1.client_proof.len = sizeof(session->client_proof);
+    payload.msg = SEC2_MSG_TYPE__S2Session_Command1;
+    payload.payload_case = SEC2_PAYLOAD__PAYLOAD_SC1;
+    payload.sc1 = &cmd1;
+
+    resp = sec2_transaction(session, &payload);
+    if (!resp) {
+        return ESP_FAIL;
+    }
+    S2SessionResp1 *resp1 = resp->sec2->sr1;
+    if (resp->sec2->msg != SEC2_MSG_TYPE__S2Session_Response1 || resp1->status != STATUS__Success ||
+            resp1->device_proof.len != sizeof(session->device_proof) ||
+            memcmp(resp1->device_proof.data, session->device_proof, sizeof(session->device_proof)) ||
+            resp1->device_nonce.len != sizeof(session->iv)) {
+        ESP_LOGE(TAG, "Invalid response 1");
+        session_data__free_unpacked(resp, NULL);
+        return ESP_FAIL;
+    }
+    memcpy(session->iv, resp1->device_nonce.data, sizeof(session->iv));
+    session_data__free_unpacked(resp, NULL);
+
+    ret = mbedtls_gcm_setkey(&session->ctx_gcm, MBEDTLS_CIPHER_ID_AES, session->session_key, SEC2_AES_KEY_BITS);
+    if (ret != 0) {
+        ESP_LOGE(TAG, "Failed at mbedtls_gcm_setkey with error code : %d", ret);
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+/* The IV ends with a big endian counter, incremented after each message in either direction */
+static void sec2_iv_increment(uint8_t *iv)
+{
+    for (int i = SEC2_IV_LEN - 1; i >= SEC2_IV_LEN - 4; i--) {
+        if (++iv[i] != 0) {
+            break;
+        }
+    }
+}
+
+/* Encrypts len bytes of data to out, followed by the tag */
+static int sec2_encrypt(session2_t *session, const uint8_t *data, size_t len, uint8_t *out)
+{
+    int ret = mbedtls_gcm_crypt_and_tag(&session->ctx_gcm, MBEDTLS_GCM_ENCRYPT, len, session->iv, SEC2_IV_LEN,
+                                        NULL, 0, data, out, SEC2_TAG_LEN, out + len);
+    sec2_iv_increment(session->iv);
+    return ret;
+}
+
+/* Decrypts len bytes of data ending with the tag to out */
+static int sec2_decrypt(session2_t *session, const uint8_t *data, size_t len, uint8_t *out)
+{
+    int ret = mbedtls_gcm_auth_decrypt(&session->ctx_gcm, len - SEC2_TAG_LEN, session->iv, SEC2_IV_LEN,
+                                       NULL, 0, data + len - SEC2_TAG_LEN, SEC2_TAG_LEN, data, out);
+    sec2_iv_increment(session->iv);
+    return ret;
+}
+
+static esp_err_t test_security2_requests(session2_t *session, int count)
+{
+    uint8_t req_data[128], req_buf[128 + SEC2_TAG_LEN], resp_data[128];
+    unsigned heap_before = 0;
+    int64_t elapsed[2] = { 0 };
+
+    for (int i = 0; i < count; i++) {
+        getrandom(req_data, sizeof(req_data), 0);
+        if (sec2_encrypt(session, req_data, sizeof(req_data), req_buf) != 0) {
+            ESP_LOGE(TAG, "Failed to encrypt request %d", i);
+            return ESP_FAIL;
+        }
+
+        uint8_t *enc_resp = NULL;
+        ssize_t enc_resp_len = 0;
+        esp_err_t ret;
+        int64_t start = esp_timer_get_time();
+        /* Alternate between the request being copied and decrypted in place */
+        if (i % 2) {
+            ret = protocomm_req_handle_inplace(test_pc, "test-ep", session->id,
+                                               req_buf, sizeof(req_buf), &enc_resp, &enc_resp_len);
+        } else {
+            ret = protocomm_req_handle(test_pc, "test-ep", session->id,
+                                       req_buf, sizeof(req_buf), &enc_resp, &enc_resp_len);
+        }
+        elapsed[i % 2] += esp_timer_get_time() - start;
+
+        /* The echoed response is followed by its tag, added in the buffer of the handler */
+        if (ret != ESP_OK || enc_resp_len != sizeof(req_buf)) {
+            ESP_LOGE(TAG, "test-ep handler failed for request %d", i);
+            free(enc_resp);
+            return ESP_FAIL;
+        }
+        int dec_ret = sec2_decrypt(session, enc_resp, enc_resp_len, resp_data);
+        free(enc_resp);
+
+        if (dec_ret != 0 || memcmp(req_data, resp_data, sizeof(req_data))) {
+            ESP_LOGE(TAG, "incorrect response data from test-ep for request %d", i);
+            return ESP_FAIL;
+        }
+        if (i == 1) {
+            /* The buffers kept between requests are allocated by now */
+            heap_before = esp_get_free_heap_size();
+            test_alloc_count_start();
+        }
+    }
+
+    test_alloc_count_stop(count - 2);
+    ESP_LOGI(TAG, "%d requests, %lld requests/s copied, %lld requests/s in place", count,
+             elapsed[0] ? (count / 2) * 1000000LL / elapsed[0] : 0,
+             elapsed[1] ? (count / 2) * 1000000LL / elapsed[1] : 0);
+
+    if (esp_get_free_heap_size() != heap_before) {
+        ESP_LOGE(TAG, "Free heap size changed by %d bytes while handling the requests",
+                 (int) (esp_get_free_heap_size() - heap_before));
+        return ESP_FAIL;
+    }
+
+    return ESP_OK;
+}
+
+static esp_err_t test_security2_wrong_tag(session2_t *session)
+{
+    uint8_t req_data[128], req_buf[128 + SEC2_TAG_LEN], resp_data[128];
+    uint8_t iv[SEC2_IV_LEN];
+
+    getrandom(req_data, sizeof(req_data), 0);
+    memcpy(iv, session->iv, sizeof(iv));
+    if (sec2_encrypt(session, req_data, sizeof(req_data), req_buf) != 0) {
+        ESP_LOGE(TAG, "Failed to encrypt request");
+        return ESP_FAIL;
+    }
+
+    /* A request with a wrong tag is rejected */
+    uint8_t *enc_resp = NULL;
+    ssize_t enc_resp_len = 0;
+    req_buf[sizeof(req_buf) - 1] ^= 0x01;
+    if (protocomm_req_handle(test_pc, "test-ep", session->id, req_buf, sizeof(req_buf),
+                             &enc_resp, &enc_resp_len) == ESP_OK || enc_resp) {
+        ESP_LOGE(TAG, "Request with a wrong tag was accepted");
+        free(enc_resp);
+        return ESP_FAIL;
+    }
+
+    /* It does not use up a value of the counter: the same request with the right tag is accepted */
+    memcpy(session->iv, iv, sizeof(iv));
+    sec2_iv_increment(session->iv);
+    req_buf[sizeof(req_buf) - 1] ^= 0x01;
+    if (protocomm_req_handle(test_pc, "test-ep", session->id, req_buf, sizeof(req_buf),
+                             &enc_resp, &enc_resp_len) != ESP_OK || enc_resp_len != sizeof(req_buf)) {
+        ESP_LOGE(TAG, "Request with the right tag was rejected");
+        free(enc_resp);
+        return ESP_FAIL;
+    }
+    int ret = sec2_decrypt(session, enc_resp, enc_resp_len, resp_data);
+    free(enc_resp);
+    if (ret != 0 || memcmp(req_data, resp_data, sizeof(req_data))) {
+        ESP_LOGE(TAG, "incorrect response data from test-ep");
+        return ESP_FAIL;
+    }
+    return ESP_OK;
+}
+
+static esp_err_t test_security2_many_requests (void)
+{
+    ESP_LOGI(TAG, "Starting Security 2 many requests test");
+
+    session2_t *session = calloc(1, sizeof(session2_t));
+    if (session == NULL) {
+        ESP_LOGE(TAG, "Error allocating session");
+        return ESP_ERR_NO_MEM;
+    }
+
+    session->id       = 10;
+    session->username = "wifiprov";
+    session->password = "abcd1234";
+    mbedtls_mpi_init(&session->N);
+    mbedtls_mpi_init(&session->g);
+    mbedtls_mpi_init(&session->a);
+    mbedtls_mpi_init(&session->A);
+    mbedtls_gcm_init(&session->ctx_gcm);
+
+    esp_err_t ret = ESP_FAIL;
+    int mbed_err = sec2_client_init(session);
+    if (mbed_err != 0) {
+        ESP_LOGE(TAG, "Failed to generate the client keys with error code : %d", mbed_err);
+        goto exit;
+    }
+
+    protocomm_security2_params_t params = {
+        .salt = (const char *) session->salt,
+        .salt_len = sizeof(session->salt),
+        .verifier = (const char *) session->verifier,
+        .verifier_len = session->verifier_len,
+    };
+
+    // Start protocomm service
+    if (start_test_service(2, &params) != ESP_OK) {
+        ESP_LOGE(TAG, "Error starting test");
+        goto stop;
+    }
+
+    if (protocomm_open_session(test_pc, session->id) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open new protocomm session");
+        goto stop;
+    }
+
+    // Perform SRP6a handshake to set the session key
+    if (test_sec2_endpoint(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error testing security endpoint");
+        goto stop;
+    }
+
+    // Send many requests, the counter of the AES-GCM IV
+    // must stay in sync and no memory must be lost
+    if (test_security2_requests(session, 1000) != ESP_OK) {
+        ESP_LOGE(TAG, "Error sending many requests");
+        goto stop;
+    }
+
+    // A request with a wrong tag must be rejected without
+    // putting the session out of sync
+    if (test_security2_wrong_tag(session) != ESP_OK) {
+        ESP_LOGE(TAG, "Error sending a request with a wrong tag");
+        goto stop;
+    }
+
+    ESP_LOGI(TAG, "Protocomm test successful");
+    ret = ESP_OK;
+stop:
+    stop_test_service();
+exit:
+    mbedtls_gcm_free(&session->ctx_gcm);
+    mbedtls_mpi_free(&session->N);
+    mbedtls_mpi_free(&session->g);
+    mbedtls_mpi_free(&session->a);
+    mbedtls_mpi_free(&session->A);
+    free(session);
+    return ret;
+}
+
 static esp_err_t test_security1_session_overflow (void)
 {
     ESP_LOGI(TAG, "Starting Security 1 session overflow test");
@@ -1144,6 +1782,7 @@ TEST_CASE("leak test", "[PROTOCOMM]")
     test_security1_wrong_pop();
     test_security1_insecure_client();
     test_security1_weak_session();
+    test_security1_many_requests();
 
     usleep(1000);
 
@@ -1191,6 +1830,16 @@ TEST_CASE("security 1 weak session test", "[PROTOCOMM]")
     TEST_ASSERT(test_security1_weak_session() == ESP_OK);
 }
 
+TEST_CASE("security 1 many requests test", "[PROTOCOMM]")
+{
+    TEST_ASSERT(test_security1_many_requests() == ESP_OK);
+}
+
+TEST_CASE("security 2 many requests test", "[PROTOCOMM]")
+{
+    TEST_ASSERT(test_security2_many_requests() == ESP_OK);
+}
+
 void app_main(void)
 {
     unity_run_menu();
@@ -18,11 +18,15 @@
 #include <sys/errno.h>
 #include <sys/fcntl.h>
 #include <sys/lock.h>
+#include <sys/param.h>
 #include "esp_vfs.h"
 #include "esp_err.h"
 #include "esp_rom_spiflash.h"
 
 #include "spiffs_api.h"
+#if CONFIG_SPIFFS_RAM_INDEX
+#include "spiffs_ram_index.h"
+#endif
 
 static const char* TAG = "SPIFFS";
 
@@ -83,6 +87,88 @@ static time_t vfs_spiffs_get_mtime(const spiffs_stat* s);
 
 static esp_spiffs_t * _efs[CONFIG_SPIFFS_MAX_PARTITIONS];
 
+typedef struct esp_spiffs_bg_gc_t {
+    esp_spiffs_bg_gc_config_t config;
+    TaskHandle_t task;
+    SemaphoreHandle_t done;     /* given by the task when it exits */
+    volatile bool stop;
+} esp_spiffs_bg_gc_t;
+
+static void esp_spiffs_bg_gc_task(void *arg)
+{
+    esp_spiffs_t *efs = (esp_spiffs_t *) arg;
+    esp_spiffs_bg_gc_t *gc = efs->bg_gc;
+    const TickType_t idle_ticks = MAX(pdMS_TO_TICKS(gc->config.idle_time_ms), 1);
+    TickType_t wait = idle_ticks;
+    uint32_t lock_count = efs->lock_count;
+
+    while (!gc->stop) {
+        ulTaskNotifyTake(pdTRUE, wait);
+        if (gc->stop) {
+            break;
+        }
+        wait = idle_ticks;
+        if (efs->lock_count != lock_count) {
+            // Partition was accessed, wait for another idle period
+            lock_count = efs->lock_count;
+            continue;
+        }
+        if (!SPIFFS_mounted(efs->fs)) {
+            // A failed format left the partition unmounted
+            continue;
+        }
+        s32_t res = SPIFFS_gc_step(efs->fs, gc->config.min_free_blocks);
+        // SPIFFS_gc_step takes the lock once
+        lock_count++;
+        if (res < 0) {
+            ESP_LOGW(TAG, "background GC step failed, %" PRId32, res);
+            SPIFFS_clearerr(efs->fs);
+        } else if (res > 0) {
+            // A block was reclaimed, continue right away unless the partition gets accessed
+            wait = 1;
+        }
+    }
+    xSemaphoreGive(gc->done);
+    vTaskDelete(NULL);
+}
+
+static esp_err_t esp_spiffs_bg_gc_create(esp_spiffs_t *efs, const esp_spiffs_bg_gc_config_t *config)
+{
+    esp_spiffs_bg_gc_t *gc = calloc(1, sizeof(esp_spiffs_bg_gc_t));
+    if (gc == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    gc->config = *config;
+    gc->done = xSemaphoreCreateBinary();
+    if (gc->done == NULL) {
+        free(gc);
+        return ESP_ERR_NO_MEM;
+    }
+    efs->bg_gc = gc;
+    if (xTaskCreate(esp_spiffs_bg_gc_task, "spiffs_gc", config->task_stack_size, efs,
+                    config->task_priority, &gc->task) != pdPASS) {
+        efs->bg_gc = NULL;
+        vSemaphoreDelete(gc->done);
+        free(gc);
+        return ESP_ERR_NO_MEM;
+    }
+    return ESP_OK;
+}
+
+static void esp_spiffs_bg_gc_delete(esp_spiffs_t *efs)
+{
+    esp_spiffs_bg_gc_t *gc = efs->bg_gc;
+    if (gc == NULL) {
+        return;
+    }
+    gc->stop = true;
+    xTaskNotifyGive(gc->task);
+    xSemaphoreTake(gc->done, portMAX_DELAY);
+    efs->bg_gc = NULL;
+    vSemaphoreDelete(gc->done);
+    free(gc);
+}
+
 static void esp_spiffs_free(esp_spiffs_t ** efs)
 {
     esp_spiffs_t * e = *efs;
@@ -91,7 +177,11 @@ static void esp_spiffs_free(esp_spiffs_t ** efs)
     }
     *efs = NULL;
 
+    esp_spiffs_bg_gc_delete(e);
     if (e->fs) {
+#if CONFIG_SPIFFS_RAM_INDEX
+        spiffs_ram_index_deinit(e->fs);
+#endif
         SPIFFS_unmount(e->fs);
         free(e->fs);
     }
@@ -286,6 +376,14 @@ static esp_err_t esp_spiffs_init(const esp_vfs_spiffs_conf_t* conf)
         esp_spiffs_free(&efs);
         return ESP_FAIL;
     }
+#if CONFIG_SPIFFS_RAM_INDEX
+    esp_err_t err = spiffs_ram_index_init(efs->fs);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "RAM index could not be built (0x%x)", err);
+        esp_spiffs_free(&efs);
+        return err;
+    }
+#endif
     _efs[index] = efs;
     return ESP_OK;
 }
@@ -320,8 +418,17 @@ esp_err_t esp_spiffs_check(const char* partition_label)
         ESP_LOGE(TAG, "SPIFFS_check failed (%d)", spiffs_res);
         errno = spiffs_res_to_errno(SPIFFS_errno(_efs[index]->fs));
         SPIFFS_clearerr(_efs[index]->fs);
+#if CONFIG_SPIFFS_RAM_INDEX
+        spiffs_ram_index_rebuild(_efs[index]->fs);
+#endif
         return ESP_FAIL;
     }
+#if CONFIG_SPIFFS_RAM_INDEX
+    // SPIFFS_check may relocate object index headers without reporting it
+    if (spiffs_ram_index_rebuild(_efs[index]->fs) != ESP_OK) {
+        return ESP_FAIL;
+    }
+#endif
     return ESP_OK;
 }
 
@@ -350,6 +457,16 @@ esp_err_t esp_spiffs_format(const char* partition_label)
         partition_was_mounted = true;
     }
 
+    esp_spiffs_bg_gc_config_t bg_gc_config;
+    bool bg_gc_was_running = _efs[index]->bg_gc != NULL;
+    if (bg_gc_was_running) {
+        bg_gc_config = _efs[index]->bg_gc->config;
+        esp_spiffs_bg_gc_delete(_efs[index]);
+    }
+
+#if CONFIG_SPIFFS_RAM_INDEX
+    spiffs_ram_index_deinit(_efs[index]->fs);
+#endif
     SPIFFS_unmount(_efs[index]->fs);
 
     s32_t res = SPIFFS_format(_efs[index]->fs);
@@ -363,7 +480,8 @@ esp_err_t esp_spiffs_format(const char* partition_label)
         if (!partition_was_mounted) {
             esp_spiffs_free(&_efs[index]);
         }
-        return ESP_FAIL;
+        err = ESP_FAIL;
+        goto restart_bg_gc;
     }
 
     if (partition_was_mounted) {
@@ -373,12 +491,26 @@ esp_err_t esp_spiffs_format(const char* partition_label)
         if (res != SPIFFS_OK) {
             ESP_LOGE(TAG, "mount failed, %" PRId32, SPIFFS_errno(_efs[index]->fs));
             SPIFFS_clearerr(_efs[index]->fs);
-            return ESP_FAIL;
+            err = ESP_FAIL;
+            goto restart_bg_gc;
         }
+#if CONFIG_SPIFFS_RAM_INDEX
+        err = spiffs_ram_index_init(_efs[index]->fs);
+#endif
     } else {
         esp_spiffs_free(&_efs[index]);
     }
-    return ESP_OK;
+
+restart_bg_gc:
+    /* The GC task is kept for the partition whatever the result of the format,
+     * it does nothing while the partition is not mounted */
+    if (bg_gc_was_running && _efs[index] != NULL) {
+        esp_err_t gc_err = esp_spiffs_bg_gc_create(_efs[index], &bg_gc_config);
+        if (err == ESP_OK) {
+            err = gc_err;
+        }
+    }
+    return err;
 }
 
 esp_err_t esp_spiffs_gc(const char* partition_label, size_t size_to_gc)
@@ -399,6 +531,34 @@ esp_err_t esp_spiffs_gc(const char* partition_label, size_t size_to_gc)
     return ESP_OK;
 }
 
+esp_err_t esp_spiffs_bg_gc_start(const char* partition_label, const esp_spiffs_bg_gc_config_t *config)
+{
+    if (config == NULL) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    int index;
+    if (esp_spiffs_by_label(partition_label, &index) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (_efs[index]->bg_gc != NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    return esp_spiffs_bg_gc_create(_efs[index], config);
+}
+
+esp_err_t esp_spiffs_bg_gc_stop(const char* partition_label)
+{
+    int index;
+    if (esp_spiffs_by_label(partition_label, &index) != ESP_OK) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (_efs[index]->bg_gc == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_spiffs_bg_gc_delete(_efs[index]);
+    return ESP_OK;
+}
+
 #ifdef CONFIG_VFS_SUPPORT_DIR
 static const esp_vfs_dir_ops_t s_vfs_spiffs_dir = {
     .stat_p = &vfs_spiffs_stat,
@@ -6,6 +6,7 @@
 #include <stdio.h>
 #include <string.h>
 #include <stdint.h>
+#include <inttypes.h>
 #include <stdlib.h>
 #include <sys/mman.h>
 #include <sys/stat.h>
@@ -13,13 +14,18 @@
 #include <dirent.h>
 #include <limits.h>
 #include <unistd.h>
+#include <time.h>
 
 #include "Mockqueue.h"
 
 #include "esp_partition.h"
+#include "esp_private/partition_linux.h"
 #include "spiffs.h"
 #include "spiffs_nucleus.h"
 #include "spiffs_api.h"
+#if CONFIG_SPIFFS_RAM_INDEX
+#include "spiffs_ram_index.h"
+#endif
 
 #include "unity.h"
 #include "unity_fixture.h"
@@ -95,6 +101,9 @@ static void init_spiffs(spiffs *fs, uint32_t max_files)
 
 static void deinit_spiffs(spiffs *fs)
 {
+#if CONFIG_SPIFFS_RAM_INDEX
+    spiffs_ram_index_deinit(fs);
+#endif
     SPIFFS_unmount(fs);
 
     free(fs->work);
@@ -310,11 +319,326 @@ TEST(spiffs, erase_check)
 #endif
 }
 
+#if !CONFIG_ESP_PARTITION_ERASE_CHECK
+// The tests below run longer workloads, SPIFFS writes to pages which are not erased
+// and so these only work with the erase check of the emulator disabled
+
+static void erase_storage_partition(void)
+{
+    const esp_partition_t *partition = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, ESP_PARTITION_SUBTYPE_DATA_SPIFFS, "storage");
+    TEST_ASSERT_NOT_NULL(partition);
+    TEST_ESP_OK(esp_partition_erase_range(partition, 0, partition->size));
+}
+
+static int compare_size_t(const void *a, const void *b)
+{
+    size_t x = *(const size_t *) a;
+    size_t y = *(const size_t *) b;
+    return (x > y) - (x < y);
+}
+
+/* Overwrites files of a partially filled filesystem and records the emulated flash time
+ * of every write. With bg_gc_min_free_blocks > 0, SPIFFS_gc_step is run after every few
+ * writes, the same way the background GC task does when the filesystem is idle.
+ */
+static void write_latency_run(size_t *latency_us, int write_count, uint32_t bg_gc_min_free_blocks, int *gc_steps)
+{
+    spiffs fs;
+    const int file_count = 60;
+    const int writes_per_burst = 4;
+    const int data_sz = 8192;
+    char *data = (char *) malloc(data_sz);
+    TEST_ASSERT_NOT_NULL(data);
+
+    erase_storage_partition();
+    init_spiffs(&fs, 5);
+    srand(1);
+    *gc_steps = 0;
+    for (int i = 0; i < write_count; ++i) {
+        if (bg_gc_min_free_blocks > 0 && i % writes_per_burst == 0) {
+            s32_t res;
+            while ((res = SPIFFS_gc_step(&fs, bg_gc_min_free_blocks)) > 0) {
+                ++*gc_steps;
+            }
+            TEST_ASSERT_EQUAL(0, res);
+        }
+
+        char name[16];
+        snprintf(name, sizeof(name), "f%d", rand() % file_count);
+        memset(data, i & 0xff, data_sz);
+        esp_partition_clear_stats();
+        spiffs_file f = SPIFFS_open(&fs, name, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR, 0);
+        TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+        TEST_ASSERT_EQUAL(data_sz, SPIFFS_write(&fs, f, data, data_sz));
+        TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(&fs, f));
+        latency_us[i] = esp_partition_get_total_time();
+    }
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_check(&fs));
+
+    qsort(latency_us, write_count, sizeof(size_t), compare_size_t);
+    free(data);
+    deinit_spiffs(&fs);
+}
+
+TEST(spiffs, bg_gc_write_latency)
+{
+    const int write_count = 1000;
+    const uint32_t min_free_blocks = 16;
+    size_t *sync_us = (size_t *) calloc(write_count, sizeof(size_t));
+    size_t *bg_us = (size_t *) calloc(write_count, sizeof(size_t));
+    TEST_ASSERT_NOT_NULL(sync_us);
+    TEST_ASSERT_NOT_NULL(bg_us);
+    int sync_steps, bg_steps;
+
+    write_latency_run(sync_us, write_count, 0, &sync_steps);
+    write_latency_run(bg_us, write_count, min_free_blocks, &bg_steps);
+
+    printf("SPIFFS write latency, emulated flash time [us], %d writes\n", write_count);
+    printf("%-24s %10s %10s %10s %10s\n", "", "p50", "p90", "p99", "max");
+    printf("%-24s %10zu %10zu %10zu %10zu\n", "synchronous GC",
+           sync_us[write_count / 2], sync_us[write_count * 9 / 10], sync_us[write_count * 99 / 100], sync_us[write_count - 1]);
+    printf("%-24s %10zu %10zu %10zu %10zu\n", "idle GC steps",
+           bg_us[write_count / 2], bg_us[write_count * 9 / 10], bg_us[write_count * 99 / 100], bg_us[write_count - 1]);
+    printf("%d GC steps while idle\n", bg_steps);
+
+    TEST_ASSERT_GREATER_THAN(0, bg_steps);
+    TEST_ASSERT_LESS_THAN(sync_us[write_count * 99 / 100], bg_us[write_count * 99 / 100]);
+
+    free(sync_us);
+    free(bg_us);
+}
+
+#if CONFIG_SPIFFS_RAM_INDEX
+static uint64_t time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t) ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+static void check_ram_index_matches_flash(spiffs *fs)
+{
+    esp_spiffs_t *efs = (esp_spiffs_t *) fs->user_data;
+    spiffs_ram_index_t *idx = efs->ram_index;
+    TEST_ASSERT_NOT_NULL(idx);
+    TEST_ASSERT_TRUE(idx->valid);
+
+    spiffs_obj_id *lu = (spiffs_obj_id *) malloc(idx->lu_bytes_per_block);
+    TEST_ASSERT_NOT_NULL(lu);
+    for (uint32_t bix = 0; bix < fs->block_count; bix++) {
+        TEST_ESP_OK(esp_partition_read(efs->partition, bix * fs->cfg.log_block_size, lu, idx->lu_bytes_per_block));
+        TEST_ASSERT_EQUAL_MEMORY(lu, &idx->lu[bix * idx->entries_per_block], idx->lu_bytes_per_block);
+        for (uint32_t entry = 0; entry < idx->entries_per_block; entry++) {
+            uint32_t e = bix * idx->entries_per_block + entry;
+            bool is_free = (idx->free_map[e / 32] >> (e % 32)) & 1;
+            TEST_ASSERT_EQUAL(lu[entry] == SPIFFS_OBJ_ID_FREE, is_free);
+        }
+    }
+    free(lu);
+}
+
+TEST(spiffs, ram_index_consistent_after_gc)
+{
+    spiffs fs;
+    erase_storage_partition();
+    init_spiffs(&fs, 5);
+    TEST_ESP_OK(spiffs_ram_index_init(&fs));
+
+    // Rewrite a set of files many times over, so that the filesystem wraps around and
+    // garbage collection has to move pages and erase blocks
+    const int data_sz = 3000;
+    char *data = (char *) malloc(data_sz);
+    char *read = (char *) malloc(data_sz);
+    TEST_ASSERT_NOT_NULL(data);
+    TEST_ASSERT_NOT_NULL(read);
+    srand(0);
+    for (int iter = 0; iter < 3000; ++iter) {
+        char name[16];
+        snprintf(name, sizeof(name), "f%d", rand() % 64);
+        if (rand() % 4 == 0) {
+            SPIFFS_remove(&fs, name);
+            continue;
+        }
+        spiffs_file f = SPIFFS_open(&fs, name, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR, 0);
+        TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+        memset(data, iter & 0xff, data_sz);
+        TEST_ASSERT_EQUAL(data_sz, SPIFFS_write(&fs, f, data, data_sz));
+        TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(&fs, f));
+
+        f = SPIFFS_open(&fs, name, SPIFFS_RDONLY, 0);
+        TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+        TEST_ASSERT_EQUAL(data_sz, SPIFFS_read(&fs, f, read, data_sz));
+        TEST_ASSERT_EQUAL_MEMORY(data, read, data_sz);
+        TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(&fs, f));
+    }
+
+    check_ram_index_matches_flash(&fs);
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_check(&fs));
+
+    free(data);
+    free(read);
+    deinit_spiffs(&fs);
+}
+
+static void write_file(spiffs *fs, const char *name, spiffs_flags flags, const char *data, int len)
+{
+    spiffs_file f = SPIFFS_open(fs, name, flags | SPIFFS_WRONLY, 0);
+    TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+    TEST_ASSERT_EQUAL(len, SPIFFS_write(fs, f, (void *) data, len));
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(fs, f));
+}
+
+TEST(spiffs, ram_index_gc_deletes_stale_header)
+{
+    spiffs fs;
+    erase_storage_partition();
+    init_spiffs(&fs, 5);
+    TEST_ESP_OK(spiffs_ram_index_init(&fs));
+
+    // Rewrite the header of the file, the previous header pages are left deleted
+    const char data[] = "0123456789";
+    write_file(&fs, "rewritten", SPIFFS_CREAT | SPIFFS_TRUNC, data, sizeof(data));
+    for (int i = 0; i < 8; ++i) {
+        write_file(&fs, "rewritten", SPIFFS_APPEND, data, sizeof(data));
+    }
+    write_file(&fs, "other", SPIFFS_CREAT | SPIFFS_TRUNC, data, sizeof(data));
+
+    // Garbage collect the block holding the header, which moves the live pages out of it
+    spiffs_page_ix hdr_pix;
+    TEST_ASSERT_EQUAL(SPIFFS_OK, spiffs_ram_index_find_ix_hdr_by_name(&fs, (const u8_t *) "rewritten", &hdr_pix));
+    fs.cleaning = 1;
+    TEST_ASSERT_EQUAL(SPIFFS_OK, spiffs_gc_clean(&fs, SPIFFS_BLOCK_FOR_PAGE(&fs, hdr_pix)));
+    fs.cleaning = 0;
+    spiffs_page_ix moved_pix;
+    TEST_ASSERT_EQUAL(SPIFFS_OK, spiffs_ram_index_find_ix_hdr_by_name(&fs, (const u8_t *) "rewritten", &moved_pix));
+    TEST_ASSERT_NOT_EQUAL(hdr_pix, moved_pix);
+    hdr_pix = moved_pix;
+
+    spiffs_stat st;
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_stat(&fs, "rewritten", &st));
+
+    // GC wiping a stale header page of a live object reports it as deleted,
+    // which must not drop the object from the index
+    spiffs_cb_object_event(&fs, NULL, SPIFFS_EV_IX_DEL, st.obj_id | SPIFFS_OBJ_ID_IX_FLAG, 0, hdr_pix + 1, 0);
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_stat(&fs, "rewritten", &st));
+    TEST_ASSERT_EQUAL(9 * sizeof(data), st.size);
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_stat(&fs, "other", &st));
+
+    // Removing the file does drop it
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_remove(&fs, "rewritten"));
+    TEST_ASSERT_TRUE(SPIFFS_stat(&fs, "rewritten", &st) < SPIFFS_OK);
+
+    check_ram_index_matches_flash(&fs);
+    TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_check(&fs));
+    deinit_spiffs(&fs);
+}
+
+typedef struct {
+    uint64_t wall_us;
+    size_t read_ops;
+    size_t read_bytes;
+    size_t flash_time_us;
+} spiffs_bench_sample_t;
+
+static void bench_start(spiffs_bench_sample_t *sample)
+{
+    esp_partition_clear_stats();
+    sample->wall_us = time_us();
+}
+
+static void bench_stop(spiffs_bench_sample_t *sample)
+{
+    sample->wall_us = time_us() - sample->wall_us;
+    sample->read_ops = esp_partition_get_read_ops();
+    sample->read_bytes = esp_partition_get_read_bytes();
+    sample->flash_time_us = esp_partition_get_total_time();
+}
+
+static void bench_print(const char *what, const spiffs_bench_sample_t *sample, int divisor)
+{
+    printf("%-28s %10" PRIu64 " %10zu %12zu %14zu\n", what, sample->wall_us / divisor,
+           sample->read_ops / divisor, sample->read_bytes / divisor, sample->flash_time_us / divisor);
+}
+
+static void bench_open_all(spiffs *fs, int file_count, spiffs_bench_sample_t *sample)
+{
+    char name[16];
+    bench_start(sample);
+    for (int i = 0; i < file_count; ++i) {
+        snprintf(name, sizeof(name), "file%d", i);
+        spiffs_file f = SPIFFS_open(fs, name, SPIFFS_RDONLY, 0);
+        TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+        TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(fs, f));
+    }
+    // Opening a file which does not exist always has to look at every object
+    spiffs_file f = SPIFFS_open(fs, "missing", SPIFFS_RDONLY, 0);
+    TEST_ASSERT_TRUE(f < SPIFFS_OK);
+    bench_stop(sample);
+}
+
+TEST(spiffs, ram_index_mount_vs_open_latency)
+{
+    spiffs fs;
+    const int file_count = 256;
+    // Open all files with just 2 file descriptors, so that the temporal fd cache
+    // does not hide the cost of the lookup. A single one would leave no room for a
+    // cache page once SPIFFS aligns the cache buffer.
+    const int max_files = 2;
+
+    erase_storage_partition();
+    init_spiffs(&fs, max_files);
+    char name[16];
+    for (int i = 0; i < file_count; ++i) {
+        snprintf(name, sizeof(name), "file%d", i);
+        spiffs_file f = SPIFFS_open(&fs, name, SPIFFS_CREAT | SPIFFS_TRUNC | SPIFFS_RDWR, 0);
+        TEST_ASSERT_TRUE(f >= SPIFFS_OK);
+        TEST_ASSERT_EQUAL(sizeof(name), SPIFFS_write(&fs, f, name, sizeof(name)));
+        TEST_ASSERT_EQUAL(SPIFFS_OK, SPIFFS_close(&fs, f));
+    }
+    deinit_spiffs(&fs);
+
+    spiffs_bench_sample_t mount, index_build, open_scan, open_index;
+
+    bench_start(&mount);
+    init_spiffs(&fs, max_files);
+    bench_stop(&mount);
+
+    bench_open_all(&fs, file_count, &open_scan);
+
+    bench_start(&index_build);
+    TEST_ESP_OK(spiffs_ram_index_init(&fs));
+    bench_stop(&index_build);
+
+    bench_open_all(&fs, file_count, &open_index);
+
+    printf("SPIFFS RAM index, %d files, %zu bytes of index\n", file_count, spiffs_ram_index_mem_size(&fs));
+    printf("%-28s %10s %10s %12s %14s\n", "", "wall [us]", "reads", "read bytes", "flash [us]");
+    bench_print("mount", &mount, 1);
+    bench_print("mount: RAM index build", &index_build, 1);
+    bench_print("open, lookup scan (avg)", &open_scan, file_count + 1);
+    bench_print("open, RAM index (avg)", &open_index, file_count + 1);
+
+    TEST_ASSERT_LESS_THAN(open_scan.read_bytes, open_index.read_bytes);
+
+    check_ram_index_matches_flash(&fs);
+    deinit_spiffs(&fs);
+}
+#endif // CONFIG_SPIFFS_RAM_INDEX
+#endif // !CONFIG_ESP_PARTITION_ERASE_CHECK
+
 TEST_GROUP_RUNNER(spiffs)
 {
     RUN_TEST_CASE(spiffs, format_disk_open_file_write_and_read_file);
     RUN_TEST_CASE(spiffs, can_read_spiffs_image);
     RUN_TEST_CASE(spiffs, erase_check);
+#if !CONFIG_ESP_PARTITION_ERASE_CHECK
+    RUN_TEST_CASE(spiffs, bg_gc_write_latency);
+#if CONFIG_SPIFFS_RAM_INDEX
+    RUN_TEST_CASE(spiffs, ram_index_consistent_after_gc);
+    RUN_TEST_CASE(spiffs, ram_index_gc_deletes_stale_header);
+    RUN_TEST_CASE(spiffs, ram_index_mount_vs_open_latency);
+#endif
+#endif
 }
 
 static void run_all_tests(void)
@@ -8,6 +8,8 @@
 #define _ESP_SPIFFS_H_
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 #ifdef __cplusplus
@@ -124,6 +126,59 @@ esp_err_t esp_spiffs_check(const char* partition_label);
  */
 esp_err_t esp_spiffs_gc(const char* partition_label, size_t size_to_gc);
 
+/**
+ * @brief Configuration of the background garbage collection task
+ */
+typedef struct {
+    size_t min_free_blocks;         /*!< Blocks are reclaimed while fewer than this number of blocks are free. Synchronous GC during write starts at 3 free blocks. */
+    uint32_t idle_time_ms;          /*!< The partition must not be accessed for this long before a GC step is run. */
+    uint32_t task_stack_size;       /*!< Stack size of the GC task, in bytes */
+    unsigned task_priority;         /*!< Priority of the GC task */
+} esp_spiffs_bg_gc_config_t;
+
+#define ESP_SPIFFS_BG_GC_CONFIG_DEFAULT() { \
+    .min_free_blocks = 8, \
+    .idle_time_ms = 100, \
+    .task_stack_size = 3072, \
+    .task_priority = 1, \
+}
+
+/**
+ * @brief Start background garbage collection for a mounted SPIFFS partition
+ *
+ * Creates a task which, whenever the partition has not been accessed for
+ * config->idle_time_ms, reclaims blocks with deleted pages one at a time
+ * (see SPIFFS_gc_step), until config->min_free_blocks blocks are free.
+ * Each step holds the filesystem lock for the time needed to clean and
+ * erase one logical block, so a write never has to wait longer than that
+ * for the GC task. Keeping free blocks available this way lets writes
+ * avoid the synchronous GC.
+ *
+ * The task is stopped by esp_spiffs_bg_gc_stop or when the partition is
+ * unregistered.
+ *
+ * @param partition_label  Label of the partition, the partition must be already mounted.
+ * @param config           Configuration, use ESP_SPIFFS_BG_GC_CONFIG_DEFAULT() for defaults
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_ARG if config is NULL
+ *          - ESP_ERR_INVALID_STATE if the partition is not mounted or GC task is already running
+ *          - ESP_ERR_NO_MEM if the task could not be created
+ */
+esp_err_t esp_spiffs_bg_gc_start(const char* partition_label, const esp_spiffs_bg_gc_config_t *config);
+
+/**
+ * @brief Stop background garbage collection of a SPIFFS partition
+ *
+ * Waits until a GC step in progress, if any, is finished.
+ *
+ * @param partition_label  Same label as passed to esp_spiffs_bg_gc_start
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_STATE if the partition is not mounted or GC task is not running
+ */
+esp_err_t esp_spiffs_bg_gc_stop(const char* partition_label);
+
 #ifdef __cplusplus
 }
 #endif
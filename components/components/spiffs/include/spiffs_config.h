@@ -278,6 +278,17 @@ ESP_STATIC_ASSERT(SPIFFS_OBJ_META_LEN + SPIFFS_OBJ_NAME_LEN + SPIFFS_PAGE_EXTRA_
 // descriptor.
 #define SPIFFS_IX_MAP                           1
 
+// Enable this to keep a RAM copy of all object lookup entries, a free page
+// bitmap and an object id to object index header page table. Lookup pages are
+// then not read from flash when searching for objects, free pages or garbage
+// collection candidates. The index is built and attached by the port after
+// mounting, and is kept consistent by the port's HAL write and erase functions.
+#ifdef CONFIG_SPIFFS_RAM_INDEX
+#define SPIFFS_RAM_INDEX                        1
+#else
+#define SPIFFS_RAM_INDEX                        0
+#endif
+
 // Set SPIFFS_TEST_VISUALISATION to non-zero to enable SPIFFS_vis function
 // in the api. This function will visualize all filesystem using given printf
 // function.
@@ -320,4 +331,19 @@ typedef u16_t spiffs_obj_id;
 // i.e. (spiffs_file_system_size / log_page_size) - 1
 typedef u16_t spiffs_span_ix;
 
+#if SPIFFS_RAM_INDEX
+// RAM index queries, implemented in spiffs_ram_index.c.
+// These return SPIFFS_RAM_INDEX_MISS if no index is attached or if the index
+// cannot answer the query, in which case object lookup pages are scanned.
+extern spiffs_obj_id *spiffs_ram_index_lu_page(struct spiffs_t *fs, spiffs_block_ix bix, int obj_lookup_page);
+extern s32_t spiffs_ram_index_find_free(struct spiffs_t *fs, spiffs_block_ix starting_block, int starting_lu_entry,
+                                        spiffs_block_ix *block_ix, int *lu_entry);
+extern s32_t spiffs_ram_index_find_ix_hdr(struct spiffs_t *fs, spiffs_obj_id obj_id, spiffs_page_ix exclusion_pix,
+                                          spiffs_page_ix *pix);
+extern s32_t spiffs_ram_index_find_ix_hdr_by_name(struct spiffs_t *fs, const u8_t *name, spiffs_page_ix *pix);
+extern void spiffs_ram_index_set_ix_hdr(struct spiffs_t *fs, spiffs_obj_id obj_id, spiffs_page_ix pix);
+extern void spiffs_ram_index_del_ix_hdr(struct spiffs_t *fs, spiffs_obj_id obj_id, spiffs_page_ix pix);
+extern void spiffs_ram_index_set_name(struct spiffs_t *fs, spiffs_obj_id obj_id, const u8_t *name);
+#endif
+
 #endif /* SPIFFS_CONFIG_H_ */
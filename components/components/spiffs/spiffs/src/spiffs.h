@@ -683,6 +683,27 @@ s32_t SPIFFS_gc_quick(spiffs *fs, u16_t max_free_pages);
  */
 s32_t SPIFFS_gc(spiffs *fs, u32_t size);
 
+/**
+ * Performs one bounded step of incremental garbage collection. If there are
+ * less than min_free_blocks free blocks, the block with most deleted and
+ * least used pages is selected, its used pages are moved and the block is
+ * erased. At most one block is erased per call. Blocks which hold more used
+ * than deleted pages (as weighted by SPIFFS_GC_HEUR_W_USED and
+ * SPIFFS_GC_HEUR_W_DELET) are not collected.
+ *
+ * Meant to be called repeatedly while the system is idle, so that free blocks
+ * are available when writing and the write does not have to wait for the
+ * synchronous garbage collector. The synchronous garbage collector starts
+ * when 3 or less free blocks remain.
+ *
+ * Returns 1 if a block was reclaimed, 0 if there was nothing to collect, or
+ * an error.
+ *
+ * @param fs              the file system struct
+ * @param min_free_blocks number of free blocks to maintain
+ */
+s32_t SPIFFS_gc_step(spiffs *fs, u32_t min_free_blocks);
+
 /**
  * Check if EOF reached.
  * @param fs            the file system struct
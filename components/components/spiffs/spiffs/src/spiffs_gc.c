@@ -34,9 +34,8 @@ s32_t spiffs_gc_quick(
   s32_t res = SPIFFS_OK;
   u32_t blocks = fs->block_count;
   spiffs_block_ix cur_block = 0;
-  u32_t cur_block_addr = 0;
   int cur_entry = 0;
-  spiffs_obj_id *obj_lu_buf = (spiffs_obj_id *)fs->lu_work;
+  spiffs_obj_id *obj_lu_buf;
 
   SPIFFS_GC_DBG("gc_quick: running\n");
 #if SPIFFS_GC_STATS
@@ -55,8 +54,7 @@ s32_t spiffs_gc_quick(
     // check each object lookup page
     while (res == SPIFFS_OK && obj_lookup_page < (int)SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
       int entry_offset = obj_lookup_page * entries_per_page;
-      res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
-          0, cur_block_addr + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+      res = spiffs_obj_lu_page_rd(fs, cur_block, obj_lookup_page, &obj_lu_buf);
       // check each entry
       while (res == SPIFFS_OK &&
           cur_entry - entry_offset < entries_per_page &&
@@ -95,7 +93,6 @@ s32_t spiffs_gc_quick(
 
     cur_entry = 0;
     cur_block++;
-    cur_block_addr += SPIFFS_CFG_LOG_BLOCK_SZ(fs);
   } // per block
 
   if (res == SPIFFS_OK) {
@@ -202,7 +199,7 @@ s32_t spiffs_gc_erase_page_stats(
   s32_t res = SPIFFS_OK;
   int obj_lookup_page = 0;
   int entries_per_page = (SPIFFS_CFG_LOG_PAGE_SZ(fs) / sizeof(spiffs_obj_id));
-  spiffs_obj_id *obj_lu_buf = (spiffs_obj_id *)fs->lu_work;
+  spiffs_obj_id *obj_lu_buf;
   int cur_entry = 0;
   u32_t dele = 0;
   u32_t allo = 0;
@@ -210,8 +207,7 @@ s32_t spiffs_gc_erase_page_stats(
   // check each object lookup page
   while (res == SPIFFS_OK && obj_lookup_page < (int)SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
     int entry_offset = obj_lookup_page * entries_per_page;
-    res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
-        0, bix * SPIFFS_CFG_LOG_BLOCK_SZ(fs) + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+    res = spiffs_obj_lu_page_rd(fs, bix, obj_lookup_page, &obj_lu_buf);
     // check each entry
     while (res == SPIFFS_OK &&
         cur_entry - entry_offset < entries_per_page && cur_entry < (int)(SPIFFS_PAGES_PER_BLOCK(fs)-SPIFFS_OBJ_LOOKUP_PAGES(fs))) {
@@ -241,8 +237,7 @@ s32_t spiffs_gc_find_candidate(
   s32_t res = SPIFFS_OK;
   u32_t blocks = fs->block_count;
   spiffs_block_ix cur_block = 0;
-  u32_t cur_block_addr = 0;
-  spiffs_obj_id *obj_lu_buf = (spiffs_obj_id *)fs->lu_work;
+  spiffs_obj_id *obj_lu_buf;
   int cur_entry = 0;
 
   // using fs->work area as sorted candidate memory, (spiffs_block_ix)cand_bix/(s32_t)score
@@ -270,8 +265,7 @@ s32_t spiffs_gc_find_candidate(
     // check each object lookup page
     while (res == SPIFFS_OK && obj_lookup_page < (int)SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
       int entry_offset = obj_lookup_page * entries_per_page;
-      res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
-          0, cur_block_addr + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+      res = spiffs_obj_lu_page_rd(fs, cur_block, obj_lookup_page, &obj_lu_buf);
       // check each entry
       while (res == SPIFFS_OK &&
           cur_entry - entry_offset < entries_per_page &&
@@ -338,7 +332,6 @@ s32_t spiffs_gc_find_candidate(
 
     cur_entry = 0;
     cur_block++;
-    cur_block_addr += SPIFFS_CFG_LOG_BLOCK_SZ(fs);
   } // per block
 
   return res;
@@ -603,4 +596,86 @@ s32_t spiffs_gc_clean(spiffs *fs, spiffs_block_ix bix) {
   return res;
 }
 
+// Performs one bounded step of incremental garbage collection: if there are
+// less than min_free_blocks free blocks, the block with the most deleted and
+// least used pages is cleaned and erased, as long as it scores positive with
+// the SPIFFS_GC_HEUR_W_DELET and SPIFFS_GC_HEUR_W_USED weights. Erase age is not considered, as
+// wear levelling is left to the synchronous gc.
+// Returns 1 if a block was reclaimed, 0 if there was nothing to do, or error.
+s32_t spiffs_gc_step(
+    spiffs *fs,
+    u32_t min_free_blocks) {
+  s32_t res = SPIFFS_OK;
+  spiffs_block_ix cur_block;
+  spiffs_block_ix cand = (spiffs_block_ix)-1;
+  s32_t cand_score = 0;
+  spiffs_obj_id *obj_lu_buf;
+  int entries_per_page = (SPIFFS_CFG_LOG_PAGE_SZ(fs) / sizeof(spiffs_obj_id));
+
+  if (fs->free_blocks >= min_free_blocks || fs->stats_p_deleted == 0) {
+    return 0;
+  }
+
+  for (cur_block = 0; res == SPIFFS_OK && cur_block < fs->block_count; cur_block++) {
+    u16_t deleted_pages_in_block = 0;
+    u16_t used_pages_in_block = 0;
+    int cur_entry = 0;
+    int obj_lookup_page = 0;
+    while (res == SPIFFS_OK && obj_lookup_page < (int)SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
+      int entry_offset = obj_lookup_page * entries_per_page;
+      res = spiffs_obj_lu_page_rd(fs, cur_block, obj_lookup_page, &obj_lu_buf);
+      while (res == SPIFFS_OK &&
+          cur_entry - entry_offset < entries_per_page &&
+          cur_entry < (int)(SPIFFS_PAGES_PER_BLOCK(fs)-SPIFFS_OBJ_LOOKUP_PAGES(fs))) {
+        spiffs_obj_id obj_id = obj_lu_buf[cur_entry-entry_offset];
+        if (obj_id == SPIFFS_OBJ_ID_FREE) {
+          res = 1; // kill object lu loop
+          break;
+        } else if (obj_id == SPIFFS_OBJ_ID_DELETED) {
+          deleted_pages_in_block++;
+        } else {
+          used_pages_in_block++;
+        }
+        cur_entry++;
+      }
+      obj_lookup_page++;
+    }
+    if (res == 1) res = SPIFFS_OK;
+    SPIFFS_CHECK_RES(res);
+
+    s32_t score =
+        deleted_pages_in_block * SPIFFS_GC_HEUR_W_DELET +
+        used_pages_in_block * SPIFFS_GC_HEUR_W_USED;
+    // blocks which would mostly be moved rather than freed are left to the
+    // synchronous gc
+    if (deleted_pages_in_block > 0 && score > 0 &&
+        (cand == (spiffs_block_ix)-1 || score > cand_score)) {
+      cand = cur_block;
+      cand_score = score;
+    }
+  }
+
+  if (cand == (spiffs_block_ix)-1) {
+    return 0;
+  }
+
+  SPIFFS_GC_DBG("gc_step: cleaning block "_SPIPRIbl" score "_SPIPRIi", free_blocks:"_SPIPRIi" pdele:"_SPIPRIi"\n",
+      cand, cand_score, fs->free_blocks, fs->stats_p_deleted);
+#if SPIFFS_GC_STATS
+  fs->stats_gc_runs++;
+#endif
+  fs->cleaning = 1;
+  res = spiffs_gc_clean(fs, cand);
+  fs->cleaning = 0;
+  SPIFFS_CHECK_RES(res);
+
+  res = spiffs_gc_erase_page_stats(fs, cand);
+  SPIFFS_CHECK_RES(res);
+
+  res = spiffs_gc_erase_block(fs, cand);
+  SPIFFS_CHECK_RES(res);
+
+  return 1;
+}
+
 #endif // !SPIFFS_READ_ONLY
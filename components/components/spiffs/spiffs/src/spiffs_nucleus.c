@@ -103,6 +103,28 @@ s32_t spiffs_phys_cpy(
 }
 #endif // !SPIFFS_READ_ONLY
 
+// Reads given object lookup page of a block.
+// If a RAM index is attached, the lookup entries are served from memory and
+// obj_lu_buf is set to point into the index; otherwise the page is read into
+// fs->lu_work and obj_lu_buf is set to point to it.
+s32_t spiffs_obj_lu_page_rd(
+    spiffs *fs,
+    spiffs_block_ix bix,
+    int obj_lookup_page,
+    spiffs_obj_id **obj_lu_buf) {
+#if SPIFFS_RAM_INDEX
+  spiffs_obj_id *ram_lu = spiffs_ram_index_lu_page(fs, bix, obj_lookup_page);
+  if (ram_lu) {
+    *obj_lu_buf = ram_lu;
+    return SPIFFS_OK;
+  }
+#endif
+  *obj_lu_buf = (spiffs_obj_id *)fs->lu_work;
+  return _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
+      0, bix * SPIFFS_CFG_LOG_BLOCK_SZ(fs) + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page),
+      SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+}
+
 // Find object lookup entry containing given id with visitor.
 // Iterate over object lookup pages in each block until a given object id entry is found.
 // When found, the visitor function is called with block index, entry index and user data.
@@ -135,9 +157,8 @@ s32_t spiffs_obj_lu_find_entry_visitor(
   s32_t res = SPIFFS_OK;
   s32_t entry_count = fs->block_count * SPIFFS_OBJ_LOOKUP_MAX_ENTRIES(fs);
   spiffs_block_ix cur_block = starting_block;
-  u32_t cur_block_addr = starting_block * SPIFFS_CFG_LOG_BLOCK_SZ(fs);
 
-  spiffs_obj_id *obj_lu_buf = (spiffs_obj_id *)fs->lu_work;
+  spiffs_obj_id *obj_lu_buf;
   int cur_entry = starting_lu_entry;
   int entries_per_page = (SPIFFS_CFG_LOG_PAGE_SZ(fs) / sizeof(spiffs_obj_id));
 
@@ -145,14 +166,12 @@ s32_t spiffs_obj_lu_find_entry_visitor(
   if (cur_entry > (int)SPIFFS_OBJ_LOOKUP_MAX_ENTRIES(fs) - 1) {
     cur_entry = 0;
     cur_block++;
-    cur_block_addr = cur_block * SPIFFS_CFG_LOG_BLOCK_SZ(fs);
     if (cur_block >= fs->block_count) {
       if (flags & SPIFFS_VIS_NO_WRAP) {
         return SPIFFS_VIS_END;
       } else {
         // block wrap
         cur_block = 0;
-        cur_block_addr = 0;
       }
     }
   }
@@ -163,8 +182,7 @@ s32_t spiffs_obj_lu_find_entry_visitor(
     // check each object lookup page
     while (res == SPIFFS_OK && obj_lookup_page < (int)SPIFFS_OBJ_LOOKUP_PAGES(fs)) {
       int entry_offset = obj_lookup_page * entries_per_page;
-      res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
-          0, cur_block_addr + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+      res = spiffs_obj_lu_page_rd(fs, cur_block, obj_lookup_page, &obj_lu_buf);
       // check each entry
       while (res == SPIFFS_OK &&
           cur_entry - entry_offset < entries_per_page && // for non-last obj lookup pages
@@ -183,8 +201,7 @@ s32_t spiffs_obj_lu_find_entry_visitor(
                 user_var_p);
             if (res == SPIFFS_VIS_COUNTINUE || res == SPIFFS_VIS_COUNTINUE_RELOAD) {
               if (res == SPIFFS_VIS_COUNTINUE_RELOAD) {
-                res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU | SPIFFS_OP_C_READ,
-                    0, cur_block_addr + SPIFFS_PAGE_TO_PADDR(fs, obj_lookup_page), SPIFFS_CFG_LOG_PAGE_SZ(fs), fs->lu_work);
+                res = spiffs_obj_lu_page_rd(fs, cur_block, obj_lookup_page, &obj_lu_buf);
                 SPIFFS_CHECK_RES(res);
               }
               res = SPIFFS_OK;
@@ -205,14 +222,12 @@ s32_t spiffs_obj_lu_find_entry_visitor(
     } // per object lookup page
     cur_entry = 0;
     cur_block++;
-    cur_block_addr += SPIFFS_CFG_LOG_BLOCK_SZ(fs);
     if (cur_block >= fs->block_count) {
       if (flags & SPIFFS_VIS_NO_WRAP) {
         return SPIFFS_VIS_END;
       } else {
         // block wrap
         cur_block = 0;
-        cur_block_addr = 0;
       }
     }
   } // per block
@@ -463,6 +478,10 @@ s32_t spiffs_obj_lu_find_free(
       return SPIFFS_ERR_FULL;
     }
   }
+#if SPIFFS_RAM_INDEX
+  res = spiffs_ram_index_find_free(fs, starting_block, starting_lu_entry, block_ix, lu_entry);
+  if (res == SPIFFS_RAM_INDEX_MISS)
+#endif
   res = spiffs_obj_lu_find_id(fs, starting_block, starting_lu_entry,
       SPIFFS_OBJ_ID_FREE, block_ix, lu_entry);
   if (res == SPIFFS_OK) {
@@ -534,6 +553,21 @@ s32_t spiffs_obj_lu_find_id_and_span(
   spiffs_block_ix bix;
   int entry;
 
+#if SPIFFS_RAM_INDEX
+  if (spix == 0 && (obj_id & SPIFFS_OBJ_ID_IX_FLAG)) {
+    // object index headers are tracked by the RAM index
+    spiffs_page_ix hdr_pix;
+    res = spiffs_ram_index_find_ix_hdr(fs, obj_id, exclusion_pix, &hdr_pix);
+    if (res != SPIFFS_RAM_INDEX_MISS) {
+      SPIFFS_CHECK_RES(res);
+      if (pix) {
+        *pix = hdr_pix;
+      }
+      return res;
+    }
+  }
+#endif
+
   res = spiffs_obj_lu_find_entry_visitor(fs,
       fs->cursor_block_ix,
       fs->cursor_obj_lu_entry,
@@ -555,6 +589,12 @@ s32_t spiffs_obj_lu_find_id_and_span(
     *pix = SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry);
   }
 
+#if SPIFFS_RAM_INDEX
+  if (spix == 0 && (obj_id & SPIFFS_OBJ_ID_IX_FLAG) && exclusion_pix == 0) {
+    spiffs_ram_index_set_ix_hdr(fs, obj_id, SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry));
+  }
+#endif
+
   fs->cursor_block_ix = bix;
   fs->cursor_obj_lu_entry = entry;
 
@@ -1143,6 +1183,22 @@ void spiffs_cb_object_event(
 
 #endif
 
+#if SPIFFS_RAM_INDEX
+  // keep object index header locations in RAM index up to date, names only
+  // change when the object is created or when the header is rewritten by name
+  if (spix == 0 && (obj_id_raw & SPIFFS_OBJ_ID_IX_FLAG)) {
+    if (ev == SPIFFS_EV_IX_DEL) {
+      // GC also deletes stale header pages of objects which are still alive
+      spiffs_ram_index_del_ix_hdr(fs, obj_id_raw, new_pix);
+    } else {
+      spiffs_ram_index_set_ix_hdr(fs, obj_id_raw, new_pix);
+    }
+    if (ev == SPIFFS_EV_IX_NEW || ev == SPIFFS_EV_IX_UPD_HDR) {
+      spiffs_ram_index_set_name(fs, obj_id_raw, ((spiffs_page_object_ix_header *)objix)->name);
+    }
+  }
+#endif
+
   // callback to user if object index header
   if (fs->file_cb_f && spix == 0 && (obj_id_raw & SPIFFS_OBJ_ID_IX_FLAG)) {
     spiffs_fileop_type op;
@@ -1692,6 +1748,11 @@ static s32_t spiffs_object_find_object_index_header_by_name_v(
       (objix_hdr.p_hdr.flags & (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_IXDELE)) ==
           (SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_IXDELE)) {
     if (strcmp((const char*)user_const_p, (char*)objix_hdr.name) == 0) {
+#if SPIFFS_RAM_INDEX
+      // the RAM index missed this header, remember it for the next lookup
+      spiffs_ram_index_set_ix_hdr(fs, obj_id, pix);
+      spiffs_ram_index_set_name(fs, obj_id, objix_hdr.name);
+#endif
       return SPIFFS_OK;
     }
   }
@@ -1708,6 +1769,13 @@ s32_t spiffs_object_find_object_index_header_by_name(
   spiffs_block_ix bix;
   int entry;
 
+#if SPIFFS_RAM_INDEX
+  res = spiffs_ram_index_find_ix_hdr_by_name(fs, name, pix);
+  if (res != SPIFFS_RAM_INDEX_MISS) {
+    return res;
+  }
+#endif
+
   res = spiffs_obj_lu_find_entry_visitor(fs,
       fs->cursor_block_ix,
       fs->cursor_obj_lu_entry,
@@ -122,6 +122,8 @@
 #define SPIFFS_VIS_COUNTINUE_RELOAD     (SPIFFS_ERR_INTERNAL - 21)
 // visitor result, stop searching
 #define SPIFFS_VIS_END                  (SPIFFS_ERR_INTERNAL - 22)
+// RAM index cannot answer the query, object lookup pages must be scanned
+#define SPIFFS_RAM_INDEX_MISS           (SPIFFS_ERR_INTERNAL - 23)
 
 // updating an object index contents
 #define SPIFFS_EV_IX_UPD                (0)
@@ -573,6 +575,12 @@ s32_t spiffs_phys_cpy(
 s32_t spiffs_phys_count_free_blocks(
     spiffs *fs);
 
+s32_t spiffs_obj_lu_page_rd(
+    spiffs *fs,
+    spiffs_block_ix bix,
+    int obj_lookup_page,
+    spiffs_obj_id **obj_lu_buf);
+
 s32_t spiffs_obj_lu_find_entry_visitor(
     spiffs *fs,
     spiffs_block_ix starting_block,
@@ -763,6 +771,9 @@ s32_t spiffs_gc_clean(
 s32_t spiffs_gc_quick(
     spiffs *fs, u16_t max_free_pages);
 
+s32_t spiffs_gc_step(
+    spiffs *fs, u32_t min_free_blocks);
+
 // ---------------
 
 s32_t spiffs_fd_find_new(
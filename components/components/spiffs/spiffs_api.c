@@ -9,12 +9,17 @@
 #include "esp_partition.h"
 #include "esp_spiffs.h"
 #include "spiffs_api.h"
+#if CONFIG_SPIFFS_RAM_INDEX
+#include "spiffs_ram_index.h"
+#endif
 
 static const char* TAG = "SPIFFS";
 
 void spiffs_api_lock(spiffs *fs)
 {
-    (void) xSemaphoreTake(((esp_spiffs_t *)(fs->user_data))->lock, portMAX_DELAY);
+    esp_spiffs_t *efs = (esp_spiffs_t *)(fs->user_data);
+    (void) xSemaphoreTake(efs->lock, portMAX_DELAY);
+    efs->lock_count++;
 }
 
 void spiffs_api_unlock(spiffs *fs)
@@ -39,8 +44,14 @@ s32_t spiffs_api_write(spiffs *fs, uint32_t addr, uint32_t size, uint8_t *src)
                                         addr, src, size);
     if (unlikely(err)) {
         ESP_LOGE(TAG, "failed to write addr 0x%08" PRIx32 ", size 0x%08" PRIx32 ", err %d", addr, size, err);
+#if CONFIG_SPIFFS_RAM_INDEX
+        spiffs_ram_index_invalidate(fs);
+#endif
         return -1;
     }
+#if CONFIG_SPIFFS_RAM_INDEX
+    spiffs_ram_index_on_write(fs, addr, size, src);
+#endif
     return 0;
 }
 
@@ -50,8 +61,14 @@ s32_t spiffs_api_erase(spiffs *fs, uint32_t addr, uint32_t size)
                                         addr, size);
     if (err) {
         ESP_LOGE(TAG, "failed to erase addr 0x%08" PRIx32 ", size 0x%08" PRIx32 ", err %d", addr, size, err);
+#if CONFIG_SPIFFS_RAM_INDEX
+        spiffs_ram_index_invalidate(fs);
+#endif
         return -1;
     }
+#if CONFIG_SPIFFS_RAM_INDEX
+    spiffs_ram_index_on_erase(fs, addr, size);
+#endif
     return 0;
 }
 
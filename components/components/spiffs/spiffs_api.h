@@ -35,6 +35,11 @@ typedef struct {
     uint32_t fds_sz;                        /*!< File Descriptor Buffer Length */
     uint8_t *cache;                         /*!< Cache Buffer */
     uint32_t cache_sz;                      /*!< Cache Buffer Length */
+#if CONFIG_SPIFFS_RAM_INDEX
+    struct spiffs_ram_index_t *ram_index;   /*!< In-RAM lookup index, NULL if not built */
+#endif
+    uint32_t lock_count;                    /*!< Incremented whenever FS lock is taken, used to detect idle periods */
+    struct esp_spiffs_bg_gc_t *bg_gc;       /*!< Background GC task state, NULL if not running */
 } esp_spiffs_t;
 
 s32_t spiffs_api_read(spiffs *fs, uint32_t addr, uint32_t size, uint8_t *dst);
@@ -0,0 +1,425 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#include <string.h>
+#include <stdlib.h>
+#include "esp_log.h"
+#include "esp_partition.h"
+#include "spiffs.h"
+#include "spiffs_nucleus.h"
+#include "spiffs_api.h"
+#include "spiffs_ram_index.h"
+
+#if SPIFFS_RAM_INDEX
+
+static const char* TAG = "SPIFFS";
+
+static inline spiffs_ram_index_t *get_index(spiffs *fs)
+{
+    esp_spiffs_t *efs = (esp_spiffs_t *)fs->user_data;
+    return efs ? efs->ram_index : NULL;
+}
+
+static inline void free_map_update(spiffs_ram_index_t *idx, uint32_t entry)
+{
+    uint32_t bit = 1UL << (entry & 31);
+    if (idx->lu[entry] == SPIFFS_OBJ_ID_FREE) {
+        idx->free_map[entry >> 5] |= bit;
+    } else {
+        idx->free_map[entry >> 5] &= ~bit;
+    }
+}
+
+static inline bool ix_hdr_page_valid(const spiffs_page_header *ph, spiffs_obj_id obj_id)
+{
+    return ph->obj_id == obj_id && ph->span_ix == 0 &&
+           (ph->flags & (SPIFFS_PH_FLAG_FINAL | SPIFFS_PH_FLAG_DELET | SPIFFS_PH_FLAG_USED)) == SPIFFS_PH_FLAG_DELET &&
+           (ph->flags & SPIFFS_PH_FLAG_IXDELE) != 0;
+}
+
+// FNV-1a, 0 is reserved for "not known"
+static uint32_t name_hash(const u8_t *name)
+{
+    uint32_t hash = 2166136261UL;
+    for (int i = 0; i < SPIFFS_OBJ_NAME_LEN && name[i] != '\0'; i++) {
+        hash = (hash ^ name[i]) * 16777619UL;
+    }
+    return hash != 0 ? hash : 1;
+}
+
+static void ram_index_free(spiffs_ram_index_t *idx)
+{
+    free(idx->lu);
+    free(idx->free_map);
+    free(idx->ix_hdr);
+    free(idx->name_hash);
+    free(idx);
+}
+
+static s32_t ram_index_load(spiffs *fs, spiffs_ram_index_t *idx)
+{
+    s32_t res;
+    idx->valid = false;
+    memset(idx->ix_hdr, 0, idx->ix_hdr_count * sizeof(spiffs_page_ix));
+    memset(idx->name_hash, 0, idx->ix_hdr_count * sizeof(uint32_t));
+    idx->ix_hdr_complete = true;
+
+    for (spiffs_block_ix bix = 0; bix < fs->block_count; bix++) {
+        spiffs_obj_id *block_lu = &idx->lu[bix * idx->entries_per_block];
+        res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU2 | SPIFFS_OP_C_READ, 0,
+                         SPIFFS_BLOCK_TO_PADDR(fs, bix), idx->lu_bytes_per_block, (u8_t *)block_lu);
+        if (res != SPIFFS_OK) {
+            return res;
+        }
+        for (uint32_t entry = 0; entry < idx->entries_per_block; entry++) {
+            spiffs_obj_id obj_id = block_lu[entry];
+            free_map_update(idx, bix * idx->entries_per_block + entry);
+            if (obj_id == SPIFFS_OBJ_ID_FREE || obj_id == SPIFFS_OBJ_ID_DELETED ||
+                    (obj_id & SPIFFS_OBJ_ID_IX_FLAG) == 0) {
+                continue;
+            }
+            spiffs_page_ix pix = SPIFFS_OBJ_LOOKUP_ENTRY_TO_PIX(fs, bix, entry);
+            spiffs_page_object_ix_header objix_hdr;
+            res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU2 | SPIFFS_OP_C_READ, 0,
+                             SPIFFS_PAGE_TO_PADDR(fs, pix), sizeof(spiffs_page_object_ix_header), (u8_t *)&objix_hdr);
+            if (res != SPIFFS_OK) {
+                return res;
+            }
+            if (!ix_hdr_page_valid(&objix_hdr.p_hdr, obj_id)) {
+                continue;
+            }
+            spiffs_obj_id id = obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+            if (id < idx->ix_hdr_count) {
+                idx->ix_hdr[id] = pix;
+                idx->name_hash[id] = name_hash(objix_hdr.name);
+            } else {
+                idx->ix_hdr_complete = false;
+            }
+        }
+    }
+    idx->valid = true;
+    return SPIFFS_OK;
+}
+
+esp_err_t spiffs_ram_index_init(spiffs *fs)
+{
+    esp_spiffs_t *efs = (esp_spiffs_t *)fs->user_data;
+    assert(efs != NULL && efs->ram_index == NULL);
+
+    spiffs_ram_index_t *idx = calloc(1, sizeof(spiffs_ram_index_t));
+    if (idx == NULL) {
+        return ESP_ERR_NO_MEM;
+    }
+    idx->entries_per_block = SPIFFS_OBJ_LOOKUP_MAX_ENTRIES(fs);
+    idx->lu_bytes_per_block = idx->entries_per_block * sizeof(spiffs_obj_id);
+    idx->entry_count = fs->block_count * idx->entries_per_block;
+    // same bound as used by spiffs_obj_lu_find_free_obj_id
+    idx->ix_hdr_count = MIN(idx->entry_count / 2 + 2, (uint32_t)SPIFFS_OBJ_ID_IX_FLAG);
+
+    idx->lu = malloc(idx->entry_count * sizeof(spiffs_obj_id));
+    idx->free_map = calloc((idx->entry_count + 31) / 32, sizeof(uint32_t));
+    idx->ix_hdr = malloc(idx->ix_hdr_count * sizeof(spiffs_page_ix));
+    idx->name_hash = malloc(idx->ix_hdr_count * sizeof(uint32_t));
+    if (idx->lu == NULL || idx->free_map == NULL || idx->ix_hdr == NULL || idx->name_hash == NULL) {
+        ESP_LOGE(TAG, "RAM index could not be allocated");
+        ram_index_free(idx);
+        return ESP_ERR_NO_MEM;
+    }
+
+    SPIFFS_LOCK(fs);
+    s32_t res = ram_index_load(fs, idx);
+    if (res == SPIFFS_OK) {
+        efs->ram_index = idx;
+    }
+    SPIFFS_UNLOCK(fs);
+
+    if (res != SPIFFS_OK) {
+        ESP_LOGE(TAG, "failed to build RAM index, %" PRId32, res);
+        ram_index_free(idx);
+        return ESP_FAIL;
+    }
+    ESP_LOGD(TAG, "RAM index built, %u bytes", (unsigned) spiffs_ram_index_mem_size(fs));
+    return ESP_OK;
+}
+
+void spiffs_ram_index_deinit(spiffs *fs)
+{
+    esp_spiffs_t *efs = (esp_spiffs_t *)fs->user_data;
+    if (efs == NULL || efs->ram_index == NULL) {
+        return;
+    }
+    spiffs_ram_index_t *idx = efs->ram_index;
+    efs->ram_index = NULL;
+    ram_index_free(idx);
+}
+
+esp_err_t spiffs_ram_index_rebuild(spiffs *fs)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    SPIFFS_LOCK(fs);
+    s32_t res = ram_index_load(fs, idx);
+    SPIFFS_UNLOCK(fs);
+    return res == SPIFFS_OK ? ESP_OK : ESP_FAIL;
+}
+
+size_t spiffs_ram_index_mem_size(spiffs *fs)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL) {
+        return 0;
+    }
+    return sizeof(spiffs_ram_index_t) +
+           idx->entry_count * sizeof(spiffs_obj_id) +
+           (idx->entry_count + 31) / 32 * sizeof(uint32_t) +
+           idx->ix_hdr_count * (sizeof(spiffs_page_ix) + sizeof(uint32_t));
+}
+
+void spiffs_ram_index_on_write(spiffs *fs, uint32_t addr, uint32_t size, const uint8_t *src)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL || !idx->valid) {
+        return;
+    }
+    addr -= SPIFFS_CFG_PHYS_ADDR(fs);
+    while (size > 0) {
+        uint32_t bix = addr / SPIFFS_CFG_LOG_BLOCK_SZ(fs);
+        uint32_t offs = addr % SPIFFS_CFG_LOG_BLOCK_SZ(fs);
+        uint32_t chunk = MIN(size, SPIFFS_CFG_LOG_BLOCK_SZ(fs) - offs);
+        if (offs < idx->lu_bytes_per_block) {
+            // write touches the object lookup entries of this block, apply it the way
+            // NOR flash does: bits can only be cleared
+            uint32_t len = MIN(chunk, idx->lu_bytes_per_block - offs);
+            uint8_t *dst = (uint8_t *)&idx->lu[bix * idx->entries_per_block] + offs;
+            for (uint32_t i = 0; i < len; i++) {
+                dst[i] &= src[i];
+            }
+            uint32_t first = bix * idx->entries_per_block + offs / sizeof(spiffs_obj_id);
+            uint32_t last = bix * idx->entries_per_block + (offs + len - 1) / sizeof(spiffs_obj_id);
+            for (uint32_t entry = first; entry <= last; entry++) {
+                free_map_update(idx, entry);
+            }
+        }
+        addr += chunk;
+        src += chunk;
+        size -= chunk;
+    }
+}
+
+void spiffs_ram_index_on_erase(spiffs *fs, uint32_t addr, uint32_t size)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL || !idx->valid) {
+        return;
+    }
+    addr -= SPIFFS_CFG_PHYS_ADDR(fs);
+    while (size > 0) {
+        uint32_t bix = addr / SPIFFS_CFG_LOG_BLOCK_SZ(fs);
+        uint32_t offs = addr % SPIFFS_CFG_LOG_BLOCK_SZ(fs);
+        uint32_t chunk = MIN(size, SPIFFS_CFG_LOG_BLOCK_SZ(fs) - offs);
+        if (offs < idx->lu_bytes_per_block) {
+            uint32_t len = MIN(chunk, idx->lu_bytes_per_block - offs);
+            memset((uint8_t *)&idx->lu[bix * idx->entries_per_block] + offs, 0xff, len);
+            uint32_t first = bix * idx->entries_per_block + offs / sizeof(spiffs_obj_id);
+            uint32_t last = bix * idx->entries_per_block + (offs + len - 1) / sizeof(spiffs_obj_id);
+            for (uint32_t entry = first; entry <= last; entry++) {
+                free_map_update(idx, entry);
+            }
+        }
+        addr += chunk;
+        size -= chunk;
+    }
+}
+
+void spiffs_ram_index_invalidate(spiffs *fs)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx != NULL && idx->valid) {
+        ESP_LOGW(TAG, "RAM index invalidated, falling back to lookup page scans");
+        idx->valid = false;
+    }
+}
+
+spiffs_obj_id *spiffs_ram_index_lu_page(spiffs *fs, spiffs_block_ix bix, int obj_lookup_page)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL || !idx->valid) {
+        return NULL;
+    }
+    int entries_per_page = SPIFFS_CFG_LOG_PAGE_SZ(fs) / sizeof(spiffs_obj_id);
+    return &idx->lu[bix * idx->entries_per_block + obj_lookup_page * entries_per_page];
+}
+
+s32_t spiffs_ram_index_find_free(spiffs *fs, spiffs_block_ix starting_block, int starting_lu_entry,
+                                 spiffs_block_ix *block_ix, int *lu_entry)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL || !idx->valid) {
+        return SPIFFS_RAM_INDEX_MISS;
+    }
+    uint32_t start = starting_block * idx->entries_per_block + MIN((uint32_t)starting_lu_entry, idx->entries_per_block);
+    if (start >= idx->entry_count) {
+        start = 0;
+    }
+    // scan the bitmap a word at a time, from the start entry to the end and then wrap around
+    uint32_t words = (idx->entry_count + 31) / 32;
+    uint32_t word = start / 32;
+    uint32_t bits = idx->free_map[word] & (UINT32_MAX << (start & 31));
+    for (uint32_t n = 0; n <= words; n++) {
+        if (bits != 0) {
+            uint32_t entry = word * 32 + __builtin_ctz(bits);
+            if (entry < idx->entry_count) {
+                *block_ix = entry / idx->entries_per_block;
+                *lu_entry = entry % idx->entries_per_block;
+                return SPIFFS_OK;
+            }
+        }
+        word = (word + 1) % words;
+        bits = idx->free_map[word];
+    }
+    return SPIFFS_ERR_NOT_FOUND;
+}
+
+// Checks that the given page still holds the object index header of obj_id
+static s32_t ix_hdr_check(spiffs *fs, spiffs_ram_index_t *idx, spiffs_obj_id obj_id, spiffs_page_ix pix, bool *valid)
+{
+    *valid = false;
+    if (pix == 0 || SPIFFS_IS_LOOKUP_PAGE(fs, pix)) {
+        return SPIFFS_OK;
+    }
+    spiffs_block_ix bix = SPIFFS_BLOCK_FOR_PAGE(fs, pix);
+    int entry = SPIFFS_OBJ_LOOKUP_ENTRY_FOR_PAGE(fs, pix);
+    if (idx->lu[bix * idx->entries_per_block + entry] != obj_id) {
+        return SPIFFS_OK;
+    }
+    spiffs_page_header ph;
+    s32_t res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU2 | SPIFFS_OP_C_READ, 0,
+                           SPIFFS_PAGE_TO_PADDR(fs, pix), sizeof(spiffs_page_header), (u8_t *)&ph);
+    if (res == SPIFFS_OK) {
+        *valid = ix_hdr_page_valid(&ph, obj_id);
+    }
+    return res;
+}
+
+s32_t spiffs_ram_index_find_ix_hdr(spiffs *fs, spiffs_obj_id obj_id, spiffs_page_ix exclusion_pix,
+                                   spiffs_page_ix *pix)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    spiffs_obj_id id = obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+    if (idx == NULL || !idx->valid || id >= idx->ix_hdr_count) {
+        return SPIFFS_RAM_INDEX_MISS;
+    }
+    spiffs_page_ix hdr_pix = idx->ix_hdr[id];
+    if (hdr_pix == 0 || hdr_pix == exclusion_pix) {
+        // during a header move the old and the new page are both valid for a moment,
+        // let the scan find the one which is not excluded
+        return SPIFFS_RAM_INDEX_MISS;
+    }
+    bool valid;
+    s32_t res = ix_hdr_check(fs, idx, obj_id | SPIFFS_OBJ_ID_IX_FLAG, hdr_pix, &valid);
+    if (res != SPIFFS_OK) {
+        return res;
+    }
+    if (!valid) {
+        idx->ix_hdr[id] = 0;
+        return SPIFFS_RAM_INDEX_MISS;
+    }
+    *pix = hdr_pix;
+    return SPIFFS_OK;
+}
+
+s32_t spiffs_ram_index_find_ix_hdr_by_name(spiffs *fs, const u8_t *name, spiffs_page_ix *pix)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL || !idx->valid) {
+        return SPIFFS_RAM_INDEX_MISS;
+    }
+    spiffs_page_object_ix_header objix_hdr;
+    uint32_t hash = name_hash(name);
+    for (spiffs_obj_id id = 1; id < idx->ix_hdr_count; id++) {
+        spiffs_page_ix hdr_pix = idx->ix_hdr[id];
+        if (hdr_pix == 0 || (idx->name_hash[id] != 0 && idx->name_hash[id] != hash)) {
+            continue;
+        }
+        spiffs_obj_id obj_id = id | SPIFFS_OBJ_ID_IX_FLAG;
+        spiffs_block_ix bix = SPIFFS_BLOCK_FOR_PAGE(fs, hdr_pix);
+        int entry = SPIFFS_OBJ_LOOKUP_ENTRY_FOR_PAGE(fs, hdr_pix);
+        if (SPIFFS_IS_LOOKUP_PAGE(fs, hdr_pix) || idx->lu[bix * idx->entries_per_block + entry] != obj_id) {
+            // stale entry, the header has moved without us noticing
+            idx->ix_hdr[id] = 0;
+            idx->ix_hdr_complete = false;
+            continue;
+        }
+        s32_t res = _spiffs_rd(fs, SPIFFS_OP_T_OBJ_LU2 | SPIFFS_OP_C_READ, 0,
+                               SPIFFS_PAGE_TO_PADDR(fs, hdr_pix), sizeof(spiffs_page_object_ix_header), (u8_t *)&objix_hdr);
+        if (res != SPIFFS_OK) {
+            return res;
+        }
+        if (!ix_hdr_page_valid(&objix_hdr.p_hdr, obj_id)) {
+            idx->ix_hdr[id] = 0;
+            idx->ix_hdr_complete = false;
+            continue;
+        }
+        idx->name_hash[id] = name_hash(objix_hdr.name);
+        if (strcmp((const char *)name, (const char *)objix_hdr.name) == 0) {
+            if (pix) {
+                *pix = hdr_pix;
+            }
+            return SPIFFS_OK;
+        }
+    }
+    return idx->ix_hdr_complete ? SPIFFS_ERR_NOT_FOUND : SPIFFS_RAM_INDEX_MISS;
+}
+
+void spiffs_ram_index_set_ix_hdr(spiffs *fs, spiffs_obj_id obj_id, spiffs_page_ix pix)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL) {
+        return;
+    }
+    spiffs_obj_id id = obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+    if (id < idx->ix_hdr_count) {
+        idx->ix_hdr[id] = pix;
+        if (pix == 0) {
+            idx->name_hash[id] = 0;
+        }
+    } else if (pix != 0) {
+        idx->ix_hdr_complete = false;
+    }
+}
+
+void spiffs_ram_index_del_ix_hdr(spiffs *fs, spiffs_obj_id obj_id, spiffs_page_ix pix)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL) {
+        return;
+    }
+    spiffs_obj_id id = obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+    if (id < idx->ix_hdr_count && idx->ix_hdr[id] == pix) {
+        idx->ix_hdr[id] = 0;
+        idx->name_hash[id] = 0;
+    } else {
+        // the deleted page is not the one we know of, which may itself be stale:
+        // let lookups by name fall back to the flash scan
+        idx->ix_hdr_complete = false;
+    }
+}
+
+void spiffs_ram_index_set_name(spiffs *fs, spiffs_obj_id obj_id, const u8_t *name)
+{
+    spiffs_ram_index_t *idx = get_index(fs);
+    if (idx == NULL) {
+        return;
+    }
+    spiffs_obj_id id = obj_id & ~SPIFFS_OBJ_ID_IX_FLAG;
+    if (id < idx->ix_hdr_count) {
+        idx->name_hash[id] = name != NULL ? name_hash(name) : 0;
+    }
+}
+
+#endif // SPIFFS_RAM_INDEX
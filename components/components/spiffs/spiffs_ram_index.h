@@ -0,0 +1,104 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "spiffs.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/**
+ * @brief In-RAM index of a mounted SPIFFS partition
+ *
+ * Holds a copy of the object lookup entries of all blocks, a bitmap of free pages
+ * and tables mapping object ids to the page of their object index header and to a
+ * hash of their name. The lookup copy and the free page bitmap mirror the flash contents exactly, as they
+ * are updated from the HAL write and erase functions. The object index header table
+ * and the name hashes are updated from SPIFFS object events, and every header page
+ * is validated against flash before it is used.
+ */
+typedef struct spiffs_ram_index_t {
+    spiffs_obj_id *lu;              /*!< Object lookup entries, SPIFFS_OBJ_LOOKUP_MAX_ENTRIES per block */
+    uint32_t *free_map;             /*!< One bit per lookup entry, set if the page is free */
+    spiffs_page_ix *ix_hdr;         /*!< Object id to object index header page, 0 if not known */
+    uint32_t *name_hash;            /*!< Object id to hash of the object name, 0 if not known */
+    uint32_t entry_count;           /*!< Number of lookup entries in the partition */
+    uint32_t entries_per_block;     /*!< Number of lookup entries per block */
+    uint32_t lu_bytes_per_block;    /*!< Size of the lookup entries of one block, in bytes */
+    uint32_t ix_hdr_count;          /*!< Number of entries in the ix_hdr and name_hash tables */
+    bool valid;                     /*!< Lookup copy matches flash */
+    bool ix_hdr_complete;           /*!< All object index headers are present in the ix_hdr table */
+} spiffs_ram_index_t;
+
+/**
+ * @brief Build the RAM index of a mounted SPIFFS and attach it to the filesystem
+ *
+ * Reads the object lookup pages of all blocks and the object index header of every
+ * object, so the call takes time proportional to the partition size.
+ *
+ * @param fs  Mounted filesystem, user_data must point to esp_spiffs_t
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_NO_MEM if the index could not be allocated
+ *          - ESP_FAIL if reading the lookup pages failed
+ */
+esp_err_t spiffs_ram_index_init(spiffs *fs);
+
+/**
+ * @brief Detach the RAM index from the filesystem and free it
+ *
+ * @param fs  Filesystem the index was attached to
+ */
+void spiffs_ram_index_deinit(spiffs *fs);
+
+/**
+ * @brief Re-read the whole index from flash
+ *
+ * Needed after operations which rewrite the filesystem structure without reporting
+ * object events, e.g. SPIFFS_check.
+ *
+ * @param fs  Filesystem with attached index
+ *
+ * @return
+ *          - ESP_OK on success
+ *          - ESP_ERR_INVALID_STATE if no index is attached
+ *          - ESP_FAIL if reading the lookup pages failed
+ */
+esp_err_t spiffs_ram_index_rebuild(spiffs *fs);
+
+/**
+ * @brief Get the amount of RAM used by the index attached to the filesystem
+ *
+ * @param fs  Filesystem
+ * @return number of bytes, 0 if no index is attached
+ */
+size_t spiffs_ram_index_mem_size(spiffs *fs);
+
+/**
+ * @brief Update the index after data was written to flash, called from the HAL write function
+ */
+void spiffs_ram_index_on_write(spiffs *fs, uint32_t addr, uint32_t size, const uint8_t *src);
+
+/**
+ * @brief Update the index after flash was erased, called from the HAL erase function
+ */
+void spiffs_ram_index_on_erase(spiffs *fs, uint32_t addr, uint32_t size);
+
+/**
+ * @brief Stop using the index after a failed write or erase left flash in an unknown state
+ */
+void spiffs_ram_index_invalidate(spiffs *fs);
+
+#ifdef __cplusplus
+}
+#endif
@@ -964,3 +964,57 @@ TEST_CASE("SPIFFS garbage-collect", "[spiffs][timeout=60]")
 
     test_teardown();
 }
+
+TEST_CASE("SPIFFS background garbage collection", "[spiffs][timeout=60]")
+{
+    esp_spiffs_bg_gc_config_t gc_config = ESP_SPIFFS_BG_GC_CONFIG_DEFAULT();
+    gc_config.min_free_blocks = 32;
+    gc_config.idle_time_ms = 20;
+
+    // should fail until the partition is initialized
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_spiffs_bg_gc_start(spiffs_test_partition_label, &gc_config));
+
+    test_setup();
+    TEST_ESP_OK(esp_spiffs_format(spiffs_test_partition_label));
+    TEST_ESP_ERR(ESP_ERR_INVALID_ARG, esp_spiffs_bg_gc_start(spiffs_test_partition_label, NULL));
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_spiffs_bg_gc_stop(spiffs_test_partition_label));
+    TEST_ESP_OK(esp_spiffs_bg_gc_start(spiffs_test_partition_label, &gc_config));
+    TEST_ESP_ERR(ESP_ERR_INVALID_STATE, esp_spiffs_bg_gc_start(spiffs_test_partition_label, &gc_config));
+
+    // rewrite files repeatedly, leaving deleted pages behind for the GC task to reclaim
+    const size_t file_size = 8192;
+    char *buf = calloc(1, file_size);
+    TEST_ASSERT_NOT_NULL(buf);
+    char name[32];
+    for (int i = 0; i < 64; ++i) {
+        snprintf(name, sizeof(name), "/spiffs/gc%d.bin", i % 8);
+        memset(buf, i, file_size);
+        FILE* f = fopen(name, "wb");
+        TEST_ASSERT_NOT_NULL(f);
+        TEST_ASSERT_EQUAL(file_size, fwrite(buf, 1, file_size, f));
+        TEST_ASSERT_EQUAL(0, fclose(f));
+        if (i % 8 == 7) {
+            // let the GC task run
+            vTaskDelay(pdMS_TO_TICKS(100));
+        }
+    }
+
+    for (int i = 56; i < 64; ++i) {
+        snprintf(name, sizeof(name), "/spiffs/gc%d.bin", i % 8);
+        FILE* f = fopen(name, "rb");
+        TEST_ASSERT_NOT_NULL(f);
+        TEST_ASSERT_EQUAL(file_size, fread(buf, 1, file_size, f));
+        TEST_ASSERT_EQUAL(0, fclose(f));
+        for (size_t j = 0; j < file_size; ++j) {
+            TEST_ASSERT_EQUAL_UINT8(i, buf[j]);
+        }
+    }
+    TEST_ESP_OK(esp_spiffs_check(spiffs_test_partition_label));
+
+    TEST_ESP_OK(esp_spiffs_bg_gc_stop(spiffs_test_partition_label));
+    // unregistering stops the task as well
+    TEST_ESP_OK(esp_spiffs_bg_gc_start(spiffs_test_partition_label, &gc_config));
+
+    free(buf);
+    test_teardown();
+}
@@ -0,0 +1,142 @@
+/*
+ * SPDX-FileCopyrightText: 2025 Espressif Systems (Shanghai) CO LTD
+ *
+ * SPDX-License-Identifier: Apache-2.0
+ */
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include <sys/uio.h>
+#include <catch2/catch_test_macros.hpp>
+#include "esp_transport.h"
+#include "esp_transport_ws.h"
+
+extern "C" {
+#include "Mockmock_transport.h"
+#include "Mockesp_tls_crypto.h"
+}
+
+using unique_transport = std::unique_ptr<std::remove_pointer_t<esp_transport_handle_t>, decltype(&esp_transport_destroy)>;
+
+namespace {
+
+std::vector<std::string> writes;
+
+int mock_write_record_callback(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms, int num_call)
+{
+    writes.emplace_back(buffer, len);
+    return len;
+}
+
+int mock_write_short_callback(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms, int num_call)
+{
+    int written = len < 3 ? len : 3;
+    writes.emplace_back(buffer, written);
+    return written;
+}
+
+int mock_poll_write_callback(esp_transport_handle_t t, int timeout_ms, int num_call)
+{
+    return 1;
+}
+
+void ws_mask_callback(unsigned char *dst, const unsigned char *src, size_t len, const unsigned char mask_key[4], size_t offset, int num_call)
+{
+    for (size_t i = 0; i < len; i++) {
+        dst[i] = src[i] ^ mask_key[(offset + i) % 4];
+    }
+}
+
+struct iovec make_iovec(const char *data)
+{
+    return { const_cast<char *>(data), std::strlen(data) };
+}
+
+}
+
+TEST_CASE("Scatter-gather write of a transport without writev", "[writev]")
+{
+    constexpr static auto timeout = 50;
+    unique_transport parent_handle{esp_transport_init(), esp_transport_destroy};
+    REQUIRE(parent_handle);
+    esp_transport_set_func(parent_handle.get(), mock_connect, mock_read, mock_write, mock_close, mock_poll_read, mock_poll_write, mock_destroy);
+    mock_destroy_ExpectAnyArgsAndReturn(ESP_OK);
+    writes.clear();
+
+    struct iovec iov[] = { make_iovec("Hello"), make_iovec(""), make_iovec(", "), make_iovec("World") };
+
+    SECTION("Buffers are written one by one") {
+        mock_write_Stub(mock_write_record_callback);
+        REQUIRE(esp_transport_writev(parent_handle.get(), iov, 4, timeout) == 12);
+        REQUIRE(writes == std::vector<std::string> {"Hello", ", ", "World"});
+    }
+
+    SECTION("A short write ends the scatter-gather write") {
+        mock_write_Stub(mock_write_short_callback);
+        REQUIRE(esp_transport_writev(parent_handle.get(), iov, 4, timeout) == 3);
+        REQUIRE(writes == std::vector<std::string> {"Hel"});
+    }
+
+    SECTION("Invalid arguments") {
+        REQUIRE(esp_transport_writev(parent_handle.get(), nullptr, 1, timeout) == -1);
+        REQUIRE(esp_transport_writev(parent_handle.get(), iov, 0, timeout) == -1);
+        REQUIRE(esp_transport_writev(nullptr, iov, 4, timeout) == -1);
+    }
+}
+
+TEST_CASE("WebSocket scatter-gather write sends one frame", "[writev]")
+{
+    constexpr static auto timeout = 50;
+    unique_transport parent_handle{esp_transport_init(), esp_transport_destroy};
+    REQUIRE(parent_handle);
+    esp_transport_set_func(parent_handle.get(), mock_connect, mock_read, mock_write, mock_close, mock_poll_read, mock_poll_write, mock_destroy);
+
+    unique_transport websocket_transport{esp_transport_ws_init(parent_handle.get()), esp_transport_destroy};
+    REQUIRE(websocket_transport);
+    mock_destroy_ExpectAnyArgsAndReturn(ESP_OK);
+    mock_poll_write_Stub(mock_poll_write_callback);
+    mock_write_Stub(mock_write_record_callback);
+    esp_crypto_ws_mask_Stub(ws_mask_callback);
+    writes.clear();
+
+    SECTION("Header and payload share a single write") {
+        struct iovec iov[] = { make_iovec("Hello"), make_iovec(""), make_iovec(", "), make_iovec("World") };
+        REQUIRE(esp_transport_writev(websocket_transport.get(), iov, 4, timeout) == 12);
+        REQUIRE(writes.size() == 1);
+
+        const std::string &frame = writes[0];
+        REQUIRE(frame.size() == 2 + 4 + 12);
+        REQUIRE(static_cast<uint8_t>(frame[0]) == 0x82);    // FIN, binary
+        REQUIRE(static_cast<uint8_t>(frame[1]) == (0x80 | 12));
+        std::string payload;
+        for (size_t i = 0; i < 12; i++) {
+            payload.push_back(frame[6 + i] ^ frame[2 + i % 4]);
+        }
+        REQUIRE(payload == "Hello, World");
+    }
+
+    SECTION("Payloads longer than the buffer are gathered across the buffers") {
+        std::string first(CONFIG_WS_BUFFER_SIZE, 'a');
+        std::string second(CONFIG_WS_BUFFER_SIZE / 2, 'b');
+        struct iovec iov[] = { make_iovec(first.c_str()), make_iovec(second.c_str()) };
+        int len = first.size() + second.size();
+        REQUIRE(esp_transport_writev(websocket_transport.get(), iov, 2, timeout) == len);
+
+        std::string frame;
+        for (const auto &write : writes) {
+            frame += write;
+        }
+        REQUIRE(writes.size() == 2);
+        REQUIRE(frame.size() == 4 + 4 + len);
+        REQUIRE(static_cast<uint8_t>(frame[1]) == (0x80 | 126));
+        REQUIRE(((static_cast<uint8_t>(frame[2]) << 8) | static_cast<uint8_t>(frame[3])) == len);
+        std::string payload;
+        for (int i = 0; i < len; i++) {
+            payload.push_back(frame[8 + i] ^ frame[4 + i % 4]);
+        }
+        REQUIRE(payload == first + second);
+    }
+}
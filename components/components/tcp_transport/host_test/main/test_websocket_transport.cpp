@@ -40,6 +40,10 @@ extern "C" {
     ssize_t lwip_send(int s, const void *data, size_t size, int flags) {
         return size;
     }
+
+    ssize_t lwip_sendmsg(int s, const struct msghdr *message, int flags) {
+        return -1;
+    }
 }
 
 using unique_transport = std::unique_ptr<std::remove_pointer_t<esp_transport_handle_t>, decltype(&esp_transport_destroy)>;
@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2015-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2015-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -9,6 +9,7 @@
 
 #include <esp_err.h>
 #include <stdbool.h>
+#include <sys/uio.h>
 
 #ifdef __cplusplus
 extern "C" {
@@ -30,6 +31,7 @@ typedef struct esp_transport_item_t* esp_transport_handle_t;
 typedef int (*connect_func)(esp_transport_handle_t t, const char *host, int port, int timeout_ms);
 typedef int (*io_func)(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms);
 typedef int (*io_read_func)(esp_transport_handle_t t, char *buffer, int len, int timeout_ms);
+typedef int (*io_vec_func)(esp_transport_handle_t t, const struct iovec *iov, int iovcnt, int timeout_ms);
 typedef int (*trans_func)(esp_transport_handle_t t);
 typedef int (*poll_func)(esp_transport_handle_t t, int timeout_ms);
 typedef int (*connect_async_func)(esp_transport_handle_t t, const char *host, int port, int timeout_ms);
@@ -220,6 +222,30 @@ int esp_transport_poll_read(esp_transport_handle_t t, int timeout_ms);
  */
 int esp_transport_write(esp_transport_handle_t t, const char *buffer, int len, int timeout_ms);
 
+/**
+ * @brief      Transport scatter-gather write function
+ *
+ *             Writes the buffers of the vector, in order, as if they were one contiguous buffer. Transports
+ *             send them with as few socket writes and TLS records as they can: TCP passes the vector to the
+ *             socket, SSL coalesces it into one record (up to the maximum outgoing fragment length) and
+ *             WebSocket sends it as one frame. Transports without a scatter-gather write function
+ *             write the buffers one by one.
+ *
+ * @note       SSL coalesces the buffers in a buffer of the connection, which grows to the largest record
+ *             written and is freed when the transport is closed.
+ *
+ * @param      t           The transport handle
+ * @param[in]  iov         The buffers
+ * @param[in]  iovcnt      The number of buffers
+ * @param[in]  timeout_ms  The timeout milliseconds (-1 indicates wait forever)
+ *
+ * @return
+ *  - Number of bytes was written, which may be less than the total length of the buffers,
+ *    as for esp_transport_write()
+ *  - (-1) if there are any errors, should check errno
+ */
+int esp_transport_writev(esp_transport_handle_t t, const struct iovec *iov, int iovcnt, int timeout_ms);
+
 /**
  * @brief      Poll the transport until writeable or timeout
  *
@@ -324,6 +350,20 @@ esp_err_t esp_transport_set_async_connect_func(esp_transport_handle_t t, connect
  */
 esp_err_t esp_transport_set_parent_transport_func(esp_transport_handle_t t, payload_transfer_func _parent_transport);
 
+/**
+ * @brief      Set the scatter-gather write function of the transport handle
+ *
+ *             esp_transport_set_func() clears it, so this has to be called afterwards.
+ *
+ * @param[in]  t         The transport handle
+ * @param[in]  _writev   The writev function pointer
+ *
+ * @return
+ *     - ESP_OK
+ *     - ESP_FAIL
+ */
+esp_err_t esp_transport_set_writev_func(esp_transport_handle_t t, io_vec_func _writev);
+
 /**
  * @brief      Returns esp_tls error handle.
  *             Warning: The returned pointer is valid only as long as esp_transport_handle_t exists. Once transport
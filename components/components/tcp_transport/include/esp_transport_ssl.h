@@ -262,6 +262,60 @@ void esp_transport_ssl_set_interface_name(esp_transport_handle_t t, struct ifreq
  */
 void esp_transport_ssl_set_addr_family(esp_transport_handle_t t, esp_tls_addr_family_t addr_family);
 
+/**
+ * @brief   Established connection, detached from the transport it was opened with
+ */
+typedef struct esp_transport_conn *esp_transport_conn_handle_t;
+
+/**
+ * @brief      Detach the established connection from the transport
+ *
+ *             The connection, including its TLS session, stays open and can be attached to another transport
+ *             of the same kind later on. The transport is left closed, as after `esp_transport_close()`.
+ *
+ * @note Works with the transports created by `esp_transport_ssl_init()` and `esp_transport_tcp_init()`
+ *
+ * @param[in]  t     The transport handle
+ *
+ * @return
+ *     - Handle of the detached connection
+ *     - NULL if the transport isn't connected, or if there is no memory
+ */
+esp_transport_conn_handle_t esp_transport_ssl_detach_conn(esp_transport_handle_t t);
+
+/**
+ * @brief      Attach a connection to the transport
+ *
+ *             The transport takes the ownership of the connection, which is then used by the next reads and writes.
+ *             The connection must have been detached from a transport of the same kind (TCP or SSL),
+ *             and the transport must be closed.
+ *
+ * @param[in]  t     The transport handle
+ * @param[in]  conn  The connection, detached with `esp_transport_ssl_detach_conn()`
+ *
+ * @return
+ *     - ESP_OK on success
+ *     - ESP_ERR_INVALID_ARG if the connection doesn't match the transport
+ *     - ESP_ERR_INVALID_STATE if the transport is connected
+ */
+esp_err_t esp_transport_ssl_attach_conn(esp_transport_handle_t t, esp_transport_conn_handle_t conn);
+
+/**
+ * @brief      Get the socket of a detached connection
+ *
+ * @param[in]  conn  The connection
+ *
+ * @return     The socket, or -1 if the connection is NULL
+ */
+int esp_transport_ssl_conn_get_socket(esp_transport_conn_handle_t conn);
+
+/**
+ * @brief      Close a detached connection and free its resources
+ *
+ * @param[in]  conn  The connection, may be NULL
+ */
+void esp_transport_ssl_conn_destroy(esp_transport_conn_handle_t conn);
+
 #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
 /**
  * @brief   Session ticket operation
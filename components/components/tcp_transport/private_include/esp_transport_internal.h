@@ -1,5 +1,5 @@
 /*
- * SPDX-FileCopyrightText: 2020-2024 Espressif Systems (Shanghai) CO LTD
+ * SPDX-FileCopyrightText: 2020-2025 Espressif Systems (Shanghai) CO LTD
  *
  * SPDX-License-Identifier: Apache-2.0
  */
@@ -45,6 +45,7 @@ struct esp_transport_item_t {
     connect_func    _connect;       /*!< Connect function of this transport */
     io_read_func    _read;          /*!< Read */
     io_func         _write;         /*!< Write */
+    io_vec_func     _writev;        /*!< Scatter-gather write, NULL to write the buffers one by one */
     trans_func      _close;         /*!< Close */
     poll_func       _poll_read;     /*!< Poll and read */
     poll_func       _poll_write;    /*!< Poll and write */
@@ -8,6 +8,7 @@
 #include <stdlib.h>
 #include <errno.h>
 #include <unistd.h>
+#include <sys/param.h>
 
 #include "esp_tls.h"
 #include "esp_log.h"
@@ -18,6 +19,15 @@
 
 #define INVALID_SOCKET (-1)
 
+/* Largest record payload which esp-tls sends, the scatter-gather writes are coalesced up to this length */
+#if defined(CONFIG_MBEDTLS_SSL_OUT_CONTENT_LEN)
+#define SSL_WRITEV_RECORD_LEN CONFIG_MBEDTLS_SSL_OUT_CONTENT_LEN
+#elif defined(CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN)
+#define SSL_WRITEV_RECORD_LEN CONFIG_MBEDTLS_SSL_MAX_CONTENT_LEN
+#else
+#define SSL_WRITEV_RECORD_LEN 4096
+#endif
+
 #define GET_SSL_FROM_TRANSPORT_OR_RETURN(ssl, t)         \
     transport_esp_tls_t *ssl = ssl_get_context_data(t);  \
     if (!ssl) { return; }
@@ -38,6 +48,8 @@ typedef struct transport_esp_tls {
     bool                     ssl_initialized;
     transport_ssl_conn_state_t conn_state;
     int                      sockfd;
+    char                     *writev_buffer;        /*!< Record coalescing the buffers of a scatter-gather write, kept for the connection */
+    size_t                   writev_buffer_size;
 #ifdef CONFIG_ESP_TLS_CLIENT_SESSION_TICKETS
     esp_tls_client_session_t *session_ticket;
 #endif
@@ -257,6 +269,67 @@ static int tcp_write(esp_transport_handle_t t, const char *buffer, int len, int
     return ret;
 }
 
+static int ssl_writev(esp_transport_handle_t t, const struct iovec *iov, int iovcnt, int timeout_ms)
+{
+    transport_esp_tls_t *ssl = ssl_get_context_data(t);
+    ESP_STATIC_ANALYZER_CHECK(ssl == NULL, -1);
+
+    // Every esp_tls_conn_write() call ends at least one record, so the buffers are gathered into a single one:
+    // a single write is passed through, and so is a first buffer which fills a record by itself
+    while (iovcnt > 0 && iov->iov_len == 0) {
+        iov++;
+        iovcnt--;
+    }
+    if (iovcnt == 0) {
+        return 0;
+    }
+    if (iovcnt == 1 || iov->iov_len >= SSL_WRITEV_RECORD_LEN) {
+        return ssl_write(t, iov->iov_base, iov->iov_len, timeout_ms);
+    }
+
+    size_t len = 0;
+    for (int i = 0; i < iovcnt && len < SSL_WRITEV_RECORD_LEN; i++) {
+        len += iov[i].iov_len;
+    }
+    len = MIN(len, SSL_WRITEV_RECORD_LEN);
+    // The record buffer only grows, up to a full record, and is released when the connection is closed
+    if (ssl->writev_buffer_size < len) {
+        char *record = realloc(ssl->writev_buffer, len);
+        ESP_TRANSPORT_MEM_CHECK(TAG, record, return -1);
+        ssl->writev_buffer = record;
+        ssl->writev_buffer_size = len;
+    }
+    size_t fill = 0;
+    for (int i = 0; fill < len; i++) {
+        size_t chunk = MIN(iov[i].iov_len, len - fill);
+        memcpy(ssl->writev_buffer + fill, iov[i].iov_base, chunk);
+        fill += chunk;
+    }
+    return ssl_write(t, ssl->writev_buffer, len, timeout_ms);
+}
+
+static int tcp_writev(esp_transport_handle_t t, const struct iovec *iov, int iovcnt, int timeout_ms)
+{
+    int poll;
+    transport_esp_tls_t *ssl = ssl_get_context_data(t);
+    ESP_STATIC_ANALYZER_CHECK(ssl == NULL, -1);
+
+    if ((poll = esp_transport_poll_write(t, timeout_ms)) <= 0) {
+        ESP_LOGW(TAG, "Poll timeout or error, errno=%s, fd=%d, timeout_ms=%d", strerror(errno), ssl->sockfd, timeout_ms);
+        return poll;
+    }
+    struct msghdr msg = {
+        .msg_iov = (struct iovec *)iov,
+        .msg_iovlen = iovcnt,
+    };
+    int ret = sendmsg(ssl->sockfd, &msg, 0);
+    if (ret < 0) {
+        ESP_LOGE(TAG, "tcp_writev error, errno=%s", strerror(errno));
+        esp_transport_capture_errno(t, errno);
+    }
+    return ret;
+}
+
 static int ssl_read(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
 {
     transport_esp_tls_t *ssl = ssl_get_context_data(t);
@@ -331,6 +404,11 @@ static int base_close(esp_transport_handle_t t)
     transport_esp_tls_t *ssl = ssl_get_context_data(t);
     ESP_STATIC_ANALYZER_CHECK(ssl == NULL, -1);
 
+    if (ssl) {
+        free(ssl->writev_buffer);
+        ssl->writev_buffer = NULL;
+        ssl->writev_buffer_size = 0;
+    }
     if (ssl && ssl->ssl_initialized) {
         ret = esp_tls_conn_destroy(ssl->tls);
         ssl->tls = NULL;
@@ -515,6 +593,80 @@ static int base_get_socket(esp_transport_handle_t t)
     return INVALID_SOCKET;
 }
 
+/**
+ *  Connection detached from a TCP or SSL transport
+ */
+struct esp_transport_conn {
+    esp_tls_t   *tls;
+    int         sockfd;
+    bool        ssl_initialized;
+    bool        is_plain_tcp;
+};
+
+esp_transport_conn_handle_t esp_transport_ssl_detach_conn(esp_transport_handle_t t)
+{
+    /* Only the transports created in this file carry an esp-tls context */
+    if (!t || t->_get_socket != base_get_socket) {
+        return NULL;
+    }
+    transport_esp_tls_t *ssl = ssl_get_context_data(t);
+    if (!ssl || ssl->sockfd < 0) {
+        return NULL;
+    }
+    struct esp_transport_conn *conn = calloc(1, sizeof(struct esp_transport_conn));
+    if (conn == NULL) {
+        return NULL;
+    }
+    conn->tls = ssl->tls;
+    conn->sockfd = ssl->sockfd;
+    conn->ssl_initialized = ssl->ssl_initialized;
+    conn->is_plain_tcp = ssl->cfg.is_plain_tcp;
+
+    ssl->tls = NULL;
+    ssl->sockfd = INVALID_SOCKET;
+    ssl->ssl_initialized = false;
+    ssl->conn_state = TRANS_SSL_INIT;
+    return conn;
+}
+
+esp_err_t esp_transport_ssl_attach_conn(esp_transport_handle_t t, esp_transport_conn_handle_t conn)
+{
+    if (!t || t->_get_socket != base_get_socket || !conn) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    transport_esp_tls_t *ssl = ssl_get_context_data(t);
+    if (!ssl || conn->is_plain_tcp != ssl->cfg.is_plain_tcp) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (ssl->sockfd >= 0 || ssl->ssl_initialized) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    ssl->tls = conn->tls;
+    ssl->sockfd = conn->sockfd;
+    ssl->ssl_initialized = conn->ssl_initialized;
+    ssl->conn_state = TRANS_SSL_INIT;
+    free(conn);
+    return ESP_OK;
+}
+
+int esp_transport_ssl_conn_get_socket(esp_transport_conn_handle_t conn)
+{
+    return conn ? conn->sockfd : INVALID_SOCKET;
+}
+
+void esp_transport_ssl_conn_destroy(esp_transport_conn_handle_t conn)
+{
+    if (conn == NULL) {
+        return;
+    }
+    if (conn->ssl_initialized) {
+        esp_tls_conn_destroy(conn->tls);
+    } else if (conn->sockfd >= 0) {
+        close(conn->sockfd);
+    }
+    free(conn);
+}
+
 #ifdef CONFIG_ESP_TLS_USE_DS_PERIPHERAL
 void esp_transport_ssl_set_ds_data(esp_transport_handle_t t, void *ds_data)
 {
@@ -572,6 +724,7 @@ esp_transport_handle_t esp_transport_ssl_init(void)
     }
     ((transport_esp_tls_t *)ssl_transport->data)->cfg.is_plain_tcp = false;
     esp_transport_set_func(ssl_transport, ssl_connect, ssl_read, ssl_write, base_close, base_poll_read, base_poll_write, base_destroy);
+    esp_transport_set_writev_func(ssl_transport, ssl_writev);
     esp_transport_set_async_connect_func(ssl_transport, ssl_connect_async);
     ssl_transport->_get_socket = base_get_socket;
     return ssl_transport;
@@ -594,6 +747,7 @@ esp_transport_handle_t esp_transport_tcp_init(void)
     }
     ((transport_esp_tls_t *)tcp_transport->data)->cfg.is_plain_tcp = true;
     esp_transport_set_func(tcp_transport, tcp_connect, tcp_read, tcp_write, base_close, base_poll_read, base_poll_write, base_destroy);
+    esp_transport_set_writev_func(tcp_transport, tcp_writev);
     esp_transport_set_async_connect_func(tcp_transport, tcp_connect_async);
     tcp_transport->_get_socket = base_get_socket;
     return tcp_transport;
@@ -9,6 +9,7 @@
 #include <unistd.h>
 #include <ctype.h>
 #include <sys/random.h>
+#include <sys/param.h>
 #include <sys/socket.h>
 #include <arpa/inet.h>
 #include "esp_log.h"
@@ -37,6 +38,7 @@ static const char *TAG = "transport_ws";
 #define WS_SIZE16                   126
 #define WS_SIZE64                   127
 #define MAX_WEBSOCKET_HEADER_SIZE   16
+#define WS_WRITEV_IOV_MAX           8   // Buffers passed in a single scatter-gather write of an unmasked frame
 #define WS_TRANSPORT_MAX_CONTROL_FRAME_BUFFER_LEN 125
 
 // HTTP status codes for redirection as described in RFC 9110.
@@ -52,6 +54,7 @@ static const char *TAG = "transport_ws";
 typedef struct {
     uint8_t opcode;
     bool fin;                           /*!< Frame fin flag, for continuations */
+    bool masked;                        /*!< Flag to indicate that the payload is masked */
     char mask_key[4];                   /*!< Mask key for this payload */
     int payload_len;                    /*!< Total length of the payload */
     int bytes_remaining;                /*!< Bytes left to read of the payload  */
@@ -71,6 +74,7 @@ typedef struct {
     ws_transport_frame_state_t frame_state;
     esp_transport_handle_t parent;
     char *redir_host;
+    char *tx_buffer;          /*!< Buffer used to mask outgoing frames, of WS_BUFFER_SIZE */
 } transport_ws_t;
 
 /**
@@ -369,13 +373,53 @@ static int ws_connect(esp_transport_handle_t t, const char *host, int port, int
     return 0;
 }
 
-static int _ws_write(esp_transport_handle_t t, int opcode, int mask_flag, const char *b, int len, int timeout_ms)
+static int ws_write_all(transport_ws_t *ws, const char *buffer, int len, int timeout_ms)
+{
+    int written = 0;
+    while (written < len) {
+        int ret = esp_transport_write(ws->parent, buffer + written, len - written, timeout_ms);
+        if (ret <= 0) {
+            return ret;
+        }
+        written += ret;
+    }
+    return written;
+}
+
+/* Writes all of the buffers, advancing them past what has been written */
+static int ws_writev_all(transport_ws_t *ws, struct iovec *iov, int iovcnt, int timeout_ms)
+{
+    int written = 0;
+    while (iovcnt > 0) {
+        int ret = esp_transport_writev(ws->parent, iov, iovcnt, timeout_ms);
+        if (ret <= 0) {
+            return ret;
+        }
+        written += ret;
+        while (iovcnt > 0 && (size_t)ret >= iov->iov_len) {
+            ret -= iov->iov_len;
+            iov++;
+            iovcnt--;
+        }
+        if (iovcnt > 0) {
+            iov->iov_base = (char *)iov->iov_base + ret;
+            iov->iov_len -= ret;
+        }
+    }
+    return written;
+}
+
+static int _ws_writev(esp_transport_handle_t t, int opcode, int mask_flag, const struct iovec *iov, int iovcnt, int timeout_ms)
 {
     transport_ws_t *ws = esp_transport_get_context_data(t);
-    char *buffer = (char *)b;
     char ws_header[MAX_WEBSOCKET_HEADER_SIZE];
-    char *mask;
-    int header_len = 0, i;
+    unsigned char mask[4];
+    int header_len = 0;
+    int len = 0;
+
+    for (int i = 0; i < iovcnt; i++) {
+        len += iov[i].iov_len;
+    }
 
     int poll_write;
     if ((poll_write = esp_transport_poll_write(ws->parent, timeout_ms)) <= 0) {
@@ -403,40 +447,85 @@ static int _ws_write(esp_transport_handle_t t, int opcode, int mask_flag, const
         ws_header[header_len++] = (uint8_t)((len >> 0) & 0xFF);
     }
 
-    if (mask_flag) {
-        mask = &ws_header[header_len];
-        ssize_t rc;
-        if ((rc = getrandom(ws_header + header_len, 4, 0)) < 0) {
-            ESP_LOGD(TAG, "getrandom() returned %zd", rc);
-            return -1;
-        }
-        header_len += 4;
-
-        for (i = 0; i < len; ++i) {
-            buffer[i] = (buffer[i] ^ mask[i % 4]);
-        }
+    if (!mask_flag) {
+        // The header and the payload buffers go to the parent transport in scatter-gather writes
+        // of up to WS_WRITEV_IOV_MAX buffers, the header sharing the first one
+        struct iovec frame[WS_WRITEV_IOV_MAX];
+        frame[0].iov_base = ws_header;
+        frame[0].iov_len = header_len;
+        int count = 1;
+        int i = 0;
+        do {
+            int chunk = MIN(iovcnt - i, WS_WRITEV_IOV_MAX - count);
+            memcpy(&frame[count], &iov[i], chunk * sizeof(struct iovec));
+            count += chunk;
+            i += chunk;
+            int frame_len = 0;
+            for (int j = 0; j < count; j++) {
+                frame_len += frame[j].iov_len;
+            }
+            if (ws_writev_all(ws, frame, count, timeout_ms) != frame_len) {
+                ESP_LOGE(TAG, "Error write frame");
+                return -1;
+            }
+            count = 0;
+        } while (i < iovcnt);
+        return len;
     }
 
-    if (esp_transport_write(ws->parent, ws_header, header_len, timeout_ms) != header_len) {
-        ESP_LOGE(TAG, "Error write header");
+    ssize_t rc;
+    if ((rc = getrandom(mask, sizeof(mask), 0)) < 0) {
+        ESP_LOGD(TAG, "getrandom() returned %zd", rc);
         return -1;
     }
-    if (len == 0) {
-        return 0;
-    }
-
-    int ret = esp_transport_write(ws->parent, buffer, len, timeout_ms);
-    // in case of masked transport we have to revert back to the original data, as ws layer
-    // does not create its own copy of data to be sent
-    if (mask_flag) {
-        mask = &ws_header[header_len - 4];
-        for (i = 0; i < len; ++i) {
-            buffer[i] = (buffer[i] ^ mask[i % 4]);
+    memcpy(&ws_header[header_len], mask, sizeof(mask));
+    header_len += sizeof(mask);
+
+    // The caller's data is left untouched: the payload is masked into the tx buffer chunk by chunk,
+    // gathering it from all the buffers, the first chunk sharing the write with the header
+    if (ws->tx_buffer == NULL) {
+        ws->tx_buffer = malloc(WS_BUFFER_SIZE);
+        ESP_TRANSPORT_MEM_CHECK(TAG, ws->tx_buffer, return -1);
+    }
+    memcpy(ws->tx_buffer, ws_header, header_len);
+    int fill = header_len;
+    int sent = 0;
+    int ret = len;
+    int i = 0;
+    size_t offset = 0;
+    do {
+        while (sent < len && fill < WS_BUFFER_SIZE) {
+            if (offset == iov[i].iov_len) {
+                i++;
+                offset = 0;
+                continue;
+            }
+            int chunk = MIN((int)(iov[i].iov_len - offset), WS_BUFFER_SIZE - fill);
+            esp_crypto_ws_mask((unsigned char *)ws->tx_buffer + fill, (const unsigned char *)iov[i].iov_base + offset, chunk, mask, sent);
+            fill += chunk;
+            offset += chunk;
+            sent += chunk;
         }
-    }
+        if (ws_write_all(ws, ws->tx_buffer, fill, timeout_ms) != fill) {
+            ESP_LOGE(TAG, "Error write data");
+            ret = -1;
+            break;
+        }
+        fill = 0;
+    } while (sent < len);
+
     return ret;
 }
 
+static int _ws_write(esp_transport_handle_t t, int opcode, int mask_flag, const char *b, int len, int timeout_ms)
+{
+    struct iovec iov = {
+        .iov_base = (void *)b,
+        .iov_len = len,
+    };
+    return _ws_writev(t, opcode, mask_flag, &iov, 1, timeout_ms);
+}
+
 int esp_transport_ws_send_raw(esp_transport_handle_t t, ws_transport_opcodes_t opcode, const char *b, int len, int timeout_ms)
 {
     uint8_t op_code = ws_get_bin_opcode(opcode);
@@ -460,6 +549,12 @@ static int ws_write(esp_transport_handle_t t, const char *b, int len, int timeou
     return _ws_write(t, WS_OPCODE_BINARY | WS_FIN, WS_MASK, b, len, timeout_ms);
 }
 
+static int ws_writev(esp_transport_handle_t t, const struct iovec *iov, int iovcnt, int timeout_ms)
+{
+    // The buffers make up the payload of a single binary frame
+    return _ws_writev(t, WS_OPCODE_BINARY | WS_FIN, WS_MASK, iov, iovcnt, timeout_ms);
+}
+
 
 static int ws_read_payload(esp_transport_handle_t t, char *buffer, int len, int timeout_ms)
 {
@@ -483,8 +578,11 @@ static int ws_read_payload(esp_transport_handle_t t, char *buffer, int len, int
     }
     ws->frame_state.bytes_remaining -= rlen;
 
-    for (int i = 0; i < bytes_to_read; i++) {
-        buffer[i] = (buffer[i] ^ ws->frame_state.mask_key[i % 4]);
+    if (ws->frame_state.masked) {
+        // bytes_remaining has already been decreased, so this is the position of buffer[0] in the payload
+        int offset = ws->frame_state.payload_len - ws->frame_state.bytes_remaining - rlen;
+        esp_crypto_ws_mask((unsigned char *)buffer, (const unsigned char *)buffer, rlen,
+                           (const unsigned char *)ws->frame_state.mask_key, offset);
     }
     return rlen;
 }
@@ -581,6 +679,7 @@ static int ws_read_header(esp_transport_handle_t t, char *buffer, int len, int t
     } else {
         memset(ws->frame_state.mask_key, 0, mask_len);
     }
+    ws->frame_state.masked = mask;
 
     ws->frame_state.payload_len = payload_len;
     ws->frame_state.bytes_remaining = payload_len;
@@ -694,6 +793,11 @@ static int ws_poll_write(esp_transport_handle_t t, int timeout_ms)
 static int ws_close(esp_transport_handle_t t)
 {
     transport_ws_t *ws = esp_transport_get_context_data(t);
+#ifdef CONFIG_WS_DYNAMIC_BUFFER
+    // The tx buffer is kept for all the writes of a connection
+    free(ws->tx_buffer);
+    ws->tx_buffer = NULL;
+#endif
     return esp_transport_close(ws->parent);
 }
 
@@ -701,6 +805,7 @@ static esp_err_t ws_destroy(esp_transport_handle_t t)
 {
     transport_ws_t *ws = esp_transport_get_context_data(t);
     free(ws->buffer);
+    free(ws->tx_buffer);
     free(ws->path);
     free(ws->sub_protocol);
     free(ws->user_agent);
@@ -782,6 +887,7 @@ esp_transport_handle_t esp_transport_ws_init(esp_transport_handle_t parent_handl
     });
 
     esp_transport_set_func(t, ws_connect, ws_read, ws_write, ws_close, ws_poll_read, ws_poll_write, ws_destroy);
+    esp_transport_set_writev_func(t, ws_writev);
     // websocket underlying transfer is the payload transfer handle
     esp_transport_set_parent_transport_func(t, ws_get_payload_transport_handle);
 